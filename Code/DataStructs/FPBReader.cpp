@@ -16,12 +16,20 @@
 #include <cstdint>
 #include <DataStructs/BitOps.h>
 
+#include <DataStructs/PackedBitOps.h>
+
 #include <RDGeneral/Invariant.h>
 #include <RDGeneral/StreamOps.h>
 #include <RDGeneral/Ranking.h>
+#include <RDGeneral/RDThreads.h>
 #include "FPBReader.h"
 #include <boost/scoped_ptr.hpp>
 #include <boost/scoped_array.hpp>
+#include <algorithm>
+#include <cstring>
+#ifdef RDK_BUILD_THREADSAFE_SSS
+#include <future>
+#endif
 
 namespace RDKit {
 
@@ -481,6 +489,222 @@ void tanimotoNeighbors(const FPBReader_impl *dp_impl, const std::uint8_t *bv,
   }
 }
 
+// the k best (similarity, index) pairs seen so far. Higher similarities are
+// better, ties are broken in favor of the lower index.
+class NearestNeighbors {
+ public:
+  NearestNeighbors(unsigned int k, double threshold)
+      : d_k(k), d_threshold(threshold) {}
+
+  // the similarity a fingerprint needs to have to be added
+  double cutoff() const {
+    return d_heap.size() < d_k ? d_threshold : d_heap.front().first;
+  }
+  bool full() const { return d_heap.size() == d_k; }
+
+  void add(double sim, unsigned int idx) {
+    if (sim < cutoff()) {
+      return;
+    }
+    std::pair<double, unsigned int> nbr(sim, idx);
+    if (d_heap.size() < d_k) {
+      d_heap.push_back(nbr);
+      std::push_heap(d_heap.begin(), d_heap.end(), better);
+    } else if (better(nbr, d_heap.front())) {
+      std::pop_heap(d_heap.begin(), d_heap.end(), better);
+      d_heap.back() = nbr;
+      std::push_heap(d_heap.begin(), d_heap.end(), better);
+    }
+  }
+  void merge(const NearestNeighbors &other) {
+    for (const auto &nbr : other.d_heap) {
+      add(nbr.first, nbr.second);
+    }
+  }
+  std::vector<std::pair<double, unsigned int>> getSorted() const {
+    auto res = d_heap;
+    std::sort(res.begin(), res.end(), better);
+    return res;
+  }
+
+ private:
+  static bool better(const std::pair<double, unsigned int> &v1,
+                     const std::pair<double, unsigned int> &v2) {
+    if (v1.first == v2.first) {
+      return v1.second < v2.second;
+    }
+    return v1.first > v2.first;
+  }
+  unsigned int d_k;
+  double d_threshold;
+  // the worst of the neighbors is at the front
+  std::vector<std::pair<double, unsigned int>> d_heap;
+};
+
+// scans fingerprints [startIdx, endIdx) for Tanimoto neighbors of the probe.
+// dbCount is the popcount of all of the fingerprints in the range, or -1 if
+// that isn't known.
+void scanTanimotoNeighbors(const FPBReader_impl *dp_impl,
+                           const std::vector<std::uint64_t> &probe,
+                           std::uint32_t probeCount, int dbCount,
+                           std::uint64_t startIdx, std::uint64_t endIdx,
+                           NearestNeighbors &nbrs) {
+  const unsigned int blockSize = 1024;
+  const auto storedBytes = dp_impl->numBytesStoredPerFingerprint;
+  const auto numWords = static_cast<unsigned int>(probe.size());
+  // the in-memory arena can be used directly if its rows are whole,
+  // aligned words
+  const bool direct =
+      !dp_impl->df_lazy && !(storedBytes % sizeof(std::uint64_t)) &&
+      !(reinterpret_cast<std::uintptr_t>(dp_impl->dp_fpData) %
+        alignof(std::uint64_t));
+  std::vector<std::uint8_t> readBuffer;
+  std::vector<std::uint64_t> rowBuffer;
+  if (!direct) {
+    if (dp_impl->df_lazy) {
+      readBuffer.resize(storedBytes * blockSize);
+    }
+    rowBuffer.resize(numWords * blockSize, 0);
+  }
+  std::vector<std::uint32_t> common(blockSize);
+  std::vector<std::uint32_t> counts(blockSize);
+  for (auto i = startIdx; i < endIdx; i += blockSize) {
+    auto toRead = static_cast<unsigned int>(
+        std::min<std::uint64_t>(blockSize, endIdx - i));
+    const std::uint64_t *rows;
+    if (direct) {
+      rows = reinterpret_cast<const std::uint64_t *>(dp_impl->dp_fpData +
+                                                     i * storedBytes);
+    } else {
+      std::uint8_t *bytes = readBuffer.data();
+      extractBytes(dp_impl, i, bytes, toRead);
+      for (unsigned int j = 0; j < toRead; ++j) {
+        memcpy(static_cast<void *>(&rowBuffer[j * numWords]),
+               bytes + j * storedBytes, storedBytes);
+      }
+      rows = rowBuffer.data();
+    }
+    PackedBitOps::bulkIntersectionPopcounts(probe.data(), rows, numWords,
+                                            numWords, toRead, common.data());
+    if (dbCount < 0) {
+      PackedBitOps::bulkPopcounts(rows, numWords, numWords, toRead,
+                                  counts.data());
+    }
+    for (unsigned int j = 0; j < toRead; ++j) {
+      auto dbc = dbCount < 0 ? counts[j] : static_cast<std::uint32_t>(dbCount);
+      auto unionCount = probeCount + dbc - common[j];
+      double tani = unionCount ? static_cast<double>(common[j]) / unionCount
+                               : 0.0;
+      nbrs.add(tani, static_cast<unsigned int>(i + j));
+    }
+  }
+}
+
+void tanimotoNearestNeighbors(
+    const FPBReader_impl *dp_impl, const std::uint8_t *bv, unsigned int k,
+    double threshold, int numThreads,
+    std::vector<std::pair<double, unsigned int>> &res) {
+  PRECONDITION(dp_impl, "bad reader pointer");
+  PRECONDITION(bv, "bad bv");
+  RANGE_CHECK(-1e-6, threshold, 1.0 + 1e-6);
+  res.clear();
+  if (!k || !dp_impl->len) {
+    return;
+  }
+  // the probe is packed into words of the same length as the stored rows,
+  // the padding bytes at the end of the rows are zero
+  const auto storedBytes = dp_impl->numBytesStoredPerFingerprint;
+  std::vector<std::uint64_t> probe(
+      (storedBytes + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t), 0);
+  memcpy(static_cast<void *>(probe.data()), bv,
+         std::min<std::uint32_t>(storedBytes, dp_impl->nBits / 8));
+  std::uint32_t probeCount = 0;
+  PackedBitOps::bulkPopcounts(probe.data(), probe.size(), probe.size(), 1,
+                              &probeCount);
+
+  NearestNeighbors nbrs(k, threshold);
+  numThreads = static_cast<int>(getNumThreadsToUse(numThreads));
+  if (dp_impl->df_lazy) {
+    // we can't read the stream from multiple threads
+    numThreads = 1;
+  }
+  // ranges with fewer fingerprints than this per thread are scanned in
+  // the calling thread
+  const std::uint64_t minRowsPerThread = 4096;
+  auto scanRange = [&](int dbCount, std::uint64_t startIdx,
+                       std::uint64_t endIdx) {
+    std::uint64_t nRows = endIdx - startIdx;
+    auto nThreads = static_cast<unsigned int>(
+        std::min<std::uint64_t>(numThreads, nRows / minRowsPerThread));
+    if (nThreads <= 1) {
+      scanTanimotoNeighbors(dp_impl, probe, probeCount, dbCount, startIdx,
+                            endIdx, nbrs);
+      return;
+    }
+#ifdef RDK_BUILD_THREADSAFE_SSS
+    // each thread collects its own neighbors, starting from the current
+    // cutoff, and the results are merged afterwards
+    std::vector<NearestNeighbors> threadNbrs(
+        nThreads, NearestNeighbors(k, nbrs.cutoff()));
+    std::vector<std::future<void>> tg;
+    auto chunkSize = (nRows + nThreads - 1) / nThreads;
+    for (unsigned int tid = 0; tid < nThreads; ++tid) {
+      auto chunkStart = startIdx + tid * chunkSize;
+      auto chunkEnd = std::min(endIdx, chunkStart + chunkSize);
+      tg.emplace_back(std::async(
+          std::launch::async, scanTanimotoNeighbors, dp_impl, std::cref(probe),
+          probeCount, dbCount, chunkStart, chunkEnd,
+          std::ref(threadNbrs[tid])));
+    }
+    for (auto &fut : tg) {
+      fut.get();
+    }
+    for (const auto &tnbrs : threadNbrs) {
+      nbrs.merge(tnbrs);
+    }
+#endif
+  };
+
+  if (dp_impl->popCountOffsets.size() != dp_impl->nBits + 2) {
+    // no popcount information, we have to look at everything
+    scanRange(-1, 0, dp_impl->len);
+  } else {
+    // The fingerprints are sorted by popcount. The Tanimoto similarity to a
+    // fingerprint with dbCount bits set is at most
+    //   min(probeCount, dbCount) / max(probeCount, dbCount)
+    // (Swamidass & Baldi, J. Chem. Inf. Model. 47, 302-317 (2007)), so we
+    // visit the popcount bins in order of decreasing bound and stop as soon
+    // as the bound drops below the similarity of the k-th best neighbor.
+    auto bound = [probeCount](std::uint32_t dbCount) {
+      auto maxCount = std::max(probeCount, dbCount);
+      return maxCount ? static_cast<double>(std::min(probeCount, dbCount)) /
+                            maxCount
+                      : 0.0;
+    };
+    const auto maxCount = dp_impl->nBits;
+    std::int64_t lo = std::min(probeCount, maxCount);
+    std::int64_t hi = lo + 1;
+    while (lo >= 0 || hi <= maxCount) {
+      std::uint32_t dbCount;
+      if (hi > maxCount || (lo >= 0 && bound(lo) >= bound(hi))) {
+        dbCount = static_cast<std::uint32_t>(lo--);
+      } else {
+        dbCount = static_cast<std::uint32_t>(hi++);
+      }
+      if (bound(dbCount) < nbrs.cutoff()) {
+        // the remaining bins can't have better bounds
+        break;
+      }
+      auto startIdx = dp_impl->popCountOffsets[dbCount];
+      auto endIdx = dp_impl->popCountOffsets[dbCount + 1];
+      if (endIdx > startIdx) {
+        scanRange(static_cast<int>(dbCount), startIdx, endIdx);
+      }
+    }
+  }
+  res = nbrs.getSorted();
+}
+
 void tverskyNeighbors(const FPBReader_impl *dp_impl, const std::uint8_t *bv,
                       double ca, double cb, double threshold,
                       std::vector<std::pair<double, unsigned int>> &res,
@@ -723,6 +947,26 @@ std::vector<std::pair<double, unsigned int>> FPBReader::getTanimotoNeighbors(
   return res;
 }
 
+std::vector<std::pair<double, unsigned int>>
+FPBReader::getTanimotoNearestNeighbors(const std::uint8_t *bv, unsigned int k,
+                                       double threshold, int numThreads) const {
+  PRECONDITION(df_init, "not initialized");
+  std::vector<std::pair<double, unsigned int>> res;
+  detail::tanimotoNearestNeighbors(dp_impl, bv, k, threshold, numThreads, res);
+  return res;
+}
+
+std::vector<std::pair<double, unsigned int>>
+FPBReader::getTanimotoNearestNeighbors(const ExplicitBitVect &ebv,
+                                       unsigned int k, double threshold,
+                                       int numThreads) const {
+  const std::uint8_t *bv = detail::bitsetToBytes(*(ebv.dp_bits));
+  std::vector<std::pair<double, unsigned int>> res =
+      getTanimotoNearestNeighbors(bv, k, threshold, numThreads);
+  delete[] bv;
+  return res;
+}
+
 double FPBReader::getTversky(unsigned int idx, const std::uint8_t *bv,
                              double ca, double cb) const {
   PRECONDITION(df_init, "not initialized");
@@ -182,6 +182,40 @@ class RDKIT_DATASTRUCTS_EXPORT FPBReader {
       const ExplicitBitVect &ebv, double threshold = 0.7,
       bool usePopcountScreen = true) const;
 
+  //! returns the \c k fingerprints most similar to the query
+  /*!
+  The result vector of (similarity,index) pairs is sorted in order
+  of decreasing similarity, ties are broken in favor of the lower index.
+
+  If the file has popcount information, the fingerprints are visited in
+  order of decreasing upper bound on their similarity to the query and the
+  search stops as soon as that bound drops below the similarity of the
+  \c k'th neighbor found so far.
+
+    \param bv the query fingerprint
+    \param k the number of neighbors to return
+    \param threshold the minimum similarity to return
+    \param numThreads  Sets the number of threads to use when scanning
+    large sets of fingerprints (more than one thread will only be used if the
+    RDKit was build with multithread support and the reader is not in
+    \c lazyRead mode) If set to zero, the max supported by the system will
+    be used.
+
+  */
+  std::vector<std::pair<double, unsigned int>> getTanimotoNearestNeighbors(
+      const std::uint8_t *bv, unsigned int k = 1, double threshold = 0.0,
+      int numThreads = 1) const;
+  //! \overload
+  std::vector<std::pair<double, unsigned int>> getTanimotoNearestNeighbors(
+      boost::shared_array<std::uint8_t> bv, unsigned int k = 1,
+      double threshold = 0.0, int numThreads = 1) const {
+    return getTanimotoNearestNeighbors(bv.get(), k, threshold, numThreads);
+  }
+  //! \overload
+  std::vector<std::pair<double, unsigned int>> getTanimotoNearestNeighbors(
+      const ExplicitBitVect &ebv, unsigned int k = 1, double threshold = 0.0,
+      int numThreads = 1) const;
+
   //! returns the Tversky similarity between the specified fingerprint and the
   //! provided fingerprint
   /*!
@@ -0,0 +1,663 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//  @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+// The FPB format is described in FPBReader.cpp, which follows fpb_io.py
+// from chemfp (www.chemfp.org)
+
+#include "FPBWriter.h"
+#include <DataStructs/BitOps.h>
+#include <RDGeneral/BadFileException.h>
+#include <RDGeneral/Invariant.h>
+#include <RDGeneral/RDLog.h>
+#include <RDGeneral/StreamOps.h>
+#include <RDGeneral/versions.h>
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <tuple>
+
+namespace RDKit {
+namespace detail {
+namespace {
+const std::string FPB_MAGIC("FPB1\r\n\0\0", 8);
+const unsigned int tagNameSize = 4;
+// the fingerprints in the arena start on a multiple of this in the file and
+// are padded to a multiple of it
+const unsigned int arenaAlignment = 8;
+// the size of the num_4byte_elements and num_8byte_elements fields at the
+// start of the FPID chunk
+const std::uint64_t idHeaderSize = 8;
+
+void writeChunkHeader(std::ostream &ostrm, const std::string &tag,
+                      std::uint64_t sz) {
+  PRECONDITION(tag.size() == tagNameSize, "bad tag");
+  streamWrite(ostrm, sz);
+  ostrm.write(tag.c_str(), tagNameSize);
+}
+
+void copyStream(std::istream &istrm, std::ostream &ostrm) {
+  std::vector<char> buffer(1 << 16);
+  while (istrm) {
+    istrm.read(buffer.data(), buffer.size());
+    ostrm.write(buffer.data(), istrm.gcount());
+  }
+}
+
+//! a fingerprint on its way to the output file
+struct MergeRecord {
+  std::uint32_t popcount = 0;
+  std::uint64_t seq = 0;  //!< the position in the order of addition
+  std::string id;
+  std::vector<std::uint8_t> fp;
+};
+
+//! a sequence of fingerprints sorted by popcount and then by seq
+class MergeSource {
+ public:
+  virtual ~MergeSource() = default;
+  //! reads the next fingerprint, returns false at the end
+  virtual bool next(MergeRecord &rec) = 0;
+};
+
+//! reads the records of a run written by FPBWriter_impl::writeRun()
+class RunSource : public MergeSource {
+ public:
+  RunSource(const std::filesystem::path &path, unsigned int numBytes)
+      : d_strm(path, std::ios_base::binary), d_numBytes(numBytes) {
+    if (!d_strm) {
+      throw BadFileException("could not open temporary file " +
+                             path.string());
+    }
+  }
+  bool next(MergeRecord &rec) override {
+    if (d_strm.peek() == std::char_traits<char>::eof()) {
+      return false;
+    }
+    std::uint32_t idLength;
+    streamRead(d_strm, rec.popcount);
+    streamRead(d_strm, rec.seq);
+    streamRead(d_strm, idLength);
+    rec.id.resize(idLength);
+    d_strm.read(rec.id.data(), idLength);
+    rec.fp.resize(d_numBytes);
+    d_strm.read(reinterpret_cast<char *>(rec.fp.data()), d_numBytes);
+    if (!d_strm) {
+      throw BadFileException("truncated temporary file");
+    }
+    return true;
+  }
+
+ private:
+  std::ifstream d_strm;
+  unsigned int d_numBytes;
+};
+
+//! reads the records of an existing FPB file sequentially
+class FPBSource : public MergeSource {
+ public:
+  FPBSource(const std::string &fname, std::uint64_t firstSeq = 0)
+      : d_fname(fname), d_firstSeq(firstSeq) {
+    std::ifstream strm(fname, std::ios_base::binary);
+    if (!strm) {
+      throw BadFileException("Bad input file " + fname);
+    }
+    char magic[8];
+    strm.read(magic, FPB_MAGIC.size());
+    if (!strm || FPB_MAGIC != std::string(magic, FPB_MAGIC.size())) {
+      throw BadFileException("Invalid FPB magic");
+    }
+    bool haveArena = false, haveIds = false;
+    while (true) {
+      std::uint64_t sz;
+      char tag[tagNameSize];
+      try {
+        streamRead(strm, sz);
+      } catch (const std::runtime_error &) {
+        throw BadFileException("EOF hit before FEND record");
+      }
+      strm.read(tag, tagNameSize);
+      std::string chunkNm(tag, tagNameSize);
+      std::streampos start = strm.tellg();
+      if (chunkNm == "FEND") {
+        break;
+      } else if (chunkNm == "AREN") {
+        std::uint8_t spacer;
+        streamRead(strm, d_numBytes);
+        streamRead(strm, d_storageSize);
+        streamRead(strm, spacer);
+        if (!d_storageSize || d_storageSize < d_numBytes) {
+          throw BadFileException("Invalid AREN record");
+        }
+        d_arenaOffset = start + static_cast<std::streamoff>(9 + spacer);
+        d_length = (sz - 9 - spacer) / d_storageSize;
+        haveArena = true;
+      } else if (chunkNm == "FPID") {
+        streamRead(strm, d_num4ByteElements);
+        streamRead(strm, d_num8ByteElements);
+        d_idChunkOffset = start;
+        d_idOffsetsOffset =
+            start + static_cast<std::streamoff>(
+                        sz - (d_num4ByteElements + 1) * 4 -
+                        static_cast<std::uint64_t>(d_num8ByteElements) * 8);
+        haveIds = true;
+      } else if (chunkNm == "POPC") {
+        df_sorted = true;
+      }
+      strm.seekg(start + static_cast<std::streamoff>(sz));
+      if (!strm) {
+        throw BadFileException("EOF hit before FEND record");
+      }
+    }
+    if (!haveArena) {
+      throw BadFileException("No AREN record found");
+    }
+    if (!haveIds) {
+      throw BadFileException("No FPID record found");
+    }
+    if (d_length !=
+        static_cast<std::uint64_t>(d_num4ByteElements) + d_num8ByteElements) {
+      throw BadFileException("the AREN and FPID records have different sizes");
+    }
+  }
+
+  unsigned int getNumBytes() const { return d_numBytes; }
+  std::uint64_t length() const { return d_length; }
+  //! whether or not the file is sorted by popcount
+  bool isSorted() const { return df_sorted; }
+
+  bool next(MergeRecord &rec) override {
+    if (!df_open) {
+      open();
+    }
+    if (d_pos == d_length) {
+      return false;
+    }
+    rec.fp.resize(d_storageSize);
+    d_fps.read(reinterpret_cast<char *>(rec.fp.data()), d_storageSize);
+    rec.fp.resize(d_numBytes);
+    rec.popcount = CalcBitmapPopcount(rec.fp.data(), d_numBytes);
+    rec.seq = d_firstSeq + d_pos;
+
+    std::uint64_t offset = readOffset(d_pos + 1);
+    if (offset < d_lastOffset) {
+      throw BadFileException("Invalid FPID record");
+    }
+    rec.id.resize(offset - d_lastOffset);
+    d_ids.read(rec.id.data(), rec.id.size());
+    d_lastOffset = offset;
+    if (!d_fps || !d_ids) {
+      throw BadFileException("error reading " + d_fname);
+    }
+    if (df_sorted && rec.popcount < d_lastPopcount) {
+      throw BadFileException(d_fname + " is not sorted by popcount");
+    }
+    d_lastPopcount = rec.popcount;
+    ++d_pos;
+    return true;
+  }
+
+ private:
+  void open() {
+    for (auto strm : {&d_fps, &d_ids, &d_offsets}) {
+      strm->open(d_fname, std::ios_base::binary);
+      if (!*strm) {
+        throw BadFileException("Bad input file " + d_fname);
+      }
+    }
+    d_fps.seekg(d_arenaOffset);
+    d_offsets.seekg(d_idOffsetsOffset);
+    d_lastOffset = readOffset(0);
+    d_ids.seekg(d_idChunkOffset + static_cast<std::streamoff>(d_lastOffset));
+    df_open = true;
+  }
+  //! reads the next entry of the offsets table, which is entry idx
+  std::uint64_t readOffset(std::uint64_t idx) {
+    if (idx <= d_num4ByteElements) {
+      std::uint32_t offset;
+      streamRead(d_offsets, offset);
+      return offset;
+    }
+    std::uint64_t offset;
+    streamRead(d_offsets, offset);
+    return offset;
+  }
+
+  std::string d_fname;
+  std::uint64_t d_firstSeq;
+  std::uint32_t d_numBytes = 0;
+  std::uint32_t d_storageSize = 0;
+  std::uint64_t d_length = 0;
+  std::uint32_t d_num4ByteElements = 0;
+  std::uint32_t d_num8ByteElements = 0;
+  std::streampos d_arenaOffset;
+  std::streampos d_idChunkOffset;
+  std::streampos d_idOffsetsOffset;
+  bool df_sorted = false;
+
+  bool df_open = false;
+  std::ifstream d_fps, d_ids, d_offsets;
+  std::uint64_t d_pos = 0;
+  std::uint64_t d_lastOffset = 0;
+  std::uint32_t d_lastPopcount = 0;
+};
+
+//! the fingerprints which were not written to a run yet
+struct BufferedFP {
+  std::uint32_t popcount;
+  std::uint64_t seq;
+  std::size_t dataOffset;  //!< where the fingerprint starts in the data
+  std::size_t idOffset;
+  std::size_t idLength;
+};
+
+class MemorySource : public MergeSource {
+ public:
+  MemorySource(std::vector<BufferedFP> &fps, std::vector<std::uint8_t> &data,
+               std::string &ids, unsigned int numBytes)
+      : d_numBytes(numBytes) {
+    d_fps.swap(fps);
+    d_data.swap(data);
+    d_ids.swap(ids);
+  }
+  bool next(MergeRecord &rec) override {
+    if (d_pos == d_fps.size()) {
+      return false;
+    }
+    const auto &fp = d_fps[d_pos];
+    rec.popcount = fp.popcount;
+    rec.seq = fp.seq;
+    rec.id.assign(d_ids, fp.idOffset, fp.idLength);
+    rec.fp.assign(d_data.begin() + fp.dataOffset,
+                  d_data.begin() + fp.dataOffset + d_numBytes);
+    ++d_pos;
+    return true;
+  }
+
+ private:
+  std::vector<BufferedFP> d_fps;
+  std::vector<std::uint8_t> d_data;
+  std::string d_ids;
+  unsigned int d_numBytes;
+  std::size_t d_pos = 0;
+};
+}  // namespace
+
+struct FPBWriter_impl {
+  std::string fname;
+  unsigned int nBits;
+  unsigned int numBytes;
+  std::size_t maxMemory;
+  std::filesystem::path tmpDir;
+  std::string tmpPrefix;
+  unsigned int numTmpFiles = 0;
+  bool df_closed = false;
+  // the number of exceptions in flight when the writer was created
+  int numUncaughtExceptions = std::uncaught_exceptions();
+
+  std::uint64_t nextSeq = 0;
+  std::vector<BufferedFP> buffer;
+  std::vector<std::uint8_t> bufferData;
+  std::string bufferIds;
+  std::vector<std::filesystem::path> runs;
+  std::vector<std::pair<std::string, std::uint64_t>> fpbFiles;
+  std::vector<std::filesystem::path> tmpFiles;
+
+  //! returns the memory held by the buffers once a fingerprint with an id
+  //! of \c idLength characters has been added, including unused capacity
+  std::size_t bufferSizeAfterAdd(std::size_t idLength) const {
+    // assume that full containers double their capacity
+    auto capacityAfterAdd = [](const auto &container, std::size_t extra) {
+      auto size = container.size() + extra;
+      return size <= container.capacity()
+                 ? container.capacity()
+                 : std::max(2 * container.capacity(), size);
+    };
+    return capacityAfterAdd(buffer, 1) * sizeof(BufferedFP) +
+           capacityAfterAdd(bufferData, numBytes) +
+           capacityAfterAdd(bufferIds, idLength);
+  }
+
+  std::filesystem::path newTmpFile() {
+    auto path =
+        tmpDir / (tmpPrefix + "_" + std::to_string(numTmpFiles++) + ".tmp");
+    tmpFiles.push_back(path);
+    return path;
+  }
+
+  void removeTmpFiles() {
+    std::error_code ec;
+    for (const auto &path : tmpFiles) {
+      std::filesystem::remove(path, ec);
+    }
+    tmpFiles.clear();
+  }
+
+  void add(const std::uint8_t *fp, const std::string &id) {
+    PRECONDITION(!df_closed, "the writer is closed");
+    // the buffers keep their capacity from one run to the next, so they
+    // only grow until they reach maxMemory
+    if (!buffer.empty() && bufferSizeAfterAdd(id.size()) > maxMemory) {
+      writeRun();
+    }
+    BufferedFP rec;
+    rec.popcount = CalcBitmapPopcount(fp, numBytes);
+    rec.seq = nextSeq++;
+    rec.dataOffset = bufferData.size();
+    rec.idOffset = bufferIds.size();
+    rec.idLength = id.size();
+    buffer.push_back(rec);
+    bufferData.insert(bufferData.end(), fp, fp + numBytes);
+    bufferIds += id;
+  }
+
+  //! sorts the buffer, keeping the fingerprints in the order they were added
+  /*!
+    Only the records are sorted, the fingerprints and ids stay where they
+    are.
+  */
+  void sortBuffer() {
+    std::sort(buffer.begin(), buffer.end(),
+              [](const BufferedFP &a, const BufferedFP &b) {
+                return std::tie(a.popcount, a.seq) <
+                       std::tie(b.popcount, b.seq);
+              });
+  }
+
+  void writeRun() {
+    if (buffer.empty()) {
+      return;
+    }
+    sortBuffer();
+    auto path = newTmpFile();
+    std::ofstream strm(path, std::ios_base::binary);
+    for (const auto &rec : buffer) {
+      streamWrite(strm, rec.popcount);
+      streamWrite(strm, rec.seq);
+      streamWrite(strm, static_cast<std::uint32_t>(rec.idLength));
+      strm.write(bufferIds.data() + rec.idOffset, rec.idLength);
+      strm.write(reinterpret_cast<const char *>(bufferData.data()) +
+                     rec.dataOffset,
+                 numBytes);
+    }
+    strm.close();
+    if (!strm) {
+      throw BadFileException("error writing temporary file " +
+                             path.string());
+    }
+    runs.push_back(path);
+    buffer.clear();
+    bufferData.clear();
+    bufferIds.clear();
+  }
+
+  void addFPBFile(const std::string &fpbName) {
+    PRECONDITION(!df_closed, "the writer is closed");
+    FPBSource source(fpbName);
+    if (source.getNumBytes() != numBytes) {
+      throw ValueErrorException(
+          "the fingerprints in " + fpbName +
+          " do not have the same size as the ones being written");
+    }
+    if (source.isSorted()) {
+      // the file can be merged as it is
+      fpbFiles.emplace_back(fpbName, nextSeq);
+      nextSeq += source.length();
+    } else {
+      MergeRecord rec;
+      while (source.next(rec)) {
+        add(rec.fp.data(), rec.id);
+      }
+    }
+  }
+
+  //! closes the writer without writing the output file
+  void abandon() {
+    df_closed = true;
+    removeTmpFiles();
+  }
+
+  void close();
+  void merge(std::vector<std::unique_ptr<MergeSource>> &sources,
+             std::ostream &ostrm, std::ostream &idStrm,
+             std::ostream &offsetStrm, std::vector<std::uint64_t> &counts);
+};
+
+void FPBWriter_impl::merge(std::vector<std::unique_ptr<MergeSource>> &sources,
+                           std::ostream &ostrm, std::ostream &idStrm,
+                           std::ostream &offsetStrm,
+                           std::vector<std::uint64_t> &counts) {
+  using HeapItem = std::tuple<std::uint32_t, std::uint64_t, std::size_t>;
+  std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<>> heap;
+  std::vector<MergeRecord> current(sources.size());
+  for (std::size_t i = 0; i < sources.size(); ++i) {
+    if (sources[i]->next(current[i])) {
+      heap.emplace(current[i].popcount, current[i].seq, i);
+    }
+  }
+
+  unsigned int storageSize =
+      (numBytes + arenaAlignment - 1) / arenaAlignment * arenaAlignment;
+  const std::string padding(storageSize - numBytes, '\0');
+  std::uint64_t idOffset = idHeaderSize;
+  streamWrite(offsetStrm, idOffset);
+  while (!heap.empty()) {
+    auto idx = std::get<2>(heap.top());
+    heap.pop();
+    auto &rec = current[idx];
+    ostrm.write(reinterpret_cast<const char *>(rec.fp.data()), numBytes);
+    ostrm.write(padding.data(), padding.size());
+    idStrm.write(rec.id.data(), rec.id.size());
+    idOffset += rec.id.size();
+    streamWrite(offsetStrm, idOffset);
+    ++counts[rec.popcount];
+    if (sources[idx]->next(rec)) {
+      heap.emplace(rec.popcount, rec.seq, idx);
+    }
+  }
+}
+
+void FPBWriter_impl::close() {
+  if (df_closed) {
+    return;
+  }
+  df_closed = true;
+
+  bool outputCreated = false;
+  try {
+    std::vector<std::unique_ptr<MergeSource>> sources;
+    for (const auto &run : runs) {
+      sources.emplace_back(new RunSource(run, numBytes));
+    }
+    for (const auto &[fpbName, firstSeq] : fpbFiles) {
+      sources.emplace_back(new FPBSource(fpbName, firstSeq));
+    }
+    std::uint64_t length = nextSeq;
+    sortBuffer();
+    sources.emplace_back(
+        new MemorySource(buffer, bufferData, bufferIds, numBytes));
+
+    std::ofstream ostrm(fname, std::ios_base::binary);
+    if (!ostrm) {
+      throw BadFileException("Bad output file " + fname);
+    }
+    // from here on a failure leaves a partial file, which is removed below
+    outputCreated = true;
+    ostrm.write(FPB_MAGIC.data(), FPB_MAGIC.size());
+
+    std::ostringstream meta;
+    meta << "#num_bits=" << nBits << "\n";
+    meta << "#software=RDKit/" << rdkitVersion << "\n";
+    writeChunkHeader(ostrm, "META", meta.str().size());
+    ostrm << meta.str();
+
+    // the arena
+    unsigned int storageSize =
+        (numBytes + arenaAlignment - 1) / arenaAlignment * arenaAlignment;
+    std::uint64_t dataStart =
+        static_cast<std::uint64_t>(ostrm.tellp()) + 12 + 9;
+    std::uint8_t spacer = (arenaAlignment - dataStart % arenaAlignment) %
+                          arenaAlignment;
+    writeChunkHeader(ostrm, "AREN", 9 + spacer + length * storageSize);
+    streamWrite(ostrm, static_cast<std::uint32_t>(numBytes));
+    streamWrite(ostrm, static_cast<std::uint32_t>(storageSize));
+    streamWrite(ostrm, spacer);
+    ostrm.write(std::string(spacer, '\0').data(), spacer);
+
+    // the ids and their offsets come after the arena, so they are collected
+    // in temporary files
+    auto idPath = newTmpFile();
+    auto offsetPath = newTmpFile();
+    std::vector<std::uint64_t> counts(numBytes * 8 + 1, 0);
+    {
+      std::ofstream idStrm(idPath, std::ios_base::binary);
+      std::ofstream offsetStrm(offsetPath, std::ios_base::binary);
+      merge(sources, ostrm, idStrm, offsetStrm, counts);
+      if (!idStrm || !offsetStrm) {
+        throw BadFileException("error writing temporary files");
+      }
+    }
+    sources.clear();
+
+    // the popcount index
+    writeChunkHeader(ostrm, "POPC", (counts.size() + 1) * 4);
+    std::uint32_t offset = 0;
+    for (auto count : counts) {
+      streamWrite(ostrm, offset);
+      offset += count;
+    }
+    streamWrite(ostrm, offset);
+
+    // the ids, followed by the table of offsets. The offsets which don't fit
+    // in 4 bytes are stored as 8 byte values at the end of the table
+    std::uint64_t idsSize = std::filesystem::file_size(idPath);
+    std::uint64_t num4ByteElements = length;
+    if (idHeaderSize + idsSize > std::numeric_limits<std::uint32_t>::max()) {
+      std::ifstream offsetStrm(offsetPath, std::ios_base::binary);
+      for (std::uint64_t i = 0; i <= length; ++i) {
+        std::uint64_t val;
+        streamRead(offsetStrm, val);
+        if (val > std::numeric_limits<std::uint32_t>::max()) {
+          num4ByteElements = i - 1;
+          break;
+        }
+      }
+    }
+    std::uint64_t num8ByteElements = length - num4ByteElements;
+    writeChunkHeader(ostrm, "FPID",
+                     idHeaderSize + idsSize + (num4ByteElements + 1) * 4 +
+                         num8ByteElements * 8);
+    streamWrite(ostrm, static_cast<std::uint32_t>(num4ByteElements));
+    streamWrite(ostrm, static_cast<std::uint32_t>(num8ByteElements));
+    {
+      std::ifstream idStrm(idPath, std::ios_base::binary);
+      copyStream(idStrm, ostrm);
+    }
+    {
+      std::ifstream offsetStrm(offsetPath, std::ios_base::binary);
+      for (std::uint64_t i = 0; i <= length; ++i) {
+        std::uint64_t val;
+        streamRead(offsetStrm, val);
+        if (i <= num4ByteElements) {
+          streamWrite(ostrm, static_cast<std::uint32_t>(val));
+        } else {
+          streamWrite(ostrm, val);
+        }
+      }
+    }
+
+    writeChunkHeader(ostrm, "FEND", 0);
+    ostrm.close();
+    if (!ostrm) {
+      throw BadFileException("error writing " + fname);
+    }
+  } catch (...) {
+    removeTmpFiles();
+    if (outputCreated) {
+      std::error_code ec;
+      std::filesystem::remove(fname, ec);
+    }
+    throw;
+  }
+  removeTmpFiles();
+}
+}  // namespace detail
+
+FPBWriter::FPBWriter(const std::string &fname, unsigned int nBits,
+                     std::size_t maxMemory, const std::string &tmpDir)
+    : dp_impl(new detail::FPBWriter_impl) {
+  PRECONDITION(nBits > 0, "the fingerprints must have at least one bit");
+  dp_impl->fname = fname;
+  dp_impl->nBits = nBits;
+  dp_impl->numBytes = (nBits + 7) / 8;
+  dp_impl->maxMemory = maxMemory;
+  dp_impl->tmpDir = tmpDir.empty() ? std::filesystem::temp_directory_path()
+                                   : std::filesystem::path(tmpDir);
+  std::random_device rd;
+  std::ostringstream prefix;
+  prefix << "rdkit_fpb_" << std::hex << rd() << rd();
+  dp_impl->tmpPrefix = prefix.str();
+}
+
+FPBWriter::~FPBWriter() {
+  // a writer destroyed by an exception may not have been given all of its
+  // fingerprints, so don't write a file which looks complete
+  if (std::uncaught_exceptions() > dp_impl->numUncaughtExceptions) {
+    dp_impl->abandon();
+    return;
+  }
+  try {
+    close();
+  } catch (const std::exception &e) {
+    BOOST_LOG(rdErrorLog) << "error closing FPBWriter: " << e.what()
+                          << std::endl;
+  }
+}
+
+void FPBWriter::write(const ExplicitBitVect &fp, const std::string &id) {
+  if (fp.getNumBits() != dp_impl->nBits) {
+    throw ValueErrorException(
+        "the fingerprint does not have the size the writer was created with");
+  }
+  auto bytes = BitVectToBinaryText(fp);
+  dp_impl->add(reinterpret_cast<const std::uint8_t *>(bytes.data()), id);
+}
+
+void FPBWriter::write(const std::uint8_t *fp, const std::string &id) {
+  PRECONDITION(fp, "bad fingerprint pointer");
+  dp_impl->add(fp, id);
+}
+
+void FPBWriter::addFPBFile(const std::string &fname) {
+  dp_impl->addFPBFile(fname);
+}
+
+void FPBWriter::close() { dp_impl->close(); }
+
+std::uint64_t FPBWriter::length() const { return dp_impl->nextSeq; }
+unsigned int FPBWriter::nBits() const { return dp_impl->nBits; }
+unsigned int FPBWriter::getNumBytes() const { return dp_impl->numBytes; }
+unsigned int FPBWriter::getNumRuns() const { return dp_impl->runs.size(); }
+
+void FPBWriter::mergeFPBFiles(const std::vector<std::string> &inputs,
+                              const std::string &output) {
+  PRECONDITION(!inputs.empty(), "no input files");
+  detail::FPBSource first(inputs[0]);
+  FPBWriter writer(output, first.getNumBytes() * 8);
+  for (const auto &input : inputs) {
+    writer.addFPBFile(input);
+  }
+  writer.close();
+}
+}  // namespace RDKit
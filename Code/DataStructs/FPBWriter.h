@@ -0,0 +1,119 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//  @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include <RDGeneral/export.h>
+#ifndef RD_FPBWRITER_H
+#define RD_FPBWRITER_H
+/*! \file FPBWriter.h
+
+  \brief contains a class for writing FPB files
+
+  \b Note that this functionality is experimental and the API may change
+     in future releases.
+*/
+
+#include <DataStructs/ExplicitBitVect.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace RDKit {
+namespace detail {
+struct FPBWriter_impl;
+}
+
+//! class for writing FPB files
+/*!
+  The fingerprints in an FPB file are sorted by the number of bits they
+  have set, which is what allows FPBReader to skip most of them in
+  similarity searches. The writer sorts the fingerprints with an external
+  merge sort: they are collected in memory until \c maxMemory bytes are
+  used, and then sorted and written to a temporary file (a run). When the
+  writer is closed the runs are merged into the output file.
+
+  The contents of existing FPB files can be added with addFPBFile(). These
+  are already sorted, so they are merged in directly and read sequentially,
+  without being loaded into memory. This allows adding new fingerprints to
+  an existing file without regenerating it:
+  \code
+  FPBWriter writer("updated.fpb", 2048);
+  writer.addFPBFile("current.fpb");
+  for (...) {
+    writer.write(*fp, id);
+  }
+  writer.close();
+  \endcode
+
+  Fingerprints with the same number of bits set are written in the order
+  they were added, with the contents of an FPB file counting as added when
+  addFPBFile() was called.
+
+  \b Note: this functionality is experimental and the API may change
+     in future releases.
+*/
+class RDKIT_DATASTRUCTS_EXPORT FPBWriter {
+ public:
+  //! ctor
+  /*!
+  \param fname     the name of the file to write
+  \param nBits     the number of bits in the fingerprints
+  \param maxMemory the approximate number of bytes used to hold fingerprints
+                   before they are written to a temporary file
+  \param tmpDir    the directory for the temporary files, if empty the
+                   system's temporary directory is used
+  */
+  FPBWriter(const std::string &fname, unsigned int nBits,
+            std::size_t maxMemory = 256 * 1024 * 1024,
+            const std::string &tmpDir = "");
+  //! closes the writer if that was not already done
+  /*!
+    If the writer is destroyed while an exception is propagating, the output
+    file is not written and the temporary files are removed.
+  */
+  ~FPBWriter();
+  FPBWriter(const FPBWriter &) = delete;
+  FPBWriter &operator=(const FPBWriter &) = delete;
+
+  //! adds a fingerprint
+  void write(const ExplicitBitVect &fp, const std::string &id);
+  //! adds a fingerprint stored as an array of getNumBytes() bytes
+  void write(const std::uint8_t *fp, const std::string &id);
+  //! adds the contents of an existing FPB file
+  /*!
+    The file is only read when the writer is closed, so it must not be
+    modified before that. In particular, it can't be the file that is being
+    written.
+  */
+  void addFPBFile(const std::string &fname);
+
+  //! sorts the fingerprints and writes the output file
+  /*!
+    The temporary files are removed. Nothing can be added after this is
+    called. If writing the output file fails, the partial file is removed.
+  */
+  void close();
+
+  //! returns the number of fingerprints added
+  std::uint64_t length() const;
+  unsigned int nBits() const;
+  unsigned int getNumBytes() const;
+  //! returns the number of runs written to temporary files so far
+  unsigned int getNumRuns() const;
+
+  //! writes a new FPB file with the contents of the input FPB files
+  static void mergeFPBFiles(const std::vector<std::string> &inputs,
+                            const std::string &output);
+
+ private:
+  std::unique_ptr<detail::FPBWriter_impl> dp_impl;
+};
+}  // namespace RDKit
+#endif
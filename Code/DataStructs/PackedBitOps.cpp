@@ -0,0 +1,705 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include "PackedBitOps.h"
+#include "ExplicitBitVect.h"
+#include <RDGeneral/Exceptions.h>
+#include <RDGeneral/Invariant.h>
+#include <RDGeneral/RDThreads.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#ifdef RDK_BUILD_THREADSAFE_SSS
+#include <future>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define RDK_PACKEDBITOPS_X86
+#include <immintrin.h>
+#endif
+
+namespace PackedBitOps {
+
+namespace {
+SIMDLevel detectSIMDLevel() {
+#ifdef RDK_PACKEDBITOPS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return SIMDLevel::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return SIMDLevel::AVX2;
+  }
+#endif
+  return SIMDLevel::Scalar;
+}
+
+bool detectVPOPCNTDQ() {
+#ifdef RDK_PACKEDBITOPS_X86
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512vpopcntdq");
+#else
+  return false;
+#endif
+}
+
+std::atomic<int> maxSIMDLevel{static_cast<int>(SIMDLevel::AVX512)};
+
+// the words of the probe which have bits set, rows only need to be
+// checked there
+std::vector<unsigned int> getProbeWords(const std::uint64_t *probe,
+                                        unsigned int numWords) {
+  std::vector<unsigned int> res;
+  for (unsigned int w = 0; w < numWords; ++w) {
+    if (probe[w]) {
+      res.push_back(w);
+    }
+  }
+  return res;
+}
+
+// the row screened at position i of a block: the rows are either
+// consecutive or given by rowIndices
+inline const std::uint64_t *getBlockRow(const std::uint64_t *rows,
+                                        std::size_t rowStride,
+                                        const std::uint32_t *rowIndices,
+                                        unsigned int i) {
+  return rows + (rowIndices ? rowIndices[i] : i) * rowStride;
+}
+
+void bulkAllProbeBitsMatchScalar(const std::uint64_t *probe,
+                                 const std::uint64_t *rows,
+                                 unsigned int numWords, std::size_t rowStride,
+                                 const std::uint32_t *rowIndices,
+                                 unsigned int numRows, std::uint64_t *result) {
+  const auto probeWords = getProbeWords(probe, numWords);
+  std::uint64_t resWord = 0;
+  for (unsigned int i = 0; i < numRows; ++i) {
+    const auto row = getBlockRow(rows, rowStride, rowIndices, i);
+    bool passes = true;
+    for (auto w : probeWords) {
+      if (probe[w] & ~row[w]) {
+        passes = false;
+        break;
+      }
+    }
+    if (passes) {
+      resWord |= std::uint64_t(1) << (i % 64);
+    }
+    if (i % 64 == 63) {
+      result[i / 64] = resWord;
+      resWord = 0;
+    }
+  }
+  if (numRows % 64) {
+    result[numRows / 64] = resWord;
+  }
+}
+
+// the scalar popcount loops are compiled twice: once for the baseline
+// architecture and, on x86, once using the popcnt instruction
+#if defined(__GNUC__) || defined(__clang__)
+#define RDK_PACKEDBITOPS_INLINE inline __attribute__((always_inline))
+#else
+#define RDK_PACKEDBITOPS_INLINE inline
+#endif
+
+RDK_PACKEDBITOPS_INLINE void bulkPopcountsImpl(const std::uint64_t *rows,
+                                               unsigned int numWords,
+                                               std::size_t rowStride,
+                                               unsigned int numRows,
+                                               std::uint32_t *counts) {
+  for (unsigned int i = 0; i < numRows; ++i, rows += rowStride) {
+    std::uint32_t count = 0;
+    for (unsigned int w = 0; w < numWords; ++w) {
+      count += std::popcount(rows[w]);
+    }
+    counts[i] = count;
+  }
+}
+
+RDK_PACKEDBITOPS_INLINE void bulkIntersectionPopcountsImpl(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride, unsigned int numRows,
+    std::uint32_t *counts) {
+  for (unsigned int i = 0; i < numRows; ++i, rows += rowStride) {
+    std::uint32_t count = 0;
+    for (unsigned int w = 0; w < numWords; ++w) {
+      count += std::popcount(probe[w] & rows[w]);
+    }
+    counts[i] = count;
+  }
+}
+
+RDK_PACKEDBITOPS_INLINE void bulkIndexedIntersectionPopcountsImpl(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride,
+    const std::uint32_t *rowIndices, unsigned int numRows,
+    std::uint32_t *counts) {
+  for (unsigned int i = 0; i < numRows; ++i) {
+    const auto row = rows + rowIndices[i] * rowStride;
+    std::uint32_t count = 0;
+    for (unsigned int w = 0; w < numWords; ++w) {
+      count += std::popcount(probe[w] & row[w]);
+    }
+    counts[i] = count;
+  }
+}
+
+void bulkPopcountsScalar(const std::uint64_t *rows, unsigned int numWords,
+                         std::size_t rowStride, unsigned int numRows,
+                         std::uint32_t *counts) {
+  bulkPopcountsImpl(rows, numWords, rowStride, numRows, counts);
+}
+
+void bulkIntersectionPopcountsScalar(const std::uint64_t *probe,
+                                     const std::uint64_t *rows,
+                                     unsigned int numWords,
+                                     std::size_t rowStride,
+                                     unsigned int numRows,
+                                     std::uint32_t *counts) {
+  bulkIntersectionPopcountsImpl(probe, rows, numWords, rowStride, numRows,
+                                counts);
+}
+
+void bulkIndexedIntersectionPopcountsScalar(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride,
+    const std::uint32_t *rowIndices, unsigned int numRows,
+    std::uint32_t *counts) {
+  bulkIndexedIntersectionPopcountsImpl(probe, rows, numWords, rowStride,
+                                       rowIndices, numRows, counts);
+}
+
+#ifdef RDK_PACKEDBITOPS_X86
+__attribute__((target("popcnt"))) void bulkPopcountsPOPCNT(
+    const std::uint64_t *rows, unsigned int numWords, std::size_t rowStride,
+    unsigned int numRows, std::uint32_t *counts) {
+  bulkPopcountsImpl(rows, numWords, rowStride, numRows, counts);
+}
+
+__attribute__((target("popcnt"))) void bulkIntersectionPopcountsPOPCNT(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride, unsigned int numRows,
+    std::uint32_t *counts) {
+  bulkIntersectionPopcountsImpl(probe, rows, numWords, rowStride, numRows,
+                                counts);
+}
+
+__attribute__((target("popcnt"))) void bulkIndexedIntersectionPopcountsPOPCNT(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride,
+    const std::uint32_t *rowIndices, unsigned int numRows,
+    std::uint32_t *counts) {
+  bulkIndexedIntersectionPopcountsImpl(probe, rows, numWords, rowStride,
+                                       rowIndices, numRows, counts);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) void bulkPopcountsAVX512(
+    const std::uint64_t *rows, unsigned int numWords, std::size_t rowStride,
+    unsigned int numRows, std::uint32_t *counts) {
+  const unsigned int numVecWords = numWords - numWords % 8;
+  const __mmask8 tailMask = (1u << (numWords % 8)) - 1;
+  for (unsigned int i = 0; i < numRows; ++i, rows += rowStride) {
+    __m512i acc = _mm512_setzero_si512();
+    for (unsigned int w = 0; w < numVecWords; w += 8) {
+      const __m512i v = _mm512_loadu_si512(rows + w);
+      acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    if (tailMask) {
+      const __m512i v = _mm512_maskz_loadu_epi64(tailMask, rows + numVecWords);
+      acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    counts[i] = static_cast<std::uint32_t>(_mm512_reduce_add_epi64(acc));
+  }
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) void
+bulkIntersectionPopcountsAVX512(const std::uint64_t *probe,
+                                const std::uint64_t *rows,
+                                unsigned int numWords, std::size_t rowStride,
+                                unsigned int numRows, std::uint32_t *counts) {
+  const unsigned int numVecWords = numWords - numWords % 8;
+  const __mmask8 tailMask = (1u << (numWords % 8)) - 1;
+  const __m512i pTail =
+      _mm512_maskz_loadu_epi64(tailMask, probe + numVecWords);
+  for (unsigned int i = 0; i < numRows; ++i, rows += rowStride) {
+    __m512i acc = _mm512_setzero_si512();
+    for (unsigned int w = 0; w < numVecWords; w += 8) {
+      const __m512i v = _mm512_and_si512(_mm512_loadu_si512(probe + w),
+                                         _mm512_loadu_si512(rows + w));
+      acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    if (tailMask) {
+      const __m512i v = _mm512_and_si512(
+          pTail, _mm512_maskz_loadu_epi64(tailMask, rows + numVecWords));
+      acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    counts[i] = static_cast<std::uint32_t>(_mm512_reduce_add_epi64(acc));
+  }
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) void
+bulkIndexedIntersectionPopcountsAVX512(const std::uint64_t *probe,
+                                       const std::uint64_t *rows,
+                                       unsigned int numWords,
+                                       std::size_t rowStride,
+                                       const std::uint32_t *rowIndices,
+                                       unsigned int numRows,
+                                       std::uint32_t *counts) {
+  const unsigned int numVecWords = numWords - numWords % 8;
+  const __mmask8 tailMask = (1u << (numWords % 8)) - 1;
+  const __m512i pTail =
+      _mm512_maskz_loadu_epi64(tailMask, probe + numVecWords);
+  for (unsigned int i = 0; i < numRows; ++i) {
+    const auto row = rows + rowIndices[i] * rowStride;
+    __m512i acc = _mm512_setzero_si512();
+    for (unsigned int w = 0; w < numVecWords; w += 8) {
+      const __m512i v = _mm512_and_si512(_mm512_loadu_si512(probe + w),
+                                         _mm512_loadu_si512(row + w));
+      acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    if (tailMask) {
+      const __m512i v = _mm512_and_si512(
+          pTail, _mm512_maskz_loadu_epi64(tailMask, row + numVecWords));
+      acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    counts[i] = static_cast<std::uint32_t>(_mm512_reduce_add_epi64(acc));
+  }
+}
+
+__attribute__((target("avx2"))) void bulkAllProbeBitsMatchAVX2(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride,
+    const std::uint32_t *rowIndices, unsigned int numRows,
+    std::uint64_t *result) {
+  const unsigned int numVecWords = numWords - numWords % 4;
+  std::uint64_t resWord = 0;
+  for (unsigned int i = 0; i < numRows; ++i) {
+    const auto row = getBlockRow(rows, rowStride, rowIndices, i);
+    // accumulate the probe bits missing from the row
+    __m256i missing = _mm256_setzero_si256();
+    unsigned int w = 0;
+    for (; w < numVecWords; w += 4) {
+      const __m256i p =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(probe + w));
+      const __m256i r =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + w));
+      missing = _mm256_or_si256(missing, _mm256_andnot_si256(r, p));
+    }
+    bool passes = _mm256_testz_si256(missing, missing);
+    for (; passes && w < numWords; ++w) {
+      passes = !(probe[w] & ~row[w]);
+    }
+    if (passes) {
+      resWord |= std::uint64_t(1) << (i % 64);
+    }
+    if (i % 64 == 63) {
+      result[i / 64] = resWord;
+      resWord = 0;
+    }
+  }
+  if (numRows % 64) {
+    result[numRows / 64] = resWord;
+  }
+}
+
+__attribute__((target("avx512f"))) void bulkAllProbeBitsMatchAVX512(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride,
+    const std::uint32_t *rowIndices, unsigned int numRows,
+    std::uint64_t *result) {
+  const unsigned int numVecWords = numWords - numWords % 8;
+  const __mmask8 tailMask = (1u << (numWords % 8)) - 1;
+  const __m512i pTail =
+      _mm512_maskz_loadu_epi64(tailMask, probe + numVecWords);
+  std::uint64_t resWord = 0;
+  for (unsigned int i = 0; i < numRows; ++i) {
+    const auto row = getBlockRow(rows, rowStride, rowIndices, i);
+    // accumulate the probe bits missing from the row
+    __m512i missing = _mm512_setzero_si512();
+    for (unsigned int w = 0; w < numVecWords; w += 8) {
+      const __m512i p = _mm512_loadu_si512(probe + w);
+      const __m512i r = _mm512_loadu_si512(row + w);
+      missing = _mm512_or_si512(missing, _mm512_andnot_si512(r, p));
+    }
+    if (tailMask) {
+      const __m512i r = _mm512_maskz_loadu_epi64(tailMask, row + numVecWords);
+      missing = _mm512_or_si512(missing, _mm512_andnot_si512(r, pTail));
+    }
+    if (!_mm512_test_epi64_mask(missing, missing)) {
+      resWord |= std::uint64_t(1) << (i % 64);
+    }
+    if (i % 64 == 63) {
+      result[i / 64] = resWord;
+      resWord = 0;
+    }
+  }
+  if (numRows % 64) {
+    result[numRows / 64] = resWord;
+  }
+}
+#endif
+}  // namespace
+
+SIMDLevel getSIMDLevel() {
+  static const SIMDLevel detected = detectSIMDLevel();
+  return static_cast<SIMDLevel>(
+      std::min(static_cast<int>(detected), maxSIMDLevel.load()));
+}
+
+namespace {
+// the popcount kernels need the VPOPCNTDQ extension of AVX-512
+SIMDLevel getPopcountLevel() {
+  static const bool hasVPOPCNTDQ = detectVPOPCNTDQ();
+  auto level = getSIMDLevel();
+  if (level == SIMDLevel::AVX512 && !hasVPOPCNTDQ) {
+    level = SIMDLevel::AVX2;
+  }
+  return level;
+}
+}  // namespace
+
+void setMaxSIMDLevel(SIMDLevel level) {
+  maxSIMDLevel = static_cast<int>(level);
+}
+
+void packBitVect(const ExplicitBitVect &bv, std::uint64_t *words) {
+  std::fill(words, words + getNumWords(bv.getNumBits()), 0);
+  const auto &bits = *bv.dp_bits;
+  for (auto i = bits.find_first(); i != boost::dynamic_bitset<>::npos;
+       i = bits.find_next(i)) {
+    words[i / 64] |= std::uint64_t(1) << (i % 64);
+  }
+}
+
+std::vector<std::uint64_t> packBitVect(const ExplicitBitVect &bv) {
+  std::vector<std::uint64_t> res(getNumWords(bv.getNumBits()));
+  packBitVect(bv, res.data());
+  return res;
+}
+
+void bulkAllProbeBitsMatch(const std::uint64_t *probe,
+                           const std::uint64_t *rows, unsigned int numWords,
+                           std::size_t rowStride, unsigned int numRows,
+                           std::uint64_t *result) {
+  bulkAllProbeBitsMatch(probe, rows, numWords, rowStride, nullptr, numRows,
+                        result);
+}
+
+void bulkAllProbeBitsMatch(const std::uint64_t *probe,
+                           const std::uint64_t *rows, unsigned int numWords,
+                           std::size_t rowStride,
+                           const std::uint32_t *rowIndices,
+                           unsigned int numRows, std::uint64_t *result) {
+  switch (getSIMDLevel()) {
+#ifdef RDK_PACKEDBITOPS_X86
+    case SIMDLevel::AVX512:
+      bulkAllProbeBitsMatchAVX512(probe, rows, numWords, rowStride,
+                                  rowIndices, numRows, result);
+      return;
+    case SIMDLevel::AVX2:
+      bulkAllProbeBitsMatchAVX2(probe, rows, numWords, rowStride, rowIndices,
+                                numRows, result);
+      return;
+#endif
+    default:
+      bulkAllProbeBitsMatchScalar(probe, rows, numWords, rowStride,
+                                  rowIndices, numRows, result);
+  }
+}
+
+void bulkPopcounts(const std::uint64_t *rows, unsigned int numWords,
+                   std::size_t rowStride, unsigned int numRows,
+                   std::uint32_t *counts) {
+  switch (getPopcountLevel()) {
+#ifdef RDK_PACKEDBITOPS_X86
+    case SIMDLevel::AVX512:
+      bulkPopcountsAVX512(rows, numWords, rowStride, numRows, counts);
+      return;
+    case SIMDLevel::AVX2:
+      bulkPopcountsPOPCNT(rows, numWords, rowStride, numRows, counts);
+      return;
+#endif
+    default:
+      bulkPopcountsScalar(rows, numWords, rowStride, numRows, counts);
+  }
+}
+
+void bulkIntersectionPopcounts(const std::uint64_t *probe,
+                               const std::uint64_t *rows,
+                               unsigned int numWords, std::size_t rowStride,
+                               unsigned int numRows, std::uint32_t *counts) {
+  switch (getPopcountLevel()) {
+#ifdef RDK_PACKEDBITOPS_X86
+    case SIMDLevel::AVX512:
+      bulkIntersectionPopcountsAVX512(probe, rows, numWords, rowStride,
+                                      numRows, counts);
+      return;
+    case SIMDLevel::AVX2:
+      bulkIntersectionPopcountsPOPCNT(probe, rows, numWords, rowStride,
+                                      numRows, counts);
+      return;
+#endif
+    default:
+      bulkIntersectionPopcountsScalar(probe, rows, numWords, rowStride,
+                                      numRows, counts);
+  }
+}
+
+PackedFingerprints::PackedFingerprints(
+    const std::vector<const ExplicitBitVect *> &bvs)
+    : PackedFingerprints(bvs.empty() ? 0 : bvs.front()->getNumBits()) {
+  reserve(static_cast<unsigned int>(bvs.size()));
+  for (const auto bv : bvs) {
+    PRECONDITION(bv, "null bit vector");
+    append(*bv);
+  }
+}
+
+PackedFingerprints::PackedFingerprints(const std::vector<ExplicitBitVect> &bvs)
+    : PackedFingerprints(bvs.empty() ? 0 : bvs.front().getNumBits()) {
+  reserve(static_cast<unsigned int>(bvs.size()));
+  for (const auto &bv : bvs) {
+    append(bv);
+  }
+}
+
+void PackedFingerprints::append(const ExplicitBitVect &bv) {
+  if (bv.getNumBits() != d_numBits) {
+    throw ValueErrorException("BitVects must be same length");
+  }
+  auto start = d_words.size();
+  d_words.resize(start + d_numWords);
+  packBitVect(bv, d_words.data() + start);
+  d_popcounts.push_back(bv.getNumOnBits());
+}
+
+void PackedFingerprints::append(const std::uint64_t *words) {
+  PRECONDITION(words, "no words");
+  d_words.insert(d_words.end(), words, words + d_numWords);
+  std::uint32_t count;
+  bulkPopcounts(words, d_numWords, d_numWords, 1, &count);
+  d_popcounts.push_back(count);
+}
+
+void PackedFingerprints::reserve(unsigned int numFps) {
+  d_words.reserve(static_cast<std::size_t>(numFps) * d_numWords);
+  d_popcounts.reserve(numFps);
+}
+
+void bulkIntersectionPopcounts(const std::uint64_t *probe,
+                               const std::uint64_t *rows,
+                               unsigned int numWords, std::size_t rowStride,
+                               const std::uint32_t *rowIndices,
+                               unsigned int numRows, std::uint32_t *counts) {
+  switch (getPopcountLevel()) {
+#ifdef RDK_PACKEDBITOPS_X86
+    case SIMDLevel::AVX512:
+      bulkIndexedIntersectionPopcountsAVX512(probe, rows, numWords, rowStride,
+                                             rowIndices, numRows, counts);
+      return;
+    case SIMDLevel::AVX2:
+      bulkIndexedIntersectionPopcountsPOPCNT(probe, rows, numWords, rowStride,
+                                             rowIndices, numRows, counts);
+      return;
+#endif
+    default:
+      bulkIndexedIntersectionPopcountsScalar(probe, rows, numWords, rowStride,
+                                             rowIndices, numRows, counts);
+  }
+}
+
+namespace {
+// these match the definitions in BitOps.cpp
+struct SimilarityFunctor {
+  SimilarityMetric metric;
+  double a;
+  double b;
+  double operator()(std::uint32_t common, std::uint32_t count1,
+                    std::uint32_t count2) const {
+    switch (metric) {
+      case SimilarityMetric::Tanimoto: {
+        auto total = count1 + count2;
+        return total ? static_cast<double>(common) / (total - common) : 0.0;
+      }
+      case SimilarityMetric::Dice: {
+        auto total = count1 + count2;
+        return total ? 2.0 * common / total : 0.0;
+      }
+      case SimilarityMetric::Tversky: {
+        if (!count1 || !count2) {
+          return 0.0;
+        }
+        double denom = a * count1 + b * count2 + (1 - a - b) * common;
+        return denom == 0.0 ? 1.0 : common / denom;
+      }
+      case SimilarityMetric::Cosine: {
+        double prod = static_cast<double>(count1) * count2;
+        return prod > 0.0 ? common / std::sqrt(prod) : 0.0;
+      }
+    }
+    return 0.0;
+  }
+};
+
+// number of rows of the first set handled at a time
+const unsigned int rowTileSize = 32;
+
+// number of rows of the second set compared at a time, chosen so that they
+// fit in the L2 cache
+unsigned int getColumnTileSize(unsigned int numWords) {
+  return std::max(64u, (128u * 1024u / 8u) / std::max(1u, numWords));
+}
+
+// calls func(rowStart, rowEnd, tileIdx) for tiles of rows of the first
+// set, distributed over the threads
+template <typename Func>
+void forEachRowTile(unsigned int numRows, int numThreads, Func func) {
+  const unsigned int numTiles = (numRows + rowTileSize - 1) / rowTileSize;
+  auto worker = [&](std::atomic<unsigned int> *nextTile) {
+    for (auto tile = (*nextTile)++; tile < numTiles; tile = (*nextTile)++) {
+      func(tile * rowTileSize, std::min(numRows, (tile + 1) * rowTileSize),
+           tile);
+    }
+  };
+  std::atomic<unsigned int> nextTile{0};
+  auto nThreads = std::min(RDKit::getNumThreadsToUse(numThreads), numTiles);
+#ifdef RDK_BUILD_THREADSAFE_SSS
+  if (nThreads > 1) {
+    std::vector<std::future<void>> tg;
+    for (unsigned int tid = 0; tid < nThreads; ++tid) {
+      tg.emplace_back(std::async(std::launch::async, worker, &nextTile));
+    }
+    for (auto &fut : tg) {
+      fut.get();
+    }
+    return;
+  }
+#endif
+  RDUNUSED_PARAM(nThreads);
+  worker(&nextTile);
+}
+
+// calls func(row, col, similarity) for every pair, the columns of each
+// row are visited in increasing order
+template <typename Func>
+void forEachSimilarity(const PackedFingerprints &fps1,
+                       const PackedFingerprints &fps2,
+                       const SimilarityFunctor &simFunc, unsigned int rowStart,
+                       unsigned int rowEnd, Func func) {
+  const auto numWords = fps1.getNumWords();
+  const auto colTileSize = getColumnTileSize(numWords);
+  std::vector<std::uint32_t> common(colTileSize);
+  for (auto colStart = 0u; colStart < fps2.size(); colStart += colTileSize) {
+    auto numCols = std::min(colTileSize, fps2.size() - colStart);
+    for (auto row = rowStart; row < rowEnd; ++row) {
+      bulkIntersectionPopcounts(fps1.getRow(row), fps2.getRow(colStart),
+                                numWords, numWords, numCols, common.data());
+      const auto count1 = fps1.getPopcount(row);
+      for (auto j = 0u; j < numCols; ++j) {
+        auto col = colStart + j;
+        func(row, col, simFunc(common[j], count1, fps2.getPopcount(col)));
+      }
+    }
+  }
+}
+
+void checkMatrixArgs(const PackedFingerprints &fps1,
+                     const PackedFingerprints &fps2, SimilarityMetric metric,
+                     double tverskyA, double tverskyB) {
+  if (fps1.getNumBits() != fps2.getNumBits()) {
+    throw ValueErrorException("BitVects must be same length");
+  }
+  if (metric == SimilarityMetric::Tversky) {
+    RANGE_CHECK(0, tverskyA, 1);
+    RANGE_CHECK(0, tverskyB, 1);
+  }
+}
+}  // namespace
+
+void calcSimilarityMatrix(const PackedFingerprints &fps1,
+                          const PackedFingerprints &fps2,
+                          std::vector<float> &res, SimilarityMetric metric,
+                          double tverskyA, double tverskyB, int numThreads) {
+  checkMatrixArgs(fps1, fps2, metric, tverskyA, tverskyB);
+  const std::size_t numCols = fps2.size();
+  res.resize(fps1.size() * numCols);
+  const SimilarityFunctor simFunc{metric, tverskyA, tverskyB};
+  float *resData = res.data();
+  forEachRowTile(fps1.size(), numThreads,
+                 [&](unsigned int rowStart, unsigned int rowEnd, unsigned int) {
+                   forEachSimilarity(
+                       fps1, fps2, simFunc, rowStart, rowEnd,
+                       [resData, numCols](unsigned int row, unsigned int col,
+                                          double sim) {
+                         resData[row * numCols + col] = static_cast<float>(sim);
+                       });
+                 });
+}
+
+void calcSparseSimilarityMatrix(const PackedFingerprints &fps1,
+                                const PackedFingerprints &fps2,
+                                double threshold, SparseSimilarityMatrix &res,
+                                SimilarityMetric metric, double tverskyA,
+                                double tverskyB, int numThreads) {
+  checkMatrixArgs(fps1, fps2, metric, tverskyA, tverskyB);
+  const SimilarityFunctor simFunc{metric, tverskyA, tverskyB};
+  // each tile of rows is collected separately and the tiles are
+  // concatenated at the end
+  struct TileResult {
+    std::vector<std::vector<std::pair<unsigned int, float>>> rows;
+  };
+  std::vector<TileResult> tiles((fps1.size() + rowTileSize - 1) /
+                                rowTileSize);
+  forEachRowTile(
+      fps1.size(), numThreads,
+      [&](unsigned int rowStart, unsigned int rowEnd, unsigned int tileIdx) {
+        auto &tileRows = tiles[tileIdx].rows;
+        tileRows.resize(rowEnd - rowStart);
+        forEachSimilarity(fps1, fps2, simFunc, rowStart, rowEnd,
+                          [&](unsigned int row, unsigned int col, double sim) {
+                            if (sim >= threshold) {
+                              tileRows[row - rowStart].emplace_back(
+                                  col, static_cast<float>(sim));
+                            }
+                          });
+      });
+
+  res.numRows = fps1.size();
+  res.numColumns = fps2.size();
+  res.rowOffsets.clear();
+  res.rowOffsets.reserve(res.numRows + 1);
+  res.rowOffsets.push_back(0);
+  std::size_t numEntries = 0;
+  for (const auto &tile : tiles) {
+    for (const auto &row : tile.rows) {
+      numEntries += row.size();
+      res.rowOffsets.push_back(numEntries);
+    }
+  }
+  res.columns.resize(numEntries);
+  res.values.resize(numEntries);
+  std::size_t pos = 0;
+  for (auto &tile : tiles) {
+    for (auto &row : tile.rows) {
+      for (const auto &entry : row) {
+        res.columns[pos] = entry.first;
+        res.values[pos] = entry.second;
+        ++pos;
+      }
+      row.clear();
+      row.shrink_to_fit();
+    }
+  }
+}
+
+}  // namespace PackedBitOps
@@ -0,0 +1,235 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include <RDGeneral/export.h>
+#ifndef RD_PACKEDBITOPS_H
+#define RD_PACKEDBITOPS_H
+/*! \file PackedBitOps.h
+
+  \brief Bulk operations on fingerprints packed into rows of 64-bit words.
+
+  A packed fingerprint of \c n bits occupies <tt>(n+63)/64</tt> words, bit
+  \c i of the fingerprint is bit <tt>i%64</tt> of word <tt>i/64</tt> and the
+  unused bits of the last word are zero. A block of fingerprints is stored
+  as consecutive rows, \c rowStride words apart.
+
+  The kernels select an AVX-512, AVX2 or scalar implementation at runtime
+  based on the capabilities of the CPU. The popcount kernels use the
+  AVX-512 VPOPCNTDQ instructions where available and the hardware popcnt
+  instruction otherwise.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ExplicitBitVect;
+
+namespace PackedBitOps {
+
+//! the instruction sets the kernels can use
+enum class SIMDLevel : int {
+  Scalar = 0,
+  AVX2 = 1,
+  AVX512 = 2
+};
+
+//! returns the instruction set the kernels currently use
+RDKIT_DATASTRUCTS_EXPORT SIMDLevel getSIMDLevel();
+
+//! limits the instruction set the kernels use, mostly useful for testing
+/*!
+  The kernels never use instructions the CPU does not support, so setting a
+  higher level than is available has no effect.
+*/
+RDKIT_DATASTRUCTS_EXPORT void setMaxSIMDLevel(SIMDLevel level);
+
+//! returns the number of 64-bit words needed to store \c numBits bits
+inline unsigned int getNumWords(unsigned int numBits) {
+  return (numBits + 63) / 64;
+}
+
+//! packs a bit vector into \c getNumWords(bv.getNumBits()) words
+RDKIT_DATASTRUCTS_EXPORT void packBitVect(const ExplicitBitVect &bv,
+                                          std::uint64_t *words);
+//! \overload
+RDKIT_DATASTRUCTS_EXPORT std::vector<std::uint64_t> packBitVect(
+    const ExplicitBitVect &bv);
+
+//! screens a block of packed fingerprints against a probe
+/*!
+  Row \c i passes if all bits set in \c probe are also set in it, i.e. the
+  bulk equivalent of AllProbeBitsMatch(probe, row).
+
+  \param probe      the packed probe, \c numWords words
+  \param rows       the first row of the block
+  \param numWords   the number of words in each fingerprint
+  \param rowStride  the distance between the starts of consecutive rows, in
+                    words
+  \param numRows    the number of rows to screen
+  \param result     bit \c i%64 of word \c i/64 is set if row \c i passes
+                    and cleared otherwise. Must have room for
+                    <tt>(numRows+63)/64</tt> words.
+*/
+RDKIT_DATASTRUCTS_EXPORT void bulkAllProbeBitsMatch(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride, unsigned int numRows,
+    std::uint64_t *result);
+//! \overload
+/*!
+  Only the rows listed in \c rowIndices are screened: bit \c i of \c result
+  is set if row \c rowIndices[i] passes.
+*/
+RDKIT_DATASTRUCTS_EXPORT void bulkAllProbeBitsMatch(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride,
+    const std::uint32_t *rowIndices, unsigned int numRows,
+    std::uint64_t *result);
+
+//! calculates the number of bits set in each row of a block
+/*!
+  \param rows       the first row of the block
+  \param numWords   the number of words in each fingerprint
+  \param rowStride  the distance between the starts of consecutive rows, in
+                    words
+  \param numRows    the number of rows
+  \param counts     used to return the results, must have room for
+                    \c numRows values
+*/
+RDKIT_DATASTRUCTS_EXPORT void bulkPopcounts(const std::uint64_t *rows,
+                                            unsigned int numWords,
+                                            std::size_t rowStride,
+                                            unsigned int numRows,
+                                            std::uint32_t *counts);
+
+//! calculates the number of bits each row of a block has in common with a
+//! probe
+/*!
+  The parameters are as for bulkPopcounts(), \c probe has \c numWords words.
+  Together with the popcounts of the rows and the probe this is all that is
+  needed to calculate Tanimoto, Dice, Tversky or cosine similarities.
+*/
+RDKIT_DATASTRUCTS_EXPORT void bulkIntersectionPopcounts(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride, unsigned int numRows,
+    std::uint32_t *counts);
+
+//! \overload
+/*!
+  Only the rows listed in \c rowIndices are used: \c counts[i] is the number
+  of bits row \c rowIndices[i] has in common with the probe.
+*/
+RDKIT_DATASTRUCTS_EXPORT void bulkIntersectionPopcounts(
+    const std::uint64_t *probe, const std::uint64_t *rows,
+    unsigned int numWords, std::size_t rowStride,
+    const std::uint32_t *rowIndices, unsigned int numRows,
+    std::uint32_t *counts);
+
+//! a set of fingerprints packed into contiguous rows, with their popcounts
+class RDKIT_DATASTRUCTS_EXPORT PackedFingerprints {
+ public:
+  explicit PackedFingerprints(unsigned int numBits)
+      : d_numBits(numBits), d_numWords(PackedBitOps::getNumWords(numBits)) {}
+  //! packs a set of bit vectors, which must all have the same size
+  explicit PackedFingerprints(const std::vector<const ExplicitBitVect *> &bvs);
+  //! \overload
+  explicit PackedFingerprints(const std::vector<ExplicitBitVect> &bvs);
+
+  //! adds a fingerprint, throws a ValueErrorException if it has the wrong
+  //! number of bits
+  void append(const ExplicitBitVect &bv);
+  //! adds a fingerprint which is already packed into getNumWords() words
+  void append(const std::uint64_t *words);
+  void reserve(unsigned int numFps);
+
+  unsigned int size() const {
+    return static_cast<unsigned int>(d_popcounts.size());
+  }
+  unsigned int getNumBits() const { return d_numBits; }
+  unsigned int getNumWords() const { return d_numWords; }
+  //! returns the words of a fingerprint, rows are getNumWords() words apart
+  const std::uint64_t *getRow(unsigned int idx) const {
+    return d_words.data() + static_cast<std::size_t>(idx) * d_numWords;
+  }
+  std::uint32_t getPopcount(unsigned int idx) const {
+    return d_popcounts[idx];
+  }
+
+ private:
+  unsigned int d_numBits;
+  unsigned int d_numWords;
+  std::vector<std::uint64_t> d_words;
+  std::vector<std::uint32_t> d_popcounts;
+};
+
+//! the similarity metrics supported by the similarity matrix functions
+enum class SimilarityMetric : int {
+  Tanimoto = 0,
+  Dice = 1,
+  Tversky = 2,
+  Cosine = 3
+};
+
+//! a similarity matrix in compressed sparse row (CSR) format
+/*!
+  The entries of row \c i are at positions <tt>rowOffsets[i]</tt> to
+  <tt>rowOffsets[i+1]</tt> of \c columns and \c values, in order of
+  increasing column.
+*/
+struct RDKIT_DATASTRUCTS_EXPORT SparseSimilarityMatrix {
+  unsigned int numRows = 0;
+  unsigned int numColumns = 0;
+  std::vector<std::size_t> rowOffsets;
+  std::vector<unsigned int> columns;
+  std::vector<float> values;
+};
+
+//! calculates the similarities between two sets of fingerprints
+/*!
+  The calculation is tiled so that blocks of \c fps2 stay in the cache while
+  they are compared to the rows of \c fps1, and the rows of \c fps1 are
+  distributed over the threads.
+
+  \param fps1       the first set of fingerprints (the rows of the matrix)
+  \param fps2       the second set of fingerprints (the columns), must have
+                    the same number of bits as \c fps1
+  \param res        used to return the <tt>fps1.size()*fps2.size()</tt>
+                    similarities in row-major order
+  \param metric     the similarity metric
+  \param tverskyA   the Tversky \c a coefficient, weights the bits only
+                    present in the fingerprints of \c fps1
+  \param tverskyB   the Tversky \c b coefficient
+  \param numThreads the number of threads to use (more than one thread will
+                    only be used if the RDKit was built with multithread
+                    support). If set to zero, the max supported by the
+                    system will be used.
+
+  The similarities are the same as those calculated by TanimotoSimilarity(),
+  DiceSimilarity(), TverskySimilarity() and CosineSimilarity().
+*/
+RDKIT_DATASTRUCTS_EXPORT void calcSimilarityMatrix(
+    const PackedFingerprints &fps1, const PackedFingerprints &fps2,
+    std::vector<float> &res,
+    SimilarityMetric metric = SimilarityMetric::Tanimoto,
+    double tverskyA = 1.0, double tverskyB = 1.0, int numThreads = 1);
+
+//! calculates the similarities between two sets of fingerprints which are
+//! at least \c threshold
+/*!
+  The other parameters are as for calcSimilarityMatrix().
+*/
+RDKIT_DATASTRUCTS_EXPORT void calcSparseSimilarityMatrix(
+    const PackedFingerprints &fps1, const PackedFingerprints &fps2,
+    double threshold, SparseSimilarityMatrix &res,
+    SimilarityMetric metric = SimilarityMetric::Tanimoto,
+    double tverskyA = 1.0, double tverskyB = 1.0, int numThreads = 1);
+
+}  // namespace PackedBitOps
+
+#endif
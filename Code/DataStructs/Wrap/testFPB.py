@@ -1,4 +1,5 @@
 import os
+import tempfile
 import unittest
 
 from rdkit import DataStructs, RDConfig
@@ -270,6 +271,42 @@ class TestCase(unittest.TestCase):
     nbrs = mfpbr.GetTanimotoNeighbors(bytes, threshold=0.6)
     self.assertEqual(len(nbrs), 0)
 
+  def test10FPBWriter(self):
+    with tempfile.TemporaryDirectory() as tmpDir:
+      fname = os.path.join(tmpDir, 'sorted.fpb')
+      w = DataStructs.FPBWriter(fname, 2048, maxMemory=4096, tmpDir=tmpDir)
+      for i in reversed(range(50)):
+        w.Write(self.fpbr.GetFP(i), self.fpbr.GetId(i))
+      for i in reversed(range(50, len(self.fpbr))):
+        w.WriteBytes(self.fpbr.GetBytes(i), self.fpbr.GetId(i))
+      self.assertEqual(len(w), 100)
+      self.assertGreater(w.GetNumRuns(), 0)
+      with self.assertRaises(ValueError):
+        w.WriteBytes(b'\x00', 'bad')
+      w.Close()
+      self.assertEqual(sorted(os.listdir(tmpDir)), ['sorted.fpb'])
+
+      fpbr = DataStructs.FPBReader(fname)
+      fpbr.Init()
+      self.assertEqual(len(fpbr), 100)
+      counts = [fpbr.GetFP(i).GetNumOnBits() for i in range(len(fpbr))]
+      self.assertEqual(counts, sorted(counts))
+      expected = dict((self.fpbr.GetId(i), self.fpbr.GetBytes(i)) for i in range(100))
+      self.assertEqual(dict((fpbr.GetId(i), fpbr.GetBytes(i)) for i in range(100)), expected)
+
+      # merging with an existing file
+      deltaName = os.path.join(tmpDir, 'delta.fpb')
+      w = DataStructs.FPBWriter(deltaName, 2048)
+      w.Write(self.fpbr.GetFP(0), 'new')
+      w.Close()
+      mergedName = os.path.join(tmpDir, 'merged.fpb')
+      DataStructs.MergeFPBFiles([fname, deltaName], mergedName)
+      merged = DataStructs.FPBReader(mergedName)
+      merged.Init()
+      self.assertEqual(len(merged), 101)
+      self.assertEqual(merged.GetId(0), fpbr.GetId(0))
+      self.assertEqual(merged.GetId(1), 'new')
+
 
 if __name__ == '__main__':
   unittest.main()
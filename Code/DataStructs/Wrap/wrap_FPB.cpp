@@ -9,6 +9,7 @@
 //
 #include <RDBoost/Wrap.h>
 #include <DataStructs/FPBReader.h>
+#include <DataStructs/FPBWriter.h>
 #include <DataStructs/MultiFPBReader.h>
 #include <RDBoost/PySequenceHolder.h>
 #include "wrap_helpers.h"
@@ -112,6 +113,21 @@ double getTverskyHelper(const FPBReader *self, unsigned int which,
   const auto *bv = reinterpret_cast<const std::uint8_t *>(bytes.c_str());
   return self->getTversky(which, bv, ca, cb);
 }
+
+void writeBytesHelper(FPBWriter *self, const std::string &bytes,
+                      const std::string &id) {
+  if (bytes.size() != self->getNumBytes()) {
+    throw_value_error("the fingerprint does not have the expected size");
+  }
+  self->write(reinterpret_cast<const std::uint8_t *>(bytes.c_str()), id);
+}
+void mergeFPBFilesHelper(python::object inputs, const std::string &output) {
+  auto inputNames = pythonObjectToVect<std::string>(inputs);
+  if (!inputNames) {
+    throw_value_error("no input files provided");
+  }
+  FPBWriter::mergeFPBFiles(*inputNames, output);
+}
 }  // namespace
 
 struct FPB_wrapper {
@@ -201,6 +217,47 @@ struct FPB_wrapper {
              python::arg("numThreads") = 1),
             "returns indices of neighbors that contain this fingerprint (where "
             "all bits from this fingerprint are also set)");
+
+    std::string FPBWriterClassDoc =
+        "A class for writing FPB files which can be searched with FPBReader.\n\
+    The fingerprints are sorted using temporary files, so the number of\n\
+    fingerprints which can be written is not limited by the memory.\n\
+    Note that this functionality is still experimental and the API may\n\
+    change in future releases.\n";
+
+    python::class_<FPBWriter, boost::noncopyable>(
+        "FPBWriter", FPBWriterClassDoc.c_str(),
+        python::init<std::string, unsigned int,
+                     python::optional<std::size_t, std::string>>(
+            (python::arg("self"), python::arg("filename"),
+             python::arg("numBits"),
+             python::arg("maxMemory") = 256 * 1024 * 1024,
+             python::arg("tmpDir") = ""),
+            "maxMemory is the approximate number of bytes used to hold "
+            "fingerprints before they are written to a temporary file in "
+            "tmpDir"))
+        .def("Write",
+             (void (FPBWriter::*)(const ExplicitBitVect &,
+                                  const std::string &))&FPBWriter::write,
+             python::args("self", "fp", "id"), "adds a fingerprint")
+        .def("WriteBytes", &writeBytesHelper,
+             python::args("self", "bytes", "id"),
+             "adds a fingerprint provided as bytes")
+        .def("AddFPBFile", &FPBWriter::addFPBFile,
+             python::args("self", "filename"),
+             "adds the contents of an existing FPB file, which is read when "
+             "the writer is closed")
+        .def("Close", &FPBWriter::close, python::args("self"),
+             "sorts the fingerprints and writes the output file")
+        .def("__len__", &FPBWriter::length, python::args("self"))
+        .def("GetNumBits", &FPBWriter::nBits, python::args("self"),
+             "returns the number of bits in a fingerprint")
+        .def("GetNumRuns", &FPBWriter::getNumRuns, python::args("self"),
+             "returns the number of temporary files written so far");
+
+    python::def("MergeFPBFiles", &mergeFPBFilesHelper,
+                (python::arg("inputs"), python::arg("output")),
+                "writes an FPB file with the contents of the input FPB files");
   }
 };
 
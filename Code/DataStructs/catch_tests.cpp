@@ -16,7 +16,10 @@
 #include "BitVectUtils.h"
 #include "ExplicitBitVect.h"
 #include "SparseIntVect.h"
+#include "PackedBitOps.h"
+#include <functional>
 #include <limits>
+#include <random>
 
 using namespace RDKit;
 
@@ -41,4 +44,210 @@ TEST_CASE("github #9033: tversky is 1 when no bits are set") {
   CHECK(BraunBlanquetSimilarity(bv1, bv2) == 0.0);
   CHECK(RusselSimilarity(bv1, bv2) == 0.0);
   CHECK(RogotGoldbergSimilarity(bv1, bv2) == 0.0);
-}
\ No newline at end of file
+}
+TEST_CASE("bulk screening of packed fingerprints") {
+  std::mt19937 rng(0xf00d);
+  // word counts which exercise the vector loops and their tails
+  for (auto numBits : {64u, 200u, 512u, 960u, 2048u}) {
+    const auto numWords = PackedBitOps::getNumWords(numBits);
+    const unsigned int numRows = 131;
+    std::vector<ExplicitBitVect> bvs;
+    std::vector<std::uint64_t> rows;
+    for (unsigned int i = 0; i < numRows; ++i) {
+      ExplicitBitVect bv(numBits);
+      for (unsigned int j = 0; j < numBits; ++j) {
+        if (rng() % 4) {
+          bv.setBit(j);
+        }
+      }
+      auto words = PackedBitOps::packBitVect(bv);
+      REQUIRE(words.size() == numWords);
+      rows.insert(rows.end(), words.begin(), words.end());
+      bvs.push_back(std::move(bv));
+    }
+    for (unsigned int trial = 0; trial < 20; ++trial) {
+      ExplicitBitVect probe(numBits);
+      for (unsigned int j = 0; j < 1 + trial; ++j) {
+        probe.setBit(rng() % numBits);
+      }
+      auto probeWords = PackedBitOps::packBitVect(probe);
+      for (auto level :
+           {PackedBitOps::SIMDLevel::Scalar, PackedBitOps::SIMDLevel::AVX2,
+            PackedBitOps::SIMDLevel::AVX512}) {
+        PackedBitOps::setMaxSIMDLevel(level);
+        std::vector<std::uint64_t> res((numRows + 63) / 64, ~0ULL);
+        PackedBitOps::bulkAllProbeBitsMatch(probeWords.data(), rows.data(),
+                                            numWords, numWords, numRows,
+                                            res.data());
+        for (unsigned int i = 0; i < numRows; ++i) {
+          CHECK(bool(res[i / 64] >> (i % 64) & 1) ==
+                AllProbeBitsMatch(probe, bvs[i]));
+        }
+        // every third row
+        std::vector<std::uint64_t> strided(1);
+        PackedBitOps::bulkAllProbeBitsMatch(probeWords.data(), rows.data(),
+                                            numWords, 3 * numWords, 44,
+                                            strided.data());
+        for (unsigned int i = 0; i < 44; ++i) {
+          CHECK(bool(strided[0] >> i & 1) ==
+                AllProbeBitsMatch(probe, bvs[3 * i]));
+        }
+        // the rows in a scrambled order
+        std::vector<std::uint32_t> rowIndices(numRows);
+        for (unsigned int i = 0; i < numRows; ++i) {
+          rowIndices[i] = (7 * i) % numRows;
+        }
+        std::vector<std::uint64_t> indexed((numRows + 63) / 64, ~0ULL);
+        PackedBitOps::bulkAllProbeBitsMatch(
+            probeWords.data(), rows.data(), numWords, numWords,
+            rowIndices.data(), numRows, indexed.data());
+        for (unsigned int i = 0; i < numRows; ++i) {
+          CHECK(bool(indexed[i / 64] >> (i % 64) & 1) ==
+                AllProbeBitsMatch(probe, bvs[rowIndices[i]]));
+        }
+      }
+    }
+  }
+  PackedBitOps::setMaxSIMDLevel(PackedBitOps::SIMDLevel::AVX512);
+}
+
+TEST_CASE("popcounts of packed fingerprints") {
+  std::mt19937 rng(0xbeef);
+  for (auto numBits : {64u, 200u, 1024u, 2048u}) {
+    const auto numWords = PackedBitOps::getNumWords(numBits);
+    const unsigned int numRows = 37;
+    std::vector<ExplicitBitVect> bvs;
+    std::vector<std::uint64_t> rows;
+    for (unsigned int i = 0; i < numRows; ++i) {
+      ExplicitBitVect bv(numBits);
+      for (unsigned int j = 0; j < numBits; ++j) {
+        if (rng() % 3 == 0) {
+          bv.setBit(j);
+        }
+      }
+      auto words = PackedBitOps::packBitVect(bv);
+      rows.insert(rows.end(), words.begin(), words.end());
+      bvs.push_back(std::move(bv));
+    }
+    for (auto level :
+         {PackedBitOps::SIMDLevel::Scalar, PackedBitOps::SIMDLevel::AVX2,
+          PackedBitOps::SIMDLevel::AVX512}) {
+      PackedBitOps::setMaxSIMDLevel(level);
+      std::vector<std::uint32_t> counts(numRows);
+      PackedBitOps::bulkPopcounts(rows.data(), numWords, numWords, numRows,
+                                  counts.data());
+      for (unsigned int i = 0; i < numRows; ++i) {
+        CHECK(counts[i] == bvs[i].getNumOnBits());
+      }
+      PackedBitOps::bulkIntersectionPopcounts(rows.data(), rows.data(),
+                                              numWords, numWords, numRows,
+                                              counts.data());
+      for (unsigned int i = 0; i < numRows; ++i) {
+        CHECK(static_cast<int>(counts[i]) ==
+              NumOnBitsInCommon(bvs[0], bvs[i]));
+      }
+      const std::vector<std::uint32_t> rowIndices = {36, 2, 2, 17, 0, 5};
+      PackedBitOps::bulkIntersectionPopcounts(
+          rows.data() + numWords, rows.data(), numWords, numWords,
+          rowIndices.data(), rowIndices.size(), counts.data());
+      for (unsigned int i = 0; i < rowIndices.size(); ++i) {
+        CHECK(static_cast<int>(counts[i]) ==
+              NumOnBitsInCommon(bvs[1], bvs[rowIndices[i]]));
+      }
+    }
+  }
+  PackedBitOps::setMaxSIMDLevel(PackedBitOps::SIMDLevel::AVX512);
+}
+
+TEST_CASE("similarity matrices") {
+  std::mt19937 rng(0xcafe);
+  const unsigned int numBits = 320;
+  auto makeFps = [&](unsigned int n) {
+    std::vector<ExplicitBitVect> res;
+    for (unsigned int i = 0; i < n; ++i) {
+      ExplicitBitVect bv(numBits);
+      // include an empty fingerprint to check the special cases
+      if (i) {
+        auto density = 2 + rng() % 10;
+        for (unsigned int j = 0; j < numBits; ++j) {
+          if (rng() % density == 0) {
+            bv.setBit(j);
+          }
+        }
+      }
+      res.push_back(std::move(bv));
+    }
+    return res;
+  };
+  auto bvs1 = makeFps(75);
+  auto bvs2 = makeFps(700);
+  PackedBitOps::PackedFingerprints fps1(bvs1);
+  PackedBitOps::PackedFingerprints fps2(bvs2);
+  REQUIRE(fps1.size() == bvs1.size());
+  REQUIRE(fps2.size() == bvs2.size());
+  CHECK(fps2.getPopcount(3) == bvs2[3].getNumOnBits());
+
+  using Metric = PackedBitOps::SimilarityMetric;
+  std::vector<std::pair<Metric, std::function<double(const ExplicitBitVect &,
+                                                     const ExplicitBitVect &)>>>
+      metrics = {
+          {Metric::Tanimoto,
+           [](const auto &bv1, const auto &bv2) {
+             return TanimotoSimilarity(bv1, bv2);
+           }},
+          {Metric::Dice,
+           [](const auto &bv1, const auto &bv2) {
+             return DiceSimilarity(bv1, bv2);
+           }},
+          {Metric::Tversky,
+           [](const auto &bv1, const auto &bv2) {
+             return TverskySimilarity(bv1, bv2, 0.7, 0.3);
+           }},
+          {Metric::Cosine, [](const auto &bv1, const auto &bv2) {
+             return CosineSimilarity(bv1, bv2);
+           }}};
+  for (const auto &[metric, simFunc] : metrics) {
+    for (auto numThreads : {1, 4}) {
+      std::vector<float> dense;
+      PackedBitOps::calcSimilarityMatrix(fps1, fps2, dense, metric, 0.7, 0.3,
+                                         numThreads);
+      REQUIRE(dense.size() == bvs1.size() * bvs2.size());
+      for (unsigned int i = 0; i < bvs1.size(); ++i) {
+        for (unsigned int j = 0; j < bvs2.size(); ++j) {
+          CHECK(dense[i * bvs2.size() + j] ==
+                static_cast<float>(simFunc(bvs1[i], bvs2[j])));
+        }
+      }
+
+      PackedBitOps::SparseSimilarityMatrix sparse;
+      PackedBitOps::calcSparseSimilarityMatrix(fps1, fps2, 0.3, sparse, metric,
+                                               0.7, 0.3, numThreads);
+      REQUIRE(sparse.numRows == bvs1.size());
+      REQUIRE(sparse.numColumns == bvs2.size());
+      REQUIRE(sparse.rowOffsets.size() == bvs1.size() + 1);
+      REQUIRE(sparse.rowOffsets.back() == sparse.columns.size());
+      REQUIRE(sparse.values.size() == sparse.columns.size());
+      for (unsigned int i = 0; i < bvs1.size(); ++i) {
+        std::vector<std::pair<unsigned int, float>> expected;
+        for (unsigned int j = 0; j < bvs2.size(); ++j) {
+          auto sim = simFunc(bvs1[i], bvs2[j]);
+          if (sim >= 0.3) {
+            expected.emplace_back(j, static_cast<float>(sim));
+          }
+        }
+        std::vector<std::pair<unsigned int, float>> row;
+        for (auto pos = sparse.rowOffsets[i]; pos < sparse.rowOffsets[i + 1];
+             ++pos) {
+          row.emplace_back(sparse.columns[pos], sparse.values[pos]);
+        }
+        CHECK(row == expected);
+      }
+    }
+  }
+
+  PackedBitOps::PackedFingerprints other(numBits + 1);
+  std::vector<float> dense;
+  CHECK_THROWS_AS(PackedBitOps::calcSimilarityMatrix(fps1, other, dense),
+                  ValueErrorException);
+  CHECK_THROWS_AS(other.append(bvs1[0]), ValueErrorException);
+}
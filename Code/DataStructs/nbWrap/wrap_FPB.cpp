@@ -7,6 +7,7 @@
 //  of the RDKit source tree.
 //
 #include <DataStructs/FPBReader.h>
+#include <DataStructs/FPBWriter.h>
 #include <RDGeneral/Invariant.h>
 #include <DataStructs/MultiFPBReader.h>
 
@@ -133,6 +134,14 @@ double getTverskyHelper(const FPBReader *self, unsigned int which,
   const auto *bv = bytesToFP(bytes);
   return self->getTversky(which, bv, ca, cb);
 }
+
+void writeBytesHelper(FPBWriter *self, const nb::bytes &bytes,
+                      const std::string &id) {
+  if (bytes.size() != self->getNumBytes()) {
+    throw nb::value_error("the fingerprint does not have the expected size");
+  }
+  self->write(bytesToFP(bytes), id);
+}
 }  // namespace
 
 struct FPB_wrapper {
@@ -208,6 +217,41 @@ struct FPB_wrapper {
             "GetContainingNeighbors", &multiContainingNbrHelper, "bv"_a,
             "numThreads"_a = 1,
             R"DOC(returns indices of neighbors that contain this fingerprint (where all bits from this fingerprint are also set))DOC");
+
+    std::string FPBWriterClassDoc =
+        R"DOC(A class for writing FPB files which can be searched with FPBReader.
+    The fingerprints are sorted using temporary files, so the number of
+    fingerprints which can be written is not limited by the memory.
+    Note that this functionality is still experimental and the API may
+    change in future releases.
+)DOC";
+
+    nb::class_<FPBWriter>(m, "FPBWriter", FPBWriterClassDoc.c_str())
+        .def(
+            nb::init<const std::string &, unsigned int, std::size_t,
+                     const std::string &>(),
+            "filename"_a, "numBits"_a, "maxMemory"_a = 256 * 1024 * 1024,
+            "tmpDir"_a = "",
+            R"DOC(maxMemory is the approximate number of bytes used to hold fingerprints before they are written to a temporary file in tmpDir)DOC")
+        .def("Write",
+             nb::overload_cast<const ExplicitBitVect &, const std::string &>(
+                 &FPBWriter::write),
+             "fp"_a, "id"_a, R"DOC(adds a fingerprint)DOC")
+        .def("WriteBytes", &writeBytesHelper, "bytes"_a, "id"_a,
+             R"DOC(adds a fingerprint provided as bytes)DOC")
+        .def(
+            "AddFPBFile", &FPBWriter::addFPBFile, "filename"_a,
+            R"DOC(adds the contents of an existing FPB file, which is read when the writer is closed)DOC")
+        .def("Close", &FPBWriter::close,
+             R"DOC(sorts the fingerprints and writes the output file)DOC")
+        .def("__len__", &FPBWriter::length)
+        .def("GetNumBits", &FPBWriter::nBits,
+             R"DOC(returns the number of bits in a fingerprint)DOC")
+        .def("GetNumRuns", &FPBWriter::getNumRuns,
+             R"DOC(returns the number of temporary files written so far)DOC");
+
+    m.def("MergeFPBFiles", &FPBWriter::mergeFPBFiles, "inputs"_a, "output"_a,
+          R"DOC(writes an FPB file with the contents of the input FPB files)DOC");
   }
 };
 
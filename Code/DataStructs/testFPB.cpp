@@ -1,5 +1,5 @@
 //
-//  Copyright (C) 2016-2025 Greg Landrum and other RDKit contributors
+//  Copyright (C) 2016-2026 Greg Landrum and other RDKit contributors
 //
 //  @@ All Rights Reserved @@
 //  This file is part of the RDKit.
@@ -11,6 +11,12 @@
 #include <RDGeneral/utils.h>
 #include <DataStructs/ExplicitBitVect.h>
 #include <DataStructs/FPBReader.h>
+#include <DataStructs/FPBWriter.h>
+#include <RDGeneral/BadFileException.h>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <random>
 
 using namespace RDKit;
 
@@ -547,3 +553,234 @@ TEST_CASE("Github Issue 1118") {
   }
   BOOST_LOG(rdInfoLog) << "Finished" << std::endl;
 }
+
+TEST_CASE("FPBReader Tanimoto Nearest Neighbors") {
+  std::string pathName = getenv("RDBASE");
+  pathName += "/Code/DataStructs/testData/";
+  std::string filename = pathName + "zim.head100.fpb";
+  for (auto lazy : {false, true}) {
+    FPBReader fps(filename, lazy);
+    fps.init();
+    REQUIRE(fps.length() == 100);
+    for (auto probeIdx : {0u, 17u, 95u}) {
+      boost::shared_array<std::uint8_t> bytes = fps.getBytes(probeIdx);
+      REQUIRE(bytes);
+      std::vector<std::pair<double, unsigned int>> all;
+      for (unsigned int i = 0; i < fps.length(); ++i) {
+        all.emplace_back(fps.getTanimoto(i, bytes), i);
+      }
+      std::sort(all.begin(), all.end(), [](const auto &v1, const auto &v2) {
+        return v1.first > v2.first ||
+               (v1.first == v2.first && v1.second < v2.second);
+      });
+      for (auto k : {1u, 3u, 10u, 200u}) {
+        for (auto numThreads : {1, 4}) {
+          auto nbrs =
+              fps.getTanimotoNearestNeighbors(bytes, k, 0.0, numThreads);
+          REQUIRE(nbrs.size() == std::min<size_t>(k, all.size()));
+          for (unsigned int i = 0; i < nbrs.size(); ++i) {
+            CHECK(nbrs[i] == all[i]);
+          }
+        }
+      }
+      // with a threshold
+      auto nbrs = fps.getTanimotoNearestNeighbors(bytes, 100, 0.3);
+      auto thresholdNbrs = fps.getTanimotoNeighbors(bytes, 0.3);
+      REQUIRE(nbrs.size() == thresholdNbrs.size());
+      for (unsigned int i = 0; i < nbrs.size(); ++i) {
+        CHECK(nbrs[i] == all[i]);
+      }
+    }
+    auto nbrs = fps.getTanimotoNearestNeighbors(*fps.getFP(95), 2);
+    REQUIRE(nbrs.size() == 2);
+    CHECK(feq(nbrs[0].first, 1.));
+    CHECK(nbrs[0].second == 95);
+    CHECK(feq(nbrs[1].first, 0.4125));
+    CHECK(nbrs[1].second == 89);
+    CHECK(fps.getTanimotoNearestNeighbors(*fps.getFP(95), 0).empty());
+  }
+}
+
+namespace {
+void compareFPBFiles(const std::string &fname1, const std::string &fname2) {
+  FPBReader fps1(fname1);
+  FPBReader fps2(fname2);
+  fps1.init();
+  fps2.init();
+  REQUIRE(fps1.length() == fps2.length());
+  REQUIRE(fps1.nBits() == fps2.nBits());
+  for (unsigned int i = 0; i < fps1.length(); ++i) {
+    CHECK(fps1.getId(i) == fps2.getId(i));
+    CHECK(*fps1.getFP(i) == *fps2.getFP(i));
+  }
+  for (unsigned int count = 0; count <= fps1.nBits(); ++count) {
+    CHECK(fps1.getFPIdsInCountRange(count, count) ==
+          fps2.getFPIdsInCountRange(count, count));
+  }
+}
+}  // namespace
+
+TEST_CASE("FPBWriter") {
+  std::string pathName = getenv("RDBASE");
+  pathName += "/Code/DataStructs/testData/";
+  std::string filename = pathName + "zim.head100.fpb";
+  auto tmpDir = std::filesystem::temp_directory_path();
+  auto outName = (tmpDir / "testFPBWriter.fpb").string();
+  auto part1Name = (tmpDir / "testFPBWriter_1.fpb").string();
+  auto part2Name = (tmpDir / "testFPBWriter_2.fpb").string();
+
+  FPBReader orig(filename);
+  orig.init();
+  REQUIRE(orig.length() == 100);
+
+  SECTION("sorting with temporary files") {
+    {
+      // add the fingerprints in reverse order with a small memory limit
+      FPBWriter writer(outName, 2048, 4096);
+      for (unsigned int i = orig.length(); i > 0; --i) {
+        writer.write(*orig.getFP(i - 1), orig.getId(i - 1));
+      }
+      CHECK(writer.length() == 100);
+      CHECK(writer.getNumRuns() > 1);
+      // the fingerprints alone need 100 * 256 bytes, a run holds less than
+      // 4096 bytes of them
+      CHECK(writer.getNumRuns() > 100 * 256 / 4096);
+      writer.close();
+    }
+    FPBReader fps(outName);
+    fps.init();
+    REQUIRE(fps.length() == 100);
+    REQUIRE(fps.nBits() == 2048);
+    std::map<std::string, ExplicitBitVect> origFPs;
+    for (unsigned int i = 0; i < orig.length(); ++i) {
+      origFPs.emplace(orig.getId(i), *orig.getFP(i));
+    }
+    unsigned int lastCount = 0;
+    for (unsigned int i = 0; i < fps.length(); ++i) {
+      auto fp = fps.getFP(i);
+      CHECK(fp->getNumOnBits() >= lastCount);
+      lastCount = fp->getNumOnBits();
+      auto id = fps.getId(i);
+      REQUIRE(origFPs.find(id) != origFPs.end());
+      CHECK(origFPs.at(id) == *fp);
+    }
+    for (unsigned int count = 0; count <= 2048; ++count) {
+      CHECK(fps.getFPIdsInCountRange(count, count) ==
+            orig.getFPIdsInCountRange(count, count));
+    }
+    auto nbrs = fps.getTanimotoNeighbors(*orig.getFP(95), 0.4);
+    auto origNbrs = orig.getTanimotoNeighbors(*orig.getFP(95), 0.4);
+    REQUIRE(nbrs.size() == origNbrs.size());
+    for (unsigned int i = 0; i < nbrs.size(); ++i) {
+      CHECK(feq(nbrs[i].first, origNbrs[i].first));
+      CHECK(fps.getId(nbrs[i].second) == orig.getId(origNbrs[i].second));
+    }
+  }
+
+  SECTION("appending and merging") {
+    {
+      FPBWriter writer1(part1Name, 2048);
+      FPBWriter writer2(part2Name, 2048);
+      for (unsigned int i = 0; i < orig.length(); ++i) {
+        auto &writer = i < 50 ? writer1 : writer2;
+        writer.write(orig.getBytes(i).get(), orig.getId(i));
+      }
+    }
+    {
+      // the fingerprints which were already in the file come first
+      FPBWriter writer(outName, 2048, 1024);
+      writer.addFPBFile(part1Name);
+      for (unsigned int i = 50; i < orig.length(); ++i) {
+        writer.write(*orig.getFP(i), orig.getId(i));
+      }
+      CHECK(writer.length() == 100);
+      writer.close();
+    }
+    compareFPBFiles(filename, outName);
+
+    FPBWriter::mergeFPBFiles({part1Name, part2Name}, outName);
+    compareFPBFiles(filename, outName);
+  }
+
+  SECTION("destroyed by an exception") {
+    std::filesystem::remove(outName);
+    auto runDir =
+        tmpDir / ("testFPBWriter_" + std::to_string(std::random_device()()));
+    std::filesystem::create_directory(runDir);
+    try {
+      FPBWriter writer(outName, 2048, 4096, runDir.string());
+      for (unsigned int i = 0; i < orig.length(); ++i) {
+        writer.write(*orig.getFP(i), orig.getId(i));
+      }
+      REQUIRE(writer.getNumRuns() > 0);
+      throw ValueErrorException("failed while adding fingerprints");
+    } catch (const ValueErrorException &) {
+    }
+    CHECK(!std::filesystem::exists(outName));
+    CHECK(std::filesystem::is_empty(runDir));
+    std::filesystem::remove_all(runDir);
+  }
+
+  SECTION("errors") {
+    FPBWriter writer(outName, 1024);
+    CHECK_THROWS_AS(writer.addFPBFile(filename), ValueErrorException);
+    CHECK_THROWS_AS(writer.write(*orig.getFP(0), "fp"), ValueErrorException);
+    CHECK_THROWS_AS(writer.addFPBFile(pathName + "no_such_file.fpb"),
+                    BadFileException);
+  }
+
+  for (const auto &fname : {outName, part1Name, part2Name}) {
+    std::filesystem::remove(fname);
+  }
+}
+
+TEST_CASE("FPBReader multithreaded Tanimoto Nearest Neighbors") {
+  // the reader only splits popcount bins with more than 4096 fingerprints
+  // per thread between threads, so put most of the fingerprints in a
+  // single bin
+  auto outName = (std::filesystem::temp_directory_path() /
+                  "testFPBReaderThreads.fpb")
+                     .string();
+  const unsigned int nBits = 256;
+  const unsigned int numFPs = 20000;
+  std::mt19937 rng(0xf00d);
+  std::vector<ExplicitBitVect> fpv;
+  {
+    FPBWriter writer(outName, nBits);
+    for (unsigned int i = 0; i < numFPs; ++i) {
+      ExplicitBitVect fp(nBits);
+      unsigned int nOn = i % 10 ? 16 : 12 + rng() % 8;
+      while (fp.getNumOnBits() < nOn) {
+        fp.setBit(rng() % nBits);
+      }
+      writer.write(fp, std::to_string(i));
+      fpv.push_back(std::move(fp));
+    }
+  }
+  FPBReader fps(outName);
+  fps.init();
+  REQUIRE(fps.length() == numFPs);
+  auto binSize = fps.getFPIdsInCountRange(16, 16);
+  REQUIRE(binSize.second - binSize.first >= 4 * 4096);
+  for (auto probeIdx : {0u, 5u, 1234u}) {
+    const auto &probe = fpv[probeIdx];
+    std::vector<std::pair<double, unsigned int>> all;
+    for (unsigned int i = 0; i < fps.length(); ++i) {
+      all.emplace_back(fps.getTanimoto(i, probe), i);
+    }
+    std::sort(all.begin(), all.end(), [](const auto &v1, const auto &v2) {
+      return v1.first > v2.first ||
+             (v1.first == v2.first && v1.second < v2.second);
+    });
+    for (auto k : {1u, 25u, 500u}) {
+      for (auto numThreads : {1, 4}) {
+        auto nbrs = fps.getTanimotoNearestNeighbors(probe, k, 0.0, numThreads);
+        REQUIRE(nbrs.size() == k);
+        for (unsigned int i = 0; i < nbrs.size(); ++i) {
+          CHECK(nbrs[i] == all[i]);
+        }
+      }
+    }
+  }
+  std::filesystem::remove(outName);
+}
@@ -29,6 +29,47 @@ class RDKIT_FORCEFIELD_EXPORT ForceFieldContrib {
   //! calculates our contribution to the gradients of a position
   virtual void getGrad(double *pos, double *grad) const = 0;
 
+  //! adds our contribution to the energies of a batch of positions
+  /*!
+    \param pos       the coordinates of \c numConfs position sets in
+                     struct-of-arrays layout: coordinate \c i of position
+                     set \c c is <tt>pos[i * numConfs + c]</tt>
+    \param numConfs  the number of position sets
+    \param energies  our contributions are added to this, should be
+                     \c numConfs long
+    \param confIds   (optional) identifies the position sets, e.g. the
+                     conformers they come from. Contributions which keep
+                     state for each position set (like neighbor lists) key
+                     it by these. If this is not provided, the position
+                     sets are numbered from zero.
+
+    \return whether or not the batch was handled. Contributions which
+            don't override this are evaluated by the ForceField one
+            position set at a time using getEnergy()
+  */
+  virtual bool getEnergies(const double * /*pos*/, unsigned int /*numConfs*/,
+                           double * /*energies*/,
+                           const unsigned int * /*confIds*/) const {
+    return false;
+  }
+
+  //! adds our contribution to the gradients of a batch of positions
+  /*!
+    \param pos       the coordinates, see getEnergies()
+    \param numConfs  the number of position sets
+    \param grads     our contributions are added to this, uses the same
+                     layout as \c pos
+    \param confIds   (optional) identifies the position sets, see
+                     getEnergies()
+
+    \return whether or not the batch was handled, see getEnergies()
+  */
+  virtual bool getGrads(const double * /*pos*/, unsigned int /*numConfs*/,
+                        double * /*grads*/,
+                        const unsigned int * /*confIds*/) const {
+    return false;
+  }
+
   //! return a copy
   virtual ForceFieldContrib *copy() const = 0;
 
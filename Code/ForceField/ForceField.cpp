@@ -12,6 +12,11 @@
 
 #include <RDGeneral/Invariant.h>
 #include <Numerics/Optimizer/BFGSOpt.h>
+#include <Numerics/Optimizer/BFGSOptBatch.h>
+#include <Numerics/Optimizer/LBFGSOpt.h>
+
+#include <numeric>
+#include <utility>
 
 namespace RDKit {
 namespace ForceFieldsHelper {
@@ -102,47 +107,104 @@ class calcEnergy {
   ForceFields::ForceField *mp_ffHolder;
 };
 
+// FIX: this hack reduces the gradients so that the
+// minimizer is more efficient.
+double scaleGradient(unsigned int dim, double *grad) {
+  double maxGrad = -1e8;
+  double gradScale = 0.1;
+  for (unsigned int i = 0; i < dim; i++) {
+    grad[i] *= gradScale;
+    if (fabs(grad[i]) > maxGrad) {
+      maxGrad = fabs(grad[i]);
+    }
+  }
+  // this is a continuation of the same hack to avoid
+  // some potential numeric instabilities:
+  if (maxGrad > 10.0) {
+    while (maxGrad * gradScale > 10.0) {
+      gradScale *= .5;
+    }
+    for (unsigned int i = 0; i < dim; i++) {
+      grad[i] *= gradScale;
+    }
+  }
+  return gradScale;
+}
+
 class calcGradient {
  public:
   calcGradient(ForceFields::ForceField *ffHolder) : mp_ffHolder(ffHolder) {};
   double operator()(double *pos, double *grad) const {
-    double res = 1.0;
+    const unsigned int dim =
+        mp_ffHolder->numPoints() * mp_ffHolder->dimension();
     // the contribs to the gradient function use +=, so we need
     // to zero the grad out before moving on:
-    for (unsigned int i = 0;
-         i < mp_ffHolder->numPoints() * mp_ffHolder->dimension(); i++) {
+    for (unsigned int i = 0; i < dim; i++) {
       grad[i] = 0.0;
     }
     mp_ffHolder->calcGrad(pos, grad);
+    return scaleGradient(dim, grad);
+  }
 
-    // FIX: this hack reduces the gradients so that the
-    // minimizer is more efficient.
-    double maxGrad = -1e8;
-    double gradScale = 0.1;
-    for (unsigned int i = 0;
-         i < mp_ffHolder->numPoints() * mp_ffHolder->dimension(); i++) {
-      grad[i] *= gradScale;
-      if (fabs(grad[i]) > maxGrad) {
-        maxGrad = fabs(grad[i]);
-      }
+ private:
+  ForceFields::ForceField *mp_ffHolder;
+};
+
+// copies a set of points into the struct-of-arrays layout used by
+// ForceField::calcEnergies()
+void toStructOfArrays(unsigned int dim, unsigned int n,
+                      const double *const *points, std::vector<double> &res) {
+  res.resize(dim * n);
+  for (unsigned int c = 0; c < n; ++c) {
+    const double *point = points[c];
+    for (unsigned int i = 0; i < dim; ++i) {
+      res[i * n + c] = point[i];
     }
-    // this is a continuation of the same hack to avoid
-    // some potential numeric instabilities:
-    if (maxGrad > 10.0) {
-      while (maxGrad * gradScale > 10.0) {
-        gradScale *= .5;
-      }
-      for (unsigned int i = 0;
-           i < mp_ffHolder->numPoints() * mp_ffHolder->dimension(); i++) {
-        grad[i] *= gradScale;
+  }
+}
+
+class calcBatchEnergies {
+ public:
+  calcBatchEnergies(ForceFields::ForceField *ffHolder)
+      : mp_ffHolder(ffHolder) {};
+  void operator()(unsigned int n, const unsigned int *confIds,
+                  double *const *points, double *vals) const {
+    const unsigned int dim =
+        mp_ffHolder->numPoints() * mp_ffHolder->dimension();
+    toStructOfArrays(dim, n, points, d_pos);
+    mp_ffHolder->calcEnergies(d_pos.data(), n, vals, confIds);
+  }
+
+ private:
+  ForceFields::ForceField *mp_ffHolder;
+  mutable std::vector<double> d_pos;
+};
+
+class calcBatchGradients {
+ public:
+  calcBatchGradients(ForceFields::ForceField *ffHolder)
+      : mp_ffHolder(ffHolder) {};
+  void operator()(unsigned int n, const unsigned int *confIds,
+                  double *const *points, double *const *grads,
+                  double *gradScales) const {
+    const unsigned int dim =
+        mp_ffHolder->numPoints() * mp_ffHolder->dimension();
+    toStructOfArrays(dim, n, points, d_pos);
+    d_grads.resize(dim * n);
+    mp_ffHolder->calcGrads(d_pos.data(), n, d_grads.data(), confIds);
+    for (unsigned int c = 0; c < n; ++c) {
+      double *grad = grads[c];
+      for (unsigned int i = 0; i < dim; ++i) {
+        grad[i] = d_grads[i * n + c];
       }
+      gradScales[c] = scaleGradient(dim, grad);
     }
-    res = gradScale;
-    return res;
   }
 
  private:
   ForceFields::ForceField *mp_ffHolder;
+  mutable std::vector<double> d_pos;
+  mutable std::vector<double> d_grads;
 };
 }  // namespace ForceFieldsHelper
 
@@ -159,7 +221,9 @@ ForceField::ForceField(const ForceField &other)
     : d_dimension(other.d_dimension),
       df_init(false),
       d_numPoints(other.d_numPoints),
-      dp_distMat(nullptr) {
+      dp_distMat(nullptr),
+      d_numLBFGSCorrections(other.d_numLBFGSCorrections),
+      df_useDistMat(other.df_useDistMat) {
   d_contribs.clear();
   for (const auto &contrib : other.d_contribs) {
     ForceFieldContrib *ncontrib = contrib->copy();
@@ -172,6 +236,9 @@ double ForceField::distance(unsigned int i, unsigned int j, double *pos) {
   PRECONDITION(df_init, "not initialized");
   URANGE_CHECK(i, d_numPoints);
   URANGE_CHECK(j, d_numPoints);
+  if (!dp_distMat) {
+    return std::as_const(*this).distance(i, j, pos);
+  }
   if (j < i) {
     int tmp = j;
     j = i;
@@ -242,9 +309,13 @@ void ForceField::initialize() {
   dp_distMat = nullptr;
 
   d_numPoints = d_positions.size();
-  d_matSize = d_numPoints * (d_numPoints + 1) / 2;
-  dp_distMat = new double[d_matSize];
-  this->initDistanceMatrix();
+  if (df_useDistMat) {
+    d_matSize = d_numPoints * (d_numPoints + 1) / 2;
+    dp_distMat = new double[d_matSize];
+    this->initDistanceMatrix();
+  } else {
+    d_matSize = 0;
+  }
   df_init = true;
 }
 
@@ -272,14 +343,159 @@ int ForceField::minimize(unsigned int snapshotFreq,
   ForceFieldsHelper::calcEnergy eCalc(this);
   ForceFieldsHelper::calcGradient gCalc(this);
 
-  int res =
-      BFGSOpt::minimize(dim, points.data(), forceTol, numIters, finalForce, eCalc,
-                        gCalc, snapshotFreq, snapshotVect, energyTol, maxIts);
+  int res;
+  if (d_numLBFGSCorrections) {
+    res = BFGSOpt::minimizeLBFGS(dim, points.data(), forceTol, numIters,
+                                 finalForce, eCalc, gCalc,
+                                 d_numLBFGSCorrections, snapshotFreq,
+                                 snapshotVect, energyTol, maxIts);
+  } else {
+    res = BFGSOpt::minimize(dim, points.data(), forceTol, numIters, finalForce,
+                            eCalc, gCalc, snapshotFreq, snapshotVect,
+                            energyTol, maxIts);
+  }
   this->gather(points.data());
 
   return res;
 }
 
+std::vector<int> ForceField::minimizeBatch(
+    const std::vector<RDGeom::PointPtrVect> &positions, unsigned int maxIts,
+    double forceTol, double energyTol, unsigned int batchSize,
+    std::vector<double> *energies) {
+  PRECONDITION(df_init, "not initialized");
+  PRECONDITION(batchSize > 0, "bad batch size");
+  const auto numConfs = static_cast<unsigned int>(positions.size());
+  const unsigned int dim = d_numPoints * d_dimension;
+  std::vector<double> points(dim * numConfs);
+  std::vector<double *> pointPtrs(numConfs);
+  for (unsigned int c = 0; c < numConfs; ++c) {
+    PRECONDITION(positions[c].size() == d_numPoints, "size mismatch");
+    pointPtrs[c] = &points[c * dim];
+    unsigned int tab = 0;
+    for (const auto point : positions[c]) {
+      for (unsigned int di = 0; di < d_dimension; ++di) {
+        points[tab++ + c * dim] = (*point)[di];
+      }
+    }
+  }
+
+  std::vector<int> res(numConfs, 0);
+  ForceFieldsHelper::calcBatchEnergies eCalc(this);
+  if (!d_contribs.empty()) {
+    ForceFieldsHelper::calcBatchGradients gCalc(this);
+    res = BFGSOpt::minimizeBatch(dim, numConfs, pointPtrs.data(), forceTol,
+                                 eCalc, gCalc, energyTol, maxIts, batchSize);
+  }
+  if (energies) {
+    energies->resize(numConfs);
+    std::vector<unsigned int> confIds(numConfs);
+    std::iota(confIds.begin(), confIds.end(), 0);
+    for (unsigned int c = 0; c < numConfs; c += batchSize) {
+      eCalc(std::min(batchSize, numConfs - c), &confIds[c], &pointPtrs[c],
+            &(*energies)[c]);
+    }
+  }
+
+  for (unsigned int c = 0; c < numConfs; ++c) {
+    unsigned int tab = 0;
+    for (const auto point : positions[c]) {
+      for (unsigned int di = 0; di < d_dimension; ++di) {
+        (*point)[di] = points[tab++ + c * dim];
+      }
+    }
+  }
+  return res;
+}
+
+void ForceField::calcEnergies(const double *pos, unsigned int numConfs,
+                              double *energies, const unsigned int *confIds) {
+  PRECONDITION(df_init, "not initialized");
+  PRECONDITION(pos, "bad position vector");
+  PRECONDITION(energies, "bad energy vector");
+  std::fill(energies, energies + numConfs, 0.0);
+  if (d_contribs.empty() || !numConfs) {
+    return;
+  }
+
+  // each contrib's energies are collected separately and then added to the
+  // totals in the order of d_contribs, so that the totals are accumulated in
+  // the same order as in calcEnergy()
+  const auto numContribs = d_contribs.size();
+  std::vector<double> contribEnergies(numContribs * numConfs, 0.0);
+  std::vector<std::size_t> unbatched;
+  for (std::size_t k = 0; k < numContribs; ++k) {
+    if (!d_contribs[k]->getEnergies(pos, numConfs,
+                                    &contribEnergies[k * numConfs], confIds)) {
+      unbatched.push_back(k);
+    }
+  }
+  if (!unbatched.empty()) {
+    // the remaining contribs are done one position set at a time:
+    const unsigned int dim = d_numPoints * d_dimension;
+    std::vector<double> confPos(dim);
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      for (unsigned int i = 0; i < dim; ++i) {
+        confPos[i] = pos[i * numConfs + c];
+      }
+      this->initDistanceMatrix();
+      for (const auto k : unbatched) {
+        contribEnergies[k * numConfs + c] =
+            d_contribs[k]->getEnergy(confPos.data());
+      }
+    }
+  }
+  for (std::size_t k = 0; k < numContribs; ++k) {
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      energies[c] += contribEnergies[k * numConfs + c];
+    }
+  }
+}
+
+void ForceField::calcGrads(const double *pos, unsigned int numConfs,
+                           double *grads, const unsigned int *confIds) {
+  PRECONDITION(df_init, "not initialized");
+  PRECONDITION(pos, "bad position vector");
+  PRECONDITION(grads, "bad gradient vector");
+  const unsigned int dim = d_numPoints * d_dimension;
+  std::fill(grads, grads + dim * numConfs, 0.0);
+  if (d_contribs.empty() || !numConfs) {
+    return;
+  }
+
+  std::vector<const ForceFieldContrib *> unbatched;
+  for (const auto &contrib : d_contribs) {
+    if (!contrib->getGrads(pos, numConfs, grads, confIds)) {
+      unbatched.push_back(contrib.get());
+    }
+  }
+  if (!unbatched.empty()) {
+    std::vector<double> confPos(dim);
+    std::vector<double> confGrad(dim);
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      for (unsigned int i = 0; i < dim; ++i) {
+        confPos[i] = pos[i * numConfs + c];
+      }
+      std::fill(confGrad.begin(), confGrad.end(), 0.0);
+      this->initDistanceMatrix();
+      for (const auto contrib : unbatched) {
+        contrib->getGrad(confPos.data(), confGrad.data());
+      }
+      for (unsigned int i = 0; i < dim; ++i) {
+        grads[i * numConfs + c] += confGrad[i];
+      }
+    }
+  }
+
+  for (const auto fixedPoint : d_fixedPoints) {
+    CHECK_INVARIANT(static_cast<unsigned int>(fixedPoint) < d_numPoints,
+                    "bad fixed point index");
+    const unsigned int idx = d_dimension * fixedPoint;
+    std::fill(grads + idx * numConfs, grads + (idx + d_dimension) * numConfs,
+              0.0);
+  }
+}
+
 double ForceField::calcEnergy(std::vector<double> *contribs) const {
   PRECONDITION(df_init, "not initialized");
   double res = 0.0;
@@ -402,7 +618,9 @@ void ForceField::gather(double *pos) {
 
 void ForceField::initDistanceMatrix() {
   PRECONDITION(d_numPoints, "no points");
-  PRECONDITION(dp_distMat, "no distance matrix");
+  if (!dp_distMat) {
+    return;
+  }
   PRECONDITION(static_cast<unsigned int>(d_numPoints * (d_numPoints + 1) / 2) <=
                    d_matSize,
                "matrix size mismatch");
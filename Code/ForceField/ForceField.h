@@ -174,6 +174,64 @@ class RDKIT_FORCEFIELD_EXPORT ForceField {
   int minimize(unsigned int maxIts = 200, double forceTol = 1e-4,
                double energyTol = 1e-6);
 
+  //! calculates the energies of a batch of position sets
+  /*!
+    \param pos       the coordinates of \c numConfs position sets in
+                     struct-of-arrays layout: coordinate \c i of position
+                     set \c c is <tt>pos[i * numConfs + c]</tt>.
+                     Should be \c 3*this->numPoints()*numConfs long.
+    \param numConfs  the number of position sets
+    \param energies  used to return the energies, should be \c numConfs long
+    \param confIds   (optional) identifies the position sets, see
+                     ForceFieldContrib::getEnergies()
+
+    <b>Notes:</b>
+      - contributions which implement ForceFieldContrib::getEnergies() are
+        evaluated for all position sets in one pass, the others are
+        evaluated one position set at a time.
+  */
+  void calcEnergies(const double *pos, unsigned int numConfs,
+                    double *energies, const unsigned int *confIds = nullptr);
+
+  //! calculates the gradients of a batch of position sets
+  /*!
+    \param pos       the coordinates, see calcEnergies()
+    \param numConfs  the number of position sets
+    \param grads     used to return the gradients, uses the same layout as
+                     \c pos
+    \param confIds   (optional) identifies the position sets, see
+                     ForceFieldContrib::getEnergies()
+  */
+  void calcGrads(const double *pos, unsigned int numConfs, double *grads,
+                 const unsigned int *confIds = nullptr);
+
+  //! minimizes several sets of positions using our contributions
+  /*!
+    This is the equivalent of setting our positions to each of the
+    sets in turn and calling minimize(), but the minimizations are run in
+    lockstep so that the energies and gradients of up to \c batchSize
+    position sets are calculated together.
+
+    \param positions the position sets, each of them should contain
+                     \c this->numPoints() points. These are updated.
+    \param maxIts    the maximum number of iterations to try
+    \param forceTol  the convergence criterion for forces
+    \param energyTol the convergence criterion for energies
+    \param batchSize the number of position sets minimized together
+    \param energies  (optional) used to return the final energies
+
+    \return the result of minimize() for each position set
+
+    <b>Note:</b>
+      this always uses the dense BFGS minimizer, see
+      setNumLBFGSCorrections()
+  */
+  std::vector<int> minimizeBatch(
+      const std::vector<RDGeom::PointPtrVect> &positions,
+      unsigned int maxIts = 200, double forceTol = 1e-4,
+      double energyTol = 1e-6, unsigned int batchSize = 16,
+      std::vector<double> *energies = nullptr);
+
   // ---------------------------
   // setters and getters
 
@@ -197,7 +255,8 @@ class RDKIT_FORCEFIELD_EXPORT ForceField {
 
     <b>Side effects:</b>
       - if the distance between i and j has not previously been calculated,
-        our internal distance matrix will be updated.
+        our internal distance matrix will be updated (if we have one, see
+        setUseDistanceMatrix()).
   */
   double distance(unsigned int i, unsigned int j, double *pos = nullptr);
 
@@ -240,6 +299,32 @@ class RDKIT_FORCEFIELD_EXPORT ForceField {
   INT_VECT &fixedPoints() { return d_fixedPoints; }
   const INT_VECT &fixedPoints() const { return d_fixedPoints; }
 
+  //! sets the number of corrections stored by the L-BFGS minimizer
+  /*!
+    If this is nonzero, minimize() uses the limited-memory BFGS minimizer
+    (BFGSOpt::minimizeLBFGS()), which keeps this many steps instead of the
+    dense inverse Hessian. That is much faster for systems with thousands of
+    coordinates. The default, 0, uses the dense BFGS minimizer.
+  */
+  void setNumLBFGSCorrections(unsigned int numCorrections) {
+    d_numLBFGSCorrections = numCorrections;
+  }
+  unsigned int numLBFGSCorrections() const { return d_numLBFGSCorrections; }
+
+  //! sets whether or not initialize() allocates our internal distance matrix
+  /*!
+    The distance matrix caches the distances between all pairs of points, so
+    its size grows quadratically with the number of points. Force fields
+    whose contribs only need a number of distances which is roughly linear
+    in the number of points, like the ones with non-bonded cutoffs, can
+    turn it off and have distance() calculate the distances directly.
+    This takes effect on the next call to initialize().
+  */
+  void setUseDistanceMatrix(bool useDistanceMatrix) {
+    df_useDistMat = useDistanceMatrix;
+  }
+  bool useDistanceMatrix() const { return df_useDistMat; }
+
  protected:
   unsigned int d_dimension;
   bool df_init{false};               //!< whether or not we've been initialized
@@ -249,6 +334,8 @@ class RDKIT_FORCEFIELD_EXPORT ForceField {
   ContribPtrVect d_contribs;         //!< contributions to the energy
   INT_VECT d_fixedPoints;
   unsigned int d_matSize = 0;
+  unsigned int d_numLBFGSCorrections = 0;
+  bool df_useDistMat{true};  //!< whether or not we use a distance matrix
   //! scatter our positions into an array
   /*!
       \param pos     should be \c 3*this->numPoints() long;
@@ -15,6 +15,20 @@
 
 namespace ForceFields {
 namespace MMFF {
+namespace {
+inline double bondStretchEnergy(const double r0, const double kb,
+                                const double distance) {
+  double distTerm = distance - r0;
+  double distTerm2 = distTerm * distTerm;
+  double const c1 = MDYNE_A_TO_KCAL_MOL;
+  double const cs = -2.0;
+  double const c3 = 7.0 / 12.0;
+
+  return (0.5 * c1 * kb * distTerm2 *
+          (1.0 + cs * distTerm + c3 * cs * cs * distTerm2));
+}
+}  // namespace
+
 namespace Utils {
 
 double calcBondRestLength(const MMFFBond *mmffBondParams) {
@@ -31,14 +45,7 @@ double calcBondForceConstant(const MMFFBond *mmffBondParams) {
 
 double calcBondStretchEnergy(const double r0, const double kb,
                              const double distance) {
-  double distTerm = distance - r0;
-  double distTerm2 = distTerm * distTerm;
-  double const c1 = MDYNE_A_TO_KCAL_MOL;
-  double const cs = -2.0;
-  double const c3 = 7.0 / 12.0;
-
-  return (0.5 * c1 * kb * distTerm2 *
-          (1.0 + cs * distTerm + c3 * cs * cs * distTerm2));
+  return bondStretchEnergy(r0, kb, distance);
 }
 }  // end of namespace Utils
 
@@ -109,5 +116,64 @@ void BondStretchContrib::getGrad(double *pos, double *grad) const {
     }
   }
 }
+
+bool BondStretchContrib::getEnergies(const double *pos, unsigned int numConfs,
+                                     double *energies,
+                                     const unsigned int * /*confIds*/) const {
+  PRECONDITION(pos, "bad vector");
+  PRECONDITION(energies, "bad vector");
+
+  const int numTerms = d_at1Idxs.size();
+  for (int termIdx = 0; termIdx < numTerms; termIdx++) {
+    const double *p1 = &(pos[3 * d_at1Idxs[termIdx] * numConfs]);
+    const double *p2 = &(pos[3 * d_at2Idxs[termIdx] * numConfs]);
+    const double r0 = d_r0[termIdx];
+    const double kb = d_kb[termIdx];
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      const double dx = p1[c] - p2[c];
+      const double dy = p1[c + numConfs] - p2[c + numConfs];
+      const double dz = p1[c + 2 * numConfs] - p2[c + 2 * numConfs];
+      const double dist = sqrt(dx * dx + dy * dy + dz * dz);
+      energies[c] += bondStretchEnergy(r0, kb, dist);
+    }
+  }
+  return true;
+}
+
+bool BondStretchContrib::getGrads(const double *pos, unsigned int numConfs,
+                                  double *grads,
+                                  const unsigned int * /*confIds*/) const {
+  PRECONDITION(pos, "bad vector");
+  PRECONDITION(grads, "bad vector");
+
+  const int numTerms = d_at1Idxs.size();
+  constexpr double cs = -2.0;
+  constexpr double c1 = MDYNE_A_TO_KCAL_MOL;
+  constexpr double c3 = 7.0 / 12.0;
+  for (int termIdx = 0; termIdx < numTerms; termIdx++) {
+    const double *p1 = &(pos[3 * d_at1Idxs[termIdx] * numConfs]);
+    const double *p2 = &(pos[3 * d_at2Idxs[termIdx] * numConfs]);
+    double *g1 = &(grads[3 * d_at1Idxs[termIdx] * numConfs]);
+    double *g2 = &(grads[3 * d_at2Idxs[termIdx] * numConfs]);
+    const double r0 = d_r0[termIdx];
+    const double kb = d_kb[termIdx];
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      const double d[3] = {p1[c] - p2[c], p1[c + numConfs] - p2[c + numConfs],
+                           p1[c + 2 * numConfs] - p2[c + 2 * numConfs]};
+      const double dist = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+      const double distTerm = dist - r0;
+      const double dE_dr = c1 * kb * distTerm *
+                           (1.0 + 1.5 * cs * distTerm +
+                            2.0 * c3 * cs * cs * distTerm * distTerm);
+      for (unsigned int i = 0; i < 3; ++i) {
+        const double dGrad =
+            ((dist > 0.0) ? (dE_dr * d[i] / dist) : kb * 0.01);
+        g1[c + i * numConfs] += dGrad;
+        g2[c + i * numConfs] -= dGrad;
+      }
+    }
+  }
+  return true;
+}
 }  // namespace MMFF
 }  // namespace ForceFields
@@ -40,6 +40,13 @@ class RDKIT_FORCEFIELD_EXPORT BondStretchContrib : public ForceFieldContrib {
 
   void getGrad(double *pos, double *grad) const override;
 
+  bool getEnergies(const double *pos, unsigned int numConfs,
+                   double *energies,
+                   const unsigned int *confIds) const override;
+
+  bool getGrads(const double *pos, unsigned int numConfs, double *grads,
+                const unsigned int *confIds) const override;
+
   BondStretchContrib *copy() const override {
     return new BondStretchContrib(*this);
   }
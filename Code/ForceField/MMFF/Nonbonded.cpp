@@ -8,6 +8,7 @@
 //
 #include "Nonbonded.h"
 #include "Params.h"
+#include <algorithm>
 #include <cmath>
 #include <ForceField/ForceField.h>
 #include <RDGeneral/Invariant.h>
@@ -16,6 +17,70 @@
 
 namespace ForceFields {
 namespace MMFF {
+namespace {
+inline double vdWEnergy(const double dist, const double R_star_ij,
+                        const double wellDepth) {
+  double const vdw1 = 1.07;
+  double const vdw1m1 = vdw1 - 1.0;
+  double const vdw2 = 1.12;
+  double const vdw2m1 = vdw2 - 1.0;
+  double dist2 = dist * dist;
+  double dist7 = dist2 * dist2 * dist2 * dist;
+  double aTerm = vdw1 * R_star_ij / (dist + vdw1m1 * R_star_ij);
+  double aTerm2 = aTerm * aTerm;
+  double aTerm7 = aTerm2 * aTerm2 * aTerm2 * aTerm;
+  double R_star_ij2 = R_star_ij * R_star_ij;
+  double R_star_ij7 = R_star_ij2 * R_star_ij2 * R_star_ij2 * R_star_ij;
+  double bTerm = vdw2 * R_star_ij7 / (dist7 + vdw2m1 * R_star_ij7) - 2.0;
+  double res = wellDepth * aTerm7 * bTerm;
+
+  return res;
+}
+
+inline double eleEnergy(double dist, double chargeTerm,
+                        std::uint8_t dielModel, bool is1_4) {
+  double corr_dist = dist + 0.05;
+  double const diel = 332.0716;
+  double const sc1_4 = 0.75;
+  if (dielModel == RDKit::MMFF::DISTANCE) {
+    corr_dist *= corr_dist;
+  }
+  return (diel * chargeTerm / corr_dist * (is1_4 ? sc1_4 : 1.0));
+}
+
+// returns dE/dr of the vdW term
+inline double vdWGradient(const double dist, const double R_star_ij,
+                          const double wellDepth) {
+  constexpr double vdw1 = 1.07;
+  constexpr double vdw1m1 = vdw1 - 1.0;
+  constexpr double vdw2 = 1.12;
+  constexpr double vdw2m1 = vdw2 - 1.0;
+  constexpr double vdw2t7 = vdw2 * 7.0;
+  const double q = dist / R_star_ij;
+  const double q2 = q * q;
+  const double q6 = q2 * q2 * q2;
+  const double q7 = q6 * q;
+  const double q7pvdw2m1 = q7 + vdw2m1;
+  const double t = vdw1 / (q + vdw1 - 1.0);
+  const double t2 = t * t;
+  const double t7 = t2 * t2 * t2 * t;
+  return wellDepth / R_star_ij * t7 *
+         (-vdw2t7 * q6 / (q7pvdw2m1 * q7pvdw2m1) +
+          ((-vdw2t7 / q7pvdw2m1 + 14.0) / (q + vdw1m1)));
+}
+
+// returns dE/dr of the electrostatic term
+inline double eleGradient(double dist, double chargeTerm,
+                          std::uint8_t dielModel, bool is1_4) {
+  double corr_dist = dist + 0.05;
+  corr_dist *=
+      ((dielModel == RDKit::MMFF::DISTANCE) ? corr_dist * corr_dist
+                                            : corr_dist);
+  return -332.0716 * (double)(dielModel)*chargeTerm / corr_dist *
+         (is1_4 ? 0.75 : 1.0);
+}
+}  // namespace
+
 namespace Utils {
 double calcUnscaledVdWMinimum(const MMFFVdWCollection *mmffVdW,
                               const MMFFVdW *mmffVdWParamsIAtom,
@@ -46,21 +111,7 @@ double calcUnscaledVdWWellDepth(double R_star_ij,
 
 double calcVdWEnergy(const double dist, const double R_star_ij,
                      const double wellDepth) {
-  double const vdw1 = 1.07;
-  double const vdw1m1 = vdw1 - 1.0;
-  double const vdw2 = 1.12;
-  double const vdw2m1 = vdw2 - 1.0;
-  double dist2 = dist * dist;
-  double dist7 = dist2 * dist2 * dist2 * dist;
-  double aTerm = vdw1 * R_star_ij / (dist + vdw1m1 * R_star_ij);
-  double aTerm2 = aTerm * aTerm;
-  double aTerm7 = aTerm2 * aTerm2 * aTerm2 * aTerm;
-  double R_star_ij2 = R_star_ij * R_star_ij;
-  double R_star_ij7 = R_star_ij2 * R_star_ij2 * R_star_ij2 * R_star_ij;
-  double bTerm = vdw2 * R_star_ij7 / (dist7 + vdw2m1 * R_star_ij7) - 2.0;
-  double res = wellDepth * aTerm7 * bTerm;
-
-  return res;
+  return vdWEnergy(dist, R_star_ij, wellDepth);
 }
 
 void scaleVdWParams(double &R_star_ij, double &wellDepth,
@@ -76,13 +127,7 @@ void scaleVdWParams(double &R_star_ij, double &wellDepth,
 
 double calcEleEnergy(unsigned int, unsigned int, double dist, double chargeTerm,
                      std::uint8_t dielModel, bool is1_4) {
-  double corr_dist = dist + 0.05;
-  double const diel = 332.0716;
-  double const sc1_4 = 0.75;
-  if (dielModel == RDKit::MMFF::DISTANCE) {
-    corr_dist *= corr_dist;
-  }
-  return (diel * chargeTerm / corr_dist * (is1_4 ? sc1_4 : 1.0));
+  return eleEnergy(dist, chargeTerm, dielModel, is1_4);
 }
 }  // namespace Utils
 
@@ -303,12 +348,6 @@ void NonbondedContrib::getGrad(double *pos, double *grad) const {
   PRECONDITION(pos, "bad vector");
   PRECONDITION(grad, "bad vector");
 
-  constexpr double vdw1 = 1.07;
-  constexpr double vdw1m1 = vdw1 - 1.0;
-  constexpr double vdw2 = 1.12;
-  constexpr double vdw2m1 = vdw2 - 1.0;
-  constexpr double vdw2t7 = vdw2 * 7.0;
-
   const int numPairs = d_at1Idxs.size();
   for (int pairIdx = 0; pairIdx < numPairs; ++pairIdx) {
     const int d_at1Idx = d_at1Idxs[pairIdx];
@@ -338,34 +377,14 @@ void NonbondedContrib::getGrad(double *pos, double *grad) const {
       return;
     }
     if (d_contribTypes[pairIdx] & ContribType::VDW) {
-      const double d_R_ij_star = d_R_ij_stars[pairIdx];
-      const double d_wellDepth = d_wellDepths[pairIdx];
-
-      const double q = dist / d_R_ij_star;
-      const double q2 = q * q;
-      const double q6 = q2 * q2 * q2;
-      const double q7 = q6 * q;
-      const double q7pvdw2m1 = q7 + vdw2m1;
-      const double t = vdw1 / (q + vdw1 - 1.0);
-      const double t2 = t * t;
-      const double t7 = t2 * t2 * t2 * t;
-      const double dE_dr = d_wellDepth / d_R_ij_star * t7 *
-                           (-vdw2t7 * q6 / (q7pvdw2m1 * q7pvdw2m1) +
-                            ((-vdw2t7 / q7pvdw2m1 + 14.0) / (q + vdw1m1)));
-      vdwGrad = dE_dr / dist;
+      vdwGrad =
+          vdWGradient(dist, d_R_ij_stars[pairIdx], d_wellDepths[pairIdx]) /
+          dist;
     }
     if (d_contribTypes[pairIdx] & ContribType::ELECTROSTATIC) {
-      const double d_chargeTerm = d_chargeTerms[pairIdx];
-      const std::uint8_t d_dielModel = d_dielModels[pairIdx];
-      const bool d_is1_4 = d_is_1_4s[pairIdx];
-
-      double corr_dist = dist + 0.05;
-      corr_dist *=
-          ((d_dielModel == RDKit::MMFF::DISTANCE) ? corr_dist * corr_dist
-                                                  : corr_dist);
-      const double dE_dr = -332.0716 * (double)(d_dielModel)*d_chargeTerm /
-                           corr_dist * (d_is1_4 ? 0.75 : 1.0);
-      eleGrad = dE_dr / dist;
+      eleGrad = eleGradient(dist, d_chargeTerms[pairIdx],
+                            d_dielModels[pairIdx], d_is_1_4s[pairIdx]) /
+                dist;
     }
     const auto dE_dr = vdwGrad + eleGrad;
     for (unsigned int i = 0; i < 3; ++i) {
@@ -376,5 +395,384 @@ void NonbondedContrib::getGrad(double *pos, double *grad) const {
   }
 }
 
+bool NonbondedContrib::getEnergies(const double *pos, unsigned int numConfs,
+                                   double *energies,
+                                   const unsigned int * /*confIds*/) const {
+  PRECONDITION(pos, "bad vector");
+  PRECONDITION(energies, "bad vector");
+
+  const int numPairs = d_at1Idxs.size();
+  for (int i = 0; i < numPairs; ++i) {
+    const double *p1 = &(pos[3 * d_at1Idxs[i] * numConfs]);
+    const double *p2 = &(pos[3 * d_at2Idxs[i] * numConfs]);
+    const bool hasVdW = d_contribTypes[i] & ContribType::VDW;
+    const bool hasEle = d_contribTypes[i] & ContribType::ELECTROSTATIC;
+    const double d_R_ij_star = d_R_ij_stars[i];
+    const double d_wellDepth = d_wellDepths[i];
+    const double d_chargeTerm = d_chargeTerms[i];
+    const std::uint8_t d_dielModel = d_dielModels[i];
+    const bool d_is1_4 = d_is_1_4s[i];
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      const double dx = p1[c] - p2[c];
+      const double dy = p1[c + numConfs] - p2[c + numConfs];
+      const double dz = p1[c + 2 * numConfs] - p2[c + 2 * numConfs];
+      const double dist = sqrt(dx * dx + dy * dy + dz * dz);
+      if (hasVdW) {
+        energies[c] += vdWEnergy(dist, d_R_ij_star, d_wellDepth);
+      }
+      if (hasEle) {
+        energies[c] += eleEnergy(dist, d_chargeTerm, d_dielModel, d_is1_4);
+      }
+    }
+  }
+  return true;
+}
+
+bool NonbondedContrib::getGrads(const double *pos, unsigned int numConfs,
+                                double *grads,
+                                const unsigned int * /*confIds*/) const {
+  PRECONDITION(pos, "bad vector");
+  PRECONDITION(grads, "bad vector");
+
+  const int numPairs = d_at1Idxs.size();
+  for (int pairIdx = 0; pairIdx < numPairs; ++pairIdx) {
+    const double *p1 = &(pos[3 * d_at1Idxs[pairIdx] * numConfs]);
+    const double *p2 = &(pos[3 * d_at2Idxs[pairIdx] * numConfs]);
+    double *g1 = &(grads[3 * d_at1Idxs[pairIdx] * numConfs]);
+    double *g2 = &(grads[3 * d_at2Idxs[pairIdx] * numConfs]);
+    const bool hasVdW = d_contribTypes[pairIdx] & ContribType::VDW;
+    const bool hasEle = d_contribTypes[pairIdx] & ContribType::ELECTROSTATIC;
+    const double d_R_ij_star = d_R_ij_stars[pairIdx];
+    const double d_wellDepth = d_wellDepths[pairIdx];
+    const double d_chargeTerm = d_chargeTerms[pairIdx];
+    const std::uint8_t d_dielModel = d_dielModels[pairIdx];
+    const bool d_is1_4 = d_is_1_4s[pairIdx];
+    // the gradient used for coincident points
+    const double zeroDistGrad =
+        (hasVdW ? d_R_ij_star * 0.01 : 0.0) + (hasEle ? 0.02 : 0.0);
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      const double d[3] = {p1[c] - p2[c], p1[c + numConfs] - p2[c + numConfs],
+                           p1[c + 2 * numConfs] - p2[c + 2 * numConfs]};
+      const double dist = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+
+      double vdwGrad = 0.0;
+      double eleGrad = 0.0;
+      if (hasVdW) {
+        vdwGrad = vdWGradient(dist, d_R_ij_star, d_wellDepth) / dist;
+      }
+      if (hasEle) {
+        eleGrad =
+            eleGradient(dist, d_chargeTerm, d_dielModel, d_is1_4) / dist;
+      }
+      const auto dE_dr = vdwGrad + eleGrad;
+      for (unsigned int i = 0; i < 3; ++i) {
+        const double dGrad = (dist > 0.0) ? dE_dr * d[i] : zeroDistGrad;
+        g1[c + i * numConfs] += dGrad;
+        g2[c + i * numConfs] -= dGrad;
+      }
+    }
+  }
+  return true;
+}
+
+NonbondedCutoffContrib::NonbondedCutoffContrib(ForceField *owner,
+                                               double cutoff, double skin,
+                                               std::uint8_t dielModel,
+                                               double dielConst,
+                                               double switchWidth)
+    : d_cutoff(cutoff),
+      d_switchOn(std::max(0.0, cutoff - switchWidth)),
+      d_dielModel(dielModel),
+      d_dielConst(dielConst) {
+  PRECONDITION(owner, "bad owner");
+  PRECONDITION(owner->dimension() == 3, "bad dimension");
+  PRECONDITION(dielConst > 0.0, "bad dielectric constant");
+  PRECONDITION(switchWidth >= 0.0, "bad switch width");
+  d_pairs.neighborList = NeighborList(cutoff, skin);
+  dp_forceField = owner;
+  d_vdWTypes.resize(owner->positions().size(), -1);
+  d_partialCharges.resize(owner->positions().size(), 0.0);
+}
+
+void NonbondedCutoffContrib::setAtomParams(unsigned int idx, int vdWType,
+                                           double partialCharge) {
+  URANGE_CHECK(idx, d_vdWTypes.size());
+  d_vdWTypes[idx] = vdWType;
+  d_partialCharges[idx] = partialCharge;
+  invalidate();
+}
+
+void NonbondedCutoffContrib::setVdWParams(
+    unsigned int vdWType1, unsigned int vdWType2,
+    const MMFFVdWRijstarEps &mmffVdWConstants) {
+  const unsigned int numTypes = std::max(vdWType1, vdWType2) + 1;
+  if (numTypes > d_numVdWTypes) {
+    std::vector<double> rijStars(numTypes * numTypes, 0.0);
+    std::vector<double> epsilons(numTypes * numTypes, 0.0);
+    for (unsigned int i = 0; i < d_numVdWTypes; ++i) {
+      for (unsigned int j = 0; j < d_numVdWTypes; ++j) {
+        rijStars[i * numTypes + j] = d_vdWRijStars[i * d_numVdWTypes + j];
+        epsilons[i * numTypes + j] = d_vdWEpsilons[i * d_numVdWTypes + j];
+      }
+    }
+    d_vdWRijStars.swap(rijStars);
+    d_vdWEpsilons.swap(epsilons);
+    d_numVdWTypes = numTypes;
+  }
+  for (const auto idx : {vdWType1 * d_numVdWTypes + vdWType2,
+                         vdWType2 * d_numVdWTypes + vdWType1}) {
+    d_vdWRijStars[idx] = mmffVdWConstants.R_ij_star;
+    d_vdWEpsilons[idx] = mmffVdWConstants.epsilon;
+  }
+  invalidate();
+}
+
+void NonbondedCutoffContrib::addExcludedPair(unsigned int idx1,
+                                             unsigned int idx2) {
+  URANGE_CHECK(idx1, d_vdWTypes.size());
+  URANGE_CHECK(idx2, d_vdWTypes.size());
+  d_pairs.neighborList.addExcludedPair(idx1, idx2);
+  invalidate();
+}
+
+void NonbondedCutoffContrib::add1_4Pair(unsigned int idx1,
+                                        unsigned int idx2) {
+  URANGE_CHECK(idx1, d_vdWTypes.size());
+  URANGE_CHECK(idx2, d_vdWTypes.size());
+  if (idx2 < idx1) {
+    std::swap(idx1, idx2);
+  }
+  if (d_1_4Pairs.size() <= idx1) {
+    d_1_4Pairs.resize(idx1 + 1);
+  }
+  auto &partners = d_1_4Pairs[idx1];
+  auto it = std::lower_bound(partners.begin(), partners.end(), idx2);
+  if (it == partners.end() || *it != idx2) {
+    partners.insert(it, idx2);
+  }
+  invalidate();
+}
+
+void NonbondedCutoffContrib::invalidate() {
+  d_pairs.neighborList.invalidate();
+  // these are copied from d_pairs the next time they are needed:
+  d_batchPairs.clear();
+}
+
+bool NonbondedCutoffContrib::is1_4Pair(unsigned int idx1,
+                                       unsigned int idx2) const {
+  if (idx1 >= d_1_4Pairs.size()) {
+    return false;
+  }
+  const auto &partners = d_1_4Pairs[idx1];
+  return std::binary_search(partners.begin(), partners.end(), idx2);
+}
+
+void NonbondedCutoffContrib::setFragments(std::vector<int> fragMapping) {
+  PRECONDITION(fragMapping.empty() || fragMapping.size() == d_vdWTypes.size(),
+               "bad fragment mapping");
+  d_pairs.neighborList.setGroups(std::move(fragMapping));
+  invalidate();
+}
+
+void NonbondedCutoffContrib::updatePairs(const double *pos,
+                                         PairList &pairs) const {
+  PRECONDITION(dp_forceField, "no owner");
+  PRECONDITION(pos, "bad vector");
+  if (!pairs.neighborList.update(pos, d_vdWTypes.size())) {
+    return;
+  }
+  pairs.at1Idxs.clear();
+  pairs.at2Idxs.clear();
+  pairs.contribTypes.clear();
+  pairs.R_ij_stars.clear();
+  pairs.wellDepths.clear();
+  pairs.chargeTerms.clear();
+  pairs.is_1_4s.clear();
+  const auto &at1Idxs = pairs.neighborList.at1Idxs();
+  const auto &at2Idxs = pairs.neighborList.at2Idxs();
+  for (unsigned int i = 0; i < pairs.neighborList.numPairs(); ++i) {
+    const auto idx1 = at1Idxs[i];
+    const auto idx2 = at2Idxs[i];
+    std::uint8_t contribType = 0;
+    double R_ij_star = 0.0;
+    double wellDepth = 0.0;
+    const int vdWType1 = d_vdWTypes[idx1];
+    const int vdWType2 = d_vdWTypes[idx2];
+    if (vdWType1 >= 0 && vdWType2 >= 0) {
+      CHECK_INVARIANT(static_cast<unsigned int>(vdWType1) < d_numVdWTypes &&
+                          static_cast<unsigned int>(vdWType2) < d_numVdWTypes,
+                      "missing vdW parameters");
+      contribType |= ContribType::VDW;
+      const unsigned int tableIdx = vdWType1 * d_numVdWTypes + vdWType2;
+      R_ij_star = d_vdWRijStars[tableIdx];
+      wellDepth = d_vdWEpsilons[tableIdx];
+    }
+    double chargeTerm = 0.0;
+    if (d_partialCharges[idx1] != 0.0 && d_partialCharges[idx2] != 0.0) {
+      contribType |= ContribType::ELECTROSTATIC;
+      chargeTerm =
+          d_partialCharges[idx1] * d_partialCharges[idx2] / d_dielConst;
+    }
+    if (!contribType) {
+      continue;
+    }
+    pairs.at1Idxs.push_back(idx1);
+    pairs.at2Idxs.push_back(idx2);
+    pairs.contribTypes.push_back(contribType);
+    pairs.R_ij_stars.push_back(R_ij_star);
+    pairs.wellDepths.push_back(wellDepth);
+    pairs.chargeTerms.push_back(chargeTerm);
+    pairs.is_1_4s.push_back(is1_4Pair(idx1, idx2));
+  }
+}
+
+double NonbondedCutoffContrib::calcEnergy(const double *pos,
+                                          PairList &pairs) const {
+  updatePairs(pos, pairs);
+  double energySum = 0.0;
+  const int numPairs = pairs.at1Idxs.size();
+  for (int i = 0; i < numPairs; ++i) {
+    const double *p1 = &(pos[3 * pairs.at1Idxs[i]]);
+    const double *p2 = &(pos[3 * pairs.at2Idxs[i]]);
+    const double dx = p1[0] - p2[0];
+    const double dy = p1[1] - p2[1];
+    const double dz = p1[2] - p2[2];
+    const double dist = sqrt(dx * dx + dy * dy + dz * dz);
+    if (dist >= d_cutoff) {
+      continue;
+    }
+    double energy = 0.0;
+    if (pairs.contribTypes[i] & ContribType::VDW) {
+      energy += vdWEnergy(dist, pairs.R_ij_stars[i], pairs.wellDepths[i]);
+    }
+    if (pairs.contribTypes[i] & ContribType::ELECTROSTATIC) {
+      energy +=
+          eleEnergy(dist, pairs.chargeTerms[i], d_dielModel, pairs.is_1_4s[i]);
+    }
+    double dS_dr;
+    energySum += energy * switchingFunction(dist, d_switchOn, d_cutoff, dS_dr);
+  }
+  return energySum;
+}
+
+void NonbondedCutoffContrib::calcGrad(const double *pos, double *grad,
+                                      PairList &pairs) const {
+  PRECONDITION(grad, "bad vector");
+  updatePairs(pos, pairs);
+  const int numPairs = pairs.at1Idxs.size();
+  for (int pairIdx = 0; pairIdx < numPairs; ++pairIdx) {
+    const double *p1 = &(pos[3 * pairs.at1Idxs[pairIdx]]);
+    const double *p2 = &(pos[3 * pairs.at2Idxs[pairIdx]]);
+    const double d[3] = {p1[0] - p2[0], p1[1] - p2[1], p1[2] - p2[2]};
+    const double dist = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    if (dist >= d_cutoff) {
+      continue;
+    }
+    const bool hasVdW = pairs.contribTypes[pairIdx] & ContribType::VDW;
+    const bool hasEle =
+        pairs.contribTypes[pairIdx] & ContribType::ELECTROSTATIC;
+    const double R_ij_star = pairs.R_ij_stars[pairIdx];
+    const double wellDepth = pairs.wellDepths[pairIdx];
+    const double chargeTerm = pairs.chargeTerms[pairIdx];
+    const bool is1_4 = pairs.is_1_4s[pairIdx];
+    double *g1 = &(grad[3 * pairs.at1Idxs[pairIdx]]);
+    double *g2 = &(grad[3 * pairs.at2Idxs[pairIdx]]);
+    if (dist <= 0.0) {
+      // move in an arbitrary direction
+      const double dGrad =
+          (hasVdW ? R_ij_star * 0.01 : 0.0) + (hasEle ? 0.02 : 0.0);
+      for (unsigned int i = 0; i < 3; ++i) {
+        g1[i] += dGrad;
+        g2[i] -= dGrad;
+      }
+      continue;
+    }
+    double dE_dr = 0.0;
+    if (hasVdW) {
+      dE_dr += vdWGradient(dist, R_ij_star, wellDepth);
+    }
+    if (hasEle) {
+      dE_dr += eleGradient(dist, chargeTerm, d_dielModel, is1_4);
+    }
+    double dS_dr;
+    const double S = switchingFunction(dist, d_switchOn, d_cutoff, dS_dr);
+    dE_dr *= S;
+    if (dS_dr != 0.0) {
+      // the product rule, we are in the switching region
+      double energy = 0.0;
+      if (hasVdW) {
+        energy += vdWEnergy(dist, R_ij_star, wellDepth);
+      }
+      if (hasEle) {
+        energy += eleEnergy(dist, chargeTerm, d_dielModel, is1_4);
+      }
+      dE_dr += energy * dS_dr;
+    }
+    dE_dr /= dist;
+    for (unsigned int i = 0; i < 3; ++i) {
+      const double dGrad = dE_dr * d[i];
+      g1[i] += dGrad;
+      g2[i] -= dGrad;
+    }
+  }
+}
+
+double NonbondedCutoffContrib::getEnergy(double *pos) const {
+  return calcEnergy(pos, d_pairs);
+}
+
+void NonbondedCutoffContrib::getGrad(double *pos, double *grad) const {
+  calcGrad(pos, grad, d_pairs);
+}
+
+NonbondedCutoffContrib::PairList &NonbondedCutoffContrib::getBatchPairs(
+    unsigned int confId) const {
+  if (confId >= d_batchPairs.size()) {
+    d_batchPairs.resize(confId + 1, d_pairs);
+  }
+  return d_batchPairs[confId];
+}
+
+bool NonbondedCutoffContrib::getEnergies(const double *pos,
+                                         unsigned int numConfs,
+                                         double *energies,
+                                         const unsigned int *confIds) const {
+  PRECONDITION(pos, "bad vector");
+  PRECONDITION(energies, "bad vector");
+  const unsigned int dim = 3 * d_vdWTypes.size();
+  std::vector<double> confPos(dim);
+  for (unsigned int c = 0; c < numConfs; ++c) {
+    for (unsigned int i = 0; i < dim; ++i) {
+      confPos[i] = pos[i * numConfs + c];
+    }
+    energies[c] +=
+        calcEnergy(confPos.data(), getBatchPairs(confIds ? confIds[c] : c));
+  }
+  return true;
+}
+
+bool NonbondedCutoffContrib::getGrads(const double *pos, unsigned int numConfs,
+                                      double *grads,
+                                      const unsigned int *confIds) const {
+  PRECONDITION(pos, "bad vector");
+  PRECONDITION(grads, "bad vector");
+  const unsigned int dim = 3 * d_vdWTypes.size();
+  std::vector<double> confPos(dim);
+  std::vector<double> confGrad(dim);
+  for (unsigned int c = 0; c < numConfs; ++c) {
+    for (unsigned int i = 0; i < dim; ++i) {
+      confPos[i] = pos[i * numConfs + c];
+    }
+    std::fill(confGrad.begin(), confGrad.end(), 0.0);
+    calcGrad(confPos.data(), confGrad.data(),
+             getBatchPairs(confIds ? confIds[c] : c));
+    for (unsigned int i = 0; i < dim; ++i) {
+      grads[i * numConfs + c] += confGrad[i];
+    }
+  }
+  return true;
+}
+
 }  // namespace MMFF
 }  // namespace ForceFields
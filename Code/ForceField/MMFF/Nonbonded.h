@@ -10,6 +10,7 @@
 #ifndef __RD_MMFFNONBONDED_H__
 #define __RD_MMFFNONBONDED_H__
 #include <ForceField/Contrib.h>
+#include <ForceField/NeighborList.h>
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/ForceFieldHelpers/MMFF/AtomTyper.h>
 
@@ -29,6 +30,11 @@ class RDKIT_FORCEFIELD_EXPORT NonbondedContrib : public ForceFieldContrib {
                double chargeTerm, std::uint8_t dielModel, bool is1_4);
   double getEnergy(double *pos) const override;
   void getGrad(double *pos, double *grad) const override;
+  bool getEnergies(const double *pos, unsigned int numConfs,
+                   double *energies,
+                   const unsigned int *confIds) const override;
+  bool getGrads(const double *pos, unsigned int numConfs, double *grads,
+                const unsigned int *confIds) const override;
   NonbondedContrib *copy() const override {
     return new NonbondedContrib(*this);
   }
@@ -51,6 +57,119 @@ class RDKIT_FORCEFIELD_EXPORT NonbondedContrib : public ForceFieldContrib {
       d_dielModels;  //!< dielectric model (1: constant; 2: distance-dependent)
 };
 
+//! combined vdW and charge terms for MMFF, evaluated with a distance cutoff
+/*!
+  Instead of a fixed list of atom pairs, this stores the parameters of the
+  atoms and uses a NeighborList to find the pairs which are closer than the
+  cutoff, so its memory use grows linearly with the number of atoms. The
+  interactions are switched off smoothly over the last \c switchWidth
+  before the cutoff, see ForceFields::switchingFunction(), so the energy
+  and the gradient are continuous and pairs which are further apart than
+  the cutoff make no contribution.
+
+  The neighbor list is rebuilt whenever an atom has moved by more than half
+  of the skin distance since it was last built. When batches of
+  conformations are evaluated, each conformation has its own neighbor list,
+  which is kept from one batch to the next. The conformations are
+  identified by the \c confIds passed to getEnergies() and getGrads(), so
+  the lists stay with their conformations when the makeup of the batch
+  changes.
+*/
+class RDKIT_FORCEFIELD_EXPORT NonbondedCutoffContrib
+    : public ForceFieldContrib {
+ public:
+  NonbondedCutoffContrib() {}
+  //! Constructor
+  /*!
+    \param owner      pointer to the owning ForceField
+    \param cutoff     the cutoff distance
+    \param skin       the skin distance of the neighbor list
+    \param dielModel  the dielectric model
+    \param dielConst  the dielectric constant
+    \param switchWidth the width of the region before the cutoff in which
+                       the interactions are switched off
+  */
+  NonbondedCutoffContrib(ForceField *owner, double cutoff, double skin,
+                         std::uint8_t dielModel, double dielConst,
+                         double switchWidth = 1.0);
+  //! sets the vdW type and the partial charge of an atom
+  /*!
+    Atoms with a negative \c vdWType have no vdW interactions, atoms with a
+    zero partial charge have no electrostatic interactions.
+  */
+  void setAtomParams(unsigned int idx, int vdWType, double partialCharge);
+  //! sets the vdW parameters for a pair of vdW types
+  void setVdWParams(unsigned int vdWType1, unsigned int vdWType2,
+                    const MMFFVdWRijstarEps &mmffVdWConstants);
+  //! excludes a pair of atoms (1,2 or 1,3 relationship)
+  void addExcludedPair(unsigned int idx1, unsigned int idx2);
+  //! flags a pair of atoms in a 1,4 relationship
+  void add1_4Pair(unsigned int idx1, unsigned int idx2);
+  //! only atoms which have the same fragment index interact
+  void setFragments(std::vector<int> fragMapping);
+  double getEnergy(double *pos) const override;
+  void getGrad(double *pos, double *grad) const override;
+  bool getEnergies(const double *pos, unsigned int numConfs,
+                   double *energies,
+                   const unsigned int *confIds) const override;
+  bool getGrads(const double *pos, unsigned int numConfs, double *grads,
+                const unsigned int *confIds) const override;
+  NonbondedCutoffContrib *copy() const override {
+    return new NonbondedCutoffContrib(*this);
+  }
+  double cutoff() const { return d_cutoff; }
+  //! the distance at which the interactions start to be switched off
+  double switchOn() const { return d_switchOn; }
+  //! returns our neighbor list
+  const NeighborList &neighborList() const { return d_pairs.neighborList; }
+  //! returns the neighbor list used for conformation \c confId in batches,
+  //! see ForceFieldContrib::getEnergies()
+  const NeighborList &batchNeighborList(unsigned int confId) const {
+    URANGE_CHECK(confId, d_batchPairs.size());
+    return d_batchPairs[confId].neighborList;
+  }
+
+ private:
+  enum ContribType {
+    VDW = 1 << 0,           //!< van der Waals contribution
+    ELECTROSTATIC = 1 << 1  //!< electrostatic contribution
+  };
+  //! a neighbor list and the parameters of the pairs in it
+  struct PairList {
+    NeighborList neighborList;
+    std::vector<std::uint32_t> at1Idxs;
+    std::vector<std::uint32_t> at2Idxs;
+    std::vector<std::uint8_t> contribTypes;
+    std::vector<double> R_ij_stars;
+    std::vector<double> wellDepths;
+    std::vector<double> chargeTerms;
+    std::vector<std::uint8_t> is_1_4s;
+  };
+  //! updates the neighbor list and, if it changed, the pair parameters
+  void updatePairs(const double *pos, PairList &pairs) const;
+  double calcEnergy(const double *pos, PairList &pairs) const;
+  void calcGrad(const double *pos, double *grad, PairList &pairs) const;
+  //! returns the pairs used for conformation \c confId in batches
+  PairList &getBatchPairs(unsigned int confId) const;
+  //! forces all of the neighbor lists to be rebuilt
+  void invalidate();
+  bool is1_4Pair(unsigned int idx1, unsigned int idx2) const;
+
+  double d_cutoff{0.0};
+  double d_switchOn{0.0};
+  std::uint8_t d_dielModel{0};
+  double d_dielConst{1.0};
+  std::vector<int> d_vdWTypes;
+  std::vector<double> d_partialCharges;
+  unsigned int d_numVdWTypes{0};
+  std::vector<double> d_vdWRijStars;  //!< R*ij for each pair of vdW types
+  std::vector<double> d_vdWEpsilons;  //!< epsilon for each pair of vdW types
+  std::vector<std::vector<std::uint32_t>> d_1_4Pairs;
+  mutable PairList d_pairs;
+  //! indexed by the conformation ids of the batches
+  mutable std::vector<PairList> d_batchPairs;
+};
+
 //! the van der Waals term for MMFF
 class RDKIT_FORCEFIELD_EXPORT VdWContrib : public ForceFieldContrib {
  public:
@@ -0,0 +1,190 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include "NeighborList.h"
+#include <algorithm>
+#include <cmath>
+#include <RDGeneral/Invariant.h>
+
+namespace ForceFields {
+NeighborList::NeighborList(double cutoff, double skin)
+    : d_cutoff(cutoff), d_skin(skin) {
+  PRECONDITION(cutoff > 0.0, "bad cutoff");
+  PRECONDITION(skin >= 0.0, "bad skin");
+}
+
+void NeighborList::addExcludedPair(unsigned int idx1, unsigned int idx2) {
+  if (idx1 == idx2) {
+    return;
+  }
+  if (idx2 < idx1) {
+    std::swap(idx1, idx2);
+  }
+  if (d_excluded.size() <= idx1) {
+    d_excluded.resize(idx1 + 1);
+  }
+  auto &excluded = d_excluded[idx1];
+  auto it = std::lower_bound(excluded.begin(), excluded.end(), idx2);
+  if (it == excluded.end() || *it != idx2) {
+    excluded.insert(it, idx2);
+  }
+  invalidate();
+}
+
+bool NeighborList::isExcluded(unsigned int idx1, unsigned int idx2) const {
+  if (!d_groups.empty() && d_groups[idx1] != d_groups[idx2]) {
+    return true;
+  }
+  if (idx2 < idx1) {
+    std::swap(idx1, idx2);
+  }
+  if (idx1 >= d_excluded.size()) {
+    return false;
+  }
+  const auto &excluded = d_excluded[idx1];
+  return std::binary_search(excluded.begin(), excluded.end(), idx2);
+}
+
+bool NeighborList::needsRebuild(const double *pos,
+                                unsigned int numPoints) const {
+  PRECONDITION(pos || !numPoints, "bad position vector");
+  if (d_refPos.size() != 3 * numPoints) {
+    return true;
+  }
+  const double maxDisp2 = 0.25 * d_skin * d_skin;
+  for (unsigned int i = 0; i < numPoints; ++i) {
+    const double dx = pos[3 * i] - d_refPos[3 * i];
+    const double dy = pos[3 * i + 1] - d_refPos[3 * i + 1];
+    const double dz = pos[3 * i + 2] - d_refPos[3 * i + 2];
+    if (dx * dx + dy * dy + dz * dz > maxDisp2) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool NeighborList::update(const double *pos, unsigned int numPoints) {
+  if (!needsRebuild(pos, numPoints)) {
+    return false;
+  }
+  build(pos, numPoints);
+  return true;
+}
+
+void NeighborList::build(const double *pos, unsigned int numPoints) {
+  PRECONDITION(pos || !numPoints, "bad position vector");
+  PRECONDITION(d_cutoff > 0.0, "bad cutoff");
+  PRECONDITION(d_groups.empty() || d_groups.size() == numPoints,
+               "bad group vector");
+  ++d_numBuilds;
+  d_refPos.assign(pos, pos + 3 * numPoints);
+  d_at1Idxs.clear();
+  d_at2Idxs.clear();
+  if (numPoints < 2) {
+    return;
+  }
+
+  // bin the points into cells which are at least as large as the
+  // list cutoff, so that only neighboring cells need to be searched:
+  const double listCutoff = d_cutoff + d_skin;
+  const double listCutoff2 = listCutoff * listCutoff;
+  double minCoords[3], maxCoords[3];
+  for (unsigned int d = 0; d < 3; ++d) {
+    minCoords[d] = maxCoords[d] = pos[d];
+  }
+  for (unsigned int i = 1; i < numPoints; ++i) {
+    for (unsigned int d = 0; d < 3; ++d) {
+      minCoords[d] = std::min(minCoords[d], pos[3 * i + d]);
+      maxCoords[d] = std::max(maxCoords[d], pos[3 * i + d]);
+    }
+  }
+  double cellSize = listCutoff;
+  unsigned int numCells[3];
+  // sparse systems would end up with many more cells than points, so we
+  // make the cells larger in that case:
+  const double maxCells = 8.0 * numPoints;
+  while (true) {
+    double totalCells = 1.0;
+    for (unsigned int d = 0; d < 3; ++d) {
+      numCells[d] = static_cast<unsigned int>(
+          std::min((maxCoords[d] - minCoords[d]) / cellSize + 1.0, maxCells));
+      totalCells *= numCells[d];
+    }
+    if (totalCells <= maxCells) {
+      break;
+    }
+    cellSize *= 1.5;
+  }
+  const size_t totalCells =
+      static_cast<size_t>(numCells[0]) * numCells[1] * numCells[2];
+
+  std::vector<unsigned int> pointCells(numPoints);
+  std::vector<unsigned int> cellStarts(totalCells + 1, 0);
+  for (unsigned int i = 0; i < numPoints; ++i) {
+    unsigned int cell = 0;
+    for (unsigned int d = 0; d < 3; ++d) {
+      auto ci = static_cast<unsigned int>((pos[3 * i + d] - minCoords[d]) /
+                                          cellSize);
+      cell = cell * numCells[d] + std::min(ci, numCells[d] - 1);
+    }
+    pointCells[i] = cell;
+    ++cellStarts[cell + 1];
+  }
+  for (size_t cell = 0; cell < totalCells; ++cell) {
+    cellStarts[cell + 1] += cellStarts[cell];
+  }
+  std::vector<unsigned int> cellPoints(numPoints);
+  {
+    std::vector<unsigned int> fill(cellStarts.begin(), cellStarts.end() - 1);
+    for (unsigned int i = 0; i < numPoints; ++i) {
+      cellPoints[fill[pointCells[i]]++] = i;
+    }
+  }
+
+  std::vector<unsigned int> nbrs;
+  for (unsigned int i = 0; i < numPoints; ++i) {
+    unsigned int cell = pointCells[i];
+    const unsigned int cz = cell % numCells[2];
+    cell /= numCells[2];
+    const unsigned int cy = cell % numCells[1];
+    const unsigned int cx = cell / numCells[1];
+    nbrs.clear();
+    for (unsigned int x = (cx ? cx - 1 : 0);
+         x <= std::min(cx + 1, numCells[0] - 1); ++x) {
+      for (unsigned int y = (cy ? cy - 1 : 0);
+           y <= std::min(cy + 1, numCells[1] - 1); ++y) {
+        for (unsigned int z = (cz ? cz - 1 : 0);
+             z <= std::min(cz + 1, numCells[2] - 1); ++z) {
+          const size_t nbrCell = (x * numCells[1] + y) * numCells[2] + z;
+          for (unsigned int k = cellStarts[nbrCell];
+               k < cellStarts[nbrCell + 1]; ++k) {
+            const unsigned int j = cellPoints[k];
+            if (j <= i) {
+              continue;
+            }
+            const double dx = pos[3 * i] - pos[3 * j];
+            const double dy = pos[3 * i + 1] - pos[3 * j + 1];
+            const double dz = pos[3 * i + 2] - pos[3 * j + 2];
+            if (dx * dx + dy * dy + dz * dz < listCutoff2 &&
+                !isExcluded(i, j)) {
+              nbrs.push_back(j);
+            }
+          }
+        }
+      }
+    }
+    // keep the order of the pairs independent of the grid:
+    std::sort(nbrs.begin(), nbrs.end());
+    for (const auto j : nbrs) {
+      d_at1Idxs.push_back(i);
+      d_at2Idxs.push_back(j);
+    }
+  }
+}
+}  // namespace ForceFields
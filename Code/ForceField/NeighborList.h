@@ -0,0 +1,122 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include <RDGeneral/export.h>
+#ifndef RD_FFNEIGHBORLIST_H
+#define RD_FFNEIGHBORLIST_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ForceFields {
+
+//! A Verlet neighbor list for 3D points
+/*!
+   The list contains all pairs of points which are closer than
+   <tt>cutoff + skin</tt>. It is built by binning the points into a grid of
+   cells, so building it is roughly linear in the number of points.
+
+   As long as no point has moved by more than half of the skin since the
+   list was built, every pair which is closer than the cutoff is guaranteed
+   to be in the list, so update() only rebuilds the list when that is no
+   longer true.
+
+   Pairs can be excluded from the list, either individually with
+   addExcludedPair() or by assigning the points to groups with setGroups().
+*/
+class RDKIT_FORCEFIELD_EXPORT NeighborList {
+ public:
+  NeighborList() {}
+  //! construct with the cutoff and the skin distance
+  NeighborList(double cutoff, double skin);
+
+  //! never include the pair \c idx1 - \c idx2 in the list
+  void addExcludedPair(unsigned int idx1, unsigned int idx2);
+  //! only include pairs of points which have the same group index
+  void setGroups(std::vector<int> groups) {
+    d_groups = std::move(groups);
+    invalidate();
+  }
+  //! forces the list to be rebuilt by the next call to update()
+  void invalidate() { d_refPos.clear(); }
+
+  //! rebuilds the list if any point has moved too much since it was built
+  /*!
+    \param pos       the coordinates, should be \c 3*numPoints long
+    \param numPoints the number of points
+
+    \return whether or not the list was rebuilt
+  */
+  bool update(const double *pos, unsigned int numPoints);
+
+  //! rebuilds the list
+  void build(const double *pos, unsigned int numPoints);
+
+  //! returns whether or not the list needs to be rebuilt for \c pos
+  bool needsRebuild(const double *pos, unsigned int numPoints) const;
+
+  //! the first points of the pairs in the list
+  const std::vector<std::uint32_t> &at1Idxs() const { return d_at1Idxs; }
+  //! the second points of the pairs in the list
+  const std::vector<std::uint32_t> &at2Idxs() const { return d_at2Idxs; }
+  unsigned int numPairs() const { return d_at1Idxs.size(); }
+
+  double cutoff() const { return d_cutoff; }
+  double skin() const { return d_skin; }
+  //! the number of times the list has been built
+  unsigned int numBuilds() const { return d_numBuilds; }
+
+ private:
+  bool isExcluded(unsigned int idx1, unsigned int idx2) const;
+
+  double d_cutoff{0.0};
+  double d_skin{0.0};
+  unsigned int d_numBuilds{0};
+  std::vector<double> d_refPos;  //!< the positions at the last build
+  std::vector<std::uint32_t> d_at1Idxs;
+  std::vector<std::uint32_t> d_at2Idxs;
+  //! the excluded partners of each point, sorted
+  std::vector<std::vector<std::uint32_t>> d_excluded;
+  std::vector<int> d_groups;
+};
+
+//! switches interactions off smoothly between \c switchOn and \c cutoff
+/*!
+   Returns 1 for distances up to \c switchOn, 0 for distances beyond
+   \c cutoff and goes smoothly from 1 to 0 in between (this is the
+   switching function used by CHARMM). Energies which are multiplied by it
+   and their gradients are continuous at the cutoff.
+
+   \param dist      the distance
+   \param switchOn  the distance at which the switching starts
+   \param cutoff    the cutoff distance
+   \param dS_dr     used to return the derivative of the switching function
+
+   \return the value of the switching function
+*/
+inline double switchingFunction(double dist, double switchOn, double cutoff,
+                                double &dS_dr) {
+  dS_dr = 0.0;
+  if (dist <= switchOn) {
+    return 1.0;
+  }
+  if (dist >= cutoff) {
+    return 0.0;
+  }
+  const double cutoff2 = cutoff * cutoff;
+  const double switchOn2 = switchOn * switchOn;
+  const double dist2 = dist * dist;
+  const double denom = cutoff2 - switchOn2;
+  const double denom3 = denom * denom * denom;
+  dS_dr = 12.0 * dist * (cutoff2 - dist2) * (switchOn2 - dist2) / denom3;
+  return (cutoff2 - dist2) * (cutoff2 - dist2) *
+         (cutoff2 + 2.0 * dist2 - 3.0 * switchOn2) / denom3;
+}
+}  // namespace ForceFields
+#endif
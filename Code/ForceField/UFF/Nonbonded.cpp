@@ -9,6 +9,7 @@
 //
 #include "Nonbonded.h"
 #include "Params.h"
+#include <algorithm>
 #include <cmath>
 #include <ForceField/ForceField.h>
 #include <RDGeneral/Invariant.h>
@@ -100,5 +101,200 @@ void vdWContrib::getGrad(double *pos, double *grad) const {
     grad[3 * d_at2Idx + i] -= dGrad;
   }
 }
+
+vdWCutoffContrib::vdWCutoffContrib(ForceField *owner, double cutoff,
+                                   double skin, double switchWidth)
+    : d_cutoff(cutoff), d_switchOn(std::max(0.0, cutoff - switchWidth)) {
+  PRECONDITION(owner, "bad owner");
+  PRECONDITION(owner->dimension() == 3, "bad dimension");
+  PRECONDITION(switchWidth >= 0.0, "bad switch width");
+  dp_forceField = owner;
+  d_pairs.neighborList = NeighborList(cutoff, skin);
+  const unsigned int numAtoms = owner->positions().size();
+  d_hasParams.resize(numAtoms, 0);
+  d_x1s.resize(numAtoms, 0.0);
+  d_D1s.resize(numAtoms, 0.0);
+}
+
+void vdWCutoffContrib::setAtomParams(unsigned int idx,
+                                     const AtomicParams *atParams) {
+  URANGE_CHECK(idx, d_hasParams.size());
+  d_hasParams[idx] = atParams != nullptr;
+  d_x1s[idx] = atParams ? atParams->x1 : 0.0;
+  d_D1s[idx] = atParams ? atParams->D1 : 0.0;
+  invalidate();
+}
+
+void vdWCutoffContrib::addExcludedPair(unsigned int idx1, unsigned int idx2) {
+  URANGE_CHECK(idx1, d_hasParams.size());
+  URANGE_CHECK(idx2, d_hasParams.size());
+  d_pairs.neighborList.addExcludedPair(idx1, idx2);
+  invalidate();
+}
+
+void vdWCutoffContrib::setFragments(std::vector<int> fragMapping) {
+  PRECONDITION(
+      fragMapping.empty() || fragMapping.size() == d_hasParams.size(),
+      "bad fragment mapping");
+  d_pairs.neighborList.setGroups(std::move(fragMapping));
+  invalidate();
+}
+
+void vdWCutoffContrib::invalidate() {
+  d_pairs.neighborList.invalidate();
+  // these are copied from d_pairs the next time they are needed:
+  d_batchPairs.clear();
+}
+
+void vdWCutoffContrib::updatePairs(const double *pos, PairList &pairs) const {
+  PRECONDITION(dp_forceField, "no owner");
+  PRECONDITION(pos, "bad vector");
+  if (!pairs.neighborList.update(pos, d_hasParams.size())) {
+    return;
+  }
+  pairs.at1Idxs.clear();
+  pairs.at2Idxs.clear();
+  pairs.xijs.clear();
+  pairs.wellDepths.clear();
+  const auto &at1Idxs = pairs.neighborList.at1Idxs();
+  const auto &at2Idxs = pairs.neighborList.at2Idxs();
+  for (unsigned int i = 0; i < pairs.neighborList.numPairs(); ++i) {
+    const auto idx1 = at1Idxs[i];
+    const auto idx2 = at2Idxs[i];
+    if (!d_hasParams[idx1] || !d_hasParams[idx2]) {
+      continue;
+    }
+    pairs.at1Idxs.push_back(idx1);
+    pairs.at2Idxs.push_back(idx2);
+    // UFF uses the geometric mean of the vdW parameters, see
+    // Utils::calcNonbondedMinimum() and Utils::calcNonbondedDepth():
+    pairs.xijs.push_back(sqrt(d_x1s[idx1] * d_x1s[idx2]));
+    pairs.wellDepths.push_back(sqrt(d_D1s[idx1] * d_D1s[idx2]));
+  }
+}
+
+double vdWCutoffContrib::calcEnergy(const double *pos, PairList &pairs) const {
+  updatePairs(pos, pairs);
+  double res = 0.0;
+  const unsigned int numPairs = pairs.at1Idxs.size();
+  for (unsigned int i = 0; i < numPairs; ++i) {
+    const double *p1 = &(pos[3 * pairs.at1Idxs[i]]);
+    const double *p2 = &(pos[3 * pairs.at2Idxs[i]]);
+    const double dx = p1[0] - p2[0];
+    const double dy = p1[1] - p2[1];
+    const double dz = p1[2] - p2[2];
+    const double dist = sqrt(dx * dx + dy * dy + dz * dz);
+    if (dist >= d_cutoff || dist <= 0.0) {
+      continue;
+    }
+    const double r = pairs.xijs[i] / dist;
+    const double r6 = int_pow<6>(r);
+    const double r12 = r6 * r6;
+    double dS_dr;
+    res += pairs.wellDepths[i] * (r12 - 2.0 * r6) *
+           switchingFunction(dist, d_switchOn, d_cutoff, dS_dr);
+  }
+  return res;
+}
+
+void vdWCutoffContrib::calcGrad(const double *pos, double *grad,
+                                PairList &pairs) const {
+  PRECONDITION(grad, "bad vector");
+  updatePairs(pos, pairs);
+  const unsigned int numPairs = pairs.at1Idxs.size();
+  for (unsigned int pairIdx = 0; pairIdx < numPairs; ++pairIdx) {
+    const double *p1 = &(pos[3 * pairs.at1Idxs[pairIdx]]);
+    const double *p2 = &(pos[3 * pairs.at2Idxs[pairIdx]]);
+    double *g1 = &(grad[3 * pairs.at1Idxs[pairIdx]]);
+    double *g2 = &(grad[3 * pairs.at2Idxs[pairIdx]]);
+    const double d[3] = {p1[0] - p2[0], p1[1] - p2[1], p1[2] - p2[2]};
+    const double dist = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    if (dist >= d_cutoff) {
+      continue;
+    }
+    if (dist <= 0) {
+      for (int i = 0; i < 3; i++) {
+        // move in an arbitrary direction
+        double dGrad = 100.0;
+        g1[i] += dGrad;
+        g2[i] -= dGrad;
+      }
+      continue;
+    }
+    const double xij = pairs.xijs[pairIdx];
+    const double wellDepth = pairs.wellDepths[pairIdx];
+    const double r = xij / dist;
+    const double r7 = int_pow<7>(r);
+    const double r13 = int_pow<13>(r);
+    double dS_dr;
+    const double S = switchingFunction(dist, d_switchOn, d_cutoff, dS_dr);
+    double preFactor = 12. * wellDepth / xij * (r7 - r13) * S;
+    if (dS_dr != 0.0) {
+      // the product rule, we are in the switching region
+      const double r6 = r7 / r;
+      preFactor += wellDepth * (r6 * r6 - 2.0 * r6) * dS_dr;
+    }
+    for (int i = 0; i < 3; i++) {
+      const double dGrad = preFactor * d[i] / dist;
+      g1[i] += dGrad;
+      g2[i] -= dGrad;
+    }
+  }
+}
+
+double vdWCutoffContrib::getEnergy(double *pos) const {
+  return calcEnergy(pos, d_pairs);
+}
+
+void vdWCutoffContrib::getGrad(double *pos, double *grad) const {
+  calcGrad(pos, grad, d_pairs);
+}
+
+vdWCutoffContrib::PairList &vdWCutoffContrib::getBatchPairs(
+    unsigned int confId) const {
+  if (confId >= d_batchPairs.size()) {
+    d_batchPairs.resize(confId + 1, d_pairs);
+  }
+  return d_batchPairs[confId];
+}
+
+bool vdWCutoffContrib::getEnergies(const double *pos, unsigned int numConfs,
+                                   double *energies,
+                                   const unsigned int *confIds) const {
+  PRECONDITION(pos, "bad vector");
+  PRECONDITION(energies, "bad vector");
+  const unsigned int dim = 3 * d_hasParams.size();
+  std::vector<double> confPos(dim);
+  for (unsigned int c = 0; c < numConfs; ++c) {
+    for (unsigned int i = 0; i < dim; ++i) {
+      confPos[i] = pos[i * numConfs + c];
+    }
+    energies[c] +=
+        calcEnergy(confPos.data(), getBatchPairs(confIds ? confIds[c] : c));
+  }
+  return true;
+}
+
+bool vdWCutoffContrib::getGrads(const double *pos, unsigned int numConfs,
+                                double *grads,
+                                const unsigned int *confIds) const {
+  PRECONDITION(pos, "bad vector");
+  PRECONDITION(grads, "bad vector");
+  const unsigned int dim = 3 * d_hasParams.size();
+  std::vector<double> confPos(dim);
+  std::vector<double> confGrad(dim);
+  for (unsigned int c = 0; c < numConfs; ++c) {
+    for (unsigned int i = 0; i < dim; ++i) {
+      confPos[i] = pos[i * numConfs + c];
+    }
+    std::fill(confGrad.begin(), confGrad.end(), 0.0);
+    calcGrad(confPos.data(), confGrad.data(),
+             getBatchPairs(confIds ? confIds[c] : c));
+    for (unsigned int i = 0; i < dim; ++i) {
+      grads[i * numConfs + c] += confGrad[i];
+    }
+  }
+  return true;
+}
 }  // namespace UFF
 }  // namespace ForceFields
@@ -11,6 +11,9 @@
 #ifndef __RD_NONBONDED_H__
 #define __RD_NONBONDED_H__
 #include <ForceField/Contrib.h>
+#include <ForceField/NeighborList.h>
+#include <RDGeneral/Invariant.h>
+#include <vector>
 
 namespace ForceFields {
 namespace UFF {
@@ -57,6 +60,96 @@ class RDKIT_FORCEFIELD_EXPORT vdWContrib : public ForceFieldContrib {
   double d_wellDepth;  //!< the vdW well depth (strength of the interaction)
   double d_thresh;     //!< the distance threshold
 };
+//! the van der Waals term for the Universal Force Field, evaluated with a
+//! distance cutoff
+/*!
+  Instead of one contribution per atom pair, this stores the parameters of
+  the atoms and uses a NeighborList to find the pairs which are closer than
+  the cutoff, so its memory use grows linearly with the number of atoms.
+  The interactions are switched off smoothly over the last \c switchWidth
+  before the cutoff, see ForceFields::switchingFunction(), so the energy
+  and the gradient are continuous and pairs which are further apart than
+  the cutoff make no contribution.
+
+  The neighbor list is rebuilt whenever an atom has moved by more than half
+  of the skin distance since it was last built. When batches of
+  conformations are evaluated, each conformation has its own neighbor list,
+  which is kept from one batch to the next. The conformations are
+  identified by the \c confIds passed to getEnergies() and getGrads(), so
+  the lists stay with their conformations when the makeup of the batch
+  changes.
+ */
+class RDKIT_FORCEFIELD_EXPORT vdWCutoffContrib : public ForceFieldContrib {
+ public:
+  vdWCutoffContrib() {}
+
+  //! Constructor
+  /*!
+    \param owner       pointer to the owning ForceField
+    \param cutoff      the cutoff distance
+    \param skin        the skin distance of the neighbor list
+    \param switchWidth the width of the region before the cutoff in which
+                       the interactions are switched off
+
+  */
+  vdWCutoffContrib(ForceField *owner, double cutoff, double skin,
+                   double switchWidth = 1.0);
+  //! sets the parameters of an atom, atoms without parameters don't interact
+  void setAtomParams(unsigned int idx, const AtomicParams *atParams);
+  //! excludes a pair of atoms (1,2 or 1,3 relationship)
+  void addExcludedPair(unsigned int idx1, unsigned int idx2);
+  //! only atoms which have the same fragment index interact
+  void setFragments(std::vector<int> fragMapping);
+  double getEnergy(double *pos) const override;
+  void getGrad(double *pos, double *grad) const override;
+  bool getEnergies(const double *pos, unsigned int numConfs,
+                   double *energies,
+                   const unsigned int *confIds) const override;
+  bool getGrads(const double *pos, unsigned int numConfs, double *grads,
+                const unsigned int *confIds) const override;
+  vdWCutoffContrib *copy() const override {
+    return new vdWCutoffContrib(*this);
+  }
+  double cutoff() const { return d_cutoff; }
+  //! the distance at which the interactions start to be switched off
+  double switchOn() const { return d_switchOn; }
+  //! returns our neighbor list
+  const NeighborList &neighborList() const { return d_pairs.neighborList; }
+  //! returns the neighbor list used for conformation \c confId in batches,
+  //! see ForceFieldContrib::getEnergies()
+  const NeighborList &batchNeighborList(unsigned int confId) const {
+    URANGE_CHECK(confId, d_batchPairs.size());
+    return d_batchPairs[confId].neighborList;
+  }
+
+ private:
+  //! a neighbor list and the parameters of the pairs in it
+  struct PairList {
+    NeighborList neighborList;
+    std::vector<std::uint32_t> at1Idxs;
+    std::vector<std::uint32_t> at2Idxs;
+    std::vector<double> xijs;
+    std::vector<double> wellDepths;
+  };
+  //! updates the neighbor list and, if it changed, the pair parameters
+  void updatePairs(const double *pos, PairList &pairs) const;
+  double calcEnergy(const double *pos, PairList &pairs) const;
+  void calcGrad(const double *pos, double *grad, PairList &pairs) const;
+  //! returns the pairs used for conformation \c confId in batches
+  PairList &getBatchPairs(unsigned int confId) const;
+  //! forces all of the neighbor lists to be rebuilt
+  void invalidate();
+
+  double d_cutoff{0.0};
+  double d_switchOn{0.0};
+  std::vector<std::uint8_t> d_hasParams;
+  std::vector<double> d_x1s;  //!< the vdW distance of each atom
+  std::vector<double> d_D1s;  //!< the vdW energy of each atom
+  mutable PairList d_pairs;
+  //! indexed by the conformation ids of the batches
+  mutable std::vector<PairList> d_batchPairs;
+};
+
 namespace Utils {
 //! calculates and returns the UFF minimum position for a vdW contact
 /*!
@@ -39,6 +39,15 @@ void ForceFieldAddFixedPoint(PyForceField *self, unsigned int idx) {
   self->field->fixedPoints().push_back(idx);
 }
 
+void ForceFieldSetNumLBFGSCorrections(PyForceField *self,
+                                      unsigned int numCorrections) {
+  self->field->setNumLBFGSCorrections(numCorrections);
+}
+
+unsigned int ForceFieldGetNumLBFGSCorrections(const PyForceField *self) {
+  return self->field->numLBFGSCorrections();
+}
+
 void UFFAddDistanceConstraint(PyForceField *self, unsigned int idx1,
                               unsigned int idx2, bool relative, double minLen,
                               double maxLen, double forceConstant) {
@@ -347,6 +356,16 @@ BOOST_PYTHON_MODULE(rdForceField) {
       .def("AddFixedPoint", ForceFieldAddFixedPoint,
            (python::arg("self"), python::arg("idx")),
            "Adds a fixed point to the force field.")
+      .def("SetNumLBFGSCorrections", ForceFieldSetNumLBFGSCorrections,
+           (python::arg("self"), python::arg("numCorrections")),
+           "Sets the number of corrections stored by the limited-memory "
+           "BFGS minimizer.\n\n  If this is nonzero, Minimize() uses "
+           "L-BFGS, which is much faster for large systems. The default, 0, "
+           "uses the dense BFGS minimizer.")
+      .def("GetNumLBFGSCorrections", ForceFieldGetNumLBFGSCorrections,
+           python::args("self"),
+           "Returns the number of corrections stored by the limited-memory "
+           "BFGS minimizer, 0 means that L-BFGS is not used.")
       .def("UFFAddDistanceConstraint", UFFAddDistanceConstraint,
            (python::arg("self"), python::arg("idx1"), python::arg("idx2"),
             python::arg("relative"), python::arg("minLen"),
@@ -8,6 +8,7 @@
 //  which is included in the file license.txt, found at the root
 //  of the RDKit source tree.
 //
+#include <algorithm>
 #include <cmath>
 #include <RDGeneral/test.h>
 #include <catch2/catch_all.hpp>
@@ -17,6 +18,9 @@
 
 #include <ForceField/AngleConstraints.h>
 #include <ForceField/DistanceConstraints.h>
+#include <ForceField/NeighborList.h>
+#include <ForceField/MMFF/Nonbonded.h>
+#include <ForceField/UFF/Nonbonded.h>
 #include <ForceField/UFF/Params.h>
 
 using namespace RDKit;
@@ -111,3 +115,195 @@ TEST_CASE("Test AngleConstraintContribs") {
     CHECK(feq(get_angle(*mol, 1, 2, 3), 160.0));
   }
 }
+
+TEST_CASE("Test NeighborList") {
+  // a jittered grid of points:
+  const unsigned int numPoints = 300;
+  std::vector<double> pos(3 * numPoints);
+  for (unsigned int i = 0; i < numPoints; ++i) {
+    pos[3 * i] = 1.5 * (i % 7) + 0.3 * sin(1.7 * i);
+    pos[3 * i + 1] = 1.5 * ((i / 7) % 6) + 0.3 * cos(0.7 * i);
+    pos[3 * i + 2] = 1.5 * (i / 42) + 0.3 * sin(2.3 * i);
+  }
+  auto bruteForce = [&](double listCutoff, const std::vector<int> &groups) {
+    std::vector<std::pair<unsigned int, unsigned int>> res;
+    for (unsigned int i = 0; i < numPoints; ++i) {
+      for (unsigned int j = i + 1; j < numPoints; ++j) {
+        if (!groups.empty() && groups[i] != groups[j]) {
+          continue;
+        }
+        double d2 = 0.0;
+        for (unsigned int k = 0; k < 3; ++k) {
+          d2 += (pos[3 * i + k] - pos[3 * j + k]) *
+                (pos[3 * i + k] - pos[3 * j + k]);
+        }
+        if (d2 < listCutoff * listCutoff) {
+          res.emplace_back(i, j);
+        }
+      }
+    }
+    return res;
+  };
+  auto pairs = [](const ForceFields::NeighborList &nbrList) {
+    std::vector<std::pair<unsigned int, unsigned int>> res;
+    for (unsigned int i = 0; i < nbrList.numPairs(); ++i) {
+      res.emplace_back(nbrList.at1Idxs()[i], nbrList.at2Idxs()[i]);
+    }
+    return res;
+  };
+  SECTION("matches the brute force result") {
+    for (const auto cutoff : {1.0, 2.5, 4.0, 50.0}) {
+      ForceFields::NeighborList nbrList(cutoff, 1.0);
+      CHECK(nbrList.update(pos.data(), numPoints));
+      CHECK(pairs(nbrList) == bruteForce(cutoff + 1.0, {}));
+    }
+  }
+  SECTION("exclusions and groups") {
+    ForceFields::NeighborList nbrList(3.0, 0.5);
+    std::vector<int> groups(numPoints);
+    for (unsigned int i = 0; i < numPoints; ++i) {
+      groups[i] = i % 3;
+    }
+    nbrList.setGroups(groups);
+    nbrList.addExcludedPair(42, 0);
+    nbrList.update(pos.data(), numPoints);
+    auto expected = bruteForce(3.5, groups);
+    auto excluded =
+        std::find(expected.begin(), expected.end(), std::make_pair(0u, 42u));
+    REQUIRE(excluded != expected.end());
+    expected.erase(excluded);
+    CHECK(pairs(nbrList) == expected);
+  }
+  SECTION("the list is only rebuilt when needed") {
+    ForceFields::NeighborList nbrList(3.0, 1.0);
+    CHECK(nbrList.update(pos.data(), numPoints));
+    CHECK(nbrList.numBuilds() == 1);
+    pos[0] += 0.4;
+    CHECK(!nbrList.update(pos.data(), numPoints));
+    CHECK(nbrList.numBuilds() == 1);
+    pos[0] += 0.2;
+    CHECK(nbrList.update(pos.data(), numPoints));
+    CHECK(nbrList.numBuilds() == 2);
+    nbrList.invalidate();
+    CHECK(nbrList.update(pos.data(), numPoints));
+    CHECK(nbrList.numBuilds() == 3);
+  }
+}
+
+TEST_CASE("Test switched cutoff contribs") {
+  const double cutoff = 6.0;
+  const double switchWidth = 2.0;
+  const double h = 1e-6;
+  SECTION("the switching function") {
+    const double switchOn = cutoff - switchWidth;
+    double dS_dr;
+    CHECK(ForceFields::switchingFunction(3.0, switchOn, cutoff, dS_dr) == 1.0);
+    CHECK(dS_dr == 0.0);
+    CHECK(ForceFields::switchingFunction(6.5, switchOn, cutoff, dS_dr) == 0.0);
+    CHECK(dS_dr == 0.0);
+    CHECK_THAT(
+        ForceFields::switchingFunction(switchOn + h, switchOn, cutoff, dS_dr),
+        Catch::Matchers::WithinAbs(1.0, 1e-9));
+    CHECK_THAT(
+        ForceFields::switchingFunction(cutoff - h, switchOn, cutoff, dS_dr),
+        Catch::Matchers::WithinAbs(0.0, 1e-9));
+    for (unsigned int i = 1; i < 20; ++i) {
+      const double dist = switchOn + 0.1 * i;
+      INFO(dist);
+      double dummy;
+      const double S =
+          ForceFields::switchingFunction(dist, switchOn, cutoff, dS_dr);
+      CHECK(S > 0.0);
+      CHECK(S < 1.0);
+      const double numDeriv =
+          (ForceFields::switchingFunction(dist + h, switchOn, cutoff, dummy) -
+           ForceFields::switchingFunction(dist - h, switchOn, cutoff, dummy)) /
+          (2 * h);
+      CHECK_THAT(dS_dr, Catch::Matchers::WithinAbs(numDeriv, 1e-6));
+    }
+  }
+
+  // two atoms on the x axis
+  RDGeom::Point3D p1(0.0, 0.0, 0.0);
+  RDGeom::Point3D p2(3.0, 0.0, 0.0);
+  ForceFields::ForceField ff;
+  ff.positions().push_back(&p1);
+  ff.positions().push_back(&p2);
+  ForceFields::UFF::AtomicParams uffParams{};
+  uffParams.x1 = 3.851;
+  uffParams.D1 = 0.105;
+  auto uffContrib = std::make_unique<ForceFields::UFF::vdWCutoffContrib>(
+      &ff, cutoff, 1.0, switchWidth);
+  uffContrib->setAtomParams(0, &uffParams);
+  uffContrib->setAtomParams(1, &uffParams);
+  ForceFields::MMFF::MMFFVdWRijstarEps mmffParams{};
+  mmffParams.R_ij_star = 3.9;
+  mmffParams.epsilon = 0.07;
+  auto mmffContrib =
+      std::make_unique<ForceFields::MMFF::NonbondedCutoffContrib>(
+          &ff, cutoff, 1.0, RDKit::MMFF::CONSTANT, 1.0, switchWidth);
+  mmffContrib->setAtomParams(0, 0, 0.4);
+  mmffContrib->setAtomParams(1, 0, -0.3);
+  mmffContrib->setVdWParams(0, 0, mmffParams);
+  const std::vector<const ForceFields::ForceFieldContrib *> contribs{
+      uffContrib.get(), mmffContrib.get()};
+
+  SECTION("energies and gradients are continuous") {
+    for (const auto contrib : contribs) {
+      auto energy = [&](double dist) {
+        std::vector<double> pos{0.0, 0.0, 0.0, dist, 0.0, 0.0};
+        return contrib->getEnergy(pos.data());
+      };
+      CHECK(energy(cutoff - switchWidth) != 0.0);
+      CHECK_THAT(energy(cutoff - h), Catch::Matchers::WithinAbs(0.0, 1e-9));
+      CHECK(energy(cutoff + h) == 0.0);
+      for (unsigned int i = 0; i < 30; ++i) {
+        const double dist = 3.05 + 0.1 * i;
+        INFO(dist);
+        std::vector<double> pos{0.0, 0.0, 0.0, dist, 0.0, 0.0};
+        std::vector<double> grad(6, 0.0);
+        contrib->getGrad(pos.data(), grad.data());
+        const double numGrad = (energy(dist + h) - energy(dist - h)) / (2 * h);
+        CHECK_THAT(grad[3], Catch::Matchers::WithinAbs(numGrad, 1e-6));
+        CHECK_THAT(grad[0], Catch::Matchers::WithinAbs(-numGrad, 1e-6));
+      }
+    }
+  }
+
+  SECTION("each conformation of a batch has its own neighbor list") {
+    const unsigned int numConfs = 2;
+    // the conformations are interleaved, see ForceFieldContrib::getEnergies()
+    std::vector<double> pos(6 * numConfs, 0.0);
+    pos[3 * numConfs] = 3.0;
+    pos[3 * numConfs + 1] = 5.0;
+    for (unsigned int i = 0; i < contribs.size(); ++i) {
+      for (unsigned int iter = 0; iter < 3; ++iter) {
+        std::vector<double> energies(numConfs, 0.0);
+        std::vector<double> grads(6 * numConfs, 0.0);
+        CHECK(contribs[i]->getEnergies(pos.data(), numConfs, energies.data(),
+                                       nullptr));
+        CHECK(contribs[i]->getGrads(pos.data(), numConfs, grads.data(),
+                                    nullptr));
+        for (unsigned int c = 0; c < numConfs; ++c) {
+          std::vector<double> confPos{0.0, 0.0, 0.0, pos[3 * numConfs + c],
+                                      0.0, 0.0};
+          std::vector<double> confGrad(6, 0.0);
+          CHECK(energies[c] == contribs[i]->getEnergy(confPos.data()));
+          contribs[i]->getGrad(confPos.data(), confGrad.data());
+          CHECK(grads[3 * numConfs + c] == confGrad[3]);
+        }
+      }
+      // the lists belong to the conformations, not to the slots of the batch
+      const unsigned int confId = 1;
+      std::vector<double> confPos{0.0, 0.0, 0.0, pos[3 * numConfs + confId],
+                                  0.0, 0.0};
+      double energy = 0.0;
+      CHECK(contribs[i]->getEnergies(confPos.data(), 1, &energy, &confId));
+      CHECK(energy == contribs[i]->getEnergy(confPos.data()));
+      for (unsigned int c = 0; c < numConfs; ++c) {
+        CHECK((i ? mmffContrib->batchNeighborList(c).numBuilds()
+                 : uffContrib->batchNeighborList(c).numBuilds()) == 1);
+      }
+    }
+  }
+}
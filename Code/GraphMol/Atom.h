@@ -26,6 +26,7 @@
 #include <RDGeneral/RDProps.h>
 #include <GraphMol/details.h>
 #include <GraphMol/MacroAtomInfo.h>
+#include <GraphMol/MolArena.h>
 
 namespace RDKit {
 class Atom;
@@ -136,6 +137,15 @@ class RDKIT_GRAPHMOL_EXPORT Atom : public RDProps {
 
   virtual ~Atom();
 
+  //! Atoms are allocated from the thread's arena when one is active, see
+  //! MolArena.h
+  static void *operator new(std::size_t size) {
+    return MolArena::allocate(size);
+  }
+  static void operator delete(void *ptr) noexcept {
+    MolArena::deallocate(ptr);
+  }
+
   //! makes a copy of this Atom and returns a pointer to it.
   /*!
     <b>Note:</b> the caller is responsible for <tt>delete</tt>ing the result
@@ -22,6 +22,7 @@
 #include <RDGeneral/RDProps.h>
 #include <GraphMol/details.h>
 #include <GraphMol/MacroBondInfo.h>
+#include <GraphMol/MolArena.h>
 
 namespace RDKit {
 class ROMol;
@@ -111,6 +112,15 @@ class RDKIT_GRAPHMOL_EXPORT Bond : public RDProps {
   explicit Bond(BondType bT);
   Bond(const Bond &other);
   virtual ~Bond();
+
+  //! Bonds are allocated from the thread's arena when one is active, see
+  //! MolArena.h
+  static void *operator new(std::size_t size) {
+    return MolArena::allocate(size);
+  }
+  static void operator delete(void *ptr) noexcept {
+    MolArena::deallocate(ptr);
+  }
   Bond &operator=(const Bond &other);
 
   Bond(Bond &&o) noexcept : RDProps(std::move(o)) {
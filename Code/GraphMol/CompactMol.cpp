@@ -0,0 +1,597 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+
+#include <GraphMol/CompactMol.h>
+#include <GraphMol/MolPickleView.h>
+#include <GraphMol/ROMol.h>
+#include <GraphMol/RingInfo.h>
+#include <GraphMol/MolOps.h>
+#include <RDGeneral/Exceptions.h>
+#include <RDGeneral/Invariant.h>
+#include <RDGeneral/StreamOps.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace RDKit {
+
+namespace {
+constexpr std::uint32_t compactMolMagic = 0xC0A1C0DE;
+// version 3 added the pattern fingerprint
+constexpr std::uint32_t compactMolVersion = 3;
+
+// the process-wide table of interned property names. A deque is used so
+// that references to the names stay valid as names are added
+std::mutex propNameMutex;
+std::deque<std::string> propNames;
+std::unordered_map<std::string, std::uint32_t> propNameIds;
+
+int findPropName(const std::string &name) {
+  std::lock_guard<std::mutex> lock(propNameMutex);
+  auto it = propNameIds.find(name);
+  return it == propNameIds.end() ? -1 : static_cast<int>(it->second);
+}
+
+std::size_t num32BitWords(std::uint32_t numAtoms, std::uint32_t numBonds,
+                          std::uint32_t numProps) {
+  // neighbor offsets, neighbor atoms and bonds, bond begin and end atoms,
+  // bond stereo atoms, isotopes, property names and property offsets
+  return 2 * (std::size_t(numAtoms) + numProps + 1) +
+         8 * std::size_t(numBonds);
+}
+
+std::size_t dataBlockSize(std::uint32_t numAtoms, std::uint32_t numBonds,
+                          std::uint32_t numProps, std::uint32_t propDataSize) {
+  // the 32 bit arrays, 8 single byte atom arrays, 4 single byte bond
+  // arrays and the property values
+  return num32BitWords(numAtoms, numBonds, numProps) * sizeof(std::uint32_t) +
+         8 * std::size_t(numAtoms) + 4 * std::size_t(numBonds) + propDataSize;
+}
+
+template <typename T>
+void appendValue(std::string &res, T val) {
+  val = EndianSwapBytes<HOST_ENDIAN_ORDER, LITTLE_ENDIAN_ORDER>(val);
+  res.append(reinterpret_cast<const char *>(&val), sizeof(T));
+}
+
+template <typename T>
+T readValue(const char *&pkl, const char *end) {
+  if (end - pkl < static_cast<std::ptrdiff_t>(sizeof(T))) {
+    throw ValueErrorException("CompactMol pickle is truncated");
+  }
+  T val;
+  std::memcpy(&val, pkl, sizeof(T));
+  pkl += sizeof(T);
+  return EndianSwapBytes<LITTLE_ENDIAN_ORDER, HOST_ENDIAN_ORDER>(val);
+}
+
+// on big endian systems the 32 bit words at the start of the data block are
+// byte swapped when they are written and read
+void swapWords(std::uint32_t *words, std::size_t count) {
+  if constexpr (HOST_ENDIAN_ORDER != LITTLE_ENDIAN_ORDER) {
+    for (std::size_t i = 0; i < count; ++i) {
+      words[i] = EndianSwapBytes<HOST_ENDIAN_ORDER, LITTLE_ENDIAN_ORDER>(
+          words[i]);
+    }
+  } else {
+    RDUNUSED_PARAM(words);
+    RDUNUSED_PARAM(count);
+  }
+}
+
+// collects the non-private properties which can be converted to strings
+std::uint32_t collectProps(const RDProps &props,
+                           std::vector<std::uint32_t> &propIds,
+                           std::vector<std::string> &propVals) {
+  std::uint32_t propDataSize = 0;
+  for (const auto &name : props.getPropList(false, false)) {
+    std::string val;
+    try {
+      if (!props.getPropIfPresent(name, val)) {
+        continue;
+      }
+    } catch (const std::exception &) {
+      // properties which cannot be converted to strings are skipped
+      continue;
+    }
+    propIds.push_back(internPropName(name));
+    propDataSize += val.size();
+    propVals.push_back(std::move(val));
+  }
+  return propDataSize;
+}
+}  // namespace
+
+std::uint32_t internPropName(const std::string &name) {
+  std::lock_guard<std::mutex> lock(propNameMutex);
+  auto [it, inserted] = propNameIds.emplace(
+      name, static_cast<std::uint32_t>(propNames.size()));
+  if (inserted) {
+    propNames.push_back(name);
+  }
+  return it->second;
+}
+
+const std::string &getInternedPropName(std::uint32_t id) {
+  std::lock_guard<std::mutex> lock(propNameMutex);
+  URANGE_CHECK(id, propNames.size());
+  return propNames[id];
+}
+
+CompactMol::CompactMol(const ROMol &mol) {
+  for (const auto atom : mol.atoms()) {
+    if (atom->hasQuery()) {
+      throw ValueErrorException("CompactMol does not support query atoms");
+    }
+  }
+  for (const auto bond : mol.bonds()) {
+    if (bond->hasQuery()) {
+      throw ValueErrorException("CompactMol does not support query bonds");
+    }
+  }
+  if (!mol.getRingInfo()->isInitialized()) {
+    MolOps::fastFindRings(mol);
+  }
+  const auto ringInfo = mol.getRingInfo();
+
+  std::vector<std::uint32_t> propIds;
+  std::vector<std::string> propVals;
+  const auto propDataSize = collectProps(mol, propIds, propVals);
+
+  allocate(mol.getNumAtoms(), mol.getNumBonds(), propIds.size(),
+           propDataSize);
+
+  dp_nbrOffsets[0] = 0;
+  for (const auto atom : mol.atoms()) {
+    const auto idx = atom->getIdx();
+    dp_atomicNums[idx] = static_cast<std::uint8_t>(atom->getAtomicNum());
+    dp_formalCharges[idx] = static_cast<std::int8_t>(atom->getFormalCharge());
+    dp_isotopes[idx] = atom->getIsotope();
+    dp_numHs[idx] =
+        static_cast<std::uint8_t>(std::min(atom->getTotalNumHs(false), 255u));
+    dp_numRadicalElectrons[idx] =
+        static_cast<std::uint8_t>(atom->getNumRadicalElectrons());
+    dp_atomFlags[idx] = atom->getIsAromatic() ? AtomIsAromatic : 0;
+    dp_chiralTags[idx] = static_cast<std::uint8_t>(atom->getChiralTag());
+    dp_hybridizations[idx] =
+        static_cast<std::uint8_t>(atom->getHybridization());
+    dp_numAtomRings[idx] =
+        static_cast<std::uint8_t>(std::min(ringInfo->numAtomRings(idx), 255u));
+
+    auto pos = dp_nbrOffsets[idx];
+    for (const auto bond : mol.atomBonds(atom)) {
+      dp_nbrAtoms[pos] = bond->getOtherAtomIdx(idx);
+      dp_nbrBonds[pos] = bond->getIdx();
+      ++pos;
+    }
+    dp_nbrOffsets[idx + 1] = pos;
+  }
+  for (const auto bond : mol.bonds()) {
+    const auto idx = bond->getIdx();
+    dp_beginAtoms[idx] = bond->getBeginAtomIdx();
+    dp_endAtoms[idx] = bond->getEndAtomIdx();
+    dp_bondTypes[idx] = static_cast<std::uint8_t>(bond->getBondType());
+    dp_bondStereos[idx] = static_cast<std::uint8_t>(bond->getStereo());
+    const auto &stereoAtoms = bond->getStereoAtoms();
+    if (stereoAtoms.size() == 2) {
+      dp_stereoAtoms[2 * idx] = stereoAtoms[0];
+      dp_stereoAtoms[2 * idx + 1] = stereoAtoms[1];
+    } else {
+      dp_stereoAtoms[2 * idx] = dp_stereoAtoms[2 * idx + 1] = noStereoAtom;
+    }
+    dp_bondFlags[idx] = (bond->getIsAromatic() ? BondIsAromatic : 0) |
+                        (bond->getIsConjugated() ? BondIsConjugated : 0);
+    dp_numBondRings[idx] =
+        static_cast<std::uint8_t>(std::min(ringInfo->numBondRings(idx), 255u));
+  }
+  setProps(propIds, propVals);
+}
+
+CompactMol::CompactMol(const MolPickleView &view) {
+  if (view.hasQueries()) {
+    throw ValueErrorException(
+        "CompactMol does not support query atoms or bonds");
+  }
+  if (!view.hasRingInfo()) {
+    std::unique_ptr<ROMol> mol(
+        view.toMol(PicklerOps::PropertyPickleOptions::MolProps));
+    *this = CompactMol(*mol);
+    return;
+  }
+
+  std::vector<std::uint32_t> propIds;
+  std::vector<std::string> propVals;
+  const auto propDataSize = collectProps(view.getProps(), propIds, propVals);
+
+  const auto numAtoms = view.getNumAtoms();
+  const auto numBonds = view.getNumBonds();
+  allocate(numAtoms, numBonds, propIds.size(), propDataSize);
+
+  for (unsigned int idx = 0; idx < numAtoms; ++idx) {
+    dp_atomicNums[idx] = static_cast<std::uint8_t>(view.getAtomicNum(idx));
+    dp_formalCharges[idx] = static_cast<std::int8_t>(view.getFormalCharge(idx));
+    dp_isotopes[idx] = view.getIsotope(idx);
+    dp_numHs[idx] =
+        static_cast<std::uint8_t>(std::min(view.getTotalNumHs(idx), 255u));
+    dp_numRadicalElectrons[idx] =
+        static_cast<std::uint8_t>(view.getNumRadicalElectrons(idx));
+    dp_atomFlags[idx] = view.getIsAromatic(idx) ? AtomIsAromatic : 0;
+    dp_chiralTags[idx] = static_cast<std::uint8_t>(view.getChiralTag(idx));
+    dp_hybridizations[idx] =
+        static_cast<std::uint8_t>(view.getHybridization(idx));
+    dp_numAtomRings[idx] = 0;
+  }
+  // an unpickled molecule has each atom's bonds in order of increasing
+  // bond index, so that's the order used here
+  std::fill(dp_nbrOffsets, dp_nbrOffsets + numAtoms + 1, 0);
+  for (unsigned int idx = 0; idx < numBonds; ++idx) {
+    dp_beginAtoms[idx] = view.getBondBeginAtomIdx(idx);
+    dp_endAtoms[idx] = view.getBondEndAtomIdx(idx);
+    ++dp_nbrOffsets[dp_beginAtoms[idx] + 1];
+    ++dp_nbrOffsets[dp_endAtoms[idx] + 1];
+    dp_bondTypes[idx] = static_cast<std::uint8_t>(view.getBondType(idx));
+    dp_bondStereos[idx] = static_cast<std::uint8_t>(view.getBondStereo(idx));
+    const auto stereoAtoms = view.getBondStereoAtoms(idx);
+    if (stereoAtoms.size() == 2) {
+      dp_stereoAtoms[2 * idx] = stereoAtoms[0];
+      dp_stereoAtoms[2 * idx + 1] = stereoAtoms[1];
+    } else {
+      dp_stereoAtoms[2 * idx] = dp_stereoAtoms[2 * idx + 1] = noStereoAtom;
+    }
+    dp_bondFlags[idx] = (view.getBondIsAromatic(idx) ? BondIsAromatic : 0) |
+                        (view.getBondIsConjugated(idx) ? BondIsConjugated : 0);
+    dp_numBondRings[idx] = 0;
+  }
+  for (unsigned int idx = 0; idx < numAtoms; ++idx) {
+    dp_nbrOffsets[idx + 1] += dp_nbrOffsets[idx];
+  }
+  std::vector<std::uint32_t> pos(dp_nbrOffsets, dp_nbrOffsets + numAtoms);
+  for (unsigned int idx = 0; idx < numBonds; ++idx) {
+    const auto begin = dp_beginAtoms[idx];
+    const auto end = dp_endAtoms[idx];
+    dp_nbrAtoms[pos[begin]] = end;
+    dp_nbrBonds[pos[begin]++] = idx;
+    dp_nbrAtoms[pos[end]] = begin;
+    dp_nbrBonds[pos[end]++] = idx;
+  }
+
+  // the rings are stored as lists of atoms, the bonds join neighboring
+  // atoms in the list
+  auto incrementCount = [](std::uint8_t &count) {
+    if (count < 255) {
+      ++count;
+    }
+  };
+  for (const auto &ring : view.getAtomRings()) {
+    for (unsigned int i = 0; i < ring.size(); ++i) {
+      incrementCount(dp_numAtomRings[ring[i]]);
+      const auto bondIdx =
+          getBondBetweenAtoms(ring[i], ring[(i + 1) % ring.size()]);
+      if (bondIdx < 0) {
+        throw ValueErrorException("bad ring in pickle");
+      }
+      incrementCount(dp_numBondRings[bondIdx]);
+    }
+  }
+  setProps(propIds, propVals);
+}
+
+void CompactMol::setProps(const std::vector<std::uint32_t> &propIds,
+                          const std::vector<std::string> &propVals) {
+  dp_propOffsets[0] = 0;
+  for (unsigned int i = 0; i < d_numProps; ++i) {
+    dp_propNames[i] = propIds[i];
+    std::memcpy(dp_propData + dp_propOffsets[i], propVals[i].data(),
+                propVals[i].size());
+    dp_propOffsets[i + 1] = dp_propOffsets[i] + propVals[i].size();
+  }
+}
+
+CompactMol::CompactMol(const std::string &pkl) {
+  initFromString(pkl.data(), pkl.size());
+}
+
+CompactMol::CompactMol(const char *pkl, std::size_t len) {
+  initFromString(pkl, len);
+}
+
+CompactMol::CompactMol(const CompactMol &other) { *this = other; }
+
+CompactMol::CompactMol(CompactMol &&other) noexcept {
+  *this = std::move(other);
+}
+
+CompactMol &CompactMol::operator=(const CompactMol &other) {
+  if (this == &other) {
+    return *this;
+  }
+  if (!other.dp_data) {
+    *this = CompactMol();
+    return *this;
+  }
+  allocate(other.d_numAtoms, other.d_numBonds, other.d_numProps,
+           other.d_propDataSize);
+  std::memcpy(dp_data.get(), other.dp_data.get(), d_dataSize);
+  d_patternFp = other.d_patternFp;
+  d_patternFpSize = other.d_patternFpSize;
+  return *this;
+}
+
+CompactMol &CompactMol::operator=(CompactMol &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  d_numAtoms = std::exchange(other.d_numAtoms, 0);
+  d_numBonds = std::exchange(other.d_numBonds, 0);
+  d_numProps = std::exchange(other.d_numProps, 0);
+  d_propDataSize = std::exchange(other.d_propDataSize, 0);
+  d_dataSize = std::exchange(other.d_dataSize, 0);
+  dp_data = std::move(other.dp_data);
+  d_patternFp = std::move(other.d_patternFp);
+  other.d_patternFp.clear();
+  d_patternFpSize = std::exchange(other.d_patternFpSize, 0);
+  setPointers();
+  other.setPointers();
+  return *this;
+}
+
+void CompactMol::allocate(std::uint32_t numAtoms, std::uint32_t numBonds,
+                          std::uint32_t numProps,
+                          std::uint32_t propDataSize) {
+  d_numAtoms = numAtoms;
+  d_numBonds = numBonds;
+  d_numProps = numProps;
+  d_propDataSize = propDataSize;
+  d_dataSize = dataBlockSize(numAtoms, numBonds, numProps, propDataSize);
+  dp_data.reset(new std::byte[d_dataSize]);
+  setPointers();
+}
+
+void CompactMol::setPointers() {
+  if (!dp_data) {
+    dp_nbrOffsets = dp_nbrAtoms = dp_nbrBonds = nullptr;
+    dp_beginAtoms = dp_endAtoms = dp_stereoAtoms = dp_isotopes = nullptr;
+    dp_propNames = dp_propOffsets = nullptr;
+    dp_atomicNums = dp_numHs = dp_numRadicalElectrons = nullptr;
+    dp_atomFlags = dp_chiralTags = dp_hybridizations = nullptr;
+    dp_numAtomRings = dp_bondTypes = dp_bondStereos = nullptr;
+    dp_bondFlags = dp_numBondRings = nullptr;
+    dp_formalCharges = nullptr;
+    dp_propData = nullptr;
+    return;
+  }
+  auto words = reinterpret_cast<std::uint32_t *>(dp_data.get());
+  dp_nbrOffsets = words;
+  words += d_numAtoms + 1;
+  dp_nbrAtoms = words;
+  words += 2 * d_numBonds;
+  dp_nbrBonds = words;
+  words += 2 * d_numBonds;
+  dp_beginAtoms = words;
+  words += d_numBonds;
+  dp_endAtoms = words;
+  words += d_numBonds;
+  dp_stereoAtoms = words;
+  words += 2 * d_numBonds;
+  dp_isotopes = words;
+  words += d_numAtoms;
+  dp_propNames = words;
+  words += d_numProps;
+  dp_propOffsets = words;
+  words += d_numProps + 1;
+
+  auto bytes = reinterpret_cast<std::uint8_t *>(words);
+  dp_atomicNums = bytes;
+  bytes += d_numAtoms;
+  dp_formalCharges = reinterpret_cast<std::int8_t *>(bytes);
+  bytes += d_numAtoms;
+  dp_numHs = bytes;
+  bytes += d_numAtoms;
+  dp_numRadicalElectrons = bytes;
+  bytes += d_numAtoms;
+  dp_atomFlags = bytes;
+  bytes += d_numAtoms;
+  dp_chiralTags = bytes;
+  bytes += d_numAtoms;
+  dp_hybridizations = bytes;
+  bytes += d_numAtoms;
+  dp_numAtomRings = bytes;
+  bytes += d_numAtoms;
+  dp_bondTypes = bytes;
+  bytes += d_numBonds;
+  dp_bondStereos = bytes;
+  bytes += d_numBonds;
+  dp_bondFlags = bytes;
+  bytes += d_numBonds;
+  dp_numBondRings = bytes;
+  bytes += d_numBonds;
+  dp_propData = reinterpret_cast<char *>(bytes);
+  CHECK_INVARIANT(bytes + d_propDataSize ==
+                      reinterpret_cast<std::uint8_t *>(dp_data.get()) +
+                          d_dataSize,
+                  "bad CompactMol layout");
+}
+
+void CompactMol::setPatternFingerprint(std::vector<std::uint64_t> words,
+                                       unsigned int numBits) {
+  if (words.size() != (std::size_t(numBits) + 63) / 64) {
+    throw ValueErrorException("bad pattern fingerprint size");
+  }
+  d_patternFp = std::move(words);
+  d_patternFpSize = numBits;
+}
+
+int CompactMol::getBondBetweenAtoms(unsigned int idx1,
+                                    unsigned int idx2) const {
+  URANGE_CHECK(idx1, d_numAtoms);
+  URANGE_CHECK(idx2, d_numAtoms);
+  for (auto pos = dp_nbrOffsets[idx1]; pos < dp_nbrOffsets[idx1 + 1]; ++pos) {
+    if (dp_nbrAtoms[pos] == idx2) {
+      return static_cast<int>(dp_nbrBonds[pos]);
+    }
+  }
+  return -1;
+}
+
+int CompactMol::findProp(const std::string &name) const {
+  const auto id = findPropName(name);
+  if (id < 0) {
+    return -1;
+  }
+  for (unsigned int i = 0; i < d_numProps; ++i) {
+    if (dp_propNames[i] == static_cast<std::uint32_t>(id)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool CompactMol::hasProp(const std::string &name) const {
+  return findProp(name) >= 0;
+}
+
+std::string_view CompactMol::getProp(const std::string &name) const {
+  const auto which = findProp(name);
+  if (which < 0) {
+    throw KeyErrorException(name);
+  }
+  return {dp_propData + dp_propOffsets[which],
+          dp_propOffsets[which + 1] - dp_propOffsets[which]};
+}
+
+std::vector<std::string> CompactMol::getPropList() const {
+  std::vector<std::string> res;
+  res.reserve(d_numProps);
+  for (unsigned int i = 0; i < d_numProps; ++i) {
+    res.push_back(getInternedPropName(dp_propNames[i]));
+  }
+  return res;
+}
+
+std::string CompactMol::toString() const {
+  std::string res;
+  appendValue(res, compactMolMagic);
+  appendValue(res, compactMolVersion);
+  appendValue(res, d_numAtoms);
+  appendValue(res, d_numBonds);
+  appendValue(res, d_numProps);
+  appendValue(res, d_propDataSize);
+  appendValue(res, d_patternFpSize);
+  // the property name ids are only meaningful in this process, so the names
+  // themselves are written
+  for (unsigned int i = 0; i < d_numProps; ++i) {
+    const auto &name = getInternedPropName(dp_propNames[i]);
+    appendValue(res, static_cast<std::uint32_t>(name.size()));
+    res.append(name);
+  }
+  if (dp_data) {
+    const auto offset = res.size();
+    res.append(reinterpret_cast<const char *>(dp_data.get()), d_dataSize);
+    swapWords(reinterpret_cast<std::uint32_t *>(res.data() + offset),
+              num32BitWords(d_numAtoms, d_numBonds, d_numProps));
+  }
+  for (auto word : d_patternFp) {
+    appendValue(res, word);
+  }
+  return res;
+}
+
+void CompactMol::initFromString(const char *pkl, std::size_t len) {
+  const char *end = pkl + len;
+  if (readValue<std::uint32_t>(pkl, end) != compactMolMagic) {
+    throw ValueErrorException("bad CompactMol pickle header");
+  }
+  const auto version = readValue<std::uint32_t>(pkl, end);
+  if (version < 2 || version > compactMolVersion) {
+    throw ValueErrorException("unsupported CompactMol pickle version");
+  }
+  const auto numAtoms = readValue<std::uint32_t>(pkl, end);
+  const auto numBonds = readValue<std::uint32_t>(pkl, end);
+  const auto numProps = readValue<std::uint32_t>(pkl, end);
+  const auto propDataSize = readValue<std::uint32_t>(pkl, end);
+  const auto patternFpSize =
+      version >= 3 ? readValue<std::uint32_t>(pkl, end) : 0;
+  // the pattern fingerprint words are at the end of the pickle
+  const auto patternFpWords = (std::size_t(patternFpSize) + 63) / 64;
+  if (static_cast<std::size_t>(end - pkl) <
+      patternFpWords * sizeof(std::uint64_t)) {
+    throw ValueErrorException("CompactMol pickle is truncated");
+  }
+  end -= patternFpWords * sizeof(std::uint64_t);
+  if (patternFpSize) {
+    std::vector<std::uint64_t> words(patternFpWords);
+    const char *fpPkl = end;
+    for (auto &word : words) {
+      word = readValue<std::uint64_t>(fpPkl, fpPkl + sizeof(std::uint64_t));
+    }
+    setPatternFingerprint(std::move(words), patternFpSize);
+  }
+  if (pkl == end && !numAtoms && !numBonds && !numProps && !propDataSize) {
+    // an empty molecule has no data block
+    return;
+  }
+  // each property name needs at least its length, so this catches bogus
+  // counts before anything is allocated
+  if (static_cast<std::size_t>(end - pkl) <
+      std::size_t(numProps) * sizeof(std::uint32_t) +
+          dataBlockSize(numAtoms, numBonds, numProps, propDataSize)) {
+    throw ValueErrorException("CompactMol pickle is truncated");
+  }
+  std::vector<std::uint32_t> propIds(numProps);
+  for (auto &id : propIds) {
+    const auto nameLen = readValue<std::uint32_t>(pkl, end);
+    if (static_cast<std::size_t>(end - pkl) < nameLen) {
+      throw ValueErrorException("CompactMol pickle is truncated");
+    }
+    id = internPropName(std::string(pkl, nameLen));
+    pkl += nameLen;
+  }
+
+  allocate(numAtoms, numBonds, numProps, propDataSize);
+  if (static_cast<std::size_t>(end - pkl) != d_dataSize) {
+    throw ValueErrorException("CompactMol pickle has the wrong size");
+  }
+  std::memcpy(dp_data.get(), pkl, d_dataSize);
+  swapWords(dp_nbrOffsets, num32BitWords(numAtoms, numBonds, numProps));
+  std::copy(propIds.begin(), propIds.end(), dp_propNames);
+
+  // check the indices so that a corrupt pickle cannot cause reads outside
+  // of the data block
+  bool ok = dp_nbrOffsets[0] == 0 && dp_nbrOffsets[numAtoms] == 2 * numBonds;
+  for (unsigned int i = 0; ok && i < numAtoms; ++i) {
+    ok = dp_nbrOffsets[i] <= dp_nbrOffsets[i + 1];
+  }
+  for (unsigned int i = 0; ok && i < 2 * numBonds; ++i) {
+    ok = dp_nbrAtoms[i] < numAtoms && dp_nbrBonds[i] < numBonds;
+  }
+  for (unsigned int i = 0; ok && i < numBonds; ++i) {
+    ok = dp_beginAtoms[i] < numAtoms && dp_endAtoms[i] < numAtoms;
+  }
+  for (unsigned int i = 0; ok && i < numBonds; ++i) {
+    const auto stereo1 = dp_stereoAtoms[2 * i];
+    const auto stereo2 = dp_stereoAtoms[2 * i + 1];
+    ok = (stereo1 == noStereoAtom && stereo2 == noStereoAtom) ||
+         (stereo1 < numAtoms && stereo2 < numAtoms);
+  }
+  ok = ok && dp_propOffsets[0] == 0 &&
+       dp_propOffsets[numProps] == propDataSize;
+  for (unsigned int i = 0; ok && i < numProps; ++i) {
+    ok = dp_propOffsets[i] <= dp_propOffsets[i + 1];
+  }
+  if (!ok) {
+    throw ValueErrorException("corrupt CompactMol pickle");
+  }
+}
+
+}  // namespace RDKit
@@ -0,0 +1,257 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+/*! \file CompactMol.h
+
+  \brief Defines a flat, read-only molecule representation
+
+*/
+#include <RDGeneral/export.h>
+#ifndef RD_COMPACTMOL_H
+#define RD_COMPACTMOL_H
+
+#include <GraphMol/Atom.h>
+#include <GraphMol/Bond.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RDKit {
+class ROMol;
+class MolPickleView;
+
+//! returns the id of a property name in the process-wide table of property
+//! names, the name is added to the table if it is not already there
+RDKIT_GRAPHMOL_EXPORT std::uint32_t internPropName(const std::string &name);
+//! returns the property name with a particular id
+RDKIT_GRAPHMOL_EXPORT const std::string &getInternedPropName(std::uint32_t id);
+
+//! CompactMol is a frozen, flat copy of a molecule for read-only use
+/*!
+  The atom and bond attributes needed for substructure searching and
+  fingerprinting are stored as parallel arrays, the connectivity is stored
+  in compressed sparse row format, and all of it lives in a single
+  allocation. This makes CompactMols cheap to create, copy, and serialize,
+  and avoids the pointer chasing of an ROMol when the same operation is
+  applied to many molecules.
+
+  Only the molecule's non-private properties are kept; their names are
+  interned (see internPropName()) and their values are stored as strings.
+
+  CompactMol is only meant for plain molecules:
+    - molecules with query atoms or bonds (e.g. from SMARTS) cannot be
+      converted. To search CompactMols with SMARTS, use a CompactMolQuery
+      (see GraphMol/Substruct/CompactMolQuery.h).
+    - stereo groups, conformers, substance groups and atom or bond
+      properties are not kept.
+
+  A pattern fingerprint can be attached to the molecule (see
+  setPatternFingerprint()), it is used to screen substructure searches.
+
+  Notes:
+    - the molecule must be sanitized (or at least have had its property cache
+      updated) so that the numbers of Hs are available.
+    - if the molecule's ring information has not been initialized, the rings
+      are found with MolOps::fastFindRings().
+*/
+class RDKIT_GRAPHMOL_EXPORT CompactMol {
+ public:
+  CompactMol() = default;
+  //! construct from an ROMol
+  explicit CompactMol(const ROMol &mol);
+  //! construct from a MolPickler pickle, without building an ROMol
+  /*!
+    If the pickle does not include ring information the molecule is
+    unpickled to find the rings.
+  */
+  explicit CompactMol(const MolPickleView &view);
+  //! construct from a binary string created with toString()
+  explicit CompactMol(const std::string &pkl);
+  //! \overload
+  CompactMol(const char *pkl, std::size_t len);
+  CompactMol(const CompactMol &other);
+  CompactMol(CompactMol &&other) noexcept;
+  CompactMol &operator=(const CompactMol &other);
+  CompactMol &operator=(CompactMol &&other) noexcept;
+  ~CompactMol() = default;
+
+  unsigned int getNumAtoms() const { return d_numAtoms; }
+  unsigned int getNumBonds() const { return d_numBonds; }
+
+  //! \name Atom attributes
+  //! @{
+  int getAtomicNum(unsigned int idx) const { return dp_atomicNums[idx]; }
+  int getFormalCharge(unsigned int idx) const { return dp_formalCharges[idx]; }
+  unsigned int getIsotope(unsigned int idx) const { return dp_isotopes[idx]; }
+  //! returns the number of explicit and implicit Hs on the atom, Hs which
+  //! are atoms in the graph are not included
+  unsigned int getNumHs(unsigned int idx) const { return dp_numHs[idx]; }
+  unsigned int getNumRadicalElectrons(unsigned int idx) const {
+    return dp_numRadicalElectrons[idx];
+  }
+  bool getAtomIsAromatic(unsigned int idx) const {
+    return dp_atomFlags[idx] & AtomIsAromatic;
+  }
+  Atom::ChiralType getChiralTag(unsigned int idx) const {
+    return static_cast<Atom::ChiralType>(dp_chiralTags[idx]);
+  }
+  Atom::HybridizationType getHybridization(unsigned int idx) const {
+    return static_cast<Atom::HybridizationType>(dp_hybridizations[idx]);
+  }
+  //! returns the number of rings the atom is in
+  unsigned int getNumAtomRings(unsigned int idx) const {
+    return dp_numAtomRings[idx];
+  }
+  unsigned int getDegree(unsigned int idx) const {
+    return dp_nbrOffsets[idx + 1] - dp_nbrOffsets[idx];
+  }
+  //! returns the indices of the atom's neighbors
+  std::span<const std::uint32_t> getAtomNeighbors(unsigned int idx) const {
+    return {dp_nbrAtoms + dp_nbrOffsets[idx], getDegree(idx)};
+  }
+  //! returns the indices of the atom's bonds, in the same order as
+  //! getAtomNeighbors()
+  std::span<const std::uint32_t> getAtomBonds(unsigned int idx) const {
+    return {dp_nbrBonds + dp_nbrOffsets[idx], getDegree(idx)};
+  }
+  //! @}
+
+  //! \name Bond attributes
+  //! @{
+  unsigned int getBeginAtomIdx(unsigned int idx) const {
+    return dp_beginAtoms[idx];
+  }
+  unsigned int getEndAtomIdx(unsigned int idx) const {
+    return dp_endAtoms[idx];
+  }
+  unsigned int getOtherAtomIdx(unsigned int idx,
+                               unsigned int thisIdx) const {
+    return dp_beginAtoms[idx] == thisIdx ? dp_endAtoms[idx]
+                                         : dp_beginAtoms[idx];
+  }
+  Bond::BondType getBondType(unsigned int idx) const {
+    return static_cast<Bond::BondType>(dp_bondTypes[idx]);
+  }
+  Bond::BondStereo getBondStereo(unsigned int idx) const {
+    return static_cast<Bond::BondStereo>(dp_bondStereos[idx]);
+  }
+  //! returns the bond's stereo atoms, this is empty if it has none
+  std::span<const std::uint32_t> getBondStereoAtoms(unsigned int idx) const {
+    if (dp_stereoAtoms[2 * idx] == noStereoAtom) {
+      return {};
+    }
+    return {dp_stereoAtoms + 2 * idx, 2};
+  }
+  bool getBondIsAromatic(unsigned int idx) const {
+    return dp_bondFlags[idx] & BondIsAromatic;
+  }
+  bool getBondIsConjugated(unsigned int idx) const {
+    return dp_bondFlags[idx] & BondIsConjugated;
+  }
+  //! returns the number of rings the bond is in
+  unsigned int getNumBondRings(unsigned int idx) const {
+    return dp_numBondRings[idx];
+  }
+  //! returns the index of the bond between two atoms, or -1 if there is
+  //! no such bond
+  int getBondBetweenAtoms(unsigned int idx1, unsigned int idx2) const;
+  //! @}
+
+  //! \name Properties
+  //! @{
+  bool hasProp(const std::string &name) const;
+  //! returns the value of a property, throws a KeyErrorException if the
+  //! property is not present
+  std::string_view getProp(const std::string &name) const;
+  std::vector<std::string> getPropList() const;
+  //! @}
+
+  //! \name Pattern fingerprint
+  //! @{
+  //! sets the molecule's pattern fingerprint
+  /*!
+    \param words   the bits of the fingerprint packed into 64 bit words, as
+                   PackedBitOps::packBitVect() does
+    \param numBits the size of the fingerprint
+
+    The fingerprint is not created here because GraphMol cannot depend on
+    the fingerprinting code, see PatternFingerprintMol() in
+    GraphMol/Fingerprints/Fingerprints.h.
+  */
+  void setPatternFingerprint(std::vector<std::uint64_t> words,
+                             unsigned int numBits);
+  bool hasPatternFingerprint() const { return d_patternFpSize != 0; }
+  unsigned int getPatternFingerprintSize() const { return d_patternFpSize; }
+  const std::vector<std::uint64_t> &getPatternFingerprintWords() const {
+    return d_patternFp;
+  }
+  //! @}
+
+  //! returns a binary string representation of the molecule
+  std::string toString() const;
+  //! returns the number of bytes used by the molecule's data
+  std::size_t getDataSize() const { return d_dataSize; }
+
+ private:
+  enum AtomFlags : std::uint8_t { AtomIsAromatic = 1 };
+  enum BondFlags : std::uint8_t { BondIsAromatic = 1, BondIsConjugated = 2 };
+  static constexpr std::uint32_t noStereoAtom = 0xffffffff;
+
+  void allocate(std::uint32_t numAtoms, std::uint32_t numBonds,
+                std::uint32_t numProps, std::uint32_t propDataSize);
+  void setPointers();
+  void initFromString(const char *pkl, std::size_t len);
+  void setProps(const std::vector<std::uint32_t> &propIds,
+                const std::vector<std::string> &propVals);
+  int findProp(const std::string &name) const;
+
+  std::uint32_t d_numAtoms = 0;
+  std::uint32_t d_numBonds = 0;
+  std::uint32_t d_numProps = 0;
+  std::uint32_t d_propDataSize = 0;
+  std::size_t d_dataSize = 0;
+  std::unique_ptr<std::byte[]> dp_data;
+  // the pattern fingerprint is optional, so it is kept outside of the data
+  // block
+  std::vector<std::uint64_t> d_patternFp;
+  std::uint32_t d_patternFpSize = 0;
+
+  // the 32 bit arrays are first in the data block, followed by the 8 bit
+  // arrays and then the property values
+  std::uint32_t *dp_nbrOffsets = nullptr;
+  std::uint32_t *dp_nbrAtoms = nullptr;
+  std::uint32_t *dp_nbrBonds = nullptr;
+  std::uint32_t *dp_beginAtoms = nullptr;
+  std::uint32_t *dp_endAtoms = nullptr;
+  std::uint32_t *dp_stereoAtoms = nullptr;
+  std::uint32_t *dp_isotopes = nullptr;
+  std::uint32_t *dp_propNames = nullptr;
+  std::uint32_t *dp_propOffsets = nullptr;
+  std::uint8_t *dp_atomicNums = nullptr;
+  std::int8_t *dp_formalCharges = nullptr;
+  std::uint8_t *dp_numHs = nullptr;
+  std::uint8_t *dp_numRadicalElectrons = nullptr;
+  std::uint8_t *dp_atomFlags = nullptr;
+  std::uint8_t *dp_chiralTags = nullptr;
+  std::uint8_t *dp_hybridizations = nullptr;
+  std::uint8_t *dp_numAtomRings = nullptr;
+  std::uint8_t *dp_bondTypes = nullptr;
+  std::uint8_t *dp_bondStereos = nullptr;
+  std::uint8_t *dp_bondFlags = nullptr;
+  std::uint8_t *dp_numBondRings = nullptr;
+  char *dp_propData = nullptr;
+};
+
+}  // namespace RDKit
+#endif
@@ -0,0 +1,378 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+/*! \file CompiledQuery.h
+
+  \brief Flat programs for evaluating atom and bond queries
+
+  Atom and bond queries are trees of Queries::Query objects. Evaluating one
+  involves a virtual call for every node, an indirect call through a
+  std::function for the data function of every leaf, and another one for the
+  match function. Since query evaluation is the innermost loop of the
+  substructure matcher this overhead adds up.
+
+  A CompiledQuery lowers such a tree into a flat sequence of instructions.
+  Each instruction evaluates one leaf of the tree, calling its data function
+  directly through a plain function pointer and doing the comparison inline,
+  and then jumps to one of two following instructions (or to a final
+  accept/reject) depending on the result. AND and OR nodes, as well as
+  negations of them, are turned into the jump targets, so they cost nothing
+  at match time. Nodes which cannot be lowered (recursive queries, set
+  queries, property queries, and any query types defined outside of the
+  Query library) are evaluated by calling their Match() method.
+
+  The instructions refer to the nodes of the query tree they were created
+  from, so a CompiledQuery must not outlive its query. It also records the
+  generation (see Queries::Query::getGeneration()) of each of those nodes,
+  so isCurrent() can tell when the query has been modified in place and the
+  program needs to be recreated. CompiledQueryHolder, which is used by
+  QueryAtom::compileQuery() and QueryBond::compileQuery(), takes care of
+  this. Since that check visits every node of the query, it is not done on
+  every match but once per substructure search, see
+  QueryOps::updateCompiledMolQueries().
+*/
+#include <RDGeneral/export.h>
+#ifndef RD_COMPILEDQUERY_H
+#define RD_COMPILEDQUERY_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#ifdef RDK_BUILD_THREADSAFE_SSS
+#include <mutex>
+#endif
+
+#include <Query/QueryObjects.h>
+
+namespace RDKit {
+
+template <class TargetPtr>
+class CompiledQuery {
+ public:
+  using QUERY_TYPE = Queries::Query<int, TargetPtr, true>;
+
+  explicit CompiledQuery(const QUERY_TYPE &query) {
+    compile(&query, accept, reject);
+    for (auto &instruction : d_program) {
+      instruction.onTrue = resolve(instruction.onTrue);
+      instruction.onFalse = resolve(instruction.onFalse);
+    }
+    d_labels.clear();
+    d_labels.shrink_to_fit();
+  }
+
+  //! returns whether or not the query matches \c what
+  bool Match(const TargetPtr what) const {
+    int pc = 0;
+    while (true) {
+      const auto &instruction = d_program[pc];
+      bool res;
+      switch (instruction.op) {
+        case OpCode::Equal:
+          res = Queries::queryCmp(instruction.val, instruction.dataFunc(what),
+                                  instruction.tol) == 0;
+          break;
+        case OpCode::Greater:
+          res = Queries::queryCmp(instruction.val, instruction.dataFunc(what),
+                                  instruction.tol) > 0;
+          break;
+        case OpCode::GreaterEqual:
+          res = Queries::queryCmp(instruction.val, instruction.dataFunc(what),
+                                  instruction.tol) >= 0;
+          break;
+        case OpCode::Less:
+          res = Queries::queryCmp(instruction.val, instruction.dataFunc(what),
+                                  instruction.tol) < 0;
+          break;
+        case OpCode::LessEqual:
+          res = Queries::queryCmp(instruction.val, instruction.dataFunc(what),
+                                  instruction.tol) <= 0;
+          break;
+        case OpCode::Range: {
+          const auto v = instruction.dataFunc(what);
+          const auto lCmp =
+              Queries::queryCmp(instruction.val, v, instruction.tol);
+          const auto uCmp =
+              Queries::queryCmp(instruction.upper, v, instruction.tol);
+          res = (instruction.lowerOpen ? lCmp < 0 : lCmp <= 0) &&
+                (instruction.upperOpen ? uCmp > 0 : uCmp >= 0);
+        } break;
+        case OpCode::Function: {
+          const auto v = instruction.dataFunc(what);
+          res = instruction.matchFunc ? instruction.matchFunc(v)
+                                      : static_cast<bool>(v);
+        } break;
+        case OpCode::Call:
+        default:
+          res = instruction.query->Match(what);
+          break;
+      }
+      pc = res ? instruction.onTrue : instruction.onFalse;
+      if (pc < 0) {
+        return pc == accept;
+      }
+    }
+  }
+
+  //! returns whether or not the query is unchanged since it was compiled
+  bool isCurrent() const {
+    return std::all_of(d_nodes.begin(), d_nodes.end(), [](const auto &node) {
+      return node.first->getGeneration() == node.second;
+    });
+  }
+
+  //! returns the number of instructions in the program
+  unsigned int getNumInstructions() const {
+    return static_cast<unsigned int>(d_program.size());
+  }
+  //! returns the number of query nodes which are evaluated by calling their
+  //! Match() method
+  unsigned int getNumCalls() const {
+    return static_cast<unsigned int>(
+        std::count_if(d_program.begin(), d_program.end(),
+                      [](const auto &ins) { return ins.op == OpCode::Call; }));
+  }
+
+ private:
+  using DataFuncPtr = int (*)(TargetPtr);
+  using MatchFuncPtr = bool (*)(int);
+  using EqualityType = Queries::EqualityQuery<int, TargetPtr, true>;
+  using GreaterType = Queries::GreaterQuery<int, TargetPtr, true>;
+  using GreaterEqualType = Queries::GreaterEqualQuery<int, TargetPtr, true>;
+  using LessType = Queries::LessQuery<int, TargetPtr, true>;
+  using LessEqualType = Queries::LessEqualQuery<int, TargetPtr, true>;
+  using RangeType = Queries::RangeQuery<int, TargetPtr, true>;
+  using AndType = Queries::AndQuery<int, TargetPtr, true>;
+  using OrType = Queries::OrQuery<int, TargetPtr, true>;
+
+  // jump targets which end the evaluation
+  static constexpr int accept = -1;
+  static constexpr int reject = -2;
+
+  enum class OpCode : std::uint8_t {
+    Equal,
+    Greater,
+    GreaterEqual,
+    Less,
+    LessEqual,
+    Range,
+    Function,
+    Call
+  };
+  struct Instruction {
+    OpCode op = OpCode::Call;
+    bool lowerOpen = false;
+    bool upperOpen = false;
+    int val = 0;  // also the lower bound of ranges
+    int upper = 0;
+    int tol = 0;
+    DataFuncPtr dataFunc = nullptr;
+    MatchFuncPtr matchFunc = nullptr;
+    const QUERY_TYPE *query = nullptr;
+    // while compiling these are labels, afterwards they are instruction
+    // indices (or accept/reject)
+    int onTrue = accept;
+    int onFalse = reject;
+  };
+
+  std::vector<Instruction> d_program;
+  std::vector<int> d_labels;
+  //! the nodes the program was compiled from, with their generations
+  std::vector<std::pair<const QUERY_TYPE *, unsigned int>> d_nodes;
+
+  int newLabel() {
+    d_labels.push_back(-1);
+    return static_cast<int>(d_labels.size()) - 1;
+  }
+  void bindLabel(int label) {
+    d_labels[label] = static_cast<int>(d_program.size());
+  }
+  int resolve(int target) const {
+    return target < 0 ? target : d_labels[target];
+  }
+
+  static DataFuncPtr getDataFunc(const QUERY_TYPE *q) {
+    const auto func = q->getDataFunc();
+    const auto res = func.template target<DataFuncPtr>();
+    return res ? *res : nullptr;
+  }
+
+  static bool isComposite(const QUERY_TYPE *q) {
+    const auto &type = typeid(*q);
+    return (type == typeid(AndType) || type == typeid(OrType)) &&
+           q->beginChildren() != q->endChildren();
+  }
+
+  // returns whether or not a node (and everything below it) can be evaluated
+  // without falling back to Match()
+  static bool isLowerable(const QUERY_TYPE *q) {
+    const auto &type = typeid(*q);
+    if (isComposite(q)) {
+      return std::all_of(q->beginChildren(), q->endChildren(),
+                         [](const auto &child) {
+                           return isLowerable(child.get());
+                         });
+    }
+    if (!getDataFunc(q)) {
+      return false;
+    }
+    if (type == typeid(QUERY_TYPE)) {
+      const auto func = q->getMatchFunc();
+      return !func || func.template target<MatchFuncPtr>();
+    }
+    return type == typeid(EqualityType) || type == typeid(GreaterType) ||
+           type == typeid(GreaterEqualType) || type == typeid(LessType) ||
+           type == typeid(LessEqualType) || type == typeid(RangeType);
+  }
+
+  void compile(const QUERY_TYPE *q, int onTrue, int onFalse) {
+    d_nodes.emplace_back(q, q->getGeneration());
+    const auto &type = typeid(*q);
+    Instruction instruction;
+    instruction.query = q;
+    if (!isComposite(q) && !isLowerable(q)) {
+      // Match() takes care of the negation
+      instruction.onTrue = onTrue;
+      instruction.onFalse = onFalse;
+      d_program.push_back(instruction);
+      return;
+    }
+    if (q->getNegation()) {
+      std::swap(onTrue, onFalse);
+    }
+    if (isComposite(q)) {
+      const bool isAnd = type == typeid(AndType);
+      // the children are free of side effects, so the ones which can be
+      // evaluated inline go first
+      std::vector<const QUERY_TYPE *> children;
+      for (auto it = q->beginChildren(); it != q->endChildren(); ++it) {
+        children.push_back(it->get());
+      }
+      std::stable_partition(
+          children.begin(), children.end(),
+          [](const QUERY_TYPE *child) { return isLowerable(child); });
+      for (auto i = 0u; i < children.size(); ++i) {
+        if (i + 1 == children.size()) {
+          compile(children[i], onTrue, onFalse);
+        } else {
+          const auto next = newLabel();
+          if (isAnd) {
+            compile(children[i], next, onFalse);
+          } else {
+            compile(children[i], onTrue, next);
+          }
+          bindLabel(next);
+        }
+      }
+      return;
+    }
+    instruction.dataFunc = getDataFunc(q);
+    if (type == typeid(QUERY_TYPE)) {
+      instruction.op = OpCode::Function;
+      const auto func = q->getMatchFunc();
+      if (func) {
+        instruction.matchFunc = *func.template target<MatchFuncPtr>();
+      }
+    } else if (type == typeid(RangeType)) {
+      const auto rq = static_cast<const RangeType *>(q);
+      instruction.op = OpCode::Range;
+      instruction.val = rq->getLower();
+      instruction.upper = rq->getUpper();
+      instruction.tol = rq->getTol();
+      std::tie(instruction.lowerOpen, instruction.upperOpen) =
+          rq->getEndsOpen();
+    } else {
+      // all of the single value comparisons derive from EqualityQuery
+      const auto eq = static_cast<const EqualityType *>(q);
+      instruction.val = eq->getVal();
+      instruction.tol = eq->getTol();
+      if (type == typeid(EqualityType)) {
+        instruction.op = OpCode::Equal;
+      } else if (type == typeid(GreaterType)) {
+        instruction.op = OpCode::Greater;
+      } else if (type == typeid(GreaterEqualType)) {
+        instruction.op = OpCode::GreaterEqual;
+      } else if (type == typeid(LessType)) {
+        instruction.op = OpCode::Less;
+      } else {
+        instruction.op = OpCode::LessEqual;
+      }
+    }
+    instruction.onTrue = onTrue;
+    instruction.onFalse = onFalse;
+    d_program.push_back(instruction);
+  }
+};
+
+//! owns the CompiledQuery of a query and recompiles it when the query has
+//! been modified in place
+/*!
+  Recompiling happens in update(), not in Match(). It is safe while other
+  threads are matching against the query: the programs which are replaced
+  are kept until the holder is destroyed, since other threads may still be
+  running them.
+*/
+template <class TargetPtr>
+class CompiledQueryHolder {
+ public:
+  using QUERY_TYPE = typename CompiledQuery<TargetPtr>::QUERY_TYPE;
+
+  explicit CompiledQueryHolder(const QUERY_TYPE &query) : dp_query(&query) {
+    d_programs.emplace_back(new CompiledQuery<TargetPtr>(query));
+    dp_current = d_programs.back().get();
+  }
+  CompiledQueryHolder(const CompiledQueryHolder &) = delete;
+  CompiledQueryHolder &operator=(const CompiledQueryHolder &) = delete;
+
+  //! returns the current program for the query
+  /*!
+    This does not check whether the query has been modified in place since
+    the program was compiled, call update() for that.
+  */
+  const CompiledQuery<TargetPtr> &get() const {
+    return *dp_current.load(std::memory_order_acquire);
+  }
+
+  //! recompiles the program if the query has been modified in place
+  void update() const {
+    if (get().isCurrent()) {
+      return;
+    }
+#ifdef RDK_BUILD_THREADSAFE_SSS
+    std::lock_guard<std::mutex> lock(d_mutex);
+#endif
+    // another thread may have got here first
+    if (!get().isCurrent()) {
+      d_programs.emplace_back(new CompiledQuery<TargetPtr>(*dp_query));
+      dp_current.store(d_programs.back().get(), std::memory_order_release);
+    }
+  }
+
+  //! returns whether or not the query matches \c what
+  bool Match(const TargetPtr what) const { return get().Match(what); }
+
+ private:
+
+  const QUERY_TYPE *dp_query;
+  mutable std::atomic<const CompiledQuery<TargetPtr> *> dp_current;
+  //! every program we have compiled, the last one is current
+  mutable std::vector<std::unique_ptr<const CompiledQuery<TargetPtr>>>
+      d_programs;
+#ifdef RDK_BUILD_THREADSAFE_SSS
+  mutable std::mutex d_mutex;
+#endif
+};
+
+}  // namespace RDKit
+#endif
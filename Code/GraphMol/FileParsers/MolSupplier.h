@@ -23,6 +23,7 @@
 #include <GraphMol/ROMol.h>
 #include <RDGeneral/BadFileException.h>
 #include "FileParsers.h"
+#include "SupplierIndex.h"
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #ifdef RDK_BUILD_THREADSAFE_SSS
 #include <mutex>
@@ -418,6 +419,19 @@ class RDKIT_FILEPARSERS_EXPORT SDMolSupplier : public ForwardSDMolSupplier {
    */
   void setStreamIndices(const std::vector<std::streampos> &locs);
 
+  //! Resets our internal state and sets the positions of the molecules from
+  //! an index of the input file
+  void setIndex(const SupplierIndex &index);
+  /*! Uses a persistent index of the input file for random access.
+   *
+   *  The index is read from the sidecar file if it is up to date with the
+   *  input file, otherwise it is built (in parallel if requested) and
+   *  saved. See SupplierIndex.h for the details.
+   *  This is only available for suppliers which were constructed from a
+   *  file name.
+   */
+  void useIndexFile(const SupplierIndexParams &params = SupplierIndexParams());
+
   iterator begin() { return RandomAccessSupplierIter(this); }
   iterator end() { return RandomAccessSupplierIter(this, length()); }
   reverse_iterator rbegin() { return reverse_iterator(end()); }
@@ -433,6 +447,7 @@ class RDKIT_FILEPARSERS_EXPORT SDMolSupplier : public ForwardSDMolSupplier {
   int d_len = 0;   // total number of mol blocks in the file (initialized to -1)
   int d_last = 0;  // the molecule we are ready to read
   std::vector<std::streampos> d_molpos;
+  std::string d_fileName;  // empty unless we were constructed from a file
   bool d_cacheMolecules = false;
   std::vector<std::optional<std::shared_ptr<RWMol>>> d_molCache;
 #ifdef RDK_BUILD_THREADSAFE_SSS
@@ -509,6 +524,23 @@ class RDKIT_FILEPARSERS_EXPORT SmilesMolSupplier : public MolSupplier {
   std::string getItemText(unsigned int idx);
   unsigned int length();
 
+  //! Resets our internal state and sets the positions of the molecules from
+  //! an index of the input file
+  /*!
+    The index must have been built with the same parameters as this
+    supplier, otherwise a ValueErrorException is thrown.
+  */
+  void setIndex(const SupplierIndex &index);
+  /*! Uses a persistent index of the input file for random access.
+   *
+   *  The index is read from the sidecar file if it is up to date with the
+   *  input file, otherwise it is built (in parallel if requested) and
+   *  saved. See SupplierIndex.h for the details.
+   *  This is only available for suppliers which were constructed from a
+   *  file name.
+   */
+  void useIndexFile(const SupplierIndexParams &params = SupplierIndexParams());
+
   iterator begin() { return iterator(this); }
   iterator end() { return iterator(this, length()); }
   reverse_iterator rbegin() { return reverse_iterator(end()); }
@@ -533,6 +565,7 @@ class RDKIT_FILEPARSERS_EXPORT SmilesMolSupplier : public MolSupplier {
       d_molpos;  // vector of positions in the file for molecules
   std::vector<int> d_lineNums;
   STR_VECT d_props;  // vector of property names
+  std::string d_fileName;  // empty unless we were constructed from a file
   bool d_cacheMolecules = false;
   std::vector<std::optional<std::shared_ptr<RWMol>>> d_molCache;
 #ifdef RDK_BUILD_THREADSAFE_SSS
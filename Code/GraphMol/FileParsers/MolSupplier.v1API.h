@@ -225,6 +225,12 @@ class RDKIT_FILEPARSERS_EXPORT SDMolSupplier : public ForwardSDMolSupplier {
     PRECONDITION(dp_supplier, "no supplier");
     static_cast<ContainedType *>(dp_supplier.get())->setStreamIndices(locs);
   }
+  //! uses a persistent index of the input file, see SupplierIndex.h
+  void useIndexFile(const v2::FileParsers::SupplierIndexParams &params =
+                        v2::FileParsers::SupplierIndexParams()) {
+    PRECONDITION(dp_supplier, "no supplier");
+    static_cast<ContainedType *>(dp_supplier.get())->useIndexFile(params);
+  }
 };
 
 //! lazy file parser for Smiles tables
@@ -323,6 +329,12 @@ class RDKIT_FILEPARSERS_EXPORT SmilesMolSupplier : public MolSupplier {
     PRECONDITION(dp_supplier, "no supplier")
     return static_cast<ContainedType *>(dp_supplier.get())->length();
   }
+  //! uses a persistent index of the input file, see SupplierIndex.h
+  void useIndexFile(const v2::FileParsers::SupplierIndexParams &params =
+                        v2::FileParsers::SupplierIndexParams()) {
+    PRECONDITION(dp_supplier, "no supplier");
+    static_cast<ContainedType *>(dp_supplier.get())->useIndexFile(params);
+  }
 };
 
 //! lazy file parser for TDT files
@@ -10,8 +10,13 @@
 //
 #include "MultithreadedMolSupplier.h"
 
+#include <GraphMol/MolArena.h>
 #include <RDGeneral/RDLog.h>
 
+#include <algorithm>
+#include <limits>
+#include <optional>
+
 namespace RDKit {
 
 namespace v2 {
@@ -19,6 +24,11 @@ namespace FileParsers {
 
 void MultithreadedMolSupplier::close() {
   df_forceStop = true;
+  // wake up writers waiting for the reorder window
+  {
+    std::lock_guard<std::mutex> lock(d_reorderMutex);
+  }
+  d_reorderCond.notify_all();
   d_outputQueue->setDone();
 
   if (df_started) {
@@ -57,6 +67,11 @@ void MultithreadedMolSupplier::close() {
       delete std::get<0>(r);
     }
   }
+  for (auto &[index, r] : d_reorderBuffer) {
+    delete std::get<0>(r);
+  }
+  d_reorderBuffer.clear();
+  d_reorderBufferSize = 0;
 
   // close external streams if any
   //  destructors are called child to parent, however the threads
@@ -69,41 +84,150 @@ void MultithreadedMolSupplier::close() {
 void MultithreadedMolSupplier::reader() {
   std::string record;
   unsigned int lineNum, index;
-  while (!df_forceStop && extractNextRecord(record, lineNum, index)) {
-    if (readCallback) {
-      try {
-        record = readCallback(record, index);
-      } catch (std::exception &e) {
-        BOOST_LOG(rdErrorLog)
-            << "Read callback exception: " << e.what() << std::endl;
+  try {
+    if (d_params.chunkSize) {
+      // the read callback is applied to the individual records by the
+      // writer threads
+      while (!df_forceStop && extractNextChunk(record, lineNum, index)) {
+        if (d_params.preserveOrder) {
+          {
+            std::lock_guard<std::mutex> lock(d_reorderMutex);
+            d_chunkStarts.push_back(index);
+          }
+          // the next record to be returned may be in this chunk
+          d_reorderCond.notify_all();
+        }
+        d_inputQueue->push(std::make_tuple(std::move(record), lineNum, index));
+      }
+    } else {
+      while (!df_forceStop && extractNextRecord(record, lineNum, index)) {
+        if (readCallback) {
+          try {
+            record = readCallback(record, index);
+          } catch (std::exception &e) {
+            BOOST_LOG(rdErrorLog)
+                << "Read callback exception: " << e.what() << std::endl;
+          }
+        }
+        auto r = std::make_tuple(record, lineNum, index);
+        if (!df_forceStop) {
+          d_inputQueue->push(r);
+        }
       }
     }
-    auto r = std::make_tuple(record, lineNum, index);
-    if (!df_forceStop) {
-      d_inputQueue->push(r);
-    }
+  } catch (std::exception &e) {
+    BOOST_LOG(rdErrorLog) << "Error reading input: " << e.what()
+                          << std::endl;
   }
   d_inputQueue->setDone();
 }
 
+bool MultithreadedMolSupplier::extractNextChunk(std::string &chunk,
+                                                unsigned int &lineNum,
+                                                unsigned int &index) {
+  PRECONDITION(dp_inStream, "no stream");
+  std::string text = std::move(d_chunkRemainder);
+  d_chunkRemainder.clear();
+  std::vector<std::pair<std::string_view, unsigned int>> records;
+  size_t used = 0;
+  while (true) {
+    bool atEnd = dp_inStream->eof() || dp_inStream->fail();
+    if (!atEnd) {
+      const auto start = text.size();
+      text.resize(start + d_params.chunkSize);
+      dp_inStream->read(text.data() + start, d_params.chunkSize);
+      text.resize(start + dp_inStream->gcount());
+      atEnd = dp_inStream->eof() || dp_inStream->fail();
+    }
+    records.clear();
+    used = findRecords(text, atEnd, records);
+    // keep reading until we have at least one complete record
+    if (!records.empty() || atEnd) {
+      break;
+    }
+  }
+  if (records.empty()) {
+    return false;
+  }
+  d_chunkRemainder = text.substr(used);
+  text.resize(used);
+  chunk = std::move(text);
+  lineNum = d_chunkLineNum;
+  index = d_chunkRecordId;
+  d_chunkLineNum += std::count(chunk.begin(), chunk.end(), '\n');
+  d_chunkRecordId += records.size();
+  return true;
+}
+
+size_t MultithreadedMolSupplier::findRecords(
+    std::string_view, bool,
+    std::vector<std::pair<std::string_view, unsigned int>> &) const {
+  throw ValueErrorException("this supplier does not support reading chunks");
+}
+
+void MultithreadedMolSupplier::processRecord(std::string &record,
+                                             unsigned int lineNum,
+                                             unsigned int index) {
+  // with chunks the writer waits once per chunk instead
+  if (d_params.preserveOrder && !d_params.chunkSize) {
+    waitForReorderWindow(index);
+    if (df_forceStop) {
+      return;
+    }
+  }
+  try {
+    std::unique_ptr<RWMol> mol(processMoleculeRecord(record, lineNum));
+    if (!df_forceStop && mol && writeCallback) {
+      writeCallback(*mol, record, index);
+    }
+    auto temp = std::tuple<RWMol *, std::string, unsigned int>{
+        mol.release(), std::move(record), index};
+
+    d_outputQueue->push(temp);
+  } catch (...) {
+    // fill the queue wih a null value
+    auto nullValue = std::tuple<RWMol *, std::string, unsigned int>{
+        nullptr, std::move(record), index};
+    d_outputQueue->push(nullValue);
+  }
+}
+
 void MultithreadedMolSupplier::writer() {
+  // the molecules are deleted by the consumer, the arena's memory is
+  // released once all of them are gone
+  std::optional<MolArena::Scope> arenaScope;
+  if (d_params.useArena) {
+    arenaScope.emplace();
+  }
   std::tuple<std::string, unsigned int, unsigned int> r;
+  std::vector<std::pair<std::string_view, unsigned int>> records;
   while (!df_forceStop && d_inputQueue->pop(r)) {
-    try {
-      std::unique_ptr<RWMol> mol(
-          processMoleculeRecord(std::get<0>(r), std::get<1>(r)));
-      if (!df_forceStop && mol && writeCallback) {
-        writeCallback(*mol, std::get<0>(r), std::get<2>(r));
+    auto &[text, lineNum, index] = r;
+    if (!d_params.chunkSize) {
+      processRecord(text, lineNum, index);
+      continue;
+    }
+    if (d_params.preserveOrder) {
+      waitForReorderWindow(index);
+      if (df_forceStop) {
+        break;
       }
-      auto temp = std::tuple<RWMol *, std::string, unsigned int>{
-          mol.release(), std::get<0>(r), std::get<2>(r)};
-
-      d_outputQueue->push(temp);
-    } catch (...) {
-      // fill the queue wih a null value
-      auto nullValue = std::tuple<RWMol *, std::string, unsigned int>{
-          nullptr, std::get<0>(r), std::get<2>(r)};
-      d_outputQueue->push(nullValue);
+    }
+    // split the chunk into records, the reader already did this once so we
+    // know that this works
+    records.clear();
+    findRecords(text, true, records);
+    for (unsigned int i = 0; i < records.size() && !df_forceStop; ++i) {
+      std::string record(records[i].first);
+      if (readCallback) {
+        try {
+          record = readCallback(record, index + i);
+        } catch (std::exception &e) {
+          BOOST_LOG(rdErrorLog)
+              << "Read callback exception: " << e.what() << std::endl;
+        }
+      }
+      processRecord(record, lineNum + records[i].second, index + i);
     }
   }
 
@@ -131,7 +255,10 @@ std::unique_ptr<RWMol> MultithreadedMolSupplier::next() {
     startThreads();
   }
   std::tuple<RWMol *, std::string, unsigned int> r;
-  if (!df_forceStop && d_outputQueue->pop(r)) {
+  const bool haveItem = d_params.preserveOrder
+                            ? popInOrder(r)
+                            : !df_forceStop && d_outputQueue->pop(r);
+  if (haveItem) {
     d_lastItemText = std::get<1>(r);
     d_lastRecordId = std::get<2>(r);
     std::unique_ptr<RWMol> res{std::get<0>(r)};
@@ -173,8 +300,117 @@ void MultithreadedMolSupplier::startThreads() {
   }
 }
 
+size_t MultithreadedMolSupplier::getReorderWindow() const {
+  if (d_params.reorderWindow) {
+    return d_params.reorderWindow;
+  }
+  return d_params.chunkSize ? 4 * d_params.numWriterThreads : 4096;
+}
+
+void MultithreadedMolSupplier::updateNextChunk() {
+  while (d_nextChunk + 1 < d_chunkStarts.size() &&
+         d_chunkStarts[d_nextChunk + 1] <= d_nextRecordId) {
+    ++d_nextChunk;
+  }
+}
+
+void MultithreadedMolSupplier::waitForReorderWindow(unsigned int index) {
+  const auto window = getReorderWindow();
+  if (window == std::numeric_limits<size_t>::max()) {
+    return;
+  }
+  // the item holding d_nextRecordId is always inside the window, so
+  // whichever writer has it can go on and the others are woken up as the
+  // consumer advances
+  std::unique_lock<std::mutex> lock(d_reorderMutex);
+  if (!d_params.chunkSize) {
+    d_reorderCond.wait(lock, [&]() {
+      return df_forceStop || index < d_nextRecordId ||
+             index - d_nextRecordId < window;
+    });
+    return;
+  }
+  // the reader adds a chunk to d_chunkStarts before queueing it
+  const size_t chunk =
+      std::lower_bound(d_chunkStarts.begin(), d_chunkStarts.end(), index) -
+      d_chunkStarts.begin();
+  d_reorderCond.wait(lock, [&]() {
+    updateNextChunk();
+    return df_forceStop || chunk < d_nextChunk ||
+           chunk - d_nextChunk < window;
+  });
+}
+
+void MultithreadedMolSupplier::advanceNextRecordId(unsigned int index) {
+  {
+    std::lock_guard<std::mutex> lock(d_reorderMutex);
+    d_nextRecordId = index + 1;
+  }
+  d_reorderCond.notify_all();
+}
+
+bool MultithreadedMolSupplier::popInOrder(
+    std::tuple<RWMol *, std::string, unsigned int> &r) {
+  // results which arrive before the ones ahead of them in the input are
+  // parked in the reorder buffer, the writers do not run more than the
+  // reorder window ahead, so this stays bounded
+  auto takeFirst = [&]() {
+    auto first = d_reorderBuffer.begin();
+    r = std::move(first->second);
+    advanceNextRecordId(first->first);
+    d_reorderBuffer.erase(first);
+    d_reorderBufferSize = d_reorderBuffer.size();
+  };
+  while (!df_forceStop) {
+    if (!d_reorderBuffer.empty() &&
+        d_reorderBuffer.begin()->first <= d_nextRecordId) {
+      takeFirst();
+      return true;
+    }
+    std::tuple<RWMol *, std::string, unsigned int> item;
+    if (!d_outputQueue->pop(item)) {
+      break;
+    }
+    if (std::get<2>(item) == d_nextRecordId) {
+      r = std::move(item);
+      advanceNextRecordId(std::get<2>(r));
+      return true;
+    }
+    d_reorderBuffer.emplace(std::get<2>(item), std::move(item));
+    d_reorderBufferSize = d_reorderBuffer.size();
+    if (d_reorderBufferSize > d_maxReorderBufferSize) {
+      d_maxReorderBufferSize = d_reorderBufferSize.load();
+    }
+  }
+  // the writers are done, return whatever is left
+  if (!df_forceStop && !d_reorderBuffer.empty()) {
+    takeFirst();
+    return true;
+  }
+  return false;
+}
+
 bool MultithreadedMolSupplier::atEnd() {
-  return (d_outputQueue->isEmpty() && d_outputQueue->getDone());
+  return (d_outputQueue->isEmpty() && d_outputQueue->getDone() &&
+          d_reorderBuffer.empty());
+}
+
+MultithreadedMolSupplier::QueueStats MultithreadedMolSupplier::getQueueStats()
+    const {
+  QueueStats res;
+  if (d_inputQueue) {
+    res.inputQueueSize = d_inputQueue->size();
+    res.inputQueueCapacity = d_inputQueue->getCapacity();
+    res.maxInputQueueSize = d_inputQueue->getMaxSize();
+  }
+  if (d_outputQueue) {
+    res.outputQueueSize = d_outputQueue->size();
+    res.outputQueueCapacity = d_outputQueue->getCapacity();
+    res.maxOutputQueueSize = d_outputQueue->getMaxSize();
+  }
+  res.reorderBufferSize = d_reorderBufferSize;
+  res.maxReorderBufferSize = d_maxReorderBufferSize;
+  return res;
 }
 
 unsigned int MultithreadedMolSupplier::getLastRecordId() const {
@@ -21,6 +21,9 @@
 
 #include <functional>
 #include <atomic>
+#include <condition_variable>
+#include <map>
+#include <string_view>
 #include <boost/tokenizer.hpp>
 
 #include "FileParsers.h"
@@ -39,6 +42,40 @@ class RDKIT_FILEPARSERS_EXPORT MultithreadedMolSupplier : public MolSupplier {
     unsigned int numWriterThreads = 1;
     size_t sizeInputQueue = 5;
     size_t sizeOutputQueue = 5;
+    //! the writer threads allocate molecules from their MolArena
+    bool useArena = false;
+    //! if this is nonzero, the reader thread reads the input in blocks of
+    //! about this many bytes, cut at record boundaries, and the writer
+    //! threads split the blocks into records. The input queue then holds
+    //! blocks instead of records. This takes most of the work off of the
+    //! reader thread, which otherwise limits the throughput for large files.
+    size_t chunkSize = 0;
+    //! return the molecules in the order they appear in the input
+    bool preserveOrder = false;
+    //! when preserveOrder is set, this bounds how far the writer threads
+    //! run ahead of the next record to be returned. It counts the items in
+    //! the input queue: records, or chunks when chunkSize is set. A writer
+    //! waits before starting an item which is this many or more items ahead
+    //! of the one holding the next record, so the reorder buffer holds at
+    //! most this many items' worth of molecules. It should be larger than
+    //! numWriterThreads, otherwise the writers wait for each other. Zero
+    //! selects 4096 records or four chunks per writer thread, the maximum
+    //! value of size_t removes the limit.
+    size_t reorderWindow = 0;
+  };
+
+  //! the current and peak occupancy of the supplier's queues
+  struct QueueStats {
+    size_t inputQueueSize = 0;
+    size_t inputQueueCapacity = 0;
+    size_t maxInputQueueSize = 0;
+    size_t outputQueueSize = 0;
+    size_t outputQueueCapacity = 0;
+    size_t maxOutputQueueSize = 0;
+    //! number of molecules waiting for earlier records to be finished, only
+    //! used when Parameters::preserveOrder is set
+    size_t reorderBufferSize = 0;
+    size_t maxReorderBufferSize = 0;
   };
 
   MultithreadedMolSupplier() {}
@@ -67,6 +104,10 @@ class RDKIT_FILEPARSERS_EXPORT MultithreadedMolSupplier : public MolSupplier {
   //! returns the text block for the last extracted item
   std::string getLastItemText() const;
 
+  //! returns the occupancy of the queues, this can be used to tune the
+  //! queue sizes and number of threads
+  QueueStats getQueueStats() const;
+
   //! sets the callback to be applied to molecules before they are returned by
   ///! the next() function
   /*!
@@ -132,6 +173,35 @@ class RDKIT_FILEPARSERS_EXPORT MultithreadedMolSupplier : public MolSupplier {
   //! processes the record into an RWMol object
   virtual RWMol *processMoleculeRecord(const std::string &record,
                                        unsigned int lineNum) = 0;
+  //! finds the complete records in a block of text
+  /*!
+    Used when Parameters::chunkSize is set.
+
+    \param text     the text to split
+    \param atEnd    whether or not the text runs to the end of the input
+    \param records  used to return the records and the line each one starts
+                    on (relative to the start of the text)
+
+    \return the number of bytes of the text which were used
+  */
+  virtual size_t findRecords(
+      std::string_view text, bool atEnd,
+      std::vector<std::pair<std::string_view, unsigned int>> &records) const;
+  //! parses a record and puts the result in the output queue
+  void processRecord(std::string &record, unsigned int lineNum,
+                     unsigned int index);
+  //! pops the next molecule in input order into the reorder buffer
+  bool popInOrder(std::tuple<RWMol *, std::string, unsigned int> &r);
+  //! blocks until the record, or the chunk starting with the record, with
+  //! id \c index is within the reorder window
+  void waitForReorderWindow(unsigned int index);
+  //! returns the reorder window which is used, see Parameters::reorderWindow
+  size_t getReorderWindow() const;
+  //! moves d_nextChunk to the chunk holding d_nextRecordId, the caller must
+  //! hold d_reorderMutex
+  void updateNextChunk();
+  //! moves the next record to be returned past \c index
+  void advanceNextRecordId(unsigned int index);
 
   std::mutex d_threadCounterMutex;
   std::atomic<unsigned int> d_threadCounter{1};  //!< thread counter
@@ -147,6 +217,27 @@ class RDKIT_FILEPARSERS_EXPORT MultithreadedMolSupplier : public MolSupplier {
   std::string d_lastItemText;  //!< stores last extracted record
   const unsigned int d_numReaderThread = 1;  //!< number of reader thread
 
+  //! extracts the next block of complete records from the input, used when
+  //! Parameters::chunkSize is set
+  virtual bool extractNextChunk(std::string &chunk, unsigned int &lineNum,
+                                unsigned int &index);
+
+  std::string d_chunkRemainder;  //!< input read past the end of the last chunk
+  unsigned int d_chunkLineNum = 0;   //!< line number of the next chunk
+  unsigned int d_chunkRecordId = 1;  //!< record id of the next chunk
+  std::map<unsigned int, std::tuple<RWMol *, std::string, unsigned int>>
+      d_reorderBuffer;  //!< molecules waiting for earlier records
+  unsigned int d_nextRecordId = 1;  //!< next record id to return in order
+  //! the ids of the first records of the chunks read so far, used when
+  //! Parameters::chunkSize and Parameters::preserveOrder are set
+  std::vector<unsigned int> d_chunkStarts;
+  size_t d_nextChunk = 0;  //!< the chunk holding d_nextRecordId
+  //! protects d_nextRecordId, d_chunkStarts and d_nextChunk
+  std::mutex d_reorderMutex;
+  std::condition_variable d_reorderCond;  //!< signals d_nextRecordId changes
+  std::atomic<size_t> d_reorderBufferSize = 0;
+  std::atomic<size_t> d_maxReorderBufferSize = 0;
+
   std::unique_ptr<
       ConcurrentQueue<std::tuple<std::string, unsigned int, unsigned int>>>
       d_inputQueue;  //!< concurrent input queue
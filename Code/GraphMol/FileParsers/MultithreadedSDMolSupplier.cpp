@@ -244,6 +244,50 @@ void MultithreadedSDMolSupplier::readMolProps(RWMol &mol,
   }
 }
 
+// this uses the same rules as extractNextRecord(): a record ends with a line
+// starting with $$$$ which follows either a blank line or the M  END line
+size_t MultithreadedSDMolSupplier::findRecords(
+    std::string_view text, bool atEnd,
+    std::vector<std::pair<std::string_view, unsigned int>> &records) const {
+  size_t recordStart = 0;
+  unsigned int recordLine = 0;
+  unsigned int line = 0;
+  bool canEndRecord = true;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    auto eol = text.find('\n', pos);
+    if (eol == std::string_view::npos) {
+      if (!atEnd) {
+        break;
+      }
+      eol = text.size();
+    }
+    const auto lineText = text.substr(pos, eol - pos);
+    const auto next = std::min(eol + 1, text.size());
+    ++line;
+    if (canEndRecord && lineText.starts_with("$$$$")) {
+      records.emplace_back(text.substr(recordStart, next - recordStart),
+                           recordLine);
+      recordStart = next;
+      recordLine = line;
+    } else {
+      canEndRecord =
+          lineText.find_first_not_of(" \t\r\n") == std::string_view::npos ||
+          lineText.starts_with("M  END");
+    }
+    pos = next;
+  }
+  if (!atEnd) {
+    return recordStart;
+  }
+  // a final record without a $$$$ line, trailing new lines are ignored
+  const auto rest = text.substr(recordStart);
+  if (rest.find_first_not_of("\n\r") != std::string_view::npos) {
+    records.emplace_back(rest, recordLine);
+  }
+  return text.size();
+}
+
 RWMol *MultithreadedSDMolSupplier::processMoleculeRecord(
     const std::string &record, unsigned int lineNum) {
   PRECONDITION(dp_inStream, "no stream");
@@ -46,6 +46,10 @@ class RDKIT_FILEPARSERS_EXPORT MultithreadedSDMolSupplier
   //! parses the record and returns the resulting molecule
   RWMol *processMoleculeRecord(const std::string &record,
                                unsigned int lineNum) override;
+  //! finds the records in a block of text
+  size_t findRecords(std::string_view text, bool atEnd,
+                     std::vector<std::pair<std::string_view, unsigned int>>
+                         &records) const override;
  protected:
     void closeStreams() override;
 
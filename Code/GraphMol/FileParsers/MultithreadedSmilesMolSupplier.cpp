@@ -74,13 +74,15 @@ bool MultithreadedSmilesMolSupplier::getEnd() const {
 //
 //  Reads and processes the title line
 //
-void MultithreadedSmilesMolSupplier::processTitleLine() {
+unsigned int MultithreadedSmilesMolSupplier::processTitleLine() {
   PRECONDITION(dp_inStream, "bad stream");
   std::string tempStr = getLine(dp_inStream);
+  unsigned int numLines = 1;
   // loop until we get a valid line
   while (!dp_inStream->eof() && !dp_inStream->fail() &&
          ((tempStr[0] == '#') || (strip(tempStr).size() == 0))) {
     tempStr = getLine(dp_inStream);
+    ++numLines;
   }
   boost::char_separator<char> sep(d_parseParams.delimiter.c_str(), "",
                                   boost::keep_empty_tokens);
@@ -90,6 +92,46 @@ void MultithreadedSmilesMolSupplier::processTitleLine() {
     std::string pname = strip(*tokIter);
     d_props.push_back(pname);
   }
+  return numLines;
+}
+
+bool MultithreadedSmilesMolSupplier::extractNextChunk(std::string &chunk,
+                                                      unsigned int &lineNum,
+                                                      unsigned int &index) {
+  PRECONDITION(dp_inStream, "bad stream");
+  if (d_parseParams.titleLine && d_props.empty() && d_chunkRecordId == 1 &&
+      !d_chunkLineNum) {
+    d_chunkLineNum = processTitleLine();
+  }
+  return MultithreadedMolSupplier::extractNextChunk(chunk, lineNum, index);
+}
+
+// each line which is not blank or a comment is a record
+size_t MultithreadedSmilesMolSupplier::findRecords(
+    std::string_view text, bool atEnd,
+    std::vector<std::pair<std::string_view, unsigned int>> &records) const {
+  size_t pos = 0;
+  unsigned int line = 0;
+  while (pos < text.size()) {
+    auto eol = text.find('\n', pos);
+    if (eol == std::string_view::npos) {
+      if (!atEnd) {
+        break;
+      }
+      eol = text.size();
+    }
+    auto lineText = text.substr(pos, eol - pos);
+    if (!lineText.empty() && lineText.back() == '\r') {
+      lineText.remove_suffix(1);
+    }
+    if (!lineText.empty() && lineText[0] != '#' &&
+        lineText.find_first_not_of(" \t\r\n") != std::string_view::npos) {
+      records.emplace_back(lineText, line);
+    }
+    ++line;
+    pos = std::min(eol + 1, text.size());
+  }
+  return pos;
 }
 
 bool MultithreadedSmilesMolSupplier::extractNextRecord(std::string &record,
@@ -33,17 +33,23 @@ class RDKIT_FILEPARSERS_EXPORT MultithreadedSmilesMolSupplier
   void init() override {}
   //! returns df_end
   bool getEnd() const override;
-  //! reads and processes the title line
-  void processTitleLine();
+  //! reads and processes the title line, returns the number of lines read
+  unsigned int processTitleLine();
   //! reads next record and returns whether or not EOF was hit
   bool extractNextRecord(std::string &record, unsigned int &lineNum,
                          unsigned int &index) override;
   //! parses the record and returns the resulting molecule
   RWMol *processMoleculeRecord(const std::string &record,
                                unsigned int lineNum) override;
+  //! finds the records in a block of text
+  size_t findRecords(std::string_view text, bool atEnd,
+                     std::vector<std::pair<std::string_view, unsigned int>>
+                         &records) const override;
 
  protected:
   void closeStreams() override;
+  bool extractNextChunk(std::string &chunk, unsigned int &lineNum,
+                        unsigned int &index) override;
 
  private:
   void initFromSettings(
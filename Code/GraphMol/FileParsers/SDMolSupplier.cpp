@@ -30,6 +30,7 @@ SDMolSupplier::SDMolSupplier(const std::string &fileName,
   init();
   dp_inStream = openAndCheckStream(fileName);
   df_owner = true;
+  d_fileName = fileName;
   d_molpos.push_back(dp_inStream->tellg());
   d_params = params;
   this->checkForEnd();
@@ -62,6 +63,7 @@ void SDMolSupplier::init() {
   ForwardSDMolSupplier::init();
   d_len = -1;
   d_last = 0;
+  d_fileName.clear();
 #ifdef RDK_BUILD_THREADSAFE_SSS
   const std::lock_guard<std::mutex> guard(d_cacheMutex);
 #endif
@@ -444,6 +446,33 @@ void SDMolSupplier::setStreamIndices(const std::vector<std::streampos> &locs) {
   this->reset();
   d_len = rdcast<int>(d_molpos.size());
 }
+
+void SDMolSupplier::setIndex(const SupplierIndex &index) {
+  PRECONDITION(dp_inStream, "no stream");
+  PRECONDITION(index.fileType == SupplierIndex::FileType::SDF,
+               "not an SD file index");
+  if (index.offsets.empty()) {
+    // mimic what happens when we open an empty file
+    setStreamIndices({std::streampos(0)});
+    d_len = 0;
+    df_end = true;
+    return;
+  }
+  std::vector<std::streampos> locs;
+  locs.reserve(index.size());
+  for (auto offset : index.offsets) {
+    locs.emplace_back(static_cast<std::streamoff>(offset));
+  }
+  setStreamIndices(locs);
+}
+
+void SDMolSupplier::useIndexFile(const SupplierIndexParams &params) {
+  if (d_fileName.empty()) {
+    throw ValueErrorException(
+        "index files can only be used with suppliers reading from a file");
+  }
+  setIndex(getSDFIndex(d_fileName, params));
+}
 }  // namespace FileParsers
 }  // namespace v2
 }  // namespace RDKit
@@ -35,6 +35,7 @@ SmilesMolSupplier::SmilesMolSupplier(const std::string &fileName,
   CHECK_INVARIANT(dp_inStream, "bad instream");
   CHECK_INVARIANT(!(dp_inStream->eof()), "early EOF");
 
+  d_fileName = fileName;
   d_params = params;
   df_end = false;
 
@@ -66,6 +67,7 @@ void SmilesMolSupplier::init() {
   d_line = -1;
   d_molpos.clear();
   d_lineNums.clear();
+  d_fileName.clear();
 #ifdef RDK_BUILD_THREADSAFE_SSS
   const std::lock_guard<std::mutex> guard(d_cacheMutex);
 #endif
@@ -541,6 +543,46 @@ unsigned int SmilesMolSupplier::length() {
   }
 }
 
+void SmilesMolSupplier::setIndex(const SupplierIndex &index) {
+  PRECONDITION(dp_inStream, "no stream");
+  PRECONDITION(index.fileType == SupplierIndex::FileType::SMILES &&
+                   index.lineNums.size() == index.size(),
+               "not a SMILES file index");
+  if (index.indexKey != getSmilesIndexKey(d_params)) {
+    throw ValueErrorException(
+        "the index was built with different SMILES parsing parameters: " +
+        index.indexKey);
+  }
+  d_molpos.clear();
+  d_molpos.reserve(index.size());
+  for (auto offset : index.offsets) {
+    d_molpos.emplace_back(static_cast<std::streamoff>(offset));
+  }
+  d_lineNums.assign(index.lineNums.begin(), index.lineNums.end());
+  // the property names come from the title line, which we would otherwise
+  // have processed while reading the first molecule
+  d_props.clear();
+  if (d_params.titleLine) {
+    dp_inStream->clear();
+    dp_inStream->seekg(0);
+    df_end = false;
+    this->processTitleLine();
+  }
+  d_len = d_molpos.size();
+  this->reset();
+  if (d_molpos.empty()) {
+    df_end = true;
+  }
+}
+
+void SmilesMolSupplier::useIndexFile(const SupplierIndexParams &params) {
+  if (d_fileName.empty()) {
+    throw ValueErrorException(
+        "index files can only be used with suppliers reading from a file");
+  }
+  setIndex(getSmilesIndex(d_fileName, d_params, params));
+}
+
 bool SmilesMolSupplier::atEnd() { return df_end; }
 }  // namespace FileParsers
 }  // namespace v2
@@ -0,0 +1,474 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include "SupplierIndex.h"
+#include "MolSupplier.h"
+
+#include <RDGeneral/BadFileException.h>
+#include <RDGeneral/Exceptions.h>
+#include <RDGeneral/Invariant.h>
+#include <RDGeneral/MemoryMappedFileReader.h>
+#include <RDGeneral/RDLog.h>
+#include <RDGeneral/RDThreads.h>
+#include <RDGeneral/StreamOps.h>
+#include <boost/tokenizer.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+namespace RDKit {
+namespace v2 {
+namespace FileParsers {
+namespace {
+constexpr char indexMagic[] = "RDKITIDX";
+constexpr std::uint32_t indexVersion = 1;
+
+struct ChunkResult {
+  std::vector<std::uint64_t> offsets;
+  std::vector<std::uint64_t> lineNums;
+  std::vector<std::string> names;
+  std::uint64_t numLines = 0;
+};
+
+bool isBlank(std::string_view text) {
+  return std::all_of(text.begin(), text.end(),
+                     [](unsigned char c) { return std::isspace(c); });
+}
+
+// returns the line which starts at pos, without the line ending
+std::string_view lineAt(std::string_view data, std::size_t pos) {
+  auto end = data.find('\n', pos);
+  if (end == std::string_view::npos) {
+    end = data.size();
+  }
+  auto res = data.substr(pos, end - pos);
+  if (!res.empty() && res.back() == '\r') {
+    res.remove_suffix(1);
+  }
+  return res;
+}
+
+// a record starts at pos unless what follows is only whitespace up to the end
+// of the file or up to the fourth empty line. This matches the check
+// SDMolSupplier uses while scanning its input.
+bool sdfRecordStartsAt(std::string_view data, std::size_t pos) {
+  unsigned int emptyLines = 0;
+  for (; pos < data.size(); ++pos) {
+    if (!std::isspace(static_cast<unsigned char>(data[pos]))) {
+      return true;
+    }
+    if (data[pos] == '\n' && ++emptyLines >= 4) {
+      return false;
+    }
+  }
+  return false;
+}
+
+// finds the records which follow the "$$$$" lines starting in [begin, end)
+void scanSDFChunk(std::string_view data, std::size_t begin, std::size_t end,
+                  bool includeNames, ChunkResult &res) {
+  constexpr std::string_view delim{"$$$$"};
+  auto pos = begin;
+  while (pos < end) {
+    pos = data.find(delim, pos);
+    if (pos == std::string_view::npos || pos >= end) {
+      break;
+    }
+    if (pos && data[pos - 1] != '\n') {
+      ++pos;
+      continue;
+    }
+    auto nl = data.find('\n', pos + delim.size());
+    if (nl == std::string_view::npos) {
+      break;
+    }
+    const auto recordStart = nl + 1;
+    if (sdfRecordStartsAt(data, recordStart)) {
+      res.offsets.push_back(recordStart);
+      if (includeNames) {
+        res.names.emplace_back(lineAt(data, recordStart));
+      }
+    }
+    pos = recordStart;
+  }
+}
+
+// finds the non-comment, non-blank lines which start in [begin, end).
+// begin must be the start of a line.
+void scanSmilesChunk(std::string_view data, std::size_t begin,
+                     std::size_t end, const SmilesMolSupplierParams &params,
+                     bool includeNames, ChunkResult &res) {
+  boost::char_separator<char> sep(params.delimiter.c_str(), "",
+                                  boost::keep_empty_tokens);
+  auto pos = begin;
+  while (pos < end) {
+    auto line = lineAt(data, pos);
+    if (!line.empty() && line[0] != '#' && !isBlank(line)) {
+      res.offsets.push_back(pos);
+      res.lineNums.push_back(res.numLines);
+      if (includeNames && params.nameColumn >= 0) {
+        std::string lineText(line);
+        boost::tokenizer<boost::char_separator<char>> tokens(lineText, sep);
+        int col = 0;
+        std::string name;
+        for (const auto &token : tokens) {
+          if (col++ == params.nameColumn) {
+            name = strip(token);
+            break;
+          }
+        }
+        res.names.push_back(std::move(name));
+      }
+    }
+    ++res.numLines;
+    auto nl = data.find('\n', pos);
+    if (nl == std::string_view::npos) {
+      break;
+    }
+    pos = nl + 1;
+  }
+}
+
+// splits data into one chunk per thread and calls scanChunk on each of them.
+// If alignToLines is set the chunks start at the beginning of a line.
+template <typename T>
+std::vector<ChunkResult> scanInParallel(std::string_view data, int numThreads,
+                                        bool alignToLines, T scanChunk) {
+  auto nChunks = getNumThreadsToUse(numThreads);
+  // there's no point in splitting small files
+  constexpr std::size_t minChunkSize = 1 << 20;
+  nChunks = std::max<std::size_t>(
+      1, std::min<std::size_t>(nChunks, data.size() / minChunkSize));
+  std::vector<std::size_t> bounds(nChunks + 1, data.size());
+  bounds[0] = 0;
+  for (unsigned int i = 1; i < nChunks; ++i) {
+    auto bound = std::max(bounds[i - 1], data.size() / nChunks * i);
+    if (alignToLines && bound && data[bound - 1] != '\n') {
+      bound = data.find('\n', bound);
+      bound = bound == std::string_view::npos ? data.size() : bound + 1;
+    }
+    bounds[i] = bound;
+  }
+  std::vector<ChunkResult> res(nChunks);
+#ifdef RDK_BUILD_THREADSAFE_SSS
+  if (nChunks > 1) {
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < nChunks; ++i) {
+      threads.emplace_back(scanChunk, bounds[i], bounds[i + 1],
+                           std::ref(res[i]));
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    return res;
+  }
+#endif
+  for (unsigned int i = 0; i < nChunks; ++i) {
+    scanChunk(bounds[i], bounds[i + 1], res[i]);
+  }
+  return res;
+}
+
+void setSourceInfo(SupplierIndex &index, const std::string &fileName) {
+  std::error_code ec;
+  index.sourceSize = std::filesystem::file_size(fileName, ec);
+  if (ec) {
+    throw BadFileException("Bad input file " + fileName);
+  }
+  index.sourceModTime = std::filesystem::last_write_time(fileName, ec)
+                            .time_since_epoch()
+                            .count();
+}
+
+std::string sdfIndexKey() { return "sdf"; }
+
+template <typename T>
+SupplierIndex loadOrBuildIndex(const std::string &fileName,
+                               const std::string &indexKey,
+                               const SupplierIndexParams &params,
+                               T buildIndex) {
+  auto indexFileName = params.indexFileName.empty()
+                           ? getDefaultIndexFileName(fileName)
+                           : params.indexFileName;
+  if (std::filesystem::exists(indexFileName)) {
+    try {
+      auto index = readSupplierIndex(indexFileName);
+      if (index.indexKey == indexKey &&
+          (!params.includeNames || index.names.size() == index.size()) &&
+          isSupplierIndexCurrent(index, fileName)) {
+        return index;
+      }
+    } catch (const ValueErrorException &e) {
+      BOOST_LOG(rdWarningLog) << "ignoring index file " << indexFileName
+                              << ": " << e.what() << std::endl;
+    }
+  }
+  auto index = buildIndex();
+  if (params.writeIndexFile) {
+    try {
+      writeSupplierIndex(index, indexFileName);
+    } catch (const BadFileException &e) {
+      BOOST_LOG(rdWarningLog) << e.what() << std::endl;
+    }
+  }
+  return index;
+}
+}  // namespace
+
+std::optional<unsigned int> SupplierIndex::findName(
+    const std::string &name) const {
+  PRECONDITION(names.size() == offsets.size(), "names were not indexed");
+  auto loc = std::find(names.begin(), names.end(), name);
+  if (loc == names.end()) {
+    return std::nullopt;
+  }
+  return static_cast<unsigned int>(loc - names.begin());
+}
+
+std::string getDefaultIndexFileName(const std::string &fileName) {
+  return fileName + ".rdidx";
+}
+
+std::string getSmilesIndexKey(const SmilesMolSupplierParams &params) {
+  std::ostringstream key;
+  key << "smiles titleLine=" << params.titleLine
+      << " nameColumn=" << params.nameColumn
+      << " delimiter=" << params.delimiter;
+  return key.str();
+}
+
+SupplierIndex buildSDFIndex(const std::string &fileName, bool includeNames,
+                            int numThreads) {
+  SupplierIndex res;
+  res.fileType = SupplierIndex::FileType::SDF;
+  res.indexKey = sdfIndexKey();
+  setSourceInfo(res, fileName);
+  MemoryMappedFileReader map(fileName);
+  std::string_view data(map.d_mappedMemory, map.d_size);
+
+  if (sdfRecordStartsAt(data, 0)) {
+    res.offsets.push_back(0);
+    if (includeNames) {
+      res.names.emplace_back(lineAt(data, 0));
+    }
+  }
+  auto chunks = scanInParallel(
+      data, numThreads, false,
+      [data, includeNames](std::size_t begin, std::size_t end,
+                           ChunkResult &chunk) {
+        scanSDFChunk(data, begin, end, includeNames, chunk);
+      });
+  for (auto &chunk : chunks) {
+    res.offsets.insert(res.offsets.end(), chunk.offsets.begin(),
+                       chunk.offsets.end());
+    std::move(chunk.names.begin(), chunk.names.end(),
+              std::back_inserter(res.names));
+  }
+  return res;
+}
+
+SupplierIndex buildSmilesIndex(const std::string &fileName,
+                               const SmilesMolSupplierParams &params,
+                               bool includeNames, int numThreads) {
+  SupplierIndex res;
+  res.fileType = SupplierIndex::FileType::SMILES;
+  res.indexKey = getSmilesIndexKey(params);
+  setSourceInfo(res, fileName);
+  MemoryMappedFileReader map(fileName);
+  std::string_view data(map.d_mappedMemory, map.d_size);
+
+  auto chunks = scanInParallel(
+      data, numThreads, true,
+      [data, &params, includeNames](std::size_t begin, std::size_t end,
+                                    ChunkResult &chunk) {
+        scanSmilesChunk(data, begin, end, params, includeNames, chunk);
+      });
+  std::uint64_t lineOffset = 0;
+  for (auto &chunk : chunks) {
+    res.offsets.insert(res.offsets.end(), chunk.offsets.begin(),
+                       chunk.offsets.end());
+    for (auto lineNum : chunk.lineNums) {
+      res.lineNums.push_back(lineNum + lineOffset);
+    }
+    std::move(chunk.names.begin(), chunk.names.end(),
+              std::back_inserter(res.names));
+    lineOffset += chunk.numLines;
+  }
+  if (params.titleLine && !res.offsets.empty()) {
+    res.offsets.erase(res.offsets.begin());
+    res.lineNums.erase(res.lineNums.begin());
+    if (!res.names.empty()) {
+      res.names.erase(res.names.begin());
+    }
+  }
+  if (includeNames && params.nameColumn < 0) {
+    // without a name column the supplier names molecules by line number
+    for (auto lineNum : res.lineNums) {
+      res.names.push_back(std::to_string(lineNum));
+    }
+  }
+  return res;
+}
+
+void writeSupplierIndex(const SupplierIndex &index,
+                        const std::string &indexFileName) {
+  PRECONDITION(index.names.empty() || index.names.size() == index.size(),
+               "bad names");
+  // write to a temporary file and move it into place so that readers never
+  // see a partially written index. The name of the temporary file is unique
+  // so that processes writing the same index do not clobber each other's
+  // files.
+  std::ostringstream tmpStream;
+  tmpStream << indexFileName << "." << std::this_thread::get_id() << "."
+            << std::random_device()() << ".tmp";
+  auto tmpName = tmpStream.str();
+  {
+    std::ofstream outs(tmpName, std::ios_base::binary);
+    if (!outs) {
+      throw BadFileException("Bad output file " + tmpName);
+    }
+    outs.write(indexMagic, sizeof(indexMagic) - 1);
+    streamWrite(outs, indexVersion);
+    streamWrite(outs, static_cast<std::uint8_t>(index.fileType));
+    streamWrite(outs, index.sourceSize);
+    streamWrite(outs, index.sourceModTime);
+    streamWrite(outs, index.indexKey);
+    streamWriteVec(outs, index.offsets);
+    streamWriteVec(outs, index.lineNums);
+    streamWriteVec(outs, index.names);
+    if (!outs) {
+      throw BadFileException("Could not write index file " + tmpName);
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmpName, indexFileName, ec);
+  if (ec) {
+    std::filesystem::remove(tmpName, ec);
+    throw BadFileException("Could not write index file " + indexFileName);
+  }
+}
+
+SupplierIndex readSupplierIndex(const std::string &indexFileName) {
+  std::ifstream ins(indexFileName, std::ios_base::binary);
+  if (!ins) {
+    throw BadFileException("Bad input file " + indexFileName);
+  }
+  std::error_code ec;
+  const auto fileSize = std::filesystem::file_size(indexFileName, ec);
+  // guards against allocating huge vectors for corrupt files
+  auto checkSize = [&ins, fileSize](std::uint64_t count,
+                                    std::uint64_t itemSize) {
+    const auto pos = static_cast<std::uint64_t>(ins.tellg());
+    if (count > (fileSize - pos) / itemSize) {
+      throw ValueErrorException("truncated index file");
+    }
+  };
+
+  SupplierIndex res;
+  try {
+    char magic[sizeof(indexMagic) - 1];
+    ins.read(magic, sizeof(magic));
+    if (!ins || std::memcmp(magic, indexMagic, sizeof(magic))) {
+      throw ValueErrorException("not an index file");
+    }
+    std::uint32_t version;
+    streamRead(ins, version);
+    if (version != indexVersion) {
+      throw ValueErrorException("unsupported index file version");
+    }
+    std::uint8_t fileType;
+    streamRead(ins, fileType);
+    if (fileType != static_cast<std::uint8_t>(SupplierIndex::FileType::SDF) &&
+        fileType !=
+            static_cast<std::uint8_t>(SupplierIndex::FileType::SMILES)) {
+      throw ValueErrorException("bad file type in index file");
+    }
+    res.fileType = static_cast<SupplierIndex::FileType>(fileType);
+    streamRead(ins, res.sourceSize);
+    streamRead(ins, res.sourceModTime);
+    std::uint32_t keyLength;
+    streamRead(ins, keyLength);
+    checkSize(keyLength, 1);
+    res.indexKey.resize(keyLength);
+    ins.read(res.indexKey.data(), keyLength);
+
+    std::uint64_t count;
+    for (auto vec : {&res.offsets, &res.lineNums}) {
+      streamRead(ins, count);
+      checkSize(count, sizeof(std::uint64_t));
+      vec->resize(count);
+      for (auto &val : *vec) {
+        streamRead(ins, val);
+      }
+    }
+    streamRead(ins, count);
+    checkSize(count, sizeof(std::uint32_t));
+    res.names.resize(count);
+    for (auto &name : res.names) {
+      std::uint32_t length;
+      streamRead(ins, length);
+      checkSize(length, 1);
+      name.resize(length);
+      ins.read(name.data(), length);
+    }
+    if (!ins) {
+      throw ValueErrorException("truncated index file");
+    }
+  } catch (const ValueErrorException &) {
+    throw;
+  } catch (const std::runtime_error &) {
+    // thrown by streamRead
+    throw ValueErrorException("truncated index file");
+  }
+  if ((!res.lineNums.empty() && res.lineNums.size() != res.size()) ||
+      (!res.names.empty() && res.names.size() != res.size())) {
+    throw ValueErrorException("inconsistent index file");
+  }
+  return res;
+}
+
+bool isSupplierIndexCurrent(const SupplierIndex &index,
+                            const std::string &fileName) {
+  SupplierIndex current;
+  try {
+    setSourceInfo(current, fileName);
+  } catch (const BadFileException &) {
+    return false;
+  }
+  return current.sourceSize == index.sourceSize &&
+         current.sourceModTime == index.sourceModTime;
+}
+
+SupplierIndex getSDFIndex(const std::string &fileName,
+                          const SupplierIndexParams &params) {
+  return loadOrBuildIndex(fileName, sdfIndexKey(), params, [&]() {
+    return buildSDFIndex(fileName, params.includeNames, params.numThreads);
+  });
+}
+
+SupplierIndex getSmilesIndex(const std::string &fileName,
+                             const SmilesMolSupplierParams &smilesParams,
+                             const SupplierIndexParams &params) {
+  return loadOrBuildIndex(
+      fileName, getSmilesIndexKey(smilesParams), params, [&]() {
+        return buildSmilesIndex(fileName, smilesParams, params.includeNames,
+                                params.numThreads);
+      });
+}
+
+}  // namespace FileParsers
+}  // namespace v2
+}  // namespace RDKit
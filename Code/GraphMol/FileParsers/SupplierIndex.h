@@ -0,0 +1,139 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+/*! \file SupplierIndex.h
+
+  \brief Persistent record indices for the random access suppliers
+
+  The random access suppliers (SDMolSupplier and SmilesMolSupplier) find the
+  positions of the records in their input by scanning it the first time
+  length() is called or a record beyond the ones already seen is requested.
+  For very large files this scan dominates the time to the first random
+  access and is repeated by every process which opens the file.
+
+  The functions here build the index by scanning a memory-mapped copy of the
+  file in parallel and store it in a sidecar file (by default the name of the
+  input file with ".rdidx" appended). The sidecar records the size and
+  modification time of the input file; when these still match, the index is
+  read from the sidecar instead of being rebuilt.
+
+  Typical usage:
+  \code
+    v2::FileParsers::SDMolSupplier suppl("huge.sdf");
+    v2::FileParsers::SupplierIndexParams ps;
+    ps.numThreads = 0;
+    suppl.useIndexFile(ps);
+    auto mol = suppl[1000000];
+  \endcode
+*/
+#include <RDGeneral/export.h>
+#ifndef RD_SUPPLIERINDEX_H
+#define RD_SUPPLIERINDEX_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace RDKit {
+namespace v2 {
+namespace FileParsers {
+struct SmilesMolSupplierParams;
+
+struct RDKIT_FILEPARSERS_EXPORT SupplierIndexParams {
+  std::string indexFileName =
+      "";  //!< the sidecar file. Defaults to the input file name + ".rdidx"
+  bool includeNames = false;   //!< also index the names of the records
+  bool writeIndexFile = true;  //!< save a newly built index to the sidecar
+  int numThreads = 1;  //!< number of threads used to build the index. Zero
+                       //!< or negative values are interpreted as in
+                       //!< getNumThreadsToUse()
+};
+
+//! the positions (and, optionally, the names) of the records in a file
+struct RDKIT_FILEPARSERS_EXPORT SupplierIndex {
+  enum class FileType : std::uint8_t { SDF = 1, SMILES = 2 };
+
+  FileType fileType = FileType::SDF;
+  std::uint64_t sourceSize = 0;  //!< size of the indexed file in bytes
+  std::int64_t sourceModTime =
+      0;  //!< modification time of the indexed file, in file clock ticks
+  std::string indexKey;  //!< the parameters which affect the index
+  std::vector<std::uint64_t> offsets;  //!< byte offset of each record
+  std::vector<std::uint64_t>
+      lineNums;  //!< 0-based line number of each record (SMILES only)
+  std::vector<std::string> names;  //!< record names, if they were indexed
+
+  std::size_t size() const { return offsets.size(); }
+  //! returns the index of the first record with a particular name
+  /*!
+    The names must have been indexed. This does a linear search; callers
+    looking up many names should build their own map.
+  */
+  std::optional<unsigned int> findName(const std::string &name) const;
+};
+
+//! returns the default name of the sidecar index for a file
+RDKIT_FILEPARSERS_EXPORT std::string getDefaultIndexFileName(
+    const std::string &fileName);
+
+//! returns the SupplierIndex::indexKey of the index of a SMILES file read
+//! with a particular set of parameters
+RDKIT_FILEPARSERS_EXPORT std::string getSmilesIndexKey(
+    const SmilesMolSupplierParams &params);
+
+//! builds the index of the records in an SD file
+/*!
+  The names of the records are the contents of their first lines.
+  The index file is neither read nor written.
+*/
+RDKIT_FILEPARSERS_EXPORT SupplierIndex
+buildSDFIndex(const std::string &fileName, bool includeNames = false,
+              int numThreads = 1);
+//! builds the index of the records in a SMILES file
+/*!
+  Comment lines, blank lines, and (if \c params.titleLine is set) the title
+  line are skipped in the same way SmilesMolSupplier does. The names of the
+  records are taken from \c params.nameColumn.
+  The index file is neither read nor written.
+*/
+RDKIT_FILEPARSERS_EXPORT SupplierIndex
+buildSmilesIndex(const std::string &fileName,
+                 const SmilesMolSupplierParams &params,
+                 bool includeNames = false, int numThreads = 1);
+
+//! writes an index to a file
+RDKIT_FILEPARSERS_EXPORT void writeSupplierIndex(
+    const SupplierIndex &index, const std::string &indexFileName);
+//! reads an index from a file
+/*!
+  A ValueErrorException is thrown if the file is not a valid index.
+*/
+RDKIT_FILEPARSERS_EXPORT SupplierIndex
+readSupplierIndex(const std::string &indexFileName);
+//! returns whether or not an index is up to date with the file it indexes
+RDKIT_FILEPARSERS_EXPORT bool isSupplierIndexCurrent(
+    const SupplierIndex &index, const std::string &fileName);
+
+//! returns the index of an SD file, reading it from the sidecar file if that
+//! is up to date and building (and saving) it otherwise
+RDKIT_FILEPARSERS_EXPORT SupplierIndex getSDFIndex(
+    const std::string &fileName,
+    const SupplierIndexParams &params = SupplierIndexParams());
+//! returns the index of a SMILES file, reading it from the sidecar file if
+//! that is up to date and building (and saving) it otherwise
+RDKIT_FILEPARSERS_EXPORT SupplierIndex
+getSmilesIndex(const std::string &fileName,
+               const SmilesMolSupplierParams &smilesParams,
+               const SupplierIndexParams &params = SupplierIndexParams());
+
+}  // namespace FileParsers
+}  // namespace v2
+}  // namespace RDKit
+#endif
@@ -8,14 +8,23 @@
 //  of the RDKit source tree.
 //
 #include "RDGeneral/test.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <set>
 #include <string>
+#include <thread>
+#include <utility>
 #include <catch2/catch_all.hpp>
 #include <RDGeneral/Invariant.h>
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/MolOps.h>
+#include <GraphMol/MolArena.h>
 #include <GraphMol/FileParsers/MultithreadedMolSupplier.h>
 #include <GraphMol/FileParsers/MultithreadedSDMolSupplier.h>
 #include <GraphMol/FileParsers/MultithreadedSmilesMolSupplier.h>
+#include <GraphMol/SmilesParse/SmilesWrite.h>
 
 using namespace RDKit;
 
@@ -199,3 +208,227 @@ TEST_CASE("callbacks smiles") {
     }
   }
 }
+
+TEST_CASE("allocating molecules from the arena") {
+  std::string rdbase = getenv("RDBASE");
+  std::string smiPath = rdbase + "/Data/NCI/first_200.tpsa.csv";
+  v2::FileParsers::MultithreadedMolSupplier::Parameters params;
+  params.numWriterThreads = 4;
+  v2::FileParsers::SmilesMolSupplierParams smiParams;
+  smiParams.delimiter = ",";
+  smiParams.titleLine = true;
+  std::vector<std::unique_ptr<RWMol>> refMols;
+  {
+    auto suppl = v2::FileParsers::MultithreadedSmilesMolSupplier(
+        smiPath, params, smiParams);
+    while (!suppl.atEnd()) {
+      auto mol = suppl.next();
+      if (mol) {
+        CHECK(!MolArena::isArenaAllocated(mol.get()));
+        refMols.push_back(std::move(mol));
+      }
+    }
+  }
+  params.useArena = true;
+  std::vector<std::unique_ptr<RWMol>> mols;
+  {
+    auto suppl = v2::FileParsers::MultithreadedSmilesMolSupplier(
+        smiPath, params, smiParams);
+    while (!suppl.atEnd()) {
+      auto mol = suppl.next();
+      if (mol) {
+        CHECK(MolArena::isArenaAllocated(mol.get()));
+        CHECK(MolArena::isArenaAllocated(mol->getAtomWithIdx(0)));
+        mols.push_back(std::move(mol));
+      }
+    }
+  }
+  // the molecules outlive the supplier and its threads
+  REQUIRE(mols.size() == refMols.size());
+  unsigned int totAtoms = 0;
+  unsigned int refTotAtoms = 0;
+  for (unsigned int i = 0; i < mols.size(); ++i) {
+    totAtoms += mols[i]->getNumAtoms();
+    refTotAtoms += refMols[i]->getNumAtoms();
+  }
+  CHECK(totAtoms == refTotAtoms);
+}
+
+TEST_CASE("chunked reading and preserving order") {
+  std::string rdbase = getenv("RDBASE");
+  SECTION("SDF") {
+    std::string sdpath = rdbase + "/Data/NCI/first_200.props.sdf";
+    std::vector<std::string> refSmiles;
+    std::vector<std::string> refNames;
+    {
+      v2::FileParsers::SDMolSupplier suppl(sdpath);
+      while (!suppl.atEnd()) {
+        auto mol = suppl.next();
+        refSmiles.push_back(mol ? MolToSmiles(*mol) : "");
+        refNames.push_back(mol ? mol->getProp<std::string>("_Name") : "");
+      }
+    }
+    REQUIRE(refSmiles.size() == 200);
+    // chunks which are smaller than a record, and ones which hold many
+    for (auto chunkSize : {100u, 4096u, 1u << 20}) {
+      INFO(chunkSize);
+      v2::FileParsers::MultithreadedMolSupplier::Parameters params;
+      params.numWriterThreads = 4;
+      params.chunkSize = chunkSize;
+      params.preserveOrder = true;
+      v2::FileParsers::MultithreadedSDMolSupplier suppl(sdpath, params);
+      unsigned int nRecords = 0;
+      while (!suppl.atEnd()) {
+        auto mol = suppl.next();
+        if (suppl.getLastRecordId() == nRecords) {
+          // nothing left to read
+          CHECK(!mol);
+          break;
+        }
+        REQUIRE(nRecords < refSmiles.size());
+        CHECK(suppl.getLastRecordId() == nRecords + 1);
+        CHECK(suppl.getLastItemText().find("$$$$") != std::string::npos);
+        if (mol) {
+          CHECK(MolToSmiles(*mol) == refSmiles[nRecords]);
+          CHECK(mol->getProp<std::string>("_Name") == refNames[nRecords]);
+        }
+        ++nRecords;
+      }
+      CHECK(nRecords == refSmiles.size());
+      auto stats = suppl.getQueueStats();
+      CHECK(stats.inputQueueCapacity == params.sizeInputQueue);
+      CHECK(stats.outputQueueCapacity == params.sizeOutputQueue);
+      CHECK(stats.maxOutputQueueSize > 0);
+      CHECK(stats.maxOutputQueueSize <= stats.outputQueueCapacity);
+      CHECK(stats.reorderBufferSize == 0);
+    }
+  }
+  SECTION("SMILES") {
+    std::string smiPath = rdbase + "/Data/NCI/first_5K.smi";
+    std::vector<std::string> refSmiles;
+    {
+      v2::FileParsers::SmilesMolSupplierParams smiParams;
+      smiParams.titleLine = false;
+      v2::FileParsers::SmilesMolSupplier suppl(smiPath, smiParams);
+      while (!suppl.atEnd()) {
+        auto mol = suppl.next();
+        refSmiles.push_back(mol ? MolToSmiles(*mol) : "");
+      }
+    }
+    for (auto titleLine : {false, true}) {
+      INFO(titleLine);
+      v2::FileParsers::MultithreadedMolSupplier::Parameters params;
+      params.numWriterThreads = 4;
+      params.chunkSize = 16384;
+      params.preserveOrder = true;
+      v2::FileParsers::SmilesMolSupplierParams smiParams;
+      smiParams.titleLine = titleLine;
+      v2::FileParsers::MultithreadedSmilesMolSupplier suppl(smiPath, params,
+                                                            smiParams);
+      unsigned int offset = titleLine ? 1 : 0;
+      unsigned int nRecords = 0;
+      while (!suppl.atEnd()) {
+        auto mol = suppl.next();
+        if (suppl.getLastRecordId() == nRecords) {
+          CHECK(!mol);
+          break;
+        }
+        CHECK(suppl.getLastRecordId() == nRecords + 1);
+        REQUIRE(nRecords + offset < refSmiles.size());
+        CHECK((mol ? MolToSmiles(*mol) : "") == refSmiles[nRecords + offset]);
+        ++nRecords;
+      }
+      CHECK(nRecords + offset == refSmiles.size());
+    }
+  }
+  SECTION("bounded reorder buffer") {
+    std::string smiPath = rdbase + "/Data/NCI/first_5K.smi";
+    size_t minLineLength = std::numeric_limits<size_t>::max();
+    size_t maxLineLength = 0;
+    {
+      std::ifstream ins(smiPath);
+      std::string line;
+      while (std::getline(ins, line)) {
+        minLineLength = std::min(minLineLength, line.size() + 1);
+        maxLineLength = std::max(maxLineLength, line.size() + 1);
+      }
+    }
+    // with chunks the window counts chunks, which hold many more records
+    // than the window does
+    for (auto [chunkSize, window] :
+         {std::pair<size_t, size_t>{0, 4}, {16384, 2}}) {
+      INFO(chunkSize);
+      v2::FileParsers::MultithreadedMolSupplier::Parameters params;
+      params.numWriterThreads = 4;
+      params.chunkSize = chunkSize;
+      params.preserveOrder = true;
+      v2::FileParsers::SmilesMolSupplierParams smiParams;
+      smiParams.titleLine = false;
+      using QueueStats =
+          v2::FileParsers::MultithreadedMolSupplier::QueueStats;
+      auto readAll = [&](size_t reorderWindow,
+                         QueueStats *stats) -> std::vector<std::string> {
+        params.reorderWindow = reorderWindow;
+        v2::FileParsers::MultithreadedSmilesMolSupplier suppl(
+            smiPath, params, smiParams);
+        // hold up some of the records so that the others get ahead of them
+        suppl.setWriteCallback([](RWMol &, const std::string &,
+                                  unsigned int recordId) {
+          if (recordId % 100 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+          }
+        });
+        std::vector<std::string> res;
+        while (!suppl.atEnd()) {
+          auto mol = suppl.next();
+          if (suppl.getLastRecordId() == res.size()) {
+            break;
+          }
+          REQUIRE(suppl.getLastRecordId() == res.size() + 1);
+          res.push_back(mol ? MolToSmiles(*mol) : "");
+        }
+        if (stats) {
+          *stats = suppl.getQueueStats();
+        }
+        return res;
+      };
+      QueueStats stats;
+      auto bounded = readAll(window, &stats);
+      CHECK(bounded.size() >= 4999);
+      CHECK(bounded == readAll(std::numeric_limits<size_t>::max(), nullptr));
+      CHECK(bounded == readAll(0, nullptr));
+      if (!chunkSize) {
+        CHECK(stats.maxReorderBufferSize < window);
+      } else {
+        // a chunk is cut at the first record boundary after chunkSize bytes
+        const auto maxRecordsPerChunk =
+            (chunkSize + maxLineLength) / minLineLength;
+        REQUIRE(chunkSize / maxLineLength > window);
+        CHECK(stats.maxReorderBufferSize <= window * maxRecordsPerChunk);
+      }
+      CHECK(stats.reorderBufferSize == 0);
+    }
+  }
+  SECTION("unordered chunks") {
+    std::string smiPath = rdbase + "/Data/NCI/first_5K.smi";
+    v2::FileParsers::MultithreadedMolSupplier::Parameters params;
+    params.numWriterThreads = 4;
+    params.chunkSize = 4096;
+    v2::FileParsers::SmilesMolSupplierParams smiParams;
+    smiParams.titleLine = false;
+    v2::FileParsers::MultithreadedSmilesMolSupplier suppl(smiPath, params,
+                                                          smiParams);
+    std::set<unsigned int> ids;
+    while (!suppl.atEnd()) {
+      auto mol = suppl.next();
+      if (!ids.insert(suppl.getLastRecordId()).second) {
+        // nothing left to read
+        CHECK(!mol);
+        break;
+      }
+    }
+    CHECK(ids.size() == 4999);
+    CHECK(*ids.begin() == 1);
+    CHECK(*ids.rbegin() == 4999);
+  }
+}
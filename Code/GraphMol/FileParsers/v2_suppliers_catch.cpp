@@ -8,6 +8,7 @@
 //
 
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -17,6 +18,7 @@
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/FileParsers/FileParsers.h>
 #include <GraphMol/FileParsers/MolSupplier.h>
+#include <GraphMol/SmilesParse/SmilesWrite.h>
 #include <RDGeneral/FileParseException.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
@@ -183,3 +185,210 @@ TEST_CASE("TestParsingInvalidChiralityLabelsWithMaeMolSupplier") {
 }
 
 #endif
+
+namespace {
+std::string makeTestFile(const std::string &name, const std::string &source,
+                         unsigned int nCopies, const std::string &header = "") {
+  auto path = (std::filesystem::temp_directory_path() / name).string();
+  std::ifstream ins(source, std::ios_base::binary);
+  std::stringstream buf;
+  buf << ins.rdbuf();
+  std::ofstream outs(path, std::ios_base::binary);
+  outs << header;
+  for (unsigned int i = 0; i < nCopies; ++i) {
+    outs << buf.str();
+  }
+  std::filesystem::remove(FileParsers::getDefaultIndexFileName(path));
+  return path;
+}
+}  // namespace
+
+TEST_CASE("supplier index files") {
+  std::string rdbase = getenv("RDBASE");
+  SECTION("SDF") {
+    // big enough that the index is built in more than one piece
+    auto fName = makeTestFile("rdkit_sdindex_test.sdf",
+                              rdbase + "/Data/NCI/first_200.props.sdf", 6);
+    auto idxName = FileParsers::getDefaultIndexFileName(fName);
+    auto serial = FileParsers::buildSDFIndex(fName, true, 1);
+    CHECK(serial.size() == 1200);
+    auto parallel = FileParsers::buildSDFIndex(fName, true, 4);
+    CHECK(parallel.offsets == serial.offsets);
+    CHECK(parallel.names == serial.names);
+
+    FileParsers::SDMolSupplier ref(fName);
+    REQUIRE(ref.length() == serial.size());
+    for (auto idx : {0u, 1u, 199u, 200u, 1199u}) {
+      auto mol = ref[idx];
+      REQUIRE(mol);
+      CHECK(mol->getProp<std::string>(common_properties::_Name) ==
+            serial.names[idx]);
+    }
+    CHECK(serial.findName(serial.names[0]) == 0u);
+    CHECK(!serial.findName("not there"));
+
+    FileParsers::SupplierIndexParams ps;
+    ps.numThreads = 4;
+    FileParsers::SDMolSupplier suppl(fName);
+    suppl.useIndexFile(ps);
+    CHECK(std::filesystem::exists(idxName));
+    // the temporary file was moved into place
+    for (const auto &entry : std::filesystem::directory_iterator(
+             std::filesystem::path(idxName).parent_path())) {
+      auto entryName = entry.path().filename().string();
+      CHECK((entryName.rfind("rdkit_sdindex_test.sdf.rdidx.", 0) != 0 ||
+             entryName.find(".tmp") == std::string::npos));
+    }
+    CHECK(suppl.length() == 1200);
+    auto mol = suppl[1199];
+    REQUIRE(mol);
+    CHECK(mol->getProp<std::string>(common_properties::_Name) ==
+          serial.names[1199]);
+    CHECK(suppl.atEnd());
+    CHECK_THROWS_AS(suppl[1200], FileParseException);
+    suppl.reset();
+    unsigned int nRead = 0;
+    while (!suppl.atEnd()) {
+      suppl.next();
+      ++nRead;
+    }
+    CHECK(nRead == 1200);
+
+    // the saved index is reused
+    auto saved = FileParsers::readSupplierIndex(idxName);
+    CHECK(saved.offsets == serial.offsets);
+    CHECK(saved.names.empty());
+    CHECK(FileParsers::isSupplierIndexCurrent(saved, fName));
+    auto loaded = FileParsers::getSDFIndex(fName);
+    CHECK(loaded.offsets == serial.offsets);
+    // asking for names requires a rebuild
+    ps.includeNames = true;
+    loaded = FileParsers::getSDFIndex(fName, ps);
+    CHECK(loaded.names == serial.names);
+    CHECK(FileParsers::readSupplierIndex(idxName).names == serial.names);
+
+    // changing the file invalidates the index
+    {
+      std::ofstream outs(fName, std::ios_base::app | std::ios_base::binary);
+      outs << serial.names[0] << "\n  empty\n\n  0  0  0  0  0  0  0  0  0  0"
+           << "999 V2000\nM  END\n$$$$\n";
+    }
+    CHECK(!FileParsers::isSupplierIndexCurrent(saved, fName));
+    FileParsers::SDMolSupplier suppl2(fName);
+    suppl2.useIndexFile();
+    CHECK(suppl2.length() == 1201);
+    CHECK(FileParsers::readSupplierIndex(idxName).size() == 1201);
+
+    // corrupt index files are rebuilt
+    {
+      std::ofstream outs(idxName, std::ios_base::binary);
+      outs << "garbage";
+    }
+    CHECK_THROWS_AS(FileParsers::readSupplierIndex(idxName),
+                    ValueErrorException);
+    FileParsers::SDMolSupplier suppl3(fName);
+    suppl3.useIndexFile();
+    CHECK(suppl3.length() == 1201);
+    CHECK(FileParsers::readSupplierIndex(idxName).size() == 1201);
+
+    // v1 API
+    SDMolSupplier suppl4(fName);
+    suppl4.useIndexFile();
+    std::unique_ptr<ROMol> mol4(suppl4[1200]);
+    REQUIRE(mol4);
+    CHECK(mol4->getNumAtoms() == 0);
+
+    std::filesystem::remove(fName);
+    std::filesystem::remove(idxName);
+  }
+  SECTION("SMILES") {
+    auto fName = makeTestFile("rdkit_smiindex_test.smi",
+                              rdbase + "/Data/NCI/first_5K.smi", 11,
+                              "# a comment\nSMILES Name\n\n");
+    auto idxName = FileParsers::getDefaultIndexFileName(fName);
+    FileParsers::SmilesMolSupplierParams params;
+    auto serial = FileParsers::buildSmilesIndex(fName, params, true, 1);
+    CHECK(serial.size() == 11 * 4999);
+    CHECK(serial.lineNums[0] == 3);
+    auto parallel = FileParsers::buildSmilesIndex(fName, params, true, 4);
+    CHECK(parallel.offsets == serial.offsets);
+    CHECK(parallel.lineNums == serial.lineNums);
+    CHECK(parallel.names == serial.names);
+
+    FileParsers::SmilesMolSupplier ref(fName, params);
+    REQUIRE(ref.length() == serial.size());
+
+    FileParsers::SupplierIndexParams ps;
+    ps.numThreads = 4;
+    FileParsers::SmilesMolSupplier suppl(fName, params);
+    suppl.useIndexFile(ps);
+    CHECK(std::filesystem::exists(idxName));
+    CHECK(suppl.length() == serial.size());
+    for (auto idx : {0u, 1u, 4998u, 4999u, 11u * 4999 - 1}) {
+      auto mol = suppl[idx];
+      auto refMol = ref[idx];
+      REQUIRE(mol);
+      REQUIRE(refMol);
+      CHECK(mol->getProp<std::string>(common_properties::_Name) ==
+            serial.names[idx]);
+      CHECK(MolToSmiles(*mol) == MolToSmiles(*refMol));
+      CHECK(suppl.getItemText(idx) == ref.getItemText(idx));
+    }
+    CHECK(suppl.atEnd());
+
+    // the index depends on the supplier parameters
+    params.nameColumn = -1;
+    FileParsers::SmilesMolSupplier suppl2(fName, params);
+    ps.includeNames = true;
+    suppl2.useIndexFile(ps);
+    auto saved = FileParsers::readSupplierIndex(idxName);
+    CHECK(saved.names[0] == "3");
+    auto mol = suppl2[0];
+    REQUIRE(mol);
+    CHECK(mol->getProp<std::string>(common_properties::_Name) == "3");
+    // and indices built with other parameters are rejected
+    CHECK_THROWS_AS(suppl2.setIndex(serial), ValueErrorException);
+    CHECK(FileParsers::getSmilesIndexKey(params) == saved.indexKey);
+
+    // streams can't use index files
+    std::ifstream ins(fName);
+    FileParsers::SmilesMolSupplier suppl3(&ins, false);
+    CHECK_THROWS_AS(suppl3.useIndexFile(), ValueErrorException);
+
+    std::filesystem::remove(fName);
+    std::filesystem::remove(idxName);
+  }
+  SECTION("empty files") {
+    auto fName = makeTestFile("rdkit_emptyindex_test.sdf",
+                              rdbase + "/Code/GraphMol/FileParsers/test_data/"
+                                       "empty.sdf",
+                              1);
+    auto index = FileParsers::buildSDFIndex(fName);
+    CHECK(index.size() == 0);
+    std::filesystem::remove(fName);
+  }
+  SECTION("non-ASCII data") {
+    auto fName = makeTestFile("rdkit_latin1index_test.sdf",
+                              rdbase + "/Code/GraphMol/FileParsers/test_data/"
+                                       "empty.sdf",
+                              1);
+    {
+      // Latin-1 record names, bytes >= 0x80 must not be taken as whitespace
+      std::ofstream outs(fName, std::ios_base::binary);
+      const std::string molBlock = R"CTAB(
+     RDKit          2D
+
+  1  0  0  0  0  0  0  0  0  0999 V2000
+    0.0000    0.0000    0.0000 C   0  0  0  0  0  0  0  0  0  0  0  0
+M  END
+$$$$
+)CTAB";
+      outs << "caf\xe9" << molBlock << "\xa0na\xefve" << molBlock;
+    }
+    auto index = FileParsers::buildSDFIndex(fName, true);
+    REQUIRE(index.size() == 2);
+    CHECK(index.names[0] == "caf\xe9");
+    CHECK(index.names[1] == "\xa0na\xefve");
+    std::filesystem::remove(fName);
+  }
+}
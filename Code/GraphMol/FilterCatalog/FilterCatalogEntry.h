@@ -86,6 +86,12 @@ class RDKIT_FILTERCATALOG_EXPORT FilterCatalogEntry
 
   bool isValid() const { return d_matcher.get() && d_matcher->isValid(); }
 
+  //------------------------------------
+  //! Returns the FilterMatcher used by this catalog entry
+  boost::shared_ptr<const FilterMatcherBase> getFilterMatcher() const {
+    return d_matcher;
+  }
+
   //------------------------------------
   //! Returns the description of the catalog entry
   std::string getDescription() const override;
@@ -0,0 +1,283 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+
+#include "FilterCatalogMatcher.h"
+#include "FilterMatchers.h"
+
+#include <GraphMol/QueryAtom.h>
+#include <GraphMol/QueryBond.h>
+#include <GraphMol/SmilesParse/SmartsWrite.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+namespace RDKit {
+namespace {
+// recursive queries can only be evaluated during a substructure search
+bool hasRecursiveQuery(const Atom::QUERYATOM_QUERY *query) {
+  if (dynamic_cast<const RecursiveStructureQuery *>(query)) {
+    return true;
+  }
+  for (auto it = query->beginChildren(); it != query->endChildren(); ++it) {
+    if (hasRecursiveQuery(it->get())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename T>
+unsigned int lookupQuery(const std::string &key, const T *item,
+                         std::map<std::string, unsigned int> &keys,
+                         std::vector<std::unique_ptr<T>> &queries) {
+  auto it = keys.find(key);
+  if (it != keys.end()) {
+    return it->second;
+  }
+  auto query = static_cast<T *>(item->copy());
+  query->compileQuery();
+  queries.emplace_back(query);
+  auto idx = static_cast<unsigned int>(queries.size() - 1);
+  keys[key] = idx;
+  return idx;
+}
+}  // namespace
+
+// per-molecule results of the prefilter queries and of the pattern groups
+class FilterCatalogMatcher::MoleculeState {
+ public:
+  MoleculeState(const FilterCatalogMatcher &matcher, const ROMol &mol)
+      : d_matcher(matcher),
+        d_mol(mol),
+        d_atomCounts(matcher.d_atomQueries.size(), -1),
+        d_bondCounts(matcher.d_bondQueries.size(), -1),
+        d_groupResults(matcher.d_numGroups, -1) {}
+
+  bool passes(const Prefilter &prefilter) {
+    for (const auto &req : prefilter.atoms) {
+      if (atomCount(req.query) < req.count) {
+        return false;
+      }
+    }
+    for (const auto &req : prefilter.bonds) {
+      if (bondCount(req.query) < req.count) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // -1 if the group hasn't been run yet
+  int &groupResult(unsigned int group) { return d_groupResults[group]; }
+
+ private:
+  const FilterCatalogMatcher &d_matcher;
+  const ROMol &d_mol;
+  std::vector<int> d_atomCounts;
+  std::vector<int> d_bondCounts;
+  std::vector<int> d_groupResults;
+
+  unsigned int atomCount(unsigned int idx) {
+    if (d_atomCounts[idx] < 0) {
+      const auto &query = d_matcher.d_atomQueries[idx];
+      int count = 0;
+      for (const auto atom : d_mol.atoms()) {
+        count += query->Match(atom);
+      }
+      d_atomCounts[idx] = count;
+    }
+    return d_atomCounts[idx];
+  }
+  unsigned int bondCount(unsigned int idx) {
+    if (d_bondCounts[idx] < 0) {
+      const auto &query = d_matcher.d_bondQueries[idx];
+      int count = 0;
+      for (const auto bond : d_mol.bonds()) {
+        count += query->Match(bond);
+      }
+      d_bondCounts[idx] = count;
+    }
+    return d_bondCounts[idx];
+  }
+};
+
+FilterCatalogMatcher::FilterCatalogMatcher(const FilterCatalog &catalog,
+                                           bool collectStats)
+    : df_collectStats(collectStats) {
+  std::map<std::string, unsigned int> atomKeys;
+  std::map<std::string, unsigned int> bondKeys;
+  std::map<std::string, unsigned int> patternKeys;
+  const auto numEntries = catalog.getNumEntries();
+  d_entries.reserve(numEntries);
+  d_prefilters.resize(numEntries);
+  d_groups.resize(numEntries, -1);
+  for (unsigned int i = 0; i < numEntries; ++i) {
+    d_entries.push_back(catalog.getEntry(i));
+    const auto &entry = d_entries.back();
+    if (!entry->isValid()) {
+      continue;
+    }
+    auto matcher = entry->getFilterMatcher();
+    auto smartsMatcher = dynamic_cast<const SmartsMatcher *>(matcher.get());
+    if (!smartsMatcher) {
+      continue;
+    }
+    const auto &pattern = *smartsMatcher->getPattern();
+    auto patternKey = MolToSmarts(pattern) + " " +
+                      std::to_string(smartsMatcher->getMinCount()) + " " +
+                      std::to_string(smartsMatcher->getMaxCount());
+    auto groupIt = patternKeys.find(patternKey);
+    if (groupIt == patternKeys.end()) {
+      groupIt = patternKeys.emplace(patternKey, d_numGroups++).first;
+    }
+    d_groups[i] = groupIt->second;
+
+    // a pattern which is allowed to match zero times can't be screened out
+    if (!smartsMatcher->getMinCount()) {
+      continue;
+    }
+    // a substructure match maps each query atom to a different atom of the
+    // molecule, so a query which appears n times in the pattern must match
+    // at least n atoms of the molecule
+    std::map<unsigned int, unsigned int> atomCounts;
+    for (const auto atom : pattern.atoms()) {
+      if (!atom->hasQuery() || hasRecursiveQuery(atom->getQuery())) {
+        continue;
+      }
+      auto key = SmartsWrite::GetAtomSmarts(atom) + "\n" + describeQuery(atom);
+      ++atomCounts[lookupQuery(key, static_cast<const QueryAtom *>(atom),
+                               atomKeys, d_atomQueries)];
+    }
+    std::map<unsigned int, unsigned int> bondCounts;
+    for (const auto bond : pattern.bonds()) {
+      if (!bond->hasQuery()) {
+        continue;
+      }
+      auto key = SmartsWrite::GetBondSmarts(bond) + "\n" + describeQuery(bond);
+      ++bondCounts[lookupQuery(key, static_cast<const QueryBond *>(bond),
+                               bondKeys, d_bondQueries)];
+    }
+    auto &prefilter = d_prefilters[i];
+    for (const auto &[query, count] : atomCounts) {
+      prefilter.atoms.push_back({query, count});
+    }
+    for (const auto &[query, count] : bondCounts) {
+      prefilter.bonds.push_back({query, count});
+    }
+  }
+  d_stats.reset(new AtomicStats[numEntries]);
+}
+
+FilterCatalogMatcher::~FilterCatalogMatcher() = default;
+
+unsigned int FilterCatalogMatcher::getNumScreenedEntries() const {
+  return static_cast<unsigned int>(
+      std::count_if(d_prefilters.begin(), d_prefilters.end(),
+                    [](const auto &prefilter) { return !prefilter.empty(); }));
+}
+
+void FilterCatalogMatcher::run(
+    const ROMol &mol, Mode mode,
+    std::vector<FilterCatalog::CONST_SENTRY> *entries,
+    std::vector<FilterMatch> *matches) const {
+  MoleculeState state(*this, mol);
+  for (unsigned int i = 0; i < d_entries.size(); ++i) {
+    const auto &entry = d_entries[i];
+    auto &stats = d_stats[i];
+    if (!state.passes(d_prefilters[i])) {
+      if (df_collectStats) {
+        ++stats.numSkipped;
+      }
+      continue;
+    }
+    std::chrono::steady_clock::time_point start;
+    if (df_collectStats) {
+      start = std::chrono::steady_clock::now();
+    }
+    bool matched;
+    if (mode == Mode::FilterMatches) {
+      matched = entry->getFilterMatches(mol, *matches);
+    } else if (d_groups[i] >= 0) {
+      auto &res = state.groupResult(d_groups[i]);
+      if (res < 0) {
+        res = entry->hasFilterMatch(mol);
+      }
+      matched = res;
+    } else {
+      matched = entry->hasFilterMatch(mol);
+    }
+    if (df_collectStats) {
+      ++stats.numRun;
+      stats.numHits += matched;
+      stats.nanoseconds +=
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count();
+    }
+    if (matched && entries) {
+      entries->push_back(entry);
+      if (mode == Mode::First) {
+        return;
+      }
+    }
+  }
+}
+
+bool FilterCatalogMatcher::hasMatch(const ROMol &mol) const {
+  return getFirstMatch(mol) != nullptr;
+}
+
+FilterCatalog::CONST_SENTRY FilterCatalogMatcher::getFirstMatch(
+    const ROMol &mol) const {
+  std::vector<FilterCatalog::CONST_SENTRY> res;
+  run(mol, Mode::First, &res, nullptr);
+  if (res.empty()) {
+    return FilterCatalog::CONST_SENTRY();
+  }
+  return res.front();
+}
+
+std::vector<FilterCatalog::CONST_SENTRY> FilterCatalogMatcher::getMatches(
+    const ROMol &mol) const {
+  std::vector<FilterCatalog::CONST_SENTRY> res;
+  run(mol, Mode::All, &res, nullptr);
+  return res;
+}
+
+std::vector<FilterMatch> FilterCatalogMatcher::getFilterMatches(
+    const ROMol &mol) const {
+  std::vector<FilterMatch> res;
+  run(mol, Mode::FilterMatches, nullptr, &res);
+  return res;
+}
+
+std::vector<FilterCatalogMatcher::EntryStats> FilterCatalogMatcher::getStats()
+    const {
+  std::vector<EntryStats> res(d_entries.size());
+  for (unsigned int i = 0; i < d_entries.size(); ++i) {
+    res[i].numRun = d_stats[i].numRun;
+    res[i].numSkipped = d_stats[i].numSkipped;
+    res[i].numHits = d_stats[i].numHits;
+    res[i].seconds = d_stats[i].nanoseconds * 1e-9;
+  }
+  return res;
+}
+
+void FilterCatalogMatcher::resetStats() {
+  for (unsigned int i = 0; i < d_entries.size(); ++i) {
+    d_stats[i].numRun = 0;
+    d_stats[i].numSkipped = 0;
+    d_stats[i].numHits = 0;
+    d_stats[i].nanoseconds = 0;
+  }
+}
+
+}  // namespace RDKit
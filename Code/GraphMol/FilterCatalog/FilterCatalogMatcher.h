@@ -0,0 +1,138 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+
+#include <RDGeneral/export.h>
+#ifndef RD_FILTER_CATALOG_MATCHER_H
+#define RD_FILTER_CATALOG_MATCHER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "FilterCatalog.h"
+
+namespace RDKit {
+class QueryAtom;
+class QueryBond;
+
+//! Runs all of the entries of a FilterCatalog against molecules
+/*!
+  FilterCatalog::getMatches() runs the substructure search for every entry
+  against the molecule. Most molecules only match a handful of the entries
+  in the large catalogs, and most of the searches fail because some atom or
+  bond of the pattern doesn't match anything in the molecule at all.
+
+  The FilterCatalogMatcher indexes the atom and bond queries of the patterns
+  of the SmartsMatcher entries of a catalog, merging identical queries
+  across patterns (the alert catalogs use the same few hundred atom queries
+  over and over). For each molecule the number of its atoms (and bonds)
+  which match each of these queries is determined once, on demand, and
+  entries with a query atom (or bond) which matches fewer atoms of the
+  molecule than the pattern needs are skipped without running the
+  substructure search. Entries which use the same pattern share the result
+  of the search. Entries using other kinds of matchers are always run.
+
+  The results are identical to those of the corresponding FilterCatalog
+  methods. Optionally, the number of times each entry was run, skipped, and
+  matched, and the time spent running it, can be collected.
+
+  The matcher holds on to the entries of the catalog at the time it was
+  constructed; later changes to the catalog are not reflected. The matching
+  methods may be called from multiple threads at the same time.
+*/
+class RDKIT_FILTERCATALOG_EXPORT FilterCatalogMatcher {
+ public:
+  //! statistics for one of the entries of the catalog
+  struct EntryStats {
+    std::uint64_t numRun = 0;  //!< number of molecules the entry was run on
+    std::uint64_t numSkipped =
+        0;  //!< number of molecules the prefilter skipped the entry for
+    std::uint64_t numHits = 0;  //!< number of molecules the entry matched
+    double seconds = 0.0;       //!< time spent running the entry
+  };
+
+  explicit FilterCatalogMatcher(const FilterCatalog &catalog,
+                                bool collectStats = false);
+  ~FilterCatalogMatcher();
+  FilterCatalogMatcher(const FilterCatalogMatcher &) = delete;
+  FilterCatalogMatcher &operator=(const FilterCatalogMatcher &) = delete;
+
+  //! returns the number of entries
+  unsigned int getNumEntries() const {
+    return static_cast<unsigned int>(d_entries.size());
+  }
+  //! returns the number of entries which can be skipped by the prefilter
+  unsigned int getNumScreenedEntries() const;
+  //! returns the number of distinct atom queries used by the prefilter
+  unsigned int getNumAtomQueries() const {
+    return static_cast<unsigned int>(d_atomQueries.size());
+  }
+  //! returns the number of distinct bond queries used by the prefilter
+  unsigned int getNumBondQueries() const {
+    return static_cast<unsigned int>(d_bondQueries.size());
+  }
+
+  //! Returns true if the molecule matches any entry in the catalog
+  bool hasMatch(const ROMol &mol) const;
+  //! Returns the first match against the catalog
+  FilterCatalog::CONST_SENTRY getFirstMatch(const ROMol &mol) const;
+  //! Returns all entry matches to the molecule
+  std::vector<FilterCatalog::CONST_SENTRY> getMatches(const ROMol &mol) const;
+  //! Returns all FilterMatches for the molecule
+  std::vector<FilterMatch> getFilterMatches(const ROMol &mol) const;
+
+  //! sets whether or not statistics are collected
+  void setCollectStats(bool val) { df_collectStats = val; }
+  bool getCollectStats() const { return df_collectStats; }
+  //! returns the statistics for each entry, in the order of the catalog
+  std::vector<EntryStats> getStats() const;
+  //! resets all statistics to zero
+  void resetStats();
+
+ private:
+  // the number of atoms (or bonds) which need to match one of the queries
+  struct Requirement {
+    unsigned int query;
+    unsigned int count;
+  };
+  struct Prefilter {
+    std::vector<Requirement> atoms;
+    std::vector<Requirement> bonds;
+    bool empty() const { return atoms.empty() && bonds.empty(); }
+  };
+  struct AtomicStats {
+    std::atomic<std::uint64_t> numRun{0};
+    std::atomic<std::uint64_t> numSkipped{0};
+    std::atomic<std::uint64_t> numHits{0};
+    std::atomic<std::uint64_t> nanoseconds{0};
+  };
+  class MoleculeState;
+  enum class Mode { First, All, FilterMatches };
+
+  std::vector<FilterCatalog::CONST_SENTRY> d_entries;
+  std::vector<Prefilter> d_prefilters;
+  // entries with the same pattern share a group; -1 if the entry isn't
+  // grouped
+  std::vector<int> d_groups;
+  unsigned int d_numGroups = 0;
+  std::vector<std::unique_ptr<QueryAtom>> d_atomQueries;
+  std::vector<std::unique_ptr<QueryBond>> d_bondQueries;
+  std::unique_ptr<AtomicStats[]> d_stats;
+  bool df_collectStats = false;
+
+  void run(const ROMol &mol, Mode mode,
+           std::vector<FilterCatalog::CONST_SENTRY> *entries,
+           std::vector<FilterMatch> *matches) const;
+};
+
+}  // namespace RDKit
+
+#endif
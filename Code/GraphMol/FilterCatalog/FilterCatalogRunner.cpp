@@ -8,6 +8,7 @@
 //
 
 #include "FilterCatalog.h"
+#include "FilterCatalogMatcher.h"
 #include "Filters.h"
 #include "FilterMatchers.h"
 #include <GraphMol/SmilesParse/SmilesParse.h>
@@ -27,7 +28,7 @@ boost::shared_ptr<FilterCatalogEntry> &makeBadSmilesEntry() {
   return bad_smiles;
 }
 void CatalogSearcher(
-    const FilterCatalog &fc, const std::vector<std::string> &smiles,
+    const FilterCatalogMatcher &fc, const std::vector<std::string> &smiles,
     std::vector<std::vector<FilterCatalog::CONST_SENTRY>> &results, int start,
     int numThreads) {
   for (unsigned int idx = start; idx < smiles.size(); idx += numThreads) {
@@ -47,6 +48,8 @@ RunFilterCatalog(const FilterCatalog &fc,
   // preallocate results so the threads don't move the vector around in memory
   //  There is one result per input smiles
   std::vector<std::vector<FilterCatalog::CONST_SENTRY>> results(smiles.size());
+  // the matcher is shared by all of the threads
+  const FilterCatalogMatcher matcher(fc);
 
 #ifdef RDK_BUILD_THREADSAFE_SSS
   std::vector<std::future<void>> thread_group;
@@ -54,9 +57,10 @@ RunFilterCatalog(const FilterCatalog &fc,
   for (int thread_group_idx = 0; thread_group_idx < numThreads;
        ++thread_group_idx) {
     // need to use std::ref otherwise things are passed by value
-    thread_group.emplace_back(std::async(
-        std::launch::async, CatalogSearcher, std::ref(fc), std::ref(smiles),
-        std::ref(results), thread_group_idx, numThreads));
+    thread_group.emplace_back(
+        std::async(std::launch::async, CatalogSearcher, std::ref(matcher),
+                   std::ref(smiles), std::ref(results), thread_group_idx,
+                   numThreads));
   }
   for (auto &fut : thread_group) {
     fut.get();
@@ -65,7 +69,7 @@ RunFilterCatalog(const FilterCatalog &fc,
 #else
   int start = 0;
   numThreads = 1;
-  CatalogSearcher(fc, smiles, results, start, numThreads);
+  CatalogSearcher(matcher, smiles, results, start, numThreads);
 #endif
   return results;
 }
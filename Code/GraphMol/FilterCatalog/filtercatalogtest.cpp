@@ -33,6 +33,7 @@
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/FileParsers/MolSupplier.h>
 #include <GraphMol/FilterCatalog/FilterCatalog.h>
+#include <GraphMol/FilterCatalog/FilterCatalogMatcher.h>
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #include <fstream>
 #include <map>
@@ -345,6 +346,79 @@ void testFilterCatalogCHEMBL() {
   }
 }
 
+void testFilterCatalogMatcher() {
+  BOOST_LOG(rdErrorLog) << "-------------------------------------" << std::endl;
+  BOOST_LOG(rdErrorLog) << "Testing the FilterCatalogMatcher" << std::endl;
+  FilterCatalogParams params(FilterCatalogParams::ALL);
+  FilterCatalog catalog(params);
+  FilterCatalogMatcher matcher(catalog, true);
+  TEST_ASSERT(matcher.getNumEntries() == catalog.getNumEntries());
+  TEST_ASSERT(matcher.getNumScreenedEntries() > 0);
+  TEST_ASSERT(matcher.getNumAtomQueries() > 0);
+
+  std::string pathName = getenv("RDBASE");
+  pathName += "/Code/GraphMol/FileParsers/test_data/zinc.leads.500.q.smi";
+  SmilesMolSupplier suppl(pathName, "\t", 0, 1, false);
+  unsigned int nMols = 0;
+  unsigned int nHits = 0;
+  while (!suppl.atEnd()) {
+    std::unique_ptr<ROMol> mol(suppl.next());
+    if (!mol) {
+      continue;
+    }
+    ++nMols;
+    auto expected = catalog.getMatches(*mol);
+    auto found = matcher.getMatches(*mol);
+    TEST_ASSERT(found == expected);
+    TEST_ASSERT(matcher.hasMatch(*mol) == catalog.hasMatch(*mol));
+    TEST_ASSERT(matcher.getFirstMatch(*mol) == catalog.getFirstMatch(*mol));
+    auto expectedMatches = catalog.getFilterMatches(*mol);
+    auto foundMatches = matcher.getFilterMatches(*mol);
+    TEST_ASSERT(foundMatches.size() == expectedMatches.size());
+    for (size_t i = 0; i < foundMatches.size(); ++i) {
+      TEST_ASSERT(foundMatches[i].filterMatch->getName() ==
+                  expectedMatches[i].filterMatch->getName());
+      TEST_ASSERT(foundMatches[i].atomPairs == expectedMatches[i].atomPairs);
+    }
+    nHits += !found.empty();
+  }
+  TEST_ASSERT(nMols > 400);
+  TEST_ASSERT(nHits > 0);
+
+  auto stats = matcher.getStats();
+  TEST_ASSERT(stats.size() == catalog.getNumEntries());
+  std::uint64_t nRun = 0, nSkipped = 0;
+  for (const auto &stat : stats) {
+    TEST_ASSERT(stat.numHits <= stat.numRun);
+    nRun += stat.numRun;
+    nSkipped += stat.numSkipped;
+  }
+  TEST_ASSERT(nSkipped > 0);
+  TEST_ASSERT(nRun > 0);
+  BOOST_LOG(rdInfoLog) << "  entries run: " << nRun << " skipped: " << nSkipped
+                       << std::endl;
+  matcher.resetStats();
+  for (const auto &stat : matcher.getStats()) {
+    TEST_ASSERT(!stat.numRun && !stat.numSkipped && !stat.numHits);
+  }
+
+  // patterns which may match zero times are never skipped
+  FilterCatalog countCatalog;
+  countCatalog.addEntry(new FilterCatalogEntry(
+      "no nitro", SmartsMatcher("no nitro", "[N+](=O)[O-]", 0, 0)));
+  countCatalog.addEntry(new FilterCatalogEntry(
+      "two bromines", SmartsMatcher("two bromines", "[Br]", 2)));
+  FilterCatalogMatcher countMatcher(countCatalog);
+  TEST_ASSERT(countMatcher.getNumScreenedEntries() == 1);
+  for (const auto smi :
+       {"CCO", "BrCCBr", "CC[N+](=O)[O-]", "BrCC(Br)[N+](=O)[O-]"}) {
+    std::unique_ptr<ROMol> mol(SmilesToMol(smi));
+    TEST_ASSERT(countMatcher.getMatches(*mol) ==
+                countCatalog.getMatches(*mol));
+  }
+  BOOST_LOG(rdErrorLog) << "  done" << std::endl;
+}
+
 int main() {
   RDLog::InitLogs();
   // boost::logging::enable_logs("rdApp.debug");
@@ -353,5 +427,6 @@ int main() {
   testFilterCatalogEntry();
   testFilterCatalogThreadedRunner();
   testFilterCatalogCHEMBL();
+  testFilterCatalogMatcher();
   return 0;
 }
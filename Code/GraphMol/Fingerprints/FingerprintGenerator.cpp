@@ -321,10 +321,9 @@ std::unique_ptr<FingerprintGenerator<std::uint64_t>> generatorFromJSON(
 }
 
 template <typename OutputType>
-std::unique_ptr<SparseIntVect<OutputType>>
-FingerprintGenerator<OutputType>::getFingerprintHelper(
+void FingerprintGenerator<OutputType>::getBitIds(
     const ROMol &mol, FingerprintFuncArguments &args,
-    const std::uint64_t fpSize) const {
+    const std::uint64_t fpSize, FingerprintScratch<OutputType> &scratch) const {
   const ROMol *lmol = &mol;
   std::unique_ptr<ROMol> tmol;
   if (dp_fingerprintArguments->df_includeChirality &&
@@ -343,32 +342,30 @@ FingerprintGenerator<OutputType>::getFingerprintHelper(
     hashResults = true;
   }
 
-  std::unique_ptr<std::vector<std::uint32_t>> atomInvariants = nullptr;
+  const std::vector<std::uint32_t> *atomInvariants = nullptr;
   if (args.customAtomInvariants) {
-    atomInvariants.reset(
-        new std::vector<std::uint32_t>(*args.customAtomInvariants));
+    atomInvariants = args.customAtomInvariants;
   } else if (dp_atomInvariantsGenerator) {
-    atomInvariants.reset(dp_atomInvariantsGenerator->getAtomInvariants(mol));
+    dp_atomInvariantsGenerator->fillAtomInvariants(mol,
+                                                   scratch.atomInvariants);
+    atomInvariants = &scratch.atomInvariants;
   }
 
-  std::unique_ptr<std::vector<std::uint32_t>> bondInvariants = nullptr;
+  const std::vector<std::uint32_t> *bondInvariants = nullptr;
   if (args.customBondInvariants) {
-    bondInvariants.reset(
-        new std::vector<std::uint32_t>(*args.customBondInvariants));
+    bondInvariants = args.customBondInvariants;
   } else if (dp_bondInvariantsGenerator) {
-    bondInvariants.reset(dp_bondInvariantsGenerator->getBondInvariants(mol));
+    dp_bondInvariantsGenerator->fillBondInvariants(mol,
+                                                   scratch.bondInvariants);
+    bondInvariants = &scratch.bondInvariants;
   }
 
   // create all atom environments that will generate the bit-ids that will
   // make up the fingerprint
-  auto atomEnvironments = dp_atomEnvironmentGenerator->getEnvironments(
-      *lmol, dp_fingerprintArguments, args.fromAtoms, args.ignoreAtoms,
-      args.confId, args.additionalOutput, atomInvariants.get(),
-      bondInvariants.get(), hashResults);
-
-  // allocate the result
-  auto res = std::make_unique<SparseIntVect<OutputType>>(
-      fpSize ? fpSize : dp_atomEnvironmentGenerator->getResultSize());
+  dp_atomEnvironmentGenerator->fillEnvironments(
+      *lmol, dp_fingerprintArguments, scratch, args.fromAtoms,
+      args.ignoreAtoms, args.confId, args.additionalOutput, atomInvariants,
+      bondInvariants, hashResults);
 
   // define a mersenne twister with customized parameters.
   // The standard parameters (used to create boost::mt19937)
@@ -381,59 +378,67 @@ FingerprintGenerator<OutputType>::getFingerprintHelper(
       rng_type;
   typedef boost::uniform_int<> distrib_type;
   typedef boost::variate_generator<rng_type &, distrib_type> source_type;
-  std::unique_ptr<rng_type> generator;
   //
   // if we generate arbitrarily sized ints then mod them down to the
   // appropriate size, we can guarantee that a fingerprint of
   // size x has the same bits set as one of size 2x that's been folded
   // in half.  This is a nice guarantee to have.
   //
-  std::unique_ptr<distrib_type> dist;
-  std::unique_ptr<source_type> randomSource;
-  if (dp_fingerprintArguments->d_numBitsPerFeature > 1) {
-    // we will only create the RNG if we're going to need it
-    generator.reset(new rng_type(42u));
-    dist.reset(new distrib_type(0, INT_MAX));
-    randomSource.reset(new source_type(*generator, *dist));
-  }
+  // the RNG is only used if we need more than one bit per feature, it is
+  // seeded with each feature's bit id
 
   // iterate over every atom environment and generate bit-ids that will make
   // up the fingerprint
-  for (const auto env : atomEnvironments) {
-    OutputType seed = env->getBitId(dp_fingerprintArguments,
-                                    atomInvariants.get(), bondInvariants.get(),
-                                    args.additionalOutput, hashResults, fpSize);
+  scratch.bitIds.clear();
+  for (size_t i = 0; i < scratch.getNumEnvironments(); ++i) {
+    const auto env = scratch.getEnvironment(i);
+    OutputType seed = env->getBitId(dp_fingerprintArguments, atomInvariants,
+                                    bondInvariants, args.additionalOutput,
+                                    hashResults, fpSize);
 
     auto bitId = seed;
     if (fpSize != 0) {
       bitId %= fpSize;
     }
-    res->setVal(bitId, res->getVal(bitId) + 1);
+    scratch.bitIds.push_back(bitId);
     if (args.additionalOutput) {
       env->updateAdditionalOutput(args.additionalOutput, bitId);
     }
     // do the additional bits if required:
     if (dp_fingerprintArguments->d_numBitsPerFeature > 1) {
-      generator->seed(static_cast<rng_type::result_type>(seed));
+      rng_type generator(static_cast<rng_type::result_type>(seed));
+      source_type randomSource(generator, distrib_type(0, INT_MAX));
 
       for (boost::uint32_t bitN = 1;
            bitN < dp_fingerprintArguments->d_numBitsPerFeature; ++bitN) {
-        bitId = (*randomSource)();
+        bitId = randomSource();
         if (fpSize != 0) {
           bitId %= fpSize;
         }
-        res->setVal(bitId, res->getVal(bitId) + 1);
+        scratch.bitIds.push_back(bitId);
         if (args.additionalOutput) {
           env->updateAdditionalOutput(args.additionalOutput, bitId);
         }
       }
     }
-    delete env;
   }
-
-  return res;
 }
+
 namespace {
+// fills scratch.bitCounts from scratch.bitIds, ordered by bit id
+template <typename OutputType>
+void countBitIds(FingerprintScratch<OutputType> &scratch) {
+  std::sort(scratch.bitIds.begin(), scratch.bitIds.end());
+  scratch.bitCounts.clear();
+  for (auto bitId : scratch.bitIds) {
+    if (!scratch.bitCounts.empty() && scratch.bitCounts.back().first == bitId) {
+      ++scratch.bitCounts.back().second;
+    } else {
+      scratch.bitCounts.emplace_back(bitId, 1);
+    }
+  }
+}
+
 template <typename OutputType>
 void duplicateAdditionalOutputBit(AdditionalOutput &oldAO,
                                   AdditionalOutput &newAO, OutputType origBitId,
@@ -500,11 +505,96 @@ void setupTempAdditionalOutput(RDKit::FingerprintFuncArguments &args,
 }
 }  // namespace
 
+template <typename OutputType>
+template <typename SetBitFunc>
+void FingerprintGenerator<OutputType>::setFingerprintBits(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    const std::uint64_t effectiveSize, FingerprintScratch<OutputType> &scratch,
+    SetBitFunc setBit) const {
+  AdditionalOutput countSimulationOutput;
+  AdditionalOutput *origAO = nullptr;
+  if (dp_fingerprintArguments->df_countSimulation && args.additionalOutput) {
+    setupTempAdditionalOutput(args, countSimulationOutput, mol.getNumAtoms());
+    origAO = args.additionalOutput;
+    args.additionalOutput = &countSimulationOutput;
+  }
+
+  getBitIds(mol, args, effectiveSize, scratch);
+
+  if (dp_fingerprintArguments->df_countSimulation) {
+    countBitIds(scratch);
+    const auto &bounds_count = dp_fingerprintArguments->d_countBounds;
+    for (const auto &[bitId, count] : scratch.bitCounts) {
+      for (unsigned int i = 0; i < bounds_count.size(); ++i) {
+        // for every bound in the d_countBounds in dp_fingerprintArguments,
+        // set a bit if the occurrence count is equal or higher than the bound
+        // for that bit
+        if (count >= static_cast<int>(bounds_count[i])) {
+          OutputType nBitId = bitId * bounds_count.size() + i;
+          setBit(nBitId);
+          if (args.additionalOutput) {
+            duplicateAdditionalOutputBit(*args.additionalOutput, *origAO,
+                                         bitId, nBitId);
+          }
+        }
+      }
+    }
+  } else {
+    for (auto bitId : scratch.bitIds) {
+      setBit(bitId);
+    }
+  }
+
+  if (origAO) {
+    if (origAO->atomCounts) {
+      *origAO->atomCounts = *countSimulationOutput.atomCounts;
+    }
+    args.additionalOutput = origAO;
+  }
+}
+
+namespace {
+std::uint32_t getEffectiveFPSize(const FingerprintArguments &fpArgs) {
+  std::uint32_t effectiveSize = fpArgs.d_fpSize;
+  if (fpArgs.df_countSimulation) {
+    if (fpArgs.d_countBounds.empty()) {
+      throw ValueErrorException("Count bounds are empty");
+    }
+
+    if (fpArgs.d_countBounds.size() >= effectiveSize) {
+      throw ValueErrorException("Count bounds size is >= fingerprint size");
+    }
+
+    // effective size needs to be smaller than result size to compensate for
+    // count simulation
+    effectiveSize /= fpArgs.d_countBounds.size();
+  }
+  return effectiveSize;
+}
+}  // namespace
+
 template <typename OutputType>
 std::unique_ptr<SparseIntVect<OutputType>>
 FingerprintGenerator<OutputType>::getSparseCountFingerprint(
     const ROMol &mol, FingerprintFuncArguments &args) const {
-  return getFingerprintHelper(mol, args);
+  FingerprintScratch<OutputType> scratch;
+  return getSparseCountFingerprint(mol, args, scratch);
+}
+
+template <typename OutputType>
+std::unique_ptr<SparseIntVect<OutputType>>
+FingerprintGenerator<OutputType>::getSparseCountFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<OutputType> &scratch) const {
+  getBitIds(mol, args, 0, scratch);
+  countBitIds(scratch);
+
+  auto result = std::make_unique<SparseIntVect<OutputType>>(
+      dp_atomEnvironmentGenerator->getResultSize());
+  for (const auto &[bitId, count] : scratch.bitCounts) {
+    result->setVal(bitId, count);
+  }
+  return result;
 }
 
 // todo getSparseFingerprint does not completely produce the same output as
@@ -516,6 +606,15 @@ template <typename OutputType>
 std::unique_ptr<SparseBitVect>
 FingerprintGenerator<OutputType>::getSparseFingerprint(
     const ROMol &mol, FingerprintFuncArguments &args) const {
+  FingerprintScratch<OutputType> scratch;
+  return getSparseFingerprint(mol, args, scratch);
+}
+
+template <typename OutputType>
+std::unique_ptr<SparseBitVect>
+FingerprintGenerator<OutputType>::getSparseFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<OutputType> &scratch) const {
   // make sure the result will fit into SparseBitVect
   std::uint32_t resultSize =
       std::min((std::uint64_t)std::numeric_limits<std::uint32_t>::max(),
@@ -528,47 +627,9 @@ FingerprintGenerator<OutputType>::getSparseFingerprint(
     effectiveSize /= dp_fingerprintArguments->d_countBounds.size();
   }
 
-  AdditionalOutput countSimulationOutput;
-  AdditionalOutput *origAO = nullptr;
-  if (dp_fingerprintArguments->df_countSimulation && args.additionalOutput) {
-    setupTempAdditionalOutput(args, countSimulationOutput, mol.getNumAtoms());
-    origAO = args.additionalOutput;
-    args.additionalOutput = &countSimulationOutput;
-  }
-
-  auto tempResult = getFingerprintHelper(mol, args, effectiveSize);
-
   auto result = std::make_unique<SparseBitVect>(resultSize);
-
-  for (auto val : tempResult->getNonzeroElements()) {
-    if (dp_fingerprintArguments->df_countSimulation) {
-      for (unsigned int i = 0;
-           i < dp_fingerprintArguments->d_countBounds.size(); ++i) {
-        // for every bound in the d_countBounds in dp_fingerprintArguments,
-        // set a bit if the occurrence count is equal or higher than the bound
-        // for that bit
-        const auto &bounds_count = dp_fingerprintArguments->d_countBounds;
-        if (val.second >= static_cast<int>(bounds_count[i])) {
-          OutputType nBitId = val.first * bounds_count.size() + i;
-          result->setBit(nBitId);
-          if (args.additionalOutput) {
-            duplicateAdditionalOutputBit(*args.additionalOutput, *origAO,
-                                         static_cast<OutputType>(val.first),
-                                         nBitId);
-          }
-        }
-      }
-    } else {
-      result->setBit(val.first);
-    }
-  }
-  if (origAO) {
-    if (origAO->atomCounts) {
-      *origAO->atomCounts = *countSimulationOutput.atomCounts;
-    }
-    args.additionalOutput = origAO;
-  }
-
+  setFingerprintBits(mol, args, effectiveSize, scratch,
+                     [&result](OutputType bitId) { result->setBit(bitId); });
   return result;
 }
 
@@ -576,15 +637,23 @@ template <typename OutputType>
 std::unique_ptr<SparseIntVect<std::uint32_t>>
 FingerprintGenerator<OutputType>::getCountFingerprint(
     const ROMol &mol, FingerprintFuncArguments &args) const {
-  auto tempResult =
-      getFingerprintHelper(mol, args, dp_fingerprintArguments->d_fpSize);
+  FingerprintScratch<OutputType> scratch;
+  return getCountFingerprint(mol, args, scratch);
+}
+
+template <typename OutputType>
+std::unique_ptr<SparseIntVect<std::uint32_t>>
+FingerprintGenerator<OutputType>::getCountFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<OutputType> &scratch) const {
+  getBitIds(mol, args, dp_fingerprintArguments->d_fpSize, scratch);
+  countBitIds(scratch);
 
   auto result = std::make_unique<SparseIntVect<std::uint32_t>>(
       dp_fingerprintArguments->d_fpSize);
-  for (auto val : tempResult->getNonzeroElements()) {
-    result->setVal(val.first, val.second);
+  for (const auto &[bitId, count] : scratch.bitCounts) {
+    result->setVal(bitId, count);
   }
-
   return result;
 }
 
@@ -592,67 +661,39 @@ template <typename OutputType>
 std::unique_ptr<ExplicitBitVect>
 FingerprintGenerator<OutputType>::getFingerprint(
     const ROMol &mol, FingerprintFuncArguments &args) const {
-  std::uint32_t effectiveSize = dp_fingerprintArguments->d_fpSize;
-  if (dp_fingerprintArguments->df_countSimulation) {
-    if (dp_fingerprintArguments->d_countBounds.empty()) {
-      throw ValueErrorException("Count bounds are empty");
-    }
-
-    if (dp_fingerprintArguments->d_countBounds.size() >= effectiveSize) {
-      throw ValueErrorException("Count bounds size is >= fingerprint size");
-    }
-
-    // effective size needs to be smaller than result size to compensate for
-    // count simulation
-    effectiveSize /= dp_fingerprintArguments->d_countBounds.size();
-  }
-
-  AdditionalOutput countSimulationOutput;
-  AdditionalOutput *origAO = nullptr;
-  if (dp_fingerprintArguments->df_countSimulation && args.additionalOutput) {
-    setupTempAdditionalOutput(args, countSimulationOutput, mol.getNumAtoms());
-    origAO = args.additionalOutput;
-    args.additionalOutput = &countSimulationOutput;
-  }
-  auto tempResult = getFingerprintHelper(mol, args, effectiveSize);
+  FingerprintScratch<OutputType> scratch;
+  return getFingerprint(mol, args, scratch);
+}
 
+template <typename OutputType>
+std::unique_ptr<ExplicitBitVect>
+FingerprintGenerator<OutputType>::getFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<OutputType> &scratch) const {
+  auto effectiveSize = getEffectiveFPSize(*dp_fingerprintArguments);
   auto result =
       std::make_unique<ExplicitBitVect>(dp_fingerprintArguments->d_fpSize);
-  for (auto val : tempResult->getNonzeroElements()) {
-    if (dp_fingerprintArguments->df_countSimulation) {
-      for (unsigned int i = 0;
-           i < dp_fingerprintArguments->d_countBounds.size(); ++i) {
-        // for every bound in the d_countBounds in dp_fingerprintArguments,
-        // set a bit if the occurrence count is equal or higher than the bound
-        // for that bit
-        const auto &bounds_count = dp_fingerprintArguments->d_countBounds;
-        if (val.second >= static_cast<int>(bounds_count[i])) {
-          OutputType nBitId = val.first * bounds_count.size() + i;
-          result->setBit(nBitId);
-          if (args.additionalOutput) {
-            duplicateAdditionalOutputBit(*args.additionalOutput, *origAO,
-                                         static_cast<OutputType>(val.first),
-                                         nBitId);
-          }
-        }
-      }
-    } else {
-      result->setBit(val.first);
-    }
-  }
-
-  if (origAO) {
-    if (origAO->atomCounts) {
-      *origAO->atomCounts = *countSimulationOutput.atomCounts;
-    }
-    args.additionalOutput = origAO;
-  }
-
+  setFingerprintBits(mol, args, effectiveSize, scratch,
+                     [&result](OutputType bitId) { result->setBit(bitId); });
   return result;
 }
 
+template <typename OutputType>
+void FingerprintGenerator<OutputType>::getFingerprintAsWords(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<OutputType> &scratch, std::uint64_t *words) const {
+  PRECONDITION(words, "bad buffer pointer");
+  auto effectiveSize = getEffectiveFPSize(*dp_fingerprintArguments);
+  std::fill(words, words + (dp_fingerprintArguments->d_fpSize + 63) / 64, 0);
+  setFingerprintBits(mol, args, effectiveSize, scratch,
+                     [words](OutputType bitId) {
+                       words[bitId / 64] |= std::uint64_t(1) << (bitId % 64);
+                     });
+}
+
 namespace {
-template <typename ReturnType, typename FuncType>
+// each thread reuses one FingerprintScratch for all of its molecules
+template <typename ReturnType, typename OutputType, typename FuncType>
 std::vector<std::unique_ptr<ReturnType>> mtgetFingerprints(
     FuncType func, const std::vector<const ROMol *> &mols, int numThreads) {
   std::vector<std::uint32_t> *fromAtoms = nullptr;
@@ -670,11 +711,12 @@ std::vector<std::unique_ptr<ReturnType>> mtgetFingerprints(
   unsigned int nmols = mols.size();
   result.reserve(nmols);
   if (numThreadsToUse == 1) {
+    FingerprintScratch<OutputType> scratch;
     for (auto i = 0u; i < nmols; ++i) {
       if (!mols[i]) {
         result.emplace_back(std::unique_ptr<ReturnType>());
       } else {
-        result.emplace_back(std::move(func(*mols[i], args)));
+        result.emplace_back(std::move(func(*mols[i], args, scratch)));
       }
     }
   }
@@ -685,11 +727,13 @@ std::vector<std::unique_ptr<ReturnType>> mtgetFingerprints(
     std::vector<std::thread> tg;
     for (auto ti = 0u; ti < numThreadsToUse; ++ti) {
       auto lfunc = [&](unsigned int tidx) {
+        FingerprintScratch<OutputType> scratch;
         for (auto midx = tidx; midx < mols.size(); midx += numThreadsToUse) {
           if (!mols[midx]) {
             accum[tidx].emplace_back(std::unique_ptr<ReturnType>());
           } else {
-            accum[tidx].emplace_back(std::move(func(*mols[midx], args)));
+            accum[tidx].emplace_back(
+                std::move(func(*mols[midx], args, scratch)));
           }
         }
       };
@@ -715,44 +759,48 @@ template <typename OutputType>
 std::vector<std::unique_ptr<ExplicitBitVect>>
 FingerprintGenerator<OutputType>::getFingerprints(
     const std::vector<const ROMol *> &mols, int numThreads) const {
-  auto fpfunc = [&](const ROMol &mol, FingerprintFuncArguments &args) {
-    return this->getFingerprint(mol, args);
+  auto fpfunc = [&](const ROMol &mol, FingerprintFuncArguments &args,
+                    FingerprintScratch<OutputType> &scratch) {
+    return this->getFingerprint(mol, args, scratch);
   };
-  return mtgetFingerprints<ExplicitBitVect, decltype(fpfunc)>(fpfunc, mols,
-                                                              numThreads);
+  return mtgetFingerprints<ExplicitBitVect, OutputType, decltype(fpfunc)>(
+      fpfunc, mols, numThreads);
 }
 
 template <typename OutputType>
 std::vector<std::unique_ptr<SparseBitVect>>
 FingerprintGenerator<OutputType>::getSparseFingerprints(
     const std::vector<const ROMol *> &mols, int numThreads) const {
-  auto fpfunc = [&](const ROMol &mol, FingerprintFuncArguments &args) {
-    return this->getSparseFingerprint(mol, args);
+  auto fpfunc = [&](const ROMol &mol, FingerprintFuncArguments &args,
+                    FingerprintScratch<OutputType> &scratch) {
+    return this->getSparseFingerprint(mol, args, scratch);
   };
-  return mtgetFingerprints<SparseBitVect, decltype(fpfunc)>(fpfunc, mols,
-                                                            numThreads);
+  return mtgetFingerprints<SparseBitVect, OutputType, decltype(fpfunc)>(
+      fpfunc, mols, numThreads);
 }
 
 template <typename OutputType>
 std::vector<std::unique_ptr<SparseIntVect<std::uint32_t>>>
 FingerprintGenerator<OutputType>::getCountFingerprints(
     const std::vector<const ROMol *> &mols, int numThreads) const {
-  auto fpfunc = [&](const ROMol &mol, FingerprintFuncArguments &args) {
-    return this->getCountFingerprint(mol, args);
+  auto fpfunc = [&](const ROMol &mol, FingerprintFuncArguments &args,
+                    FingerprintScratch<OutputType> &scratch) {
+    return this->getCountFingerprint(mol, args, scratch);
   };
-  return mtgetFingerprints<SparseIntVect<std::uint32_t>, decltype(fpfunc)>(
-      fpfunc, mols, numThreads);
+  return mtgetFingerprints<SparseIntVect<std::uint32_t>, OutputType,
+                           decltype(fpfunc)>(fpfunc, mols, numThreads);
 }
 
 template <typename OutputType>
 std::vector<std::unique_ptr<SparseIntVect<OutputType>>>
 FingerprintGenerator<OutputType>::getSparseCountFingerprints(
     const std::vector<const ROMol *> &mols, int numThreads) const {
-  auto fpfunc = [&](const ROMol &mol, FingerprintFuncArguments &args) {
-    return this->getSparseCountFingerprint(mol, args);
+  auto fpfunc = [&](const ROMol &mol, FingerprintFuncArguments &args,
+                    FingerprintScratch<OutputType> &scratch) {
+    return this->getSparseCountFingerprint(mol, args, scratch);
   };
-  return mtgetFingerprints<SparseIntVect<OutputType>, decltype(fpfunc)>(
-      fpfunc, mols, numThreads);
+  return mtgetFingerprints<SparseIntVect<OutputType>, OutputType,
+                           decltype(fpfunc)>(fpfunc, mols, numThreads);
 }
 
 template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<SparseIntVect<std::uint32_t>>
@@ -787,6 +835,56 @@ template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<ExplicitBitVect>
 FingerprintGenerator<std::uint64_t>::getFingerprint(
     const ROMol &mol, FingerprintFuncArguments &args) const;
 
+template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<SparseIntVect<std::uint32_t>>
+FingerprintGenerator<std::uint32_t>::getSparseCountFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint32_t> &scratch) const;
+
+template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<SparseIntVect<std::uint64_t>>
+FingerprintGenerator<std::uint64_t>::getSparseCountFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint64_t> &scratch) const;
+
+template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<SparseBitVect>
+FingerprintGenerator<std::uint32_t>::getSparseFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint32_t> &scratch) const;
+
+template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<SparseBitVect>
+FingerprintGenerator<std::uint64_t>::getSparseFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint64_t> &scratch) const;
+
+template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<SparseIntVect<std::uint32_t>>
+FingerprintGenerator<std::uint32_t>::getCountFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint32_t> &scratch) const;
+
+template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<SparseIntVect<std::uint32_t>>
+FingerprintGenerator<std::uint64_t>::getCountFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint64_t> &scratch) const;
+
+template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<ExplicitBitVect>
+FingerprintGenerator<std::uint32_t>::getFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint32_t> &scratch) const;
+
+template RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<ExplicitBitVect>
+FingerprintGenerator<std::uint64_t>::getFingerprint(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint64_t> &scratch) const;
+
+template RDKIT_FINGERPRINTS_EXPORT void
+FingerprintGenerator<std::uint32_t>::getFingerprintAsWords(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint32_t> &scratch, std::uint64_t *words) const;
+
+template RDKIT_FINGERPRINTS_EXPORT void
+FingerprintGenerator<std::uint64_t>::getFingerprintAsWords(
+    const ROMol &mol, FingerprintFuncArguments &args,
+    FingerprintScratch<std::uint64_t> &scratch, std::uint64_t *words) const;
+
 template RDKIT_FINGERPRINTS_EXPORT std::vector<std::unique_ptr<ExplicitBitVect>>
 FingerprintGenerator<std::uint32_t>::getFingerprints(
     const std::vector<const ROMol *> &mols, int numThreads) const;
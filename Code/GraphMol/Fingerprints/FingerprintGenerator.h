@@ -153,6 +153,79 @@ class RDKIT_FINGERPRINTS_EXPORT AtomEnvironment : private boost::noncopyable {
   virtual ~AtomEnvironment() {}
 };
 
+/*!
+  \brief abstract base class for the working state an
+  AtomEnvironmentGenerator keeps in a FingerprintScratch between molecules
+
+ */
+class RDKIT_FINGERPRINTS_EXPORT EnvironmentGeneratorWorkspace {
+ public:
+  virtual ~EnvironmentGeneratorWorkspace() {}
+};
+
+/*!
+  \brief holds the buffers used while generating fingerprints so that they
+  can be reused for many molecules
+
+  Generating a fingerprint needs the atom and bond invariants, the atom
+  environments and the bit ids of the molecule. Passing the same
+  FingerprintScratch to the fingerprinting functions for a series of
+  molecules keeps these, so that they are not allocated again for every
+  molecule.
+
+  A FingerprintScratch can be used with any generator with the same
+  OutputType, but only by one thread at a time.
+
+ */
+template <typename OutputType>
+class FingerprintScratch : private boost::noncopyable {
+ public:
+  std::vector<std::uint32_t> atomInvariants;
+  std::vector<std::uint32_t> bondInvariants;
+  //! the bit ids set by the environments of the last molecule
+  std::vector<OutputType> bitIds;
+  //! the distinct bit ids of the last molecule and how often they were set
+  std::vector<std::pair<OutputType, int>> bitCounts;
+  //! the state kept by the atom environment generator
+  std::unique_ptr<EnvironmentGeneratorWorkspace> workspace;
+
+  //! returns the number of environments generated for the last molecule
+  size_t getNumEnvironments() const { return d_numEnvironments; }
+  AtomEnvironment<OutputType> *getEnvironment(size_t idx) const {
+    PRECONDITION(idx < d_numEnvironments, "bad environment index");
+    return d_environments[idx].get();
+  }
+  //! starts collecting the environments of a new molecule
+  void clearEnvironments() { d_numEnvironments = 0; }
+  //! adds an environment, the scratch takes ownership of it
+  void addEnvironment(AtomEnvironment<OutputType> *env) {
+    if (d_numEnvironments < d_environments.size()) {
+      d_environments[d_numEnvironments].reset(env);
+    } else {
+      d_environments.emplace_back(env);
+    }
+    ++d_numEnvironments;
+  }
+  //! \brief returns an environment left from a previous molecule which can
+  //! be reset and added again, or nullptr if there is none of type EnvType
+  template <typename EnvType>
+  EnvType *reuseEnvironment() {
+    if (d_numEnvironments < d_environments.size()) {
+      auto *env =
+          dynamic_cast<EnvType *>(d_environments[d_numEnvironments].get());
+      if (env) {
+        ++d_numEnvironments;
+        return env;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  std::vector<std::unique_ptr<AtomEnvironment<OutputType>>> d_environments;
+  size_t d_numEnvironments = 0;
+};
+
 /*!
   \brief abstract base class that generates atom-environments from a molecule
 
@@ -197,6 +270,32 @@ class RDKIT_FINGERPRINTS_EXPORT AtomEnvironmentGenerator
       const std::vector<std::uint32_t> *bondInvariants = nullptr,
       const bool hashResults = false) const = 0;
 
+  /*!
+    \brief generate all atom-environments from a molecule into a
+    FingerprintScratch
+
+    The arguments are the same as for getEnvironments(), the environments
+    replace the ones in \c scratch and are owned by it. The default
+    implementation calls getEnvironments(), generators override this to reuse
+    the environments and the workspace kept in \c scratch.
+   */
+  virtual void fillEnvironments(
+      const ROMol &mol, FingerprintArguments *arguments,
+      FingerprintScratch<OutputType> &scratch,
+      const std::vector<std::uint32_t> *fromAtoms,
+      const std::vector<std::uint32_t> *ignoreAtoms, const int confId,
+      const AdditionalOutput *additionalOutput,
+      const std::vector<std::uint32_t> *atomInvariants,
+      const std::vector<std::uint32_t> *bondInvariants,
+      const bool hashResults) const {
+    scratch.clearEnvironments();
+    for (auto env : getEnvironments(mol, arguments, fromAtoms, ignoreAtoms,
+                                    confId, additionalOutput, atomInvariants,
+                                    bondInvariants, hashResults)) {
+      scratch.addEnvironment(env);
+    }
+  }
+
   /**
    \brief method that returns information about this /c AtomEnvironmentGenerator
    and its arguments if any
@@ -237,6 +336,18 @@ class RDKIT_FINGERPRINTS_EXPORT AtomInvariantsGenerator
   virtual std::vector<std::uint32_t> *getAtomInvariants(
       const ROMol &mol) const = 0;
 
+  /*!
+    \brief get atom invariants from a molecule into an existing vector
+
+    The default implementation calls getAtomInvariants(), generators override
+    this to reuse the storage of \c invariants.
+   */
+  virtual void fillAtomInvariants(
+      const ROMol &mol, std::vector<std::uint32_t> &invariants) const {
+    std::unique_ptr<std::vector<std::uint32_t>> res(getAtomInvariants(mol));
+    invariants.assign(res->begin(), res->end());
+  }
+
   /**
    \brief method that returns information about this /c AtomInvariantsGenerator
    and its arguments
@@ -269,6 +380,18 @@ class RDKIT_FINGERPRINTS_EXPORT BondInvariantsGenerator
   virtual std::vector<std::uint32_t> *getBondInvariants(
       const ROMol &mol) const = 0;
 
+  /*!
+    \brief get bond invariants from a molecule into an existing vector
+
+    The default implementation calls getBondInvariants(), generators override
+    this to reuse the storage of \c invariants.
+   */
+  virtual void fillBondInvariants(
+      const ROMol &mol, std::vector<std::uint32_t> &invariants) const {
+    std::unique_ptr<std::vector<std::uint32_t>> res(getBondInvariants(mol));
+    invariants.assign(res->begin(), res->end());
+  }
+
   /**
  \brief method that returns information about this /c BondInvariantsGenerator
  and its arguments
@@ -326,9 +449,14 @@ class RDKIT_FINGERPRINTS_EXPORT FingerprintGenerator
   const bool df_ownsAtomInvGenerator;
   const bool df_ownsBondInvGenerator;
 
-  std::unique_ptr<SparseIntVect<OutputType>> getFingerprintHelper(
-      const ROMol &mol, FingerprintFuncArguments &args,
-      const std::uint64_t fpSize = 0) const;
+  void getBitIds(const ROMol &mol, FingerprintFuncArguments &args,
+                 const std::uint64_t fpSize,
+                 FingerprintScratch<OutputType> &scratch) const;
+  template <typename SetBitFunc>
+  void setFingerprintBits(const ROMol &mol, FingerprintFuncArguments &args,
+                          const std::uint64_t effectiveSize,
+                          FingerprintScratch<OutputType> &scratch,
+                          SetBitFunc setBit) const;
 
  public:
   FingerprintGenerator(
@@ -357,6 +485,43 @@ class RDKIT_FINGERPRINTS_EXPORT FingerprintGenerator
   std::unique_ptr<ExplicitBitVect> getFingerprint(
       const ROMol &mol, FingerprintFuncArguments &args) const;
 
+  //! \name Fingerprinting with reused buffers
+  /*!
+    These are equivalent to the functions above, but use the buffers in \c
+    scratch instead of allocating new ones. This is faster when generating
+    fingerprints for many molecules.
+  */
+  //!@{
+  std::unique_ptr<SparseIntVect<OutputType>> getSparseCountFingerprint(
+      const ROMol &mol, FingerprintFuncArguments &args,
+      FingerprintScratch<OutputType> &scratch) const;
+
+  std::unique_ptr<SparseBitVect> getSparseFingerprint(
+      const ROMol &mol, FingerprintFuncArguments &args,
+      FingerprintScratch<OutputType> &scratch) const;
+
+  std::unique_ptr<SparseIntVect<std::uint32_t>> getCountFingerprint(
+      const ROMol &mol, FingerprintFuncArguments &args,
+      FingerprintScratch<OutputType> &scratch) const;
+
+  std::unique_ptr<ExplicitBitVect> getFingerprint(
+      const ROMol &mol, FingerprintFuncArguments &args,
+      FingerprintScratch<OutputType> &scratch) const;
+
+  //! \brief generates the fingerprint into a caller provided buffer
+  /*!
+    This sets the same bits as getFingerprint(), but without creating an
+    ExplicitBitVect.
+
+    \param words  the buffer for the fingerprint, must hold at least
+                  (fpSize + 63) / 64 values. Bit \c i of the fingerprint is
+                  bit i % 64 of words[i / 64], the other bits are cleared.
+  */
+  void getFingerprintAsWords(const ROMol &mol, FingerprintFuncArguments &args,
+                             FingerprintScratch<OutputType> &scratch,
+                             std::uint64_t *words) const;
+  //!@}
+
   std::vector<std::unique_ptr<ExplicitBitVect>> getFingerprints(
       const std::vector<const ROMol *> &mols, int numThreads = 1) const;
 
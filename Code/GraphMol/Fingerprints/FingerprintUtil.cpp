@@ -9,6 +9,7 @@
 //
 
 #include <GraphMol/RDKitBase.h>
+#include <GraphMol/CompactMol.h>
 #include <GraphMol/Fingerprints/FingerprintUtil.h>
 #include <GraphMol/Subgraphs/Subgraphs.h>
 #include <RDGeneral/hash/hash.hpp>
@@ -239,31 +240,74 @@ void getFeatureInvariants(const ROMol &mol, std::vector<uint32_t> &invars,
   }
 }  // end of getFeatureInvariants()
 
+namespace {
+// the invariant of one atom, shared by the ROMol and CompactMol versions of
+// getConnectivityInvariants()
+std::uint32_t hashConnectivityInvariant(std::vector<uint32_t> &components,
+                                        int atomicNum, unsigned int degree,
+                                        unsigned int numHs, int formalCharge,
+                                        double mass, bool inRing) {
+  gboost::hash<std::vector<uint32_t>> vectHasher;
+  components.clear();
+  components.push_back(atomicNum);
+  components.push_back(degree);
+  components.push_back(numHs);
+  components.push_back(formalCharge);
+  int deltaMass = static_cast<int>(
+      mass - PeriodicTable::getTable()->getAtomicWeight(atomicNum));
+  components.push_back(deltaMass);
+  if (inRing) {
+    components.push_back(1);
+  }
+  return vectHasher(components);
+}
+}  // namespace
+
 void getConnectivityInvariants(const ROMol &mol, std::vector<uint32_t> &invars,
                                bool includeRingMembership) {
   unsigned int nAtoms = mol.getNumAtoms();
   PRECONDITION(invars.size() >= nAtoms, "vector too small");
-  gboost::hash<std::vector<uint32_t>> vectHasher;
+  std::vector<uint32_t> components;
   for (unsigned int i = 0; i < nAtoms; ++i) {
     Atom const *atom = mol.getAtomWithIdx(i);
-    std::vector<uint32_t> components;
-    components.push_back(atom->getAtomicNum());
-    components.push_back(atom->getTotalDegree());
-    components.push_back(atom->getTotalNumHs(true));
-    components.push_back(atom->getFormalCharge());
-    int deltaMass = static_cast<int>(
-        atom->getMass() -
-        PeriodicTable::getTable()->getAtomicWeight(atom->getAtomicNum()));
-    components.push_back(deltaMass);
-
-    if (includeRingMembership &&
-        atom->getOwningMol().getRingInfo()->numAtomRings(atom->getIdx())) {
-      components.push_back(1);
-    }
-    invars[i] = vectHasher(components);
+    invars[i] = hashConnectivityInvariant(
+        components, atom->getAtomicNum(), atom->getTotalDegree(),
+        atom->getTotalNumHs(true), atom->getFormalCharge(), atom->getMass(),
+        includeRingMembership &&
+            atom->getOwningMol().getRingInfo()->numAtomRings(atom->getIdx()));
   }
 }  // end of getConnectivityInvariants()
 
+void getConnectivityInvariants(const CompactMol &mol,
+                               std::vector<uint32_t> &invars,
+                               bool includeRingMembership) {
+  unsigned int nAtoms = mol.getNumAtoms();
+  PRECONDITION(invars.size() >= nAtoms, "vector too small");
+  const auto table = PeriodicTable::getTable();
+  std::vector<uint32_t> components;
+  for (unsigned int i = 0; i < nAtoms; ++i) {
+    const auto atomicNum = mol.getAtomicNum(i);
+    const auto nbrs = mol.getAtomNeighbors(i);
+    // getNumHs() doesn't include the Hs in the graph
+    const auto numHs = mol.getNumHs(i);
+    const auto numNbrHs = std::count_if(
+        nbrs.begin(), nbrs.end(),
+        [&mol](std::uint32_t nbr) { return mol.getAtomicNum(nbr) == 1; });
+    // this matches Atom::getMass()
+    double mass = table->getAtomicWeight(atomicNum);
+    if (const auto isotope = mol.getIsotope(i); isotope) {
+      mass = table->getMassForIsotope(atomicNum, isotope);
+      if (atomicNum != 0 && mass == 0.0) {
+        mass = isotope;
+      }
+    }
+    invars[i] = hashConnectivityInvariant(
+        components, atomicNum, numHs + nbrs.size(), numHs + numNbrHs,
+        mol.getFormalCharge(i), mass,
+        includeRingMembership && mol.getNumAtomRings(i));
+  }
+}
+
 }  // namespace MorganFingerprints
 
 namespace RDKitFPUtils {
@@ -25,6 +25,7 @@
 #include <GraphMol/Subgraphs/Subgraphs.h>
 
 namespace RDKit {
+class CompactMol;
 namespace AtomPairs {
 const unsigned int numTypeBits = 4;
 const unsigned int atomNumberTypes[1 << numTypeBits] = {
@@ -112,6 +113,10 @@ RDKIT_FINGERPRINTS_EXPORT extern std::vector<std::string> defaultFeatureSmarts;
 RDKIT_FINGERPRINTS_EXPORT void getConnectivityInvariants(
     const ROMol &mol, std::vector<std::uint32_t> &invars,
     bool includeRingMembership = true);
+//! \overload
+RDKIT_FINGERPRINTS_EXPORT void getConnectivityInvariants(
+    const CompactMol &mol, std::vector<std::uint32_t> &invars,
+    bool includeRingMembership = true);
 const std::string morganConnectivityInvariantVersion = "1.0.0";
 
 //! returns the feature invariants for a molecule
@@ -19,6 +19,7 @@ class ExplicitBitVect;
 namespace RDKit {
 class ROMol;
 class MolBundle;
+class CompactMol;
 
 //! \brief Generates a topological (Daylight like) fingerprint for a molecule
 //!        using an alternate (faster) hashing algorithm
@@ -151,6 +152,19 @@ const std::string PatternFingerprintMolVersion = "1.0.0";
 RDKIT_FINGERPRINTS_EXPORT ExplicitBitVect *PatternFingerprintMol(
     const MolBundle &bundle, unsigned int fpSize = 2048,
     ExplicitBitVect *setOnlyBits = nullptr, bool tautomericFingerprint = false);
+//! \overload
+/*!
+  The result is the same as the fingerprint of the ROMol the CompactMol was
+  created from.
+*/
+RDKIT_FINGERPRINTS_EXPORT ExplicitBitVect *PatternFingerprintMol(
+    const CompactMol &mol, unsigned int fpSize = 2048,
+    bool tautomericFingerprint = false);
+//! \brief Generates the pattern fingerprint of a CompactMol and stores it on
+//! the molecule, so that it is used to screen substructure searches
+RDKIT_FINGERPRINTS_EXPORT void addPatternFingerprint(
+    CompactMol &mol, unsigned int fpSize = 2048,
+    bool tautomericFingerprint = false);
 
 RDKIT_FINGERPRINTS_EXPORT SparseIntVect<boost::uint64_t> *
 getUnfoldedRDKFingerprintMol(
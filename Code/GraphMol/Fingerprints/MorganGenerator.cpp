@@ -9,6 +9,7 @@
 //
 
 #include <GraphMol/RDKitBase.h>
+#include <GraphMol/CompactMol.h>
 #include <GraphMol/MolOps.h>
 #include <GraphMol/Fingerprints/FingerprintGenerator.h>
 #include <GraphMol/Fingerprints/MorganGenerator.h>
@@ -41,13 +42,18 @@ MorganAtomInvGenerator::MorganAtomInvGenerator(const bool includeRingMembership)
 
 std::vector<std::uint32_t> *MorganAtomInvGenerator::getAtomInvariants(
     const ROMol &mol) const {
-  unsigned int nAtoms = mol.getNumAtoms();
   std::unique_ptr<std::vector<std::uint32_t>> atomInvariants(
-      new std::vector<std::uint32_t>(nAtoms));
-  getConnectivityInvariants(mol, *atomInvariants, df_includeRingMembership);
+      new std::vector<std::uint32_t>());
+  fillAtomInvariants(mol, *atomInvariants);
   return atomInvariants.release();
 }
 
+void MorganAtomInvGenerator::fillAtomInvariants(
+    const ROMol &mol, std::vector<std::uint32_t> &invariants) const {
+  invariants.resize(mol.getNumAtoms());
+  getConnectivityInvariants(mol, invariants, df_includeRingMembership);
+}
+
 std::string MorganAtomInvGenerator::infoString() const {
   return "MorganInvariantGenerator includeRingMembership=" +
          std::to_string(df_includeRingMembership);
@@ -133,21 +139,31 @@ MorganFeatureAtomInvGenerator *MorganFeatureAtomInvGenerator::clone() const {
 
 std::vector<std::uint32_t> *MorganFeatureAtomInvGenerator::getAtomInvariants(
     const ROMol &mol) const {
-  unsigned int nAtoms = mol.getNumAtoms();
-  std::vector<std::uint32_t> *result = new std::vector<std::uint32_t>(nAtoms);
-
-  getFeatureInvariants(mol, *result, dp_patterns);
+  std::vector<std::uint32_t> *result = new std::vector<std::uint32_t>();
+  fillAtomInvariants(mol, *result);
   return result;
 }
 
+void MorganFeatureAtomInvGenerator::fillAtomInvariants(
+    const ROMol &mol, std::vector<std::uint32_t> &invariants) const {
+  invariants.resize(mol.getNumAtoms());
+  getFeatureInvariants(mol, invariants, dp_patterns);
+}
+
 MorganBondInvGenerator::MorganBondInvGenerator(const bool useBondTypes,
                                                const bool useChirality)
     : df_useBondTypes(useBondTypes), df_useChirality(useChirality) {}
 
 std::vector<std::uint32_t> *MorganBondInvGenerator::getBondInvariants(
     const ROMol &mol) const {
-  std::vector<std::uint32_t> *result =
-      new std::vector<std::uint32_t>(mol.getNumBonds());
+  std::vector<std::uint32_t> *result = new std::vector<std::uint32_t>();
+  fillBondInvariants(mol, *result);
+  return result;
+}
+
+void MorganBondInvGenerator::fillBondInvariants(
+    const ROMol &mol, std::vector<std::uint32_t> &invariants) const {
+  invariants.resize(mol.getNumBonds());
   for (unsigned int i = 0; i < mol.getNumBonds(); ++i) {
     Bond const *bond = mol.getBondWithIdx(i);
     int32_t bondInvariant = 1;
@@ -183,9 +199,8 @@ std::vector<std::uint32_t> *MorganBondInvGenerator::getBondInvariants(
             bondStereo;
       }
     }
-    (*result)[bond->getIdx()] = static_cast<int32_t>(bondInvariant);
+    invariants[bond->getIdx()] = static_cast<int32_t>(bondInvariant);
   }
-  return result;
 }
 
 std::string MorganBondInvGenerator::infoString() const {
@@ -275,18 +290,106 @@ OutputType MorganAtomEnv<OutputType>::getBitId(
   return d_code;
 }  // namespace MorganFingerprint
 
+namespace {
+// the buffers used to generate the Morgan environments of a molecule, these
+// are kept in a FingerprintScratch so that they can be reused
 template <typename OutputType>
-std::vector<AtomEnvironment<OutputType> *>
-MorganEnvGenerator<OutputType>::getEnvironments(
-    const ROMol &mol, FingerprintArguments *arguments,
+struct MorganEnvWorkspace : public EnvironmentGeneratorWorkspace {
+  std::vector<OutputType> currentInvariants;
+  std::vector<OutputType> nextLayerInvariants;
+  std::vector<std::pair<int32_t, uint32_t>> neighborhoodInvariants;
+  boost::dynamic_bitset<> includeAtoms;
+  boost::dynamic_bitset<> chiralAtoms;
+  std::unordered_set<boost::dynamic_bitset<>> neighborhoods;
+  std::vector<boost::dynamic_bitset<>> atomNeighborhoods;
+  std::vector<boost::dynamic_bitset<>> roundAtomNeighborhoods;
+  boost::dynamic_bitset<> deadAtoms;
+  std::vector<unsigned int> atomOrder;
+  std::vector<AccumTuple> allNeighborhoodsThisRound;
+};
+
+void resetBitset(boost::dynamic_bitset<> &bits, size_t size) {
+  // clear() keeps the storage
+  bits.clear();
+  bits.resize(size);
+}
+
+// generateMorganEnvironments() reads the molecule through one of these, so
+// that ROMols and CompactMols share the same implementation
+class ROMolGraph {
+ public:
+  explicit ROMolGraph(const ROMol &mol) : d_mol(mol) {}
+  unsigned int getNumAtoms() const { return d_mol.getNumAtoms(); }
+  unsigned int getNumBonds() const { return d_mol.getNumBonds(); }
+  unsigned int getDegree(unsigned int idx) const {
+    return d_mol.getAtomWithIdx(idx)->getDegree();
+  }
+  //! calls func(bondIdx, otherAtomIdx) for each of the atom's bonds
+  template <typename Func>
+  void forEachBond(unsigned int idx, Func func) const {
+    for (const auto bond : d_mol.atomBonds(d_mol.getAtomWithIdx(idx))) {
+      func(bond->getIdx(), bond->getOtherAtomIdx(idx));
+    }
+  }
+  Atom::ChiralType getChiralTag(unsigned int idx) const {
+    return d_mol.getAtomWithIdx(idx)->getChiralTag();
+  }
+  std::string getCIPCode(unsigned int idx) const {
+    std::string cip = "";
+    d_mol.getAtomWithIdx(idx)->getPropIfPresent(common_properties::_CIPCode,
+                                                cip);
+    return cip;
+  }
+  // we need to make sure the atoms have R/S labels
+  void prepareChirality() const {
+    if (!Chirality::getUseLegacyStereoPerception() &&
+        !d_mol.hasProp(common_properties::_CIPComputed)) {
+      CIPLabeler::assignCIPLabels(const_cast<ROMol &>(d_mol));
+    }
+  }
+
+ private:
+  const ROMol &d_mol;
+};
+
+class CompactMolGraph {
+ public:
+  explicit CompactMolGraph(const CompactMol &mol) : d_mol(mol) {}
+  unsigned int getNumAtoms() const { return d_mol.getNumAtoms(); }
+  unsigned int getNumBonds() const { return d_mol.getNumBonds(); }
+  unsigned int getDegree(unsigned int idx) const {
+    return d_mol.getDegree(idx);
+  }
+  template <typename Func>
+  void forEachBond(unsigned int idx, Func func) const {
+    const auto nbrs = d_mol.getAtomNeighbors(idx);
+    const auto bonds = d_mol.getAtomBonds(idx);
+    for (unsigned int i = 0; i < nbrs.size(); ++i) {
+      func(bonds[i], nbrs[i]);
+    }
+  }
+  Atom::ChiralType getChiralTag(unsigned int idx) const {
+    return d_mol.getChiralTag(idx);
+  }
+  std::string getCIPCode(unsigned int) const { return ""; }
+  // CompactMols don't have CIP labels
+  void prepareChirality() const {
+    throw ValueErrorException(
+        "chirality is not supported for Morgan fingerprints of CompactMols");
+  }
+
+ private:
+  const CompactMol &d_mol;
+};
+
+// calls addEnv(code, atomIdx, layer) for each of the environments
+template <typename OutputType, typename MolGraph, typename AddEnvFunc>
+void generateMorganEnvironments(
+    const MolGraph &mol, FingerprintArguments *arguments,
     const std::vector<std::uint32_t> *fromAtoms,
-    const std::vector<std::uint32_t> *,  // ignoreAtoms
-    const int,                           // confId
-    const AdditionalOutput *,            // additionalOutput
     const std::vector<std::uint32_t> *atomInvariants,
     const std::vector<std::uint32_t> *bondInvariants,
-    const bool  // hashResults
-) const {
+    MorganEnvWorkspace<OutputType> &ws, AddEnvFunc addEnv) {
   PRECONDITION(atomInvariants && (atomInvariants->size() >= mol.getNumAtoms()),
                "bad atom invariants size");
   PRECONDITION(bondInvariants && (bondInvariants->size() >= mol.getNumBonds()),
@@ -297,32 +400,26 @@ MorganEnvGenerator<OutputType>::getEnvironments(
   unsigned int nAtoms = mol.getNumAtoms();
   const unsigned int maxNumResults = (morganArguments->d_radius + 1) * nAtoms;
 
-  std::vector<AtomEnvironment<OutputType> *> result =
-      std::vector<AtomEnvironment<OutputType> *>();
-  result.reserve(maxNumResults);
-
-  // if we are using chirality, we need to make sure the atoms have R/S labels
-  if (morganArguments->df_includeChirality &&
-      !Chirality::getUseLegacyStereoPerception() &&
-      !mol.hasProp(common_properties::_CIPComputed)) {
-    CIPLabeler::assignCIPLabels(const_cast<ROMol &>(mol));
+  if (morganArguments->df_includeChirality) {
+    mol.prepareChirality();
   }
 
-  std::vector<OutputType> currentInvariants(atomInvariants->size());
-  std::copy(atomInvariants->begin(), atomInvariants->end(),
-            currentInvariants.begin());
+  auto &currentInvariants = ws.currentInvariants;
+  currentInvariants.assign(atomInvariants->begin(), atomInvariants->end());
   // will hold bit ids calculated this round to be used as invariants next
   // round
-  std::vector<OutputType> nextLayerInvariants(nAtoms);
+  auto &nextLayerInvariants = ws.nextLayerInvariants;
+  nextLayerInvariants.assign(nAtoms, 0);
 
   // will hold up to date invariants of neighboring atoms with bond
   // types, these invariants hold information from atoms around radius
   // as big as current layer around the current atom
-  std::vector<std::pair<int32_t, uint32_t>> neighborhoodInvariants;
+  auto &neighborhoodInvariants = ws.neighborhoodInvariants;
   // Max number of neighbors expected.
   neighborhoodInvariants.reserve(8);
 
-  boost::dynamic_bitset<> includeAtoms(nAtoms);
+  auto &includeAtoms = ws.includeAtoms;
+  resetBitset(includeAtoms, nAtoms);
   if (fromAtoms) {
     for (auto idx : *fromAtoms) {
       includeAtoms.set(idx, 1);
@@ -331,26 +428,33 @@ MorganEnvGenerator<OutputType>::getEnvironments(
     includeAtoms.set();
   }
 
-  boost::dynamic_bitset<> chiralAtoms(nAtoms);
+  auto &chiralAtoms = ws.chiralAtoms;
+  resetBitset(chiralAtoms, nAtoms);
 
   // these are the neighborhoods that have already been added
   // to the fingerprint
-  std::unordered_set<boost::dynamic_bitset<>> neighborhoods;
+  auto &neighborhoods = ws.neighborhoods;
+  neighborhoods.clear();
   neighborhoods.reserve(maxNumResults);
   // these are the environments around each atom:
-  std::vector<boost::dynamic_bitset<>> atomNeighborhoods(
-      nAtoms, boost::dynamic_bitset<>(mol.getNumBonds()));
+  auto &atomNeighborhoods = ws.atomNeighborhoods;
+  atomNeighborhoods.resize(nAtoms);
+  for (auto &atomNeighborhood : atomNeighborhoods) {
+    resetBitset(atomNeighborhood, mol.getNumBonds());
+  }
   // holds atoms in the environment (neighborhood) for the current layer for
   // each atom, starts with the immediate neighbors of atoms and expands
   // with every iteration
-  std::vector<boost::dynamic_bitset<>> roundAtomNeighborhoods =
-      atomNeighborhoods;
-  boost::dynamic_bitset<> deadAtoms(nAtoms);
+  auto &roundAtomNeighborhoods = ws.roundAtomNeighborhoods;
+  roundAtomNeighborhoods = atomNeighborhoods;
+  auto &deadAtoms = ws.deadAtoms;
+  resetBitset(deadAtoms, nAtoms);
 
   // if df_onlyNonzeroInvariants is set order the atoms to make sure atoms
   // with zero invariants are processed last so that in case of duplicate
   // environments atoms with non-zero invariants are used
-  std::vector<unsigned int> atomOrder(nAtoms);
+  auto &atomOrder = ws.atomOrder;
+  atomOrder.resize(nAtoms);
   if (morganArguments->df_onlyNonzeroInvariants) {
     std::vector<std::pair<int32_t, uint32_t>> ordering;
     for (unsigned int i = 0; i < nAtoms; ++i) {
@@ -374,46 +478,37 @@ MorganEnvGenerator<OutputType>::getEnvironments(
   for (unsigned int i = 0; i < nAtoms; ++i) {
     if (includeAtoms[i]) {
       if (!morganArguments->df_onlyNonzeroInvariants || currentInvariants[i]) {
-        result.push_back(
-            new MorganAtomEnv<OutputType>(currentInvariants[i], i, 0, &mol));
+        addEnv(currentInvariants[i], i, 0);
       }
     }
   }
 
   // now do our subsequent rounds:
   for (unsigned int layer = 0; layer < morganArguments->d_radius; ++layer) {
-    std::vector<AccumTuple> allNeighborhoodsThisRound;
+    auto &allNeighborhoodsThisRound = ws.allNeighborhoodsThisRound;
+    allNeighborhoodsThisRound.clear();
     for (auto atomIdx : atomOrder) {
       // skip atoms which will not generate unique environments
       // (neighborhoods) anymore
       if (!deadAtoms[atomIdx]) {
-        const Atom *tAtom = mol.getAtomWithIdx(atomIdx);
-        if (!tAtom->getDegree()) {
+        if (!mol.getDegree(atomIdx)) {
           deadAtoms.set(atomIdx, 1);
           continue;
         }
 
-        ROMol::OEDGE_ITER beg, end;
-        boost::tie(beg, end) = mol.getAtomBonds(tAtom);
-
         // add up to date invariants of neighbors
         // This should keep capacity, so reallocation only triggers if we
         // haven't seen a molecule of this size.
         neighborhoodInvariants.clear();
 
-        while (beg != end) {
-          const Bond *bond = mol[*beg];
-          roundAtomNeighborhoods[atomIdx][bond->getIdx()] = 1;
-
-          unsigned int oIdx = bond->getOtherAtomIdx(atomIdx);
+        mol.forEachBond(atomIdx, [&](unsigned int bondIdx, unsigned int oIdx) {
+          roundAtomNeighborhoods[atomIdx][bondIdx] = 1;
           roundAtomNeighborhoods[atomIdx] |= atomNeighborhoods[oIdx];
 
-          auto bt = static_cast<int32_t>((*bondInvariants)[bond->getIdx()]);
+          auto bt = static_cast<int32_t>((*bondInvariants)[bondIdx]);
           neighborhoodInvariants.push_back(
               std::make_pair(bt, currentInvariants[oIdx]));
-
-          ++beg;
-        }
+        });
 
         // sort the neighbor list:
         std::sort(neighborhoodInvariants.begin(), neighborhoodInvariants.end());
@@ -421,7 +516,8 @@ MorganEnvGenerator<OutputType>::getEnvironments(
         // "chiral"
         std::uint32_t invar = layer;
         gboost::hash_combine(invar, currentInvariants[atomIdx]);
-        bool looksChiral = (tAtom->getChiralTag() != Atom::CHI_UNSPECIFIED);
+        bool looksChiral =
+            (mol.getChiralTag(atomIdx) != Atom::CHI_UNSPECIFIED);
         for (std::vector<std::pair<int32_t, uint32_t>>::const_iterator it =
                  neighborhoodInvariants.begin();
              it != neighborhoodInvariants.end(); ++it) {
@@ -443,8 +539,7 @@ MorganEnvGenerator<OutputType>::getEnvironments(
         if (morganArguments->df_includeChirality && looksChiral) {
           chiralAtoms[atomIdx] = 1;
           // add an extra value to the invariant to reflect chirality:
-          std::string cip = "";
-          tAtom->getPropIfPresent(common_properties::_CIPCode, cip);
+          const auto cip = mol.getCIPCode(atomIdx);
           if (cip == "R") {
             gboost::hash_combine(invar, 3);
           } else if (cip == "S") {
@@ -478,8 +573,7 @@ MorganEnvGenerator<OutputType>::getEnvironments(
         if (!morganArguments->df_onlyNonzeroInvariants ||
             (*atomInvariants)[std::get<2>(*iter)]) {
           if (includeAtoms[std::get<2>(*iter)]) {
-            result.push_back(new MorganAtomEnv<OutputType>(
-                std::get<1>(*iter), std::get<2>(*iter), layer + 1, &mol));
+            addEnv(std::get<1>(*iter), std::get<2>(*iter), layer + 1);
             neighborhoods.insert(std::get<0>(*iter));
           }
         }
@@ -498,10 +592,70 @@ MorganEnvGenerator<OutputType>::getEnvironments(
     // so the radius can grow every iteration
     atomNeighborhoods = roundAtomNeighborhoods;
   }
+}
+}  // namespace
 
+template <typename OutputType>
+std::vector<AtomEnvironment<OutputType> *>
+MorganEnvGenerator<OutputType>::getEnvironments(
+    const ROMol &mol, FingerprintArguments *arguments,
+    const std::vector<std::uint32_t> *fromAtoms,
+    const std::vector<std::uint32_t> *,  // ignoreAtoms
+    const int,                           // confId
+    const AdditionalOutput *,            // additionalOutput
+    const std::vector<std::uint32_t> *atomInvariants,
+    const std::vector<std::uint32_t> *bondInvariants,
+    const bool  // hashResults
+) const {
+  std::vector<AtomEnvironment<OutputType> *> result;
+  if (auto *morganArguments = dynamic_cast<MorganArguments *>(arguments)) {
+    result.reserve((morganArguments->d_radius + 1) * mol.getNumAtoms());
+  }
+  MorganEnvWorkspace<OutputType> ws;
+  generateMorganEnvironments(
+      ROMolGraph(mol), arguments, fromAtoms, atomInvariants, bondInvariants,
+      ws,
+      [&](OutputType code, unsigned int atomIdx, unsigned int layer) {
+        result.push_back(
+            new MorganAtomEnv<OutputType>(code, atomIdx, layer, &mol));
+      });
   return result;
 }
 
+template <typename OutputType>
+void MorganEnvGenerator<OutputType>::fillEnvironments(
+    const ROMol &mol, FingerprintArguments *arguments,
+    FingerprintScratch<OutputType> &scratch,
+    const std::vector<std::uint32_t> *fromAtoms,
+    const std::vector<std::uint32_t> *,  // ignoreAtoms
+    const int,                           // confId
+    const AdditionalOutput *,            // additionalOutput
+    const std::vector<std::uint32_t> *atomInvariants,
+    const std::vector<std::uint32_t> *bondInvariants,
+    const bool  // hashResults
+) const {
+  auto *ws =
+      dynamic_cast<MorganEnvWorkspace<OutputType> *>(scratch.workspace.get());
+  if (!ws) {
+    ws = new MorganEnvWorkspace<OutputType>();
+    scratch.workspace.reset(ws);
+  }
+  scratch.clearEnvironments();
+  generateMorganEnvironments(
+      ROMolGraph(mol), arguments, fromAtoms, atomInvariants, bondInvariants,
+      *ws,
+      [&](OutputType code, unsigned int atomIdx, unsigned int layer) {
+        auto *env =
+            scratch.template reuseEnvironment<MorganAtomEnv<OutputType>>();
+        if (env) {
+          env->reset(code, atomIdx, layer, &mol);
+        } else {
+          scratch.addEnvironment(
+              new MorganAtomEnv<OutputType>(code, atomIdx, layer, &mol));
+        }
+      });
+}
+
 template <typename OutputType>
 std::string MorganEnvGenerator<OutputType>::infoString() const {
   return "MorganEnvironmentGenerator";
@@ -591,5 +745,56 @@ getMorganGenerator(unsigned int radius, bool countSimulation,
                    std::uint32_t fpSize, std::vector<std::uint32_t> countBounds,
                    bool ownsAtomInvGen, bool ownsBondInvGen);
 
+namespace {
+// calls addBit(bitId) for each of the environments of a CompactMol, the
+// invariants are the defaults of getMorganGenerator()
+template <typename AddBitFunc>
+void generateCompactMolBitIds(const CompactMol &mol, unsigned int radius,
+                              bool useBondTypes,
+                              bool includeRedundantEnvironments,
+                              AddBitFunc addBit) {
+  MorganArguments arguments(radius, false, false, false, {1, 2, 4, 8}, 2048,
+                            includeRedundantEnvironments, useBondTypes);
+  std::vector<std::uint32_t> atomInvariants(mol.getNumAtoms());
+  getConnectivityInvariants(mol, atomInvariants);
+  // this matches MorganBondInvGenerator without chirality
+  std::vector<std::uint32_t> bondInvariants(mol.getNumBonds(), 1);
+  if (useBondTypes) {
+    for (unsigned int i = 0; i < mol.getNumBonds(); ++i) {
+      bondInvariants[i] = static_cast<std::uint32_t>(mol.getBondType(i));
+    }
+  }
+  MorganEnvWorkspace<std::uint32_t> ws;
+  generateMorganEnvironments(
+      CompactMolGraph(mol), &arguments, nullptr, &atomInvariants,
+      &bondInvariants, ws,
+      [&](std::uint32_t code, unsigned int, unsigned int) { addBit(code); });
+}
+}  // namespace
+
+std::unique_ptr<SparseIntVect<std::uint32_t>> getSparseCountFingerprint(
+    const CompactMol &mol, unsigned int radius, bool useBondTypes,
+    bool includeRedundantEnvironments) {
+  auto res = std::make_unique<SparseIntVect<std::uint32_t>>(
+      std::numeric_limits<std::uint32_t>::max());
+  generateCompactMolBitIds(mol, radius, useBondTypes,
+                           includeRedundantEnvironments,
+                           [&res](std::uint32_t bitId) {
+                             res->setVal(bitId, res->getVal(bitId) + 1);
+                           });
+  return res;
+}
+
+std::unique_ptr<ExplicitBitVect> getFingerprint(
+    const CompactMol &mol, unsigned int radius, std::uint32_t fpSize,
+    bool useBondTypes, bool includeRedundantEnvironments) {
+  PRECONDITION(fpSize, "fpSize must be nonzero");
+  auto res = std::make_unique<ExplicitBitVect>(fpSize);
+  generateCompactMolBitIds(
+      mol, radius, useBondTypes, includeRedundantEnvironments,
+      [&res, fpSize](std::uint32_t bitId) { res->setBit(bitId % fpSize); });
+  return res;
+}
+
 }  // namespace MorganFingerprint
 }  // namespace RDKit
@@ -15,6 +15,7 @@
 #include <GraphMol/Fingerprints/FingerprintGenerator.h>
 #include <cstdint>
 namespace RDKit {
+class CompactMol;
 
 namespace MorganFingerprint {
 
@@ -38,6 +39,8 @@ class RDKIT_FINGERPRINTS_EXPORT MorganAtomInvGenerator
 
   std::vector<std::uint32_t> *getAtomInvariants(
       const ROMol &mol) const override;
+  void fillAtomInvariants(
+      const ROMol &mol, std::vector<std::uint32_t> &invariants) const override;
 
   std::string infoString() const override;
   void toJSON(boost::property_tree::ptree &pt) const override;
@@ -70,6 +73,8 @@ class RDKIT_FINGERPRINTS_EXPORT MorganFeatureAtomInvGenerator
 
   std::vector<std::uint32_t> *getAtomInvariants(
       const ROMol &mol) const override;
+  void fillAtomInvariants(
+      const ROMol &mol, std::vector<std::uint32_t> &invariants) const override;
 
   std::string infoString() const override;
   void toJSON(boost::property_tree::ptree &pt) const override;
@@ -100,6 +105,8 @@ class RDKIT_FINGERPRINTS_EXPORT MorganBondInvGenerator
 
   std::vector<std::uint32_t> *getBondInvariants(
       const ROMol &mol) const override;
+  void fillBondInvariants(
+      const ROMol &mol, std::vector<std::uint32_t> &invariants) const override;
 
   std::string infoString() const override;
   void toJSON(boost::property_tree::ptree &pt) const override;
@@ -164,9 +171,9 @@ class RDKIT_FINGERPRINTS_EXPORT MorganArguments : public FingerprintArguments {
 template <typename OutputType>
 class RDKIT_FINGERPRINTS_EXPORT MorganAtomEnv
     : public AtomEnvironment<OutputType> {
-  const OutputType d_code;
-  const unsigned int d_atomId;
-  const unsigned int d_layer;
+  OutputType d_code;
+  unsigned int d_atomId;
+  unsigned int d_layer;
   const ROMol *d_mol = nullptr;
 
  public:
@@ -191,6 +198,15 @@ class RDKIT_FINGERPRINTS_EXPORT MorganAtomEnv
   MorganAtomEnv(const std::uint32_t code, const unsigned int atomId,
                 const unsigned int layer, const ROMol *mol)
       : d_code(code), d_atomId(atomId), d_layer(layer), d_mol(mol) {}
+
+  //! reinitializes the environment so that it can be reused
+  void reset(const std::uint32_t code, const unsigned int atomId,
+             const unsigned int layer, const ROMol *mol) {
+    d_code = code;
+    d_atomId = atomId;
+    d_layer = layer;
+    d_mol = mol;
+  }
 };
 
 /**
@@ -210,6 +226,17 @@ class RDKIT_FINGERPRINTS_EXPORT MorganEnvGenerator
       const std::vector<std::uint32_t> *bondInvariants,
       const bool hashResults = false) const override;
 
+  //! reuses the environments and buffers held by the scratch
+  void fillEnvironments(const ROMol &mol, FingerprintArguments *arguments,
+                        FingerprintScratch<OutputType> &scratch,
+                        const std::vector<std::uint32_t> *fromAtoms,
+                        const std::vector<std::uint32_t> *ignoreAtoms,
+                        const int confId,
+                        const AdditionalOutput *additionalOutput,
+                        const std::vector<std::uint32_t> *atomInvariants,
+                        const std::vector<std::uint32_t> *bondInvariants,
+                        const bool hashResults = false) const override;
+
   std::string infoString() const override;
   void toJSON(boost::property_tree::ptree &pt) const override;
   void fromJSON(const boost::property_tree::ptree &pt) override;
@@ -344,6 +371,40 @@ FingerprintGenerator<OutputType> *getMorganGenerator(
       ownsBondInvGen);
 };
 
+/**
+ \brief Returns the Morgan count fingerprint of a CompactMol
+
+ The fingerprint is the same as the one from a generator created with
+ getMorganGenerator<std::uint32_t>() with the default atom and bond
+ invariants, no count simulation, no chirality, and the options provided
+ here. It is calculated directly from the CompactMol, so no ROMol needs to
+ be constructed.
+
+ \param mol the molecule
+ \param radius the number of iterations to grow the fingerprint
+ \param useBondTypes if set, bond types will be included as a part of the
+ bond invariants
+ \param includeRedundantEnvironments if set, redundant environments will be
+ included in the fingerprint
+
+ */
+RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<SparseIntVect<std::uint32_t>>
+getSparseCountFingerprint(const CompactMol &mol, unsigned int radius,
+                          bool useBondTypes = true,
+                          bool includeRedundantEnvironments = false);
+
+/**
+ \brief Returns the folded Morgan fingerprint of a CompactMol
+
+ See getSparseCountFingerprint(const CompactMol &, ...) for details.
+
+ \param fpSize size of the generated fingerprint
+
+ */
+RDKIT_FINGERPRINTS_EXPORT std::unique_ptr<ExplicitBitVect> getFingerprint(
+    const CompactMol &mol, unsigned int radius, std::uint32_t fpSize = 2048,
+    bool useBondTypes = true, bool includeRedundantEnvironments = false);
+
 }  // namespace MorganFingerprint
 }  // namespace RDKit
 
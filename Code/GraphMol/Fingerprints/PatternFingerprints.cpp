@@ -9,6 +9,7 @@
 //
 
 #include <GraphMol/RDKitBase.h>
+#include <GraphMol/CompactMol.h>
 #include <GraphMol/MolBundle.h>
 #include <GraphMol/QueryOps.h>
 #include <DataStructs/ExplicitBitVect.h>
@@ -17,6 +18,8 @@
 #include <GraphMol/Subgraphs/Subgraphs.h>
 #include <GraphMol/Subgraphs/SubgraphUtils.h>
 #include <GraphMol/Substruct/SubstructMatch.h>
+#include <GraphMol/Substruct/CompactMolQuery.h>
+#include <DataStructs/PackedBitOps.h>
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #include <RDGeneral/Invariant.h>
 #include <boost/random.hpp>
@@ -158,17 +161,7 @@ bool isTautomerBondQuery(const Bond *b) {
          description == "SingleOrAromaticBond";
 }
 
-void updatePatternFingerprint(const ROMol &mol, ExplicitBitVect &fp,
-                              unsigned int fpSize,
-                              std::vector<unsigned int> *atomCounts,
-                              ExplicitBitVect *setOnlyBits,
-                              bool tautomericFingerprint) {
-  PRECONDITION(fpSize != 0, "fpSize==0");
-  PRECONDITION(!atomCounts || atomCounts->size() >= mol.getNumAtoms(),
-               "bad atomCounts size");
-  PRECONDITION(!setOnlyBits || setOnlyBits->getNumBits() == fpSize,
-               "bad setOnlyBits size");
-
+std::vector<const ROMol *> getPatterns() {
   std::vector<const ROMol *> patts;
   patts.reserve(10);
   unsigned int idx = 0;
@@ -182,157 +175,223 @@ void updatePatternFingerprint(const ROMol &mol, ExplicitBitVect &fp,
     CHECK_INVARIANT(matcher, "bad smarts");
     patts.push_back(matcher);
   }
+  return patts;
+}
 
-  if (!mol.getRingInfo()->isFindFastOrBetter()) {
-    MolOps::fastFindRings(mol);
-  }
-
-  boost::dynamic_bitset<> isQueryAtom(mol.getNumAtoms()),
-      isQueryBond(mol.getNumBonds()), isTautomerBond(mol.getNumBonds());
-  for (const auto at : mol.atoms()) {
-    // isComplexQuery() no longer considers "AtomNull" to be complex, but for
-    // the purposes of the pattern FP, it definitely needs to be treated as a
-    // query feature.
-    if (at->hasQuery() && (at->getQuery()->getDescription() == "AtomNull" ||
-                           isComplexQuery(at))) {
-      isQueryAtom.set(at->getIdx());
-    }
-  }
-
-  for (const auto bond : mol.bonds()) {
-    if (isPatternComplexQuery(bond)) {
-      isQueryBond.set(bond->getIdx());
-      if (tautomericFingerprint && isTautomerBondQuery(bond)) {
-        isTautomerBond.set(bond->getIdx());
-      }
+// the patterns translated for searching CompactMols
+const std::vector<CompactMolQuery> &getCompactMolPatterns() {
+  static const auto patts = [] {
+    std::vector<CompactMolQuery> res;
+    for (const auto patt : getPatterns()) {
+      res.emplace_back(*patt);
     }
-  }
-
-  unsigned int pIdx = 0;
-  for (const auto patt : patts) {
-    ++pIdx;
-    std::vector<MatchVectType> matches;
-    // uniquify matches?
-    //   time for 10K molecules w/ uniquify: 5.24s
-    //   time for 10K molecules w/o uniquify: 4.87s
+    return res;
+  }();
+  return patts;
+}
 
-    SubstructMatchParameters params;
-    params.uniquify = false;
-    // raise maxMatches really high. This was the cause for github #2614.
-    // if we end up with more matches than this, we're completely hosed: :-)
-    params.maxMatches = 100000000;
-    matches = SubstructMatch(mol, *patt, params);
+// these let setPatternMatchBits() work with ROMols and CompactMols
+int getAtomicNum(const ROMol &mol, unsigned int idx) {
+  return mol.getAtomWithIdx(idx)->getAtomicNum();
+}
+int getAtomicNum(const CompactMol &mol, unsigned int idx) {
+  return mol.getAtomicNum(idx);
+}
+unsigned int getBondBetweenAtoms(const ROMol &mol, unsigned int idx1,
+                                 unsigned int idx2) {
+  return mol.getBondBetweenAtoms(idx1, idx2)->getIdx();
+}
+unsigned int getBondBetweenAtoms(const CompactMol &mol, unsigned int idx1,
+                                 unsigned int idx2) {
+  return mol.getBondBetweenAtoms(idx1, idx2);
+}
+Bond::BondType getBondType(const ROMol &mol, unsigned int idx) {
+  return mol.getBondWithIdx(idx)->getBondType();
+}
+Bond::BondType getBondType(const CompactMol &mol, unsigned int idx) {
+  return mol.getBondType(idx);
+}
+bool getBondIsAromatic(const ROMol &mol, unsigned int idx) {
+  return mol.getBondWithIdx(idx)->getIsAromatic();
+}
+bool getBondIsAromatic(const CompactMol &mol, unsigned int idx) {
+  return mol.getBondIsAromatic(idx);
+}
 
-    std::uint32_t mIdx = pIdx + patt->getNumAtoms() + patt->getNumBonds();
-    for (const auto &mv : matches) {
+// sets the bits for the matches of pattern pIdx
+template <typename MolType>
+void setPatternMatchBits(const MolType &mol, const ROMol &patt,
+                         std::uint32_t pIdx,
+                         const std::vector<MatchVectType> &matches,
+                         const boost::dynamic_bitset<> &isQueryAtom,
+                         const boost::dynamic_bitset<> &isQueryBond,
+                         const boost::dynamic_bitset<> &isTautomerBond,
+                         bool tautomericFingerprint, ExplicitBitVect &fp,
+                         unsigned int fpSize) {
+  std::uint32_t mIdx = pIdx + patt.getNumAtoms() + patt.getNumBonds();
+  for (const auto &mv : matches) {
 #ifdef VERBOSE_FINGERPRINTING
-      std::cerr << "\nPatt: " << pIdx << " | ";
+    std::cerr << "\nPatt: " << pIdx << " | ";
 #endif
-      // collect bits counting the number of occurrences of the pattern:
-      gboost::hash_combine(mIdx, 0xBEEF);
-      fp.setBit(mIdx % fpSize);
+    // collect bits counting the number of occurrences of the pattern:
+    gboost::hash_combine(mIdx, 0xBEEF);
+    fp.setBit(mIdx % fpSize);
 #ifdef VERBOSE_FINGERPRINTING
-      std::cerr << "count: " << mIdx % fpSize << " | ";
+    std::cerr << "count: " << mIdx % fpSize << " | ";
 #endif
 
-      bool isQuery = false;
-      std::uint32_t bitId = pIdx;
-      std::vector<unsigned int> amap(mv.size(), 0);
-      for (const auto &p : mv) {
+    bool isQuery = false;
+    std::uint32_t bitId = pIdx;
+    std::vector<unsigned int> amap(mv.size(), 0);
+    for (const auto &p : mv) {
 #ifdef VERBOSE_FINGERPRINTING
-        std::cerr << p.second << " ";
+      std::cerr << p.second << " ";
 #endif
-        if (isQueryAtom[p.second]) {
-          isQuery = true;
+      if (isQueryAtom[p.second]) {
+        isQuery = true;
 #ifdef VERBOSE_FINGERPRINTING
-          std::cerr << "atom query.";
+        std::cerr << "atom query.";
 #endif
-          break;
-        }
-        gboost::hash_combine(bitId,
-                             mol.getAtomWithIdx(p.second)->getAtomicNum());
-        amap[p.first] = p.second;
-      }
-      if (isQuery) {
-        continue;
+        break;
       }
-      auto tautomerBitId = bitId;
-      auto tautomerQuery = false;
-      ROMol::EDGE_ITER firstB, lastB;
-      boost::tie(firstB, lastB) = patt->getEdges();
+      gboost::hash_combine(bitId, getAtomicNum(mol, p.second));
+      amap[p.first] = p.second;
+    }
+    if (isQuery) {
+      continue;
+    }
+    auto tautomerBitId = bitId;
+    auto tautomerQuery = false;
+    ROMol::EDGE_ITER firstB, lastB;
+    boost::tie(firstB, lastB) = patt.getEdges();
 #ifdef VERBOSE_FINGERPRINTING
-      std::cerr << " bs:|| ";
+    std::cerr << " bs:|| ";
 #endif
-      while (!isQuery && firstB != lastB) {
-        const Bond *pbond = (*patt)[*firstB];
-        ++firstB;
-        const Bond *mbond = mol.getBondBetweenAtoms(
-            amap[pbond->getBeginAtomIdx()], amap[pbond->getEndAtomIdx()]);
-        const auto bondIdx = mbond->getIdx();
-
-        if (isQueryBond[bondIdx]) {
-          isQuery = true;
-          if (isTautomerBond[bondIdx]) {
-            isQuery = false;
-            tautomerQuery = true;
+    while (!isQuery && firstB != lastB) {
+      const Bond *pbond = patt[*firstB];
+      ++firstB;
+      const auto bondIdx = getBondBetweenAtoms(
+          mol, amap[pbond->getBeginAtomIdx()], amap[pbond->getEndAtomIdx()]);
+      const auto bondType = getBondType(mol, bondIdx);
+      const bool bondIsAromatic = getBondIsAromatic(mol, bondIdx);
+
+      if (isQueryBond[bondIdx]) {
+        isQuery = true;
+        if (isTautomerBond[bondIdx]) {
+          isQuery = false;
+          tautomerQuery = true;
 #ifdef VERBOSE_FINGERPRINTING
-            std::cerr << "tautomer query: " << mbond->getIdx();
+          std::cerr << "tautomer query: " << bondIdx;
 #endif
-          }
-          if (isQuery) {
+        }
+        if (isQuery) {
 #ifdef VERBOSE_FINGERPRINTING
-            std::cerr << "bond query: " << mbond->getIdx();
+          std::cerr << "bond query: " << bondIdx;
 #endif
-            break;
-          }
+          break;
         }
+      }
 
-        if (tautomericFingerprint) {
-          if (isTautomerBond[bondIdx] || mbond->getIsAromatic() ||
-              mbond->getBondType() == Bond::SINGLE ||
-              mbond->getBondType() == Bond::DOUBLE ||
-              mbond->getBondType() == Bond::AROMATIC) {
-            gboost::hash_combine(tautomerBitId, -1);
+      if (tautomericFingerprint) {
+        if (isTautomerBond[bondIdx] || bondIsAromatic ||
+            bondType == Bond::SINGLE || bondType == Bond::DOUBLE ||
+            bondType == Bond::AROMATIC) {
+          gboost::hash_combine(tautomerBitId, -1);
 #ifdef VERBOSE_FINGERPRINTING
-            std::cerr << "T ";
+          std::cerr << "T ";
 #endif
-          }
         }
+      }
 
-        if (!tautomerQuery) {
-          if (!mbond->getIsAromatic()) {
-            gboost::hash_combine(bitId, (std::uint32_t)mbond->getBondType());
+      if (!tautomerQuery) {
+        if (!bondIsAromatic) {
+          gboost::hash_combine(bitId, (std::uint32_t)bondType);
 #ifdef VERBOSE_FINGERPRINTING
-            std::cerr << mbond->getBondType() << " ";
+          std::cerr << bondType << " ";
 #endif
-          } else {
-            gboost::hash_combine(bitId, (std::uint32_t)Bond::AROMATIC);
+        } else {
+          gboost::hash_combine(bitId, (std::uint32_t)Bond::AROMATIC);
 #ifdef VERBOSE_FINGERPRINTING
-            std::cerr << Bond::AROMATIC << " ";
+          std::cerr << Bond::AROMATIC << " ";
 #endif
-          }
         }
       }
+    }
 
-      if (!isQuery) {
-        if (!tautomerQuery) {
+    if (!isQuery) {
+      if (!tautomerQuery) {
 #ifdef VERBOSE_FINGERPRINTING
-          std::cerr << " set: " << bitId << " " << bitId % fpSize;
+        std::cerr << " set: " << bitId << " " << bitId % fpSize;
 #endif
-          fp.setBit(bitId % fpSize);
-        }
-        if (tautomericFingerprint) {
+        fp.setBit(bitId % fpSize);
+      }
+      if (tautomericFingerprint) {
 #ifdef VERBOSE_FINGERPRINTING
-          std::cerr << " tset: " << tautomerBitId << " "
-                    << tautomerBitId % fpSize;
+        std::cerr << " tset: " << tautomerBitId << " "
+                  << tautomerBitId % fpSize;
 #endif
-          fp.setBit(tautomerBitId % fpSize);
-        }
+        fp.setBit(tautomerBitId % fpSize);
       }
     }
   }
 }
 
+void updatePatternFingerprint(const ROMol &mol, ExplicitBitVect &fp,
+                              unsigned int fpSize,
+                              std::vector<unsigned int> *atomCounts,
+                              ExplicitBitVect *setOnlyBits,
+                              bool tautomericFingerprint) {
+  PRECONDITION(fpSize != 0, "fpSize==0");
+  PRECONDITION(!atomCounts || atomCounts->size() >= mol.getNumAtoms(),
+               "bad atomCounts size");
+  PRECONDITION(!setOnlyBits || setOnlyBits->getNumBits() == fpSize,
+               "bad setOnlyBits size");
+
+  const auto patts = getPatterns();
+
+  if (!mol.getRingInfo()->isFindFastOrBetter()) {
+    MolOps::fastFindRings(mol);
+  }
+
+  boost::dynamic_bitset<> isQueryAtom(mol.getNumAtoms()),
+      isQueryBond(mol.getNumBonds()), isTautomerBond(mol.getNumBonds());
+  for (const auto at : mol.atoms()) {
+    // isComplexQuery() no longer considers "AtomNull" to be complex, but for
+    // the purposes of the pattern FP, it definitely needs to be treated as a
+    // query feature.
+    if (at->hasQuery() && (at->getQuery()->getDescription() == "AtomNull" ||
+                           isComplexQuery(at))) {
+      isQueryAtom.set(at->getIdx());
+    }
+  }
+
+  for (const auto bond : mol.bonds()) {
+    if (isPatternComplexQuery(bond)) {
+      isQueryBond.set(bond->getIdx());
+      if (tautomericFingerprint && isTautomerBondQuery(bond)) {
+        isTautomerBond.set(bond->getIdx());
+      }
+    }
+  }
+
+  unsigned int pIdx = 0;
+  for (const auto patt : patts) {
+    ++pIdx;
+    std::vector<MatchVectType> matches;
+    // uniquify matches?
+    //   time for 10K molecules w/ uniquify: 5.24s
+    //   time for 10K molecules w/o uniquify: 4.87s
+
+    SubstructMatchParameters params;
+    params.uniquify = false;
+    // raise maxMatches really high. This was the cause for github #2614.
+    // if we end up with more matches than this, we're completely hosed: :-)
+    params.maxMatches = 100000000;
+    matches = SubstructMatch(mol, *patt, params);
+    setPatternMatchBits(mol, *patt, pIdx, matches, isQueryAtom, isQueryBond,
+                        isTautomerBond, tautomericFingerprint, fp, fpSize);
+  }
+}
 }  // namespace
 
 // caller owns the result, it must be deleted
@@ -351,6 +410,36 @@ ExplicitBitVect *PatternFingerprintMol(const ROMol &mol, unsigned int fpSize,
   return res;
 }
 
+// caller owns the result, it must be deleted
+ExplicitBitVect *PatternFingerprintMol(const CompactMol &mol,
+                                       unsigned int fpSize,
+                                       bool tautomericFingerprint) {
+  PRECONDITION(fpSize != 0, "fpSize==0");
+  auto *res = new ExplicitBitVect(fpSize);
+  // CompactMols have no query features
+  const boost::dynamic_bitset<> isQueryAtom(mol.getNumAtoms());
+  const boost::dynamic_bitset<> isQueryBond(mol.getNumBonds());
+  const auto patts = getPatterns();
+  const auto &compactPatts = getCompactMolPatterns();
+  SubstructMatchParameters params;
+  params.uniquify = false;
+  params.maxMatches = 100000000;
+  for (unsigned int i = 0; i < patts.size(); ++i) {
+    const auto matches = SubstructMatch(mol, compactPatts[i], params);
+    setPatternMatchBits(mol, *patts[i], i + 1, matches, isQueryAtom,
+                        isQueryBond, isQueryBond, tautomericFingerprint, *res,
+                        fpSize);
+  }
+  return res;
+}
+
+void addPatternFingerprint(CompactMol &mol, unsigned int fpSize,
+                           bool tautomericFingerprint) {
+  std::unique_ptr<ExplicitBitVect> fp(
+      PatternFingerprintMol(mol, fpSize, tautomericFingerprint));
+  mol.setPatternFingerprint(PackedBitOps::packBitVect(*fp), fpSize);
+}
+
 // caller owns the result, it must be deleted
 ExplicitBitVect *PatternFingerprintMol(const MolBundle &bundle,
                                        unsigned int fpSize,
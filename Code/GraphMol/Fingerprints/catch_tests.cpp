@@ -24,7 +24,10 @@
 #include <GraphMol/Fingerprints/TopologicalTorsionGenerator.h>
 #include <GraphMol/Fingerprints/AtomPairGenerator.h>
 #include <GraphMol/Substruct/SubstructMatch.h>
+#include <GraphMol/Substruct/CompactMolQuery.h>
+#include <GraphMol/CompactMol.h>
 #include <DataStructs/ExplicitBitVect.h>
+#include <DataStructs/PackedBitOps.h>
 #include <DataStructs/BitOps.h>
 #include <string>
 
@@ -944,4 +947,42 @@ TEST_CASE("toJSON") {
     CHECK(jsonStr == jsonStr2);
     CHECK(*fp1 == *fp2);
   }
-}
\ No newline at end of file
+}
+TEST_CASE("pattern fingerprints of CompactMols") {
+  const std::vector<std::string> smis = {
+      "c1ccccc1CC(=O)O",       "C1CCC1C(=O)[O-]", "OC(=O)c1ccncc1[13CH3]",
+      "C1CC2CCC1CC2",          "c1ccc2ccccc2c1",  "[2H]OC(=O)CC*",
+      "CN1C=NC2=C1C(=O)NC=N2", "N->[Pt]",         "C"};
+  for (const auto &smi : smis) {
+    auto mol = v2::SmilesParse::MolFromSmiles(smi);
+    REQUIRE(mol);
+    CompactMol cmol(*mol);
+    for (auto tautomeric : {false, true}) {
+      INFO(smi << " " << tautomeric);
+      std::unique_ptr<ExplicitBitVect> fp(
+          PatternFingerprintMol(*mol, 1024, nullptr, nullptr, tautomeric));
+      std::unique_ptr<ExplicitBitVect> cfp(
+          PatternFingerprintMol(cmol, 1024, tautomeric));
+      CHECK(*cfp == *fp);
+    }
+  }
+  SECTION("screening") {
+    auto mol = "c1ccccc1CC(=O)O"_smiles;
+    REQUIRE(mol);
+    CompactMol cmol(*mol);
+    addPatternFingerprint(cmol);
+    REQUIRE(cmol.hasPatternFingerprint());
+    CHECK(cmol.getPatternFingerprintSize() == 2048);
+    for (const auto &[sma, numMatches] :
+         std::vector<std::pair<std::string, unsigned int>>{
+             {"c1ccccc1C", 1}, {"C(=O)[OH]", 1}, {"C1CCCCC1", 0}, {"N", 0}}) {
+      auto query = v2::SmilesParse::MolFromSmarts(sma);
+      REQUIRE(query);
+      CompactMolQuery cquery(*query);
+      std::unique_ptr<ExplicitBitVect> qfp(PatternFingerprintMol(*query));
+      cquery.setPatternFingerprint(PackedBitOps::packBitVect(*qfp),
+                                   qfp->getNumBits());
+      CHECK(SubstructMatch(cmol, cquery).size() == numMatches);
+    }
+  }
+}
@@ -22,6 +22,8 @@
 #include <GraphMol/Fingerprints/RDKitFPGenerator.h>
 #include <GraphMol/Fingerprints/TopologicalTorsionGenerator.h>
 #include <GraphMol/Fingerprints/FingerprintGenerator.h>
+#include <GraphMol/CompactMol.h>
+#include <DataStructs/BitOps.h>
 
 #include <GraphMol/FileParsers/MolSupplier.h>
 #include <GraphMol/FileParsers/FileParsers.h>
@@ -558,3 +560,197 @@ TEST_CASE("RDKit fingerprinter and ignoreAtoms") {
       fpg->getSparseFingerprint(*mol, funcArgs)};
   CHECK(fp3->getNumOnBits() == 0);
 }
+
+TEST_CASE("Morgan fingerprints of CompactMols") {
+  const std::vector<std::string> smis = {
+      "CC(=O)O",        "c1ccccc1CC(=O)[O-]",  "OC(=O)c1ccncc1[13CH3]",
+      "[2H]OC([2H])=O", "C1CC2CCC1CC2.[Na+]", "[H]C([H])([H])C#N",
+      "N->[Pt]",        "[CH2]C=C/C=C/Cl",     "C"};
+  for (const auto &smi : smis) {
+    v2::SmilesParse::SmilesParserParams ps;
+    ps.removeHs = false;
+    auto mol = v2::SmilesParse::MolFromSmiles(smi, ps);
+    REQUIRE(mol);
+    CompactMol cmol(*mol);
+    for (auto radius : {0u, 1u, 2u, 3u}) {
+      for (auto useBondTypes : {true, false}) {
+        for (auto includeRedundantEnvironments : {false, true}) {
+          INFO(smi << " " << radius << " " << useBondTypes << " "
+                   << includeRedundantEnvironments);
+          std::unique_ptr<FingerprintGenerator<std::uint32_t>> fpgen{
+              MorganFingerprint::getMorganGenerator<std::uint32_t>(
+                  radius, false, false, useBondTypes, false,
+                  includeRedundantEnvironments)};
+          std::unique_ptr<SparseIntVect<std::uint32_t>> expected{
+              fpgen->getSparseCountFingerprint(*mol)};
+          auto fp = MorganFingerprint::getSparseCountFingerprint(
+              cmol, radius, useBondTypes, includeRedundantEnvironments);
+          CHECK(*fp == *expected);
+
+          std::unique_ptr<ExplicitBitVect> expectedBits{
+              fpgen->getFingerprint(*mol)};
+          auto bits = MorganFingerprint::getFingerprint(
+              cmol, radius, 2048, useBondTypes, includeRedundantEnvironments);
+          CHECK(*bits == *expectedBits);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("fingerprinting with a reused scratch") {
+  const std::vector<std::string> smis = {
+      "CC(=O)O",           "c1ccccc1CC(=O)[O-]", "C[C@H](F)Cl",
+      "N[C@@H](C)C(=O)O",  "C/C=C/C=C\\Cl",      "C1CC2CCC1CC2.[Na+]",
+      "OC(=O)c1ccncc1[13CH3]", "C",              "c1ccc2ccccc2c1CCN"};
+  std::vector<std::unique_ptr<RWMol>> mols;
+  for (const auto &smi : smis) {
+    mols.emplace_back(SmilesToMol(smi));
+    REQUIRE(mols.back());
+  }
+  MorganFingerprint::MorganFeatureAtomInvGenerator featureInvGen;
+  std::vector<std::unique_ptr<FingerprintGenerator<std::uint64_t>>> fpgs;
+  fpgs.emplace_back(MorganFingerprint::getMorganGenerator<std::uint64_t>(2));
+  fpgs.emplace_back(MorganFingerprint::getMorganGenerator<std::uint64_t>(
+      3, true, true, true, false, nullptr, nullptr, 1024));
+  fpgs.emplace_back(MorganFingerprint::getMorganGenerator<std::uint64_t>(
+      2, false, false, true, true, &featureInvGen));
+  fpgs.emplace_back(RDKitFP::getRDKitFPGenerator<std::uint64_t>(1, 5));
+  fpgs.emplace_back(AtomPair::getAtomPairGenerator<std::uint64_t>());
+  fpgs.emplace_back(
+      TopologicalTorsion::getTopologicalTorsionGenerator<std::uint64_t>());
+
+  // the same scratch is used with all the generators and molecules
+  FingerprintScratch<std::uint64_t> scratch;
+  for (const auto &fpg : fpgs) {
+    for (unsigned int idx = 0; idx < mols.size(); ++idx) {
+      INFO(fpg->infoString() << " " << smis[idx]);
+      const auto &mol = mols[idx];
+      FingerprintFuncArguments args;
+      std::unique_ptr<ExplicitBitVect> expected{fpg->getFingerprint(*mol)};
+      auto fp = fpg->getFingerprint(*mol, args, scratch);
+      CHECK(*fp == *expected);
+
+      std::unique_ptr<SparseIntVect<std::uint64_t>> expectedSparseCounts{
+          fpg->getSparseCountFingerprint(*mol)};
+      auto sparseCounts = fpg->getSparseCountFingerprint(*mol, args, scratch);
+      CHECK(*sparseCounts == *expectedSparseCounts);
+
+      std::unique_ptr<SparseIntVect<std::uint32_t>> expectedCounts{
+          fpg->getCountFingerprint(*mol)};
+      auto counts = fpg->getCountFingerprint(*mol, args, scratch);
+      CHECK(*counts == *expectedCounts);
+
+      std::unique_ptr<SparseBitVect> expectedSparse{
+          fpg->getSparseFingerprint(*mol)};
+      auto sparse = fpg->getSparseFingerprint(*mol, args, scratch);
+      CHECK(*sparse == *expectedSparse);
+
+      std::vector<std::uint64_t> words((expected->getNumBits() + 63) / 64,
+                                       ~0ULL);
+      fpg->getFingerprintAsWords(*mol, args, scratch, words.data());
+      for (unsigned int i = 0; i < expected->getNumBits(); ++i) {
+        CHECK(((words[i / 64] >> (i % 64)) & 1) == (*expected)[i]);
+      }
+    }
+  }
+  SECTION("additional output and fromAtoms") {
+    auto &fpg = fpgs[0];
+    for (unsigned int idx = 0; idx < mols.size(); ++idx) {
+      INFO(smis[idx]);
+      const auto &mol = mols[idx];
+      std::vector<std::uint32_t> fromAtoms = {0};
+      AdditionalOutput expectedAO;
+      expectedAO.allocateBitInfoMap();
+      expectedAO.allocateAtomCounts();
+      FingerprintFuncArguments expectedArgs(&fromAtoms, nullptr, -1,
+                                            &expectedAO, nullptr, nullptr);
+      auto expected = fpg->getFingerprint(*mol, expectedArgs);
+
+      AdditionalOutput ao;
+      ao.allocateBitInfoMap();
+      ao.allocateAtomCounts();
+      FingerprintFuncArguments args(&fromAtoms, nullptr, -1, &ao, nullptr,
+                                    nullptr);
+      auto fp = fpg->getFingerprint(*mol, args, scratch);
+      CHECK(*fp == *expected);
+      CHECK(*ao.bitInfoMap == *expectedAO.bitInfoMap);
+      CHECK(*ao.atomCounts == *expectedAO.atomCounts);
+    }
+  }
+  SECTION("multithreaded") {
+    std::vector<const ROMol *> molPtrs;
+    for (unsigned int i = 0; i < 20; ++i) {
+      for (const auto &mol : mols) {
+        molPtrs.push_back(mol.get());
+      }
+    }
+    for (const auto &fpg : fpgs) {
+      auto serial = fpg->getFingerprints(molPtrs, 1);
+      auto threaded = fpg->getFingerprints(molPtrs, 4);
+      REQUIRE(serial.size() == threaded.size());
+      for (unsigned int i = 0; i < serial.size(); ++i) {
+        CHECK(*serial[i] == *threaded[i]);
+      }
+      auto serialCounts = fpg->getSparseCountFingerprints(molPtrs, 1);
+      auto threadedCounts = fpg->getSparseCountFingerprints(molPtrs, 4);
+      REQUIRE(serialCounts.size() == threadedCounts.size());
+      for (unsigned int i = 0; i < serialCounts.size(); ++i) {
+        CHECK(*serialCounts[i] == *threadedCounts[i]);
+      }
+    }
+  }
+}
+
+TEST_CASE("fingerprint values with a reused scratch") {
+  // these were generated before FingerprintScratch was added
+  auto mol = "CC(=O)Nc1ccc(O)cc1"_smiles;
+  REQUIRE(mol);
+  std::vector<std::unique_ptr<FingerprintGenerator<std::uint64_t>>> fpgs;
+  fpgs.emplace_back(MorganFingerprint::getMorganGenerator<std::uint64_t>(
+      2, false, false, true, false, nullptr, nullptr, 512));
+  // the RDKit fingerprint sets two bits per feature
+  fpgs.emplace_back(RDKitFP::getRDKitFPGenerator<std::uint64_t>(
+      1, 5, true, true, true, nullptr, false, {1, 2, 4, 8}, 512));
+  fpgs.emplace_back(AtomPair::getAtomPairGenerator<std::uint64_t>(
+      1, 30, false, true, nullptr, true, 512));
+  fpgs.emplace_back(
+      TopologicalTorsion::getTopologicalTorsionGenerator<std::uint64_t>(
+          false, 4, nullptr, true, 512));
+  const std::vector<std::pair<unsigned int, std::string>> expected = {
+      {19,
+       "0000040002002000040000000000000001040000000000800000400000022400"
+       "0000000182000000000802001000002000000000000000000000000000000002"},
+      {86,
+       "0600030404020820011002028108011a80596000022010002420011000584091"
+       "000004114602004110048a09028048210800400280004884026080a52200208c"},
+      {52,
+       "0000300013101000010003301000030000000030000000300003003007000030"
+       "0100001001000003030001110100000001000000000000003000000370001033"},
+      {12,
+       "0300000000000000000000000000000000000000000000000000000000000000"
+       "0000000000000000000000003000007000000030000000000000000100003000"},
+  };
+  FingerprintScratch<std::uint64_t> scratch;
+  // fingerprint a second molecule with the same scratch first
+  auto other = "c1ccc2ccccc2c1CCN"_smiles;
+  REQUIRE(other);
+  for (unsigned int i = 0; i < fpgs.size(); ++i) {
+    INFO(fpgs[i]->infoString());
+    FingerprintFuncArguments args;
+    fpgs[i]->getFingerprint(*other, args, scratch);
+    auto fp = fpgs[i]->getFingerprint(*mol, args, scratch);
+    CHECK(fp->getNumOnBits() == expected[i].first);
+    CHECK(BitVectToFPSText(*fp) == expected[i].second);
+  }
+
+  auto counts = fpgs[0]->getSparseCountFingerprint(*mol);
+  const std::map<std::uint64_t, int> expectedCounts = {
+      {26234434, 1},   {43357009, 1},   {353395765, 1},  {411967733, 1},
+      {847961216, 1},  {859799282, 1},  {864662311, 1},  {864942730, 1},
+      {951226070, 4},  {1510328189, 1}, {1790668568, 1}, {2246699815, 1},
+      {2246728737, 1}, {2560252747, 2}, {2629723425, 2}, {2734098962, 1},
+      {2905660137, 1}, {3217380708, 2}, {3218693969, 4}, {3545365497, 1},
+      {3918336191, 1}};
+  CHECK(counts->getNonzeroElements() == expectedCounts);
+}
@@ -13,20 +13,75 @@
 #include <GraphMol/ROMol.h>
 #include <ForceField/ForceField.h>
 #include <RDGeneral/RDThreads.h>
+#include <algorithm>
+#include <numeric>
 
 namespace RDKit {
 class ROMol;
 namespace ForceFieldsHelper {
 namespace detail {
+//! the number of conformers which are minimized together; the BFGS
+//! minimizer needs an inverse Hessian for each of them, so fewer are
+//! used for large molecules
+inline unsigned int getConformerBatchSize(unsigned int numAtoms) {
+  constexpr std::size_t maxHessianBytes = 64 * 1024 * 1024;
+  const std::size_t dim = 3 * std::max(numAtoms, 1u);
+  const std::size_t hessianBytes = dim * dim * sizeof(double);
+  return static_cast<unsigned int>(std::max<std::size_t>(
+      1, std::min<std::size_t>(16, maxHessianBytes / hessianBytes)));
+}
+
+//! minimizes a set of conformers together, see ForceField::minimizeBatch()
+inline void OptimizeConformerBatch_(ROMol &mol, ForceFields::ForceField &ff,
+                                    const std::vector<unsigned int> &confIdxs,
+                                    std::vector<std::pair<int, double>> &res,
+                                    int maxIters) {
+  PRECONDITION(res.size() >= mol.getNumConformers(),
+               "res.size() must be >= mol.getNumConformers()");
+  if (confIdxs.empty()) {
+    return;
+  }
+  std::vector<Conformer *> confs;
+  confs.reserve(mol.getNumConformers());
+  for (auto cit = mol.beginConformers(); cit != mol.endConformers(); ++cit) {
+    confs.push_back(cit->get());
+  }
+  std::vector<RDGeom::PointPtrVect> positions(confIdxs.size());
+  for (unsigned int i = 0; i < confIdxs.size(); ++i) {
+    auto &confPositions = confs[confIdxs[i]]->getPositions();
+    for (auto &pt : confPositions) {
+      positions[i].push_back(&pt);
+    }
+  }
+  ff.positions() = positions.front();
+  ff.initialize();
+  std::vector<double> energies;
+  auto needsMore = ff.minimizeBatch(positions, maxIters, 1e-4, 1e-6,
+                                    getConformerBatchSize(mol.getNumAtoms()),
+                                    &energies);
+  for (unsigned int i = 0; i < confIdxs.size(); ++i) {
+    res[confIdxs[i]] = std::make_pair(needsMore[i], energies[i]);
+  }
+}
+
 #ifdef RDK_BUILD_THREADSAFE_SSS
 inline void OptimizeMoleculeConfsHelper_(
     ForceFields::ForceField ff, ROMol *mol,
     std::vector<std::pair<int, double>> *res, unsigned int threadIdx,
-    unsigned int numThreads, int maxIters) {
+    unsigned int numThreads, int maxIters, bool batched) {
   PRECONDITION(mol, "mol must not be nullptr");
   PRECONDITION(res, "res must not be nullptr");
   PRECONDITION(res->size() >= mol->getNumConformers(),
                "res->size() must be >= mol->getNumConformers()");
+  if (batched) {
+    std::vector<unsigned int> confIdxs;
+    for (unsigned int i = threadIdx; i < mol->getNumConformers();
+         i += numThreads) {
+      confIdxs.push_back(i);
+    }
+    OptimizeConformerBatch_(*mol, ff, confIdxs, *res, maxIters);
+    return;
+  }
   unsigned int i = 0;
   ff.positions().resize(mol->getNumAtoms());
   for (ROMol::ConformerIterator cit = mol->beginConformers();
@@ -47,11 +102,12 @@ inline void OptimizeMoleculeConfsHelper_(
 inline void OptimizeMoleculeConfsMT(ROMol &mol,
                                     const ForceFields::ForceField &ff,
                                     std::vector<std::pair<int, double>> &res,
-                                    int numThreads, int maxIters) {
+                                    int numThreads, int maxIters,
+                                    bool batched) {
   std::vector<std::thread> tg;
   for (int ti = 0; ti < numThreads; ++ti) {
     tg.emplace_back(std::thread(detail::OptimizeMoleculeConfsHelper_, ff, &mol,
-                                &res, ti, numThreads, maxIters));
+                                &res, ti, numThreads, maxIters, batched));
   }
   for (auto &thread : tg) {
     if (thread.joinable()) {
@@ -63,9 +119,15 @@ inline void OptimizeMoleculeConfsMT(ROMol &mol,
 
 inline void OptimizeMoleculeConfsST(ROMol &mol, ForceFields::ForceField &ff,
                                     std::vector<std::pair<int, double>> &res,
-                                    int maxIters) {
+                                    int maxIters, bool batched) {
   PRECONDITION(res.size() >= mol.getNumConformers(),
                "res.size() must be >= mol.getNumConformers()");
+  if (batched) {
+    std::vector<unsigned int> confIdxs(mol.getNumConformers());
+    std::iota(confIdxs.begin(), confIdxs.end(), 0u);
+    OptimizeConformerBatch_(mol, ff, confIdxs, res, maxIters);
+    return;
+  }
   unsigned int i = 0;
   for (ROMol::ConformerIterator cit = mol.beginConformers();
        cit != mol.endConformers(); ++cit, ++i) {
@@ -111,19 +173,25 @@ inline std::pair<int, double> OptimizeMolecule(ForceFields::ForceField &ff,
                     If set to zero, the max supported by the system will be
   used.
   \param maxIters   the maximum number of force-field iterations
+  \param batched    if true, each thread minimizes its conformers together,
+                    see ForceField::minimizeBatch(). The results can differ
+                    slightly from those of minimizing the conformers one at
+                    a time.
 
 */
 inline void OptimizeMoleculeConfs(ROMol &mol, ForceFields::ForceField &ff,
                                   std::vector<std::pair<int, double>> &res,
-                                  int numThreads = 1, int maxIters = 1000) {
+                                  int numThreads = 1, int maxIters = 1000,
+                                  bool batched = false) {
   res.resize(mol.getNumConformers());
   numThreads = getNumThreadsToUse(numThreads);
   if (numThreads == 1) {
-    detail::OptimizeMoleculeConfsST(mol, ff, res, maxIters);
+    detail::OptimizeMoleculeConfsST(mol, ff, res, maxIters, batched);
   }
 #ifdef RDK_BUILD_THREADSAFE_SSS
   else {
-    detail::OptimizeMoleculeConfsMT(mol, ff, res, numThreads, maxIters);
+    detail::OptimizeMoleculeConfsMT(mol, ff, res, numThreads, maxIters,
+                                    batched);
   }
 #endif
 }
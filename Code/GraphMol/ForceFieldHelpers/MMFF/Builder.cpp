@@ -7,6 +7,7 @@
 //  of the RDKit source tree.
 //
 #include <cmath>
+#include <map>
 
 #include <RDGeneral/Invariant.h>
 #include <GraphMol/RDKitBase.h>
@@ -14,6 +15,7 @@
 #include <GraphMol/Substruct/SubstructMatch.h>
 #include <ForceField/MMFF/Params.h>
 #include <ForceField/MMFF/Contribs.h>
+#include <Numerics/Optimizer/LBFGSOpt.h>
 #include "AtomTyper.h"
 #include "Builder.h"
 
@@ -1079,34 +1081,120 @@ void addNonbonded(const ROMol &mol, int confId,
   }
 }
 
-}  // end of namespace Tools
-
-// ------------------------------------------------------------------------
-//
-//
-//
-// ------------------------------------------------------------------------
-ForceFields::ForceField *constructForceField(ROMol &mol, double nonBondedThresh,
-                                             int confId,
-                                             bool ignoreInterfragInteractions) {
-  MMFFMolProperties mmffMolProperties(mol);
-  PRECONDITION(mmffMolProperties.isValid(),
+void addNonbondedWithCutoff(const ROMol &mol,
+                            MMFFMolProperties *mmffMolProperties,
+                            ForceFields::ForceField *field,
+                            double nonBondedCutoff, double skin,
+                            bool ignoreInterfragInteractions) {
+  PRECONDITION(field, "bad ForceField");
+  PRECONDITION(mmffMolProperties, "bad MMFFMolProperties");
+  PRECONDITION(mmffMolProperties->isValid(),
                "missing atom types - invalid force-field");
-  ForceFields::ForceField *res =
-      constructForceField(mol, &mmffMolProperties, nonBondedThresh, confId,
-                          ignoreInterfragInteractions);
+  PRECONDITION(nonBondedCutoff > 0.0, "bad cutoff");
 
-  return res;
+  const bool useVdW = mmffMolProperties->getMMFFVdWTerm();
+  const bool useEle = mmffMolProperties->getMMFFEleTerm();
+  if (!useVdW && !useEle) {
+    return;
+  }
+  unsigned int nAtoms = mol.getNumAtoms();
+  auto contrib = std::make_unique<NonbondedCutoffContrib>(
+      field, nonBondedCutoff, skin,
+      mmffMolProperties->getMMFFDielectricModel(),
+      mmffMolProperties->getMMFFDielectricConstant());
+
+  // the vdW parameters only depend on the atom types, so we only need
+  // them for the pairs of atom types which are present. vdWTypes maps
+  // each MMFF atom type to its index in the parameter table (or -1):
+  std::map<unsigned int, int> vdWTypes;
+  std::vector<unsigned int> vdWTypeAtoms;
+  bool hasContrib = false;
+  for (unsigned int i = 0; i < nAtoms; ++i) {
+    int vdWType = -1;
+    if (useVdW) {
+      const unsigned int atomType = mmffMolProperties->getMMFFAtomType(i);
+      auto it = vdWTypes.find(atomType);
+      if (it == vdWTypes.end()) {
+        MMFFVdWRijstarEps mmffVdWConstants;
+        int newType = -1;
+        if (mmffMolProperties->getMMFFVdWParams(i, i, mmffVdWConstants)) {
+          newType = vdWTypeAtoms.size();
+          vdWTypeAtoms.push_back(i);
+        }
+        it = vdWTypes.emplace(atomType, newType).first;
+      }
+      vdWType = it->second;
+    }
+    double partialCharge = 0.0;
+    if (useEle && !isDoubleZero(mmffMolProperties->getMMFFPartialCharge(i))) {
+      partialCharge = mmffMolProperties->getMMFFPartialCharge(i);
+    }
+    contrib->setAtomParams(i, vdWType, partialCharge);
+    hasContrib |= (vdWType >= 0 || partialCharge != 0.0);
+  }
+  if (!hasContrib) {
+    return;
+  }
+  for (unsigned int ti = 0; ti < vdWTypeAtoms.size(); ++ti) {
+    for (unsigned int tj = ti; tj < vdWTypeAtoms.size(); ++tj) {
+      MMFFVdWRijstarEps mmffVdWConstants;
+      mmffMolProperties->getMMFFVdWParams(vdWTypeAtoms[ti], vdWTypeAtoms[tj],
+                                          mmffVdWConstants);
+      contrib->setVdWParams(ti, tj, mmffVdWConstants);
+    }
+  }
+
+  // 1,2 and 1,3 pairs are excluded, 1,4 pairs are scaled. The topological
+  // distances are found with a breadth-first search from each atom
+  // instead of the full neighbor matrix, which is quadratic in size:
+  std::vector<int> topoDists(nAtoms, -1);
+  std::vector<unsigned int> visited;
+  std::vector<unsigned int> frontier;
+  std::vector<unsigned int> nextFrontier;
+  for (unsigned int i = 0; i < nAtoms; ++i) {
+    topoDists[i] = 0;
+    visited.assign(1, i);
+    frontier.assign(1, i);
+    for (int depth = 1; depth <= 3 && !frontier.empty(); ++depth) {
+      nextFrontier.clear();
+      for (const auto idx : frontier) {
+        for (const auto nbr : mol.atomNeighbors(mol.getAtomWithIdx(idx))) {
+          const unsigned int nbrIdx = nbr->getIdx();
+          if (topoDists[nbrIdx] < 0) {
+            topoDists[nbrIdx] = depth;
+            visited.push_back(nbrIdx);
+            nextFrontier.push_back(nbrIdx);
+          }
+        }
+      }
+      frontier.swap(nextFrontier);
+    }
+    for (const auto j : visited) {
+      if (j > i) {
+        if (topoDists[j] < 3) {
+          contrib->addExcludedPair(i, j);
+        } else {
+          contrib->add1_4Pair(i, j);
+        }
+      }
+      topoDists[j] = -1;
+    }
+  }
+
+  if (ignoreInterfragInteractions) {
+    INT_VECT fragMapping;
+    MolOps::getMolFrags(mol, fragMapping);
+    contrib->setFragments(std::move(fragMapping));
+  }
+  field->contribs().push_back(ForceFields::ContribPtr(contrib.release()));
 }
 
-// ------------------------------------------------------------------------
-//
-//
-//
-// ------------------------------------------------------------------------
-ForceFields::ForceField *constructForceField(
-    ROMol &mol, MMFFMolProperties *mmffMolProperties, double nonBondedThresh,
-    int confId, bool ignoreInterfragInteractions) {
+}  // end of namespace Tools
+
+namespace {
+// creates a force field with all terms except for the non-bonded ones
+std::unique_ptr<ForceFields::ForceField> constructBondedForceField(
+    ROMol &mol, MMFFMolProperties *mmffMolProperties, int confId) {
   PRECONDITION(mmffMolProperties, "bad MMFFMolProperties");
   PRECONDITION(mmffMolProperties->isValid(),
                "missing atom types - invalid force-field");
@@ -1134,6 +1222,37 @@ ForceFields::ForceField *constructForceField(
   if (mmffMolProperties->getMMFFTorsionTerm()) {
     Tools::addTorsions(mol, mmffMolProperties, res.get());
   }
+  return res;
+}
+}  // namespace
+
+// ------------------------------------------------------------------------
+//
+//
+//
+// ------------------------------------------------------------------------
+ForceFields::ForceField *constructForceField(ROMol &mol, double nonBondedThresh,
+                                             int confId,
+                                             bool ignoreInterfragInteractions) {
+  MMFFMolProperties mmffMolProperties(mol);
+  PRECONDITION(mmffMolProperties.isValid(),
+               "missing atom types - invalid force-field");
+  ForceFields::ForceField *res =
+      constructForceField(mol, &mmffMolProperties, nonBondedThresh, confId,
+                          ignoreInterfragInteractions);
+
+  return res;
+}
+
+// ------------------------------------------------------------------------
+//
+//
+//
+// ------------------------------------------------------------------------
+ForceFields::ForceField *constructForceField(
+    ROMol &mol, MMFFMolProperties *mmffMolProperties, double nonBondedThresh,
+    int confId, bool ignoreInterfragInteractions) {
+  auto res = constructBondedForceField(mol, mmffMolProperties, confId);
   if (mmffMolProperties->getMMFFVdWTerm() ||
       mmffMolProperties->getMMFFEleTerm()) {
     boost::shared_array<std::uint8_t> neighborMat =
@@ -1144,5 +1263,35 @@ ForceFields::ForceField *constructForceField(
 
   return res.release();
 }
+
+// ------------------------------------------------------------------------
+//
+//
+//
+// ------------------------------------------------------------------------
+ForceFields::ForceField *constructForceFieldWithCutoff(
+    ROMol &mol, MMFFMolProperties *mmffMolProperties, double nonBondedCutoff,
+    double skin, int confId, bool ignoreInterfragInteractions) {
+  auto res = constructBondedForceField(mol, mmffMolProperties, confId);
+  Tools::addNonbondedWithCutoff(mol, mmffMolProperties, res.get(),
+                                nonBondedCutoff, skin,
+                                ignoreInterfragInteractions);
+  // avoid the storage which grows quadratically with the number of atoms:
+  // the distance matrix and the inverse Hessian of the dense BFGS minimizer
+  res->setUseDistanceMatrix(false);
+  res->setNumLBFGSCorrections(BFGSOpt::LBFGS_CORRECTIONS);
+  return res.release();
+}
+
+ForceFields::ForceField *constructForceFieldWithCutoff(
+    ROMol &mol, double nonBondedCutoff, double skin, int confId,
+    bool ignoreInterfragInteractions) {
+  MMFFMolProperties mmffMolProperties(mol);
+  PRECONDITION(mmffMolProperties.isValid(),
+               "missing atom types - invalid force-field");
+  return constructForceFieldWithCutoff(mol, &mmffMolProperties,
+                                       nonBondedCutoff, skin, confId,
+                                       ignoreInterfragInteractions);
+}
 }  // namespace MMFF
 }  // namespace RDKit
@@ -77,6 +77,47 @@ RDKIT_FORCEFIELDHELPERS_EXPORT ForceFields::ForceField *constructForceField(
     double nonBondedThresh = 100.0, int confId = -1,
     bool ignoreInterfragInteractions = true);
 
+//! Builds and returns a MMFF force field for a molecule which evaluates the
+//! non-bonded terms with a distance cutoff
+/*!
+  Rather than adding a term for every non-bonded atom pair, the non-bonded
+  interactions are found during the minimization using a neighbor list, see
+  ForceFields::MMFF::NonbondedCutoffContrib. This keeps the memory use and the
+  cost of the non-bonded terms roughly linear in the number of atoms, which
+  makes it the better choice for large systems.
+
+  For the same reason the force field does not use a distance matrix (see
+  ForceFields::ForceField::setUseDistanceMatrix()) and minimize() uses the
+  L-BFGS minimizer with BFGSOpt::LBFGS_CORRECTIONS corrections (see
+  ForceFields::ForceField::setNumLBFGSCorrections()).
+
+  \param mol              the molecule to use
+  \param mmffMolProperties pointer to a MMFFMolProperties object
+  \param nonBondedCutoff  non-bonded contacts which are longer than this
+                          (in Angstrom) make no contribution, the
+                          interactions are switched off smoothly over the
+                          last Angstrom before it
+  \param skin             the skin distance of the neighbor list: it is
+                          rebuilt when an atom has moved by more than half
+                          of this since the last build
+  \param confId           the optional conformer id, if this isn't provided,
+                          the molecule's default confId will be used.
+  \param ignoreInterfragInteractions if true, nonbonded terms will not be
+                          added between fragments
+
+  \return the new force field. The client is responsible for free'ing this.
+*/
+RDKIT_FORCEFIELDHELPERS_EXPORT ForceFields::ForceField *
+constructForceFieldWithCutoff(ROMol &mol, MMFFMolProperties *mmffMolProperties,
+                              double nonBondedCutoff, double skin = 2.0,
+                              int confId = -1,
+                              bool ignoreInterfragInteractions = true);
+//! \overload
+RDKIT_FORCEFIELDHELPERS_EXPORT ForceFields::ForceField *
+constructForceFieldWithCutoff(ROMol &mol, double nonBondedCutoff,
+                              double skin = 2.0, int confId = -1,
+                              bool ignoreInterfragInteractions = true);
+
 namespace Tools {
 class RDKIT_FORCEFIELDHELPERS_EXPORT DefaultTorsionBondSmarts {
  public:
@@ -133,6 +174,10 @@ RDKIT_FORCEFIELDHELPERS_EXPORT void addEle(
     ForceFields::ForceField *field,
     boost::shared_array<std::uint8_t> neighborMatrix,
     double nonBondedThresh = 100.0, bool ignoreInterfragInteractions = true);
+RDKIT_FORCEFIELDHELPERS_EXPORT void addNonbondedWithCutoff(
+    const ROMol &mol, MMFFMolProperties *mmffMolProperties,
+    ForceFields::ForceField *field, double nonBondedCutoff, double skin = 2.0,
+    bool ignoreInterfragInteractions = true);
 }  // namespace Tools
 }  // namespace MMFF
 }  // namespace RDKit
@@ -76,6 +76,8 @@ inline std::pair<int, double> MMFFOptimizeMolecule(
   \param ignoreInterfragInteractions if true, nonbonded terms will not be added
   between
                                      fragments
+  \param batched    if true, the conformers are minimized together, see
+                    ForceFieldsHelper::OptimizeMoleculeConfs()
 
 */
 inline void MMFFOptimizeMoleculeConfs(ROMol &mol,
@@ -83,14 +85,15 @@ inline void MMFFOptimizeMoleculeConfs(ROMol &mol,
                                       int numThreads = 1, int maxIters = 1000,
                                       std::string mmffVariant = "MMFF94",
                                       double nonBondedThresh = 10.0,
-                                      bool ignoreInterfragInteractions = true) {
+                                      bool ignoreInterfragInteractions = true,
+                                      bool batched = false) {
   MMFF::MMFFMolProperties mmffMolProperties(mol, mmffVariant);
   if (mmffMolProperties.isValid()) {
     std::unique_ptr<ForceFields::ForceField> ff(
         MMFF::constructForceField(mol, &mmffMolProperties, nonBondedThresh, -1,
                                   ignoreInterfragInteractions));
     ForceFieldsHelper::OptimizeMoleculeConfs(mol, *ff, res, numThreads,
-                                             maxIters);
+                                             maxIters, batched);
   } else {
     res.resize(mol.getNumConformers());
     for (unsigned int i = 0; i < mol.getNumConformers(); ++i) {
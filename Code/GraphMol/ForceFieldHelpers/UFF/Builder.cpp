@@ -16,6 +16,7 @@
 #include <ForceField/ForceField.h>
 #include <ForceField/UFF/Params.h>
 #include <ForceField/UFF/Contribs.h>
+#include <Numerics/Optimizer/LBFGSOpt.h>
 
 #include "AtomTyper.h"
 #include "Builder.h"
@@ -469,6 +470,39 @@ void addNonbonded(const ROMol &mol, int confId, const AtomicParamVect &params,
   }
 }
 
+void addNonbondedWithCutoff(const ROMol &mol, const AtomicParamVect &params,
+                            ForceFields::ForceField *field, double vdwCutoff,
+                            double skin, bool ignoreInterfragInteractions) {
+  PRECONDITION(mol.getNumAtoms() == params.size(), "bad parameters");
+  PRECONDITION(field, "bad forcefield");
+  PRECONDITION(vdwCutoff > 0.0, "bad cutoff");
+
+  auto contrib =
+      std::make_unique<vdWCutoffContrib>(field, vdwCutoff, skin);
+  unsigned int nAtoms = mol.getNumAtoms();
+  for (unsigned int i = 0; i < nAtoms; i++) {
+    contrib->setAtomParams(i, params[i]);
+  }
+  // 1,2 and 1,3 pairs are excluded:
+  for (const auto atom : mol.atoms()) {
+    const unsigned int idx = atom->getIdx();
+    for (const auto nbr1 : mol.atomNeighbors(atom)) {
+      contrib->addExcludedPair(idx, nbr1->getIdx());
+      for (const auto nbr2 : mol.atomNeighbors(atom)) {
+        if (nbr2->getIdx() > nbr1->getIdx()) {
+          contrib->addExcludedPair(nbr1->getIdx(), nbr2->getIdx());
+        }
+      }
+    }
+  }
+  if (ignoreInterfragInteractions) {
+    INT_VECT fragMapping;
+    MolOps::getMolFrags(mol, fragMapping);
+    contrib->setFragments(std::move(fragMapping));
+  }
+  field->contribs().push_back(ForceFields::ContribPtr(contrib.release()));
+}
+
 const std::string DefaultTorsionBondSmarts::ds_string =
     "[!$(*#*)&!D1]~[!$(*#*)&!D1]";
 boost::scoped_ptr<const ROMol> DefaultTorsionBondSmarts::ds_instance;
@@ -705,6 +739,56 @@ ForceFields::ForceField *constructForceField(ROMol &mol,
   return res.release();
 }
 
+// ------------------------------------------------------------------------
+//
+//
+//
+// ------------------------------------------------------------------------
+ForceFields::ForceField *constructForceFieldWithCutoff(
+    ROMol &mol, const AtomicParamVect &params, double vdwCutoff, double skin,
+    int confId, bool ignoreInterfragInteractions) {
+  PRECONDITION(mol.getNumAtoms() == params.size(), "bad parameters");
+
+  if (MolOps::needsHs(mol)) {
+    BOOST_LOG(rdWarningLog)
+        << "Molecule does not have explicit Hs. Consider calling AddHs()"
+        << std::endl;
+  }
+
+  std::unique_ptr<ForceFields::ForceField> res(new ForceFields::ForceField());
+
+  // add the atomic positions:
+  Conformer &conf = mol.getConformer(confId);
+  for (unsigned int i = 0; i < mol.getNumAtoms(); i++) {
+    res->positions().push_back(&conf.getAtomPos(i));
+  }
+
+  Tools::addBonds(mol, params, res.get());
+  Tools::addAngles(mol, params, res.get());
+  Tools::addAngleSpecialCases(mol, confId, params, res.get());
+  Tools::addNonbondedWithCutoff(mol, params, res.get(), vdwCutoff, skin,
+                                ignoreInterfragInteractions);
+  Tools::addTorsions(mol, params, res.get());
+  Tools::addInversions(mol, params, res.get());
+
+  // avoid the storage which grows quadratically with the number of atoms:
+  // the distance matrix and the inverse Hessian of the dense BFGS minimizer
+  res->setUseDistanceMatrix(false);
+  res->setNumLBFGSCorrections(BFGSOpt::LBFGS_CORRECTIONS);
+
+  return res.release();
+}
+
+ForceFields::ForceField *constructForceFieldWithCutoff(
+    ROMol &mol, double vdwCutoff, double skin, int confId,
+    bool ignoreInterfragInteractions) {
+  bool foundAll;
+  AtomicParamVect params;
+  boost::tie(params, foundAll) = getAtomTypes(mol);
+  return constructForceFieldWithCutoff(mol, params, vdwCutoff, skin, confId,
+                                       ignoreInterfragInteractions);
+}
+
 // ------------------------------------------------------------------------
 //
 //
@@ -75,6 +75,47 @@ RDKIT_FORCEFIELDHELPERS_EXPORT ForceFields::ForceField *constructForceField(
     ROMol &mol, const AtomicParamVect &params, double vdwThresh = 100.0,
     int confId = -1, bool ignoreInterfragInteractions = true);
 
+//! Builds and returns a UFF force field for a molecule which evaluates the
+//! van der Waals terms with a distance cutoff
+/*!
+  Rather than adding a term for every non-bonded atom pair, the van der
+  Waals interactions are found during the minimization using a neighbor
+  list, see ForceFields::UFF::vdWCutoffContrib. This keeps the memory use and
+  the cost of the van der Waals terms roughly linear in the number of atoms,
+  which makes it the better choice for large systems.
+
+  For the same reason the force field does not use a distance matrix (see
+  ForceFields::ForceField::setUseDistanceMatrix()) and minimize() uses the
+  L-BFGS minimizer with BFGSOpt::LBFGS_CORRECTIONS corrections (see
+  ForceFields::ForceField::setNumLBFGSCorrections()).
+
+  \param mol        the molecule to use
+  \param params     a vector with pointers to the
+                    ForceFields::UFF::AtomicParams structures to be used
+  \param vdwCutoff  van der Waals contacts which are longer than this (in
+                    Angstrom) make no contribution, the interactions are
+                    switched off smoothly over the last Angstrom before it
+  \param skin       the skin distance of the neighbor list: it is rebuilt
+                    when an atom has moved by more than half of this since
+                    the last build
+  \param confId     the optional conformer id, if this isn't provided, the
+                    molecule's default confId will be used.
+  \param ignoreInterfragInteractions if true, nonbonded terms will not be
+                    added between fragments
+
+  \return the new force field. The client is responsible for free'ing this.
+*/
+RDKIT_FORCEFIELDHELPERS_EXPORT ForceFields::ForceField *
+constructForceFieldWithCutoff(ROMol &mol, const AtomicParamVect &params,
+                              double vdwCutoff, double skin = 2.0,
+                              int confId = -1,
+                              bool ignoreInterfragInteractions = true);
+//! \overload
+RDKIT_FORCEFIELDHELPERS_EXPORT ForceFields::ForceField *
+constructForceFieldWithCutoff(ROMol &mol, double vdwCutoff, double skin = 2.0,
+                              int confId = -1,
+                              bool ignoreInterfragInteractions = true);
+
 namespace Tools {
 class RDKIT_FORCEFIELDHELPERS_EXPORT DefaultTorsionBondSmarts {
  public:
@@ -116,6 +157,10 @@ RDKIT_FORCEFIELDHELPERS_EXPORT void addNonbonded(
     ForceFields::ForceField *field,
     boost::shared_array<std::uint8_t> neighborMatrix, double vdwThresh = 100.0,
     bool ignoreInterfragInteractions = true);
+RDKIT_FORCEFIELDHELPERS_EXPORT void addNonbondedWithCutoff(
+    const ROMol &mol, const AtomicParamVect &params,
+    ForceFields::ForceField *field, double vdwCutoff, double skin = 2.0,
+    bool ignoreInterfragInteractions = true);
 RDKIT_FORCEFIELDHELPERS_EXPORT void addTorsions(
     const ROMol &mol, const AtomicParamVect &params,
     ForceFields::ForceField *field,
@@ -64,16 +64,20 @@ inline std::pair<int, double> UFFOptimizeMolecule(
   \param ignoreInterfragInteractions if true, nonbonded terms will not be added
   between
                                      fragments
+  \param batched    if true, the conformers are minimized together, see
+                    ForceFieldsHelper::OptimizeMoleculeConfs()
 
 */
 inline void UFFOptimizeMoleculeConfs(ROMol &mol,
                                      std::vector<std::pair<int, double>> &res,
                                      int numThreads = 1, int maxIters = 1000,
                                      double vdwThresh = 10.0,
-                                     bool ignoreInterfragInteractions = true) {
+                                     bool ignoreInterfragInteractions = true,
+                                     bool batched = false) {
   std::unique_ptr<ForceFields::ForceField> ff(UFF::constructForceField(
       mol, vdwThresh, -1, ignoreInterfragInteractions));
-  ForceFieldsHelper::OptimizeMoleculeConfs(mol, *ff, res, numThreads, maxIters);
+  ForceFieldsHelper::OptimizeMoleculeConfs(mol, *ff, res, numThreads, maxIters,
+                                           batched);
 }
 }  // end of namespace UFF
 }  // end of namespace RDKit
@@ -103,6 +103,16 @@ ForceFields::PyForceField *UFFGetMoleculeForceField(
   return res;
 }
 
+ForceFields::PyForceField *UFFGetMoleculeForceFieldWithCutoff(
+    ROMol &mol, double vdwCutoff, double skin = 2.0, int confId = -1,
+    bool ignoreInterfragInteractions = true) {
+  ForceFields::ForceField *ff = UFF::constructForceFieldWithCutoff(
+      mol, vdwCutoff, skin, confId, ignoreInterfragInteractions);
+  auto *res = new ForceFields::PyForceField(ff);
+  res->initialize();
+  return res;
+}
+
 bool UFFHasAllMoleculeParams(const ROMol &mol) {
   UFF::AtomicParamVect types;
   bool foundAll;
@@ -169,6 +179,25 @@ ForceFields::PyForceField *MMFFGetMoleculeForceField(
   return pyFF;
 }
 
+ForceFields::PyForceField *MMFFGetMoleculeForceFieldWithCutoff(
+    ROMol &mol, ForceFields::PyMMFFMolProperties *pyMMFFMolProperties,
+    double nonBondedCutoff, double skin = 2.0, int confId = -1,
+    bool ignoreInterfragInteractions = true) {
+  ForceFields::PyForceField *pyFF = nullptr;
+
+  if (pyMMFFMolProperties) {
+    MMFF::MMFFMolProperties *mmffMolProperties =
+        &(*(pyMMFFMolProperties->mmffMolProperties));
+    ForceFields::ForceField *ff = MMFF::constructForceFieldWithCutoff(
+        mol, mmffMolProperties, nonBondedCutoff, skin, confId,
+        ignoreInterfragInteractions);
+    pyFF = new ForceFields::PyForceField(ff);
+    pyFF->initialize();
+  }
+
+  return pyFF;
+}
+
 bool MMFFHasAllMoleculeParams(const ROMol &mol) {
   ROMol molCopy(mol);
   MMFF::MMFFMolProperties mmffMolProperties(molCopy);
@@ -313,6 +342,31 @@ BOOST_PYTHON_MODULE(rdForceFieldHelpers) {
               python::return_value_policy<python::manage_new_object>(),
               docString.c_str());
 
+  docString =
+      "returns a UFF force field for a molecule which evaluates the van der\n\
+ Waals terms with a distance cutoff using a neighbor list\n\n\
+ The force field minimizes with L-BFGS by default, see\n\
+ ForceField.SetNumLBFGSCorrections()\n\
+ \n\
+ ARGUMENTS:\n\n\
+    - mol : the molecule of interest\n\
+    - vdwCutoff : van der Waals contacts longer than this (in Angstrom)\n\
+                  make no contribution, the interactions are switched\n\
+                  off smoothly over the last Angstrom before it\n\
+    - skin : the neighbor list is rebuilt when an atom has moved by more\n\
+                  than half of this (defaults to 2.0)\n\
+    - confId : indicates which conformer to optimize\n\
+    - ignoreInterfragInteractions : if true, nonbonded terms between\n\
+                  fragments will not be added to the forcefield\n\
+\n";
+  python::def("UFFGetMoleculeForceFieldWithCutoff",
+              RDKit::UFFGetMoleculeForceFieldWithCutoff,
+              (python::arg("mol"), python::arg("vdwCutoff"),
+               python::arg("skin") = 2.0, python::arg("confId") = -1,
+               python::arg("ignoreInterfragInteractions") = true),
+              python::return_value_policy<python::manage_new_object>(),
+              docString.c_str());
+
   docString =
       "checks if UFF parameters are available for all of a molecule's atoms\n\n\
  \n\
@@ -391,6 +445,35 @@ BOOST_PYTHON_MODULE(rdForceFieldHelpers) {
       python::return_value_policy<python::manage_new_object>(),
       docString.c_str());
 
+  docString =
+      "returns a MMFF force field for a molecule which evaluates the\n\
+ non-bonded terms with a distance cutoff using a neighbor list\n\n\
+ The force field minimizes with L-BFGS by default, see\n\
+ ForceField.SetNumLBFGSCorrections()\n\
+ \n\
+ ARGUMENTS:\n\n\
+    - mol : the molecule of interest\n\
+    - pyMMFFMolProperties : PyMMFFMolProperties object as returned\n\
+                  by MMFFGetMoleculeProperties()\n\
+    - nonBondedCutoff : non-bonded contacts longer than this (in\n\
+                  Angstrom) make no contribution, the interactions are\n\
+                  switched off smoothly over the last Angstrom before it\n\
+    - skin : the neighbor list is rebuilt when an atom has moved by more\n\
+                  than half of this (defaults to 2.0)\n\
+    - confId : indicates which conformer to optimize\n\
+    - ignoreInterfragInteractions : if true, nonbonded terms between\n\
+                  fragments will not be added to the forcefield\n\
+\n";
+  python::def(
+      "MMFFGetMoleculeForceFieldWithCutoff",
+      RDKit::MMFFGetMoleculeForceFieldWithCutoff,
+      (python::arg("mol"), python::arg("pyMMFFMolProperties"),
+       python::arg("nonBondedCutoff"), python::arg("skin") = 2.0,
+       python::arg("confId") = -1,
+       python::arg("ignoreInterfragInteractions") = true),
+      python::return_value_policy<python::manage_new_object>(),
+      docString.c_str());
+
   docString =
       "Get An empty Force Field, with only the positions of the atoms but no Contributions.\n\n\
   \n\
@@ -423,6 +423,19 @@ M  END"""
     self.assertIsNotNone(ff)
     self.assertTrue(hasattr(ff, "CalcEnergy"))
 
+  def testCutoffForceFields(self):
+    fName = os.path.join(self.dirName, 'benzene.mol')
+    m = Chem.MolFromMolFile(fName)
+    ff = ChemicalForceFields.UFFGetMoleculeForceField(m, vdwThresh=1000.0)
+    cutoffFF = ChemicalForceFields.UFFGetMoleculeForceFieldWithCutoff(m, 1000.0)
+    self.assertAlmostEqual(cutoffFF.CalcEnergy(), ff.CalcEnergy(), places=6)
+
+    mp = ChemicalForceFields.MMFFGetMoleculeProperties(m)
+    ff = ChemicalForceFields.MMFFGetMoleculeForceField(m, mp)
+    cutoffFF = ChemicalForceFields.MMFFGetMoleculeForceFieldWithCutoff(m, mp, 1000.0)
+    self.assertAlmostEqual(cutoffFF.CalcEnergy(), ff.CalcEnergy(), places=6)
+    self.assertFalse(cutoffFF.Minimize(maxIts=1000))
+
   def testMMFFMolPropertiesScalarGetters(self):
     mol = Chem.AddHs(Chem.MolFromSmiles("CCO"))
     mp = ChemicalForceFields.MMFFGetMoleculeProperties(mol)
@@ -15,8 +15,13 @@
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #include <GraphMol/FileParsers/FileParsers.h>
 #include <GraphMol/ForceFieldHelpers/UFF/UFF.h>
+#include <GraphMol/ForceFieldHelpers/MMFF/MMFF.h>
+#include <GraphMol/FileParsers/MolSupplier.h>
 #include <ForceField/MMFF/Params.h>
 #include <ForceField/MMFF/BondStretch.h>
+#include <ForceField/MMFF/Nonbonded.h>
+#include <Numerics/Optimizer/BFGSOpt.h>
+#include <Numerics/Optimizer/LBFGSOpt.h>
 #include <GraphMol/MolTransforms/MolTransforms.h>
 
 #include "FFConvenience.h"
@@ -119,4 +124,358 @@ M  END)CTAB";
   CHECK(MolTransforms::getAngleDeg(conf, 1, 3, 8) > 110);
   CHECK(MolTransforms::getAngleDeg(conf, 1, 3, 7) > 110);
   CHECK(MolTransforms::getAngleDeg(conf, 7, 3, 8) > 110);
-}
\ No newline at end of file
+}
+
+TEST_CASE("batched conformer minimization") {
+  std::string pathName = getenv("RDBASE");
+  pathName += "/Code/GraphMol/ForceFieldHelpers/UFF/test_data/bulk.sdf";
+  SDMolSupplier suppl(pathName, true, false);
+  std::unique_ptr<ROMol> mol{suppl[4]};
+  REQUIRE(mol);
+  // make some distorted conformers:
+  const unsigned int numConfs = 11;
+  for (unsigned int i = 1; i < numConfs; ++i) {
+    auto conf = new Conformer(mol->getConformer());
+    for (unsigned int j = 0; j < mol->getNumAtoms(); ++j) {
+      auto &pos = conf->getAtomPos(j);
+      pos.x += 0.2 * sin(1.3 * i + 0.7 * j);
+      pos.y += 0.2 * cos(0.9 * i + 1.1 * j);
+      pos.z += 0.2 * sin(0.5 * i * j);
+    }
+    mol->addConformer(conf, true);
+  }
+
+  SECTION("batched energies and gradients") {
+    std::unique_ptr<ForceFields::ForceField> ff{
+        MMFF::constructForceField(*mol)};
+    REQUIRE(ff);
+    ff->initialize();
+    const unsigned int dim = 3 * mol->getNumAtoms();
+    std::vector<double> pos(dim * numConfs);
+    std::vector<double> expectedEnergies(numConfs);
+    std::vector<double> expectedGrads(dim * numConfs);
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      std::vector<double> confPos(dim);
+      std::vector<double> confGrad(dim, 0.0);
+      const auto &conf = mol->getConformer(c);
+      for (unsigned int j = 0; j < mol->getNumAtoms(); ++j) {
+        for (unsigned int k = 0; k < 3; ++k) {
+          confPos[3 * j + k] = conf.getAtomPos(j)[k];
+          pos[(3 * j + k) * numConfs + c] = confPos[3 * j + k];
+        }
+      }
+      expectedEnergies[c] = ff->calcEnergy(confPos.data());
+      ff->calcGrad(confPos.data(), confGrad.data());
+      for (unsigned int i = 0; i < dim; ++i) {
+        expectedGrads[i * numConfs + c] = confGrad[i];
+      }
+    }
+    std::vector<double> energies(numConfs);
+    std::vector<double> grads(dim * numConfs);
+    ff->calcEnergies(pos.data(), numConfs, energies.data());
+    ff->calcGrads(pos.data(), numConfs, grads.data());
+    // the contribs are summed in the same order as in calcEnergy()
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      CHECK(energies[c] == expectedEnergies[c]);
+    }
+    for (unsigned int i = 0; i < dim * numConfs; ++i) {
+      CHECK_THAT(grads[i], Catch::Matchers::WithinAbs(expectedGrads[i], 1e-8));
+    }
+  }
+
+  SECTION("batched minimization matches the conformer-by-conformer one") {
+    for (const auto useMMFF : {true, false}) {
+      ROMol mol2(*mol);
+      std::unique_ptr<ForceFields::ForceField> ff{
+          useMMFF ? MMFF::constructForceField(*mol)
+                  : UFF::constructForceField(*mol)};
+      REQUIRE(ff);
+      std::vector<std::pair<int, double>> expected(numConfs);
+      for (unsigned int c = 0; c < numConfs; ++c) {
+        auto &conf = mol->getConformer(c);
+        for (unsigned int j = 0; j < mol->getNumAtoms(); ++j) {
+          ff->positions()[j] = &conf.getAtomPos(j);
+        }
+        ff->initialize();
+        expected[c].first = ff->minimize(1000);
+        expected[c].second = ff->calcEnergy();
+      }
+
+      std::vector<std::pair<int, double>> res;
+      ForceFieldsHelper::OptimizeMoleculeConfs(mol2, *ff, res, 1, 1000, true);
+      REQUIRE(res.size() == numConfs);
+      for (unsigned int c = 0; c < numConfs; ++c) {
+        CHECK(res[c].first == expected[c].first);
+        CHECK_THAT(res[c].second,
+                   Catch::Matchers::WithinAbs(expected[c].second, 1e-4));
+        const auto &conf = mol->getConformer(c);
+        const auto &conf2 = mol2.getConformer(c);
+        for (unsigned int j = 0; j < mol->getNumAtoms(); ++j) {
+          CHECK((conf.getAtomPos(j) - conf2.getAtomPos(j)).length() < 1e-3);
+        }
+      }
+    }
+  }
+
+  SECTION("batch sizes and fixed points") {
+    std::unique_ptr<ForceFields::ForceField> ff{
+        MMFF::constructForceField(*mol)};
+    REQUIRE(ff);
+    ff->fixedPoints().push_back(0);
+    ff->initialize();
+    std::vector<RDGeom::PointPtrVect> positions(numConfs);
+    std::vector<ROMol> mols(2, *mol);
+    std::vector<std::vector<double>> energies(2);
+    std::vector<std::vector<int>> needsMore(2);
+    unsigned int batchSizes[2] = {1, 4};
+    for (unsigned int i = 0; i < 2; ++i) {
+      for (unsigned int c = 0; c < numConfs; ++c) {
+        positions[c].clear();
+        for (auto &pt : mols[i].getConformer(c).getPositions()) {
+          positions[c].push_back(&pt);
+        }
+      }
+      needsMore[i] = ff->minimizeBatch(positions, 200, 1e-4, 1e-6,
+                                       batchSizes[i], &energies[i]);
+    }
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      CHECK(needsMore[0][c] == needsMore[1][c]);
+      CHECK_THAT(energies[0][c],
+                 Catch::Matchers::WithinRel(energies[1][c], 1e-8));
+      CHECK(mols[0].getConformer(c).getAtomPos(0).x ==
+            mol->getConformer(c).getAtomPos(0).x);
+      CHECK(mols[1].getConformer(c).getAtomPos(0).z ==
+            mol->getConformer(c).getAtomPos(0).z);
+    }
+  }
+}
+
+TEST_CASE("non-bonded cutoff force fields") {
+  std::string pathName = getenv("RDBASE");
+  pathName += "/Code/GraphMol/ForceFieldHelpers/UFF/test_data/bulk.sdf";
+  SDMolSupplier suppl(pathName, true, false);
+  std::unique_ptr<ROMol> mol{suppl[4]};
+  REQUIRE(mol);
+  const unsigned int dim = 3 * mol->getNumAtoms();
+  std::vector<double> pos(dim);
+  for (unsigned int j = 0; j < mol->getNumAtoms(); ++j) {
+    for (unsigned int k = 0; k < 3; ++k) {
+      pos[3 * j + k] = mol->getConformer().getAtomPos(j)[k];
+    }
+  }
+
+  SECTION("a large cutoff reproduces the full force fields") {
+    for (const auto useMMFF : {true, false}) {
+      std::unique_ptr<ForceFields::ForceField> ff{
+          useMMFF ? MMFF::constructForceField(*mol)
+                  : UFF::constructForceField(*mol, 1000.0)};
+      std::unique_ptr<ForceFields::ForceField> cutoffFF{
+          useMMFF ? MMFF::constructForceFieldWithCutoff(*mol, 1000.0)
+                  : UFF::constructForceFieldWithCutoff(*mol, 1000.0)};
+      REQUIRE(ff);
+      REQUIRE(cutoffFF);
+      // the cutoff force fields avoid the quadratic storage
+      CHECK(ff->useDistanceMatrix());
+      CHECK(!cutoffFF->useDistanceMatrix());
+      CHECK(cutoffFF->numLBFGSCorrections() == BFGSOpt::LBFGS_CORRECTIONS);
+      ForceFields::ForceField ffCopy(*cutoffFF);
+      CHECK(!ffCopy.useDistanceMatrix());
+      ff->initialize();
+      cutoffFF->initialize();
+      CHECK_THAT(cutoffFF->calcEnergy(pos.data()),
+                 Catch::Matchers::WithinRel(ff->calcEnergy(pos.data()), 1e-10));
+      std::vector<double> grad(dim, 0.0);
+      std::vector<double> cutoffGrad(dim, 0.0);
+      ff->calcGrad(pos.data(), grad.data());
+      cutoffFF->calcGrad(pos.data(), cutoffGrad.data());
+      for (unsigned int i = 0; i < dim; ++i) {
+        CHECK_THAT(cutoffGrad[i], Catch::Matchers::WithinAbs(grad[i], 1e-8));
+      }
+    }
+  }
+
+  SECTION("minimization") {
+    for (const auto useMMFF : {true, false}) {
+      ROMol mol2(*mol);
+      std::unique_ptr<ForceFields::ForceField> ff{
+          useMMFF ? MMFF::constructForceField(*mol)
+                  : UFF::constructForceField(*mol)};
+      std::unique_ptr<ForceFields::ForceField> cutoffFF{
+          useMMFF ? MMFF::constructForceFieldWithCutoff(mol2, 1000.0)
+                  : UFF::constructForceFieldWithCutoff(mol2, 1000.0)};
+      REQUIRE(ff);
+      REQUIRE(cutoffFF);
+      ff->initialize();
+      cutoffFF->initialize();
+      CHECK(ff->minimize(1000) == 0);
+      CHECK(cutoffFF->minimize(1000) == 0);
+      CHECK_THAT(cutoffFF->calcEnergy(),
+                 Catch::Matchers::WithinAbs(ff->calcEnergy(), 1e-4));
+    }
+  }
+
+  SECTION("short cutoffs") {
+    std::unique_ptr<ForceFields::ForceField> ff{
+        MMFF::constructForceFieldWithCutoff(*mol, 3.0, 0.5)};
+    REQUIRE(ff);
+    ff->initialize();
+    const ForceFields::MMFF::NonbondedCutoffContrib *contrib = nullptr;
+    for (const auto &c : ff->contribs()) {
+      auto nb = dynamic_cast<const ForceFields::MMFF::NonbondedCutoffContrib *>(
+          c.get());
+      if (nb) {
+        contrib = nb;
+      }
+    }
+    REQUIRE(contrib);
+    const auto e0 = ff->calcEnergy(pos.data());
+    const auto &nbrList = contrib->neighborList();
+    CHECK(nbrList.numBuilds() == 1);
+    const auto numAtoms = mol->getNumAtoms();
+    CHECK(nbrList.numPairs() < numAtoms * (numAtoms - 1) / 2);
+    for (unsigned int i = 0; i < nbrList.numPairs(); ++i) {
+      CHECK((mol->getConformer().getAtomPos(nbrList.at1Idxs()[i]) -
+             mol->getConformer().getAtomPos(nbrList.at2Idxs()[i]))
+                .length() < 3.5);
+    }
+    CHECK(ff->minimize(1000) == 0);
+    CHECK(ff->calcEnergy() < e0);
+  }
+
+  SECTION("batched minimization keeps a neighbor list for each conformer") {
+    // the conformers are distorted by different amounts, so that they
+    // converge after different numbers of iterations and the conformers in
+    // the batch change during the minimization
+    const unsigned int numConfs = 6;
+    ROMol confMol(*mol);
+    for (unsigned int i = 1; i < numConfs; ++i) {
+      auto conf = new Conformer(mol->getConformer());
+      for (unsigned int j = 0; j < mol->getNumAtoms(); ++j) {
+        auto &pt = conf->getAtomPos(j);
+        pt.x += 0.1 * i * sin(1.3 * i + 0.7 * j);
+        pt.y += 0.1 * i * cos(0.9 * i + 1.1 * j);
+        pt.z += 0.1 * i * sin(0.5 * i * j);
+      }
+      confMol.addConformer(conf, true);
+    }
+    auto getContrib = [](const ForceFields::ForceField &ff) {
+      const ForceFields::MMFF::NonbondedCutoffContrib *res = nullptr;
+      for (const auto &c : ff.contribs()) {
+        if (auto nb = dynamic_cast<
+                const ForceFields::MMFF::NonbondedCutoffContrib *>(c.get())) {
+          res = nb;
+        }
+      }
+      return res;
+    };
+
+    ROMol batchMol(confMol);
+    std::unique_ptr<ForceFields::ForceField> ff{
+        MMFF::constructForceFieldWithCutoff(batchMol, 3.0, 0.5)};
+    REQUIRE(ff);
+    ff->initialize();
+    std::vector<RDGeom::PointPtrVect> positions(numConfs);
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      for (auto &pt : batchMol.getConformer(c).getPositions()) {
+        positions[c].push_back(&pt);
+      }
+    }
+    std::vector<double> energies;
+    const auto needsMore =
+        ff->minimizeBatch(positions, 1000, 1e-4, 1e-6, 2, &energies);
+    const auto contrib = getContrib(*ff);
+    REQUIRE(contrib);
+
+    // each conformer's list was built exactly as often as when the
+    // conformer is minimized on its own
+    unsigned int maxBuilds = 0;
+    for (unsigned int c = 0; c < numConfs; ++c) {
+      INFO(c);
+      std::unique_ptr<ForceFields::ForceField> confFF{
+          MMFF::constructForceFieldWithCutoff(confMol, 3.0, 0.5, c)};
+      REQUIRE(confFF);
+      // minimizeBatch() uses the dense BFGS minimizer
+      confFF->setNumLBFGSCorrections(0);
+      confFF->initialize();
+      CHECK(confFF->minimize(1000, 1e-4, 1e-6) == needsMore[c]);
+      CHECK_THAT(energies[c],
+                 Catch::Matchers::WithinAbs(confFF->calcEnergy(), 1e-8));
+      const auto confContrib = getContrib(*confFF);
+      REQUIRE(confContrib);
+      const auto numBuilds = confContrib->neighborList().numBuilds();
+      CHECK(contrib->batchNeighborList(c).numBuilds() == numBuilds);
+      maxBuilds = std::max(maxBuilds, numBuilds);
+      for (unsigned int j = 0; j < mol->getNumAtoms(); ++j) {
+        CHECK((confMol.getConformer(c).getAtomPos(j) -
+               batchMol.getConformer(c).getAtomPos(j))
+                  .length() < 1e-5);
+      }
+    }
+    // the lists were rebuilt during the minimizations
+    CHECK(maxBuilds > 1);
+  }
+}
+
+TEST_CASE("L-BFGS minimization") {
+  std::string pathName = getenv("RDBASE");
+  pathName += "/Code/GraphMol/ForceFieldHelpers/UFF/test_data/bulk.sdf";
+  SDMolSupplier suppl(pathName, true, false);
+  std::unique_ptr<ROMol> mol{suppl[4]};
+  REQUIRE(mol);
+  for (const auto useMMFF : {true, false}) {
+    ROMol mol2(*mol);
+    std::unique_ptr<ForceFields::ForceField> ff{
+        useMMFF ? MMFF::constructForceField(*mol)
+                : UFF::constructForceField(*mol)};
+    std::unique_ptr<ForceFields::ForceField> lbfgsFF{
+        useMMFF ? MMFF::constructForceField(mol2)
+                : UFF::constructForceField(mol2)};
+    REQUIRE(ff);
+    REQUIRE(lbfgsFF);
+    CHECK(lbfgsFF->numLBFGSCorrections() == 0);
+    lbfgsFF->setNumLBFGSCorrections(8);
+    CHECK(lbfgsFF->numLBFGSCorrections() == 8);
+    ff->initialize();
+    lbfgsFF->initialize();
+    CHECK(ff->minimize(1000) == 0);
+    CHECK(lbfgsFF->minimize(1000) == 0);
+    CHECK_THAT(lbfgsFF->calcEnergy(),
+               Catch::Matchers::WithinAbs(ff->calcEnergy(), 1e-2));
+  }
+}
+
+TEST_CASE("minimization with the SIMD kernels") {
+  std::string pathName = getenv("RDBASE");
+  pathName += "/Code/GraphMol/ForceFieldHelpers/UFF/test_data/bulk.sdf";
+  SDMolSupplier suppl(pathName, true, false);
+  std::unique_ptr<ROMol> mol{suppl[4]};
+  REQUIRE(mol);
+  // the kernels are opt-in, so by default nothing changes
+  REQUIRE(BFGSOpt::getSIMDLevel() == BFGSOpt::SIMDLevel::Scalar);
+  for (const auto useMMFF : {true, false}) {
+    ROMol mol2(*mol);
+    std::unique_ptr<ForceFields::ForceField> ff{
+        useMMFF ? MMFF::constructForceField(*mol)
+                : UFF::constructForceField(*mol)};
+    std::unique_ptr<ForceFields::ForceField> simdFF{
+        useMMFF ? MMFF::constructForceField(mol2)
+                : UFF::constructForceField(mol2)};
+    REQUIRE(ff);
+    REQUIRE(simdFF);
+    ff->initialize();
+    simdFF->initialize();
+    CHECK(ff->minimize(1000) == 0);
+    BFGSOpt::setMaxSIMDLevel(BFGSOpt::SIMDLevel::AVX512);
+    CHECK(simdFF->minimize(1000) == 0);
+    BFGSOpt::setMaxSIMDLevel(BFGSOpt::SIMDLevel::Scalar);
+    // the kernels sum in a different order, so the minimizations can take
+    // slightly different paths, but they end up in the same minimum
+    CHECK_THAT(simdFF->calcEnergy(),
+               Catch::Matchers::WithinAbs(ff->calcEnergy(), 1e-4));
+    for (unsigned int i = 0; i < mol->getNumAtoms(); ++i) {
+      CHECK((mol->getConformer().getAtomPos(i) -
+             mol2.getConformer().getAtomPos(i))
+                .length() < 1e-2);
+    }
+  }
+}
@@ -0,0 +1,203 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include "MolArena.h"
+
+#include <cstdint>
+
+namespace RDKit {
+namespace MolArena {
+namespace detail {
+std::atomic<std::size_t> useCount{0};
+}  // namespace detail
+
+namespace {
+// slabs are aligned to their size, so the start of the slab an object came
+// from is found by masking its address
+constexpr unsigned int slabShift = 16;
+constexpr std::size_t slabSize = std::size_t(1) << slabShift;
+constexpr std::size_t allocationAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+// larger allocations go straight to the heap
+constexpr std::size_t maxArenaAllocation = slabSize / 16;
+
+constexpr std::size_t roundUp(std::size_t size) {
+  return (size + allocationAlignment - 1) / allocationAlignment *
+         allocationAlignment;
+}
+
+struct Slab {
+  // one reference for each live allocation plus one held by the owning
+  // thread while the slab is its current slab
+  std::atomic<std::size_t> refCount{1};
+  std::size_t used = roundUp(sizeof(Slab));
+};
+
+// The live slabs are recorded in a two level bitmap with one bit for each
+// slab-sized block of the address space, so that deallocate() can tell slab
+// memory from heap memory without taking a lock. The leaves are created on
+// demand and each covers 4GB of address space; they are never freed.
+constexpr unsigned int addressBits = 48;
+constexpr unsigned int leafBits = 16;
+constexpr std::size_t leafWords = (std::size_t(1) << leafBits) / 64;
+constexpr std::size_t rootSize = std::size_t(1)
+                                 << (addressBits - slabShift - leafBits);
+
+struct SlabMapLeaf {
+  std::atomic<std::uint64_t> words[leafWords] = {};
+};
+std::atomic<SlabMapLeaf *> slabMap[rootSize];
+
+// returns the leaf of the slab map which covers the block starting at base,
+// nullptr if there is none (and create is false) or the block is outside of
+// the range the map covers
+SlabMapLeaf *getSlabMapLeaf(std::uint64_t base, bool create) {
+  const auto rootIdx = base >> (slabShift + leafBits);
+  if (rootIdx >= rootSize) {
+    return nullptr;
+  }
+  auto leaf = slabMap[rootIdx].load(std::memory_order_acquire);
+  if (!leaf && create) {
+    auto newLeaf = new SlabMapLeaf;
+    if (slabMap[rootIdx].compare_exchange_strong(leaf, newLeaf,
+                                                 std::memory_order_acq_rel)) {
+      leaf = newLeaf;
+    } else {
+      // another thread got here first, leaf now holds its leaf
+      delete newLeaf;
+    }
+  }
+  return leaf;
+}
+
+std::uint64_t slabMapBit(std::uint64_t base, std::size_t &word) {
+  const auto idx = (base >> slabShift) & ((std::uint64_t(1) << leafBits) - 1);
+  word = idx / 64;
+  return std::uint64_t(1) << (idx % 64);
+}
+
+// returns nullptr if the memory for a slab could not be registered, the
+// caller then falls back to the heap
+Slab *newSlab() {
+  auto mem = ::operator new(slabSize, std::align_val_t(slabSize));
+  const auto base = reinterpret_cast<std::uintptr_t>(mem);
+  SlabMapLeaf *leaf;
+  try {
+    leaf = getSlabMapLeaf(base, true);
+  } catch (...) {
+    ::operator delete(mem, std::align_val_t(slabSize));
+    throw;
+  }
+  if (!leaf) {
+    ::operator delete(mem, std::align_val_t(slabSize));
+    return nullptr;
+  }
+  std::size_t word;
+  const auto bit = slabMapBit(base, word);
+  leaf->words[word].fetch_or(bit, std::memory_order_release);
+  ++detail::useCount;
+  return new (mem) Slab;
+}
+
+void releaseSlab(Slab *slab) noexcept {
+  if (slab->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    const auto base = reinterpret_cast<std::uintptr_t>(slab);
+    std::size_t word;
+    const auto bit = slabMapBit(base, word);
+    getSlabMapLeaf(base, false)->words[word].fetch_and(
+        ~bit, std::memory_order_release);
+    slab->~Slab();
+    ::operator delete(slab, std::align_val_t(slabSize));
+    --detail::useCount;
+  }
+}
+
+// returns the slab which contains ptr, nullptr if it is not in a slab
+Slab *findSlab(const void *ptr) noexcept {
+  const auto base =
+      reinterpret_cast<std::uintptr_t>(ptr) & ~std::uintptr_t(slabSize - 1);
+  const auto leaf = getSlabMapLeaf(base, false);
+  if (!leaf) {
+    return nullptr;
+  }
+  std::size_t word;
+  const auto bit = slabMapBit(base, word);
+  return leaf->words[word].load(std::memory_order_acquire) & bit
+             ? reinterpret_cast<Slab *>(base)
+             : nullptr;
+}
+
+struct ThreadArena {
+  unsigned int depth = 0;
+  Slab *current = nullptr;
+
+  void releaseCurrent() noexcept {
+    if (current) {
+      releaseSlab(current);
+      current = nullptr;
+    }
+  }
+  ~ThreadArena() { releaseCurrent(); }
+};
+
+thread_local ThreadArena threadArena;
+}  // namespace
+
+Scope::Scope() {
+  if (!threadArena.depth++) {
+    ++detail::useCount;
+  }
+}
+
+Scope::~Scope() {
+  if (!--threadArena.depth) {
+    threadArena.releaseCurrent();
+    --detail::useCount;
+  }
+}
+
+bool isActive() { return threadArena.depth > 0; }
+
+namespace detail {
+void *allocate(std::size_t size) {
+  const auto total = roundUp(size);
+  if (!threadArena.depth || total > maxArenaAllocation) {
+    return ::operator new(size);
+  }
+  auto &current = threadArena.current;
+  if (!current || current->used + total > slabSize) {
+    threadArena.releaseCurrent();
+    current = newSlab();
+    if (!current) {
+      return ::operator new(size);
+    }
+  }
+  void *res = reinterpret_cast<std::byte *>(current) + current->used;
+  current->used += total;
+  current->refCount.fetch_add(1, std::memory_order_relaxed);
+  return res;
+}
+
+void deallocate(void *ptr) noexcept {
+  if (!ptr) {
+    return;
+  }
+  if (auto slab = findSlab(ptr)) {
+    releaseSlab(slab);
+  } else {
+    ::operator delete(ptr);
+  }
+}
+}  // namespace detail
+
+bool isArenaAllocated(const void *ptr) {
+  return ptr && findSlab(ptr) != nullptr;
+}
+
+}  // namespace MolArena
+}  // namespace RDKit
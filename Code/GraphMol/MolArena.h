@@ -0,0 +1,119 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+/*! \file MolArena.h
+
+  \brief Per-thread arena used to allocate molecules
+
+  Building a molecule from SMILES or from a pickle involves a separate
+  heap allocation for the molecule, each of its atoms and bonds, and its ring
+  information. When many molecules are being created this can account for a
+  significant amount of the run time.
+
+  While a MolArena::Scope is alive, ROMol, Atom, Bond, and RingInfo objects
+  created on that thread are carved out of large blocks of memory (slabs)
+  owned by the thread instead of being allocated one at a time. Memory in a
+  slab is never reused; a slab is returned to the system in one shot once
+  every object allocated from it has been deleted and the thread no longer
+  allocates from it. Objects may be deleted on any thread, so molecules
+  created inside a scope can safely be handed to other threads and can
+  outlive the scope.
+
+  The arena is opt-in. Typical usage:
+  \code
+    {
+      MolArena::Scope arena;
+      for (const auto &smi : smiles) {
+        auto mol = v2::SmilesParse::MolFromSmiles(smi);
+        ...
+      }
+    }
+  \endcode
+  v2::SmilesParse::SmilesParserParams::useArena and
+  v2::FileParsers::MultithreadedMolSupplier::Parameters::useArena open a
+  scope for you.
+
+  Allocations do not carry a header: the slabs are aligned to their size
+  and recorded in a bitmap indexed by address, so the slab an object
+  belongs to is found from its address without taking a lock. As long as
+  no scope is active and no slab is alive anywhere in the process,
+  allocating and releasing these objects costs a single relaxed atomic load
+  on top of the standard allocator.
+
+  Notes:
+    - a single long-lived object keeps its whole slab alive, so the arena is
+      best suited to workloads where batches of molecules are created and
+      destroyed together.
+    - the properties, ring membership vectors, and graph storage of the
+      molecule still use the standard allocator.
+*/
+#include <RDGeneral/export.h>
+#ifndef RD_MOLARENA_H
+#define RD_MOLARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace RDKit {
+namespace MolArena {
+
+//! while an instance of this class is alive, molecules are allocated from the
+//! calling thread's arena
+/*!
+  Scopes can be nested; the thread stops allocating from its arena when the
+  outermost scope is destroyed.
+*/
+class RDKIT_GRAPHMOL_EXPORT Scope {
+ public:
+  Scope();
+  ~Scope();
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+};
+
+//! returns whether or not the calling thread is allocating from its arena
+RDKIT_GRAPHMOL_EXPORT bool isActive();
+
+namespace detail {
+//! the number of active scopes plus the number of live slabs, over all
+//! threads. While this is zero no memory can come from an arena.
+RDKIT_GRAPHMOL_EXPORT extern std::atomic<std::size_t> useCount;
+RDKIT_GRAPHMOL_EXPORT void *allocate(std::size_t size);
+RDKIT_GRAPHMOL_EXPORT void deallocate(void *ptr) noexcept;
+}  // namespace detail
+
+//! allocates memory, from the arena if it is active on the calling thread
+/*!
+  This is used to implement operator new for the classes which support the
+  arena; memory returned by this function must be released with
+  deallocate().
+*/
+inline void *allocate(std::size_t size) {
+  if (!detail::useCount.load(std::memory_order_relaxed)) {
+    return ::operator new(size);
+  }
+  return detail::allocate(size);
+}
+//! releases memory returned by allocate()
+inline void deallocate(void *ptr) noexcept {
+  // memory from a slab keeps useCount above zero, and whoever deletes an
+  // object has synchronized with the thread which created it
+  if (!detail::useCount.load(std::memory_order_relaxed)) {
+    ::operator delete(ptr);
+    return;
+  }
+  detail::deallocate(ptr);
+}
+//! returns whether or not memory returned by allocate() came from an arena
+RDKIT_GRAPHMOL_EXPORT bool isArenaAllocated(const void *ptr);
+
+}  // namespace MolArena
+}  // namespace RDKit
+#endif
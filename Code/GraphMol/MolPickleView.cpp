@@ -0,0 +1,709 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include <GraphMol/MolPickleView.h>
+#include <GraphMol/ROMol.h>
+#include <GraphMol/StereoGroup.h>
+#include <RDGeneral/Invariant.h>
+#include <RDGeneral/StreamOps.h>
+
+#include <cstring>
+#include <istream>
+#include <streambuf>
+
+namespace RDKit {
+namespace {
+const char *eofMessage =
+    "Bad pickle format: unexpected End-of-File while reading";
+
+// reads directly from the pickle buffer, without copying it
+class PickleStreamBuf : public std::streambuf {
+ public:
+  PickleStreamBuf(const char *begin, const char *end) {
+    setg(const_cast<char *>(begin), const_cast<char *>(begin),
+         const_cast<char *>(end));
+  }
+
+ protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode) override {
+    char *target = gptr();
+    if (dir == std::ios_base::beg) {
+      target = eback();
+    } else if (dir == std::ios_base::end) {
+      target = egptr();
+    }
+    if (off < eback() - target || off > egptr() - target) {
+      return pos_type(off_type(-1));
+    }
+    target += off;
+    setg(eback(), target, egptr());
+    return pos_type(target - eback());
+  }
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+};
+
+template <typename T>
+T readAt(const char *p) {
+  T res;
+  std::memcpy(&res, p, sizeof(T));
+  return EndianSwapBytes<LITTLE_ENDIAN_ORDER, HOST_ENDIAN_ORDER>(res);
+}
+
+// the size of each of the optional fields of the atom data, see
+// MolPickler::_pickleAtomData()
+size_t atomFieldSize(unsigned int field) {
+  return (field == 0 || field == 8) ? 4 : 1;
+}
+
+// a bounds-checked cursor over the pickle
+class PickleReader {
+ public:
+  explicit PickleReader(std::string_view pickle) : d_pickle(pickle) {}
+
+  size_t pos() const { return d_pos; }
+
+  template <typename T>
+  T read() {
+    check(sizeof(T));
+    auto res = readAt<T>(d_pickle.data() + d_pos);
+    d_pos += sizeof(T);
+    return res;
+  }
+  MolPickler::Tags readTag() {
+    auto tag = read<unsigned char>();
+    if (tag >= MolPickler::INVALID_TAG) {
+      throw MolPicklerException("Invalid tag found.");
+    }
+    return static_cast<MolPickler::Tags>(tag);
+  }
+  void expectTag(MolPickler::Tags expected, const char *name) {
+    if (readTag() != expected) {
+      throw MolPicklerException(std::string("Bad pickle format: ") + name +
+                                " tag not found.");
+    }
+  }
+  unsigned int readIndex(bool wide) {
+    if (wide) {
+      auto res = read<std::int32_t>();
+      if (res < 0) {
+        throw MolPicklerException("Bad pickle format: negative index");
+      }
+      return static_cast<unsigned int>(res);
+    }
+    return read<unsigned char>();
+  }
+  void skip(size_t n) {
+    check(n);
+    d_pos += n;
+  }
+  void skipIndices(bool wide, size_t n) { skip(n * (wide ? 4 : 1)); }
+  void skipString() { skip(read<std::uint32_t>()); }
+  // skips the optional atom data fields, returns the property flags
+  std::int32_t skipAtomData() {
+    auto propFlags = read<std::int32_t>();
+    for (unsigned int field = 0; field < 9; ++field) {
+      if (propFlags & (1 << field)) {
+        skip(atomFieldSize(field));
+      }
+    }
+    return propFlags;
+  }
+
+  // runs func with a stream positioned at the cursor and then moves the
+  // cursor past whatever func read
+  template <typename F>
+  void withStream(F func) {
+    PickleStreamBuf buf(d_pickle.data() + d_pos,
+                        d_pickle.data() + d_pickle.size());
+    std::istream ss(&buf);
+    try {
+      func(ss);
+    } catch (const std::runtime_error &) {
+      throw MolPicklerException(eofMessage);
+    }
+    d_pos += static_cast<size_t>(ss.tellg());
+  }
+
+ private:
+  void check(size_t n) const {
+    if (n > d_pickle.size() - d_pos) {
+      throw MolPicklerException(eofMessage);
+    }
+  }
+
+  std::string_view d_pickle;
+  size_t d_pos{0};
+};
+}  // namespace
+
+struct MolPickleView::LazyData {
+  bool confsDecoded{false};
+  std::vector<std::unique_ptr<Conformer>> conformers;
+  bool propsDecoded{false};
+  RDProps props;
+  std::vector<RDProps> atomProps;
+  std::vector<RDProps> bondProps;
+};
+
+MolPickleView::MolPickleView(std::string_view pickle) : d_pickle(pickle) {
+  index();
+}
+MolPickleView::MolPickleView(MolPickleView &&) noexcept = default;
+MolPickleView &MolPickleView::operator=(MolPickleView &&) noexcept = default;
+MolPickleView::~MolPickleView() = default;
+
+void MolPickleView::index() {
+  PickleReader reader(d_pickle);
+  if (reader.read<std::int32_t>() != MolPickler::endianId) {
+    throw MolPicklerException(
+        "Bad pickle format: bad endian ID or invalid file format");
+  }
+  if (reader.read<std::int32_t>() != MolPickler::VERSION) {
+    throw MolPicklerException("Bad pickle format: no version tag");
+  }
+  auto majorVersion = reader.read<std::int32_t>();
+  auto minorVersion = reader.read<std::int32_t>();
+  auto patchVersion = reader.read<std::int32_t>();
+  if (majorVersion < 0 || majorVersion > 1000 || minorVersion < 0 ||
+      minorVersion > 100 || patchVersion < 0 || patchVersion > 100) {
+    throw MolPicklerException("unreasonable version numbers");
+  }
+  d_version = 1000 * majorVersion + minorVersion * 10 + patchVersion;
+  if (d_version < 13000) {
+    throw MolPicklerException(
+        "MolPickleView requires pickle format 13.0 or later");
+  }
+
+  auto numAtoms = reader.read<std::int32_t>();
+  auto numBonds = reader.read<std::int32_t>();
+  if (numAtoms < 0 || numBonds < 0) {
+    throw MolPicklerException("Bad pickle format: negative atom count");
+  }
+  d_numAtoms = numAtoms;
+  d_numBonds = numBonds;
+  d_wideIndices = numAtoms > 255;
+  // the coordinates flag, only used by very old pickles
+  reader.read<unsigned char>();
+
+  // -------------------
+  //
+  // Atoms
+  //
+  // -------------------
+  reader.expectTag(MolPickler::BEGINATOM, "BEGINATOM");
+  d_atomOffsets.resize(2 * d_numAtoms);
+  for (unsigned int i = 0; i < d_numAtoms; ++i) {
+    d_atomOffsets[2 * i] = rdcast<std::uint32_t>(reader.pos());
+    reader.read<unsigned char>();
+    auto flags = reader.read<unsigned char>();
+    if (flags & 0x1 << 7) {
+      reader.skip(3 * sizeof(float));
+    }
+    reader.skipAtomData();
+    if (flags & 0x1 << 4) {
+      d_hasQueries = true;
+      reader.expectTag(MolPickler::BEGINQUERY, "BEGINQUERY");
+      reader.withStream([this](std::istream &ss) {
+        MolPickler::_skipQuery(ss, true, d_version);
+      });
+      reader.expectTag(MolPickler::ENDQUERY, "ENDQUERY");
+    }
+    d_atomOffsets[2 * i + 1] = rdcast<std::uint32_t>(reader.pos());
+    if (flags & 0x1 << 3) {
+      reader.expectTag(MolPickler::ATOM_MAPNUMBER, "ATOM_MAPNUMBER");
+      if (reader.read<signed char>() < 0) {
+        reader.read<std::int32_t>();
+      }
+    }
+    if (flags & 0x1 << 2) {
+      reader.expectTag(MolPickler::ATOM_DUMMYLABEL, "ATOM_DUMMYLABEL");
+      reader.skipString();
+    }
+    if (flags & 0x1 << 1) {
+      auto tag = reader.readTag();
+      reader.withStream([this, tag](std::istream &ss) {
+        MolPickler::_skipAtomMonomerInfo(ss, tag, d_version);
+      });
+    }
+  }
+
+  // -------------------
+  //
+  // Bonds
+  //
+  // -------------------
+  reader.expectTag(MolPickler::BEGINBOND, "BEGINBOND");
+  d_bondOffsets.resize(d_numBonds);
+  for (unsigned int i = 0; i < d_numBonds; ++i) {
+    d_bondOffsets[i] = rdcast<std::uint32_t>(reader.pos());
+    for (unsigned int j = 0; j < 2; ++j) {
+      if (reader.readIndex(d_wideIndices) >= d_numAtoms) {
+        throw MolPicklerException("Bad pickle format: bad bond atom index");
+      }
+    }
+    auto flags = reader.read<unsigned char>();
+    if (flags & 0x1 << 3) {
+      reader.skip(1);
+    }
+    if (flags & 0x1 << 2) {
+      reader.skip(1);
+    }
+    if (flags & 0x1 << 1) {
+      reader.skip(1);
+      reader.skipIndices(d_wideIndices, reader.read<unsigned char>());
+    }
+    if (flags & 0x1) {
+      reader.skipString();
+      reader.skipString();
+    }
+    if (flags & 0x1 << 4) {
+      d_hasQueries = true;
+      reader.expectTag(MolPickler::BEGINQUERY, "BEGINQUERY");
+      reader.withStream([this](std::istream &ss) {
+        MolPickler::_skipQuery(ss, false, d_version);
+      });
+      reader.expectTag(MolPickler::ENDQUERY, "ENDQUERY");
+    }
+  }
+
+  // -------------------
+  //
+  // Rings, SubstanceGroups and StereoGroups
+  //
+  // -------------------
+  auto tag = reader.readTag();
+  if (tag == MolPickler::BEGINSSSR || tag == MolPickler::BEGINSYMMSSSR ||
+      tag == MolPickler::BEGINFASTFIND ||
+      tag == MolPickler::BEGINFINDOTHERORUNKNOWN) {
+    d_ringsOffset = reader.pos();
+    std::uint32_t numRings = d_version >= 13002
+                                 ? reader.read<std::uint32_t>()
+                                 : reader.readIndex(d_wideIndices);
+    for (std::uint32_t i = 0; i < numRings; ++i) {
+      reader.skipIndices(d_wideIndices, reader.readIndex(d_wideIndices));
+    }
+    tag = reader.readTag();
+  }
+  if (tag == MolPickler::BEGINSGROUP) {
+    auto numSGroups = reader.read<std::int32_t>();
+    for (std::int32_t i = 0; i < numSGroups; ++i) {
+      bool isSup = false;
+      reader.withStream([this, &isSup](std::istream &ss) {
+        RDProps sgroupProps;
+        MolPickler::_unpickleProperties(ss, sgroupProps, d_version);
+        std::string type;
+        isSup = sgroupProps.getPropIfPresent("TYPE", type) && type == "SUP";
+      });
+      // atoms, parent atoms and bonds:
+      for (unsigned int j = 0; j < 3; ++j) {
+        reader.skipIndices(d_wideIndices, reader.readIndex(d_wideIndices));
+      }
+      // brackets:
+      reader.skip(reader.readIndex(d_wideIndices) * 9 * sizeof(float));
+      // cstates:
+      auto numItems = reader.readIndex(d_wideIndices);
+      for (unsigned int j = 0; j < numItems; ++j) {
+        reader.skipIndices(d_wideIndices, 1);
+        if (isSup) {
+          reader.skip(3 * sizeof(float));
+        }
+      }
+      // attachment points:
+      numItems = reader.readIndex(d_wideIndices);
+      for (unsigned int j = 0; j < numItems; ++j) {
+        reader.skipIndices(d_wideIndices, 1);
+        reader.read<std::int32_t>();
+        reader.skipString();
+      }
+    }
+    tag = reader.readTag();
+  }
+  if (tag == MolPickler::BEGINSTEREOGROUP) {
+    auto numGroups = reader.readIndex(d_wideIndices);
+    for (unsigned int i = 0; i < numGroups; ++i) {
+      auto groupType =
+          static_cast<StereoGroupType>(reader.readIndex(d_wideIndices));
+      if (d_version >= 14010 &&
+          groupType != StereoGroupType::STEREO_ABSOLUTE) {
+        reader.readIndex(d_wideIndices);
+      }
+      reader.skipIndices(d_wideIndices, reader.readIndex(d_wideIndices));
+      if (d_version > 16000) {
+        reader.skipIndices(d_wideIndices, reader.readIndex(d_wideIndices));
+      }
+    }
+    tag = reader.readTag();
+  }
+
+  // -------------------
+  //
+  // Conformers and properties, these are only located here
+  //
+  // -------------------
+  if (tag == MolPickler::BEGINCONFS || tag == MolPickler::BEGINCONFS_DOUBLE) {
+    d_confsOffset = reader.pos() - 1;
+    auto blkSize = reader.read<std::int32_t>();
+    if (blkSize < 0) {
+      throw MolPicklerException("Bad pickle format: negative block size");
+    }
+    reader.skip(blkSize);
+    tag = reader.readTag();
+  }
+  d_propsOffset = reader.pos() - 1;
+  while (tag != MolPickler::ENDMOL) {
+    if (tag == MolPickler::BEGINPROPS || tag == MolPickler::BEGINATOMPROPS ||
+        tag == MolPickler::BEGINBONDPROPS) {
+      auto blkSize = reader.read<std::int32_t>();
+      if (blkSize < 0) {
+        throw MolPicklerException("Bad pickle format: negative block size");
+      }
+      reader.skip(blkSize);
+    } else if (tag == MolPickler::BEGINQUERYATOMDATA) {
+      for (unsigned int i = 0; i < d_numAtoms; ++i) {
+        reader.skipAtomData();
+      }
+    } else {
+      throw MolPicklerException("Bad pickle format: ENDMOL tag not found.");
+    }
+    reader.expectTag(MolPickler::ENDPROPS, "ENDPROPS");
+    tag = reader.readTag();
+  }
+}
+
+const char *MolPickleView::atomData(unsigned int idx,
+                                    unsigned int field) const {
+  URANGE_CHECK(idx, d_numAtoms);
+  const char *rec = d_pickle.data() + d_atomOffsets[2 * idx];
+  const char *p = rec + 2;
+  if (static_cast<unsigned char>(rec[1]) & 0x1 << 7) {
+    p += 3 * sizeof(float);
+  }
+  const auto propFlags = readAt<std::int32_t>(p);
+  if (!(propFlags & (1 << field))) {
+    return nullptr;
+  }
+  p += sizeof(std::int32_t);
+  for (unsigned int i = 0; i < field; ++i) {
+    if (propFlags & (1 << i)) {
+      p += atomFieldSize(i);
+    }
+  }
+  return p;
+}
+
+int MolPickleView::getAtomicNum(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numAtoms);
+  return static_cast<unsigned char>(d_pickle[d_atomOffsets[2 * idx]]);
+}
+bool MolPickleView::getIsAromatic(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numAtoms);
+  return d_pickle[d_atomOffsets[2 * idx] + 1] & 0x1 << 6;
+}
+bool MolPickleView::getNoImplicit(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numAtoms);
+  return d_pickle[d_atomOffsets[2 * idx] + 1] & 0x1 << 5;
+}
+bool MolPickleView::atomHasQuery(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numAtoms);
+  return d_pickle[d_atomOffsets[2 * idx] + 1] & 0x1 << 4;
+}
+int MolPickleView::getFormalCharge(unsigned int idx) const {
+  const auto p = atomData(idx, 1);
+  return p ? static_cast<signed char>(*p) : 0;
+}
+Atom::ChiralType MolPickleView::getChiralTag(unsigned int idx) const {
+  const auto p = atomData(idx, 2);
+  return static_cast<Atom::ChiralType>(p ? *p : 0);
+}
+Atom::HybridizationType MolPickleView::getHybridization(
+    unsigned int idx) const {
+  const auto p = atomData(idx, 3);
+  return p ? static_cast<Atom::HybridizationType>(*p) : Atom::SP3;
+}
+unsigned int MolPickleView::getNumExplicitHs(unsigned int idx) const {
+  const auto p = atomData(idx, 4);
+  return p ? static_cast<unsigned char>(*p) : 0;
+}
+unsigned int MolPickleView::getTotalNumHs(unsigned int idx) const {
+  unsigned int res = getNumExplicitHs(idx);
+  if (!getNoImplicit(idx)) {
+    const auto p = atomData(idx, 6);
+    res += p ? static_cast<unsigned char>(*p) : 0;
+  }
+  return res;
+}
+unsigned int MolPickleView::getNumRadicalElectrons(unsigned int idx) const {
+  const auto p = atomData(idx, 7);
+  return p ? static_cast<unsigned char>(*p) : 0;
+}
+unsigned int MolPickleView::getIsotope(unsigned int idx) const {
+  // the mass difference (field 0) is not written by any version which
+  // can be viewed, so we don't need to handle that
+  const auto p = atomData(idx, 8);
+  return p ? readAt<std::uint32_t>(p) : 0;
+}
+int MolPickleView::getAtomMapNum(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numAtoms);
+  if (!(d_pickle[d_atomOffsets[2 * idx] + 1] & 0x1 << 3)) {
+    return 0;
+  }
+  // skip the ATOM_MAPNUMBER tag:
+  const char *p = d_pickle.data() + d_atomOffsets[2 * idx + 1] + 1;
+  const auto val = static_cast<signed char>(*p);
+  return val < 0 ? readAt<std::int32_t>(p + 1) : val;
+}
+
+unsigned int MolPickleView::getBondBeginAtomIdx(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  const char *p = d_pickle.data() + d_bondOffsets[idx];
+  return d_wideIndices ? readAt<std::int32_t>(p)
+                       : static_cast<unsigned char>(*p);
+}
+unsigned int MolPickleView::getBondEndAtomIdx(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  const char *p = d_pickle.data() + d_bondOffsets[idx];
+  return d_wideIndices ? readAt<std::int32_t>(p + 4)
+                       : static_cast<unsigned char>(p[1]);
+}
+
+namespace {
+// returns the optional bond field with flag bit \c field (3: type, 2:
+// direction, 1: stereo) or nullptr if it isn't present
+const char *bondField(const char *rec, bool wideIndices, unsigned int field) {
+  const char *p = rec + (wideIndices ? 8 : 2);
+  const auto flags = static_cast<unsigned char>(*p++);
+  if (!(flags & 0x1 << field)) {
+    return nullptr;
+  }
+  for (unsigned int i = 3; i > field; --i) {
+    if (flags & 0x1 << i) {
+      ++p;
+    }
+  }
+  return p;
+}
+}  // namespace
+
+Bond::BondType MolPickleView::getBondType(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  const auto p = bondField(d_pickle.data() + d_bondOffsets[idx],
+                           d_wideIndices, 3);
+  return p ? static_cast<Bond::BondType>(*p) : Bond::SINGLE;
+}
+Bond::BondDir MolPickleView::getBondDir(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  const auto p = bondField(d_pickle.data() + d_bondOffsets[idx],
+                           d_wideIndices, 2);
+  return p ? static_cast<Bond::BondDir>(*p) : Bond::NONE;
+}
+Bond::BondStereo MolPickleView::getBondStereo(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  const auto p = bondField(d_pickle.data() + d_bondOffsets[idx],
+                           d_wideIndices, 1);
+  return p ? static_cast<Bond::BondStereo>(*p) : Bond::STEREONONE;
+}
+INT_VECT MolPickleView::getBondStereoAtoms(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  const auto p = bondField(d_pickle.data() + d_bondOffsets[idx],
+                           d_wideIndices, 1);
+  INT_VECT res;
+  if (!p) {
+    return res;
+  }
+  // the stereo is followed by the number of stereo atoms and their indices
+  const auto numStereoAtoms = static_cast<unsigned char>(p[1]);
+  const char *atomP = p + 2;
+  for (unsigned int i = 0; i < numStereoAtoms; ++i) {
+    int aidx;
+    if (d_wideIndices) {
+      aidx = readAt<std::int32_t>(atomP);
+      atomP += sizeof(std::int32_t);
+    } else {
+      aidx = static_cast<unsigned char>(*atomP++);
+    }
+    if (aidx < 0 || static_cast<unsigned int>(aidx) >= d_numAtoms) {
+      throw MolPicklerException("Bad pickle format: bad stereo atom index");
+    }
+    res.push_back(aidx);
+  }
+  return res;
+}
+bool MolPickleView::getBondIsAromatic(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  return d_pickle[d_bondOffsets[idx] + (d_wideIndices ? 8 : 2)] & 0x1 << 6;
+}
+bool MolPickleView::getBondIsConjugated(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  return d_pickle[d_bondOffsets[idx] + (d_wideIndices ? 8 : 2)] & 0x1 << 5;
+}
+bool MolPickleView::bondHasQuery(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  return d_pickle[d_bondOffsets[idx] + (d_wideIndices ? 8 : 2)] & 0x1 << 4;
+}
+
+unsigned int MolPickleView::getNumRings() const {
+  if (!d_ringsOffset) {
+    return 0;
+  }
+  const char *p = d_pickle.data() + d_ringsOffset;
+  if (d_version >= 13002) {
+    return readAt<std::uint32_t>(p);
+  }
+  return d_wideIndices ? readAt<std::int32_t>(p)
+                       : static_cast<unsigned char>(*p);
+}
+
+VECT_INT_VECT MolPickleView::getAtomRings() const {
+  VECT_INT_VECT res;
+  if (!d_ringsOffset) {
+    return res;
+  }
+  PickleReader reader(d_pickle);
+  reader.skip(d_ringsOffset);
+  std::uint32_t numRings = d_version >= 13002
+                               ? reader.read<std::uint32_t>()
+                               : reader.readIndex(d_wideIndices);
+  res.resize(numRings);
+  for (auto &ring : res) {
+    ring.resize(reader.readIndex(d_wideIndices));
+    for (auto &aidx : ring) {
+      aidx = static_cast<int>(reader.readIndex(d_wideIndices));
+      if (static_cast<unsigned int>(aidx) >= d_numAtoms) {
+        throw MolPicklerException("Bad pickle format: bad ring atom index");
+      }
+    }
+  }
+  return res;
+}
+
+unsigned int MolPickleView::getNumConformers() const {
+  if (!d_confsOffset) {
+    return 0;
+  }
+  // skip the tag and the block size:
+  return readAt<std::int32_t>(d_pickle.data() + d_confsOffset + 5);
+}
+
+const MolPickleView::LazyData &MolPickleView::decodeConformers() const {
+  if (!dp_lazy) {
+    dp_lazy = std::make_unique<LazyData>();
+  }
+  if (dp_lazy->confsDecoded || !d_confsOffset) {
+    return *dp_lazy;
+  }
+  const bool asDouble = static_cast<unsigned char>(d_pickle[d_confsOffset]) ==
+                        MolPickler::BEGINCONFS_DOUBLE;
+  const auto blkSize =
+      readAt<std::int32_t>(d_pickle.data() + d_confsOffset + 1);
+  // only read the conformer block:
+  const auto block = d_pickle.substr(d_confsOffset + 5, blkSize);
+  PickleReader reader(block);
+  std::vector<std::unique_ptr<Conformer>> conformers(
+      reader.read<std::int32_t>());
+  for (auto &conf : conformers) {
+    reader.withStream([&](std::istream &ss) {
+      conf.reset(MolPickler::_conformerFromPickle(ss, d_version, d_wideIndices,
+                                                  asDouble));
+    });
+  }
+  if (reader.pos() < block.size()) {
+    reader.expectTag(MolPickler::BEGINCONFPROPS, "BEGINCONFPROPS");
+    reader.read<std::int32_t>();
+    for (auto &conf : conformers) {
+      reader.withStream([&](std::istream &ss) {
+        MolPickler::_unpickleProperties(ss, *conf, d_version);
+      });
+    }
+  }
+  dp_lazy->conformers = std::move(conformers);
+  dp_lazy->confsDecoded = true;
+  return *dp_lazy;
+}
+
+const Conformer &MolPickleView::getConformer(int id) const {
+  const auto &lazy = decodeConformers();
+  if (lazy.conformers.empty()) {
+    throw ConformerException("No conformations available on the molecule");
+  }
+  if (id < 0) {
+    return *lazy.conformers.front();
+  }
+  for (const auto &conf : lazy.conformers) {
+    if (conf->getId() == static_cast<unsigned int>(id)) {
+      return *conf;
+    }
+  }
+  throw ConformerException("Can't find conformation with ID: " +
+                           std::to_string(id));
+}
+
+const MolPickleView::LazyData &MolPickleView::decodeProps() const {
+  if (!dp_lazy) {
+    dp_lazy = std::make_unique<LazyData>();
+  }
+  if (dp_lazy->propsDecoded) {
+    return *dp_lazy;
+  }
+  auto lazy = std::make_unique<LazyData>();
+  lazy->atomProps.resize(d_numAtoms);
+  lazy->bondProps.resize(d_numBonds);
+  PickleReader reader(d_pickle.substr(d_propsOffset));
+  auto tag = reader.readTag();
+  while (tag != MolPickler::ENDMOL) {
+    if (tag == MolPickler::BEGINQUERYATOMDATA) {
+      for (unsigned int i = 0; i < d_numAtoms; ++i) {
+        reader.skipAtomData();
+      }
+    } else {
+      reader.read<std::int32_t>();
+      reader.withStream([&](std::istream &ss) {
+        if (tag == MolPickler::BEGINPROPS) {
+          MolPickler::_unpickleProperties(ss, lazy->props, d_version);
+        } else if (tag == MolPickler::BEGINATOMPROPS) {
+          for (auto &props : lazy->atomProps) {
+            MolPickler::_unpickleAtomProperties(ss, props, d_version);
+          }
+        } else {
+          for (auto &props : lazy->bondProps) {
+            MolPickler::_unpickleBondProperties(ss, props, d_version);
+          }
+        }
+      });
+    }
+    reader.expectTag(MolPickler::ENDPROPS, "ENDPROPS");
+    tag = reader.readTag();
+  }
+  dp_lazy->props = std::move(lazy->props);
+  dp_lazy->atomProps = std::move(lazy->atomProps);
+  dp_lazy->bondProps = std::move(lazy->bondProps);
+  dp_lazy->propsDecoded = true;
+  return *dp_lazy;
+}
+
+const RDProps &MolPickleView::getProps() const { return decodeProps().props; }
+const RDProps &MolPickleView::getAtomProps(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numAtoms);
+  return decodeProps().atomProps[idx];
+}
+const RDProps &MolPickleView::getBondProps(unsigned int idx) const {
+  URANGE_CHECK(idx, d_numBonds);
+  return decodeProps().bondProps[idx];
+}
+
+ROMol *MolPickleView::toMol(unsigned int propertyFlags) const {
+  PickleStreamBuf buf(d_pickle.data(), d_pickle.data() + d_pickle.size());
+  std::istream ss(&buf);
+  std::unique_ptr<ROMol> res(new ROMol());
+  MolPickler::molFromPickle(ss, res.get(), propertyFlags);
+  return res.release();
+}
+}  // namespace RDKit
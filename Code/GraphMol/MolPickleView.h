@@ -0,0 +1,174 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include <RDGeneral/export.h>
+#ifndef RD_MOLPICKLEVIEW_H
+#define RD_MOLPICKLEVIEW_H
+
+#include <GraphMol/Atom.h>
+#include <GraphMol/Bond.h>
+#include <GraphMol/Conformer.h>
+#include <GraphMol/MolPickler.h>
+#include <RDGeneral/RDProps.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RDKit {
+class ROMol;
+
+//! A read-only view of a molecule pickle
+/*!
+  The view reads the atom and bond attributes directly from the pickle, so
+  looking at, for example, the number of atoms or the atomic number of an
+  atom does not require building an ROMol. Constructing the view only
+  reads the header and records where each atom and bond starts; conformers
+  and properties are decoded the first time they are accessed.
+
+  The view does not copy the pickle: the buffer it was constructed from
+  must outlive it.
+
+  Only pickles written by RDKit versions which use pickle format 13.0 or
+  later can be viewed; the constructor throws a MolPicklerException for
+  anything older. Use toMol() (or MolPickler::molFromPickle()) when the
+  full molecule is needed.
+
+  <b>Notes:</b>
+    - the lazily decoded parts of the view are cached without locking, so a
+      single view should not be used from multiple threads at once.
+*/
+class RDKIT_GRAPHMOL_EXPORT MolPickleView {
+ public:
+  //! constructs a view of the pickle in \c pickle
+  explicit MolPickleView(std::string_view pickle);
+  MolPickleView(const char *data, size_t size)
+      : MolPickleView(std::string_view(data, size)) {}
+  MolPickleView(const MolPickleView &) = delete;
+  MolPickleView &operator=(const MolPickleView &) = delete;
+  MolPickleView(MolPickleView &&) noexcept;
+  MolPickleView &operator=(MolPickleView &&) noexcept;
+  ~MolPickleView();
+
+  //! returns the version of the pickle as <tt>1000*major+10*minor+patch</tt>
+  int getVersion() const { return d_version; }
+  //! returns the pickle the view was constructed from
+  std::string_view getPickle() const { return d_pickle; }
+
+  unsigned int getNumAtoms() const { return d_numAtoms; }
+  unsigned int getNumBonds() const { return d_numBonds; }
+  //! returns whether or not any atom or bond has a query
+  bool hasQueries() const { return d_hasQueries; }
+
+  //! \name Atoms
+  //! @{
+  int getAtomicNum(unsigned int idx) const;
+  bool getIsAromatic(unsigned int idx) const;
+  bool getNoImplicit(unsigned int idx) const;
+  bool atomHasQuery(unsigned int idx) const;
+  int getFormalCharge(unsigned int idx) const;
+  Atom::ChiralType getChiralTag(unsigned int idx) const;
+  Atom::HybridizationType getHybridization(unsigned int idx) const;
+  unsigned int getNumExplicitHs(unsigned int idx) const;
+  //! returns the number of explicit and implicit Hs on the atom
+  /*!
+    Neighboring H atoms are not included, this is equivalent to
+    Atom::getTotalNumHs(false) on the unpickled atom.
+  */
+  unsigned int getTotalNumHs(unsigned int idx) const;
+  unsigned int getNumRadicalElectrons(unsigned int idx) const;
+  unsigned int getIsotope(unsigned int idx) const;
+  //! returns the atom map number of the atom, 0 if it does not have one
+  int getAtomMapNum(unsigned int idx) const;
+  //! @}
+
+  //! \name Bonds
+  //! @{
+  unsigned int getBondBeginAtomIdx(unsigned int idx) const;
+  unsigned int getBondEndAtomIdx(unsigned int idx) const;
+  Bond::BondType getBondType(unsigned int idx) const;
+  Bond::BondDir getBondDir(unsigned int idx) const;
+  Bond::BondStereo getBondStereo(unsigned int idx) const;
+  //! returns the stereo atoms of the bond, this is empty if it has none
+  INT_VECT getBondStereoAtoms(unsigned int idx) const;
+  bool getBondIsAromatic(unsigned int idx) const;
+  bool getBondIsConjugated(unsigned int idx) const;
+  bool bondHasQuery(unsigned int idx) const;
+  //! @}
+
+  //! returns whether or not the pickle includes ring information
+  bool hasRingInfo() const { return d_ringsOffset != 0; }
+  //! returns the number of rings in the pickled ring information
+  unsigned int getNumRings() const;
+  //! returns the atoms in each ring of the pickled ring information, in
+  //! the same format as RingInfo::atomRings()
+  VECT_INT_VECT getAtomRings() const;
+
+  //! \name Conformers
+  //! The conformers are decoded the first time one of these is called
+  //! @{
+  unsigned int getNumConformers() const;
+  //! returns the conformer with a particular ID, -1 returns the first one
+  const Conformer &getConformer(int id = -1) const;
+  //! @}
+
+  //! \name Properties
+  //! The properties are decoded the first time they are accessed
+  //! @{
+  //! returns the molecule's properties
+  const RDProps &getProps() const;
+  //! returns the properties of atom \c idx
+  const RDProps &getAtomProps(unsigned int idx) const;
+  //! returns the properties of bond \c idx
+  const RDProps &getBondProps(unsigned int idx) const;
+
+  bool hasProp(const std::string_view key) const {
+    return getProps().hasProp(key);
+  }
+  template <typename T>
+  T getProp(const std::string_view key) const {
+    return getProps().getProp<T>(key);
+  }
+  template <typename T>
+  bool getPropIfPresent(const std::string_view key, T &res) const {
+    return getProps().getPropIfPresent(key, res);
+  }
+  //! @}
+
+  //! decodes the full molecule, the caller owns the result
+  ROMol *toMol(unsigned int propertyFlags =
+                   PicklerOps::PropertyPickleOptions::AllProps) const;
+
+ private:
+  struct LazyData;
+
+  void index();
+  const char *atomData(unsigned int idx, unsigned int field) const;
+  const LazyData &decodeConformers() const;
+  const LazyData &decodeProps() const;
+
+  std::string_view d_pickle;
+  int d_version{0};
+  unsigned int d_numAtoms{0};
+  unsigned int d_numBonds{0};
+  bool d_wideIndices{false};  //!< atom indices are stored as int32
+  bool d_hasQueries{false};
+  //! for each atom: the offsets of its record and of its map number
+  std::vector<std::uint32_t> d_atomOffsets;
+  std::vector<std::uint32_t> d_bondOffsets;
+  size_t d_ringsOffset{0};
+  size_t d_confsOffset{0};
+  size_t d_propsOffset{0};
+  mutable std::unique_ptr<LazyData> dp_lazy;
+};
+
+}  // namespace RDKit
+#endif
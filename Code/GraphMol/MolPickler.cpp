@@ -2603,6 +2603,51 @@ void MolPickler::_unpickleProperties(std::istream &ss, RDProps &props,
 //
 //--------------------------------------
 
+Conformer *MolPickler::_conformerFromPickle(std::istream &ss, int version,
+                                            bool wideIndices, bool asDouble) {
+  if (wideIndices) {
+    return asDouble ? _conformerFromPickle<int32_t, double>(ss, version)
+                    : _conformerFromPickle<int32_t, float>(ss, version);
+  }
+  return asDouble ? _conformerFromPickle<unsigned char, double>(ss, version)
+                  : _conformerFromPickle<unsigned char, float>(ss, version);
+}
+
+void MolPickler::_unpickleAtomProperties(std::istream &ss, RDProps &props,
+                                         int version) {
+  unpickleAtomProperties(ss, props, version);
+}
+
+void MolPickler::_unpickleBondProperties(std::istream &ss, RDProps &props,
+                                         int version) {
+  unpickleBondProperties(ss, props, version);
+}
+
+void MolPickler::_skipQuery(std::istream &ss, bool atomQuery, int version) {
+  if (atomQuery) {
+    QueryAtom owner;
+    std::unique_ptr<Query<int, Atom const *, true>> query(
+        unpickleQuery(ss, &owner, version));
+  } else {
+    QueryBond owner;
+    std::unique_ptr<Query<int, Bond const *, true>> query(
+        unpickleQuery(ss, &owner, version));
+  }
+}
+
+void MolPickler::_skipAtomMonomerInfo(std::istream &ss, Tags tag,
+                                      int version) {
+  std::unique_ptr<AtomMonomerInfo> info;
+  if (tag == BEGIN_PDB_RESIDUE) {
+    info.reset(unpickleAtomPDBResidueInfo(ss, version));
+  } else if (tag == BEGIN_ATOM_MONOMER_INFO) {
+    info.reset(unpickleAtomMonomerInfo(ss, version));
+  } else {
+    throw MolPicklerException(
+        "Bad pickle format: BEGIN_PDB_RESIDUE or BEGIN_ATOM_MONOMER_INFO tag not found.");
+  }
+}
+
 void MolPickler::_pickleV1(const ROMol *mol, std::ostream &ss) {
   PRECONDITION(mol, "empty molecule");
   ROMol::ConstAtomIterator atIt;
@@ -34,6 +34,7 @@
 namespace RDKit {
 class ROMol;
 class RingInfo;
+class MolPickleView;
 
 //! used to indicate exceptions whilst pickling (serializing) molecules
 class RDKIT_GRAPHMOL_EXPORT MolPicklerException : public std::exception {
@@ -219,6 +220,8 @@ class RDKIT_GRAPHMOL_EXPORT MolPickler {
   }
 
  private:
+  friend class MolPickleView;
+
   //! Pickle nonquery atom data
   static std::int32_t _pickleAtomData(std::ostream &tss, const Atom *atom);
   //! depickle nonquery atom data
@@ -298,6 +301,8 @@ class RDKIT_GRAPHMOL_EXPORT MolPickler {
   //! extract a conformation from a pickle
   template <typename T, typename C>
   static Conformer *_conformerFromPickle(std::istream &ss, int version);
+  static Conformer *_conformerFromPickle(std::istream &ss, int version,
+                                         bool wideIndices, bool asDouble);
 
   //! pickle standard properties
   static void _pickleProperties(std::ostream &ss, const RDProps &props,
@@ -306,6 +311,17 @@ class RDKIT_GRAPHMOL_EXPORT MolPickler {
   static void _unpickleProperties(std::istream &ss, RDProps &props,
                                   int version);
 
+  //! unpickle the properties of a single atom
+  static void _unpickleAtomProperties(std::istream &ss, RDProps &props,
+                                      int version);
+  //! unpickle the properties of a single bond
+  static void _unpickleBondProperties(std::istream &ss, RDProps &props,
+                                      int version);
+  //! read and discard an atom (or bond) query
+  static void _skipQuery(std::istream &ss, bool atomQuery, int version);
+  //! read and discard atom monomer info which started with \c tag
+  static void _skipAtomMonomerInfo(std::istream &ss, Tags tag, int version);
+
   //! backwards compatibility
   static void _pickleV1(const ROMol *mol, std::ostream &ss);
   //! backwards compatibility
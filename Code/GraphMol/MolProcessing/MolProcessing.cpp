@@ -9,6 +9,15 @@
 //
 
 #include "MolProcessing.h"
+#include <DataStructs/BitOps.h>
+#include <GraphMol/SanitException.h>
+#include <RDGeneral/Exceptions.h>
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include <chrono>
+#include <map>
+#include <set>
 
 namespace RDKit {
 namespace MolProcessing {
@@ -27,6 +36,15 @@ inline std::unique_ptr<FileParsers::MolSupplier> getSupplier(
 }  // namespace details
 
 namespace {
+//! returns whether a null molecule from the supplier marks the end of the
+//! input rather than a record which could not be parsed
+bool hitEndOfInput(v2::FileParsers::MolSupplier *suppl) {
+  // the SD suppliers return a null molecule when there's trailing
+  // whitespace after the last record
+  auto sdsuppl = dynamic_cast<v2::FileParsers::ForwardSDMolSupplier *>(suppl);
+  return sdsuppl && sdsuppl->getEOFHitOnRead();
+}
+
 #ifdef RDK_BUILD_THREADSAFE_SSS
 inline std::mutex &get_fp_mutex() {
   // create on demand
@@ -51,11 +69,17 @@ std::vector<std::unique_ptr<T>> mtWorker(
   };
   suppl->setWriteCallback(workerfunc);
   // loop over the supplier to make sure we read everything
+  auto maxv = 0u;
   while (!suppl->atEnd()) {
     auto mol = suppl->next();
+    // records which failed to parse are included, but not the empty record
+    // the SMILES supplier returns at the end of the input
+    if (mol ||
+        !boost::algorithm::trim_copy(suppl->getLastItemText()).empty()) {
+      maxv = std::max(maxv, suppl->getLastRecordId());
+    }
   }
   // convert the map to a vector and get the results in the input order
-  auto maxv = 0u;
   for (const auto &pr : accum) {
     maxv = std::max(maxv, pr.first);
   }
@@ -89,13 +113,193 @@ std::vector<std::unique_ptr<T>> worker(v2::FileParsers::MolSupplier *suppl,
       if (mol) {
         auto fp = func(*mol);
         results.emplace_back(fp);
-      } else if (!suppl->atEnd()) {
+      } else if (!hitEndOfInput(suppl)) {
         results.emplace_back(nullptr);
       }
     }
     return results;
   }
 }
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+//! passes the fingerprints to the sink in input order
+class OrderedWriter {
+ public:
+  OrderedWriter(FingerprintSink &sink, FingerprintPipelineStats &stats)
+      : d_sink(sink), d_stats(stats) {}
+
+  void add(unsigned int recordId, std::unique_ptr<ExplicitBitVect> fp) {
+    d_pending[recordId] = std::move(fp);
+    d_stats.maxPending = std::max(d_stats.maxPending, d_pending.size());
+    writeReady();
+  }
+
+  //! the supplier returned something which is not an actual record
+  void skip(unsigned int recordId) {
+    d_skipped.insert(recordId);
+    writeReady();
+  }
+
+  //! writes whatever is left, filling in any missing records
+  void finish() {
+    while (!d_pending.empty()) {
+      writeReady();
+      if (!d_pending.empty()) {
+        writeFirst();
+      }
+    }
+    auto start = Clock::now();
+    d_sink.finish();
+    d_stats.writeSeconds += secondsSince(start);
+  }
+
+ private:
+  void writeReady() {
+    while (true) {
+      if (d_skipped.erase(d_nextRecordId)) {
+        ++d_nextRecordId;
+      } else if (!d_pending.empty() &&
+                 d_pending.begin()->first == d_nextRecordId) {
+        writeFirst();
+      } else {
+        break;
+      }
+    }
+  }
+
+  void writeFirst() {
+    auto first = d_pending.begin();
+    std::unique_ptr<ExplicitBitVect> fp;
+    if (first->first == d_nextRecordId) {
+      fp = std::move(first->second);
+      d_pending.erase(first);
+    }
+    ++d_stats.numRecords;
+    if (fp) {
+      ++d_stats.numFingerprints;
+    } else {
+      ++d_stats.numFailures;
+    }
+    auto start = Clock::now();
+    d_sink.write(d_nextRecordId++, fp.get());
+    d_stats.writeSeconds += secondsSince(start);
+  }
+
+  FingerprintSink &d_sink;
+  FingerprintPipelineStats &d_stats;
+  std::map<unsigned int, std::unique_ptr<ExplicitBitVect>> d_pending;
+  std::set<unsigned int> d_skipped;
+  unsigned int d_nextRecordId = 1;
+};
+
+#ifdef RDK_BUILD_THREADSAFE_SSS
+template <typename OutputType>
+void mtStreamWorker(v2::FileParsers::MultithreadedMolSupplier *suppl,
+                    FingerprintGenerator<OutputType> *generator,
+                    OrderedWriter &writer, FingerprintPipelineStats &stats) {
+  PRECONDITION(suppl, "no supplier");
+  std::mutex mutex;
+  std::map<unsigned int, std::unique_ptr<ExplicitBitVect>> fingerprints;
+  std::atomic<std::int64_t> fingerprintTicks{0};
+
+  // the fingerprints are generated in the supplier's threads, which hand
+  // them over to this one through the map
+  auto workerfunc = [&](RWMol &mol, const std::string &,
+                        unsigned int recordId) {
+    // each of the supplier's threads reuses its own buffers
+    thread_local FingerprintScratch<OutputType> scratch;
+    FingerprintFuncArguments args;
+    auto start = Clock::now();
+    auto fp = generator->getFingerprint(mol, args, scratch);
+    fingerprintTicks += (Clock::now() - start).count();
+    // the molecule is no longer needed, release it before it is queued
+    mol = RWMol();
+    std::lock_guard<std::mutex> lock(mutex);
+    fingerprints[recordId] = std::move(fp);
+  };
+  suppl->setWriteCallback(workerfunc);
+
+  unsigned int lastRecordId = 0;
+  while (!suppl->atEnd()) {
+    auto start = Clock::now();
+    auto mol = suppl->next();
+    stats.readSeconds += secondsSince(start);
+    auto recordId = suppl->getLastRecordId();
+    if (recordId == lastRecordId) {
+      // the supplier ran out of records
+      continue;
+    }
+    lastRecordId = recordId;
+    if (!mol &&
+        boost::algorithm::trim_copy(suppl->getLastItemText()).empty()) {
+      // the SMILES supplier returns an empty record at the end of the input
+      writer.skip(recordId);
+      continue;
+    }
+    std::unique_ptr<ExplicitBitVect> fp;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = fingerprints.find(recordId);
+      if (it != fingerprints.end()) {
+        fp = std::move(it->second);
+        fingerprints.erase(it);
+      }
+    }
+    writer.add(recordId, std::move(fp));
+  }
+  stats.fingerprintSeconds += std::chrono::duration<double>(
+                                  Clock::duration(fingerprintTicks.load()))
+                                  .count();
+}
+#endif
+
+template <typename OutputType>
+void streamWorker(v2::FileParsers::MolSupplier *suppl,
+                  FingerprintGenerator<OutputType> *generator,
+                  OrderedWriter &writer, FingerprintPipelineStats &stats) {
+  PRECONDITION(suppl, "no supplier");
+#ifdef RDK_BUILD_THREADSAFE_SSS
+  auto tsuppl =
+      dynamic_cast<v2::FileParsers::MultithreadedMolSupplier *>(suppl);
+  if (tsuppl) {
+    mtStreamWorker(tsuppl, generator, writer, stats);
+    return;
+  }
+#endif
+  FingerprintScratch<OutputType> scratch;
+  FingerprintFuncArguments args;
+  unsigned int recordId = 0;
+  while (!suppl->atEnd()) {
+    auto start = Clock::now();
+    auto mol = suppl->next();
+    stats.readSeconds += secondsSince(start);
+    if (!mol && hitEndOfInput(suppl)) {
+      break;
+    }
+    std::unique_ptr<ExplicitBitVect> fp;
+    if (mol) {
+      start = Clock::now();
+      // molecules which can't be fingerprinted are reported as failures,
+      // the multithreaded suppliers do the same
+      try {
+        fp = generator->getFingerprint(*mol, args, scratch);
+      } catch (const Invar::Invariant &) {
+      } catch (const MolSanitizeException &) {
+      } catch (const ValueErrorException &) {
+      } catch (const KeyErrorException &) {
+      } catch (const IndexErrorException &) {
+      }
+      stats.fingerprintSeconds += secondsSince(start);
+      mol.reset();
+    }
+    writer.add(++recordId, std::move(fp));
+  }
+}
 }  // namespace
 
 //! \brief Get fingerprints for all of the molecules in a file
@@ -142,5 +346,71 @@ template RDKIT_MOLPROCESSING_EXPORT
         const GeneralMolSupplier::SupplierOptions &options,
         FingerprintGenerator<std::uint64_t> *generator);
 
+PackedFingerprintWriter::PackedFingerprintWriter(std::ostream &strm,
+                                                 unsigned int numBits)
+    : d_strm(strm), d_numBits(numBits), d_empty((numBits + 7) / 8, '\0') {
+  PRECONDITION(numBits > 0, "the fingerprints must have at least one bit");
+}
+
+void PackedFingerprintWriter::write(unsigned int, const ExplicitBitVect *fp) {
+  if (fp) {
+    if (fp->getNumBits() != d_numBits) {
+      throw ValueErrorException(
+          "fingerprint size does not match the size of the column");
+    }
+    d_strm << BitVectToBinaryText(*fp);
+  } else {
+    d_strm.write(d_empty.data(), d_empty.size());
+  }
+  if (!d_strm) {
+    throw ValueErrorException("error writing the fingerprints");
+  }
+  ++d_numRecords;
+}
+
+void PackedFingerprintWriter::finish() { d_strm.flush(); }
+
+void FPBFingerprintWriter::write(unsigned int recordId,
+                                 const ExplicitBitVect *fp) {
+  if (fp) {
+    d_writer.write(*fp, std::to_string(recordId));
+  }
+}
+
+void FPBFingerprintWriter::finish() { d_writer.close(); }
+
+template <typename OutputType>
+FingerprintPipelineStats writeFingerprintsForMolsInFile(
+    const std::string &fileName, FingerprintSink &sink,
+    const GeneralMolSupplier::SupplierOptions &options,
+    FingerprintGenerator<OutputType> *generator) {
+  auto start = Clock::now();
+  auto suppl = details::getSupplier(fileName, options);
+
+  std::unique_ptr<FingerprintGenerator<OutputType>> morgan;
+  if (generator == nullptr) {
+    morgan.reset(MorganFingerprint::getMorganGenerator<OutputType>(3));
+    generator = morgan.get();
+  }
+
+  FingerprintPipelineStats stats;
+  OrderedWriter writer(sink, stats);
+  streamWorker(suppl.get(), generator, writer, stats);
+  writer.finish();
+  stats.elapsedSeconds = secondsSince(start);
+  return stats;
+}
+
+template RDKIT_MOLPROCESSING_EXPORT FingerprintPipelineStats
+writeFingerprintsForMolsInFile(
+    const std::string &fileName, FingerprintSink &sink,
+    const GeneralMolSupplier::SupplierOptions &options,
+    FingerprintGenerator<std::uint32_t> *generator);
+template RDKIT_MOLPROCESSING_EXPORT FingerprintPipelineStats
+writeFingerprintsForMolsInFile(
+    const std::string &fileName, FingerprintSink &sink,
+    const GeneralMolSupplier::SupplierOptions &options,
+    FingerprintGenerator<std::uint64_t> *generator);
+
 }  // namespace MolProcessing
 }  // namespace RDKit
@@ -11,9 +11,13 @@
 #ifndef RD_MOLPROCESSING_H
 #define RD_MOLPROCESSING_H
 
+#include <cstdint>
+#include <ostream>
+#include <string>
 #include <vector>
 #include <boost/dynamic_bitset.hpp>
 #include <DataStructs/BitVects.h>
+#include <DataStructs/FPBWriter.h>
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/FileParsers/GeneralFileReader.h>
 #include <GraphMol/Fingerprints/FingerprintGenerator.h>
@@ -37,6 +41,112 @@ std::vector<std::unique_ptr<ExplicitBitVect>> getFingerprintsForMolsInFile(
         details::defaultSupplierOptions,
     FingerprintGenerator<OutputType> *generator = nullptr);
 
+//! receives the fingerprints from writeFingerprintsForMolsInFile()
+class RDKIT_MOLPROCESSING_EXPORT FingerprintSink {
+ public:
+  virtual ~FingerprintSink() = default;
+  //! called for each record of the input, in input order
+  /*!
+    \param recordId the index of the record in the input, starting from 1
+    \param fp       the fingerprint, nullptr if the record could not be
+                    parsed or fingerprinted. The sink does not own it.
+  */
+  virtual void write(unsigned int recordId, const ExplicitBitVect *fp) = 0;
+  //! called once all the records have been written
+  virtual void finish() {}
+};
+
+//! writes fingerprints to a stream as a packed binary column
+/*!
+  Each record is written as numBits/8 (rounded up) bytes, with bit i of
+  the fingerprint in bit i%8 of byte i/8. This is the layout produced by
+  BitVectToBinaryText() and used by the PostgreSQL cartridge's bfp type,
+  so record n of the input starts at byte (n-1)*getNumBytes().
+
+  Records which could not be processed are written as fingerprints with no
+  bits set.
+*/
+class RDKIT_MOLPROCESSING_EXPORT PackedFingerprintWriter
+    : public FingerprintSink {
+ public:
+  PackedFingerprintWriter(std::ostream &strm, unsigned int numBits);
+  void write(unsigned int recordId, const ExplicitBitVect *fp) override;
+  void finish() override;
+
+  unsigned int getNumBytes() const { return d_empty.size(); }
+  std::uint64_t getNumRecords() const { return d_numRecords; }
+
+ private:
+  std::ostream &d_strm;
+  unsigned int d_numBits;
+  std::string d_empty;
+  std::uint64_t d_numRecords = 0;
+};
+
+//! writes fingerprints to an FPB file
+/*!
+  The id of each fingerprint is its record id. Records which could not be
+  processed are skipped. finish() closes the FPBWriter, which sorts the
+  fingerprints and writes the file.
+*/
+class RDKIT_MOLPROCESSING_EXPORT FPBFingerprintWriter
+    : public FingerprintSink {
+ public:
+  explicit FPBFingerprintWriter(FPBWriter &writer) : d_writer(writer) {}
+  void write(unsigned int recordId, const ExplicitBitVect *fp) override;
+  void finish() override;
+
+ private:
+  FPBWriter &d_writer;
+};
+
+//! counters collected by writeFingerprintsForMolsInFile()
+/*!
+  The times of the different stages can be compared to find the one which
+  limits the throughput. With a multithreaded supplier the records are
+  parsed and fingerprinted by the supplier's threads, and readSeconds is
+  the time spent waiting for them.
+*/
+struct FingerprintPipelineStats {
+  std::uint64_t numRecords = 0;       //!< records read from the input
+  std::uint64_t numFingerprints = 0;  //!< records which were fingerprinted
+  std::uint64_t numFailures = 0;  //!< records which could not be processed
+  //! time spent getting molecules from the supplier
+  double readSeconds = 0.0;
+  //! time spent generating fingerprints, summed over all the threads
+  double fingerprintSeconds = 0.0;
+  //! time spent in the sink
+  double writeSeconds = 0.0;
+  double elapsedSeconds = 0.0;
+  //! the largest number of fingerprints waiting for earlier records
+  size_t maxPending = 0;
+};
+
+//! \brief Fingerprints the molecules in a file and passes the fingerprints
+//! to a sink as they are generated
+/*!
+   Unlike getFingerprintsForMolsInFile(), neither the molecules nor the
+   fingerprints are kept: each molecule is released as soon as it has been
+   fingerprinted, and each fingerprint as soon as the sink has written it.
+   The memory used is determined by the supplier's queues and does not
+   depend on the size of the input.
+
+   \param fileName the name of the file to read
+   \param sink     receives the fingerprints, in input order
+   \param options  options controlling how the file is read, if not
+                   provided four threads will be used when reading the file
+   \param generator the fingerprint generator to use, if not provided,
+           Morgan fingerprints with radius of 3 will be used.
+
+   \return counters for the different stages of the pipeline
+*/
+template <typename OutputType = std::uint32_t>
+FingerprintPipelineStats writeFingerprintsForMolsInFile(
+    const std::string &fileName, FingerprintSink &sink,
+    const GeneralMolSupplier::SupplierOptions &options =
+        details::defaultSupplierOptions,
+    FingerprintGenerator<OutputType> *generator = nullptr);
+
 }  // namespace MolProcessing
 }  // namespace RDKit
 #endif
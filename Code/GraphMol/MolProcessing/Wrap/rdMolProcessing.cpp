@@ -13,6 +13,8 @@
 #include <GraphMol/MolProcessing/MolProcessing.h>
 #include <GraphMol/FileParsers/GeneralFileReader.h>
 
+#include <fstream>
+
 namespace python = boost::python;
 using namespace RDKit;
 
@@ -43,6 +45,46 @@ python::tuple getFingerprintsHelper(
 
   return python::tuple(pyFingerprints);
 }
+
+template <typename OutputType>
+python::dict writeFingerprintsHelper(
+    const std::string &fileName, const std::string &outputFileName,
+    python::object pyGenerator,
+    const GeneralMolSupplier::SupplierOptions &options) {
+  FingerprintGenerator<OutputType> *generator = nullptr;
+  if (pyGenerator) {
+    generator =
+        python::extract<FingerprintGenerator<OutputType> *>(pyGenerator);
+  }
+  std::unique_ptr<FingerprintGenerator<OutputType>> morgan;
+  if (generator == nullptr) {
+    morgan.reset(MorganFingerprint::getMorganGenerator<OutputType>(3));
+    generator = morgan.get();
+  }
+
+  MolProcessing::FingerprintPipelineStats stats;
+  {
+    NOGIL gil;
+    std::ofstream outStrm(outputFileName, std::ios::out | std::ios::binary);
+    if (!outStrm) {
+      throw ValueErrorException("could not open " + outputFileName);
+    }
+    MolProcessing::PackedFingerprintWriter writer(
+        outStrm, generator->getOptions()->d_fpSize);
+    stats = MolProcessing::writeFingerprintsForMolsInFile(fileName, writer,
+                                                          options, generator);
+  }
+  python::dict res;
+  res["numRecords"] = stats.numRecords;
+  res["numFingerprints"] = stats.numFingerprints;
+  res["numFailures"] = stats.numFailures;
+  res["readSeconds"] = stats.readSeconds;
+  res["fingerprintSeconds"] = stats.fingerprintSeconds;
+  res["writeSeconds"] = stats.writeSeconds;
+  res["elapsedSeconds"] = stats.elapsedSeconds;
+  res["maxPending"] = stats.maxPending;
+  return res;
+}
 }  // namespace
 
 BOOST_PYTHON_MODULE(rdMolProcessing) {
@@ -95,4 +137,35 @@ BOOST_PYTHON_MODULE(rdMolProcessing) {
       (python::arg("filename"), python::arg("generator") = python::object(),
        python::arg("options") = GeneralMolSupplier::SupplierOptions()),
       "returns the fingerprints for the molecules in a file (64 bit version)");
+
+  std::string docString =
+      R"DOC(writes the fingerprints for the molecules in a file to outputFilename
+as a packed binary column: one record of fpSize/8 bytes for each record of
+the input, in input order. Records which could not be processed are
+written as fingerprints with no bits set.
+The molecules and fingerprints are not kept in memory, so this can be used
+with inputs of any size.
+
+Returns a dictionary with the number of records processed and the time
+spent in the different stages.)DOC";
+  python::def(
+      "WriteFingerprintsForMolsInFile",
+      (python::dict(*)(const std::string &, const std::string &,
+                       python::object,
+                       const GeneralMolSupplier::SupplierOptions &))
+          writeFingerprintsHelper<std::uint32_t>,
+      (python::arg("filename"), python::arg("outputFilename"),
+       python::arg("generator") = python::object(),
+       python::arg("options") = GeneralMolSupplier::SupplierOptions()),
+      docString.c_str());
+  python::def(
+      "WriteFingerprintsForMolsInFile",
+      (python::dict(*)(const std::string &, const std::string &,
+                       python::object,
+                       const GeneralMolSupplier::SupplierOptions &))
+          writeFingerprintsHelper<std::uint64_t>,
+      (python::arg("filename"), python::arg("outputFilename"),
+       python::arg("generator") = python::object(),
+       python::arg("options") = GeneralMolSupplier::SupplierOptions()),
+      docString.c_str());
 }
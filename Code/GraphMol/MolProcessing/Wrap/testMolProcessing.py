@@ -7,6 +7,8 @@
 #  which is included in the file license.txt, found at the root
 #  of the RDKit source tree.
 
+import os
+import tempfile
 import unittest
 
 #
@@ -51,6 +53,21 @@ class TestCase(unittest.TestCase):
     self.assertEqual(DataStructs.TanimotoSimilarity(fps[0], fps[1]),
                      DataStructs.TanimotoSimilarity(nfps[0], nfps[1]))
 
+  def test3(self):
+    fpg = rdFingerprintGenerator.GetMorganGenerator(radius=2, fpSize=1024)
+    fps = rdMolProcessing.GetFingerprintsForMolsInFile(self.sdFile, generator=fpg)
+    with tempfile.TemporaryDirectory() as tmpdir:
+      fname = os.path.join(tmpdir, 'fps.bin')
+      stats = rdMolProcessing.WriteFingerprintsForMolsInFile(self.sdFile, fname, generator=fpg)
+      self.assertEqual(stats['numRecords'], 200)
+      self.assertEqual(stats['numFingerprints'], 200)
+      self.assertEqual(stats['numFailures'], 0)
+      with open(fname, 'rb') as inf:
+        column = inf.read()
+    self.assertEqual(len(column), 200 * 128)
+    for i, fp in enumerate(fps):
+      self.assertEqual(column[i * 128:(i + 1) * 128], DataStructs.BitVectToBinaryText(fp))
+
 
 if __name__ == '__main__':  # pragma: nocover
   unittest.main()
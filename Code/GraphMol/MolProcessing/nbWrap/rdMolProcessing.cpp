@@ -11,6 +11,8 @@
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/string.h>
 
+#include <fstream>
+
 #include <GraphMol/MolProcessing/MolProcessing.h>
 #include <GraphMol/FileParsers/GeneralFileReader.h>
 #include <RDBoost/Wrap.h>
@@ -46,6 +48,49 @@ nb::tuple getFingerprintsHelper(
   }
   return nb::tuple(pyFingerprints);
 }
+
+template <typename OutputType>
+nb::dict writeFingerprintsHelper(
+    const std::string &fileName, const std::string &outputFileName,
+    nb::object pyGenerator,
+    const GeneralMolSupplier::SupplierOptions &options) {
+  FingerprintGenerator<OutputType> *generator = nullptr;
+  if (!pyGenerator.is_none()) {
+    try {
+      generator = nb::cast<FingerprintGenerator<OutputType> *>(pyGenerator);
+    } catch (const nb::cast_error &) {
+      throw nb::next_overload();
+    }
+  }
+  std::unique_ptr<FingerprintGenerator<OutputType>> morgan;
+  if (generator == nullptr) {
+    morgan.reset(MorganFingerprint::getMorganGenerator<OutputType>(3));
+    generator = morgan.get();
+  }
+
+  MolProcessing::FingerprintPipelineStats stats;
+  {
+    NOGIL gil;
+    std::ofstream outStrm(outputFileName, std::ios::out | std::ios::binary);
+    if (!outStrm) {
+      throw ValueErrorException("could not open " + outputFileName);
+    }
+    MolProcessing::PackedFingerprintWriter writer(
+        outStrm, generator->getOptions()->d_fpSize);
+    stats = MolProcessing::writeFingerprintsForMolsInFile(fileName, writer,
+                                                          options, generator);
+  }
+  nb::dict res;
+  res["numRecords"] = stats.numRecords;
+  res["numFingerprints"] = stats.numFingerprints;
+  res["numFailures"] = stats.numFailures;
+  res["readSeconds"] = stats.readSeconds;
+  res["fingerprintSeconds"] = stats.fingerprintSeconds;
+  res["writeSeconds"] = stats.writeSeconds;
+  res["elapsedSeconds"] = stats.elapsedSeconds;
+  res["maxPending"] = stats.maxPending;
+  return res;
+}
 }  // namespace
 
 NB_MODULE(rdMolProcessing, m) {
@@ -85,4 +130,23 @@ NB_MODULE(rdMolProcessing, m) {
         "filename"_a, "generator"_a = nb::none(),
         "options"_a = GeneralMolSupplier::SupplierOptions(),
         "returns the fingerprints for the molecules in a file (64 bit version)");
+
+  const char *docString =
+      R"DOC(writes the fingerprints for the molecules in a file to outputFilename
+as a packed binary column: one record of fpSize/8 bytes for each record of
+the input, in input order. Records which could not be processed are
+written as fingerprints with no bits set.
+The molecules and fingerprints are not kept in memory, so this can be used
+with inputs of any size.
+
+Returns a dictionary with the number of records processed and the time
+spent in the different stages.)DOC";
+  m.def("WriteFingerprintsForMolsInFile",
+        writeFingerprintsHelper<std::uint32_t>, "filename"_a,
+        "outputFilename"_a, "generator"_a = nb::none(),
+        "options"_a = GeneralMolSupplier::SupplierOptions(), docString);
+  m.def("WriteFingerprintsForMolsInFile",
+        writeFingerprintsHelper<std::uint64_t>, "filename"_a,
+        "outputFilename"_a, "generator"_a = nb::none(),
+        "options"_a = GeneralMolSupplier::SupplierOptions(), docString);
 }
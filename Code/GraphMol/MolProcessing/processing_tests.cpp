@@ -13,10 +13,27 @@
 #include "RDGeneral/test.h"
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/MolProcessing/MolProcessing.h>
+#include <GraphMol/FileParsers/FileWriters.h>
+#include <GraphMol/SmilesParse/SmilesParse.h>
+#include <DataStructs/BitOps.h>
+#include <DataStructs/FPBReader.h>
 #include <RDGeneral/RDLog.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
 
 using namespace RDKit;
 
+namespace {
+// ctest may run several test processes at once, so each file gets its own name
+std::string uniqueTempPath(const std::string &extension) {
+  std::ostringstream name;
+  name << "testMolProcessing_" << std::random_device()() << extension;
+  return (std::filesystem::temp_directory_path() / name.str()).string();
+}
+}  // namespace
+
 TEST_CASE("getFingerprintsForMolsInFile") {
   std::string dirName = getenv("RDBASE");
   dirName += "/Data/NCI/";
@@ -49,4 +66,140 @@ TEST_CASE("getFingerprintsForMolsInFile") {
       CHECK(res.size() == 4999);
     }
   }
-}
\ No newline at end of file
+}
+TEST_CASE("writeFingerprintsForMolsInFile") {
+  std::string dirName = getenv("RDBASE");
+  dirName += "/Data/NCI/";
+  std::unique_ptr<FingerprintGenerator<std::uint32_t>> fpg(
+      MorganFingerprint::getMorganGenerator<std::uint32_t>(2));
+  SECTION("packed column") {
+    std::string fileName = dirName + "first_200.props.sdf";
+    auto fps = MolProcessing::getFingerprintsForMolsInFile<>(
+        fileName, MolProcessing::details::defaultSupplierOptions, fpg.get());
+    for (auto numThreads : {1, 4}) {
+      INFO(numThreads);
+      GeneralMolSupplier::SupplierOptions options;
+      options.numWriterThreads = numThreads;
+      std::ostringstream oss;
+      MolProcessing::PackedFingerprintWriter writer(oss, 2048);
+      auto stats = MolProcessing::writeFingerprintsForMolsInFile(
+          fileName, writer, options, fpg.get());
+      CHECK(stats.numRecords == 200);
+      CHECK(stats.numFingerprints == 200);
+      CHECK(stats.numFailures == 0);
+      CHECK(writer.getNumBytes() == 256);
+      CHECK(writer.getNumRecords() == 200);
+      auto column = oss.str();
+      REQUIRE(column.size() == 200 * 256);
+      REQUIRE(fps.size() == 200);
+      for (auto i = 0u; i < fps.size(); ++i) {
+        INFO(i);
+        REQUIRE(fps[i]);
+        CHECK(column.substr(i * 256, 256) == BitVectToBinaryText(*fps[i]));
+      }
+    }
+  }
+  SECTION("failures") {
+    std::string fileName = dirName + "first_5K.smi";
+    boost::logging::disable_logs("rdApp.*");
+    for (auto numThreads : {1, 4}) {
+      INFO(numThreads);
+      GeneralMolSupplier::SupplierOptions options;
+      options.numWriterThreads = numThreads;
+      options.titleLine = false;
+      auto fps = MolProcessing::getFingerprintsForMolsInFile<>(
+          fileName, options, fpg.get());
+
+      // the sink sees the records in order, with nulls for the failures
+      class CheckingSink : public MolProcessing::FingerprintSink {
+       public:
+        CheckingSink(const std::vector<std::unique_ptr<ExplicitBitVect>> &fps)
+            : d_fps(fps) {}
+        void write(unsigned int recordId, const ExplicitBitVect *fp) override {
+          CHECK(recordId == ++numWritten);
+          REQUIRE(recordId <= d_fps.size());
+          const auto &expected = d_fps[recordId - 1];
+          REQUIRE((fp != nullptr) == (expected != nullptr));
+          if (fp) {
+            CHECK(*fp == *expected);
+          }
+        }
+        void finish() override { finished = true; }
+        unsigned int numWritten = 0;
+        bool finished = false;
+
+       private:
+        const std::vector<std::unique_ptr<ExplicitBitVect>> &d_fps;
+      } sink(fps);
+
+      auto stats = MolProcessing::writeFingerprintsForMolsInFile(
+          fileName, sink, options, fpg.get());
+      CHECK(sink.finished);
+      CHECK(sink.numWritten == fps.size());
+      CHECK(stats.numRecords == fps.size());
+      auto numFailures = std::count(fps.begin(), fps.end(), nullptr);
+      CHECK(numFailures > 0);
+      CHECK(stats.numFailures == static_cast<std::uint64_t>(numFailures));
+      CHECK(stats.numFingerprints + stats.numFailures == stats.numRecords);
+    }
+  }
+  SECTION("failure in the last record") {
+    auto fileName = uniqueTempPath(".sdf");
+    {
+      std::ofstream outs(fileName);
+      auto mol = "CCO"_smiles;
+      outs << MolToMolBlock(*mol) << "$$$$\n";
+      // a five-valent carbon
+      v2::SmilesParse::SmilesParserParams ps;
+      ps.sanitize = false;
+      auto bad = v2::SmilesParse::MolFromSmiles("C(C)(C)(C)(C)C", ps);
+      REQUIRE(bad);
+      outs << MolToMolBlock(*bad) << "$$$$\n";
+    }
+    boost::logging::disable_logs("rdApp.*");
+    for (auto numThreads : {1, 4}) {
+      INFO(numThreads);
+      GeneralMolSupplier::SupplierOptions options;
+      options.numWriterThreads = numThreads;
+      auto fps = MolProcessing::getFingerprintsForMolsInFile<>(
+          fileName, options, fpg.get());
+      REQUIRE(fps.size() == 2);
+      CHECK(fps[0]);
+      CHECK(!fps[1]);
+      std::ostringstream oss;
+      MolProcessing::PackedFingerprintWriter writer(oss, 2048);
+      auto stats = MolProcessing::writeFingerprintsForMolsInFile(
+          fileName, writer, options, fpg.get());
+      CHECK(stats.numRecords == 2);
+      CHECK(stats.numFingerprints == 1);
+      CHECK(stats.numFailures == 1);
+      CHECK(writer.getNumRecords() == 2);
+    }
+    std::filesystem::remove(fileName);
+  }
+  SECTION("FPB file") {
+    std::string fileName = dirName + "first_200.props.sdf";
+    auto fps = MolProcessing::getFingerprintsForMolsInFile<>(
+        fileName, MolProcessing::details::defaultSupplierOptions, fpg.get());
+    auto outName = uniqueTempPath(".fpb");
+    {
+      FPBWriter fpbWriter(outName, 2048);
+      MolProcessing::FPBFingerprintWriter writer(fpbWriter);
+      auto stats = MolProcessing::writeFingerprintsForMolsInFile(
+          fileName, writer, MolProcessing::details::defaultSupplierOptions,
+          fpg.get());
+      CHECK(stats.numFingerprints == 200);
+      CHECK(fpbWriter.length() == 200);
+    }
+    FPBReader reader(outName);
+    reader.init();
+    REQUIRE(reader.length() == 200);
+    for (auto i = 0u; i < reader.length(); ++i) {
+      auto recordId = std::stoul(reader.getId(i));
+      REQUIRE(recordId >= 1);
+      REQUIRE(recordId <= fps.size());
+      CHECK(*reader.getFP(i) == *fps[recordId - 1]);
+    }
+    std::filesystem::remove(outName);
+  }
+}
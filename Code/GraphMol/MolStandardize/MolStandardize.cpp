@@ -51,6 +51,7 @@ void updateCleanupParamsFromJSON(CleanupParameters &params,
   PT_OPT_GET(fragmentFile);
   PT_OPT_GET(tautomerTransforms);
   PT_OPT_GET(maxRestarts);
+  PT_OPT_GET(normalizeSinglePass);
   PT_OPT_GET(preferOrganic);
   PT_OPT_GET(doCanonical);
   PT_OPT_GET(maxTautomers);
@@ -51,6 +51,9 @@ struct RDKIT_MOLSTANDARDIZE_EXPORT CleanupParameters {
   std::string tautomerTransforms;
   int maxRestarts{200};  //!< The maximum number of times to attempt to apply
                          //!< the series of normalizations (default 200).
+  bool normalizeSinglePass{
+      false};  //!< Whether the Normalizer should try all transforms before
+               //!< restarting (defaults to false)
   bool preferOrganic{false};  //!< Whether to prioritize organic fragments when
                               //!< choosing fragment parent (default False).
   bool doCanonical{true};     //!< Whether to apply normalizations in a
@@ -15,6 +15,11 @@
 #include <GraphMol/SmilesParse/SmilesWrite.h>
 #include <GraphMol/SanitException.h>
 #include <GraphMol/ChemTransforms/ChemTransforms.h>
+#include <GraphMol/QueryAtom.h>
+#include <GraphMol/QueryBond.h>
+#include <GraphMol/SmilesParse/SmartsWrite.h>
+#include <atomic>
+#include <map>
 #include <RDGeneral/BoostStartInclude.h>
 #include <boost/flyweight.hpp>
 #include <boost/flyweight/key_value.hpp>
@@ -43,6 +48,135 @@ typedef boost::flyweight<boost::flyweights::key_value<
 
 // unsigned int MAX_RESTARTS = 200;
 
+namespace detail {
+// The atoms and bonds which the reactant template of each transform needs to
+// find in a molecule, along with the statistics for the transforms.
+// A substructure match maps each template atom to a different atom of the
+// molecule, so a query which appears n times in the template must match at
+// least n atoms of the molecule.
+class NormalizerPrescreen {
+ public:
+  struct Counters {
+    std::atomic<std::uint64_t> numTested{0};
+    std::atomic<std::uint64_t> numSkipped{0};
+    std::atomic<std::uint64_t> numFired{0};
+  };
+
+  explicit NormalizerPrescreen(
+      const std::vector<std::shared_ptr<ChemicalReaction>> &transforms)
+      : d_counters(new Counters[transforms.size()]),
+        d_atoms(transforms.size()),
+        d_bonds(transforms.size()) {
+    for (unsigned int i = 0; i < transforms.size(); ++i) {
+      const auto &transform = *transforms[i];
+      std::string name;
+      transform.getPropIfPresent(common_properties::_Name, name);
+      d_names.push_back(name);
+      if (transform.getNumReactantTemplates() != 1) {
+        continue;
+      }
+      const auto &ps = transform.getSubstructParams();
+      const auto &templ = *transform.getReactants()[0];
+      if (!ps.useQueryQueryMatches &&
+          !(ps.extraAtomCheck && ps.extraAtomCheckOverridesDefaultCheck)) {
+        addRequirements(templ.atoms(), d_atoms[i]);
+      }
+      if (!ps.useQueryQueryMatches &&
+          !(ps.extraBondCheck && ps.extraBondCheckOverridesDefaultCheck)) {
+        addRequirements(templ.bonds(), d_bonds[i]);
+      }
+    }
+  }
+
+  //! returns false if transform \c idx cannot match \c mol
+  bool canMatch(unsigned int idx, const ROMol &mol) const {
+    try {
+      return hasEnough(d_atoms[idx], mol.atoms()) &&
+             hasEnough(d_bonds[idx], mol.bonds());
+    } catch (const std::exception &) {
+      // the queries can't be evaluated on this molecule (e.g. because the
+      // implicit valences are not set), leave the decision to the transform
+      return true;
+    }
+  }
+
+  Counters &getCounters(unsigned int idx) const { return d_counters[idx]; }
+  const std::string &getName(unsigned int idx) const { return d_names[idx]; }
+  unsigned int size() const {
+    return static_cast<unsigned int>(d_names.size());
+  }
+
+ private:
+  template <typename T>
+  using Requirements =
+      std::vector<std::pair<std::unique_ptr<T>, unsigned int>>;
+
+  std::unique_ptr<Counters[]> d_counters;
+  std::vector<std::string> d_names;
+  std::vector<Requirements<QueryAtom>> d_atoms;
+  std::vector<Requirements<QueryBond>> d_bonds;
+
+  static bool hasRecursiveQuery(const Atom::QUERYATOM_QUERY *query) {
+    if (dynamic_cast<const RecursiveStructureQuery *>(query)) {
+      return true;
+    }
+    for (auto it = query->beginChildren(); it != query->endChildren(); ++it) {
+      if (hasRecursiveQuery(it->get())) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // recursive queries can only be evaluated during a substructure search
+  static bool canPrescreen(const Atom *atom) {
+    return atom->hasQuery() && !hasRecursiveQuery(atom->getQuery());
+  }
+  static bool canPrescreen(const Bond *bond) { return bond->hasQuery(); }
+  static std::string getKey(const Atom *atom) {
+    return SmartsWrite::GetAtomSmarts(atom) + "\n" + describeQuery(atom);
+  }
+  static std::string getKey(const Bond *bond) {
+    return SmartsWrite::GetBondSmarts(bond) + "\n" + describeQuery(bond);
+  }
+
+  template <typename Range, typename T>
+  static void addRequirements(Range items, Requirements<T> &reqs) {
+    std::map<std::string, unsigned int> keys;
+    for (const auto item : items) {
+      if (!canPrescreen(item)) {
+        continue;
+      }
+      auto key = getKey(item);
+      auto it = keys.find(key);
+      if (it != keys.end()) {
+        ++reqs[it->second].second;
+        continue;
+      }
+      keys[key] = reqs.size();
+      std::unique_ptr<T> query(static_cast<T *>(item->copy()));
+      query->compileQuery();
+      reqs.emplace_back(std::move(query), 1);
+    }
+  }
+
+  template <typename T, typename Range>
+  static bool hasEnough(const Requirements<T> &reqs, Range items) {
+    for (const auto &[query, count] : reqs) {
+      unsigned int n = 0;
+      for (const auto item : items) {
+        if (query->Match(item) && ++n == count) {
+          break;
+        }
+      }
+      if (n < count) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+}  // namespace detail
+
 // constructor
 Normalizer::Normalizer() {
   BOOST_LOG(rdInfoLog) << "Initializing Normalizer\n";
@@ -52,6 +186,7 @@ Normalizer::Normalizer() {
   this->MAX_RESTARTS = 200;
 
   this->d_tcat->getCatalogParams()->initializeTransforms();
+  initPrescreen();
 }
 
 // overloaded constructor
@@ -64,6 +199,7 @@ Normalizer::Normalizer(const std::string normalizeFile,
   this->MAX_RESTARTS = maxRestarts;
 
   this->d_tcat->getCatalogParams()->initializeTransforms();
+  initPrescreen();
 }
 
 // overloaded constructor
@@ -75,6 +211,7 @@ Normalizer::Normalizer(std::istream &normalizeStream,
   this->MAX_RESTARTS = maxRestarts;
 
   this->d_tcat->getCatalogParams()->initializeTransforms();
+  initPrescreen();
 }
 
 // overloaded constructor
@@ -88,11 +225,40 @@ Normalizer::Normalizer(
   this->MAX_RESTARTS = maxRestarts;
 
   this->d_tcat->getCatalogParams()->initializeTransforms();
+  initPrescreen();
 }
 
 // destructor
 Normalizer::~Normalizer() { delete d_tcat; }
 
+void Normalizer::initPrescreen() {
+  const TransformCatalogParams *tparams = this->d_tcat->getCatalogParams();
+  PRECONDITION(tparams, "no transform parameters");
+  dp_prescreen.reset(
+      new detail::NormalizerPrescreen(tparams->getTransformations()));
+}
+
+std::vector<NormalizerRuleStats> Normalizer::getRuleStats() const {
+  std::vector<NormalizerRuleStats> res(dp_prescreen->size());
+  for (unsigned int i = 0; i < res.size(); ++i) {
+    const auto &counters = dp_prescreen->getCounters(i);
+    res[i].name = dp_prescreen->getName(i);
+    res[i].numTested = counters.numTested;
+    res[i].numSkipped = counters.numSkipped;
+    res[i].numFired = counters.numFired;
+  }
+  return res;
+}
+
+void Normalizer::resetRuleStats() {
+  for (unsigned int i = 0; i < dp_prescreen->size(); ++i) {
+    auto &counters = dp_prescreen->getCounters(i);
+    counters.numTested = 0;
+    counters.numSkipped = 0;
+    counters.numFired = 0;
+  }
+}
+
 void Normalizer::normalizeInPlace(RWMol &mol) {
   BOOST_LOG(rdInfoLog) << "Running Normalizer\n";
   PRECONDITION(this->d_tcat, "");
@@ -124,9 +290,21 @@ void Normalizer::normalizeInPlace(RWMol &mol) {
   for (unsigned int i = 0; i < MAX_RESTARTS; ++i) {
     bool loop_break = false;
     // Iterate through Normalization transforms and apply each in order
-    for (auto &transform : transforms) {
+    for (unsigned int tidx = 0; tidx < transforms.size(); ++tidx) {
+      auto &transform = transforms[tidx];
+      auto &counters = dp_prescreen->getCounters(tidx);
+      if (!dp_prescreen->canMatch(tidx, mol)) {
+        ++counters.numSkipped;
+        continue;
+      }
       constexpr bool removeUnmatchedAtoms = false;
-      if (transform->runReactant(mol, removeUnmatchedAtoms)) {
+      // in single-pass mode the transform is applied to all of its matches
+      for (unsigned int j = 0; j < MAX_RESTARTS; ++j) {
+        ++counters.numTested;
+        if (!transform->runReactant(mol, removeUnmatchedAtoms)) {
+          break;
+        }
+        ++counters.numFired;
         BOOST_LOG(rdInfoLog)
             << "Rule applied: "
             << transform->getProp<std::string>(common_properties::_Name)
@@ -141,6 +319,11 @@ void Normalizer::normalizeInPlace(RWMol &mol) {
           BOOST_LOG(rdInfoLog) << "FAILED sanitizeMol.\n";
         }
         loop_break = true;
+        if (!df_singlePass) {
+          break;
+        }
+      }
+      if (loop_break && !df_singlePass) {
         break;
       }
     }
@@ -194,9 +377,18 @@ ROMOL_SPTR Normalizer::normalizeFragment(
   for (unsigned int i = 0; i < MAX_RESTARTS; ++i) {
     bool loop_break = false;
     // Iterate through Normalization transforms and apply each in order
-    for (auto &transform : transforms) {
+    for (unsigned int tidx = 0; tidx < transforms.size(); ++tidx) {
+      auto &transform = transforms[tidx];
+      auto &counters = dp_prescreen->getCounters(tidx);
+      if (!dp_prescreen->canMatch(tidx, *nfrag)) {
+        ++counters.numSkipped;
+        continue;
+      }
+      ++counters.numTested;
+      // applyTransform() already applies the transform to all of its matches
       SmilesMolPair product = applyTransform(nfrag, *transform);
       if (!product.first.empty() && !seenProductSmiles.count(product.first)) {
+        ++counters.numFired;
         seenProductSmiles.insert(product.first);
         BOOST_LOG(rdInfoLog)
             << "Rule applied: "
@@ -204,7 +396,9 @@ ROMOL_SPTR Normalizer::normalizeFragment(
             << "\n";
         nfrag = product.second;
         loop_break = true;
-        break;
+        if (!df_singlePass) {
+          break;
+        }
       }
     }
     // For loop finishes normally, all applicable transforms have been applied
@@ -16,6 +16,8 @@
 #ifndef RD_NORMALIZE_H
 #define RD_NORMALIZE_H
 
+#include <cstdint>
+#include <memory>
 #include <Catalogs/Catalog.h>
 #include <GraphMol/MolStandardize/TransformCatalog/TransformCatalogEntry.h>
 #include <GraphMol/MolStandardize/TransformCatalog/TransformCatalogParams.h>
@@ -34,6 +36,18 @@ typedef RDCatalog::HierarchCatalog<TransformCatalogEntry,
     TransformCatalog;
 typedef std::pair<std::string, ROMOL_SPTR> SmilesMolPair;
 
+//! how often a Normalizer transform was considered for a molecule
+struct RDKIT_MOLSTANDARDIZE_EXPORT NormalizerRuleStats {
+  std::string name;
+  std::uint64_t numTested = 0;   //!< times the transform was run
+  std::uint64_t numSkipped = 0;  //!< times the prescreen showed that the
+                                 //!< transform could not match
+  std::uint64_t numFired = 0;    //!< times the transform changed the molecule
+};
+namespace detail {
+class NormalizerPrescreen;
+}
+
 //! The Normalizer class for applying Normalization transforms.
 /*!
 
@@ -42,6 +56,10 @@ typedef std::pair<std::string, ROMOL_SPTR> SmilesMolPair;
   to correct functional groups and recombine charges.
     - Each transform is repeatedly applied until no further changes
   occur.
+    - Before a transform is run, the atom and bond queries of its reactant
+  template are checked against the molecule. Transforms which cannot match
+  because the molecule doesn't contain enough atoms (or bonds) matching one
+  of the queries are skipped.
 */
 
 class RDKIT_MOLSTANDARDIZE_EXPORT Normalizer {
@@ -79,9 +97,32 @@ class RDKIT_MOLSTANDARDIZE_EXPORT Normalizer {
 
   void normalizeInPlace(RWMol &mol);
 
+  //! sets whether or not a full pass is made over the transforms before
+  //! restarting
+  /*!
+    By default the normalization restarts from the first transform as soon
+    as one of the transforms changes the molecule. In single-pass mode a
+    transform which fires is applied to all of its matches and the
+    remaining transforms are then tried before restarting. This needs far
+    fewer restarts for molecules with many groups to be normalized. Since
+    the transforms are applied in a different order the results can differ
+    from those of the default mode when transforms overlap.
+  */
+  void setSinglePass(bool val) { df_singlePass = val; }
+  bool getSinglePass() const { return df_singlePass; }
+
+  //! returns the statistics for each of the transforms
+  std::vector<NormalizerRuleStats> getRuleStats() const;
+  //! resets the statistics for all of the transforms to zero
+  void resetRuleStats();
+
  private:
   const TransformCatalog *d_tcat;
   unsigned int MAX_RESTARTS;
+  bool df_singlePass = false;
+  std::unique_ptr<detail::NormalizerPrescreen> dp_prescreen;
+
+  void initPrescreen();
 
   ROMOL_SPTR normalizeFragment(
       const ROMol &mol,
@@ -93,11 +134,14 @@ class RDKIT_MOLSTANDARDIZE_EXPORT Normalizer {
 
 // caller owns the returned pointer
 inline Normalizer *normalizerFromParams(const CleanupParameters &params) {
+  Normalizer *res;
   if (params.normalizationData.empty()) {
-    return new Normalizer(params.normalizations, params.maxRestarts);
+    res = new Normalizer(params.normalizations, params.maxRestarts);
   } else {
-    return new Normalizer(params.normalizationData, params.maxRestarts);
+    res = new Normalizer(params.normalizationData, params.maxRestarts);
   }
+  res->setSinglePass(params.normalizeSinglePass);
+  return res;
 }
 
 }  // namespace MolStandardize
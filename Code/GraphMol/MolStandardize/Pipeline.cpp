@@ -8,6 +8,7 @@
 //  of the RDKit source tree.
 //
 
+#include <chrono>
 #include <cmath>
 #include <regex>
 #include <sstream>
@@ -22,15 +23,44 @@
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #include <GraphMol/SmilesParse/SmilesWrite.h>
 #include <GraphMol/Chirality.h>
+#include <RDGeneral/RDThreads.h>
+
+#ifdef RDK_BUILD_THREADSAFE_SSS
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#endif
 
 namespace RDKit {
 namespace MolStandardize {
 
+namespace {
+using Clock = std::chrono::steady_clock;
+
+void addStageTiming(PipelineResult &result, Clock::time_point start) {
+  result.stageTimings.push_back(
+      {result.stage,
+       std::chrono::duration<double>(Clock::now() - start).count()});
+}
+}  // namespace
+
 void PipelineResult::append(PipelineStatus newStatus, const std::string &info) {
   status = static_cast<PipelineStatus>(status | newStatus);
   log.push_back({newStatus, info});
 }
 
+double PipelineResult::getStageTime(PipelineStage which) const {
+  double res = 0.0;
+  for (const auto &timing : stageTimings) {
+    if (timing.stage == static_cast<uint32_t>(which)) {
+      res += timing.seconds;
+    }
+  }
+  return res;
+}
+
 PipelineResult Pipeline::run(const std::string &molblock) const {
   PipelineResult result;
   result.status = NO_EVENT;
@@ -38,7 +68,9 @@ PipelineResult Pipeline::run(const std::string &molblock) const {
 
   // parse the molblock into an RWMol instance
   result.stage = static_cast<uint32_t>(PipelineStage::PARSING_INPUT);
+  auto start = Clock::now();
   RWMOL_SPTR mol = parse(molblock, result, options);
+  addStageTiming(result, start);
   if (!mol || ((result.status & PIPELINE_ERROR) != NO_EVENT &&
                !options.reportAllFailures)) {
     return result;
@@ -51,7 +83,9 @@ PipelineResult Pipeline::run(const std::string &molblock) const {
   RWMOL_SPTR molCopy{new RWMol(*mol)};
   for (const auto &[stage, operation] : validationSteps) {
     result.stage = stage;
+    start = Clock::now();
     molCopy = operation(molCopy, result, options);
+    addStageTiming(result, start);
     if (!molCopy || ((result.status & PIPELINE_ERROR) != NO_EVENT &&
                      !options.reportAllFailures)) {
       return result;
@@ -60,7 +94,9 @@ PipelineResult Pipeline::run(const std::string &molblock) const {
 
   for (const auto &[stage, operation] : standardizationSteps) {
     result.stage = stage;
+    start = Clock::now();
     mol = operation(mol, result, options);
+    addStageTiming(result, start);
     if (!mol || ((result.status & PIPELINE_ERROR) != NO_EVENT &&
                  !options.reportAllFailures)) {
       return result;
@@ -68,7 +104,9 @@ PipelineResult Pipeline::run(const std::string &molblock) const {
   }
   if (makeParent) {
     result.stage = static_cast<uint32_t>(PipelineStage::MAKE_PARENT);
+    start = Clock::now();
     output = makeParent(mol, result, options);
+    addStageTiming(result, start);
     if (!output.first || !output.second ||
         ((result.status & PIPELINE_ERROR) != NO_EVENT &&
          !options.reportAllFailures)) {
@@ -80,7 +118,9 @@ PipelineResult Pipeline::run(const std::string &molblock) const {
 
   // serialize as MolBlocks
   result.stage = static_cast<uint32_t>(PipelineStage::SERIALIZING_OUTPUT);
+  start = Clock::now();
   serialize(output, result, options);
+  addStageTiming(result, start);
   if ((result.status & PIPELINE_ERROR) != NO_EVENT &&
       !options.reportAllFailures) {
     return result;
@@ -91,6 +131,115 @@ PipelineResult Pipeline::run(const std::string &molblock) const {
   return result;
 }
 
+void Pipeline::run(const std::vector<std::string> &molblocks,
+                   const ResultCallback &callback, int numThreads) const {
+  const auto numInputs = static_cast<unsigned int>(molblocks.size());
+  const auto numThreadsToUse =
+      std::min(numInputs, getNumThreadsToUse(numThreads));
+  if (numThreadsToUse <= 1) {
+    for (unsigned int i = 0; i < numInputs; ++i) {
+      callback(i, run(molblocks[i]));
+    }
+    return;
+  }
+#ifdef RDK_BUILD_THREADSAFE_SSS
+  // The workers put their results into a ring of slots which the calling
+  // thread empties in input order. A worker doesn't start on an input until
+  // its slot is free, so one slow input holds back at most a ring's worth of
+  // results.
+  struct Slot {
+    std::optional<PipelineResult> result;
+    std::exception_ptr error;
+  };
+  const unsigned int ringSize = 4 * numThreadsToUse;
+  std::vector<Slot> ring(ringSize);
+  std::mutex mutex;
+  std::condition_variable cond;
+  unsigned int nextInput = 0;
+  unsigned int numDelivered = 0;
+  bool abort = false;
+
+  auto worker = [&]() {
+    while (true) {
+      unsigned int idx;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (abort || nextInput >= numInputs) {
+          return;
+        }
+        idx = nextInput++;
+        cond.wait(lock,
+                  [&]() { return abort || idx < numDelivered + ringSize; });
+        if (abort) {
+          return;
+        }
+      }
+      Slot slot;
+      try {
+        slot.result = run(molblocks[idx]);
+      } catch (...) {
+        slot.error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ring[idx % ringSize] = std::move(slot);
+      }
+      cond.notify_all();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < numThreadsToUse; ++i) {
+    threads.emplace_back(worker);
+  }
+  auto stopWorkers = [&]() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      abort = true;
+    }
+    cond.notify_all();
+    for (auto &thread : threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  };
+
+  try {
+    for (unsigned int i = 0; i < numInputs; ++i) {
+      Slot slot;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto &ready = ring[i % ringSize];
+        cond.wait(lock, [&]() { return ready.result || ready.error; });
+        std::swap(slot, ready);
+        ++numDelivered;
+      }
+      cond.notify_all();
+      if (slot.error) {
+        std::rethrow_exception(slot.error);
+      }
+      callback(i, std::move(*slot.result));
+    }
+  } catch (...) {
+    stopWorkers();
+    throw;
+  }
+  stopWorkers();
+#endif
+}
+
+std::vector<PipelineResult> Pipeline::run(
+    const std::vector<std::string> &molblocks, int numThreads) const {
+  std::vector<PipelineResult> res(molblocks.size());
+  run(
+      molblocks,
+      [&res](unsigned int idx, PipelineResult &&result) {
+        res[idx] = std::move(result);
+      },
+      numThreads);
+  return res;
+}
+
 namespace Operations {
 RWMOL_SPTR parse(const std::string &molblock, PipelineResult &result,
                  const PipelineOptions &options) {
@@ -280,6 +429,30 @@ RWMOL_SPTR prepareForStandardization(RWMOL_SPTR mol, PipelineResult &result,
   return mol;
 }
 
+namespace {
+// Building the normalizer means parsing all of its transforms, which takes
+// longer than applying them to a typical molecule, so each thread holds on to
+// the last one it built.
+Normalizer &getNormalizer(const PipelineOptions &options) {
+  thread_local std::unique_ptr<Normalizer> normalizer;
+  thread_local std::string normalizerData;
+  thread_local unsigned int maxRestarts;
+  if (!normalizer || normalizerData != options.normalizerData ||
+      maxRestarts != options.normalizerMaxRestarts) {
+    normalizer.reset();
+    if (options.normalizerData.empty()) {
+      normalizer.reset(new Normalizer);
+    } else {
+      std::istringstream sstr(options.normalizerData);
+      normalizer.reset(new Normalizer(sstr, options.normalizerMaxRestarts));
+    }
+    normalizerData = options.normalizerData;
+    maxRestarts = options.normalizerMaxRestarts;
+  }
+  return *normalizer;
+}
+}  // namespace
+
 RWMOL_SPTR standardize(RWMOL_SPTR mol, PipelineResult &result,
                        const PipelineOptions &options) {
   auto smiles = MolToSmiles(*mol);
@@ -310,17 +483,15 @@ RWMOL_SPTR standardize(RWMOL_SPTR mol, PipelineResult &result,
 
   // functional groups
   try {
-    std::unique_ptr<Normalizer> normalizer{};
-    if (options.normalizerData.empty()) {
-      normalizer.reset(new Normalizer);
-    } else {
-      std::istringstream sstr(options.normalizerData);
-      normalizer.reset(new Normalizer(sstr, options.normalizerMaxRestarts));
-    }
+    auto &normalizer = getNormalizer(options);
+    normalizer.resetRuleStats();
     // normalizeInPlace() may return an ill-formed molecule if
     // the sanitization of a transformed structure failed
     // => use normalize() instead (also see GitHub #7189)
-    mol.reset(static_cast<RWMol *>(normalizer->normalize(*mol)));
+    mol.reset(static_cast<RWMol *>(normalizer.normalize(*mol)));
+    if (options.collectNormalizerStats) {
+      result.normalizerStats = normalizer.getRuleStats();
+    }
     mol->updatePropertyCache(false);
   } catch (...) {
     result.append(
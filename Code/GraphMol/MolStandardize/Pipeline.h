@@ -11,6 +11,8 @@
 #define RD_MOLSTANDARDIZE_PIPELINE_H
 #include <RDGeneral/export.h>
 #include <GraphMol/RWMol.h>
+#include <GraphMol/MolStandardize/Normalize.h>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -82,6 +84,8 @@ struct RDKIT_MOLSTANDARDIZE_EXPORT PipelineOptions {
       "Charge recombination\t[N,P,As,Sb;-1:1]=[C+;v3:2]>>[*+0:1]#[C+0:2]\n"};
   unsigned int normalizerMaxRestarts{200};
   double scaledMedianBondLength{1.};
+  // report how often each of the normalizer transforms was tested and applied
+  bool collectNormalizerStats{false};
 
   // serialization
   bool outputV2000{false};
@@ -140,6 +144,12 @@ struct RDKIT_MOLSTANDARDIZE_EXPORT PipelineLogEntry {
 
 using PipelineLog = std::vector<PipelineLogEntry>;
 
+//! the wall-clock time spent in one of the steps of the pipeline
+struct RDKIT_MOLSTANDARDIZE_EXPORT PipelineStageTiming {
+  std::uint32_t stage;
+  double seconds;
+};
+
 struct RDKIT_MOLSTANDARDIZE_EXPORT PipelineResult {
   PipelineStatus status;
   std::uint32_t stage;
@@ -147,6 +157,13 @@ struct RDKIT_MOLSTANDARDIZE_EXPORT PipelineResult {
   std::string inputMolData;
   std::string outputMolData;
   std::string parentMolData;
+  // the steps which were run, in order
+  std::vector<PipelineStageTiming> stageTimings;
+  // only filled in if PipelineOptions::collectNormalizerStats is set
+  std::vector<NormalizerRuleStats> normalizerStats;
+
+  //! returns the total time spent in all steps belonging to a stage
+  double getStageTime(PipelineStage stage) const;
 
   void append(PipelineStatus newStatus, const std::string &info);
 };
@@ -215,6 +232,29 @@ class RDKIT_MOLSTANDARDIZE_EXPORT Pipeline {
 
   PipelineResult run(const std::string &molblock) const;
 
+  //! called with the position of the input and its result
+  using ResultCallback =
+      std::function<void(unsigned int, PipelineResult &&)>;
+
+  //! runs the pipeline on a batch of inputs using multiple threads
+  /*!
+    \param molblocks  the inputs
+    \param callback   called once for each input, in input order and on the
+                      calling thread, as soon as its result is available.
+                      At most a few results per thread are held back to
+                      preserve the order.
+    \param numThreads the number of threads to use. Zero or negative values
+                      are interpreted as in getNumThreadsToUse()
+
+    Exceptions thrown by the callback or by one of the steps of the
+    pipeline stop the processing and are rethrown.
+  */
+  void run(const std::vector<std::string> &molblocks,
+           const ResultCallback &callback, int numThreads = 1) const;
+  //! \overload returns the results for all of the inputs
+  std::vector<PipelineResult> run(const std::vector<std::string> &molblocks,
+                                  int numThreads = 1) const;
+
   void setValidationSteps(const Operations::PipelineVector &steps) {
     validationSteps = steps;
   }
@@ -13,12 +13,21 @@
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #include <GraphMol/SmilesParse/SmilesWrite.h>
 #include <GraphMol/Substruct/SubstructMatch.h>
+#include <RDGeneral/RDThreads.h>
 #include <boost/dynamic_bitset.hpp>
 #include <algorithm>
+#include <cstdint>
 #include <limits>
+#include <exception>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <utility>
 
+#ifdef RDK_BUILD_THREADSAFE_SSS
+#include <thread>
+#endif
+
 // #define VERBOSE_ENUMERATION 1
 
 #ifdef VERBOSE_ENUMERATION
@@ -376,6 +385,268 @@ bool hasValidSpecifiedDoubleBondStereo(const Bond &bond) {
   return bond.getBondType() == Bond::DOUBLE && stereo >= Bond::STEREOZ &&
          stereo <= Bond::STEREOTRANS && bond.getStereoAtoms().size() == 2;
 }
+
+// The parts of a tautomer which differ between the tautomers of a molecule
+// and which the sanitization of a transform's product and its SMILES depend
+// on: H counts, charges, bond orders, aromaticity, and stereo.
+// Two products whose unsanitized states (and sets of modified atoms and
+// bonds) are the same end up as the same tautomer, so the enumerator only
+// sanitizes products whose state is new. Two sanitized products with the
+// same state have the same SMILES, so different Kekule structures of a
+// tautomer only need to be canonicalized once.
+// The hash is a sum over the words of the state, which allows it to be
+// updated for the few atoms and bonds a transform touches without looking
+// at the rest of the molecule.
+class TautomerState {
+ public:
+  static constexpr unsigned int wordsPerAtom = 3;
+  static constexpr unsigned int wordsPerBond = 3;
+
+  explicit TautomerState(const ROMol &mol) : d_numAtoms(mol.getNumAtoms()) {
+    d_words.resize(wordsPerAtom * mol.getNumAtoms() +
+                   wordsPerBond * mol.getNumBonds() + 2);
+    for (const auto atom : mol.atoms()) {
+      setAtom(atom->getIdx(), *atom, atom->getFormalCharge(),
+              atom->getNumExplicitHs(), atom->getNoImplicit());
+    }
+    for (const auto bond : mol.bonds()) {
+      setBond(bond->getIdx(), *bond, bond->getBondType());
+    }
+  }
+
+  void setAtom(unsigned int idx, const Atom &atom, int formalCharge,
+               unsigned int numExplicitHs, bool noImplicit) {
+    const auto offset = wordsPerAtom * idx;
+    set(offset, static_cast<std::uint32_t>(formalCharge));
+    set(offset + 1, (numExplicitHs << 1) | noImplicit);
+    // the canonical atom ranking uses the CIP codes
+    std::uint32_t cipCode = 0;
+    std::string code;
+    if (atom.getPropIfPresent(common_properties::_CIPCode, code)) {
+      cipCode = code == "R" ? 2 : 1;
+    }
+    set(offset + 2,
+        (atom.getNumRadicalElectrons() << 8) |
+            (static_cast<std::uint32_t>(atom.getChiralTag()) << 4) |
+            (cipCode << 2) | (atom.getIsAromatic() << 1) |
+            atom.hasProp(common_properties::_isotopicHs));
+  }
+  void setBond(unsigned int idx, const Bond &bond, Bond::BondType bondType) {
+    const auto offset = wordsPerAtom * d_numAtoms + wordsPerBond * idx;
+    const auto &stereoAtoms = bond.getStereoAtoms();
+    set(offset, (static_cast<std::uint32_t>(bondType) << 16) |
+                    (static_cast<std::uint32_t>(bond.getStereo()) << 8) |
+                    (static_cast<std::uint32_t>(bond.getBondDir()) << 1) |
+                    bond.getIsAromatic());
+    set(offset + 1, stereoAtoms.size() == 2 ? stereoAtoms[0] + 1 : 0);
+    set(offset + 2, stereoAtoms.size() == 2 ? stereoAtoms[1] + 1 : 0);
+  }
+  void setNumModified(std::size_t numAtoms, std::size_t numBonds) {
+    set(d_words.size() - 2, static_cast<std::uint32_t>(numAtoms));
+    set(d_words.size() - 1, static_cast<std::uint32_t>(numBonds));
+  }
+
+  std::size_t hash() const { return d_hash; }
+  bool operator==(const TautomerState &other) const {
+    return d_hash == other.d_hash && d_words == other.d_words;
+  }
+
+ private:
+  unsigned int d_numAtoms;
+  std::vector<std::uint32_t> d_words;
+  std::size_t d_hash = 0;
+
+  static std::size_t mix(std::size_t pos, std::uint32_t word) {
+    // splitmix64 finalizer
+    std::uint64_t x = (static_cast<std::uint64_t>(pos) << 32) | word;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<std::size_t>(x ^ (x >> 31));
+  }
+  void set(std::size_t pos, std::uint32_t word) {
+    d_hash += mix(pos, word) - mix(pos, d_words[pos]);
+    d_words[pos] = word;
+  }
+};
+
+// the new charge and H count of one of the atoms matched by a transform
+struct AtomEdit {
+  unsigned int idx;
+  int formalCharge;
+  unsigned int numExplicitHs;
+  bool noImplicit;
+};
+
+struct TautomerStateHash {
+  std::size_t operator()(const TautomerState &state) const {
+    return state.hash();
+  }
+};
+
+using BondEdit = std::pair<const Bond *, Bond::BondType>;
+
+// works out what applying a transform to a match in a kekulized tautomer
+// changes: a hydrogen is removed from the first matched atom and added to
+// the last, and the bond orders and charges are adjusted
+void getTransformEdits(const ROMol &kmol, const TautomerTransform &transform,
+                       const MatchVectType &match,
+                       std::vector<AtomEdit> &atomEdits,
+                       std::vector<BondEdit> &bondEdits) {
+  const int firstIdx = match.front().second;
+  const int lastIdx = match.back().second;
+  atomEdits.clear();
+  unsigned int ci = 0;
+  for (const auto &pair : match) {
+    const auto atom = kmol.getAtomWithIdx(pair.second);
+    AtomEdit edit{static_cast<unsigned int>(pair.second),
+                  atom->getFormalCharge(), atom->getNumExplicitHs(),
+                  atom->getNoImplicit()};
+    // Remove any implicit hydrogens from the first and last atoms
+    // now we set the count explicitly
+    if (pair.second == firstIdx) {
+      edit.numExplicitHs = static_cast<unsigned int>(
+          std::max(0, static_cast<int>(atom->getTotalNumHs()) - 1));
+      edit.noImplicit = true;
+    } else if (pair.second == lastIdx) {
+      edit.numExplicitHs = atom->getTotalNumHs() + 1;
+      edit.noImplicit = true;
+    }
+    // TODO adjust charges
+    if (!transform.Charges.empty()) {
+      edit.formalCharge += transform.Charges[ci++];
+    }
+    atomEdits.push_back(edit);
+  }
+  bondEdits.clear();
+  unsigned int bi = 0;
+  for (size_t i = 0; i < transform.Mol->getNumBonds(); ++i) {
+    const auto tbond = transform.Mol->getBondWithIdx(i);
+    const Bond *bond =
+        kmol.getBondBetweenAtoms(match[tbond->getBeginAtomIdx()].second,
+                                 match[tbond->getEndAtomIdx()].second);
+    ASSERT_INVARIANT(bond, "required bond not found");
+    Bond::BondType bondtype = bond->getBondType();
+    // check if bonds is specified in tautomer.in file
+    if (!transform.BondTypes.empty()) {
+      bondtype = transform.BondTypes[bi];
+      ++bi;
+    } else if (bondtype == Bond::SINGLE) {
+      bondtype = Bond::DOUBLE;
+    } else if (bondtype == Bond::DOUBLE) {
+      bondtype = Bond::SINGLE;
+    }
+    bondEdits.emplace_back(bond, bondtype);
+  }
+}
+
+// applies the edits to a copy of the kekulized tautomer and sanitizes it,
+// returns null if the product can't be kekulized
+RWMOL_SPTR makeProduct(const ROMol &kmol,
+                       const std::vector<AtomEdit> &atomEdits,
+                       const std::vector<BondEdit> &bondEdits) {
+  // Create a copy of in the input molecule so we can modify it
+  // Use kekule form so bonds are explicitly single/double instead of
+  // aromatic
+  RWMOL_SPTR product(new RWMol(kmol, true));
+  for (const auto &edit : atomEdits) {
+    Atom *atom = product->getAtomWithIdx(edit.idx);
+    atom->setFormalCharge(edit.formalCharge);
+    atom->setNumExplicitHs(edit.numExplicitHs);
+    atom->setNoImplicit(edit.noImplicit);
+  }
+  for (const auto &[bond, bondtype] : bondEdits) {
+    product
+        ->getBondBetweenAtoms(bond->getBeginAtomIdx(), bond->getEndAtomIdx())
+        ->setBondType(bondtype);
+  }
+#ifdef VERBOSE_ENUMERATION
+  {
+    SmilesWriteParams smilesWriteParams;
+    smilesWriteParams.allBondsExplicit = true;
+    std::cout << "pre-sanitize: " << MolToSmiles(*product, smilesWriteParams)
+              << std::endl;
+  }
+#endif
+
+  try {
+    // We only change bond orders/H counts/charges; the molecular graph
+    // (and therefore ring topology) is unchanged.
+    // `sanitizeMol()` always calls `clearComputedProps()` which resets
+    // ring info and forces ring-finding for each generated tautomer.
+    // Avoid that by clearing computed props without touching rings,
+    // then running the specific sanitize steps we need.
+    product->clearComputedProps(false);
+    product->updatePropertyCache(false);
+    MolOps::Kekulize(*product);
+    MolOps::setAromaticity(*product);
+    MolOps::setConjugation(*product);
+    MolOps::setHybridization(*product);
+    MolOps::adjustHs(*product);
+  } catch (const KekulizeException &) {
+    return RWMOL_SPTR();
+  }
+  return product;
+}
+
+// The transform matches and the sanitized products of a tautomer. When the
+// enumerator uses multiple threads these are worked out ahead of time for
+// all of the tautomers which are waiting to be expanded. Whether a product
+// is actually needed is only known when the tautomer is expanded.
+struct TautomerExpansion {
+  struct Product {
+    RWMOL_SPTR mol;  // null if the product couldn't be kekulized
+    std::exception_ptr error;
+  };
+  std::vector<std::vector<MatchVectType>> matches;  // by transform
+  std::vector<std::vector<Product>> products;       // by transform and match
+
+  void expand(const ROMol &kmol,
+              const std::vector<TautomerTransform> &transforms) {
+    std::vector<AtomEdit> atomEdits;
+    std::vector<BondEdit> bondEdits;
+    matches.resize(transforms.size());
+    products.resize(transforms.size());
+    for (unsigned int i = 0; i < transforms.size(); ++i) {
+      SubstructMatch(kmol, *(transforms[i].Mol), matches[i]);
+      for (const auto &match : matches[i]) {
+        Product product;
+        try {
+          getTransformEdits(kmol, transforms[i], match, atomEdits, bondEdits);
+          product.mol = makeProduct(kmol, atomEdits, bondEdits);
+        } catch (...) {
+          product.error = std::current_exception();
+        }
+        products[i].push_back(std::move(product));
+      }
+    }
+  }
+};
+
+void expandInParallel(
+    std::vector<std::pair<const ROMol *, TautomerExpansion *>> &work,
+    const std::vector<TautomerTransform> &transforms, unsigned int numThreads) {
+#ifdef RDK_BUILD_THREADSAFE_SSS
+  auto func = [&](unsigned int tidx) {
+    for (auto i = tidx; i < work.size(); i += numThreads) {
+      work[i].second->expand(*work[i].first, transforms);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (auto tidx = 0u; tidx < numThreads; ++tidx) {
+    threads.emplace_back(func, tidx);
+  }
+  for (auto &t : threads) {
+    if (t.joinable()) {
+      t.join();
+    }
+  }
+#else
+  RDUNUSED_PARAM(numThreads);
+  for (auto &[kmol, expansion] : work) {
+    expansion->expand(*kmol, transforms);
+  }
+#endif
+}
 }  // namespace
 
 TautomerEnumerator::TautomerEnumerator(const CleanupParameters &params)
@@ -384,7 +655,8 @@ TautomerEnumerator::TautomerEnumerator(const CleanupParameters &params)
       d_removeSp3Stereo(params.tautomerRemoveSp3Stereo),
       d_removeBondStereo(params.tautomerRemoveBondStereo),
       d_removeIsotopicHs(params.tautomerRemoveIsotopicHs),
-      d_reassignStereo(params.tautomerReassignStereo) {
+      d_reassignStereo(params.tautomerReassignStereo),
+      d_numThreads(1) {
   std::unique_ptr<TautomerCatalogParams> tautParams;
   if (params.tautomerTransformData.empty()) {
     tautParams.reset(new TautomerCatalogParams(params.tautomerTransforms));
@@ -587,6 +859,13 @@ TautomerEnumeratorResult TautomerEnumerator::enumerate(const ROMol &mol) const {
       ++numModifiedBonds;
     }
   };
+  // the unsanitized states of all of the products seen so far
+  std::unordered_set<TautomerState, TautomerStateHash> seenStates;
+  // the SMILES of the sanitized products
+  std::unordered_map<TautomerState, std::string, TautomerStateHash>
+      smilesCache;
+  std::vector<AtomEdit> atomEdits;
+  std::vector<BondEdit> bondEdits;
   bool completed = false;
   bool bailOut = false;
   unsigned int nTransforms = 0;
@@ -594,7 +873,27 @@ TautomerEnumeratorResult TautomerEnumerator::enumerate(const ROMol &mol) const {
       "completed", "max tautomers reached", "max transforms reached",
       "canceled"};
 
+  const auto numThreads = getNumThreadsToUse(d_numThreads);
+  std::unordered_map<const Tautomer *, TautomerExpansion> expansions;
   while (!completed && !bailOut) {
+    expansions.clear();
+    if (numThreads > 1) {
+      // the expansions of the tautomers waiting to be processed don't depend
+      // on each other or on the rest of the enumeration, so they can be done
+      // in parallel. Products with the same state as an earlier one are
+      // still sanitized here, the results are the same as those of the
+      // serial enumeration.
+      std::vector<std::pair<const ROMol *, TautomerExpansion *>> work;
+      for (const auto &smilesTautomerPair : res.d_tautomers) {
+        if (!smilesTautomerPair.second.d_done) {
+          work.emplace_back(smilesTautomerPair.second.getKekulized().get(),
+                            &expansions[&smilesTautomerPair.second]);
+        }
+      }
+      expandInParallel(work, transforms,
+                       std::min(numThreads,
+                                static_cast<unsigned int>(work.size())));
+    }
     // std::map automatically sorts res.d_tautomers into alphabetical order
     // (SMILES)
     for (auto &smilesTautomerPair : res.d_tautomers) {
@@ -618,16 +917,28 @@ TautomerEnumeratorResult TautomerEnumerator::enumerate(const ROMol &mol) const {
                 << std::endl;
 #endif
       // tautomer not yet done
-      for (const auto &transform : transforms) {
+      std::unique_ptr<TautomerState> kmolState;
+      TautomerExpansion *expansion = nullptr;
+      if (auto it = expansions.find(&smilesTautomerPair.second);
+          it != expansions.end()) {
+        expansion = &it->second;
+      }
+      for (unsigned int transformIdx = 0; transformIdx < transforms.size();
+           ++transformIdx) {
+        const auto &transform = transforms[transformIdx];
         if (bailOut) {
           break;
         }
         // kmol is the kekulized version of the tautomer (created lazily)
         const auto &kmol = smilesTautomerPair.second.getKekulized();
-        std::vector<MatchVectType> matches;
-        unsigned int matched = SubstructMatch(*kmol, *(transform.Mol), matches);
+        std::vector<MatchVectType> localMatches;
+        if (!expansion) {
+          SubstructMatch(*kmol, *(transform.Mol), localMatches);
+        }
+        const auto &matches =
+            expansion ? expansion->matches[transformIdx] : localMatches;
 
-        if (!matched) {
+        if (matches.empty()) {
           continue;
         }
         ++nTransforms;
@@ -644,7 +955,9 @@ TautomerEnumeratorResult TautomerEnumerator::enumerate(const ROMol &mol) const {
         std::cout << "Matched: " << name << std::endl;
 #endif
         // loop over transform matches
-        for (const auto &match : matches) {
+        for (unsigned int matchIdx = 0; matchIdx < matches.size();
+             ++matchIdx) {
+          const auto &match = matches[matchIdx];
           if (nTransforms >= d_maxTransforms) {
             res.d_status = TautomerEnumeratorStatus::MaxTransformsReached;
             bailOut = true;
@@ -658,92 +971,42 @@ TautomerEnumeratorResult TautomerEnumerator::enumerate(const ROMol &mol) const {
           if (bailOut) {
             break;
           }
-          // Create a copy of in the input molecule so we can modify it
-          // Use kekule form so bonds are explicitly single/double instead of
-          // aromatic
-          RWMOL_SPTR product(new RWMol(*kmol, true));
-          // Remove a hydrogen from the first matched atom and add one to the
-          // last
-          int firstIdx = match.front().second;
-          int lastIdx = match.back().second;
-          Atom *first = product->getAtomWithIdx(firstIdx);
-          Atom *last = product->getAtomWithIdx(lastIdx);
-          markAtomModified(static_cast<unsigned int>(firstIdx));
-          markAtomModified(static_cast<unsigned int>(lastIdx));
-          first->setNumExplicitHs(
-              std::max(0, static_cast<int>(first->getTotalNumHs()) - 1));
-          last->setNumExplicitHs(last->getTotalNumHs() + 1);
-          // Remove any implicit hydrogens from the first and last atoms
-          // now we have set the count explicitly
-          first->setNoImplicit(true);
-          last->setNoImplicit(true);
-          // Adjust bond orders
-          unsigned int bi = 0;
-          for (size_t i = 0; i < transform.Mol->getNumBonds(); ++i) {
-            const auto tbond = transform.Mol->getBondWithIdx(i);
-            Bond *bond = product->getBondBetweenAtoms(
-                match[tbond->getBeginAtomIdx()].second,
-                match[tbond->getEndAtomIdx()].second);
-            ASSERT_INVARIANT(bond, "required bond not found");
-            // check if bonds is specified in tautomer.in file
-            if (!transform.BondTypes.empty()) {
-              bond->setBondType(transform.BondTypes[bi]);
-              ++bi;
-            } else {
-              Bond::BondType bondtype = bond->getBondType();
-#ifdef VERBOSE_ENUMERATION
-              std::cout << "Bond as double: " << bond->getBondTypeAsDouble()
-                        << std::endl;
-              std::cout << bondtype << std::endl;
-#endif
-              if (bondtype == Bond::SINGLE) {
-                bond->setBondType(Bond::DOUBLE);
-#ifdef VERBOSE_ENUMERATION
-                std::cout << "Set bond to double" << std::endl;
-#endif
-              }
-              if (bondtype == Bond::DOUBLE) {
-                bond->setBondType(Bond::SINGLE);
-#ifdef VERBOSE_ENUMERATION
-                std::cout << "Set bond to single" << std::endl;
-#endif
-              }
-            }
-            markBondModified(bond->getIdx());
+          getTransformEdits(*kmol, transform, match, atomEdits, bondEdits);
+          markAtomModified(static_cast<unsigned int>(match.front().second));
+          markAtomModified(static_cast<unsigned int>(match.back().second));
+          for (const auto &bondEdit : bondEdits) {
+            markBondModified(bondEdit.first->getIdx());
           }
-          // TODO adjust charges
-          if (!transform.Charges.empty()) {
-            unsigned int ci = 0;
-            for (const auto &pair : match) {
-              Atom *atom = product->getAtomWithIdx(pair.second);
-              atom->setFormalCharge(atom->getFormalCharge() +
-                                    transform.Charges[ci++]);
-            }
+
+          // products which have been seen before add nothing new
+          if (!kmolState) {
+            kmolState.reset(new TautomerState(*kmol));
           }
-#ifdef VERBOSE_ENUMERATION
-          {
-            SmilesWriteParams smilesWriteParams;
-            smilesWriteParams.allBondsExplicit = true;
-            std::cout << "pre-sanitize: "
-                      << MolToSmiles(*product, smilesWriteParams) << std::endl;
+          TautomerState state(*kmolState);
+          for (const auto &edit : atomEdits) {
+            state.setAtom(edit.idx, *kmol->getAtomWithIdx(edit.idx),
+                          edit.formalCharge, edit.numExplicitHs,
+                          edit.noImplicit);
+          }
+          for (const auto &[bond, bondtype] : bondEdits) {
+            state.setBond(bond->getIdx(), *bond, bondtype);
+          }
+          state.setNumModified(numModifiedAtoms, numModifiedBonds);
+          if (!seenStates.insert(std::move(state)).second) {
+            continue;
           }
-#endif
 
-          try {
-            // We only change bond orders/H counts/charges; the molecular graph
-            // (and therefore ring topology) is unchanged.
-            // `sanitizeMol()` always calls `clearComputedProps()` which resets
-            // ring info and forces ring-finding for each generated tautomer.
-            // Avoid that by clearing computed props without touching rings,
-            // then running the specific sanitize steps we need.
-            product->clearComputedProps(false);
-            product->updatePropertyCache(false);
-            MolOps::Kekulize(*product);
-            MolOps::setAromaticity(*product);
-            MolOps::setConjugation(*product);
-            MolOps::setHybridization(*product);
-            MolOps::adjustHs(*product);
-          } catch (const KekulizeException &) {
+          RWMOL_SPTR product;
+          if (expansion) {
+            auto &precomputed = expansion->products[transformIdx][matchIdx];
+            if (precomputed.error) {
+              std::rethrow_exception(precomputed.error);
+            }
+            product = std::move(precomputed.mol);
+          } else {
+            product = makeProduct(*kmol, atomEdits, bondEdits);
+          }
+          if (!product) {
             continue;
           }
 #ifdef VERBOSE_ENUMERATION
@@ -753,7 +1016,16 @@ TautomerEnumeratorResult TautomerEnumerator::enumerate(const ROMol &mol) const {
                     << MolToSmiles(*product, smilesWriteParams) << std::endl;
 #endif
           setTautomerStereoAndIsoHs(mol, *product, res);
-          tsmiles = MolToSmiles(*product, true);
+          {
+            TautomerState sanitizedState(*product);
+            auto smilesIt = smilesCache.find(sanitizedState);
+            if (smilesIt != smilesCache.end()) {
+              tsmiles = smilesIt->second;
+            } else {
+              tsmiles = MolToSmiles(*product, true);
+              smilesCache.emplace(std::move(sanitizedState), tsmiles);
+            }
+          }
 #ifdef VERBOSE_ENUMERATION
           (transform.Mol)->getProp(common_properties::_Name, name);
           std::cout << "Applied rule: " << name << " to "
@@ -310,7 +310,8 @@ class RDKIT_MOLSTANDARDIZE_EXPORT TautomerEnumerator {
         d_removeSp3Stereo(true),
         d_removeBondStereo(true),
         d_removeIsotopicHs(true),
-        d_reassignStereo(true) {}
+        d_reassignStereo(true),
+        d_numThreads(1) {}
   TautomerEnumerator(const CleanupParameters &params = CleanupParameters());
   TautomerEnumerator(const TautomerEnumerator &other)
       : dp_catalog(other.dp_catalog),
@@ -320,7 +321,8 @@ class RDKIT_MOLSTANDARDIZE_EXPORT TautomerEnumerator {
         d_removeSp3Stereo(other.d_removeSp3Stereo),
         d_removeBondStereo(other.d_removeBondStereo),
         d_removeIsotopicHs(other.d_removeIsotopicHs),
-        d_reassignStereo(other.d_reassignStereo) {}
+        d_reassignStereo(other.d_reassignStereo),
+        d_numThreads(other.d_numThreads) {}
   TautomerEnumerator &operator=(const TautomerEnumerator &other) {
     if (this == &other) {
       return *this;
@@ -333,6 +335,7 @@ class RDKIT_MOLSTANDARDIZE_EXPORT TautomerEnumerator {
     d_removeBondStereo = other.d_removeBondStereo;
     d_removeIsotopicHs = other.d_removeIsotopicHs;
     d_reassignStereo = other.d_reassignStereo;
+    d_numThreads = other.d_numThreads;
     return *this;
   }
   //! \param maxTautomers maximum number of tautomers to be generated
@@ -400,6 +403,17 @@ class RDKIT_MOLSTANDARDIZE_EXPORT TautomerEnumerator {
       tautomer generated by the enumerate() method
    */
   bool getReassignStereo() { return d_reassignStereo; }
+  /*! \param numThreads; the number of threads used by the enumerate() method.
+      The transform matches and products of all of the tautomers which are
+      waiting to be expanded are then worked out in parallel before the
+      tautomers are processed. The results don't depend on the number of
+      threads. This only pays off for molecules with many tautomers.
+      Zero or negative values are interpreted as in getNumThreadsToUse().
+      This defaults to 1.
+   */
+  void setNumThreads(int numThreads) { d_numThreads = numThreads; }
+  //! \return the number of threads used by the enumerate() method
+  int getNumThreads() const { return d_numThreads; }
   /*! set this to an instance of a class derived from
       TautomerEnumeratorCallback where operator() is overridden.
       DO NOT delete the instance as ownership of the pointer is transferred
@@ -524,6 +538,7 @@ class RDKIT_MOLSTANDARDIZE_EXPORT TautomerEnumerator {
   bool d_removeBondStereo;
   bool d_removeIsotopicHs;
   bool d_reassignStereo;
+  int d_numThreads;
 };  // TautomerEnumerator class
 
 // caller owns the pointer
@@ -25,6 +25,45 @@ bool operator==(const PipelineLogEntry &lhs, const PipelineLogEntry &rhs) {
 namespace python = boost::python;
 using namespace RDKit;
 
+namespace {
+MolStandardize::PipelineResult runPipeline(
+    const MolStandardize::Pipeline &self, const std::string &molblock) {
+  return self.run(molblock);
+}
+
+python::list runPipelineBatch(const MolStandardize::Pipeline &self,
+                              python::object molblocks, int numThreads) {
+  auto inputs = pythonObjectToVect<std::string>(molblocks);
+  std::vector<MolStandardize::PipelineResult> results;
+  if (inputs) {
+    NOGIL gil;
+    results = self.run(*inputs, numThreads);
+  }
+  python::list res;
+  for (auto &result : results) {
+    res.append(std::move(result));
+  }
+  return res;
+}
+
+python::tuple getStageTimings(const MolStandardize::PipelineResult &self) {
+  python::list res;
+  for (const auto &timing : self.stageTimings) {
+    res.append(python::make_tuple(timing.stage, timing.seconds));
+  }
+  return python::tuple(res);
+}
+
+python::tuple getNormalizerStats(const MolStandardize::PipelineResult &self) {
+  python::list res;
+  for (const auto &stats : self.normalizerStats) {
+    res.append(python::make_tuple(stats.name, stats.numTested,
+                                  stats.numSkipped, stats.numFired));
+  }
+  return python::tuple(res);
+}
+}  // namespace
+
 void wrap_pipeline() {
   python::class_<MolStandardize::PipelineOptions>("PipelineOptions")
       .def_readwrite("strictParsing",
@@ -60,6 +99,8 @@ void wrap_pipeline() {
                      &MolStandardize::PipelineOptions::normalizerMaxRestarts)
       .def_readwrite("scaledMedianBondLength",
                      &MolStandardize::PipelineOptions::scaledMedianBondLength)
+      .def_readwrite("collectNormalizerStats",
+                     &MolStandardize::PipelineOptions::collectNormalizerStats)
       .def_readwrite("outputV2000",
                      &MolStandardize::PipelineOptions::outputV2000);
 
@@ -113,6 +154,9 @@ void wrap_pipeline() {
       .value("PREPARE_FOR_STANDARDIZATION",
              MolStandardize::PipelineStage::PREPARE_FOR_STANDARDIZATION)
       .value("STANDARDIZATION", MolStandardize::PipelineStage::STANDARDIZATION)
+      .value("REAPPLY_WEDGING", MolStandardize::PipelineStage::REAPPLY_WEDGING)
+      .value("CLEANUP_2D", MolStandardize::PipelineStage::CLEANUP_2D)
+      .value("MAKE_PARENT", MolStandardize::PipelineStage::MAKE_PARENT)
       .value("SERIALIZING_OUTPUT",
              MolStandardize::PipelineStage::SERIALIZING_OUTPUT)
       .value("COMPLETED", MolStandardize::PipelineStage::COMPLETED);
@@ -135,9 +179,24 @@ void wrap_pipeline() {
       .def_readonly("outputMolData",
                     &MolStandardize::PipelineResult::outputMolData)
       .def_readonly("parentMolData",
-                    &MolStandardize::PipelineResult::parentMolData);
+                    &MolStandardize::PipelineResult::parentMolData)
+      .def("GetStageTimings", getStageTimings, python::args("self"),
+           "returns a tuple of (stage, seconds) pairs for the steps which "
+           "were run")
+      .def("GetStageTime", &MolStandardize::PipelineResult::getStageTime,
+           python::args("self", "stage"),
+           "returns the total time in seconds spent in a stage")
+      .def("GetNormalizerStats", getNormalizerStats, python::args("self"),
+           "returns a tuple of (name, numTested, numSkipped, numFired) "
+           "tuples for the normalizer transforms. Only available if "
+           "collectNormalizerStats was set in the options.");
 
   python::class_<MolStandardize::Pipeline>("Pipeline")
       .def(python::init<const MolStandardize::PipelineOptions &>())
-      .def("run", &MolStandardize::Pipeline::run);
+      .def("run", runPipeline, python::args("self", "molblock"))
+      .def("runBatch", runPipelineBatch,
+           (python::arg("self"), python::arg("molblocks"),
+            python::arg("numThreads") = 1),
+           "runs the pipeline on a sequence of molblocks using multiple "
+           "threads and returns the results in input order");
 }
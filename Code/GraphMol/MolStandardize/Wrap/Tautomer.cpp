@@ -494,6 +494,16 @@ struct tautomer_wrapper {
              (python::arg("self")),
              "returns whether AssignStereochemistry will be called "
              "on each tautomer generated by the Enumerate() method.")
+        .def("SetNumThreads",
+             &MolStandardize::TautomerEnumerator::setNumThreads,
+             (python::arg("self"), python::arg("numThreads")),
+             "set the number of threads used by the Enumerate() method. "
+             "The results don't depend on the number of threads. "
+             "This defaults to 1.")
+        .def("GetNumThreads",
+             &MolStandardize::TautomerEnumerator::getNumThreads,
+             (python::arg("self")),
+             "returns the number of threads used by the Enumerate() method.")
         .def("SetCallback", &setCallbackHelper,
              python::args("self", "callback"),
              "Pass an instance of a class derived from\n"
@@ -1848,6 +1848,31 @@ M  END
     self.assertEqual(result.stage, rdMolStandardize.PipelineStage.COMPLETED)
     self.assertEqual(result.status, rdMolStandardize.PipelineStatus.NO_EVENT)
 
+  def test27PipelineBatchAndTimings(self):
+    options = rdMolStandardize.PipelineOptions()
+    options.collectNormalizerStats = True
+    pipeline = rdMolStandardize.Pipeline(options)
+    molblocks = [
+      Chem.MolToMolBlock(Chem.MolFromSmiles(smi))
+      for smi in ('CCO', 'C[S+2]([O-])([O-])C', 'CC(=O)[O-].[Na+]')
+    ] * 4
+    results = pipeline.runBatch(molblocks, numThreads=2)
+    self.assertEqual(len(results), len(molblocks))
+    for molblock, result in zip(molblocks, results):
+      single = pipeline.run(molblock)
+      self.assertEqual(result.inputMolData, molblock)
+      self.assertEqual(result.status, single.status)
+      self.assertEqual(result.outputMolData, single.outputMolData)
+
+    result = results[1]
+    timings = result.GetStageTimings()
+    self.assertEqual(timings[0][0], rdMolStandardize.PipelineStage.PARSING_INPUT)
+    self.assertTrue(all(t >= 0 for _, t in timings))
+    self.assertGreaterEqual(
+      result.GetStageTime(rdMolStandardize.PipelineStage.STANDARDIZATION), 0)
+    stats = result.GetNormalizerStats()
+    self.assertEqual(sum(fired for _, _, _, fired in stats), 1)
+
   def testCustomScoreFuncs(self):
     smi = "CC\\C=C(/O)[C@@H](C)C(C)=O"
     m = Chem.MolFromSmiles(smi)
@@ -1881,3 +1881,110 @@ M  END
     }
   }
 }
+
+TEST_CASE("normalizer prescreen and rule statistics", "[normalizer]") {
+  const std::vector<std::string> smiles = {
+      "CCO",
+      "CN(=O)=O",
+      "O=N(=O)c1ccc(N(=O)=O)cc1CS(C)=O",
+      "C[S+2]([O-])([O-])c1ccc(cc1)[N+](=O)[O-]",
+      "C=C(O)C.CC(O)=N",
+      "[Na]OC(=O)c1ccccc1",
+      "c1ccccc1N=[N+]=[N-]",
+  };
+  SECTION("default mode") {
+    MolStandardize::Normalizer nrml;
+    auto stats = nrml.getRuleStats();
+    REQUIRE(!stats.empty());
+    CHECK(!stats[0].name.empty());
+    for (const auto &stat : stats) {
+      CHECK(stat.numTested == 0);
+    }
+    for (const auto &smi : smiles) {
+      INFO(smi);
+      std::unique_ptr<RWMol> m(SmilesToMol(smi));
+      REQUIRE(m);
+      std::unique_ptr<ROMol> res(nrml.normalize(*m));
+      REQUIRE(res);
+    }
+    std::uint64_t nTested = 0, nSkipped = 0, nFired = 0;
+    for (const auto &stat : nrml.getRuleStats()) {
+      CHECK(stat.numFired <= stat.numTested);
+      nTested += stat.numTested;
+      nSkipped += stat.numSkipped;
+      nFired += stat.numFired;
+    }
+    CHECK(nFired > 0);
+    CHECK(nSkipped > nTested);
+    nrml.resetRuleStats();
+    for (const auto &stat : nrml.getRuleStats()) {
+      CHECK(stat.numTested == 0);
+      CHECK(stat.numSkipped == 0);
+      CHECK(stat.numFired == 0);
+    }
+  }
+  SECTION("single pass") {
+    MolStandardize::Normalizer nrml;
+    MolStandardize::Normalizer singlePass;
+    singlePass.setSinglePass(true);
+    for (const auto &smi : smiles) {
+      INFO(smi);
+      std::unique_ptr<RWMol> m(SmilesToMol(smi));
+      REQUIRE(m);
+      std::unique_ptr<ROMol> res(nrml.normalize(*m));
+      std::unique_ptr<ROMol> res2(singlePass.normalize(*m));
+      CHECK(MolToSmiles(*res2) == MolToSmiles(*res));
+
+      RWMol inPlace(*m);
+      nrml.normalizeInPlace(inPlace);
+      RWMol inPlace2(*m);
+      singlePass.normalizeInPlace(inPlace2);
+      CHECK(MolToSmiles(inPlace2) == MolToSmiles(inPlace));
+    }
+  }
+  SECTION("parameters") {
+    MolStandardize::CleanupParameters params;
+    CHECK(!params.normalizeSinglePass);
+    MolStandardize::updateCleanupParamsFromJSON(
+        params, R"({"normalizeSinglePass":true})");
+    CHECK(params.normalizeSinglePass);
+    std::unique_ptr<MolStandardize::Normalizer> nrml(
+        MolStandardize::normalizerFromParams(params));
+    CHECK(nrml->getSinglePass());
+  }
+}
+
+TEST_CASE("tautomer enumeration with multiple threads", "[tautomers]") {
+  std::vector<std::string> smis{
+      "Oc1c(cccc3)c3nc2ccncc12",
+      "CC(=O)CC(=O)CC(=O)CC(=O)C",
+      "Oc1nc(O)c2[nH]c(O)nc2n1",
+      "C/C=C/C(O)=C(C)C(=O)[C@@H](C)CC",
+      "O=C1C=CC(=O)C=C1[2H]",
+      // stopped by the transforms limit
+      "CC(=O)CC(=O)CC(=O)CC(=O)CC(=O)CC(=O)CC(=O)CC(=O)C"};
+  MolStandardize::TautomerEnumerator serial;
+  CHECK(serial.getNumThreads() == 1);
+  MolStandardize::TautomerEnumerator parallel(serial);
+  parallel.setNumThreads(4);
+  CHECK(parallel.getNumThreads() == 4);
+  MolStandardize::TautomerEnumerator copy(parallel);
+  CHECK(copy.getNumThreads() == 4);
+  for (const auto &smi : smis) {
+    INFO(smi);
+    std::unique_ptr<RWMol> m(SmilesToMol(smi));
+    REQUIRE(m);
+    auto res1 = serial.enumerate(*m);
+    auto res2 = parallel.enumerate(*m);
+    CHECK(res1.status() == res2.status());
+    CHECK(res1.smiles() == res2.smiles());
+    CHECK(res1.modifiedAtoms() == res2.modifiedAtoms());
+    CHECK(res1.modifiedBonds() == res2.modifiedBonds());
+    for (unsigned int i = 0; i < res1.size(); ++i) {
+      CHECK(MolToSmiles(*res1.at(i)) == MolToSmiles(*res2.at(i)));
+    }
+    std::unique_ptr<ROMol> canon1(serial.canonicalize(*m));
+    std::unique_ptr<ROMol> canon2(parallel.canonicalize(*m));
+    CHECK(MolToSmiles(*canon1) == MolToSmiles(*canon2));
+  }
+}
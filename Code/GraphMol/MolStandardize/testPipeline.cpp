@@ -2424,4 +2424,119 @@ TEST_CASE("custom pipeline stages") {
     CHECK(res.outputMolData == "CCCO");
     CHECK(res.inputMolData == "CCC[O-]");
   }
-}
\ No newline at end of file
+}
+TEST_CASE("batch processing and timing") {
+  std::vector<std::string> molblocks;
+  for (const auto smi :
+       {"CCC[O-].[Na+]", "C[N+](=O)[O-]", "c1ccccc1C(=O)O", "CN(=O)=O",
+        "C[S+2]([O-])([O-])C", "O=C([O-])c1ccccc1.[K+]", "CCO", "CC[NH3+]"}) {
+    auto m = v2::SmilesParse::MolFromSmiles(smi);
+    REQUIRE(m);
+    molblocks.push_back(MolToMolBlock(*m));
+  }
+  molblocks.push_back("not a molblock");
+  // make the batch big enough to wrap around the buffer of results
+  const auto numUnique = molblocks.size();
+  for (unsigned int i = 0; i < 5; ++i) {
+    for (unsigned int j = 0; j < numUnique; ++j) {
+      molblocks.push_back(molblocks[j]);
+    }
+  }
+
+  MolStandardize::PipelineOptions options;
+  options.collectNormalizerStats = true;
+  MolStandardize::Pipeline pipeline(options);
+  std::vector<MolStandardize::PipelineResult> expected;
+  for (const auto &mb : molblocks) {
+    expected.push_back(pipeline.run(mb));
+  }
+
+  SECTION("timings and normalizer statistics") {
+    const auto &res = expected[3];
+    CHECK(res.stage ==
+          static_cast<uint32_t>(MolStandardize::PipelineStage::COMPLETED));
+    CHECK(res.stageTimings.size() == 9);
+    CHECK(res.stageTimings.front().stage ==
+          static_cast<uint32_t>(MolStandardize::PipelineStage::PARSING_INPUT));
+    CHECK(res.stageTimings.back().stage ==
+          static_cast<uint32_t>(
+              MolStandardize::PipelineStage::SERIALIZING_OUTPUT));
+    double total = 0.0;
+    for (const auto &timing : res.stageTimings) {
+      CHECK(timing.seconds >= 0.0);
+      total += timing.seconds;
+    }
+    CHECK(res.getStageTime(MolStandardize::PipelineStage::STANDARDIZATION) <=
+          total);
+    CHECK(res.getStageTime(MolStandardize::PipelineStage::COMPLETED) == 0.0);
+
+    REQUIRE(res.normalizerStats.size() == 26);
+    CHECK(res.normalizerStats[0].numTested +
+              res.normalizerStats[0].numSkipped ==
+          1);
+    // the sulfone
+    const auto &sulfone = expected[4];
+    CHECK(sulfone.status &
+          MolStandardize::PipelineStatus::NORMALIZATION_APPLIED);
+    REQUIRE(sulfone.normalizerStats.size() == 26);
+    CHECK(sulfone.normalizerStats[1].numFired == 1);
+    unsigned int numFired = 0;
+    for (const auto &stats : expected[6].normalizerStats) {
+      numFired += stats.numFired;
+    }
+    CHECK(numFired == 0);
+
+    // parsing failures only time the parsing
+    const auto &failed = expected[numUnique - 1];
+    CHECK(failed.stageTimings.size() == 1);
+    CHECK(failed.normalizerStats.empty());
+
+    MolStandardize::Pipeline noStats;
+    CHECK(noStats.run(molblocks[3]).normalizerStats.empty());
+  }
+
+  SECTION("batches") {
+    for (auto numThreads : {1, 2, 4}) {
+      auto results = pipeline.run(molblocks, numThreads);
+      REQUIRE(results.size() == expected.size());
+      for (unsigned int i = 0; i < results.size(); ++i) {
+        CHECK(results[i].status == expected[i].status);
+        CHECK(results[i].stage == expected[i].stage);
+        CHECK(results[i].inputMolData == expected[i].inputMolData);
+        CHECK(results[i].outputMolData == expected[i].outputMolData);
+        CHECK(results[i].parentMolData == expected[i].parentMolData);
+        CHECK(results[i].stageTimings.size() ==
+              expected[i].stageTimings.size());
+        CHECK(results[i].normalizerStats.size() ==
+              expected[i].normalizerStats.size());
+      }
+    }
+  }
+
+  SECTION("results are streamed in order") {
+    std::vector<unsigned int> order;
+    pipeline.run(
+        molblocks,
+        [&](unsigned int idx, MolStandardize::PipelineResult &&res) {
+          CHECK(res.inputMolData == molblocks[idx]);
+          order.push_back(idx);
+        },
+        3);
+    REQUIRE(order.size() == molblocks.size());
+    for (unsigned int i = 0; i < order.size(); ++i) {
+      CHECK(order[i] == i);
+    }
+  }
+
+  SECTION("exceptions in the callback") {
+    unsigned int numCalls = 0;
+    auto callback = [&](unsigned int idx, MolStandardize::PipelineResult &&) {
+      ++numCalls;
+      if (idx == 5) {
+        throw ValueErrorException("stop");
+      }
+    };
+    CHECK_THROWS_AS(pipeline.run(molblocks, callback, 2), ValueErrorException);
+    CHECK(numCalls == 6);
+  }
+}
@@ -27,6 +27,7 @@ void QueryAtom::expandQuery(QUERYATOM_QUERY *what,
                             Queries::CompositeQueryType how,
                             bool maintainOrder) {
   PRECONDITION(dp_query, "Can't expand empty query");
+  dp_compiledQuery.reset();
   bool thisIsNullQuery = dp_query->getDescription() == "AtomNull";
   bool otherIsNullQuery = what->getDescription() == "AtomNull";
 
@@ -180,8 +181,16 @@ bool queriesMatch(QueryAtom::QUERYATOM_QUERY const *q1,
 bool QueryAtom::Match(Atom const *what) const {
   PRECONDITION(what, "bad query atom");
   PRECONDITION(dp_query, "no query set");
+  if (dp_compiledQuery) {
+    return dp_compiledQuery->Match(what);
+  }
   return dp_query->Match(what);
 }
+
+void QueryAtom::compileQuery() {
+  PRECONDITION(dp_query, "no query set");
+  dp_compiledQuery.reset(new CompiledQueryHolder<Atom const *>(*dp_query));
+}
 bool QueryAtom::QueryMatch(QueryAtom const *what) const {
   PRECONDITION(what, "bad query atom");
   PRECONDITION(dp_query, "no query set");
@@ -11,10 +11,12 @@
 #ifndef RD_QUERYATOM_H
 #define RD_QUERYATOM_H
 
+#include <memory>
 #include <utility>
 #include "Atom.h"
 #include <Query/QueryObjects.h>
 #include <GraphMol/QueryOps.h>
+#include <GraphMol/CompiledQuery.h>
 
 namespace RDKit {
 
@@ -53,23 +55,31 @@ class RDKIT_GRAPHMOL_EXPORT QueryAtom : public Atom {
     } else {
       dp_query = nullptr;
     }
+    if (other.dp_compiledQuery) {
+      compileQuery();
+    }
   }
   QueryAtom &operator=(const QueryAtom &other) {
     if (this == &other) {
       return *this;
     }
     Atom::operator=(other);
+    dp_compiledQuery.reset();
     delete dp_query;
     if (other.dp_query) {
       dp_query = other.dp_query->copy();
     } else {
       dp_query = nullptr;
     }
+    if (other.dp_compiledQuery) {
+      compileQuery();
+    }
     return *this;
   }
 
   QueryAtom(QueryAtom &&other) noexcept : Atom(std::move(other)) {
     dp_query = std::exchange(other.dp_query, nullptr);
+    dp_compiledQuery = std::move(other.dp_compiledQuery);
   }
   QueryAtom &operator=(QueryAtom &&other) noexcept {
     if (this == &other) {
@@ -77,6 +87,7 @@ class RDKIT_GRAPHMOL_EXPORT QueryAtom : public Atom {
     }
     QueryAtom::operator=(std::move(other));
     dp_query = std::exchange(other.dp_query, nullptr);
+    dp_compiledQuery = std::move(other.dp_compiledQuery);
     return *this;
   }
 
@@ -93,6 +104,7 @@ class RDKIT_GRAPHMOL_EXPORT QueryAtom : public Atom {
 
   //! replaces our current query with the value passed in
   void setQuery(QUERYATOM_QUERY *what) override {
+    dp_compiledQuery.reset();
     delete dp_query;
     dp_query = what;
   }
@@ -126,8 +138,38 @@ class RDKIT_GRAPHMOL_EXPORT QueryAtom : public Atom {
   //! returns true if our query details match those of QueryAtom \c what
   bool QueryMatch(QueryAtom const *what) const;
 
+  //! compiles our query into a CompiledQuery, which Match() uses from then on
+  /*!
+    <b>Notes:</b>
+      - setQuery() and expandQuery() discard the compiled query. If the query
+        is modified in place (through getQuery()) it is recompiled by
+        updateCompiledQuery(), which substructure searches call once at
+        the start.
+      - this is not thread safe: it must not be called while other threads
+        are matching against this atom.
+  */
+  void compileQuery();
+  //! recompiles our compiled query if our query has been modified in place
+  //! since it was compiled
+  /*!
+    This is safe to call while other threads are matching against this
+    atom.
+  */
+  void updateCompiledQuery() const {
+    if (dp_compiledQuery) {
+      dp_compiledQuery->update();
+    }
+  }
+  //! returns whether or not Match() is using a compiled query
+  bool hasCompiledQuery() const { return dp_compiledQuery != nullptr; }
+  //! returns our compiled query (or nullptr if there isn't one)
+  const CompiledQuery<Atom const *> *getCompiledQuery() const {
+    return dp_compiledQuery ? &dp_compiledQuery->get() : nullptr;
+  }
+
  private:
   QUERYATOM_QUERY *dp_query{nullptr};
+  std::unique_ptr<CompiledQueryHolder<Atom const *>> dp_compiledQuery;
 
 };  // end o' class
 
@@ -30,11 +30,15 @@ QueryBond &QueryBond::operator=(const QueryBond &other) {
   // FIX: how to deal with atom indices?
   dp_mol = nullptr;
   d_bondType = other.d_bondType;
+  dp_compiledQuery.reset();
   if (other.dp_query) {
     dp_query = other.dp_query->copy();
   } else {
     dp_query = nullptr;
   }
+  if (other.dp_compiledQuery) {
+    compileQuery();
+  }
   d_props = other.d_props;
   return *this;
 }
@@ -47,6 +51,7 @@ Bond *QueryBond::copy() const {
 void QueryBond::setBondType(BondType bT) {
   // NOTE: calling this blows out any existing query
   d_bondType = bT;
+  dp_compiledQuery.reset();
   delete dp_query;
   dp_query = nullptr;
 
@@ -67,6 +72,7 @@ void QueryBond::setBondDir(BondDir bD) {
 void QueryBond::expandQuery(QUERYBOND_QUERY *what,
                             Queries::CompositeQueryType how,
                             bool maintainOrder) {
+  dp_compiledQuery.reset();
   bool thisIsNullQuery = dp_query->getDescription() == "BondNull";
   bool otherIsNullQuery = what->getDescription() == "BondNull";
 
@@ -201,8 +207,16 @@ bool queriesMatch(QueryBond::QUERYBOND_QUERY const *q1,
 bool QueryBond::Match(Bond const *what) const {
   PRECONDITION(what, "bad query bond");
   PRECONDITION(dp_query, "no query set");
+  if (dp_compiledQuery) {
+    return dp_compiledQuery->Match(what);
+  }
   return dp_query->Match(what);
 }
+
+void QueryBond::compileQuery() {
+  PRECONDITION(dp_query, "no query set");
+  dp_compiledQuery.reset(new CompiledQueryHolder<Bond const *>(*dp_query));
+}
 bool QueryBond::QueryMatch(QueryBond const *what) const {
   PRECONDITION(what, "bad query bond");
   PRECONDITION(dp_query, "no query set");
@@ -11,9 +11,11 @@
 #ifndef _RD_QUERYBOND_H
 #define _RD_QUERYBOND_H
 
+#include <memory>
 #include <Query/QueryObjects.h>
 #include "Bond.h"
 #include "QueryOps.h"
+#include "CompiledQuery.h"
 
 namespace RDKit {
 
@@ -41,9 +43,13 @@ class RDKIT_GRAPHMOL_EXPORT QueryBond : public Bond {
     } else {
       dp_query = nullptr;
     }
+    if (other.dp_compiledQuery) {
+      compileQuery();
+    }
   }
   QueryBond(QueryBond &&other) noexcept : Bond(std::move(other)) {
     dp_query = std::move(other.dp_query);
+    dp_compiledQuery = std::move(other.dp_compiledQuery);
   }
   QueryBond &operator=(QueryBond &&other) noexcept {
     if (this == &other) {
@@ -51,6 +57,7 @@ class RDKIT_GRAPHMOL_EXPORT QueryBond : public Bond {
     }
     QueryBond::operator=(std::move(other));
     dp_query = std::move(other.dp_query);
+    dp_compiledQuery = std::move(other.dp_compiledQuery);
     return *this;
   }
 
@@ -72,6 +79,35 @@ class RDKIT_GRAPHMOL_EXPORT QueryBond : public Bond {
   //! returns true if our query details match those of QueryBond \c what
   bool QueryMatch(QueryBond const *what) const;
 
+  //! compiles our query into a CompiledQuery, which Match() uses from then on
+  /*!
+    <b>Notes:</b>
+      - setQuery(), expandQuery() and setBondType() discard the compiled
+        query. If the query is modified in place (through getQuery()) it is
+        recompiled by updateCompiledQuery(), which substructure searches
+        call once at the start.
+      - this is not thread safe: it must not be called while other threads
+        are matching against this bond.
+  */
+  void compileQuery();
+  //! recompiles our compiled query if our query has been modified in place
+  //! since it was compiled
+  /*!
+    This is safe to call while other threads are matching against this
+    bond.
+  */
+  void updateCompiledQuery() const {
+    if (dp_compiledQuery) {
+      dp_compiledQuery->update();
+    }
+  }
+  //! returns whether or not Match() is using a compiled query
+  bool hasCompiledQuery() const { return dp_compiledQuery != nullptr; }
+  //! returns our compiled query (or nullptr if there isn't one)
+  const CompiledQuery<Bond const *> *getCompiledQuery() const {
+    return dp_compiledQuery ? &dp_compiledQuery->get() : nullptr;
+  }
+
   // This method can be used to distinguish query bonds from standard bonds
   bool hasQuery() const override { return dp_query != nullptr; }
 
@@ -80,6 +116,7 @@ class RDKIT_GRAPHMOL_EXPORT QueryBond : public Bond {
   //! replaces our current query with the value passed in
   void setQuery(QUERYBOND_QUERY *what) override {
     // free up any existing query (Issue255):
+    dp_compiledQuery.reset();
     delete dp_query;
     dp_query = what;
   }
@@ -115,6 +152,7 @@ class RDKIT_GRAPHMOL_EXPORT QueryBond : public Bond {
 
  protected:
   QUERYBOND_QUERY *dp_query{nullptr};
+  std::unique_ptr<CompiledQueryHolder<Bond const *>> dp_compiledQuery;
 };
 
 namespace detail {
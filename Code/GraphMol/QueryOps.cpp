@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <RDGeneral/types.h>
 #include <GraphMol/QueryAtom.h>
+#include <GraphMol/QueryBond.h>
 #include <boost/range/iterator_range.hpp>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/algorithm/string.hpp>
@@ -595,6 +596,57 @@ makeSingleOrDoubleOrAromaticBondQuery() {
   return res;
 };
 
+bool RecursiveStructureQuery::Match(Atom const *what) const {
+  if (const auto results = detail::RecursiveQueryResults::current()) {
+    if (const auto matches = results->getMatches(this)) {
+      const auto idx = what->getIdx();
+      return (idx < matches->size() && (*matches)[idx]) ^ getNegation();
+    }
+  }
+  return Queries::SetQuery<int, Atom const *, true>::Match(what);
+}
+
+namespace detail {
+namespace {
+thread_local RecursiveQueryResults *currentRecursiveQueryResults = nullptr;
+}  // namespace
+
+RecursiveQueryResults::RecursiveQueryResults()
+    : dp_previous(currentRecursiveQueryResults) {
+  currentRecursiveQueryResults = this;
+}
+
+RecursiveQueryResults::~RecursiveQueryResults() {
+  currentRecursiveQueryResults = dp_previous;
+}
+
+void RecursiveQueryResults::setMatches(const RecursiveStructureQuery *query,
+                                       boost::dynamic_bitset<> matches) {
+  PRECONDITION(query, "bad query");
+  for (auto &[q, res] : d_results) {
+    if (q == query) {
+      res = std::move(matches);
+      return;
+    }
+  }
+  d_results.emplace_back(query, std::move(matches));
+}
+
+const boost::dynamic_bitset<> *RecursiveQueryResults::getMatches(
+    const RecursiveStructureQuery *query) const {
+  for (const auto &[q, res] : d_results) {
+    if (q == query) {
+      return &res;
+    }
+  }
+  return nullptr;
+}
+
+const RecursiveQueryResults *RecursiveQueryResults::current() {
+  return currentRecursiveQueryResults;
+}
+}  // namespace detail
+
 namespace QueryOps {
 // we don't use these anymore but we need to keep them around for backwards
 // compatibility with pickled queries. There's no reason to update this list.
@@ -976,6 +1028,19 @@ void completeQueryAndChildren(Atom::QUERYATOM_QUERY *query, Atom *tgt,
     completeQueryAndChildren(childIt->get(), tgt, magicVal);
   }
 }
+
+void compileRecursiveQueries(Atom::QUERYATOM_QUERY *query) {
+  if (auto rsq = dynamic_cast<RecursiveStructureQuery *>(query)) {
+    // the query molecule is const, so compile a copy of it
+    auto queryMol = new ROMol(*rsq->getQueryMol());
+    compileMolQueries(*queryMol);
+    rsq->setQueryMol(queryMol);
+  }
+  for (auto childIt = query->beginChildren(); childIt != query->endChildren();
+       ++childIt) {
+    compileRecursiveQueries(childIt->get());
+  }
+}
 }  // namespace
 void completeMolQueries(RWMol *mol, unsigned int magicVal) {
   PRECONDITION(mol, "bad molecule");
@@ -986,6 +1051,39 @@ void completeMolQueries(RWMol *mol, unsigned int magicVal) {
   }
 }
 
+void compileMolQueries(ROMol &mol) {
+  for (auto atom : mol.atoms()) {
+    if (auto qatom = dynamic_cast<QueryAtom *>(atom);
+        qatom && qatom->hasQuery()) {
+      compileRecursiveQueries(qatom->getQuery());
+      qatom->compileQuery();
+    }
+  }
+  for (auto bond : mol.bonds()) {
+    if (auto qbond = dynamic_cast<QueryBond *>(bond);
+        qbond && qbond->hasQuery()) {
+      qbond->compileQuery();
+    }
+  }
+}
+
+void updateCompiledMolQueries(const ROMol &mol) {
+  for (const auto atom : mol.atoms()) {
+    if (atom->hasQuery()) {
+      if (const auto qatom = dynamic_cast<const QueryAtom *>(atom)) {
+        qatom->updateCompiledQuery();
+      }
+    }
+  }
+  for (const auto bond : mol.bonds()) {
+    if (bond->hasQuery()) {
+      if (const auto qbond = dynamic_cast<const QueryBond *>(bond)) {
+        qbond->updateCompiledQuery();
+      }
+    }
+  }
+}
+
 Atom *replaceAtomWithQueryAtom(RWMol *mol, Atom *atom) {
   PRECONDITION(mol, "bad molecule");
   PRECONDITION(atom, "bad atom");
@@ -22,6 +22,7 @@
 #include <Query/Query.h>
 #include <DataStructs/BitVects.h>
 #include <DataStructs/BitOps.h>
+#include <boost/dynamic_bitset.hpp>
 #include <functional>
 
 #include <functional>
@@ -840,14 +841,58 @@ class RDKIT_GRAPHMOL_EXPORT RecursiveStructureQuery
   }
   unsigned int getSerialNumber() const { return d_serialNumber; }
 
-#ifdef RDK_BUILD_THREADSAFE_SSS
-  std::mutex d_mutex;
-#endif
+  //! returns whether or not an atom matches the query
+  /*!
+    During a substructure search the results of the recursive match are
+    taken from the search's detail::RecursiveQueryResults, so a single query
+    can be used from multiple threads at the same time. Outside of a search
+    the atom indices in our set are used.
+  */
+  bool Match(Atom const *what) const override;
+
  private:
   boost::shared_ptr<const ROMol> dp_queryMol;
   unsigned int d_serialNumber{0};
 };
 
+namespace detail {
+//! holds the results of the recursive queries evaluated by a substructure
+//! search
+/*!
+  While an instance of this class is alive, RecursiveStructureQuery::Match()
+  calls on the thread which created it use the results stored in it. Each
+  search creates its own instance, so nothing is stored in the (shared) query
+  molecule and searches using the same query can run concurrently without
+  locking. Instances can be nested; the most recently created one is used.
+*/
+class RDKIT_GRAPHMOL_EXPORT RecursiveQueryResults {
+ public:
+  RecursiveQueryResults();
+  ~RecursiveQueryResults();
+  RecursiveQueryResults(const RecursiveQueryResults &) = delete;
+  RecursiveQueryResults &operator=(const RecursiveQueryResults &) = delete;
+
+  //! sets the atoms which match a query
+  void setMatches(const RecursiveStructureQuery *query,
+                  boost::dynamic_bitset<> matches);
+  //! returns the atoms which match a query, nullptr if it hasn't been
+  //! evaluated
+  const boost::dynamic_bitset<> *getMatches(
+      const RecursiveStructureQuery *query) const;
+
+  //! returns the results being used on the calling thread (if any)
+  static const RecursiveQueryResults *current();
+
+ private:
+  // searches rarely involve more than a handful of recursive queries, so a
+  // linear search beats a map here
+  std::vector<
+      std::pair<const RecursiveStructureQuery *, boost::dynamic_bitset<>>>
+      d_results;
+  RecursiveQueryResults *dp_previous = nullptr;
+};
+}  // namespace detail
+
 template <typename T>
 int nullDataFun(T) {
   return 1;
@@ -1174,6 +1219,26 @@ inline bool isAtomDummy(const Atom *a) {
 namespace QueryOps {
 RDKIT_GRAPHMOL_EXPORT void completeMolQueries(
     RWMol *mol, unsigned int magicVal = 0xDEADBEEF);
+//! compiles the queries of the query atoms and bonds of a molecule,
+//! including those of the molecules in recursive queries
+/*!
+  Substructure searches with the molecule as the query then evaluate the atom
+  and bond queries using the compiled form; see CompiledQuery.h for the
+  details. This is not thread safe and must not be called while the molecule
+  is being used in other threads.
+*/
+RDKIT_GRAPHMOL_EXPORT void compileMolQueries(ROMol &mol);
+//! recompiles the compiled queries of the atoms and bonds of a molecule which
+//! have been modified in place since they were compiled
+/*!
+  The substructure search calls this once for the query molecule (and for
+  each of the molecules in its recursive queries) before it starts matching,
+  so that the compiled queries do not have to check whether they are still
+  current on every match. Code which matches the atoms and bonds of a
+  compiled query molecule directly should call it after modifying their
+  queries in place.
+*/
+RDKIT_GRAPHMOL_EXPORT void updateCompiledMolQueries(const ROMol &mol);
 // Replaces the given atom in the molecule with a QueryAtom that is otherwise
 // a copy of the given atom.  Returns a pointer to that atom.
 // if the atom already has a query, nothing will be changed
@@ -610,6 +610,15 @@ class RDKIT_GRAPHMOL_EXPORT ROMol : public RDProps {
 
   virtual ~ROMol() { destroy(); }
 
+  //! molecules are allocated from the thread's arena when one is active, see
+  //! MolArena.h
+  static void *operator new(std::size_t size) {
+    return MolArena::allocate(size);
+  }
+  static void operator delete(void *ptr) noexcept {
+    MolArena::deallocate(ptr);
+  }
+
   //! @}
   //! \name Atoms
   //! @{
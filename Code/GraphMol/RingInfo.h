@@ -18,6 +18,7 @@
 #include <boost/shared_ptr.hpp>
 #include <RDGeneral/BoostEndInclude.h>
 #include <RingDecomposerLib.h>
+#include <GraphMol/MolArena.h>
 
 namespace RDKit {
 //! A class to store information about a molecule's rings
@@ -45,6 +46,15 @@ class RDKIT_GRAPHMOL_EXPORT RingInfo {
   RingInfo &operator=(const RingInfo &other) = default;
   RingInfo(RingInfo &&other) noexcept = default;
   RingInfo &operator=(RingInfo &&other) noexcept = default;
+
+  //! RingInfos are allocated from the thread's arena when one is active, see
+  //! MolArena.h
+  static void *operator new(std::size_t size) {
+    return MolArena::allocate(size);
+  }
+  static void operator delete(void *ptr) noexcept {
+    MolArena::deallocate(ptr);
+  }
   //! checks to see if we've been properly initialized
   bool isInitialized() const { return df_init; }
   //! does initialization
@@ -29,6 +29,7 @@
 #include <boost/lexical_cast.hpp>
 #include <RDGeneral/BoostEndInclude.h>
 #include <GraphMol/RDKitBase.h>
+#include <GraphMol/MolArena.h>
 #include <GraphMol/QueryOps.h>
 #include <GraphMol/Chirality.h>
 #include <GraphMol/Atropisomers.h>
@@ -46,6 +47,7 @@
 // show up very quickly in the tests.
 #include "smarts.tab.hpp"
 #include <list>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -426,6 +428,10 @@ std::unique_ptr<RWMol> MolFromSmiles(const std::string &smiles,
   if (yysmiles_debug != params.debugParse) {
     yysmiles_debug = params.debugParse;
   }
+  std::optional<MolArena::Scope> arenaScope;
+  if (params.useArena) {
+    arenaScope.emplace();
+  }
 
   std::string lsmiles, name, cxPart;
   preprocessSmiles(smiles, params, lsmiles, name, cxPart);
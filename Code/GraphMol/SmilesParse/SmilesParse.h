@@ -51,6 +51,8 @@ struct RDKIT_SMILESPARSE_EXPORT SmilesParserParams {
   bool debugParse = false;  /**< enable debugging in the SMILES parser*/
   std::map<std::string, std::string>
       replacements; /**< allows SMILES "macros" */
+  bool useArena = false; /**< allocate the molecule from the thread's
+                              MolArena, see MolArena.h */
 };
 
 struct RDKIT_SMILESPARSE_EXPORT SmartsParserParams {
@@ -0,0 +1,196 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+/*! \file CompactMolQuery.h
+
+  \brief Defines substructure queries which can be matched against
+  CompactMols
+
+*/
+#include <RDGeneral/export.h>
+#ifndef RD_COMPACTMOLQUERY_H
+#define RD_COMPACTMOLQUERY_H
+
+#include <GraphMol/Atom.h>
+#include <GraphMol/Bond.h>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace RDKit {
+class ROMol;
+class CompactMol;
+struct SubstructMatchParameters;
+typedef std::vector<std::pair<int, int>> MatchVectType;
+
+//! A substructure query for searching CompactMols
+/*!
+  CompactMols cannot hold query features, so the queries used to search
+  them are created from an ROMol, which may have query atoms and bonds
+  (e.g. from SMARTS), or from another CompactMol. The atom and bond queries
+  are translated to work directly on the data of a CompactMol when the
+  CompactMolQuery is constructed, so it can be reused for any number of
+  searches.
+
+  Most of the queries the SMARTS parser creates are supported, including
+  recursive SMARTS. Queries which need information a CompactMol doesn't
+  have, like ring sizes, valences, the number of implicit Hs, masses, or
+  atom and bond properties, cause a ValueErrorException.
+
+  If both the query and the molecule have a pattern fingerprint of the same
+  size (see setPatternFingerprint()), molecules which can't match are
+  rejected before the search starts.
+*/
+class RDKIT_SUBSTRUCTMATCH_EXPORT CompactMolQuery {
+ public:
+  //! construct from an ROMol, which may have query atoms and bonds
+  explicit CompactMolQuery(const ROMol &query);
+  //! construct from a CompactMol, this also takes its pattern fingerprint
+  explicit CompactMolQuery(const CompactMol &query);
+
+  unsigned int getNumAtoms() const { return d_numAtoms; }
+  unsigned int getNumBonds() const { return d_numBonds; }
+
+  //! \name Graph
+  //! @{
+  unsigned int getDegree(unsigned int idx) const {
+    return d_nbrOffsets[idx + 1] - d_nbrOffsets[idx];
+  }
+  //! returns the indices of the atom's neighbors
+  std::span<const std::uint32_t> getAtomNeighbors(unsigned int idx) const {
+    return {d_nbrAtoms.data() + d_nbrOffsets[idx], getDegree(idx)};
+  }
+  //! returns the indices of the atom's bonds, in the same order as
+  //! getAtomNeighbors()
+  std::span<const std::uint32_t> getAtomBonds(unsigned int idx) const {
+    return {d_nbrBonds.data() + d_nbrOffsets[idx], getDegree(idx)};
+  }
+  Atom::ChiralType getChiralTag(unsigned int idx) const {
+    return static_cast<Atom::ChiralType>(d_chiralTags[idx]);
+  }
+  unsigned int getBeginAtomIdx(unsigned int idx) const {
+    return d_beginAtoms[idx];
+  }
+  unsigned int getEndAtomIdx(unsigned int idx) const {
+    return d_endAtoms[idx];
+  }
+  Bond::BondType getBondType(unsigned int idx) const {
+    return static_cast<Bond::BondType>(d_bondTypes[idx]);
+  }
+  Bond::BondStereo getBondStereo(unsigned int idx) const {
+    return static_cast<Bond::BondStereo>(d_bondStereos[idx]);
+  }
+  //! returns the bond's stereo atoms, this is empty if it has none
+  std::span<const std::uint32_t> getBondStereoAtoms(unsigned int idx) const {
+    if (d_stereoAtoms[2 * idx] == noStereoAtom) {
+      return {};
+    }
+    return {d_stereoAtoms.data() + 2 * idx, 2};
+  }
+  //! @}
+
+  //! \name Pattern fingerprint
+  //! @{
+  //! sets the query's pattern fingerprint
+  /*!
+    \param words   the bits of the fingerprint packed into 64 bit words, as
+                   PackedBitOps::packBitVect() does
+    \param numBits the size of the fingerprint
+  */
+  void setPatternFingerprint(std::vector<std::uint64_t> words,
+                             unsigned int numBits);
+  bool hasPatternFingerprint() const { return d_patternFpSize != 0; }
+  unsigned int getPatternFingerprintSize() const { return d_patternFpSize; }
+  const std::vector<std::uint64_t> &getPatternFingerprintWords() const {
+    return d_patternFp;
+  }
+  //! @}
+
+ private:
+  static constexpr std::uint32_t noStereoAtom = 0xffffffff;
+
+  //! a node of an atom or bond query
+  struct QueryNode {
+    enum class Type : std::uint8_t {
+      And,
+      Or,
+      Xor,
+      True,
+      Equal,
+      Greater,
+      GreaterEqual,
+      Less,
+      LessEqual,
+      Range,
+      PlainAtom,
+      PlainBond,
+      Recursive
+    };
+    Type type = Type::True;
+    //! the value which is compared, see CompactSubstructMatch.cpp
+    std::uint8_t feature = 0;
+    bool negated = false;
+    bool lowerOpen = false;
+    bool upperOpen = false;
+    int val = 0;  // also the lower bound of ranges
+    int upper = 0;
+    int tol = 0;
+    //! the children of composite nodes are d_children[begin, end), for the
+    //! other node types begin is the index of the plain atom or bond or of
+    //! the recursive query
+    std::uint32_t begin = 0;
+    std::uint32_t end = 0;
+  };
+  struct PlainAtom {
+    int atomicNum = 0;
+    int formalCharge = 0;
+    unsigned int isotope = 0;
+    unsigned int numRadicalElectrons = 0;
+  };
+  struct PlainBond {
+    Bond::BondType bondType = Bond::UNSPECIFIED;
+    bool isConjugated = false;
+  };
+  class Builder;
+  class Matcher;
+  friend std::vector<MatchVectType> SubstructMatch(
+      const CompactMol &mol, const CompactMolQuery &query,
+      const SubstructMatchParameters &params);
+
+  void initGraph(unsigned int numAtoms, unsigned int numBonds);
+
+  unsigned int d_numAtoms = 0;
+  unsigned int d_numBonds = 0;
+  std::vector<std::uint32_t> d_nbrOffsets;
+  std::vector<std::uint32_t> d_nbrAtoms;
+  std::vector<std::uint32_t> d_nbrBonds;
+  std::vector<std::uint32_t> d_beginAtoms;
+  std::vector<std::uint32_t> d_endAtoms;
+  std::vector<std::uint32_t> d_stereoAtoms;
+  std::vector<std::uint8_t> d_chiralTags;
+  std::vector<std::uint8_t> d_bondTypes;
+  std::vector<std::uint8_t> d_bondStereos;
+
+  //! the index of the root node of each atom's and bond's query
+  std::vector<std::uint32_t> d_atomQueries;
+  std::vector<std::uint32_t> d_bondQueries;
+  std::vector<QueryNode> d_nodes;
+  std::vector<std::uint32_t> d_children;
+  std::vector<PlainAtom> d_plainAtoms;
+  std::vector<PlainBond> d_plainBonds;
+  std::vector<std::shared_ptr<const CompactMolQuery>> d_recursiveQueries;
+
+  std::vector<std::uint64_t> d_patternFp;
+  unsigned int d_patternFpSize = 0;
+};
+
+}  // namespace RDKit
+#endif
@@ -0,0 +1,978 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include "SubstructMatch.h"
+#include "CompactMolQuery.h"
+#include <GraphMol/Chirality.h>
+#include <GraphMol/CompactMol.h>
+#include <GraphMol/QueryOps.h>
+#include <GraphMol/RDKitBase.h>
+#include <RDGeneral/Exceptions.h>
+#include <RDGeneral/utils.h>
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <set>
+#include <string_view>
+#include <typeinfo>
+#include <unordered_map>
+
+namespace RDKit {
+
+namespace {
+// the atom and bond values queries can be made on. Each of these mirrors
+// one of the data functions in QueryOps.h
+enum class AtomFeature : std::uint8_t {
+  AtomicNum,
+  AtomType,
+  IsAromatic,
+  IsAliphatic,
+  ExplicitDegree,
+  TotalDegree,
+  HeavyAtomDegree,
+  NonHydrogenDegree,
+  HCount,
+  Isotope,
+  FormalCharge,
+  NegativeFormalCharge,
+  Hybridization,
+  NumRadicalElectrons,
+  HasChiralTag,
+  InRing,
+  InNRings,
+  RingBondCount,
+  HasRingBond,
+  NumHeteroatomNbrs,
+  HasHeteroatomNbrs,
+  NumAliphaticHeteroatomNbrs,
+  HasAliphaticHeteroatomNbrs
+};
+enum class BondFeature : std::uint8_t {
+  BondOrder,
+  SingleOrAromatic,
+  DoubleOrAromatic,
+  SingleOrDouble,
+  SingleOrDoubleOrAromatic,
+  InRing,
+  InNRings,
+  HasStereo
+};
+
+// the queries are recognized by their descriptions, as in QueryOps.cpp
+const std::map<std::string_view, AtomFeature> atomFeatures = {
+    {"AtomAtomicNum", AtomFeature::AtomicNum},
+    {"AtomType", AtomFeature::AtomType},
+    {"AtomIsAromatic", AtomFeature::IsAromatic},
+    {"AtomIsAliphatic", AtomFeature::IsAliphatic},
+    {"AtomExplicitDegree", AtomFeature::ExplicitDegree},
+    {"AtomTotalDegree", AtomFeature::TotalDegree},
+    {"AtomHeavyAtomDegree", AtomFeature::HeavyAtomDegree},
+    {"AtomNonHydrogenDegree", AtomFeature::NonHydrogenDegree},
+    {"AtomHCount", AtomFeature::HCount},
+    {"AtomIsotope", AtomFeature::Isotope},
+    {"AtomFormalCharge", AtomFeature::FormalCharge},
+    {"AtomNegativeFormalCharge", AtomFeature::NegativeFormalCharge},
+    {"AtomHybridization", AtomFeature::Hybridization},
+    {"AtomNumRadicalElectrons", AtomFeature::NumRadicalElectrons},
+    {"AtomHasChiralTag", AtomFeature::HasChiralTag},
+    {"AtomInRing", AtomFeature::InRing},
+    {"AtomInNRings", AtomFeature::InNRings},
+    {"AtomRingBondCount", AtomFeature::RingBondCount},
+    {"AtomHasRingBond", AtomFeature::HasRingBond},
+    {"AtomNumHeteroatomNeighbors", AtomFeature::NumHeteroatomNbrs},
+    {"AtomHasHeteroatomNeighbors", AtomFeature::HasHeteroatomNbrs},
+    {"AtomNumAliphaticHeteroatomNeighbors",
+     AtomFeature::NumAliphaticHeteroatomNbrs},
+    {"AtomHasAliphaticHeteroatomNeighbors",
+     AtomFeature::HasAliphaticHeteroatomNbrs}};
+const std::map<std::string_view, BondFeature> bondFeatures = {
+    {"BondOrder", BondFeature::BondOrder},
+    {"SingleOrAromaticBond", BondFeature::SingleOrAromatic},
+    {"DoubleOrAromaticBond", BondFeature::DoubleOrAromatic},
+    {"SingleOrDoubleBond", BondFeature::SingleOrDouble},
+    {"SingleOrDoubleOrAromaticBond", BondFeature::SingleOrDoubleOrAromatic},
+    {"BondInRing", BondFeature::InRing},
+    {"BondInNRings", BondFeature::InNRings},
+    {"BondStereo", BondFeature::HasStereo}};
+
+int countNeighbors(const CompactMol &mol, unsigned int idx, auto pred) {
+  const auto nbrs = mol.getAtomNeighbors(idx);
+  return static_cast<int>(std::count_if(nbrs.begin(), nbrs.end(), pred));
+}
+
+bool isHeteroatom(const CompactMol &mol, unsigned int idx) {
+  return mol.getAtomicNum(idx) != 6 && mol.getAtomicNum(idx) != 1;
+}
+
+int getAtomFeature(AtomFeature feature, const CompactMol &mol,
+                   unsigned int idx) {
+  switch (feature) {
+    case AtomFeature::AtomicNum:
+      return mol.getAtomicNum(idx);
+    case AtomFeature::AtomType:
+      return makeAtomType(mol.getAtomicNum(idx), mol.getAtomIsAromatic(idx));
+    case AtomFeature::IsAromatic:
+      return mol.getAtomIsAromatic(idx);
+    case AtomFeature::IsAliphatic:
+      return !mol.getAtomIsAromatic(idx);
+    case AtomFeature::ExplicitDegree:
+      return mol.getDegree(idx);
+    case AtomFeature::TotalDegree:
+      return mol.getDegree(idx) + mol.getNumHs(idx);
+    case AtomFeature::HeavyAtomDegree:
+      return countNeighbors(mol, idx, [&mol](std::uint32_t nbr) {
+        return mol.getAtomicNum(nbr) > 1;
+      });
+    case AtomFeature::NonHydrogenDegree:
+      // D and T are treated as "non-hydrogen" here
+      return countNeighbors(mol, idx, [&mol](std::uint32_t nbr) {
+        return mol.getAtomicNum(nbr) != 1 || mol.getIsotope(nbr) > 1;
+      });
+    case AtomFeature::HCount:
+      // getNumHs() doesn't include the Hs in the graph
+      return mol.getNumHs(idx) +
+             countNeighbors(mol, idx, [&mol](std::uint32_t nbr) {
+               return mol.getAtomicNum(nbr) == 1;
+             });
+    case AtomFeature::Isotope:
+      return mol.getIsotope(idx);
+    case AtomFeature::FormalCharge:
+      return mol.getFormalCharge(idx);
+    case AtomFeature::NegativeFormalCharge:
+      return -mol.getFormalCharge(idx);
+    case AtomFeature::Hybridization:
+      return mol.getHybridization(idx);
+    case AtomFeature::NumRadicalElectrons:
+      return mol.getNumRadicalElectrons(idx);
+    case AtomFeature::HasChiralTag:
+      return mol.getChiralTag(idx) != Atom::CHI_UNSPECIFIED;
+    case AtomFeature::InRing:
+      return mol.getNumAtomRings(idx) != 0;
+    case AtomFeature::InNRings:
+      return mol.getNumAtomRings(idx);
+    case AtomFeature::RingBondCount:
+    case AtomFeature::HasRingBond: {
+      const auto bonds = mol.getAtomBonds(idx);
+      const int res = std::count_if(
+          bonds.begin(), bonds.end(),
+          [&mol](std::uint32_t bond) { return mol.getNumBondRings(bond); });
+      return feature == AtomFeature::HasRingBond ? res != 0 : res;
+    }
+    case AtomFeature::NumHeteroatomNbrs:
+    case AtomFeature::HasHeteroatomNbrs: {
+      const auto res = countNeighbors(mol, idx, [&mol](std::uint32_t nbr) {
+        return isHeteroatom(mol, nbr);
+      });
+      return feature == AtomFeature::HasHeteroatomNbrs ? res != 0 : res;
+    }
+    case AtomFeature::NumAliphaticHeteroatomNbrs:
+    case AtomFeature::HasAliphaticHeteroatomNbrs: {
+      const auto res = countNeighbors(mol, idx, [&mol](std::uint32_t nbr) {
+        return !mol.getAtomIsAromatic(nbr) && isHeteroatom(mol, nbr);
+      });
+      return feature == AtomFeature::HasAliphaticHeteroatomNbrs ? res != 0
+                                                                 : res;
+    }
+  }
+  return 0;
+}
+
+int getBondFeature(BondFeature feature, const CompactMol &mol,
+                   unsigned int idx) {
+  const auto bondType = mol.getBondType(idx);
+  switch (feature) {
+    case BondFeature::BondOrder:
+      return bondType;
+    case BondFeature::SingleOrAromatic:
+      return bondType == Bond::SINGLE || bondType == Bond::AROMATIC;
+    case BondFeature::DoubleOrAromatic:
+      return bondType == Bond::DOUBLE || bondType == Bond::AROMATIC;
+    case BondFeature::SingleOrDouble:
+      return bondType == Bond::SINGLE || bondType == Bond::DOUBLE;
+    case BondFeature::SingleOrDoubleOrAromatic:
+      return bondType == Bond::SINGLE || bondType == Bond::DOUBLE ||
+             bondType == Bond::AROMATIC;
+    case BondFeature::InRing:
+      return mol.getNumBondRings(idx) != 0;
+    case BondFeature::InNRings:
+      return mol.getNumBondRings(idx);
+    case BondFeature::HasStereo:
+      return mol.getBondStereo(idx) > Bond::STEREONONE;
+  }
+  return 0;
+}
+
+template <typename MolType>
+bool hasChiralLabel(const MolType &mol, unsigned int idx) {
+  return mol.getChiralTag(idx) == Atom::CHI_TETRAHEDRAL_CW ||
+         mol.getChiralTag(idx) == Atom::CHI_TETRAHEDRAL_CCW;
+}
+
+template <typename MolType>
+bool hasSpecifiedDoubleBondStereo(const MolType &mol, unsigned int idx) {
+  return mol.getBondType(idx) == Bond::DOUBLE &&
+         mol.getBondStereo(idx) > Bond::STEREOANY;
+}
+
+// returns false if the pattern fingerprints show that the query can't match
+bool passesPatternFingerprint(const CompactMol &mol,
+                              const CompactMolQuery &query) {
+  if (!mol.hasPatternFingerprint() || !query.hasPatternFingerprint() ||
+      mol.getPatternFingerprintSize() != query.getPatternFingerprintSize()) {
+    return true;
+  }
+  const auto &molWords = mol.getPatternFingerprintWords();
+  const auto &queryWords = query.getPatternFingerprintWords();
+  for (unsigned int i = 0; i < queryWords.size(); ++i) {
+    if (queryWords[i] & ~molWords[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+// translates atom and bond queries into QueryNodes
+class CompactMolQuery::Builder {
+ public:
+  explicit Builder(CompactMolQuery &query) : d_query(query) {}
+
+  std::uint32_t addPlainAtom(PlainAtom atom) {
+    QueryNode node;
+    node.type = QueryNode::Type::PlainAtom;
+    node.begin = d_query.d_plainAtoms.size();
+    d_query.d_plainAtoms.push_back(atom);
+    return addNode(node);
+  }
+
+  std::uint32_t addPlainBond(PlainBond bond) {
+    QueryNode node;
+    node.type = QueryNode::Type::PlainBond;
+    node.begin = d_query.d_plainBonds.size();
+    d_query.d_plainBonds.push_back(bond);
+    return addNode(node);
+  }
+
+  template <class TargetPtr>
+  std::uint32_t addQuery(const Queries::Query<int, TargetPtr, true> *q) {
+    PRECONDITION(q, "bad query");
+    constexpr bool isAtomQuery = std::is_same_v<TargetPtr, Atom const *>;
+    const auto &type = typeid(*q);
+    QueryNode node;
+    node.negated = q->getNegation();
+    if (type == typeid(Queries::AndQuery<int, TargetPtr, true>) ||
+        type == typeid(Queries::OrQuery<int, TargetPtr, true>) ||
+        type == typeid(Queries::XOrQuery<int, TargetPtr, true>)) {
+      if (type == typeid(Queries::AndQuery<int, TargetPtr, true>)) {
+        node.type = QueryNode::Type::And;
+      } else if (type == typeid(Queries::OrQuery<int, TargetPtr, true>)) {
+        node.type = QueryNode::Type::Or;
+      } else {
+        node.type = QueryNode::Type::Xor;
+      }
+      std::vector<std::uint32_t> children;
+      for (auto it = q->beginChildren(); it != q->endChildren(); ++it) {
+        children.push_back(addQuery(it->get()));
+      }
+      node.begin = d_query.d_children.size();
+      d_query.d_children.insert(d_query.d_children.end(), children.begin(),
+                                children.end());
+      node.end = d_query.d_children.size();
+      return addNode(node);
+    }
+    if constexpr (isAtomQuery) {
+      if (type == typeid(RecursiveStructureQuery)) {
+        node.type = QueryNode::Type::Recursive;
+        node.begin = addRecursiveQuery(
+            static_cast<const RecursiveStructureQuery *>(q));
+        return addNode(node);
+      }
+      if (type == typeid(AtomRingQuery)) {
+        // used for the ring counts in SMARTS (R, R<n>, x, x<n>), a negative
+        // value matches any atom with a nonzero count
+        const auto rq = static_cast<const AtomRingQuery *>(q);
+        const bool isRingBondCount =
+            rq->getDescription() == "AtomRingBondCount";
+        if (!isRingBondCount && rq->getDescription() != "AtomInNRings") {
+          throw ValueErrorException(
+              "query not supported for CompactMol substructure searches: " +
+              rq->getDescription());
+        }
+        node.type = QueryNode::Type::Equal;
+        if (rq->getVal() < 0) {
+          node.feature = static_cast<std::uint8_t>(
+              isRingBondCount ? AtomFeature::HasRingBond : AtomFeature::InRing);
+          node.val = 1;
+        } else {
+          node.feature = static_cast<std::uint8_t>(
+              isRingBondCount ? AtomFeature::RingBondCount
+                              : AtomFeature::InNRings);
+          node.val = rq->getVal();
+          node.tol = rq->getTol();
+        }
+        return addNode(node);
+      }
+    }
+
+    std::string_view descr = q->getDescription();
+    for (std::string_view prefix : {"range_", "less_", "greater_"}) {
+      if (descr.starts_with(prefix)) {
+        descr.remove_prefix(prefix.size());
+        break;
+      }
+    }
+    if (descr == (isAtomQuery ? "AtomNull" : "BondNull")) {
+      node.type = QueryNode::Type::True;
+      return addNode(node);
+    }
+    bool supported = false;
+    if constexpr (isAtomQuery) {
+      if (auto it = atomFeatures.find(descr); it != atomFeatures.end()) {
+        node.feature = static_cast<std::uint8_t>(it->second);
+        supported = true;
+      }
+    } else {
+      if (auto it = bondFeatures.find(descr); it != bondFeatures.end()) {
+        node.feature = static_cast<std::uint8_t>(it->second);
+        supported = true;
+      }
+    }
+    if (supported) {
+      supported = setComparison(q, node);
+    }
+    if (!supported) {
+      throw ValueErrorException(
+          "query not supported for CompactMol substructure searches: " +
+          q->getDescription());
+    }
+    return addNode(node);
+  }
+
+ private:
+  std::uint32_t addNode(const QueryNode &node) {
+    d_query.d_nodes.push_back(node);
+    return d_query.d_nodes.size() - 1;
+  }
+
+  template <class TargetPtr>
+  static bool setComparison(const Queries::Query<int, TargetPtr, true> *q,
+                            QueryNode &node) {
+    const auto &type = typeid(*q);
+    if (type == typeid(Queries::RangeQuery<int, TargetPtr, true>)) {
+      const auto rq =
+          static_cast<const Queries::RangeQuery<int, TargetPtr, true> *>(q);
+      node.type = QueryNode::Type::Range;
+      node.val = rq->getLower();
+      node.upper = rq->getUpper();
+      node.tol = rq->getTol();
+      std::tie(node.lowerOpen, node.upperOpen) = rq->getEndsOpen();
+      return true;
+    }
+    if (type == typeid(Queries::EqualityQuery<int, TargetPtr, true>)) {
+      node.type = QueryNode::Type::Equal;
+    } else if (type == typeid(Queries::GreaterQuery<int, TargetPtr, true>)) {
+      node.type = QueryNode::Type::Greater;
+    } else if (type ==
+               typeid(Queries::GreaterEqualQuery<int, TargetPtr, true>)) {
+      node.type = QueryNode::Type::GreaterEqual;
+    } else if (type == typeid(Queries::LessQuery<int, TargetPtr, true>)) {
+      node.type = QueryNode::Type::Less;
+    } else if (type == typeid(Queries::LessEqualQuery<int, TargetPtr, true>)) {
+      node.type = QueryNode::Type::LessEqual;
+    } else {
+      return false;
+    }
+    // all of the single value comparisons derive from EqualityQuery
+    const auto eq =
+        static_cast<const Queries::EqualityQuery<int, TargetPtr, true> *>(q);
+    node.val = eq->getVal();
+    node.tol = eq->getTol();
+    return true;
+  }
+
+  std::uint32_t addRecursiveQuery(const RecursiveStructureQuery *rsq) {
+    // recursive queries with the same serial number are the same, so they
+    // share their results
+    const auto serialNumber = rsq->getSerialNumber();
+    if (serialNumber) {
+      if (auto it = d_serialNumbers.find(serialNumber);
+          it != d_serialNumbers.end()) {
+        return it->second;
+      }
+    }
+    std::shared_ptr<const CompactMolQuery> recursiveQuery;
+    if (rsq->getQueryMol()) {
+      recursiveQuery = std::make_shared<CompactMolQuery>(*rsq->getQueryMol());
+    }
+    const std::uint32_t res = d_query.d_recursiveQueries.size();
+    d_query.d_recursiveQueries.push_back(std::move(recursiveQuery));
+    if (serialNumber) {
+      d_serialNumbers[serialNumber] = res;
+    }
+    return res;
+  }
+
+  CompactMolQuery &d_query;
+  std::unordered_map<unsigned int, std::uint32_t> d_serialNumbers;
+};
+
+CompactMolQuery::CompactMolQuery(const ROMol &query) {
+  initGraph(query.getNumAtoms(), query.getNumBonds());
+  d_nbrOffsets[0] = 0;
+  Builder builder(*this);
+  for (const auto atom : query.atoms()) {
+    const auto idx = atom->getIdx();
+    d_chiralTags[idx] = static_cast<std::uint8_t>(atom->getChiralTag());
+    if (atom->hasQuery()) {
+      d_atomQueries[idx] = builder.addQuery(atom->getQuery());
+    } else {
+      d_atomQueries[idx] = builder.addPlainAtom(
+          {atom->getAtomicNum(), atom->getFormalCharge(), atom->getIsotope(),
+           atom->getNumRadicalElectrons()});
+    }
+    auto pos = d_nbrOffsets[idx];
+    for (const auto bond : query.atomBonds(atom)) {
+      d_nbrAtoms[pos] = bond->getOtherAtomIdx(idx);
+      d_nbrBonds[pos] = bond->getIdx();
+      ++pos;
+    }
+    d_nbrOffsets[idx + 1] = pos;
+  }
+  for (const auto bond : query.bonds()) {
+    const auto idx = bond->getIdx();
+    d_beginAtoms[idx] = bond->getBeginAtomIdx();
+    d_endAtoms[idx] = bond->getEndAtomIdx();
+    d_bondTypes[idx] = static_cast<std::uint8_t>(bond->getBondType());
+    d_bondStereos[idx] = static_cast<std::uint8_t>(bond->getStereo());
+    const auto &stereoAtoms = bond->getStereoAtoms();
+    if (stereoAtoms.size() == 2) {
+      d_stereoAtoms[2 * idx] = stereoAtoms[0];
+      d_stereoAtoms[2 * idx + 1] = stereoAtoms[1];
+    }
+    if (bond->hasQuery()) {
+      d_bondQueries[idx] = builder.addQuery(bond->getQuery());
+    } else {
+      d_bondQueries[idx] =
+          builder.addPlainBond({bond->getBondType(), bond->getIsConjugated()});
+    }
+  }
+}
+
+CompactMolQuery::CompactMolQuery(const CompactMol &query) {
+  initGraph(query.getNumAtoms(), query.getNumBonds());
+  d_nbrOffsets[0] = 0;
+  Builder builder(*this);
+  for (unsigned int idx = 0; idx < d_numAtoms; ++idx) {
+    d_chiralTags[idx] = static_cast<std::uint8_t>(query.getChiralTag(idx));
+    d_atomQueries[idx] = builder.addPlainAtom(
+        {query.getAtomicNum(idx), query.getFormalCharge(idx),
+         query.getIsotope(idx), query.getNumRadicalElectrons(idx)});
+    const auto nbrs = query.getAtomNeighbors(idx);
+    const auto bonds = query.getAtomBonds(idx);
+    std::copy(nbrs.begin(), nbrs.end(),
+              d_nbrAtoms.begin() + d_nbrOffsets[idx]);
+    std::copy(bonds.begin(), bonds.end(),
+              d_nbrBonds.begin() + d_nbrOffsets[idx]);
+    d_nbrOffsets[idx + 1] = d_nbrOffsets[idx] + nbrs.size();
+  }
+  for (unsigned int idx = 0; idx < d_numBonds; ++idx) {
+    d_beginAtoms[idx] = query.getBeginAtomIdx(idx);
+    d_endAtoms[idx] = query.getEndAtomIdx(idx);
+    d_bondTypes[idx] = static_cast<std::uint8_t>(query.getBondType(idx));
+    d_bondStereos[idx] = static_cast<std::uint8_t>(query.getBondStereo(idx));
+    const auto stereoAtoms = query.getBondStereoAtoms(idx);
+    std::copy(stereoAtoms.begin(), stereoAtoms.end(),
+              d_stereoAtoms.begin() + 2 * idx);
+    d_bondQueries[idx] = builder.addPlainBond(
+        {query.getBondType(idx), query.getBondIsConjugated(idx)});
+  }
+  if (query.hasPatternFingerprint()) {
+    setPatternFingerprint(query.getPatternFingerprintWords(),
+                          query.getPatternFingerprintSize());
+  }
+}
+
+void CompactMolQuery::initGraph(unsigned int numAtoms, unsigned int numBonds) {
+  d_numAtoms = numAtoms;
+  d_numBonds = numBonds;
+  d_nbrOffsets.resize(numAtoms + 1);
+  d_nbrAtoms.resize(2 * numBonds);
+  d_nbrBonds.resize(2 * numBonds);
+  d_beginAtoms.resize(numBonds);
+  d_endAtoms.resize(numBonds);
+  d_stereoAtoms.resize(2 * numBonds, noStereoAtom);
+  d_chiralTags.resize(numAtoms);
+  d_bondTypes.resize(numBonds);
+  d_bondStereos.resize(numBonds);
+  d_atomQueries.resize(numAtoms);
+  d_bondQueries.resize(numBonds);
+}
+
+void CompactMolQuery::setPatternFingerprint(std::vector<std::uint64_t> words,
+                                            unsigned int numBits) {
+  if (words.size() != (numBits + 63) / 64) {
+    throw ValueErrorException("bad pattern fingerprint size");
+  }
+  d_patternFp = std::move(words);
+  d_patternFpSize = numBits;
+}
+
+// a straightforward backtracking search. The query atoms are visited in
+// breadth first order so that, apart from the first atom of each fragment,
+// the candidates for each query atom are the neighbors of the atom its
+// parent was mapped to.
+class CompactMolQuery::Matcher {
+ public:
+  //! the results of the recursive queries for each atom of the molecule,
+  //! these are filled in as they are needed: -1 means not done yet
+  using RecursiveResults =
+      std::unordered_map<const CompactMolQuery *, std::vector<std::int8_t>>;
+
+  //! if \c anchor is not negative, the first query atom is only matched to
+  //! that atom
+  Matcher(const CompactMol &mol, const CompactMolQuery &query,
+          const SubstructMatchParameters &params,
+          RecursiveResults &recursiveResults, int anchor = -1)
+      : d_mol(mol),
+        d_query(query),
+        d_params(params),
+        d_recursiveResults(recursiveResults),
+        d_anchor(anchor),
+        d_queryMap(query.getNumAtoms(), -1),
+        d_molUsed(mol.getNumAtoms(), false) {
+    const auto nQueryAtoms = query.getNumAtoms();
+    std::vector<bool> visited(nQueryAtoms, false);
+    d_order.reserve(nQueryAtoms);
+    d_parents.reserve(nQueryAtoms);
+    for (unsigned int root = 0; root < nQueryAtoms; ++root) {
+      if (visited[root]) {
+        continue;
+      }
+      visited[root] = true;
+      auto first = d_order.size();
+      d_order.push_back(root);
+      d_parents.push_back(-1);
+      while (first < d_order.size()) {
+        const auto current = d_order[first++];
+        for (auto nbr : query.getAtomNeighbors(current)) {
+          if (!visited[nbr]) {
+            visited[nbr] = true;
+            d_order.push_back(nbr);
+            d_parents.push_back(current);
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<MatchVectType> run() {
+    const auto nQueryAtoms = d_query.getNumAtoms();
+    if (nQueryAtoms && nQueryAtoms <= d_mol.getNumAtoms() &&
+        d_params.maxMatches) {
+      search(0);
+    }
+    return std::move(d_matches);
+  }
+
+ private:
+  // this mirrors Atom::Match()
+  bool plainAtomMatches(const PlainAtom &qAtom, unsigned int mIdx) const {
+    if (qAtom.atomicNum != d_mol.getAtomicNum(mIdx)) {
+      return false;
+    }
+    const auto mIsotope = d_mol.getIsotope(mIdx);
+    if (!qAtom.atomicNum) {
+      // dummies only need to match isotopes
+      return !qAtom.isotope || !mIsotope || qAtom.isotope == mIsotope;
+    }
+    if (qAtom.formalCharge &&
+        qAtom.formalCharge != d_mol.getFormalCharge(mIdx)) {
+      return false;
+    }
+    if (qAtom.isotope && qAtom.isotope != mIsotope) {
+      return false;
+    }
+    if (qAtom.numRadicalElectrons &&
+        qAtom.numRadicalElectrons != d_mol.getNumRadicalElectrons(mIdx)) {
+      return false;
+    }
+    return true;
+  }
+
+  // this mirrors bondCompat() for bonds without queries
+  bool plainBondMatches(const PlainBond &qBond, unsigned int mIdx) const {
+    const auto qType = qBond.bondType;
+    const auto mType = d_mol.getBondType(mIdx);
+    auto isSingleOrDouble = [](Bond::BondType bt) {
+      return bt == Bond::SINGLE || bt == Bond::DOUBLE;
+    };
+    if (qType == Bond::AROMATIC && mType == Bond::AROMATIC &&
+        (d_params.aromaticMatchesConjugated ||
+         d_params.aromaticMatchesSingleOrDouble)) {
+      return true;
+    } else if (d_params.aromaticMatchesConjugated &&
+               ((qType == Bond::AROMATIC && isSingleOrDouble(mType) &&
+                 d_mol.getBondIsConjugated(mIdx)) ||
+                (mType == Bond::AROMATIC && isSingleOrDouble(qType) &&
+                 qBond.isConjugated))) {
+      return true;
+    } else if (d_params.aromaticMatchesSingleOrDouble &&
+               ((qType == Bond::AROMATIC && isSingleOrDouble(mType)) ||
+                (mType == Bond::AROMATIC && isSingleOrDouble(qType)))) {
+      return true;
+    }
+    return qType == Bond::UNSPECIFIED || mType == Bond::UNSPECIFIED ||
+           qType == mType;
+  }
+
+  static bool compare(const QueryNode &node, int val) {
+    switch (node.type) {
+      case QueryNode::Type::Equal:
+        return Queries::queryCmp(node.val, val, node.tol) == 0;
+      case QueryNode::Type::Greater:
+        return Queries::queryCmp(node.val, val, node.tol) > 0;
+      case QueryNode::Type::GreaterEqual:
+        return Queries::queryCmp(node.val, val, node.tol) >= 0;
+      case QueryNode::Type::Less:
+        return Queries::queryCmp(node.val, val, node.tol) < 0;
+      case QueryNode::Type::LessEqual:
+        return Queries::queryCmp(node.val, val, node.tol) <= 0;
+      case QueryNode::Type::Range: {
+        const auto lCmp = Queries::queryCmp(node.val, val, node.tol);
+        const auto uCmp = Queries::queryCmp(node.upper, val, node.tol);
+        return (node.lowerOpen ? lCmp < 0 : lCmp <= 0) &&
+               (node.upperOpen ? uCmp > 0 : uCmp >= 0);
+      }
+      default:
+        return false;
+    }
+  }
+
+  // returns whether or not the query node matches atom (or bond) idx
+  bool nodeMatches(std::uint32_t nodeIdx, unsigned int idx,
+                   bool isAtom) const {
+    const auto &node = d_query.d_nodes[nodeIdx];
+    bool res;
+    switch (node.type) {
+      case QueryNode::Type::And:
+        res = std::all_of(d_query.d_children.begin() + node.begin,
+                          d_query.d_children.begin() + node.end,
+                          [&](std::uint32_t child) {
+                            return nodeMatches(child, idx, isAtom);
+                          });
+        break;
+      case QueryNode::Type::Or:
+        res = std::any_of(d_query.d_children.begin() + node.begin,
+                          d_query.d_children.begin() + node.end,
+                          [&](std::uint32_t child) {
+                            return nodeMatches(child, idx, isAtom);
+                          });
+        break;
+      case QueryNode::Type::Xor:
+        // as in XOrQuery, this is true if exactly one child matches
+        res = false;
+        for (auto i = node.begin; i < node.end; ++i) {
+          if (nodeMatches(d_query.d_children[i], idx, isAtom)) {
+            if (res) {
+              res = false;
+              break;
+            }
+            res = true;
+          }
+        }
+        break;
+      case QueryNode::Type::True:
+        res = true;
+        break;
+      case QueryNode::Type::PlainAtom:
+        res = plainAtomMatches(d_query.d_plainAtoms[node.begin], idx);
+        break;
+      case QueryNode::Type::PlainBond:
+        res = plainBondMatches(d_query.d_plainBonds[node.begin], idx);
+        break;
+      case QueryNode::Type::Recursive:
+        res = recursiveQueryMatches(node.begin, idx);
+        break;
+      default:
+        if (isAtom) {
+          res = compare(node, getAtomFeature(
+                                  static_cast<AtomFeature>(node.feature),
+                                  d_mol, idx));
+        } else {
+          res = compare(node, getBondFeature(
+                                  static_cast<BondFeature>(node.feature),
+                                  d_mol, idx));
+        }
+        break;
+    }
+    return res != node.negated;
+  }
+
+  bool recursiveQueryMatches(std::uint32_t which, unsigned int mIdx) const {
+    const auto &recursiveQuery = d_query.d_recursiveQueries[which];
+    if (!recursiveQuery) {
+      return false;
+    }
+    // the map's nodes stay put when other queries are added to it
+    auto &results = d_recursiveResults[recursiveQuery.get()];
+    if (results.empty()) {
+      results.resize(d_mol.getNumAtoms(), -1);
+    }
+    if (results[mIdx] < 0) {
+      auto params = d_params;
+      params.maxMatches = 1;
+      params.uniquify = false;
+      Matcher matcher(d_mol, *recursiveQuery, params, d_recursiveResults,
+                      mIdx);
+      results[mIdx] = !matcher.run().empty();
+    }
+    return results[mIdx];
+  }
+
+  bool atomMatches(unsigned int qIdx, unsigned int mIdx) const {
+    return nodeMatches(d_query.d_atomQueries[qIdx], mIdx, true);
+  }
+
+  bool bondMatches(unsigned int qIdx, unsigned int mIdx) const {
+    if (!nodeMatches(d_query.d_bondQueries[qIdx], mIdx, false)) {
+      return false;
+    }
+    if (d_query.getBondType(qIdx) == Bond::DATIVE &&
+        d_mol.getBondType(mIdx) == Bond::DATIVE) {
+      // for dative bonds the direction also needs to match
+      return atomMatches(d_query.getBeginAtomIdx(qIdx),
+                         d_mol.getBeginAtomIdx(mIdx)) &&
+             atomMatches(d_query.getEndAtomIdx(qIdx),
+                         d_mol.getEndAtomIdx(mIdx));
+    }
+    return true;
+  }
+
+  // returns false when the search should stop
+  bool search(unsigned int depth) {
+    if (depth == d_order.size()) {
+      return addMatch();
+    }
+    const auto qIdx = d_order[depth];
+    if (d_parents[depth] < 0) {
+      if (!depth && d_anchor >= 0) {
+        return tryAtom(depth, qIdx, d_anchor);
+      }
+      for (unsigned int mIdx = 0; mIdx < d_mol.getNumAtoms(); ++mIdx) {
+        if (!tryAtom(depth, qIdx, mIdx)) {
+          return false;
+        }
+      }
+    } else {
+      const auto parentIdx = d_queryMap[d_parents[depth]];
+      for (auto mIdx : d_mol.getAtomNeighbors(parentIdx)) {
+        if (!tryAtom(depth, qIdx, mIdx)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool tryAtom(unsigned int depth, unsigned int qIdx, unsigned int mIdx) {
+    if (d_molUsed[mIdx] || d_query.getDegree(qIdx) > d_mol.getDegree(mIdx) ||
+        !atomMatches(qIdx, mIdx)) {
+      return true;
+    }
+    // as in the ROMol matcher, unspecified stereo is rejected right away
+    // and the stereo itself is checked once a match is complete
+    if (d_params.useChirality &&
+        !d_params.specifiedStereoQueryMatchesUnspecified &&
+        hasChiralLabel(d_query, qIdx) && !hasChiralLabel(d_mol, mIdx)) {
+      return true;
+    }
+    // every query bond to an atom which has already been mapped needs a
+    // matching bond in the molecule
+    const auto qNbrs = d_query.getAtomNeighbors(qIdx);
+    const auto qBonds = d_query.getAtomBonds(qIdx);
+    for (unsigned int i = 0; i < qNbrs.size(); ++i) {
+      const auto mNbr = d_queryMap[qNbrs[i]];
+      if (mNbr < 0) {
+        continue;
+      }
+      const auto mBond = d_mol.getBondBetweenAtoms(mIdx, mNbr);
+      if (mBond < 0 || !bondMatches(qBonds[i], mBond)) {
+        return true;
+      }
+      if (d_params.useChirality &&
+          !d_params.specifiedStereoQueryMatchesUnspecified &&
+          hasSpecifiedDoubleBondStereo(d_query, qBonds[i]) &&
+          d_mol.getBondType(mBond) == Bond::DOUBLE &&
+          d_mol.getBondStereo(mBond) <= Bond::STEREOANY) {
+        return true;
+      }
+    }
+    d_queryMap[qIdx] = mIdx;
+    d_molUsed[mIdx] = true;
+    const bool keepGoing = search(depth + 1);
+    d_queryMap[qIdx] = -1;
+    d_molUsed[mIdx] = false;
+    return keepGoing;
+  }
+
+  // this mirrors the chirality checks in MolMatchFinalCheckFunctor
+  bool atomStereoMatches() const {
+    for (unsigned int qIdx = 0; qIdx < d_query.getNumAtoms(); ++qIdx) {
+      // with less than 3 neighbors we can't establish CW/CCW parity
+      if (d_query.getDegree(qIdx) < 3 || !hasChiralLabel(d_query, qIdx)) {
+        continue;
+      }
+      const auto mIdx = d_queryMap[qIdx];
+      if (!hasChiralLabel(d_mol, mIdx)) {
+        if (d_params.specifiedStereoQueryMatchesUnspecified) {
+          continue;
+        }
+        return false;
+      }
+      // the query bonds are taken in their stored order, so the query
+      // permutation is even. mOrder has the corresponding molecule bonds.
+      std::list<int> mOrder;
+      for (auto qNbr : d_query.getAtomNeighbors(qIdx)) {
+        mOrder.push_back(d_mol.getBondBetweenAtoms(mIdx, d_queryMap[qNbr]));
+      }
+      mOrder.insert(mOrder.end(), d_mol.getDegree(mIdx) - mOrder.size(), -1);
+      std::list<int> moOrder;
+      for (auto mBond : d_mol.getAtomBonds(mIdx)) {
+        const int bondIdx = mBond;
+        moOrder.push_back(
+            std::find(mOrder.begin(), mOrder.end(), bondIdx) != mOrder.end()
+                ? bondIdx
+                : -1);
+      }
+      const bool requireMatch =
+          countSwapsToInterconvert(moOrder, mOrder) % 2 == 0;
+      const bool labelsMatch =
+          d_query.getChiralTag(qIdx) == d_mol.getChiralTag(mIdx);
+      if (requireMatch != labelsMatch) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool bondStereoMatches() const {
+    for (unsigned int qBond = 0; qBond < d_query.getNumBonds(); ++qBond) {
+      if (!hasSpecifiedDoubleBondStereo(d_query, qBond)) {
+        continue;
+      }
+      const auto qStereoAtoms = d_query.getBondStereoAtoms(qBond);
+      if (qStereoAtoms.size() != 2) {
+        continue;
+      }
+      const auto mBegin = d_queryMap[d_query.getBeginAtomIdx(qBond)];
+      const auto mBond = d_mol.getBondBetweenAtoms(
+          mBegin, d_queryMap[d_query.getEndAtomIdx(qBond)]);
+      if (d_mol.getBondType(mBond) != Bond::DOUBLE) {
+        continue;
+      }
+      if (!d_params.specifiedStereoQueryMatchesUnspecified &&
+          d_mol.getBondStereo(mBond) <= Bond::STEREOANY) {
+        return false;
+      }
+      const auto mStereoAtoms = d_mol.getBondStereoAtoms(mBond);
+      if (mStereoAtoms.size() != 2) {
+        continue;
+      }
+      // the stereo atoms are given in the order of the bond's atoms
+      const bool sameDirection =
+          static_cast<unsigned int>(mBegin) == d_mol.getBeginAtomIdx(mBond);
+      unsigned int totalMatches = 0;
+      for (unsigned int i = 0; i < 2; ++i) {
+        if (static_cast<unsigned int>(d_queryMap[qStereoAtoms[i]]) ==
+            mStereoAtoms[sameDirection ? i : 1 - i]) {
+          ++totalMatches;
+        }
+      }
+      const auto mStereo =
+          Chirality::translateEZLabelToCisTrans(d_mol.getBondStereo(mBond));
+      const auto qStereo =
+          Chirality::translateEZLabelToCisTrans(d_query.getBondStereo(qBond));
+      if ((mStereo == qStereo) == (totalMatches == 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool addMatch() {
+    std::vector<int> atoms;
+    if (d_params.uniquify) {
+      atoms = d_queryMap;
+      std::sort(atoms.begin(), atoms.end());
+      if (d_seen.find(atoms) != d_seen.end()) {
+        return true;
+      }
+    }
+    if (d_params.useChirality &&
+        (!atomStereoMatches() || !bondStereoMatches())) {
+      return true;
+    }
+    if (d_params.uniquify) {
+      d_seen.insert(std::move(atoms));
+    }
+    MatchVectType match;
+    match.reserve(d_queryMap.size());
+    for (unsigned int i = 0; i < d_queryMap.size(); ++i) {
+      match.emplace_back(i, d_queryMap[i]);
+    }
+    d_matches.push_back(std::move(match));
+    return d_matches.size() < d_params.maxMatches;
+  }
+
+  const CompactMol &d_mol;
+  const CompactMolQuery &d_query;
+  const SubstructMatchParameters &d_params;
+  RecursiveResults &d_recursiveResults;
+  int d_anchor;
+  std::vector<unsigned int> d_order;
+  std::vector<int> d_parents;
+  std::vector<int> d_queryMap;
+  std::vector<bool> d_molUsed;
+  std::set<std::vector<int>> d_seen;
+  std::vector<MatchVectType> d_matches;
+};
+
+std::vector<MatchVectType> SubstructMatch(
+    const CompactMol &mol, const CompactMolQuery &query,
+    const SubstructMatchParameters &params) {
+  // these need information which CompactMols don't have
+  if (params.useEnhancedStereo || params.useGenericMatchers ||
+      !params.atomProperties.empty() || !params.bondProperties.empty() ||
+      params.extraFinalCheck || params.extraAtomCheck ||
+      params.extraBondCheck) {
+    throw ValueErrorException(
+        "unsupported substructure match parameters for CompactMol");
+  }
+  if (!passesPatternFingerprint(mol, query)) {
+    return {};
+  }
+  CompactMolQuery::Matcher::RecursiveResults recursiveResults;
+  CompactMolQuery::Matcher matcher(mol, query, params, recursiveResults);
+  return matcher.run();
+}
+
+std::vector<MatchVectType> SubstructMatch(
+    const CompactMol &mol, const CompactMol &query,
+    const SubstructMatchParameters &params) {
+  return SubstructMatch(mol, CompactMolQuery(query), params);
+}
+
+std::vector<MatchVectType> SubstructMatch(
+    const CompactMol &mol, const ROMol &query,
+    const SubstructMatchParameters &params) {
+  return SubstructMatch(mol, CompactMolQuery(query), params);
+}
+
+}  // namespace RDKit
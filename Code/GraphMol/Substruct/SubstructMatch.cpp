@@ -124,7 +124,7 @@ typedef struct {
 void MatchSubqueries(const ROMol &mol, QueryAtom::QUERYATOM_QUERY *q,
                      const SubstructMatchParameters &params,
                      SUBQUERY_MAP &subqueryMap,
-                     std::vector<RecursiveStructureQuery *> &locked);
+                     RecursiveQueryResults &recursiveResults);
 
 bool insertIfNeeded(std::set<MatchVectType> &matches, const MatchVectType &m) {
   bool shouldInsert = true;
@@ -456,24 +456,6 @@ void ResSubstructMatchHelper_(const ResSubstructMatchHelperArgs_ &args,
   }
 };
 
-struct RecursiveLocker {
-  std::vector<RecursiveStructureQuery *> locked;
-  RecursiveLocker(const ROMol &query, const bool recursionPossible) {
-    if (recursionPossible) {
-      locked.reserve(query.getNumAtoms());
-    }
-  }
-
-  ~RecursiveLocker() {
-    for (auto v : locked) {
-      v->clear();
-#ifdef RDK_BUILD_THREADSAFE_SSS
-      v->d_mutex.unlock();
-#endif
-    }
-  }
-};
-
 // A minimal container which satisfies the vf2_all() output-sequence interface
 // but only counts matches instead of storing them.
 struct MatchCounter {
@@ -506,16 +488,18 @@ std::vector<MatchVectType> SubstructMatch(
     return matches;
   }
 
-  detail::RecursiveLocker locker(query, params.recursionPossible);
+  QueryOps::updateCompiledMolQueries(query);
+
+  // the results of recursive queries live here rather than in the query, so
+  // that the query can be used by several threads at once
+  detail::RecursiveQueryResults recursiveResults;
 
   if (params.recursionPossible) {
     detail::SUBQUERY_MAP subqueryMap;
-    ROMol::ConstAtomIterator atIt;
     for (const auto atom : query.atoms()) {
       if (atom->hasQuery()) {
-        // std::cerr<<"recurse from atom "<<(*atIt)->getIdx()<<std::endl;
         detail::MatchSubqueries(mol, atom->getQuery(), params, subqueryMap,
-                                locker.locked);
+                                recursiveResults);
       }
     }
   }
@@ -548,14 +532,16 @@ unsigned int SubstructMatchCount(const ROMol &mol, const ROMol &query,
     return 0;
   }
 
-  detail::RecursiveLocker locker(query, params.recursionPossible);
+  QueryOps::updateCompiledMolQueries(query);
+
+  detail::RecursiveQueryResults recursiveResults;
 
   if (params.recursionPossible) {
     detail::SUBQUERY_MAP subqueryMap;
     for (const auto atom : query.atoms()) {
       if (atom->hasQuery()) {
         detail::MatchSubqueries(mol, atom->getQuery(), params, subqueryMap,
-                                locker.locked);
+                                recursiveResults);
       }
     }
   }
@@ -656,13 +642,15 @@ unsigned int RecursiveMatcher(const ROMol &mol, const ROMol &query,
                               std::vector<int> &matches,
                               SUBQUERY_MAP &subqueryMap,
                               const SubstructMatchParameters &params,
-                              std::vector<RecursiveStructureQuery *> &locked) {
+                              RecursiveQueryResults &recursiveResults) {
   SubstructMatchParameters lparams = params;
   lparams.maxMatches = std::max(params.maxRecursiveMatches, params.maxMatches);
   lparams.uniquify = false;
+  QueryOps::updateCompiledMolQueries(query);
   for (auto qAtom : query.atoms()) {
     if (qAtom->hasQuery()) {
-      MatchSubqueries(mol, qAtom->getQuery(), lparams, subqueryMap, locked);
+      MatchSubqueries(mol, qAtom->getQuery(), lparams, subqueryMap,
+                      recursiveResults);
     }
   }
 
@@ -711,42 +699,39 @@ unsigned int RecursiveMatcher(const ROMol &mol, const ROMol &query,
 void MatchSubqueries(const ROMol &mol, QueryAtom::QUERYATOM_QUERY *query,
                      const SubstructMatchParameters &params,
                      SUBQUERY_MAP &subqueryMap,
-                     std::vector<RecursiveStructureQuery *> &locked) {
+                     RecursiveQueryResults &recursiveResults) {
   PRECONDITION(query, "bad query");
   if (query->getDescription() == "RecursiveStructure") {
     auto *rsq = (RecursiveStructureQuery *)query;
-#ifdef RDK_BUILD_THREADSAFE_SSS
-    rsq->d_mutex.lock();
-#endif
-    locked.push_back(rsq);
-    rsq->clear();
     bool matchDone = false;
     if (rsq->getSerialNumber() &&
         subqueryMap.find(rsq->getSerialNumber()) != subqueryMap.end()) {
       // we've matched an equivalent serial number before, just
       // copy in the matches:
-      matchDone = true;
       auto orsq =
           (const RecursiveStructureQuery *)subqueryMap[rsq->getSerialNumber()];
-      for (auto setIter = orsq->beginSet(); setIter != orsq->endSet();
-           ++setIter) {
-        rsq->insert(*setIter);
+      if (auto matches = recursiveResults.getMatches(orsq)) {
+        auto matchesCopy = *matches;
+        recursiveResults.setMatches(rsq, std::move(matchesCopy));
+        matchDone = true;
       }
     }
 
     if (!matchDone) {
+      boost::dynamic_bitset<> matches(mol.getNumAtoms());
       ROMol const *queryMol = rsq->getQueryMol();
-      // in case we are reusing this query, clear its contents now.
       if (queryMol) {
         std::vector<int> matchStarts;
         unsigned int res = RecursiveMatcher(mol, *queryMol, matchStarts,
-                                            subqueryMap, params, locked);
+                                            subqueryMap, params,
+                                            recursiveResults);
         if (res) {
           for (int &matchStart : matchStarts) {
-            rsq->insert(matchStart);
+            matches.set(matchStart);
           }
         }
       }
+      recursiveResults.setMatches(rsq, std::move(matches));
       if (rsq->getSerialNumber()) {
         subqueryMap[rsq->getSerialNumber()] = query;
       }
@@ -756,7 +741,8 @@ void MatchSubqueries(const ROMol &mol, QueryAtom::QUERYATOM_QUERY *query,
   // now recurse over our children (these things can be nested)
   for (auto childIt = query->beginChildren(); childIt != query->endChildren();
        ++childIt) {
-    MatchSubqueries(mol, childIt->get(), params, subqueryMap, locked);
+    MatchSubqueries(mol, childIt->get(), params, subqueryMap,
+                    recursiveResults);
   }
   // std::cout << "<<- back " << (int)query << std::endl;
 }
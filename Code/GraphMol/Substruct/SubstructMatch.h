@@ -34,6 +34,8 @@ class Atom;
 class Bond;
 class ResonanceMolSupplier;
 class MolBundle;
+class CompactMol;
+class CompactMolQuery;
 
 //! \brief used to return matches from substructure searching,
 //!   The format is (queryAtomIdx, molAtomIdx)
@@ -147,6 +149,44 @@ RDKIT_SUBSTRUCTMATCH_EXPORT std::vector<MatchVectType> SubstructMatch(
     const MolBundle &bundle, const MolBundle &query,
     const SubstructMatchParameters &params = SubstructMatchParameters());
 
+//! Find all substructure matches for a query in a CompactMol
+/*!
+    The query's atom and bond queries are evaluated directly on the
+    CompactMol's data, see CompactMolQuery for the supported query
+    features. When the molecule and the query both have pattern
+    fingerprints of the same size these are used to screen the molecule
+    before searching.
+
+    The supported options are uniquify, maxMatches, useChirality,
+    specifiedStereoQueryMatchesUnspecified, aromaticMatchesConjugated and
+    aromaticMatchesSingleOrDouble; the others are ignored, apart from
+    useEnhancedStereo, useGenericMatchers, atom and bond properties and the
+    extra checks, which need information CompactMols don't have and cause a
+    ValueErrorException.
+
+    \param mol         The CompactMol to be searched
+    \param query       The query
+    \param matchParams Parameters controlling the matching
+
+    \return The matches, if any
+
+*/
+RDKIT_SUBSTRUCTMATCH_EXPORT std::vector<MatchVectType> SubstructMatch(
+    const CompactMol &mol, const CompactMolQuery &query,
+    const SubstructMatchParameters &params = SubstructMatchParameters());
+//! \overload
+/*!
+    The query is converted to a CompactMolQuery, create that once when the
+    same query is used for many molecules.
+*/
+RDKIT_SUBSTRUCTMATCH_EXPORT std::vector<MatchVectType> SubstructMatch(
+    const CompactMol &mol, const ROMol &query,
+    const SubstructMatchParameters &params = SubstructMatchParameters());
+//! \overload
+RDKIT_SUBSTRUCTMATCH_EXPORT std::vector<MatchVectType> SubstructMatch(
+    const CompactMol &mol, const CompactMol &query,
+    const SubstructMatchParameters &params = SubstructMatchParameters());
+
 //! Find a substructure match for a query
 /*!
     \param mol       The object to be searched
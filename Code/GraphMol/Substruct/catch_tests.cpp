@@ -12,10 +12,12 @@
 
 #include <catch2/catch_all.hpp>
 
+#include <set>
 #include <tuple>
 #include <utility>
 
 #ifdef RDK_TEST_MULTITHREADED
+#include <atomic>
 #include <csignal>
 #include <thread>
 #include <chrono>
@@ -25,6 +27,8 @@
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #include <GraphMol/SmilesParse/SmilesWrite.h>
 #include <GraphMol/Substruct/SubstructMatch.h>
+#include <GraphMol/CompactMol.h>
+#include <GraphMol/Substruct/CompactMolQuery.h>
 #include <GraphMol/FileParsers/FileParsers.h>
 #include <GraphMol/QueryOps.h>
 #include <GraphMol/MolPickler.h>
@@ -1244,3 +1248,353 @@ M  END
   interruptThread.join();
 }
 #endif
+
+TEST_CASE("substructure matching with CompactMols") {
+  const std::vector<std::string> molSmis = {
+      "c1ccccc1CC(=O)O", "C1CCC1C(=O)[O-]", "OC(=O)c1ccncc1[13CH3]",
+      "[CH2]CC=O",       "N->[Pt]",         "C1=CC=CC=C1",
+      "c1ccc2ccccc2c1",  "[2H]OC(=O)CC*"};
+  const std::vector<std::string> querySmis = {
+      "C=O", "CC(=O)O", "c1ccccc1", "C(=O)[O-]", "[13CH3]", "[CH2]C",
+      "CC.O", "N->[Pt]", "[Pt]<-N", "C:C", "*C", "[2H]O", "C1CCC1"};
+  for (const auto &molSmi : molSmis) {
+    auto mol = v2::SmilesParse::MolFromSmiles(molSmi);
+    REQUIRE(mol);
+    CompactMol cmol(*mol);
+    for (const auto &querySmi : querySmis) {
+      v2::SmilesParse::SmilesParserParams ps;
+      ps.sanitize = false;
+      auto query = v2::SmilesParse::MolFromSmiles(querySmi, ps);
+      REQUIRE(query);
+      query->updatePropertyCache(false);
+      CompactMol cquery(*query);
+      for (auto uniquify : {true, false}) {
+        for (auto aromaticMatchesConjugated : {false, true}) {
+          SubstructMatchParameters params;
+          params.uniquify = uniquify;
+          params.aromaticMatchesConjugated = aromaticMatchesConjugated;
+          auto expected = SubstructMatch(*mol, *query, params);
+          auto matches = SubstructMatch(cmol, cquery, params);
+          INFO(molSmi << " " << querySmi << " " << uniquify << " "
+                      << aromaticMatchesConjugated);
+          REQUIRE(matches.size() == expected.size());
+          if (uniquify) {
+            // the same sets of atoms are matched, but not necessarily
+            // in the same way
+            auto atomSets = [](const std::vector<MatchVectType> &ms) {
+              std::set<std::vector<int>> res;
+              for (const auto &m : ms) {
+                std::vector<int> atoms;
+                for (const auto &pr : m) {
+                  atoms.push_back(pr.second);
+                }
+                std::sort(atoms.begin(), atoms.end());
+                res.insert(atoms);
+              }
+              return res;
+            };
+            CHECK(atomSets(matches) == atomSets(expected));
+          } else {
+            std::sort(matches.begin(), matches.end());
+            std::sort(expected.begin(), expected.end());
+            CHECK(matches == expected);
+          }
+        }
+      }
+    }
+  }
+  SECTION("maxMatches") {
+    auto mol = "c1ccccc1"_smiles;
+    REQUIRE(mol);
+    CompactMol cmol(*mol);
+    SubstructMatchParameters params;
+    params.uniquify = false;
+    params.maxMatches = 5;
+    CHECK(SubstructMatch(cmol, cmol, params).size() == 5);
+    params.maxMatches = 1000;
+    CHECK(SubstructMatch(cmol, cmol, params).size() == 12);
+  }
+  SECTION("chirality") {
+    const std::vector<std::string> chiralMolSmis = {
+        "C[C@H](F)Cl",        "C[C@@H](F)Cl",      "CC(F)Cl",
+        "F[C@](Cl)(Br)CO",    "OC[C@@](Cl)(F)Br",  "C[C@H]1CC[C@@H](O)CC1",
+        "C/C=C/C(=O)O",       "C/C=C\\C(=O)O",     "CC=CC(=O)O",
+        "F/C=C/C=C\\Cl",      "O=C(O)/C(C)=C/Cl"};
+    const std::vector<std::string> chiralQuerySmis = {
+        "[C@H](F)Cl",  "[C@@H](F)Cl", "C[C@H](F)Cl", "F[C@@](Cl)Br",
+        "C/C=C/C",     "C/C=C\\C",    "C=CC(=O)O",   "F/C=C/C",
+        "[C@@H]1CCCC1", "Cl/C=C/C"};
+    for (const auto &molSmi : chiralMolSmis) {
+      auto mol = v2::SmilesParse::MolFromSmiles(molSmi);
+      REQUIRE(mol);
+      CompactMol cmol(*mol);
+      for (const auto &querySmi : chiralQuerySmis) {
+        v2::SmilesParse::SmilesParserParams ps;
+        ps.sanitize = false;
+        auto query = v2::SmilesParse::MolFromSmiles(querySmi, ps);
+        REQUIRE(query);
+        query->updatePropertyCache(false);
+        MolOps::setBondStereoFromDirections(*query);
+        CompactMol cquery(*query);
+        for (auto unspecified : {false, true}) {
+          SubstructMatchParameters params;
+          params.useChirality = true;
+          params.specifiedStereoQueryMatchesUnspecified = unspecified;
+          params.uniquify = false;
+          auto expected = SubstructMatch(*mol, *query, params);
+          auto matches = SubstructMatch(cmol, cquery, params);
+          INFO(molSmi << " " << querySmi << " " << unspecified);
+          std::sort(matches.begin(), matches.end());
+          std::sort(expected.begin(), expected.end());
+          CHECK(matches == expected);
+        }
+      }
+    }
+  }
+  SECTION("SMARTS queries") {
+    const std::vector<std::string> smartsMolSmis = {
+        "c1ccccc1CC(=O)O", "OC(=O)c1ccncc1[13CH3]", "C1CCC1C(=O)[O-]",
+        "[2H]OC(=O)CC*",   "CC(C)(C)N[CH2]",        "c1ccc2ccccc2c1",
+        "C/C=C/C(=O)O",    "[NH4+].[Cl-]",          "N->[Pt]"};
+    const std::vector<std::string> smartsQueries = {
+        "[#6]~[#8]",        "[C;R]",           "[c,n]:c",
+        "[!#6;!#1]",        "[C;H2,H3]",        "[$(C=O)]O",
+        "[$([OH]C=O),$([O-]C=O)]", "[$(*~[$(c1ccccc1)])]", "[D3]",
+        "[X4]",             "[+]",             "[-1]",
+        "[#7;+0]",          "[13C]",           "[2H]",
+        "[a]",              "[A;!R]",          "[R;!$(C=O)]",
+        "[R2]",             "[x2]",            "[z1]",
+        "[Z2]",             "[D{2-3}]",        "[D{-2}]",
+        "[C^3]",            "C=,#C",           "C-,:c",
+        "*@*",              "*!@*",            "[C,N;!$(*=*)]~*",
+        "C/C=C/C",          "[#6]~*~*~*",      "N->[Pt]",
+        "[C,N]~[$(O);!$(O=*)]", "[CH2;H2]",   "[C,c;X3,X4]",
+        "[!R0;H1]",         "[x;!x3]"};
+    for (const auto &molSmi : smartsMolSmis) {
+      auto mol = v2::SmilesParse::MolFromSmiles(molSmi);
+      REQUIRE(mol);
+      CompactMol cmol(*mol);
+      for (const auto &sma : smartsQueries) {
+        auto query = v2::SmilesParse::MolFromSmarts(sma);
+        REQUIRE(query);
+        CompactMolQuery cquery(*query);
+        for (auto uniquify : {true, false}) {
+          SubstructMatchParameters params;
+          params.uniquify = uniquify;
+          auto expected = SubstructMatch(*mol, *query, params);
+          auto matches = SubstructMatch(cmol, cquery, params);
+          INFO(molSmi << " " << sma << " " << uniquify);
+          REQUIRE(matches.size() == expected.size());
+          if (!uniquify) {
+            std::sort(matches.begin(), matches.end());
+            std::sort(expected.begin(), expected.end());
+            CHECK(matches == expected);
+          }
+        }
+      }
+    }
+    // queries which need information CompactMols don't have
+    for (const auto sma : {"[r5]", "[v4]", "[h1]", "C!@;-C", "[C;$(C)&r6]"}) {
+      auto query = v2::SmilesParse::MolFromSmarts(sma);
+      REQUIRE(query);
+      INFO(sma);
+      bool supported = true;
+      try {
+        CompactMolQuery cquery(*query);
+      } catch (const ValueErrorException &) {
+        supported = false;
+      }
+      // "!@;-" has only supported features
+      CHECK(supported == (std::string(sma) == "C!@;-C"));
+    }
+  }
+  SECTION("pattern fingerprint screening") {
+    auto mol = "c1ccccc1CC(=O)O"_smiles;
+    REQUIRE(mol);
+    CompactMol cmol(*mol);
+    CompactMol cquery(*"CC(=O)O"_smiles);
+    // the fingerprints aren't real pattern fingerprints here, only the
+    // bits matter for the screen
+    cmol.setPatternFingerprint({0b0110, 0x1}, 65);
+    cquery.setPatternFingerprint({0b0100, 0x1}, 65);
+    CHECK(SubstructMatch(cmol, cquery).size() == 1);
+    CompactMolQuery screened(cquery);
+    REQUIRE(screened.hasPatternFingerprint());
+    screened.setPatternFingerprint({0b1000, 0x0}, 65);
+    CHECK(SubstructMatch(cmol, screened).empty());
+    // fingerprints of different sizes are ignored
+    screened.setPatternFingerprint({0b1000}, 64);
+    CHECK(SubstructMatch(cmol, screened).size() == 1);
+    CHECK_THROWS_AS(screened.setPatternFingerprint({0b1000}, 65),
+                    ValueErrorException);
+  }
+  SECTION("unsupported options") {
+    auto mol = "C[C@H](F)Cl"_smiles;
+    REQUIRE(mol);
+    CompactMol cmol(*mol);
+    SubstructMatchParameters params;
+    params.useEnhancedStereo = true;
+    CHECK_THROWS_AS(SubstructMatch(cmol, cmol, params), ValueErrorException);
+    params.useEnhancedStereo = false;
+    params.atomProperties.push_back("foo");
+    CHECK_THROWS_AS(SubstructMatch(cmol, cmol, params), ValueErrorException);
+  }
+}
+
+TEST_CASE("recursive queries do not store state in the query") {
+  std::vector<std::string> smarts = {
+      "[$(C=O);!$(C-N)]",          "[$([OH]),$([NH2])]~*",
+      "[$(C[$(O[CH3])])]",         "[$(C=O)]~*~[$(C=O)]",
+      "[$(c1ccccc1);!$(c[OH])]~*", "[!$([#6]);$(*~[#6](=O))]"};
+  std::vector<std::string> smiles = {
+      "CC(=O)O",           "NCC(=O)N",   "COc1ccccc1O", "O=C(C)CC(=O)C",
+      "OCCN",              "c1ccccc1CO", "CCOC(=O)C",   "OC(=O)C(=O)O",
+      "c1ccc(O)cc1C(=O)N", "CCCCCC"};
+  std::vector<std::unique_ptr<RWMol>> queries;
+  for (const auto &sma : smarts) {
+    queries.emplace_back(SmartsToMol(sma));
+    REQUIRE(queries.back());
+  }
+  std::vector<std::unique_ptr<RWMol>> mols;
+  for (const auto &smi : smiles) {
+    mols.emplace_back(SmilesToMol(smi));
+    REQUIRE(mols.back());
+  }
+  SubstructMatchParameters ps;
+  ps.uniquify = false;
+  std::vector<std::vector<MatchVectType>> expected;
+  for (const auto &query : queries) {
+    for (const auto &mol : mols) {
+      expected.push_back(SubstructMatch(*mol, *query, ps));
+    }
+  }
+  CHECK(SubstructMatch(*mols[0], *queries[0], ps).size() == 1);
+  CHECK(SubstructMatch(*mols[1], *queries[0], ps).empty());
+  CHECK(SubstructMatch(*mols[3], *queries[3], ps).size() == 2);
+  CHECK(SubstructMatch(*mols[2], *queries[2], ps).size() == 1);
+
+  SECTION("nothing is left in the query") {
+    for (const auto &query : queries) {
+      for (const auto atom : query->atoms()) {
+        std::vector<const Atom::QUERYATOM_QUERY *> stack{atom->getQuery()};
+        while (!stack.empty()) {
+          auto qry = stack.back();
+          stack.pop_back();
+          if (qry->getDescription() == "RecursiveStructure") {
+            CHECK(static_cast<const RecursiveStructureQuery *>(qry)->size() ==
+                  0);
+          }
+          for (auto child = qry->beginChildren(); child != qry->endChildren();
+               ++child) {
+            stack.push_back(child->get());
+          }
+        }
+      }
+    }
+  }
+  SECTION("nested searches") {
+    // a search started while another search using the same query is in
+    // progress on the same thread does not disturb the outer search
+    SubstructMatchParameters nps = ps;
+    unsigned int nCalls = 0;
+    nps.extraFinalCheck = [&](const ROMol &, std::span<const unsigned int>) {
+      ++nCalls;
+      CHECK(SubstructMatch(*mols[0], *queries[0], ps).size() == 1);
+      return true;
+    };
+    CHECK(SubstructMatch(*mols[3], *queries[3], nps) == expected[3 * 10 + 3]);
+    CHECK(nCalls > 0);
+  }
+#ifdef RDK_TEST_MULTITHREADED
+  SECTION("sharing queries between threads") {
+    std::vector<std::thread> threads;
+    std::atomic<unsigned int> nMismatches{0};
+    for (unsigned int i = 0; i < 8; ++i) {
+      threads.emplace_back([&]() {
+        for (unsigned int iter = 0; iter < 50; ++iter) {
+          for (unsigned int qi = 0; qi < queries.size(); ++qi) {
+            for (unsigned int mi = 0; mi < mols.size(); ++mi) {
+              if (SubstructMatch(*mols[mi], *queries[qi], ps) !=
+                  expected[qi * mols.size() + mi]) {
+                ++nMismatches;
+              }
+            }
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    CHECK(nMismatches == 0);
+  }
+#endif
+}
+
+TEST_CASE("substructure searches with compiled queries") {
+  const std::vector<std::string> smartsList = {
+      "[CX3](=O)[OX2H1]",
+      "[#6]-!@[#7;!$(N-C=O)]",
+      "c1ccc2[nH]ccc2c1",
+      "[$([NH2]-c),$([NH1](-c)-C)]",
+      "[C;R2;r5,r6]",
+      "[!#1;!#6]~[!#1;!#6]",
+      "[C@@H](N)C(=O)O",
+      "[#6;a]:[#6;a]-,=[#6,#7]",
+  };
+  const std::vector<std::string> smilesList = {
+      "CC(=O)Nc1ccc(O)cc1",
+      "N[C@@H](Cc1c[nH]c2ccccc12)C(=O)O",
+      "C1CC2CCC1CC2",
+      "CNc1ccccc1C(=O)O",
+      "O=[N+]([O-])c1ccc(NN)cc1",
+  };
+  SubstructMatchParameters ps;
+  ps.useChirality = true;
+  ps.uniquify = false;
+  for (const auto &smarts : smartsList) {
+    INFO(smarts);
+    auto query = v2::SmilesParse::MolFromSmarts(smarts);
+    REQUIRE(query);
+    ROMol compiled(*query);
+    QueryOps::compileMolQueries(compiled);
+    for (const auto &smiles : smilesList) {
+      INFO(smiles);
+      auto mol = v2::SmilesParse::MolFromSmiles(smiles);
+      REQUIRE(mol);
+      CHECK(SubstructMatch(*mol, compiled, ps) ==
+            SubstructMatch(*mol, *query, ps));
+    }
+  }
+}
+
+TEST_CASE("compiled queries modified in place") {
+  auto mol = "OCC(=O)NC"_smiles;
+  REQUIRE(mol);
+  auto query = "[C;$(C=O)]-[N,O]"_smarts;
+  REQUIRE(query);
+  QueryOps::compileMolQueries(*query);
+  CHECK(SubstructMatch(*mol, *query).size() == 1);
+
+  // the search picks up modifications of the atom and bond queries
+  auto qatom = static_cast<QueryAtom *>(query->getAtomWithIdx(0));
+  qatom->getQuery()->setNegation(true);
+  CHECK(!qatom->getCompiledQuery()->isCurrent());
+  CHECK(SubstructMatch(*mol, *query).size() == 2);
+  CHECK(qatom->getCompiledQuery()->isCurrent());
+  qatom->getQuery()->setNegation(false);
+  auto qbond = static_cast<QueryBond *>(query->getBondWithIdx(0));
+  qbond->getQuery()->setNegation(true);
+  auto matches = SubstructMatch(*mol, *query);
+  REQUIRE(matches.size() == 1);
+  CHECK(matches[0][1].second == 3);
+  qbond->getQuery()->setNegation(false);
+  CHECK(SubstructMatch(*mol, *query).size() == 1);
+
+  // and those of the atoms in recursive queries
+  const auto rsq = static_cast<const RecursiveStructureQuery *>(
+      std::prev(qatom->getQuery()->endChildren())->get());
+  REQUIRE(typeid(*rsq) == typeid(RecursiveStructureQuery));
+  rsq->getQueryMol()->getAtomWithIdx(1)->getQuery()->setNegation(true);
+  CHECK(SubstructMatch(*mol, *query).empty());
+}
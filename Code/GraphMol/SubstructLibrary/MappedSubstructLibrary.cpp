@@ -0,0 +1,520 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include "MappedSubstructLibrary.h"
+
+#include <RDGeneral/BadFileException.h>
+#include <DataStructs/PackedBitOps.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace RDKit {
+
+namespace {
+constexpr char mappedLibraryMagic[8] = {'R', 'D', 'K', 'S', 'S', 'L', 'I', 'B'};
+constexpr std::uint32_t mappedLibraryVersion = 1;
+constexpr std::uint32_t endianMarker = 0x01020304;
+constexpr std::uint64_t columnAlignment = 64;
+
+// the file starts with this, all positions are byte offsets from the
+// start of the file
+struct MappedLibraryHeader {
+  char magic[8];
+  std::uint32_t endianMarker;
+  std::uint32_t version;
+  std::uint64_t numMols;
+  std::uint32_t molFormat;
+  std::uint32_t fpType;
+  std::uint32_t numFpBits;
+  std::uint32_t reserved1;
+  std::uint64_t molDataPos;
+  std::uint64_t molDataSize;
+  std::uint64_t molOffsetsPos;
+  std::uint64_t fpPos;
+  std::uint64_t keyDataPos;
+  std::uint64_t keyDataSize;
+  std::uint64_t keyOffsetsPos;  // zero if there are no keys
+  std::uint64_t searchOrderPos;
+  std::uint64_t searchOrderSize;
+  std::uint64_t reserved2[2];
+};
+static_assert(sizeof(MappedLibraryHeader) == 128,
+              "unexpected size of MappedLibraryHeader");
+
+
+void writePadding(std::ostream &os) {
+  static const char zeros[columnAlignment] = {0};
+  auto pos = static_cast<std::uint64_t>(os.tellp());
+  if (pos % columnAlignment) {
+    os.write(zeros, columnAlignment - pos % columnAlignment);
+  }
+}
+
+template <typename T>
+void writeColumn(std::ostream &os, const std::vector<T> &column) {
+  if (!column.empty()) {
+    os.write(reinterpret_cast<const char *>(column.data()),
+             column.size() * sizeof(T));
+  }
+}
+
+// writes a blob of strings and returns their offsets into the blob
+template <typename GetEntry>
+std::vector<std::uint64_t> writeStrings(std::ostream &os, unsigned int count,
+                                        GetEntry getEntry) {
+  std::vector<std::uint64_t> offsets;
+  offsets.reserve(count + 1);
+  std::uint64_t offset = 0;
+  offsets.push_back(offset);
+  for (unsigned int i = 0; i < count; ++i) {
+    const std::string entry = getEntry(i);
+    os.write(entry.data(), entry.size());
+    offset += entry.size();
+    offsets.push_back(offset);
+  }
+  return offsets;
+}
+
+template <typename T>
+const T *columnPtr(const MemoryMappedFileReader &map, std::uint64_t pos,
+                   std::uint64_t count, const char *what) {
+  if (pos % alignof(T) || pos > map.d_size ||
+      count > (map.d_size - pos) / sizeof(T)) {
+    throw BadFileException(std::string("bad ") + what +
+                           " column in mapped library");
+  }
+  return reinterpret_cast<const T *>(map.d_mappedMemory + pos);
+}
+
+std::string_view getEntry(const char *data, const std::uint64_t *offsets,
+                          std::uint64_t dataSize, unsigned int idx) {
+  const auto start = offsets[idx];
+  const auto end = offsets[idx + 1];
+  // the offsets are not validated when the file is opened, since that would
+  // mean touching the whole column
+  if (end < start || end > dataSize) {
+    throw BadFileException("bad offsets in mapped library");
+  }
+  return std::string_view(data + start, end - start);
+}
+
+void addWords(const ExplicitBitVect &fp, std::vector<std::uint64_t> &words) {
+  auto start = words.size();
+  words.resize(start + PackedBitOps::getNumWords(fp.getNumBits()));
+  PackedBitOps::packBitVect(fp, &words[start]);
+}
+}  // namespace
+
+MappedLibraryFile::MappedLibraryFile(const std::string &fileName)
+    : d_fileName(fileName), d_map(fileName) {
+  if (d_map.d_size < sizeof(MappedLibraryHeader)) {
+    throw BadFileException(fileName + " is not a mapped library");
+  }
+  MappedLibraryHeader header;
+  std::memcpy(&header, d_map.d_mappedMemory, sizeof(header));
+  if (std::memcmp(header.magic, mappedLibraryMagic, sizeof(header.magic))) {
+    throw BadFileException(fileName + " is not a mapped library");
+  }
+  if (header.endianMarker != endianMarker) {
+    throw BadFileException(fileName +
+                           " was written on a machine with different "
+                           "endianness");
+  }
+  if (header.version > mappedLibraryVersion) {
+    throw BadFileException(fileName +
+                           " was written by a newer version of the RDKit");
+  }
+  if (header.numMols >= std::numeric_limits<unsigned int>::max()) {
+    throw BadFileException("too many molecules in " + fileName);
+  }
+  if (header.molFormat > static_cast<std::uint32_t>(MolFormat::Pickle) ||
+      header.fpType >
+          static_cast<std::uint32_t>(FingerprintType::TautomerPattern)) {
+    throw BadFileException("bad header in mapped library " + fileName);
+  }
+  d_numMols = static_cast<unsigned int>(header.numMols);
+  d_molFormat = static_cast<MolFormat>(header.molFormat);
+  d_fpType = static_cast<FingerprintType>(header.fpType);
+
+  d_molData =
+      columnPtr<char>(d_map, header.molDataPos, header.molDataSize, "molecule");
+  d_molOffsets = columnPtr<std::uint64_t>(d_map, header.molOffsetsPos,
+                                          header.numMols + 1, "molecule");
+  d_molDataSize = header.molDataSize;
+
+  if (d_fpType != FingerprintType::None) {
+    d_numFpBits = header.numFpBits;
+    d_numFpWords = PackedBitOps::getNumWords(d_numFpBits);
+    d_fps = columnPtr<std::uint64_t>(d_map, header.fpPos,
+                                     header.numMols * d_numFpWords,
+                                     "fingerprint");
+  }
+  if (header.keyOffsetsPos) {
+    d_keyData =
+        columnPtr<char>(d_map, header.keyDataPos, header.keyDataSize, "key");
+    d_keyOffsets = columnPtr<std::uint64_t>(d_map, header.keyOffsetsPos,
+                                            header.numMols + 1, "key");
+    d_keyDataSize = header.keyDataSize;
+  }
+  if (header.searchOrderSize) {
+    d_searchOrder =
+        columnPtr<std::uint32_t>(d_map, header.searchOrderPos,
+                                 header.searchOrderSize, "search order");
+    d_searchOrderSize = header.searchOrderSize;
+  }
+}
+
+std::string_view MappedLibraryFile::getMolEntry(unsigned int idx) const {
+  if (idx >= d_numMols) {
+    throw IndexErrorException(idx);
+  }
+  return getEntry(d_molData, d_molOffsets, d_molDataSize, idx);
+}
+
+std::string_view MappedLibraryFile::getKey(unsigned int idx) const {
+  PRECONDITION(d_keyOffsets, "no keys in mapped library");
+  if (idx >= d_numMols) {
+    throw IndexErrorException(idx);
+  }
+  return getEntry(d_keyData, d_keyOffsets, d_keyDataSize, idx);
+}
+
+const std::uint64_t *MappedLibraryFile::getFingerprintWords(
+    unsigned int idx) const {
+  PRECONDITION(d_fps, "no fingerprints in mapped library");
+  if (idx >= d_numMols) {
+    throw IndexErrorException(idx);
+  }
+  return d_fps + static_cast<std::uint64_t>(idx) * d_numFpWords;
+}
+
+bool MappedLibraryFile::passesFilter(unsigned int idx,
+                                     const ExplicitBitVect &query) const {
+  PRECONDITION(query.getNumBits() == d_numFpBits,
+               "query fingerprint has the wrong size");
+  const auto *words = getFingerprintWords(idx);
+  // query fingerprints are sparse, so it's cheaper to check their on bits
+  // than to convert them to words
+  for (auto bit = query.dp_bits->find_first();
+       bit != boost::dynamic_bitset<>::npos;
+       bit = query.dp_bits->find_next(bit)) {
+    if (!((words[bit / 64] >> (bit % 64)) & 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void MappedLibraryFile::bulkPassesFilter(const ExplicitBitVect &query,
+                                         unsigned int firstIdx,
+                                         unsigned int stride,
+                                         unsigned int count,
+                                         std::uint64_t *result) const {
+  PRECONDITION(query.getNumBits() == d_numFpBits,
+               "query fingerprint has the wrong size");
+  PRECONDITION(stride > 0, "bad stride");
+  PRECONDITION(result, "no result");
+  if (!count) {
+    return;
+  }
+  const auto lastIdx =
+      firstIdx + static_cast<std::uint64_t>(count - 1) * stride;
+  if (lastIdx >= d_numMols) {
+    throw IndexErrorException(static_cast<int>(lastIdx));
+  }
+  const auto probe = PackedBitOps::packBitVect(query);
+  PackedBitOps::bulkAllProbeBitsMatch(
+      probe.data(), getFingerprintWords(firstIdx), d_numFpWords,
+      static_cast<std::size_t>(stride) * d_numFpWords, count, result);
+}
+
+void MappedLibraryFile::bulkPassesFilterIndices(const ExplicitBitVect &query,
+                                                const unsigned int *indices,
+                                                unsigned int count,
+                                                std::uint64_t *result) const {
+  PRECONDITION(query.getNumBits() == d_numFpBits,
+               "query fingerprint has the wrong size");
+  PRECONDITION(result, "no result");
+  PRECONDITION(indices || !count, "no indices");
+  PRECONDITION(d_fps, "no fingerprints in mapped library");
+  for (unsigned int i = 0; i < count; ++i) {
+    if (indices[i] >= d_numMols) {
+      throw IndexErrorException(indices[i]);
+    }
+  }
+  const auto probe = PackedBitOps::packBitVect(query);
+  PackedBitOps::bulkAllProbeBitsMatch(probe.data(), d_fps, d_numFpWords,
+                                      d_numFpWords, indices, count, result);
+}
+
+std::vector<unsigned int> MappedLibraryFile::getSearchOrder() const {
+  return std::vector<unsigned int>(d_searchOrder,
+                                   d_searchOrder + d_searchOrderSize);
+}
+
+unsigned int MappedMolHolder::addMol(const ROMol &) {
+  throw ValueErrorException("mapped molecules cannot be modified");
+}
+
+boost::shared_ptr<ROMol> MappedMolHolder::getMol(unsigned int idx) const {
+  if (idx >= size()) {
+    throw IndexErrorException(idx);
+  }
+  const auto entry = d_file->getMolEntry(idx);
+  if (entry.empty()) {
+    return boost::shared_ptr<ROMol>();
+  }
+  switch (d_file->getMolFormat()) {
+    case MappedLibraryFile::MolFormat::TrustedSmiles: {
+      RWMol *m = SmilesToMol(std::string(entry), 0, false);
+      if (m) {
+        m->updatePropertyCache();
+      }
+      return boost::shared_ptr<ROMol>(m);
+    }
+    case MappedLibraryFile::MolFormat::Smiles:
+      return boost::shared_ptr<ROMol>(SmilesToMol(std::string(entry)));
+    case MappedLibraryFile::MolFormat::Pickle: {
+      boost::shared_ptr<ROMol> mol(new ROMol);
+      MolPickler::molFromPickle(std::string(entry), mol.get());
+      return mol;
+    }
+  }
+  return boost::shared_ptr<ROMol>();
+}
+
+unsigned int MappedKeyHolder::addMol(const ROMol &) {
+  throw ValueErrorException("mapped keys cannot be modified");
+}
+
+unsigned int MappedKeyHolder::addKey(const std::string &) {
+  throw ValueErrorException("mapped keys cannot be modified");
+}
+
+MappedKeyHolder::MappedKeyHolder(
+    boost::shared_ptr<const MappedLibraryFile> file)
+    : KeyHolderBase(), d_file(std::move(file)) {
+  PRECONDITION(d_file && d_file->hasKeys(), "no keys in file");
+  d_keys.reset(new std::atomic<const std::string *>[d_file->size()]);
+  for (unsigned int i = 0; i < d_file->size(); ++i) {
+    d_keys[i] = nullptr;
+  }
+}
+
+MappedKeyHolder::~MappedKeyHolder() {
+  for (unsigned int i = 0; i < d_file->size(); ++i) {
+    delete d_keys[i].load();
+  }
+}
+
+const std::string &MappedKeyHolder::getKey(unsigned int idx) const {
+  auto view = d_file->getKey(idx);
+  auto key = d_keys[idx].load(std::memory_order_acquire);
+  if (!key) {
+    // another thread may be doing the same, only one copy is kept
+    auto copy = std::make_unique<std::string>(view);
+    if (d_keys[idx].compare_exchange_strong(key, copy.get(),
+                                            std::memory_order_acq_rel)) {
+      key = copy.release();
+    }
+  }
+  return *key;
+}
+
+std::vector<std::string> MappedKeyHolder::getKeys(
+    const std::vector<unsigned int> &indices) const {
+  std::vector<std::string> res;
+  res.reserve(indices.size());
+  for (auto idx : indices) {
+    res.emplace_back(d_file->getKey(idx));
+  }
+  return res;
+}
+
+void writeMappedSubstructLibrary(const SubstructLibrary &lib,
+                                 const std::string &fileName) {
+  const auto &molHolder = lib.getMolHolder();
+  const auto &fpHolder = lib.getFpHolder();
+  const auto &keyHolder = lib.getKeyHolder();
+  const auto numMols = lib.size();
+  if (fpHolder && fpHolder->size() != numMols) {
+    throw ValueErrorException("#mols different than #fingerprints");
+  }
+  if (keyHolder && keyHolder->size() != numMols) {
+    throw ValueErrorException("#mols different than #keys");
+  }
+
+  MappedLibraryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, mappedLibraryMagic, sizeof(header.magic));
+  header.endianMarker = endianMarker;
+  header.version = mappedLibraryVersion;
+  header.numMols = numMols;
+
+  std::ofstream os(fileName, std::ios_base::binary | std::ios_base::out);
+  if (!os || os.bad()) {
+    throw BadFileException("could not open " + fileName + " for writing");
+  }
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  // molecules
+  writePadding(os);
+  header.molDataPos = os.tellp();
+  std::vector<std::uint64_t> offsets;
+  const auto *mappedMols = dynamic_cast<const MappedMolHolder *>(
+      molHolder.get());
+  if (const auto *tsmiHolder =
+          dynamic_cast<const CachedTrustedSmilesMolHolder *>(
+              molHolder.get())) {
+    header.molFormat =
+        static_cast<std::uint32_t>(MappedLibraryFile::MolFormat::TrustedSmiles);
+    offsets = writeStrings(os, numMols, [tsmiHolder](unsigned int i) {
+      return tsmiHolder->getMols()[i];
+    });
+  } else if (const auto *smiHolder =
+                 dynamic_cast<const CachedSmilesMolHolder *>(
+                     molHolder.get())) {
+    header.molFormat =
+        static_cast<std::uint32_t>(MappedLibraryFile::MolFormat::Smiles);
+    offsets = writeStrings(os, numMols, [smiHolder](unsigned int i) {
+      return smiHolder->getMols()[i];
+    });
+  } else if (const auto *pklHolder =
+                 dynamic_cast<const CachedMolHolder *>(molHolder.get())) {
+    header.molFormat =
+        static_cast<std::uint32_t>(MappedLibraryFile::MolFormat::Pickle);
+    offsets = writeStrings(os, numMols, [pklHolder](unsigned int i) {
+      return pklHolder->getMols()[i];
+    });
+  } else if (mappedMols) {
+    header.molFormat =
+        static_cast<std::uint32_t>(mappedMols->getFile().getMolFormat());
+    offsets = writeStrings(os, numMols, [mappedMols](unsigned int i) {
+      return std::string(mappedMols->getFile().getMolEntry(i));
+    });
+  } else {
+    header.molFormat =
+        static_cast<std::uint32_t>(MappedLibraryFile::MolFormat::Pickle);
+    offsets = writeStrings(os, numMols, [&molHolder](unsigned int i) {
+      std::string pkl;
+      auto mol = molHolder->getMol(i);
+      if (mol) {
+        MolPickler::pickleMol(*mol, pkl);
+      }
+      return pkl;
+    });
+  }
+  header.molDataSize = offsets.back();
+  writePadding(os);
+  header.molOffsetsPos = os.tellp();
+  writeColumn(os, offsets);
+
+  // fingerprints
+  if (fpHolder) {
+    const auto *patternHolder =
+        dynamic_cast<const PatternHolder *>(fpHolder.get());
+    if (!patternHolder) {
+      throw ValueErrorException(
+          "only pattern fingerprints can be written to a mapped library");
+    }
+    header.fpType = static_cast<std::uint32_t>(
+        dynamic_cast<const TautomerPatternHolder *>(fpHolder.get())
+            ? MappedLibraryFile::FingerprintType::TautomerPattern
+            : MappedLibraryFile::FingerprintType::Pattern);
+    header.numFpBits = patternHolder->getNumBits();
+    const MappedLibraryFile *mappedFps = nullptr;
+    if (const auto *mph =
+            dynamic_cast<const MappedPatternHolder *>(fpHolder.get())) {
+      mappedFps = &mph->getFile();
+    } else if (const auto *mtph =
+                   dynamic_cast<const MappedTautomerPatternHolder *>(
+                       fpHolder.get())) {
+      mappedFps = &mtph->getFile();
+    }
+    writePadding(os);
+    header.fpPos = os.tellp();
+    const auto nWords = PackedBitOps::getNumWords(header.numFpBits);
+    std::vector<std::uint64_t> words;
+    words.reserve(nWords);
+    for (unsigned int i = 0; i < numMols; ++i) {
+      words.clear();
+      if (mappedFps) {
+        const auto *fpWords = mappedFps->getFingerprintWords(i);
+        words.insert(words.end(), fpWords, fpWords + nWords);
+      } else {
+        const auto &fp = fpHolder->getFingerprint(i);
+        if (fp.getNumBits() != header.numFpBits) {
+          throw ValueErrorException("fingerprint has the wrong size");
+        }
+        addWords(fp, words);
+      }
+      writeColumn(os, words);
+    }
+  }
+
+  // keys
+  if (keyHolder) {
+    writePadding(os);
+    header.keyDataPos = os.tellp();
+    offsets = writeStrings(os, numMols, [&keyHolder](unsigned int i) {
+      return keyHolder->getKey(i);
+    });
+    header.keyDataSize = offsets.back();
+    writePadding(os);
+    header.keyOffsetsPos = os.tellp();
+    writeColumn(os, offsets);
+  }
+
+  // search order
+  const auto &searchOrder = lib.getSearchOrder();
+  if (!searchOrder.empty()) {
+    writePadding(os);
+    header.searchOrderPos = os.tellp();
+    header.searchOrderSize = searchOrder.size();
+    std::vector<std::uint32_t> order(searchOrder.begin(), searchOrder.end());
+    writeColumn(os, order);
+  }
+
+  os.seekp(0);
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  if (!os) {
+    throw BadFileException("error writing " + fileName);
+  }
+}
+
+SubstructLibrary openMappedSubstructLibrary(const std::string &fileName) {
+  auto file = boost::make_shared<const MappedLibraryFile>(fileName);
+  boost::shared_ptr<MolHolderBase> mols(new MappedMolHolder(file));
+  boost::shared_ptr<FPHolderBase> fps;
+  switch (file->getFingerprintType()) {
+    case MappedLibraryFile::FingerprintType::Pattern:
+      fps.reset(new MappedPatternHolder(file));
+      break;
+    case MappedLibraryFile::FingerprintType::TautomerPattern:
+      fps.reset(new MappedTautomerPatternHolder(file));
+      break;
+    case MappedLibraryFile::FingerprintType::None:
+      break;
+  }
+  boost::shared_ptr<KeyHolderBase> keys;
+  if (file->hasKeys()) {
+    keys.reset(new MappedKeyHolder(file));
+  }
+  SubstructLibrary lib(mols, fps, keys);
+  const auto searchOrder = file->getSearchOrder();
+  if (!searchOrder.empty()) {
+    lib.setSearchOrder(searchOrder);
+  }
+  return lib;
+}
+
+}  // namespace RDKit
@@ -0,0 +1,361 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#ifndef RDK_MAPPED_SUBSTRUCT_LIBRARY
+#define RDK_MAPPED_SUBSTRUCT_LIBRARY
+
+#include <RDGeneral/export.h>
+#include <RDGeneral/MemoryMappedFileReader.h>
+#include <GraphMol/SubstructLibrary/SubstructLibrary.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RDKit {
+
+//! A SubstructLibrary file that has been memory mapped read-only
+/*!
+  The file stores the molecules, the pattern fingerprints and the keys of a
+  SubstructLibrary in separate contiguous columns:
+
+    - molecules: a blob of SMILES or binary pickles plus a column of
+      64-bit offsets into it
+    - fingerprints: one row of 64-bit words per molecule
+    - keys: a blob of strings plus a column of 64-bit offsets into it
+    - search order: a column of 32-bit molecule indices
+
+  Each column starts on a 64 byte boundary.  The data are used directly
+  from the mapping, so opening a file is independent of its size and
+  processes which open the same file share one copy of it in the page
+  cache.
+
+  Files are created with writeMappedSubstructLibrary() and are normally
+  used through openMappedSubstructLibrary().
+*/
+class RDKIT_SUBSTRUCTLIBRARY_EXPORT MappedLibraryFile {
+ public:
+  //! how the molecules are stored in the file
+  enum class MolFormat : std::uint32_t {
+    TrustedSmiles = 0,  //!< SMILES generated by the RDKit
+    Smiles = 1,         //!< arbitrary SMILES, sanitized when read
+    Pickle = 2          //!< binary molecule pickles
+  };
+  //! the fingerprints stored in the file
+  enum class FingerprintType : std::uint32_t {
+    None = 0,
+    Pattern = 1,         //!< fingerprints from a PatternHolder
+    TautomerPattern = 2  //!< fingerprints from a TautomerPatternHolder
+  };
+
+  //! maps the file, throws a BadFileException if it is not valid
+  explicit MappedLibraryFile(const std::string &fileName);
+  //! returns the name of the file that was mapped
+  const std::string &getFileName() const { return d_fileName; }
+  MappedLibraryFile(const MappedLibraryFile &) = delete;
+  MappedLibraryFile &operator=(const MappedLibraryFile &) = delete;
+
+  //! returns the number of molecules in the file
+  unsigned int size() const { return d_numMols; }
+  MolFormat getMolFormat() const { return d_molFormat; }
+  FingerprintType getFingerprintType() const { return d_fpType; }
+  unsigned int getNumFingerprintBits() const { return d_numFpBits; }
+  //! returns the number of 64-bit words in each fingerprint
+  unsigned int getNumFingerprintWords() const { return d_numFpWords; }
+  bool hasKeys() const { return d_keyOffsets != nullptr; }
+
+  //! returns the stored SMILES or pickle of a molecule
+  /*!
+    The view points into the mapping and is valid as long as this object is.
+    An empty view indicates a null molecule.
+  */
+  std::string_view getMolEntry(unsigned int idx) const;
+  //! returns the key of a molecule, the view points into the mapping
+  std::string_view getKey(unsigned int idx) const;
+  //! returns the words of the fingerprint of a molecule.
+  //!  bit \c i of the fingerprint is bit \c i%64 of word \c i/64
+  const std::uint64_t *getFingerprintWords(unsigned int idx) const;
+  //! returns false if a substructure search with the query fingerprint can
+  //! never match the molecule
+  bool passesFilter(unsigned int idx, const ExplicitBitVect &query) const;
+  //! screens a block of molecules, see FPHolderBase::bulkPassesFilter()
+  void bulkPassesFilter(const ExplicitBitVect &query, unsigned int firstIdx,
+                        unsigned int stride, unsigned int count,
+                        std::uint64_t *result) const;
+  //! screens a list of molecules, see FPHolderBase::bulkPassesFilterIndices()
+  void bulkPassesFilterIndices(const ExplicitBitVect &query,
+                               const unsigned int *indices, unsigned int count,
+                               std::uint64_t *result) const;
+  //! returns the search order stored in the file (empty if there is none)
+  std::vector<unsigned int> getSearchOrder() const;
+
+ private:
+  std::string d_fileName;
+  MemoryMappedFileReader d_map;
+  unsigned int d_numMols = 0;
+  MolFormat d_molFormat = MolFormat::Pickle;
+  FingerprintType d_fpType = FingerprintType::None;
+  unsigned int d_numFpBits = 0;
+  unsigned int d_numFpWords = 0;
+  const char *d_molData = nullptr;
+  std::uint64_t d_molDataSize = 0;
+  const std::uint64_t *d_molOffsets = nullptr;
+  const std::uint64_t *d_fps = nullptr;
+  const char *d_keyData = nullptr;
+  std::uint64_t d_keyDataSize = 0;
+  const std::uint64_t *d_keyOffsets = nullptr;
+  const std::uint32_t *d_searchOrder = nullptr;
+  std::uint64_t d_searchOrderSize = 0;
+};
+
+//! Read-only molecule holder that reads molecules from a MappedLibraryFile
+class RDKIT_SUBSTRUCTLIBRARY_EXPORT MappedMolHolder : public MolHolderBase {
+  boost::shared_ptr<const MappedLibraryFile> d_file;
+
+ public:
+  MappedMolHolder(boost::shared_ptr<const MappedLibraryFile> file)
+      : MolHolderBase(), d_file(std::move(file)) {
+    PRECONDITION(d_file, "no file");
+  }
+
+  //! throws a ValueErrorException, mapped libraries cannot be modified
+  unsigned int addMol(const ROMol &m) override;
+
+  boost::shared_ptr<ROMol> getMol(unsigned int idx) const override;
+
+  unsigned int size() const override { return d_file->size(); }
+
+  const MappedLibraryFile &getFile() const { return *d_file; }
+};
+
+//! Read-only pattern fingerprint holder that screens directly against the
+//! fingerprints in a MappedLibraryFile
+/*!
+  PatternHolderType is PatternHolder or TautomerPatternHolder, this
+  determines how query fingerprints are generated.
+
+  n.b. the fingerprints are not available as ExplicitBitVects, so
+  getFingerprint() and getFingerprints() throw a ValueErrorException. Use
+  getFile().getFingerprintWords() to access them.
+*/
+template <class PatternHolderType>
+class MappedPatternHolderT : public PatternHolderType {
+  boost::shared_ptr<const MappedLibraryFile> d_file;
+
+ public:
+  MappedPatternHolderT(boost::shared_ptr<const MappedLibraryFile> file)
+      : PatternHolderType(file->getNumFingerprintBits()),
+        d_file(std::move(file)) {}
+
+  unsigned int size() const override { return d_file->size(); }
+
+  //! throws a ValueErrorException, mapped libraries cannot be modified
+  unsigned int addMol(const ROMol &) override {
+    throw ValueErrorException("mapped fingerprints cannot be modified");
+  }
+
+  bool passesFilter(unsigned int idx,
+                    const ExplicitBitVect &query) const override {
+    if (idx >= d_file->size()) {
+      throw IndexErrorException(idx);
+    }
+    return d_file->passesFilter(idx, query);
+  }
+
+  void bulkPassesFilter(const ExplicitBitVect &query, unsigned int firstIdx,
+                        unsigned int stride, unsigned int count,
+                        std::uint64_t *result) const override {
+    d_file->bulkPassesFilter(query, firstIdx, stride, count, result);
+  }
+
+  void bulkPassesFilterIndices(const ExplicitBitVect &query,
+                               const unsigned int *indices, unsigned int count,
+                               std::uint64_t *result) const override {
+    d_file->bulkPassesFilterIndices(query, indices, count, result);
+  }
+
+  //! throws a ValueErrorException, see the class documentation
+  const ExplicitBitVect &getFingerprint(unsigned int) const override {
+    throwNoBitVects();
+  }
+  //! throws a ValueErrorException, see the class documentation
+  std::vector<ExplicitBitVect *> &getFingerprints() override {
+    throwNoBitVects();
+  }
+  //! throws a ValueErrorException, see the class documentation
+  const std::vector<ExplicitBitVect *> &getFingerprints() const override {
+    throwNoBitVects();
+  }
+
+  const MappedLibraryFile &getFile() const { return *d_file; }
+
+ private:
+  [[noreturn]] static void throwNoBitVects() {
+    throw ValueErrorException(
+        "mapped fingerprints are not available as ExplicitBitVects");
+  }
+};
+
+typedef MappedPatternHolderT<PatternHolder> MappedPatternHolder;
+typedef MappedPatternHolderT<TautomerPatternHolder>
+    MappedTautomerPatternHolder;
+
+//! Read-only key holder that reads keys from a MappedLibraryFile
+/*!
+  getKey() has to return a reference, so the keys it is asked for are copied
+  out of the mapping the first time and kept until the holder is destroyed.
+  getKeyView() and getKeys() read the mapping directly.
+*/
+class RDKIT_SUBSTRUCTLIBRARY_EXPORT MappedKeyHolder : public KeyHolderBase {
+  boost::shared_ptr<const MappedLibraryFile> d_file;
+  // the keys returned by getKey(), filled in as they are requested
+  std::unique_ptr<std::atomic<const std::string *>[]> d_keys;
+
+ public:
+  MappedKeyHolder(boost::shared_ptr<const MappedLibraryFile> file);
+  ~MappedKeyHolder() override;
+  MappedKeyHolder(const MappedKeyHolder &) = delete;
+  MappedKeyHolder &operator=(const MappedKeyHolder &) = delete;
+
+  //! throws a ValueErrorException, mapped libraries cannot be modified
+  unsigned int addMol(const ROMol &m) override;
+  //! throws a ValueErrorException, mapped libraries cannot be modified
+  unsigned int addKey(const std::string &) override;
+
+  const std::string &getKey(unsigned int idx) const override;
+  //! returns the key at the requested index without copying it
+  /*!
+    The view points into the mapping and is valid as long as the holder is.
+    Throws an IndexErrorException if \c idx is out of range.
+  */
+  std::string_view getKeyView(unsigned int idx) const {
+    return d_file->getKey(idx);
+  }
+
+  std::vector<std::string> getKeys(
+      const std::vector<unsigned int> &indices) const override;
+
+  unsigned int size() const override { return d_file->size(); }
+
+  const MappedLibraryFile &getFile() const { return *d_file; }
+};
+
+//! Writes a SubstructLibrary to a file which can be memory mapped
+/*!
+  Molecules from CachedTrustedSmilesMolHolder and CachedSmilesMolHolder are
+  stored as SMILES, all others are stored as binary pickles.  The fingerprint
+  holder, if present, must be a PatternHolder or a TautomerPatternHolder.
+
+  \param lib       the library to write
+  \param fileName  name of the output file
+*/
+RDKIT_SUBSTRUCTLIBRARY_EXPORT void writeMappedSubstructLibrary(
+    const SubstructLibrary &lib, const std::string &fileName);
+
+//! Opens a file created by writeMappedSubstructLibrary()
+/*!
+  The returned library uses MappedMolHolder, MappedPatternHolder (or
+  MappedTautomerPatternHolder) and MappedKeyHolder, which all share the
+  mapping.  The library is read-only: adding molecules throws a
+  ValueErrorException.
+
+  \param fileName  name of the file to map
+*/
+RDKIT_SUBSTRUCTLIBRARY_EXPORT SubstructLibrary
+openMappedSubstructLibrary(const std::string &fileName);
+
+}  // namespace RDKit
+
+#ifdef RDK_USE_BOOST_SERIALIZATION
+// The mapped holders are serialized as the name of their file, which is
+// mapped again when they are loaded. The file therefore needs to be
+// available under the same name wherever the library is loaded.
+namespace boost {
+namespace serialization {
+
+template <class Archive, class Holder>
+void saveMappedHolder(Archive &ar, const Holder *holder) {
+  ar << holder->getFile().getFileName();
+}
+
+template <class Archive, class Holder>
+void loadMappedHolder(Archive &ar, Holder *holder) {
+  std::string fileName;
+  ar >> fileName;
+  ::new (holder)
+      Holder(boost::make_shared<const RDKit::MappedLibraryFile>(fileName));
+}
+
+template <class Archive>
+void serialize(Archive &ar, RDKit::MappedMolHolder &holder,
+               const unsigned int) {
+  ar &boost::serialization::base_object<RDKit::MolHolderBase>(holder);
+}
+
+template <class Archive>
+void save_construct_data(Archive &ar, const RDKit::MappedMolHolder *holder,
+                         const unsigned int) {
+  saveMappedHolder(ar, holder);
+}
+
+template <class Archive>
+void load_construct_data(Archive &ar, RDKit::MappedMolHolder *holder,
+                         const unsigned int) {
+  loadMappedHolder(ar, holder);
+}
+
+template <class Archive, class PatternHolderType>
+void serialize(Archive &, RDKit::MappedPatternHolderT<PatternHolderType> &,
+               const unsigned int) {
+  // the fingerprints are in the file, so the base class, which would save
+  // them, is not serialized
+  boost::serialization::void_cast_register<
+      RDKit::MappedPatternHolderT<PatternHolderType>, RDKit::FPHolderBase>();
+}
+
+template <class Archive, class PatternHolderType>
+void save_construct_data(
+    Archive &ar, const RDKit::MappedPatternHolderT<PatternHolderType> *holder,
+    const unsigned int) {
+  saveMappedHolder(ar, holder);
+}
+
+template <class Archive, class PatternHolderType>
+void load_construct_data(
+    Archive &ar, RDKit::MappedPatternHolderT<PatternHolderType> *holder,
+    const unsigned int) {
+  loadMappedHolder(ar, holder);
+}
+
+template <class Archive>
+void serialize(Archive &ar, RDKit::MappedKeyHolder &holder,
+               const unsigned int) {
+  ar &boost::serialization::base_object<RDKit::KeyHolderBase>(holder);
+}
+
+template <class Archive>
+void save_construct_data(Archive &ar, const RDKit::MappedKeyHolder *holder,
+                         const unsigned int) {
+  saveMappedHolder(ar, holder);
+}
+
+template <class Archive>
+void load_construct_data(Archive &ar, RDKit::MappedKeyHolder *holder,
+                         const unsigned int) {
+  loadMappedHolder(ar, holder);
+}
+
+}  // namespace serialization
+}  // namespace boost
+#endif
+
+#endif
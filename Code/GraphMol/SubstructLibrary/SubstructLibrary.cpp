@@ -31,6 +31,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 #include "SubstructLibrary.h"
+#include "MappedSubstructLibrary.h"
 #include <RDGeneral/RDThreads.h>
 #ifdef RDK_BUILD_THREADSAFE_SSS
 #include <thread>
@@ -53,6 +54,91 @@ bool SubstructLibraryCanSerialize() {
 #endif
 }
 
+namespace {
+void setPassesFilterBit(std::uint64_t *result, unsigned int i, bool passes) {
+  if (passes) {
+    result[i / 64] |= std::uint64_t(1) << (i % 64);
+  }
+}
+}  // namespace
+
+const PackedBitOps::PackedFingerprints *FPHolderBase::getPackedFingerprints()
+    const {
+  std::lock_guard<std::mutex> lock(d_packedFpsMutex);
+  if (fps.empty() || !fps[0]) {
+    return nullptr;
+  }
+  if (!dp_packedFps) {
+    dp_packedFps.reset(
+        new PackedBitOps::PackedFingerprints(fps[0]->getNumBits()));
+    dp_packedFps->reserve(rdcast<unsigned int>(fps.size()));
+  }
+  // pack any fingerprints which have been added since the last call, the
+  // packed copy is only usable if they all have the same size
+  const auto numBits = dp_packedFps->getNumBits();
+  for (auto i = dp_packedFps->size(); i < fps.size(); ++i) {
+    if (!fps[i] || fps[i]->getNumBits() != numBits) {
+      return nullptr;
+    }
+    dp_packedFps->append(*fps[i]);
+  }
+  return dp_packedFps.get();
+}
+
+void FPHolderBase::bulkPassesFilter(const ExplicitBitVect &query,
+                                    unsigned int firstIdx, unsigned int stride,
+                                    unsigned int count,
+                                    std::uint64_t *result) const {
+  PRECONDITION(stride > 0, "bad stride");
+  PRECONDITION(result, "no result");
+  if (!count) {
+    return;
+  }
+  const auto lastIdx = firstIdx + static_cast<size_t>(count - 1) * stride;
+  if (lastIdx >= fps.size()) {
+    throw IndexErrorException(static_cast<int>(lastIdx));
+  }
+  const auto packedFps = getPackedFingerprints();
+  if (packedFps && packedFps->getNumBits() == query.getNumBits()) {
+    const auto probe = PackedBitOps::packBitVect(query);
+    PackedBitOps::bulkAllProbeBitsMatch(
+        probe.data(), packedFps->getRow(firstIdx), packedFps->getNumWords(),
+        static_cast<std::size_t>(stride) * packedFps->getNumWords(), count,
+        result);
+    return;
+  }
+  std::fill(result, result + (count + 63) / 64, 0);
+  for (unsigned int i = 0; i < count; ++i) {
+    setPassesFilterBit(result, i,
+                       AllProbeBitsMatch(query, *fps[firstIdx + i * stride]));
+  }
+}
+
+void FPHolderBase::bulkPassesFilterIndices(const ExplicitBitVect &query,
+                                           const unsigned int *indices,
+                                           unsigned int count,
+                                           std::uint64_t *result) const {
+  PRECONDITION(result, "no result");
+  PRECONDITION(indices || !count, "no indices");
+  for (unsigned int i = 0; i < count; ++i) {
+    if (indices[i] >= fps.size()) {
+      throw IndexErrorException(indices[i]);
+    }
+  }
+  const auto packedFps = getPackedFingerprints();
+  if (packedFps && packedFps->getNumBits() == query.getNumBits()) {
+    const auto probe = PackedBitOps::packBitVect(query);
+    PackedBitOps::bulkAllProbeBitsMatch(
+        probe.data(), packedFps->getRow(0), packedFps->getNumWords(),
+        packedFps->getNumWords(), indices, count, result);
+    return;
+  }
+  std::fill(result, result + (count + 63) / 64, 0);
+  for (unsigned int i = 0; i < count; ++i) {
+    setPassesFilterBit(result, i, AllProbeBitsMatch(query, *fps[indices[i]]));
+  }
+}
+
 struct Bits {
   const ExplicitBitVect *queryBits;
   const FPHolderBase *fps;
@@ -153,6 +239,30 @@ struct Bits {
     }
     return true;
   }
+
+  // screens molecules firstIdx + i * stride for i < count into result
+  bool screen(unsigned int firstIdx, unsigned int stride, unsigned int count,
+              std::vector<std::uint64_t> &result) const {
+    if (!fps) {
+      return false;
+    }
+    result.resize((count + 63) / 64);
+    fps->bulkPassesFilter(*queryBits, firstIdx, stride, count, result.data());
+    return true;
+  }
+
+  // screens molecules indices[i] for i < indices.size() into result
+  bool screen(const std::vector<unsigned int> &indices,
+              std::vector<std::uint64_t> &result) const {
+    if (!fps) {
+      return false;
+    }
+    result.resize((indices.size() + 63) / 64);
+    fps->bulkPassesFilterIndices(*queryBits, indices.data(),
+                                 rdcast<unsigned int>(indices.size()),
+                                 result.data());
+    return true;
+  }
 };
 
 unsigned int SubstructLibrary::addMol(const ROMol &m) {
@@ -243,12 +353,44 @@ void SubSearcher(const Query &in_query, const Bits &bits,
   // we copy the query so that we don't end up with lock contention for
   // recursive matchers when using multiple threads
   Query query(in_query);
+  // the molecules this thread handles are screened in blocks, which is
+  // much faster than screening them one at a time. The blocks are kept
+  // fairly small so that searches which stop early don't screen much more
+  // than they need to.
+  const unsigned int screenBlockSize = 1024;
+  std::vector<std::uint64_t> candidates;
+  std::vector<unsigned int> blockIndices;
+  unsigned int blockStart = start;
+  unsigned int blockEnd = start;
+  bool screened = false;
   for (unsigned int idx = start; idx < end; idx += numThreads) {
     unsigned int sidx = idx;
     if (!searchOrder.empty()) {
       sidx = searchOrder[idx];
     }
-    if (!bits.check(sidx) || found[sidx]) {
+    if (idx >= blockEnd) {
+      auto count = std::min(screenBlockSize, (end - idx - 1) / numThreads + 1);
+      if (searchOrder.empty()) {
+        screened = bits.screen(idx, numThreads, count, candidates);
+      } else {
+        blockIndices.clear();
+        for (unsigned int i = 0; i < count; ++i) {
+          blockIndices.push_back(searchOrder[idx + i * numThreads]);
+        }
+        screened = bits.screen(blockIndices, candidates);
+      }
+      blockStart = idx;
+      blockEnd = idx + count * numThreads;
+    }
+    if (screened) {
+      const auto pos = (idx - blockStart) / numThreads;
+      if (!(candidates[pos / 64] >> (pos % 64) & 1)) {
+        continue;
+      }
+    } else if (!bits.check(sidx)) {
+      continue;
+    }
+    if (found[sidx]) {
       continue;
     }
     // need shared_ptr as it (may) control the lifespan of the
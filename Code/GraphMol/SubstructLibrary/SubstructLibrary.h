@@ -37,6 +37,7 @@
 #include <RDGeneral/export.h>
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/MolPickler.h>
+#include <GraphMol/MolPickleView.h>
 #include <GraphMol/MolBundle.h>
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #include <GraphMol/SmilesParse/SmilesWrite.h>
@@ -44,11 +45,15 @@
 #include <GraphMol/Substruct/SubstructMatch.h>
 #include <DataStructs/ExplicitBitVect.h>
 #include <DataStructs/BitOps.h>
+#include <DataStructs/PackedBitOps.h>
 #include <GraphMol/MolOps.h>
 #include <GraphMol/TautomerQuery/TautomerQuery.h>
 #include <GraphMol/GeneralizedSubstruct/XQMol.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <boost/lexical_cast.hpp>
 
@@ -146,6 +151,19 @@ class RDKIT_SUBSTRUCTLIBRARY_EXPORT CachedMolHolder : public MolHolderBase {
     return mol;
   }
 
+  //! returns a read-only view of the pickle of molecule \c idx
+  /*!
+    This is much cheaper than getMol() when only a few atom or bond
+    attributes or properties of the molecule are needed. The view refers to
+    the pickle stored here, so it is invalidated by adding molecules.
+  */
+  MolPickleView getMolView(unsigned int idx) const {
+    if (idx >= mols.size()) {
+      throw IndexErrorException(idx);
+    }
+    return MolPickleView(mols[idx]);
+  }
+
   unsigned int size() const override {
     return rdcast<unsigned int>(mols.size());
   }
@@ -257,8 +275,25 @@ class RDKIT_SUBSTRUCTLIBRARY_EXPORT CachedTrustedSmilesMolHolder
 //! Base FPI for the fingerprinter used to rule out impossible matches
 class RDKIT_SUBSTRUCTLIBRARY_EXPORT FPHolderBase {
   std::vector<ExplicitBitVect *> fps;
+  // the fingerprints packed into word-aligned rows for the bulk screens,
+  // created when they are first needed
+  mutable std::unique_ptr<PackedBitOps::PackedFingerprints> dp_packedFps;
+  mutable std::mutex d_packedFpsMutex;
+
+  const PackedBitOps::PackedFingerprints *getPackedFingerprints() const;
 
  public:
+  FPHolderBase() = default;
+  // the packed fingerprints are not copied, they are made again when needed
+  FPHolderBase(const FPHolderBase &other) : fps(other.fps) {}
+  FPHolderBase &operator=(const FPHolderBase &other) {
+    if (this != &other) {
+      std::lock_guard<std::mutex> lock(d_packedFpsMutex);
+      fps = other.fps;
+      dp_packedFps.reset();
+    }
+    return *this;
+  }
   virtual ~FPHolderBase() {
     for (size_t i = 0; i < fps.size(); ++i) {
       delete fps[i];
@@ -268,9 +303,8 @@ class RDKIT_SUBSTRUCTLIBRARY_EXPORT FPHolderBase {
   virtual unsigned int size() const { return rdcast<unsigned int>(fps.size()); }
 
   //! Adds a molecule to the fingerprinter
-  unsigned int addMol(const ROMol &m) {
-    fps.push_back(makeFingerprint(m));
-    return rdcast<unsigned int>(fps.size() - 1);
+  virtual unsigned int addMol(const ROMol &m) {
+    return addFingerprint(makeFingerprint(m));
   }
 
   //! Adds a raw bit vector pointer to the fingerprinter, which takes ownership
@@ -289,7 +323,8 @@ class RDKIT_SUBSTRUCTLIBRARY_EXPORT FPHolderBase {
   }
 
   //! Return false if a substructure search can never match the molecule
-  bool passesFilter(unsigned int idx, const ExplicitBitVect &query) const {
+  virtual bool passesFilter(unsigned int idx,
+                            const ExplicitBitVect &query) const {
     if (idx >= fps.size()) {
       throw IndexErrorException(idx);
     }
@@ -297,9 +332,40 @@ class RDKIT_SUBSTRUCTLIBRARY_EXPORT FPHolderBase {
     return AllProbeBitsMatch(query, *fps[idx]);
   }
 
+  //! Screens a block of molecules at once
+  /*!
+    Screens the molecules <tt>firstIdx + i * stride</tt> for <tt>i <
+    count</tt> and sets bit \c i%64 of word \c i/64 of \c result if the
+    molecule passes the filter (clearing it otherwise).  \c result must have
+    room for <tt>(count + 63) / 64</tt> words.
+
+    The default implementation keeps a copy of the fingerprints packed into
+    word-aligned rows and screens them with
+    PackedBitOps::bulkAllProbeBitsMatch(), which uses AVX2 or AVX-512 where
+    the CPU supports them. The packed copy is made the first time it is
+    needed and again after each call to the non-const getFingerprints(),
+    which allows the fingerprints to be modified. Classes which override
+    passesFilter() should override this as well.
+  */
+  virtual void bulkPassesFilter(const ExplicitBitVect &query,
+                                unsigned int firstIdx, unsigned int stride,
+                                unsigned int count,
+                                std::uint64_t *result) const;
+
+  //! Screens the molecules <tt>indices[i]</tt> for <tt>i < count</tt>
+  /*!
+    This is used when the molecules are searched in a custom order, the
+    result is set as for bulkPassesFilter().  Classes which override
+    passesFilter() should override this as well.
+  */
+  virtual void bulkPassesFilterIndices(const ExplicitBitVect &query,
+                                       const unsigned int *indices,
+                                       unsigned int count,
+                                       std::uint64_t *result) const;
+
   //! Get the bit vector at the specified index (throws IndexError if out of
   //! range)
-  const ExplicitBitVect &getFingerprint(unsigned int idx) const {
+  virtual const ExplicitBitVect &getFingerprint(unsigned int idx) const {
     if (idx >= fps.size()) {
       throw IndexErrorException(idx);
     }
@@ -310,8 +376,15 @@ class RDKIT_SUBSTRUCTLIBRARY_EXPORT FPHolderBase {
   //!  Caller owns the vector!
   virtual ExplicitBitVect *makeFingerprint(const ROMol &m) const = 0;
 
-  std::vector<ExplicitBitVect *> &getFingerprints() { return fps; }
-  const std::vector<ExplicitBitVect *> &getFingerprints() const { return fps; }
+  virtual std::vector<ExplicitBitVect *> &getFingerprints() {
+    // the caller may modify the fingerprints
+    std::lock_guard<std::mutex> lock(d_packedFpsMutex);
+    dp_packedFps.reset();
+    return fps;
+  }
+  virtual const std::vector<ExplicitBitVect *> &getFingerprints() const {
+    return fps;
+  }
 };
 
 //! Uses the pattern fingerprinter with a user-defined number of bits (default:
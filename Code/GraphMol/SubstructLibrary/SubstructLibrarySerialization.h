@@ -41,6 +41,15 @@
 #include <boost/archive/archive_exception.hpp>
 #include <RDGeneral/BoostEndInclude.h>
 
+// the memory mapped holders are defined, and their serialization
+// implemented, in MappedSubstructLibrary.h
+namespace RDKit {
+class MappedMolHolder;
+template <class PatternHolderType>
+class MappedPatternHolderT;
+class MappedKeyHolder;
+}  // namespace RDKit
+
 BOOST_SERIALIZATION_ASSUME_ABSTRACT(RDKit::MolHolderBase)
 BOOST_SERIALIZATION_ASSUME_ABSTRACT(RDKit::FPHolderBase)
 
@@ -191,6 +200,14 @@ void registerSubstructLibraryTypes(Archive &ar) {
   ar.register_type(static_cast<RDKit::PatternHolder *>(nullptr));
   ar.register_type(static_cast<RDKit::TautomerPatternHolder *>(nullptr));
   ar.register_type(static_cast<RDKit::KeyFromPropHolder *>(nullptr));
+  ar.register_type(static_cast<RDKit::MappedMolHolder *>(nullptr));
+  ar.register_type(
+      static_cast<RDKit::MappedPatternHolderT<RDKit::PatternHolder> *>(
+          nullptr));
+  ar.register_type(
+      static_cast<RDKit::MappedPatternHolderT<RDKit::TautomerPatternHolder> *>(
+          nullptr));
+  ar.register_type(static_cast<RDKit::MappedKeyHolder *>(nullptr));
 }
 
 template <class Archive>
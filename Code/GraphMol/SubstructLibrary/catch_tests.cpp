@@ -10,6 +10,11 @@
 
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
+#include <type_traits>
+#include <filesystem>
+#include <fstream>
+
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/MolBundle.h>
 #include <GraphMol/SmilesParse/SmilesParse.h>
@@ -17,6 +22,7 @@
 #include <GraphMol/RDKitQueries.h>
 #include <GraphMol/SubstructLibrary/SubstructLibrary.h>
 #include <GraphMol/SubstructLibrary/PatternFactory.h>
+#include <GraphMol/SubstructLibrary/MappedSubstructLibrary.h>
 #include <GraphMol/GeneralizedSubstruct/XQMol.h>
 
 using namespace RDKit;
@@ -326,4 +332,294 @@ TEST_CASE("ExtendedQueryMol") {
     CHECK(!ssslib.hasMatch(xqm));
   }
 }
-#endif
\ No newline at end of file
+
+TEST_CASE("memory mapped libraries") {
+  std::vector<std::string> libSmiles = {"CCCOC", "CCCCOCC", "c1ccccc1O",
+                                        "COC",   "CCCCCOC", "Oc1ccncc1"};
+  // ctest may run several test processes at once, so the file name is unique
+  auto fname = (std::filesystem::temp_directory_path() /
+                ("mapped_ssslib_" + std::to_string(std::random_device()()) +
+                 ".bin"))
+                   .string();
+  std::vector<std::string> qSmarts = {"COC", "c1ccccc1", "[OH]", "[#7]",
+                                      "[R]"};
+
+  SECTION("trusted smiles, patterns and keys") {
+    boost::shared_ptr<CachedTrustedSmilesMolHolder> mholder(
+        new CachedTrustedSmilesMolHolder());
+    boost::shared_ptr<PatternHolder> fpholder(new PatternHolder());
+    boost::shared_ptr<KeyFromPropHolder> keyholder(new KeyFromPropHolder());
+    SubstructLibrary ssslib(mholder, fpholder, keyholder);
+    for (const auto &smi : libSmiles) {
+      std::unique_ptr<RWMol> mol(SmilesToMol(smi));
+      REQUIRE(mol);
+      mol->setProp(common_properties::_Name, "mol-" + smi);
+      ssslib.addMol(*mol);
+    }
+    ssslib.setSearchOrder({5, 4, 3, 2, 1, 0});
+    writeMappedSubstructLibrary(ssslib, fname);
+
+    auto mapped = openMappedSubstructLibrary(fname);
+    REQUIRE(mapped.size() == ssslib.size());
+    CHECK(mapped.getSearchOrder() == ssslib.getSearchOrder());
+    CHECK(dynamic_cast<MappedPatternHolder *>(mapped.getFpHolder().get()));
+    for (unsigned int i = 0; i < ssslib.size(); ++i) {
+      CHECK(MolToSmiles(*mapped.getMol(i)) == MolToSmiles(*ssslib.getMol(i)));
+      CHECK(mapped.getKeys().getKey(i) == ssslib.getKeys().getKey(i));
+    }
+    for (const auto &sma : qSmarts) {
+      std::unique_ptr<RWMol> qm(SmartsToMol(sma));
+      REQUIRE(qm);
+      for (auto numThreads : std::vector<int>{1, -1}) {
+        CHECK(mapped.getMatches(*qm, true, true, false, numThreads) ==
+              ssslib.getMatches(*qm, true, true, false, numThreads));
+        CHECK(mapped.countMatches(*qm, true, true, false, numThreads) ==
+              ssslib.countMatches(*qm, true, true, false, numThreads));
+      }
+    }
+    auto qm = "[OH]"_smarts;
+    auto matches = mapped.getMatches(*qm);
+    CHECK(mapped.getKeys().getKeys(matches) ==
+          ssslib.getKeys().getKeys(ssslib.getMatches(*qm)));
+
+    auto m = "CC"_smiles;
+    CHECK_THROWS_AS(mapped.addMol(*m), ValueErrorException);
+
+    // the fingerprints are not available as ExplicitBitVects
+    const FPHolderBase &fpBase = *mapped.getFpHolder();
+    CHECK_THROWS_AS(fpBase.getFingerprint(0), ValueErrorException);
+    CHECK_THROWS_AS(fpBase.getFingerprints(), ValueErrorException);
+
+    // the references returned by getKey() stay valid
+    const auto &key0 = mapped.getKeys().getKey(0);
+    const auto &key1 = mapped.getKeys().getKey(1);
+    CHECK(key0 == "mol-CCCOC");
+    CHECK(key1 == "mol-CCCCOCC");
+    CHECK(&mapped.getKeys().getKey(0) == &key0);
+    const auto &mappedKeys =
+        dynamic_cast<const MappedKeyHolder &>(*mapped.getKeyHolder());
+    CHECK(mappedKeys.getKeyView(1) == "mol-CCCCOCC");
+    CHECK_THROWS_AS(mappedKeys.getKeyView(ssslib.size()),
+                    IndexErrorException);
+    CHECK_THROWS_AS(mappedKeys.getKey(ssslib.size()), IndexErrorException);
+
+    // the mapped holders are serialized as the name of the file
+    SubstructLibrary serialized;
+    serialized.initFromString(mapped.Serialize());
+    REQUIRE(serialized.size() == mapped.size());
+    CHECK(dynamic_cast<MappedMolHolder *>(serialized.getMolHolder().get()));
+    CHECK(
+        dynamic_cast<MappedPatternHolder *>(serialized.getFpHolder().get()));
+    CHECK(dynamic_cast<MappedKeyHolder *>(serialized.getKeyHolder().get()));
+    CHECK(serialized.getSearchOrder() == mapped.getSearchOrder());
+    CHECK(serialized.getMatches(*qm) == matches);
+    CHECK(serialized.getKeys().getKeys(matches) ==
+          mapped.getKeys().getKeys(matches));
+  }
+
+  SECTION("pickles and tautomer patterns") {
+    boost::shared_ptr<MolHolder> mholder(new MolHolder());
+    boost::shared_ptr<TautomerPatternHolder> fpholder(
+        new TautomerPatternHolder(1024));
+    SubstructLibrary ssslib(mholder, fpholder);
+    for (const auto &smi : libSmiles) {
+      std::unique_ptr<RWMol> mol(SmilesToMol(smi));
+      REQUIRE(mol);
+      ssslib.addMol(*mol);
+    }
+    writeMappedSubstructLibrary(ssslib, fname);
+
+    auto mapped = openMappedSubstructLibrary(fname);
+    REQUIRE(mapped.size() == ssslib.size());
+    const auto *fps = dynamic_cast<MappedTautomerPatternHolder *>(
+        mapped.getFpHolder().get());
+    REQUIRE(fps);
+    CHECK(fps->getNumBits() == 1024);
+    CHECK(fps->getFile().getMolFormat() ==
+          MappedLibraryFile::MolFormat::Pickle);
+    CHECK_THROWS_AS(mapped.getKeys(), ValueErrorException);
+    for (const auto &sma : qSmarts) {
+      std::unique_ptr<RWMol> qm(SmartsToMol(sma));
+      REQUIRE(qm);
+      CHECK(mapped.getMatches(*qm) == ssslib.getMatches(*qm));
+    }
+    auto tq = "CC(=O)C"_smiles;
+    std::unique_ptr<TautomerQuery> tautQuery(TautomerQuery::fromMol(*tq));
+    CHECK(mapped.getMatches(*tautQuery) == ssslib.getMatches(*tautQuery));
+
+    // mapped libraries can be written again
+    auto fname2 = fname + ".2";
+    writeMappedSubstructLibrary(mapped, fname2);
+    auto mapped2 = openMappedSubstructLibrary(fname2);
+    CHECK(mapped2.size() == mapped.size());
+    CHECK(mapped2.getMatches(*tautQuery) == mapped.getMatches(*tautQuery));
+
+    SubstructLibrary serialized;
+    serialized.initFromString(mapped2.Serialize());
+    CHECK(dynamic_cast<MappedTautomerPatternHolder *>(
+        serialized.getFpHolder().get()));
+    CHECK(serialized.getMatches(*tautQuery) ==
+          mapped.getMatches(*tautQuery));
+    std::filesystem::remove(fname2);
+  }
+
+  SECTION("bad files") {
+    {
+      std::ofstream os(fname, std::ios_base::binary);
+      os << "this is not a substructure library, but it needs to be a bit "
+            "longer than the header is, so here are some more characters";
+    }
+    CHECK_THROWS_AS(openMappedSubstructLibrary(fname), BadFileException);
+  }
+  std::filesystem::remove(fname);
+}
+#endif
+
+TEST_CASE("bulk screening") {
+  // every fragment can be used at either end or in the middle of a chain:
+  std::vector<std::string> frags = {
+      "C",     "O",        "N",    "c1ccccc1", "CC",   "C(=O)O",
+      "C(Cl)", "c1ccncc1", "S",    "C1CCCCC1", "C(F)", "C(C#N)"};
+  boost::shared_ptr<MolHolder> mholder(new MolHolder());
+  boost::shared_ptr<PatternHolder> fpholder(new PatternHolder(512));
+  SubstructLibrary ssslib(mholder, fpholder);
+  SubstructLibrary unscreened(mholder);
+  for (const auto &f1 : frags) {
+    for (const auto &f2 : frags) {
+      for (const auto &f3 : frags) {
+        std::unique_ptr<RWMol> mol(SmilesToMol(f1 + "C" + f2 + "C" + f3));
+        REQUIRE(mol);
+        ssslib.addMol(*mol);
+      }
+    }
+  }
+  REQUIRE(ssslib.size() == 1728);
+
+  std::vector<std::string> qSmarts = {"c1ccccc1", "ClCC(=O)O", "[#7]",
+                                      "FCCCCl", "[R]C[R]"};
+  SECTION("bulkPassesFilter") {
+    for (const auto &sma : qSmarts) {
+      std::unique_ptr<RWMol> qm(SmartsToMol(sma));
+      REQUIRE(qm);
+      std::unique_ptr<ExplicitBitVect> qfp(fpholder->makeFingerprint(*qm));
+      for (auto stride : {1u, 3u}) {
+        const unsigned int first = 5;
+        const unsigned int count = (ssslib.size() - first - 1) / stride + 1;
+        std::vector<std::uint64_t> res((count + 63) / 64);
+        fpholder->bulkPassesFilter(*qfp, first, stride, count, res.data());
+        for (unsigned int i = 0; i < count; ++i) {
+          CHECK(bool(res[i / 64] >> (i % 64) & 1) ==
+                fpholder->passesFilter(first + i * stride, *qfp));
+        }
+      }
+      std::vector<std::uint64_t> res(1);
+      CHECK_THROWS_AS(fpholder->bulkPassesFilter(*qfp, ssslib.size() - 1, 1,
+                                                 2, res.data()),
+                      IndexErrorException);
+
+      std::vector<unsigned int> indices = {1700, 3, 3, 999, 0, 42};
+      fpholder->bulkPassesFilterIndices(*qfp, indices.data(), indices.size(),
+                                        res.data());
+      for (unsigned int i = 0; i < indices.size(); ++i) {
+        CHECK(bool(res[0] >> i & 1) ==
+              fpholder->passesFilter(indices[i], *qfp));
+      }
+      indices.push_back(ssslib.size());
+      CHECK_THROWS_AS(fpholder->bulkPassesFilterIndices(
+                          *qfp, indices.data(), indices.size(), res.data()),
+                      IndexErrorException);
+    }
+  }
+  SECTION("search order") {
+    std::vector<unsigned int> searchOrder(ssslib.size());
+    for (unsigned int i = 0; i < searchOrder.size(); ++i) {
+      searchOrder[i] = (i * 7) % searchOrder.size();
+    }
+    std::reverse(searchOrder.begin(), searchOrder.end());
+    ssslib.setSearchOrder(searchOrder);
+    for (const auto &sma : qSmarts) {
+      std::unique_ptr<RWMol> qm(SmartsToMol(sma));
+      REQUIRE(qm);
+      for (auto numThreads : std::vector<int>{1, 4}) {
+        auto matches = ssslib.getMatches(*qm, true, true, false, numThreads);
+        std::sort(matches.begin(), matches.end());
+        auto expected =
+            unscreened.getMatches(*qm, true, true, false, numThreads);
+        std::sort(expected.begin(), expected.end());
+        CHECK(matches == expected);
+      }
+      // with a single thread the results are in the search order
+      auto firstMatches = ssslib.getMatches(*qm, true, true, false, 1, 5);
+      auto all = unscreened.getMatches(*qm, true, true, false, 1);
+      std::vector<unsigned int> expected;
+      for (auto idx : searchOrder) {
+        if (expected.size() < 5 &&
+            std::find(all.begin(), all.end(), idx) != all.end()) {
+          expected.push_back(idx);
+        }
+      }
+      CHECK(firstMatches == expected);
+    }
+  }
+  // the wrappers rely on the holders being copy constructible
+  STATIC_REQUIRE(std::is_copy_constructible_v<PatternHolder>);
+  SECTION("matches") {
+    for (const auto &sma : qSmarts) {
+      std::unique_ptr<RWMol> qm(SmartsToMol(sma));
+      REQUIRE(qm);
+      for (auto numThreads : std::vector<int>{1, 4}) {
+        auto matches = ssslib.getMatches(*qm, true, true, false, numThreads);
+        std::sort(matches.begin(), matches.end());
+        auto expected =
+            unscreened.getMatches(*qm, true, true, false, numThreads);
+        std::sort(expected.begin(), expected.end());
+        CHECK(matches == expected);
+        CHECK(ssslib.countMatches(*qm, true, true, false, numThreads) ==
+              expected.size());
+        CHECK(ssslib.getMatches(*qm, true, true, false, numThreads, 7)
+                  .size() == std::min<size_t>(7, expected.size()));
+      }
+    }
+  }
+  SECTION("modifying the fingerprints") {
+    auto qm = "c1ccncc1"_smarts;
+    auto nmatches = ssslib.countMatches(*qm);
+    std::unique_ptr<ExplicitBitVect> qfp(fpholder->makeFingerprint(*qm));
+    std::vector<std::uint64_t> res(1);
+    fpholder->bulkPassesFilter(*qfp, 0, 1, 64, res.data());
+    CHECK(res[0] != ~0ULL);
+    // set every bit so that everything passes the screen
+    for (auto &fp : fpholder->getFingerprints()) {
+      *fp = ~ExplicitBitVect(512);
+    }
+    fpholder->bulkPassesFilter(*qfp, 0, 1, 64, res.data());
+    CHECK(res[0] == ~0ULL);
+    CHECK(ssslib.countMatches(*qm) == nmatches);
+    // fingerprints of different sizes are screened one at a time
+    fpholder->addFingerprint(ExplicitBitVect(1024));
+    res[0] = 0;
+    fpholder->bulkPassesFilter(*qfp, 0, 1, 64, res.data());
+    CHECK(res[0] == ~0ULL);
+  }
+}
+
+TEST_CASE("CachedMolHolder views") {
+  CachedMolHolder holder;
+  for (const auto smi : {"c1ccccc1", "CC(=O)[O-]", "[13CH4]"}) {
+    auto mol = v2::SmilesParse::MolFromSmiles(smi);
+    REQUIRE(mol);
+    holder.addMol(*mol);
+  }
+  for (unsigned int i = 0; i < holder.size(); ++i) {
+    auto mol = holder.getMol(i);
+    auto view = holder.getMolView(i);
+    CHECK(view.getNumAtoms() == mol->getNumAtoms());
+    CHECK(view.getNumBonds() == mol->getNumBonds());
+    for (const auto atom : mol->atoms()) {
+      CHECK(view.getAtomicNum(atom->getIdx()) == atom->getAtomicNum());
+      CHECK(view.getFormalCharge(atom->getIdx()) == atom->getFormalCharge());
+      CHECK(view.getIsotope(atom->getIdx()) == atom->getIsotope());
+    }
+  }
+  CHECK_THROWS_AS(holder.getMolView(holder.size()), IndexErrorException);
+}
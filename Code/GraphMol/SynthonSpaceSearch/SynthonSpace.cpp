@@ -27,7 +27,7 @@
 #include <GraphMol/ChemTransforms/ChemTransforms.h>
 #include <GraphMol/Fingerprints/Fingerprints.h>
 #include <GraphMol/GeneralizedSubstruct/XQMol.h>
-#include <GraphMol/SynthonSpaceSearch/MemoryMappedFileReader.h>
+#include <RDGeneral/MemoryMappedFileReader.h>
 #include <GraphMol/SynthonSpaceSearch/SynthonSpace.h>
 #include <GraphMol/SynthonSpaceSearch/SynthonSpaceFingerprintSearcher.h>
 #include <GraphMol/SynthonSpaceSearch/SynthonSpaceRascalSearcher.h>
@@ -705,7 +705,7 @@ void SynthonSpace::readDBFile(const std::string &inFilename,
   }
   is.close();
 
-  details::MemoryMappedFileReader fileMap(d_fileName);
+  MemoryMappedFileReader fileMap(d_fileName);
   // put the end of the last synthon and reaction into their respective arrays,
   synthonPos.push_back(reactionPos[0]);
   reactionPos.push_back(fileMap.d_size);
@@ -0,0 +1,234 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+
+#include <catch2/catch_all.hpp>
+
+#include <GraphMol/RDKitBase.h>
+#include <GraphMol/CompactMol.h>
+#include <GraphMol/MolPickler.h>
+#include <GraphMol/MolPickleView.h>
+#include <GraphMol/SmilesParse/SmilesParse.h>
+
+using namespace RDKit;
+
+namespace {
+void compareToMol(const CompactMol &cmol, const ROMol &mol) {
+  REQUIRE(cmol.getNumAtoms() == mol.getNumAtoms());
+  REQUIRE(cmol.getNumBonds() == mol.getNumBonds());
+  for (const auto atom : mol.atoms()) {
+    const auto idx = atom->getIdx();
+    CHECK(cmol.getAtomicNum(idx) == atom->getAtomicNum());
+    CHECK(cmol.getFormalCharge(idx) == atom->getFormalCharge());
+    CHECK(cmol.getIsotope(idx) == atom->getIsotope());
+    CHECK(cmol.getNumHs(idx) == atom->getTotalNumHs());
+    CHECK(cmol.getNumRadicalElectrons(idx) ==
+          atom->getNumRadicalElectrons());
+    CHECK(cmol.getAtomIsAromatic(idx) == atom->getIsAromatic());
+    CHECK(cmol.getChiralTag(idx) == atom->getChiralTag());
+    CHECK(cmol.getHybridization(idx) == atom->getHybridization());
+    CHECK(cmol.getNumAtomRings(idx) ==
+          mol.getRingInfo()->numAtomRings(idx));
+    CHECK(cmol.getDegree(idx) == atom->getDegree());
+    auto nbrs = cmol.getAtomNeighbors(idx);
+    auto bonds = cmol.getAtomBonds(idx);
+    REQUIRE(nbrs.size() == atom->getDegree());
+    for (unsigned int i = 0; i < nbrs.size(); ++i) {
+      const auto bond = mol.getBondBetweenAtoms(idx, nbrs[i]);
+      REQUIRE(bond);
+      CHECK(bond->getIdx() == bonds[i]);
+      CHECK(cmol.getBondBetweenAtoms(idx, nbrs[i]) ==
+            static_cast<int>(bond->getIdx()));
+    }
+  }
+  for (const auto bond : mol.bonds()) {
+    const auto idx = bond->getIdx();
+    CHECK(cmol.getBeginAtomIdx(idx) == bond->getBeginAtomIdx());
+    CHECK(cmol.getEndAtomIdx(idx) == bond->getEndAtomIdx());
+    CHECK(cmol.getOtherAtomIdx(idx, bond->getBeginAtomIdx()) ==
+          bond->getEndAtomIdx());
+    CHECK(cmol.getBondType(idx) == bond->getBondType());
+    CHECK(cmol.getBondStereo(idx) == bond->getStereo());
+    auto stereoAtoms = cmol.getBondStereoAtoms(idx);
+    CHECK(INT_VECT(stereoAtoms.begin(), stereoAtoms.end()) ==
+          bond->getStereoAtoms());
+    CHECK(cmol.getBondIsAromatic(idx) == bond->getIsAromatic());
+    CHECK(cmol.getBondIsConjugated(idx) == bond->getIsConjugated());
+    CHECK(cmol.getNumBondRings(idx) ==
+          mol.getRingInfo()->numBondRings(idx));
+  }
+}
+}  // namespace
+
+TEST_CASE("CompactMol basics") {
+  SECTION("attributes and connectivity") {
+    for (const auto smi :
+         {"c1ccccc1C(=O)[O-]", "[13CH3][C@H](F)/C=C/Cl", "C1CC2CCC1CC2",
+          "[CH2]C.[Na+]", "[2H]C([2H])([2H])N->[Fe]"}) {
+      INFO(smi);
+      auto mol = v2::SmilesParse::MolFromSmiles(smi);
+      REQUIRE(mol);
+      CompactMol cmol(*mol);
+      compareToMol(cmol, *mol);
+      CHECK(cmol.getBondBetweenAtoms(0, 0) == -1);
+    }
+  }
+  SECTION("empty molecules") {
+    CompactMol cmol;
+    CHECK(cmol.getNumAtoms() == 0);
+    CHECK(cmol.getDataSize() == 0);
+    CompactMol cmol2(cmol.toString());
+    CHECK(cmol2.getNumAtoms() == 0);
+    RWMol mol;
+    CompactMol cmol3(mol);
+    CHECK(cmol3.getNumAtoms() == 0);
+  }
+  SECTION("properties") {
+    auto mol = "CCO"_smiles;
+    REQUIRE(mol);
+    mol->setProp("_Name", "ethanol");
+    mol->setProp("foo", "bar");
+    mol->setProp("count", 3);
+    mol->setProp("_private", 1);
+    CompactMol cmol(*mol);
+    CHECK(cmol.hasProp("foo"));
+    CHECK(cmol.getProp("foo") == "bar");
+    CHECK(cmol.getProp("count") == "3");
+    CHECK(!cmol.hasProp("_Name"));
+    CHECK(!cmol.hasProp("_private"));
+    CHECK(!cmol.hasProp("missing"));
+    CHECK_THROWS_AS(cmol.getProp("missing"), KeyErrorException);
+    CHECK(cmol.getPropList().size() == 2);
+    CHECK(getInternedPropName(internPropName("foo")) == "foo");
+    CHECK(internPropName("foo") == internPropName("foo"));
+  }
+  SECTION("query molecules") {
+    auto qry = "C~[#6]"_smarts;
+    REQUIRE(qry);
+    CHECK_THROWS_AS(CompactMol(*qry), ValueErrorException);
+  }
+}
+
+TEST_CASE("CompactMol serialization and copying") {
+  auto mol = "OC(=O)c1ccccc1[C@@H](F)Cl"_smiles;
+  REQUIRE(mol);
+  mol->setProp("foo", "bar");
+  CompactMol cmol(*mol);
+  SECTION("round trip") {
+    auto pkl = cmol.toString();
+    CompactMol cmol2(pkl);
+    compareToMol(cmol2, *mol);
+    CHECK(cmol2.getProp("foo") == "bar");
+    CHECK(cmol2.getDataSize() == cmol.getDataSize());
+    CHECK(cmol2.toString() == pkl);
+    CompactMol cmol3(pkl.c_str(), pkl.size());
+    compareToMol(cmol3, *mol);
+  }
+  SECTION("copy and move") {
+    CompactMol cmol2(cmol);
+    compareToMol(cmol2, *mol);
+    CompactMol cmol3(std::move(cmol2));
+    compareToMol(cmol3, *mol);
+    CHECK(cmol2.getNumAtoms() == 0);
+    CompactMol cmol4;
+    cmol4 = cmol3;
+    compareToMol(cmol4, *mol);
+    cmol4 = CompactMol();
+    CHECK(cmol4.getNumAtoms() == 0);
+    cmol4 = std::move(cmol3);
+    compareToMol(cmol4, *mol);
+  }
+  SECTION("pattern fingerprint") {
+    CHECK(!cmol.hasPatternFingerprint());
+    CHECK_THROWS_AS(cmol.setPatternFingerprint({1, 2}, 200),
+                    ValueErrorException);
+    cmol.setPatternFingerprint({1, 2, 0xffff}, 130);
+    REQUIRE(cmol.hasPatternFingerprint());
+    auto pkl = cmol.toString();
+    CompactMol cmol2(pkl);
+    compareToMol(cmol2, *mol);
+    CHECK(cmol2.getPatternFingerprintSize() == 130);
+    CHECK(cmol2.getPatternFingerprintWords() ==
+          std::vector<std::uint64_t>{1, 2, 0xffff});
+    CHECK(cmol2.toString() == pkl);
+    CompactMol cmol3(cmol2);
+    CHECK(cmol3.getPatternFingerprintWords() ==
+          cmol2.getPatternFingerprintWords());
+    CompactMol cmol4(std::move(cmol3));
+    CHECK(cmol4.getPatternFingerprintSize() == 130);
+    CHECK(!cmol3.hasPatternFingerprint());
+    CHECK_THROWS_AS(CompactMol(pkl.substr(0, pkl.size() - 1)),
+                    ValueErrorException);
+    // an empty molecule can have a fingerprint too
+    CompactMol empty;
+    empty.setPatternFingerprint({3}, 64);
+    CompactMol empty2(empty.toString());
+    CHECK(empty2.getNumAtoms() == 0);
+    CHECK(empty2.getPatternFingerprintWords() == std::vector<std::uint64_t>{3});
+  }
+  SECTION("bad input") {
+    auto pkl = cmol.toString();
+    CHECK_THROWS_AS(CompactMol(pkl.substr(0, pkl.size() - 1)),
+                    ValueErrorException);
+    CHECK_THROWS_AS(CompactMol(pkl.substr(0, 6)), ValueErrorException);
+    auto bad = pkl;
+    bad[0] ^= 0xff;
+    CHECK_THROWS_AS(CompactMol(bad), ValueErrorException);
+    CHECK_THROWS_AS(CompactMol(pkl + "x"), ValueErrorException);
+  }
+}
+
+TEST_CASE("CompactMols from pickles") {
+  SECTION("with ring information") {
+    for (const auto smi :
+         {"c1ccccc1C(=O)[O-]", "[13CH3][C@H](F)/C=C/Cl", "C1CC2CCC1CC2",
+          "[CH2]C.[Na+]", "[2H]C([2H])([2H])N->[Fe]", "C1CC12CC2"}) {
+      INFO(smi);
+      auto mol = v2::SmilesParse::MolFromSmiles(smi);
+      REQUIRE(mol);
+      mol->setProp("foo", "bar");
+      std::string pkl;
+      MolPickler::pickleMol(*mol, pkl,
+                            PicklerOps::PropertyPickleOptions::MolProps);
+      MolPickleView view(pkl);
+      REQUIRE(view.hasRingInfo());
+      CompactMol cmol(view);
+      // the unpickled molecule has the same atom neighbor order
+      std::unique_ptr<ROMol> unpickled(view.toMol());
+      compareToMol(cmol, *unpickled);
+      CHECK(cmol.getProp("foo") == "bar");
+      CHECK(cmol.toString() == CompactMol(*unpickled).toString());
+    }
+  }
+  SECTION("without ring information") {
+    v2::SmilesParse::SmilesParserParams ps;
+    ps.sanitize = false;
+    auto mol = v2::SmilesParse::MolFromSmiles("C1CCC1CC2CC2", ps);
+    REQUIRE(mol);
+    mol->updatePropertyCache(false);
+    mol->getRingInfo()->reset();
+    std::string pkl;
+    MolPickler::pickleMol(*mol, pkl);
+    MolPickleView view(pkl);
+    REQUIRE(!view.hasRingInfo());
+    CompactMol cmol(view);
+    CHECK(cmol.getNumAtomRings(0) == 1);
+    CHECK(cmol.getNumAtomRings(4) == 0);
+    CHECK(cmol.getNumBondRings(cmol.getBondBetweenAtoms(3, 4)) == 0);
+    CHECK(cmol.getNumBondRings(cmol.getBondBetweenAtoms(5, 6)) == 1);
+  }
+  SECTION("query molecules") {
+    auto qry = "C~[#6]"_smarts;
+    REQUIRE(qry);
+    std::string pkl;
+    MolPickler::pickleMol(*qry, pkl);
+    MolPickleView view(pkl);
+    CHECK_THROWS_AS(CompactMol(view), ValueErrorException);
+  }
+}
@@ -0,0 +1,193 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+
+#include <catch2/catch_all.hpp>
+
+#include <GraphMol/RDKitBase.h>
+#include <GraphMol/MolArena.h>
+#include <GraphMol/MolPickler.h>
+#include <GraphMol/QueryAtom.h>
+#include <GraphMol/SmilesParse/SmilesParse.h>
+#include <GraphMol/SmilesParse/SmilesWrite.h>
+
+#ifdef RDK_BUILD_THREADSAFE_SSS
+#include <thread>
+#endif
+
+using namespace RDKit;
+
+namespace {
+bool allArenaAllocated(const ROMol &mol) {
+  if (!MolArena::isArenaAllocated(&mol) ||
+      !MolArena::isArenaAllocated(mol.getRingInfo())) {
+    return false;
+  }
+  for (const auto atom : mol.atoms()) {
+    if (!MolArena::isArenaAllocated(atom)) {
+      return false;
+    }
+  }
+  for (const auto bond : mol.bonds()) {
+    if (!MolArena::isArenaAllocated(bond)) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+TEST_CASE("MolArena basics") {
+  SECTION("scopes") {
+    CHECK(!MolArena::isActive());
+    {
+      MolArena::Scope arena;
+      CHECK(MolArena::isActive());
+      {
+        MolArena::Scope inner;
+        CHECK(MolArena::isActive());
+      }
+      CHECK(MolArena::isActive());
+    }
+    CHECK(!MolArena::isActive());
+  }
+  SECTION("no arena in use") {
+    // without a scope or live slabs the standard allocator is used directly
+    CHECK(MolArena::detail::useCount == 0);
+    std::unique_ptr<Atom> atom;
+    {
+      MolArena::Scope arena;
+      CHECK(MolArena::detail::useCount > 0);
+      atom.reset(new Atom(6));
+    }
+    // the slab is alive as long as the atom is
+    CHECK(MolArena::detail::useCount > 0);
+    CHECK(MolArena::isArenaAllocated(atom.get()));
+    std::unique_ptr<Atom> heapAtom(new Atom(7));
+    CHECK(!MolArena::isArenaAllocated(heapAtom.get()));
+    atom.reset();
+    CHECK(MolArena::detail::useCount == 0);
+    // heap memory handed out while an arena was in use can be released
+    // once it no longer is, and the other way around
+    void *mem = nullptr;
+    {
+      MolArena::Scope arena;
+      mem = MolArena::allocate(1 << 20);
+      heapAtom.reset();
+    }
+    CHECK(MolArena::detail::useCount == 0);
+    CHECK(!MolArena::isArenaAllocated(mem));
+    MolArena::deallocate(mem);
+    int onStack = 0;
+    CHECK(!MolArena::isArenaAllocated(&onStack));
+  }
+  SECTION("allocation") {
+    std::unique_ptr<Atom> heapAtom(new Atom(6));
+    CHECK(!MolArena::isArenaAllocated(heapAtom.get()));
+    std::vector<std::unique_ptr<Atom>> atoms;
+    std::unique_ptr<QueryAtom> qatom;
+    {
+      MolArena::Scope arena;
+      // enough atoms to need more than one slab
+      for (unsigned int i = 0; i < 5000; ++i) {
+        atoms.emplace_back(new Atom(i % 100));
+      }
+      qatom.reset(new QueryAtom(8));
+    }
+    // the atoms outlive the scope
+    for (unsigned int i = 0; i < atoms.size(); ++i) {
+      CHECK(MolArena::isArenaAllocated(atoms[i].get()));
+      CHECK(atoms[i]->getAtomicNum() == static_cast<int>(i % 100));
+      CHECK(reinterpret_cast<std::uintptr_t>(atoms[i].get()) %
+                alignof(Atom) ==
+            0);
+    }
+    CHECK(MolArena::isArenaAllocated(qatom.get()));
+    CHECK(qatom->Match(heapAtom.get()) == false);
+    // the first slab only holds atoms, so it is gone once they are
+    const void *firstAtom = atoms.front().get();
+    atoms.clear();
+    CHECK(!MolArena::isArenaAllocated(firstAtom));
+    CHECK(MolArena::isArenaAllocated(qatom.get()));
+    // large allocations are not taken from the arena
+    MolArena::Scope arena;
+    auto mem = MolArena::allocate(1 << 20);
+    CHECK(!MolArena::isArenaAllocated(mem));
+    MolArena::deallocate(mem);
+    MolArena::deallocate(nullptr);
+  }
+}
+
+TEST_CASE("building molecules in the arena") {
+  SECTION("SMILES") {
+    v2::SmilesParse::SmilesParserParams ps;
+    ps.useArena = true;
+    auto mol = v2::SmilesParse::MolFromSmiles("c1ccccc1[C@H](F)CC(=O)O", ps);
+    REQUIRE(mol);
+    CHECK(!MolArena::isActive());
+    CHECK(allArenaAllocated(*mol));
+    CHECK(MolToSmiles(*mol) == "O=C(O)C[C@@H](F)c1ccccc1");
+
+    // copies made outside a scope come from the heap
+    RWMol cp(*mol);
+    CHECK(!MolArena::isArenaAllocated(cp.getAtomWithIdx(0)));
+    CHECK(MolToSmiles(cp) == MolToSmiles(*mol));
+
+    ps.useArena = false;
+    auto mol2 = v2::SmilesParse::MolFromSmiles("CCO", ps);
+    REQUIRE(mol2);
+    CHECK(!MolArena::isArenaAllocated(mol2.get()));
+    CHECK(!MolArena::isArenaAllocated(mol2->getAtomWithIdx(0)));
+  }
+  SECTION("pickles") {
+    auto mol = "c1ccccc1[C@H](F)CC(=O)O"_smiles;
+    REQUIRE(mol);
+    std::string pkl;
+    MolPickler::pickleMol(*mol, pkl);
+    std::unique_ptr<ROMol> mol2;
+    {
+      MolArena::Scope arena;
+      mol2.reset(new ROMol(pkl));
+    }
+    CHECK(allArenaAllocated(*mol2));
+    CHECK(MolToSmiles(*mol2) == MolToSmiles(*mol));
+  }
+  SECTION("editing arena molecules") {
+    v2::SmilesParse::SmilesParserParams ps;
+    ps.useArena = true;
+    auto mol = v2::SmilesParse::MolFromSmiles("CCO", ps);
+    REQUIRE(mol);
+    mol->addAtom(new Atom(7), true, true);
+    mol->addBond(2, 3, Bond::SINGLE);
+    mol->removeAtom(0u);
+    MolOps::sanitizeMol(*mol);
+    CHECK(MolToSmiles(*mol) == "CON");
+  }
+#ifdef RDK_BUILD_THREADSAFE_SSS
+  SECTION("molecules deleted on other threads") {
+    std::vector<std::unique_ptr<RWMol>> mols;
+    std::thread producer([&mols]() {
+      v2::SmilesParse::SmilesParserParams ps;
+      ps.useArena = true;
+      MolArena::Scope arena;
+      for (unsigned int i = 0; i < 200; ++i) {
+        mols.push_back(v2::SmilesParse::MolFromSmiles("c1ccccc1CC(=O)O", ps));
+      }
+    });
+    producer.join();
+    REQUIRE(mols.size() == 200);
+    for (const auto &mol : mols) {
+      REQUIRE(mol);
+      CHECK(allArenaAllocated(*mol));
+      CHECK(mol->getNumAtoms() == 10);
+    }
+    mols.clear();
+  }
+#endif
+}
@@ -16,6 +16,8 @@
 
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/MolPickler.h>
+#include <GraphMol/MolPickleView.h>
+#include <GraphMol/MonomerInfo.h>
 #include <GraphMol/FileParsers/FileParsers.h>
 #include <GraphMol/SmilesParse/SmilesParse.h>
 #include <GraphMol/SmilesParse/SmilesWrite.h>
@@ -287,3 +289,176 @@ TEST_CASE("pickling HasPropWithValue queries") {
     }
   }
 }
+
+namespace {
+void compareViewToMol(const MolPickleView &view, const ROMol &mol) {
+  REQUIRE(view.getNumAtoms() == mol.getNumAtoms());
+  REQUIRE(view.getNumBonds() == mol.getNumBonds());
+  for (const auto atom : mol.atoms()) {
+    auto idx = atom->getIdx();
+    CHECK(view.getAtomicNum(idx) == atom->getAtomicNum());
+    CHECK(view.getIsAromatic(idx) == atom->getIsAromatic());
+    CHECK(view.getNoImplicit(idx) == atom->getNoImplicit());
+    CHECK(view.atomHasQuery(idx) == atom->hasQuery());
+    CHECK(view.getFormalCharge(idx) == atom->getFormalCharge());
+    CHECK(view.getChiralTag(idx) == atom->getChiralTag());
+    CHECK(view.getHybridization(idx) == atom->getHybridization());
+    CHECK(view.getNumExplicitHs(idx) == atom->getNumExplicitHs());
+    CHECK(view.getNumRadicalElectrons(idx) ==
+          atom->getNumRadicalElectrons());
+    CHECK(view.getIsotope(idx) == atom->getIsotope());
+    CHECK(view.getAtomMapNum(idx) == atom->getAtomMapNum());
+    if (!atom->hasQuery()) {
+      CHECK(view.getTotalNumHs(idx) == atom->getTotalNumHs());
+    }
+  }
+  for (const auto bond : mol.bonds()) {
+    auto idx = bond->getIdx();
+    CHECK(view.getBondBeginAtomIdx(idx) == bond->getBeginAtomIdx());
+    CHECK(view.getBondEndAtomIdx(idx) == bond->getEndAtomIdx());
+    CHECK(view.getBondType(idx) == bond->getBondType());
+    CHECK(view.getBondDir(idx) == bond->getBondDir());
+    CHECK(view.getBondStereo(idx) == bond->getStereo());
+    CHECK(view.getBondIsAromatic(idx) == bond->getIsAromatic());
+    CHECK(view.getBondIsConjugated(idx) == bond->getIsConjugated());
+    CHECK(view.bondHasQuery(idx) == bond->hasQuery());
+  }
+  CHECK(view.getNumConformers() == mol.getNumConformers());
+  if (mol.getRingInfo()->isInitialized()) {
+    CHECK(view.getNumRings() == mol.getRingInfo()->numRings());
+  }
+}
+}  // namespace
+
+TEST_CASE("MolPickleView") {
+  SECTION("atoms and bonds") {
+    for (const auto smi :
+         {"C", "c1ccccc1[O-]", "[13CH3:3][C@H](F)/C=C/[NH3+]",
+          "[CH2]C([2H])([2H])[Cl:200]", "C[Fe](C)(C)(C)(C)C",
+          "C1CC2CCC1CC2.c1cc[nH]c1"}) {
+      INFO(smi);
+      std::unique_ptr<RWMol> mol(SmilesToMol(smi));
+      REQUIRE(mol);
+      std::string pkl;
+      MolPickler::pickleMol(*mol, pkl);
+      MolPickleView view(pkl);
+      CHECK(view.getVersion() > 16000);
+      CHECK(!view.hasQueries());
+      RWMol mol2(pkl);
+      compareViewToMol(view, mol2);
+    }
+  }
+  SECTION("large molecules") {
+    std::string smi = "C";
+    for (unsigned int i = 0; i < 300; ++i) {
+      smi += (i % 2) ? "C" : "N";
+    }
+    smi += "[13CH2:1000]";
+    auto mol = v2::SmilesParse::MolFromSmiles(smi);
+    REQUIRE(mol);
+    std::string pkl;
+    MolPickler::pickleMol(*mol, pkl);
+    MolPickleView view(pkl);
+    RWMol mol2(pkl);
+    compareViewToMol(view, mol2);
+    CHECK(view.getAtomMapNum(301) == 1000);
+    CHECK(view.getIsotope(301) == 13);
+  }
+  SECTION("queries, sgroups, stereo groups and monomer info") {
+    auto mol =
+        "C/C=C/C[C@H](O)[C@@H](C)F |a:6,o2:4,r,SgD:5:data_pt:4.5::::|"_smiles;
+    REQUIRE(mol);
+    mol->getAtomWithIdx(0)->setMonomerInfo(
+        new AtomPDBResidueInfo(" CA ", 1, "", "ALA", 1, "A"));
+    mol->setProp("foo", 1.5);
+    std::string pkl;
+    MolPickler::pickleMol(*mol, pkl, PicklerOps::AllProps);
+    MolPickleView view(pkl);
+    RWMol mol2(pkl);
+    compareViewToMol(view, mol2);
+    CHECK(view.getProp<double>("foo") == 1.5);
+
+    auto qry = "[#6;R2]-,=[O,N;+0]-[$(C=O):3]"_smarts;
+    REQUIRE(qry);
+    qry->setProp("bar", std::string("baz"));
+    MolPickler::pickleMol(*qry, pkl, PicklerOps::AllProps);
+    MolPickleView qview(pkl);
+    CHECK(qview.hasQueries());
+    RWMol qry2(pkl);
+    compareViewToMol(qview, qry2);
+    CHECK(qview.getProp<std::string>("bar") == "baz");
+  }
+  SECTION("conformers and properties") {
+    auto mol = "OC(=O)C |(0,0,0;1,0,0;1,1,0;2,0,0)|"_smiles;
+    REQUIRE(mol);
+    auto conf = new Conformer(mol->getConformer());
+    conf->setId(3);
+    conf->getAtomPos(3).z = 1.0;
+    conf->setProp("energy", 2.5);
+    mol->addConformer(conf);
+    mol->setProp("name", std::string("acid"));
+    mol->setProp<int>("count", 12);
+    mol->getAtomWithIdx(1)->setProp<int>("atomprop", 3);
+    mol->getBondWithIdx(2)->setProp("bondprop", std::string("b"));
+    const std::vector<unsigned int> allFlags = {
+        PicklerOps::AllProps,
+        PicklerOps::AllProps | PicklerOps::CoordsAsDouble};
+    for (auto flags : allFlags) {
+      std::string pkl;
+      MolPickler::pickleMol(*mol, pkl, flags);
+      MolPickleView view(pkl);
+      CHECK(view.getNumConformers() == 2);
+      CHECK(view.hasProp("name"));
+      CHECK(view.getProp<std::string>("name") == "acid");
+      int count = 0;
+      CHECK(view.getPropIfPresent("count", count));
+      CHECK(count == 12);
+      CHECK(!view.hasProp("missing"));
+      CHECK(view.getAtomProps(1).getProp<int>("atomprop") == 3);
+      CHECK(!view.getAtomProps(0).hasProp("atomprop"));
+      CHECK(view.getBondProps(2).getProp<std::string>("bondprop") == "b");
+      CHECK(view.getConformer().getId() == 0);
+      const auto &conf2 = view.getConformer(3);
+      CHECK(conf2.getNumAtoms() == 4);
+      CHECK(conf2.getAtomPos(2).y == Catch::Approx(1.0));
+      CHECK(conf2.getAtomPos(3).z == Catch::Approx(1.0));
+      CHECK(conf2.getProp<double>("energy") == 2.5);
+      CHECK_THROWS_AS(view.getConformer(1), ConformerException);
+
+      std::unique_ptr<ROMol> mol2(view.toMol());
+      CHECK(MolToSmiles(*mol2) == MolToSmiles(*mol));
+      CHECK(mol2->getNumConformers() == 2);
+      CHECK(mol2->getProp<int>("count") == 12);
+    }
+    std::string pkl;
+    MolPickler::pickleMol(*mol, pkl, PicklerOps::NoConformers);
+    MolPickleView view(pkl);
+    CHECK(view.getNumConformers() == 0);
+    CHECK_THROWS_AS(view.getConformer(), ConformerException);
+    CHECK(!view.hasProp("name"));
+  }
+  SECTION("the view does not copy the pickle") {
+    auto mol = "CCO"_smiles;
+    REQUIRE(mol);
+    std::string pkl;
+    MolPickler::pickleMol(*mol, pkl);
+    MolPickleView view(pkl.data(), pkl.size());
+    CHECK(view.getPickle().data() == pkl.data());
+    MolPickleView view2(std::move(view));
+    CHECK(view2.getAtomicNum(2) == 8);
+  }
+  SECTION("bad pickles") {
+    auto mol = "CCO |$;;foo_p$|"_smiles;
+    REQUIRE(mol);
+    std::string pkl;
+    MolPickler::pickleMol(*mol, pkl);
+    CHECK_THROWS_AS(MolPickleView(std::string_view(pkl).substr(0, 30)),
+                    MolPicklerException);
+    CHECK_THROWS_AS(
+        MolPickleView(std::string_view(pkl).substr(0, pkl.size() - 1)),
+        MolPicklerException);
+    CHECK_THROWS_AS(MolPickleView(std::string_view(pkl).substr(4)),
+                    MolPicklerException);
+    CHECK_THROWS_AS(MolPickleView(""), MolPicklerException);
+  }
+}
@@ -12,6 +12,8 @@
 
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/QueryOps.h>
+#include <GraphMol/QueryAtom.h>
+#include <GraphMol/QueryBond.h>
 #include <GraphMol/SmilesParse/SmilesParse.h>
 
 using namespace RDKit;
@@ -102,4 +104,174 @@ TEST_CASE("range queries for atom ring membership") {
     CHECK(queryAtomIsInRingOfSize(m->getAtomWithIdx(3), 0, 4) == 4);
     CHECK(queryAtomIsInRingOfSize(m->getAtomWithIdx(5), 0, 4) == -1);
   }
-}
\ No newline at end of file
+}
+TEST_CASE("compiled queries") {
+  const std::vector<std::string> smartsList = {
+      "[#6]",
+      "[C,N;H1,H2]",
+      "[!#6;!#1]",
+      "[c;R2]",
+      "[N;X3;!$(N=O)]",
+      "[#7,#8;-,+]",
+      "[CH2;D2;r6]",
+      "[!C;!c]",
+      "[O;H1;X2]",
+      "[#6;+0;!a;D{2-3}]",
+      "[C;z{1-}]",
+      "[$(C=O),$(S=O);!R]",
+      "[*]",
+      "[a;!R1]",
+      "[#6&v4&!H0,#7&X3]",
+      "[12C,13C]",
+      "[C@H]",
+      "[#6]~[#7]",
+      "c:c-,=C",
+      "C!@C",
+      "C@;-C",
+      "[#6]-;!@[#8,#7]",
+      "C~*",
+      "C#N",
+  };
+  const std::vector<std::string> smilesList = {
+      "CC(=O)Nc1ccc(O)cc1",
+      "C[C@H](N)C(=O)O",
+      "c1ccc2c(c1)[nH]c1ccccc12",
+      "C1CC2CCC1CC2",
+      "[NH3+]CC(=O)[O-]",
+      "O=[N+]([O-])c1ccc(S(=O)(=O)N)cc1",
+      "[13CH3]C#N",
+      "FC(F)(F)Cl",
+  };
+  for (const auto &smarts : smartsList) {
+    INFO(smarts);
+    std::unique_ptr<RWMol> query(SmartsToMol(smarts));
+    REQUIRE(query);
+    std::unique_ptr<RWMol> compiled(new RWMol(*query));
+    QueryOps::compileMolQueries(*compiled);
+    for (const auto atom : compiled->atoms()) {
+      REQUIRE(atom->hasQuery());
+      CHECK(static_cast<QueryAtom *>(atom)->hasCompiledQuery());
+    }
+    for (const auto bond : compiled->bonds()) {
+      REQUIRE(bond->hasQuery());
+      CHECK(static_cast<QueryBond *>(bond)->hasCompiledQuery());
+    }
+    for (const auto &smiles : smilesList) {
+      INFO(smiles);
+      std::unique_ptr<RWMol> mol(SmilesToMol(smiles));
+      REQUIRE(mol);
+      for (const auto qatom : query->atoms()) {
+        const auto catom = compiled->getAtomWithIdx(qatom->getIdx());
+        for (const auto atom : mol->atoms()) {
+          CHECK(catom->Match(atom) == qatom->Match(atom));
+        }
+      }
+      for (const auto qbond : query->bonds()) {
+        const auto cbond = compiled->getBondWithIdx(qbond->getIdx());
+        for (const auto bond : mol->bonds()) {
+          CHECK(cbond->Match(bond) == qbond->Match(bond));
+        }
+      }
+    }
+  }
+  SECTION("program details") {
+    auto query = "[C,N;H1,H2;!$(C=O)]"_smarts;
+    REQUIRE(query);
+    auto qatom = static_cast<QueryAtom *>(query->getAtomWithIdx(0));
+    qatom->compileQuery();
+    const auto program = qatom->getCompiledQuery();
+    REQUIRE(program);
+    // C, N, H1, H2, and the recursive query
+    CHECK(program->getNumInstructions() == 5);
+    CHECK(program->getNumCalls() == 1);
+
+    // modifying the query discards the program
+    qatom->expandQuery(makeAtomAromaticQuery());
+    CHECK(!qatom->hasCompiledQuery());
+    qatom->compileQuery();
+    CHECK(qatom->hasCompiledQuery());
+    qatom->setQuery(makeAtomNumQuery(6));
+    CHECK(!qatom->hasCompiledQuery());
+  }
+  SECTION("negated composites") {
+    auto mol = "CNOc1ccccc1"_smiles;
+    REQUIRE(mol);
+    QueryAtom qatom(6);
+    qatom.expandQuery(makeAtomNumQuery(7), Queries::COMPOSITE_OR);
+    qatom.getQuery()->setNegation(true);
+    qatom.expandQuery(makeAtomAromaticQuery(), Queries::COMPOSITE_OR);
+    QueryAtom compiled(qatom);
+    compiled.compileQuery();
+    for (const auto atom : mol->atoms()) {
+      CHECK(compiled.Match(atom) == qatom.Match(atom));
+    }
+    // copies are compiled too
+    QueryAtom cp(compiled);
+    CHECK(cp.hasCompiledQuery());
+    CHECK(cp.Match(mol->getAtomWithIdx(2)));
+    CHECK(!cp.Match(mol->getAtomWithIdx(1)));
+  }
+  SECTION("modifying the query in place") {
+    auto mol = "CNO"_smiles;
+    REQUIRE(mol);
+    const auto c = mol->getAtomWithIdx(0);
+    const auto n = mol->getAtomWithIdx(1);
+    const auto o = mol->getAtomWithIdx(2);
+    QueryAtom qatom(6);
+    qatom.expandQuery(makeAtomNumQuery(7), Queries::COMPOSITE_OR);
+    qatom.compileQuery();
+    const auto program = qatom.getCompiledQuery();
+    REQUIRE(program);
+    CHECK(program->isCurrent());
+    CHECK(qatom.Match(c));
+    CHECK(qatom.Match(n));
+    CHECK(!qatom.Match(o));
+
+    // the root
+    qatom.getQuery()->setNegation(true);
+    CHECK(!program->isCurrent());
+    // Match() does not check, the program is updated on request
+    CHECK(qatom.getCompiledQuery() == program);
+    qatom.updateCompiledQuery();
+    CHECK(qatom.getCompiledQuery() != program);
+    CHECK(!qatom.Match(c));
+    CHECK(!qatom.Match(n));
+    CHECK(qatom.Match(o));
+    CHECK(qatom.getCompiledQuery()->isCurrent());
+    qatom.getQuery()->setNegation(false);
+
+    // one of the leaves
+    auto leaf = static_cast<ATOM_EQUALS_QUERY *>(
+        qatom.getQuery()->beginChildren()->get());
+    leaf->setVal(8);
+    CHECK(!qatom.getCompiledQuery()->isCurrent());
+    qatom.updateCompiledQuery();
+    CHECK(!qatom.Match(c));
+    CHECK(qatom.Match(n));
+    CHECK(qatom.Match(o));
+
+    // adding a child
+    qatom.getQuery()->addChild(
+        QueryAtom::QUERYATOM_QUERY::CHILD_TYPE(makeAtomNumQuery(6)));
+    qatom.updateCompiledQuery();
+    CHECK(qatom.Match(c));
+    CHECK(qatom.getCompiledQuery()->isCurrent());
+  }
+  SECTION("recursive queries") {
+    auto query = "[C;$(C=O)]"_smarts;
+    REQUIRE(query);
+    const auto rsq = static_cast<const RecursiveStructureQuery *>(
+        std::prev(query->getAtomWithIdx(0)->getQuery()->endChildren())
+            ->get());
+    REQUIRE(typeid(*rsq) == typeid(RecursiveStructureQuery));
+    const auto queryMol = rsq->getQueryMol();
+    QueryOps::compileMolQueries(*query);
+    // the original recursive query molecule is replaced by a compiled copy
+    CHECK(rsq->getQueryMol() != queryMol);
+    CHECK(rsq->getQueryMol()->getNumAtoms() == 2);
+    CHECK(rsq->getQueryMol()->getNumBonds() == 1);
+    for (const auto atom : rsq->getQueryMol()->atoms()) {
+      CHECK(static_cast<const QueryAtom *>(atom)->hasCompiledQuery());
+    }
+  }
+}
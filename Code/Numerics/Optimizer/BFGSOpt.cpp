@@ -9,7 +9,37 @@
 //
 
 #include "BFGSOpt.h"
+#include <atomic>
 
 namespace BFGSOpt {
 int HEAD_ONLY_LIBRARY = 0;
+
+namespace {
+SIMDLevel detectSIMDLevel() {
+#ifdef RDK_AVX_AVAILABLE
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return SIMDLevel::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return SIMDLevel::AVX2;
+  }
+#endif
+  return SIMDLevel::Scalar;
+}
+
+// the kernels sum in a different order than the scalar code, so they are
+// only used when asked for, to keep the default results unchanged
+std::atomic<int> maxSIMDLevel{static_cast<int>(SIMDLevel::Scalar)};
+}  // namespace
+
+SIMDLevel getSIMDLevel() {
+  static const SIMDLevel detected = detectSIMDLevel();
+  return static_cast<SIMDLevel>(
+      std::min(static_cast<int>(detected), maxSIMDLevel.load()));
+}
+
+void setMaxSIMDLevel(SIMDLevel level) {
+  maxSIMDLevel = static_cast<int>(level);
 }
+}  // namespace BFGSOpt
@@ -18,6 +18,7 @@
 #include <vector>
 #include <algorithm>
 #include "BFGSOpt_SVE.h"
+#include "BFGSOpt_AVX.h"
 
 namespace BFGSOpt {
 RDKIT_OPTIMIZER_EXPORT extern int HEAD_ONLY_LIBRARY;
@@ -32,6 +33,47 @@ const double TOLX =
     4. * EPS;  //!< Default direction vector tolerance in the minimizer
 const double MAXSTEP = 100.0;  //!< Default maximum step size in the minimizer
 
+namespace detail {
+//! returns the dot product of \c a and \c b
+inline double dotProduct(unsigned int dim, const double *a, const double *b) {
+#ifdef RDK_AVX_AVAILABLE
+  switch (getSIMDLevel()) {
+    case SIMDLevel::AVX512:
+      return avx512DotProduct(dim, a, b);
+    case SIMDLevel::AVX2:
+      return avx2DotProduct(dim, a, b);
+    default:
+      break;
+  }
+#endif
+  double res = 0.0;
+  for (unsigned int i = 0; i < dim; i++) {
+    res += a[i] * b[i];
+  }
+  return res;
+}
+
+//! sets \c res to <tt>x + alpha * y</tt>
+inline void addScaled(unsigned int dim, double *res, const double *x,
+                      double alpha, const double *y) {
+#ifdef RDK_AVX_AVAILABLE
+  switch (getSIMDLevel()) {
+    case SIMDLevel::AVX512:
+      avx512AddScaled(dim, res, x, alpha, y);
+      return;
+    case SIMDLevel::AVX2:
+      avx2AddScaled(dim, res, x, alpha, y);
+      return;
+    default:
+      break;
+  }
+#endif
+  for (unsigned int i = 0; i < dim; i++) {
+    res[i] = x[i] + alpha * y[i];
+  }
+}
+}  // namespace detail
+
 /*!
   See Numerical Recipes in C, Section 9.7 for a description of the algorithm.
 
@@ -67,11 +109,7 @@ void linearSearch(unsigned int dim, double *oldPt, double oldVal, double *grad,
   resCode = -1;
 
   // get the length of the direction vector:
-  sum = 0.0;
-  for (unsigned int i = 0; i < dim; i++) {
-    sum += dir[i] * dir[i];
-  }
-  sum = sqrt(sum);
+  sum = sqrt(detail::dotProduct(dim, dir, dir));
 
   // Rescale if we're trying to move too far
   if (sum > maxStep) {
@@ -82,10 +120,7 @@ void linearSearch(unsigned int dim, double *oldPt, double oldVal, double *grad,
 
   // make sure our direction has at least some component along
   // -grad
-  slope = 0.0;
-  for (unsigned int i = 0; i < dim; i++) {
-    slope += dir[i] * grad[i];
-  }
+  slope = detail::dotProduct(dim, dir, grad);
   if (slope >= 0.0) {
     return;
   }
@@ -107,9 +142,7 @@ void linearSearch(unsigned int dim, double *oldPt, double oldVal, double *grad,
       resCode = 1;
       break;
     }
-    for (unsigned int i = 0; i < dim; i++) {
-      newPt[i] = oldPt[i] + lambda * dir[i];
-    }
+    detail::addScaled(dim, newPt, oldPt, lambda, dir);
     newVal = func(newPt);
     if (newVal - oldVal <= FUNCTOL * lambda * slope) {
       // Armijo sufficient-decrease condition satisfied; accept the step
@@ -155,6 +188,134 @@ void linearSearch(unsigned int dim, double *oldPt, double oldVal, double *grad,
   }
 }
 
+namespace detail {
+//! BFGS update of the inverse Hessian
+/*!
+   \param dim        the dimensionality of the space.
+   \param invHessian the inverse Hessian (dim*dim), updated in place
+   \param xi         the last step
+   \param dGrad      the change in the gradient along the last step,
+                     used as scratch space
+   \param hessDGrad  scratch space (dim)
+*/
+inline void updateInverseHessian(unsigned int dim, double *invHessian,
+                                 double *xi, double *dGrad,
+                                 double *hessDGrad) {
+  double fac = 0, fae = 0, sumDGrad = 0, sumXi = 0;
+#ifdef RDK_SVE_AVAILABLE
+  if (cpuHasSVE()) {
+    // SVE path: matrix-vector multiply and all four dot products computed in
+    // one vectorised pass, saving two additional O(dim) traversals compared
+    // to separate scalar dot-product calls.
+    sveHessianVecMul(dim, invHessian, dGrad, hessDGrad, xi, &fac, &fae,
+                     &sumDGrad, &sumXi);
+  } else
+#endif
+#ifdef RDK_AVX_AVAILABLE
+  if (const auto level = getSIMDLevel(); level != SIMDLevel::Scalar) {
+    if (level == SIMDLevel::AVX512) {
+      avx512HessianVecMul(dim, invHessian, dGrad, hessDGrad, xi, &fac, &fae,
+                          &sumDGrad, &sumXi);
+    } else {
+      avx2HessianVecMul(dim, invHessian, dGrad, hessDGrad, xi, &fac, &fae,
+                        &sumDGrad, &sumXi);
+    }
+  } else
+#endif
+  {
+    // Scalar path: fused matrix-vector multiply and dot-product accumulation.
+    // Pointer arithmetic (++ivh, ++dgj) avoids repeated index computations
+    // and helps the compiler generate efficient load sequences.
+    for (unsigned int i = 0; i < dim; i++) {
+      double *ivh = &(invHessian[i * dim]);
+      double &hdgradi = hessDGrad[i];
+      double *dgj = dGrad;
+      hdgradi = 0.0;
+      for (unsigned int j = 0; j < dim; ++j, ++ivh, ++dgj) {
+        hdgradi += *ivh * *dgj;
+      }
+      fac += dGrad[i] * xi[i];
+      fae += dGrad[i] * hessDGrad[i];
+      sumDGrad += dGrad[i] * dGrad[i];
+      sumXi += xi[i] * xi[i];
+    }
+  }
+  if (fac > sqrt(EPS * sumDGrad * sumXi)) {
+    fac = 1.0 / fac;
+    double fad = 1.0 / fae;
+    for (unsigned int i = 0; i < dim; i++) {
+      dGrad[i] = fac * xi[i] - fad * hessDGrad[i];
+    }
+
+#ifdef RDK_SVE_AVAILABLE
+    if (cpuHasSVE()) {
+      // SVE path: symmetric rank-1 update with FMA, exploiting symmetry to
+      // halve memory writes and FLOPs versus a full-matrix update
+      sveHessianRank1Update(dim, invHessian, xi, hessDGrad, dGrad, fac, fad,
+                            fae);
+    } else
+#endif
+#ifdef RDK_AVX_AVAILABLE
+    if (const auto level = getSIMDLevel(); level != SIMDLevel::Scalar) {
+      if (level == SIMDLevel::AVX512) {
+        avx512HessianRank1Update(dim, invHessian, xi, hessDGrad, dGrad, fac,
+                                 fad, fae);
+      } else {
+        avx2HessianRank1Update(dim, invHessian, xi, hessDGrad, dGrad, fac,
+                               fad, fae);
+      }
+    } else
+#endif
+    {
+      // Scalar path: upper-triangle-only update (j >= i) followed by
+      // explicit symmetrisation. This halves the number of Hessian writes
+      // at the cost of one additional pass over a row to mirror elements.
+      for (unsigned int i = 0; i < dim; i++) {
+        unsigned int itab = i * dim;
+        double pxi = fac * xi[i], hdgi = fad * hessDGrad[i],
+               dgi = fae * dGrad[i];
+        double *pxj = &(xi[i]), *hdgj = &(hessDGrad[i]), *dgj = &(dGrad[i]);
+        for (unsigned int j = i; j < dim; ++j, ++pxj, ++hdgj, ++dgj) {
+          invHessian[itab + j] += pxi * *pxj - hdgi * *hdgj + dgi * *dgj;
+          invHessian[j * dim + i] = invHessian[itab + j];
+        }
+      }
+    }
+  }
+}
+
+//! sets the new search direction: xi = -invHessian * grad
+inline void setSearchDirection(unsigned int dim, const double *invHessian,
+                               const double *grad, double *xi) {
+#ifdef RDK_SVE_AVAILABLE
+  if (cpuHasSVE()) {
+    sveHessianVecMulNeg(dim, invHessian, grad, xi);
+  } else
+#endif
+#ifdef RDK_AVX_AVAILABLE
+  if (const auto level = getSIMDLevel(); level != SIMDLevel::Scalar) {
+    if (level == SIMDLevel::AVX512) {
+      avx512HessianVecMulNeg(dim, invHessian, grad, xi);
+    } else {
+      avx2HessianVecMulNeg(dim, invHessian, grad, xi);
+    }
+  } else
+#endif
+  {
+    for (unsigned int i = 0; i < dim; i++) {
+      unsigned int itab = i * dim;
+      xi[i] = 0.0;
+      double &pxi = xi[i];
+      const double *ivh = &(invHessian[itab]);
+      const double *gj = grad;
+      for (unsigned int j = 0; j < dim; ++j, ++ivh, ++gj) {
+        pxi -= *ivh * *gj;
+      }
+    }
+  }
+}
+}  // namespace detail
+
 //! Do a BFGS minimization of a function.
 /*!
    See Numerical Recipes in C, Section 10.7 for a description of the algorithm.
@@ -211,6 +372,16 @@ int minimize(unsigned int dim, double *pos, double gradTol,
     sveInitXiAndSum(dim, grad.data(), xi.data(), pos, &sum);
     for (unsigned int i = 0; i < dim; i++) invHessian[i * dim + i] = 1.0;
   } else
+#endif
+#ifdef RDK_AVX_AVAILABLE
+  if (const auto level = getSIMDLevel(); level != SIMDLevel::Scalar) {
+    if (level == SIMDLevel::AVX512) {
+      avx512InitXiAndSum(dim, grad.data(), xi.data(), pos, &sum);
+    } else {
+      avx2InitXiAndSum(dim, grad.data(), xi.data(), pos, &sum);
+    }
+    for (unsigned int i = 0; i < dim; i++) invHessian[i * dim + i] = 1.0;
+  } else
 #endif
   {
     // Scalar path: initialise the inverse Hessian to the identity matrix,
@@ -279,83 +450,10 @@ int minimize(unsigned int dim, double *pos, double gradTol,
     }
 
     // BFGS inverse Hessian update.
-    double fac = 0, fae = 0, sumDGrad = 0, sumXi = 0;
-#ifdef RDK_SVE_AVAILABLE
-    if (cpuHasSVE()) {
-      // SVE path: matrix-vector multiply and all four dot products computed in
-      // one vectorised pass, saving two additional O(dim) traversals compared
-      // to separate scalar dot-product calls.
-      sveHessianVecMul(dim, invHessian.data(), dGrad.data(), hessDGrad.data(),
-                       xi.data(), &fac, &fae, &sumDGrad, &sumXi);
-    } else
-#endif
-    {
-      // Scalar path: fused matrix-vector multiply and dot-product accumulation.
-      // Pointer arithmetic (++ivh, ++dgj) avoids repeated index computations
-      // and helps the compiler generate efficient load sequences.
-      for (unsigned int i = 0; i < dim; i++) {
-        double *ivh = &(invHessian[i * dim]);
-        double &hdgradi = hessDGrad[i];
-        double *dgj = dGrad.data();
-        hdgradi = 0.0;
-        for (unsigned int j = 0; j < dim; ++j, ++ivh, ++dgj) {
-          hdgradi += *ivh * *dgj;
-        }
-        fac += dGrad[i] * xi[i];
-        fae += dGrad[i] * hessDGrad[i];
-        sumDGrad += dGrad[i] * dGrad[i];
-        sumXi += xi[i] * xi[i];
-      }
-    }
-    if (fac > sqrt(EPS * sumDGrad * sumXi)) {
-      fac = 1.0 / fac;
-      double fad = 1.0 / fae;
-      for (unsigned int i = 0; i < dim; i++) {
-        dGrad[i] = fac * xi[i] - fad * hessDGrad[i];
-      }
-
-#ifdef RDK_SVE_AVAILABLE
-      if (cpuHasSVE()) {
-        // SVE path: symmetric rank-1 update with FMA, exploiting symmetry to
-        // halve memory writes and FLOPs versus a full-matrix update
-        sveHessianRank1Update(dim, invHessian.data(), xi.data(),
-                              hessDGrad.data(), dGrad.data(), fac, fad, fae);
-      } else
-#endif
-      {
-        // Scalar path: upper-triangle-only update (j >= i) followed by
-        // explicit symmetrisation. This halves the number of Hessian writes
-        // at the cost of one additional pass over a row to mirror elements.
-        for (unsigned int i = 0; i < dim; i++) {
-          unsigned int itab = i * dim;
-          double pxi = fac * xi[i], hdgi = fad * hessDGrad[i],
-                 dgi = fae * dGrad[i];
-          double *pxj = &(xi[i]), *hdgj = &(hessDGrad[i]), *dgj = &(dGrad[i]);
-          for (unsigned int j = i; j < dim; ++j, ++pxj, ++hdgj, ++dgj) {
-            invHessian[itab + j] += pxi * *pxj - hdgi * *hdgj + dgi * *dgj;
-            invHessian[j * dim + i] = invHessian[itab + j];
-          }
-        }
-      }
-    }
+    detail::updateInverseHessian(dim, invHessian.data(), xi.data(),
+                                 dGrad.data(), hessDGrad.data());
+    detail::setSearchDirection(dim, invHessian.data(), grad.data(), xi.data());
 
-#ifdef RDK_SVE_AVAILABLE
-    if (cpuHasSVE()) {
-      sveHessianVecMulNeg(dim, invHessian.data(), grad.data(), xi.data());
-    } else
-#endif
-    {
-      for (unsigned int i = 0; i < dim; i++) {
-        unsigned int itab = i * dim;
-        xi[i] = 0.0;
-        double &pxi = xi[i];
-        double *ivh = &(invHessian[itab]);
-        double *gj = grad.data();
-        for (unsigned int j = 0; j < dim; ++j, ++ivh, ++gj) {
-          pxi -= *ivh * *gj;
-        }
-      }
-    }
     if (snapshotVect && snapshotFreq && !(iter % snapshotFreq)) {
       RDKit::Snapshot s(boost::shared_array<double>(newPos.release()), fp);
       snapshotVect->push_back(s);
@@ -0,0 +1,396 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#ifndef RD_BFGSOPTBATCH_H
+#define RD_BFGSOPTBATCH_H
+
+#include "BFGSOpt.h"
+
+namespace BFGSOpt {
+namespace detail {
+//! the state of one problem being minimized by minimizeBatch()
+struct BatchBFGSLane {
+  enum class Stage {
+    Idle,        //!< no problem assigned
+    InitEnergy,  //!< needs the energy at the starting position
+    InitGrad,    //!< needs the gradient at the starting position
+    LineSearch,  //!< needs the energy at the line search trial point
+    Grad         //!< needs the gradient at the end of a line search
+  };
+  Stage stage = Stage::Idle;
+  unsigned int prob = 0;
+  double *pos = nullptr;
+  std::vector<double> grad, dGrad, hessDGrad, xi, invHessian, newPos;
+  double fp = 0.0;
+  double funcVal = 0.0;
+  double maxStep = 0.0;
+  unsigned int iter = 0;
+  // line search state, see linearSearch()
+  double slope = 0.0;
+  double lambda = 0.0;
+  double lambda2 = 0.0;
+  double lambdaMin = 0.0;
+  double val2 = 0.0;
+  unsigned int lsIter = 0;
+
+  explicit BatchBFGSLane(unsigned int dim)
+      : grad(dim),
+        dGrad(dim),
+        hessDGrad(dim),
+        xi(dim),
+        invHessian(dim * dim),
+        newPos(dim) {}
+
+  //! sets up a line search along xi, returns false if the direction is bad
+  bool startLineSearch(unsigned int dim) {
+    double sum = sqrt(dotProduct(dim, xi.data(), xi.data()));
+    if (sum > maxStep) {
+      for (unsigned int i = 0; i < dim; i++) {
+        xi[i] *= maxStep / sum;
+      }
+    }
+    slope = dotProduct(dim, xi.data(), grad.data());
+    if (slope >= 0.0) {
+      return false;
+    }
+    double test = 0.0;
+    for (unsigned int i = 0; i < dim; i++) {
+      double temp = fabs(xi[i]) / std::max(fabs(pos[i]), 1.0);
+      if (temp > test) {
+        test = temp;
+      }
+    }
+    lambdaMin = MOVETOL / test;
+    lambda = 1.0;
+    lsIter = 0;
+    return true;
+  }
+
+  //! sets the next trial point of the line search
+  /*!
+    \return 1 if the energy of newPos is needed, 0 if the search is done
+      (newPos was reset to pos), -1 if the search failed
+  */
+  int nextTrialPoint(unsigned int dim) {
+    const unsigned int MAX_ITER_LINEAR_SEARCH = 1000;
+    if (lsIter >= MAX_ITER_LINEAR_SEARCH || lambda < lambdaMin) {
+      for (unsigned int i = 0; i < dim; i++) {
+        newPos[i] = pos[i];
+      }
+      return lsIter >= MAX_ITER_LINEAR_SEARCH ? -1 : 0;
+    }
+    addScaled(dim, newPos.data(), pos, lambda, xi.data());
+    return 1;
+  }
+
+  //! processes the energy at the trial point
+  /*!
+    \return true if the trial point was accepted
+  */
+  bool acceptTrialPoint(double newVal) {
+    funcVal = newVal;
+    if (newVal - fp <= FUNCTOL * lambda * slope) {
+      return true;
+    }
+    double tmpLambda;
+    if (lsIter == 0) {
+      tmpLambda = -slope / (2.0 * (newVal - fp - slope));
+    } else {
+      double rhs1 = newVal - fp - lambda * slope;
+      double rhs2 = val2 - fp - lambda2 * slope;
+      double a = (rhs1 / (lambda * lambda) - rhs2 / (lambda2 * lambda2)) /
+                 (lambda - lambda2);
+      double b = (-lambda2 * rhs1 / (lambda * lambda) +
+                  lambda * rhs2 / (lambda2 * lambda2)) /
+                 (lambda - lambda2);
+      if (a == 0.0) {
+        tmpLambda = -slope / (2.0 * b);
+      } else {
+        double disc = b * b - 3 * a * slope;
+        if (disc < 0.0) {
+          tmpLambda = 0.5 * lambda;
+        } else if (b <= 0.0) {
+          tmpLambda = (-b + sqrt(disc)) / (3.0 * a);
+        } else {
+          tmpLambda = -slope / (b + sqrt(disc));
+        }
+      }
+      if (tmpLambda > 0.5 * lambda) {
+        tmpLambda = 0.5 * lambda;
+      }
+    }
+    lambda2 = lambda;
+    val2 = newVal;
+    lambda = std::max(tmpLambda, 0.1 * lambda);
+    ++lsIter;
+    return false;
+  }
+
+  //! moves to the end point of the line search
+  /*!
+    \return true if the step was small enough to stop
+  */
+  bool takeStep(unsigned int dim) {
+    fp = funcVal;
+    double test = 0.0;
+    for (unsigned int i = 0; i < dim; i++) {
+      xi[i] = newPos[i] - pos[i];
+      pos[i] = newPos[i];
+      double temp = fabs(xi[i]) / std::max(fabs(pos[i]), 1.0);
+      if (temp > test) {
+        test = temp;
+      }
+      dGrad[i] = grad[i];
+    }
+    return test < TOLX;
+  }
+
+  //! processes the gradient at the new position
+  /*!
+    \return true if the gradient criterion for convergence was met
+  */
+  bool updateFromGradient(unsigned int dim, double gradScale,
+                          double gradTol) {
+    double test = 0.0;
+    double term = std::max(fabs(funcVal) * gradScale, 1.0);
+    for (unsigned int i = 0; i < dim; i++) {
+      double temp = fabs(grad[i]) * std::max(fabs(pos[i]), 1.0);
+      test = std::max(test, temp);
+      dGrad[i] = grad[i] - dGrad[i];
+    }
+    test /= term;
+    if (test < gradTol) {
+      return true;
+    }
+    updateInverseHessian(dim, invHessian.data(), xi.data(), dGrad.data(),
+                         hessDGrad.data());
+    setSearchDirection(dim, invHessian.data(), grad.data(), xi.data());
+    return false;
+  }
+};
+}  // namespace detail
+
+//! Do BFGS minimizations of several functions in lockstep.
+/*!
+   Each problem follows exactly the same sequence of steps as it would
+   with minimize(), but the function and gradient evaluations of the
+   problems which are in flight are requested together. This allows
+   functions which can evaluate several points in one pass (e.g. the
+   energies of several conformers of a molecule) to do so.
+
+   At most \c batchSize problems are in flight at any time; as soon as one
+   of them converges, the next problem takes its place.
+
+   \param dim       the dimensionality of the space.
+   \param numProbs  the number of problems
+   \param pos       the starting positions of the problems, each of them
+                    \c dim long. Used to return the final positions.
+   \param gradTol   tolerance for gradient convergence
+   \param func      calculates the function values of a set of points:
+                    <tt>func(n, probs, points, vals)</tt> where \c probs
+                    holds the indices of the \c n problems the points
+                    belong to, \c points is an array of \c n pointers to
+                    positions and \c vals receives the \c n values.
+   \param gradFunc  calculates the gradients of a set of points:
+                    <tt>gradFunc(n, probs, points, grads, gradScales)</tt>
+                    where \c grads is an array of \c n pointers to the
+                    gradients and \c gradScales receives the \c n values
+                    that minimize() expects the gradient functor to
+                    return.
+
+   <b>Note:</b>
+     the set of problems in flight changes as problems converge, so
+     functors which keep state for each problem (like neighbor lists)
+     should key it by the indices in \c probs rather than by position in
+     the batch.
+   \param funcTol   tolerance for changes in the function value for
+                    convergence.
+   \param maxIts    maximum number of iterations allowed
+   \param batchSize maximum number of problems in flight; every one of them
+                    needs \c dim*dim doubles for its inverse Hessian.
+   \param numIters  (optional) used to return the number of iterations
+                    required for each problem
+
+   \return a flag for each problem, with the same meaning as the value
+           returned by minimize()
+*/
+template <typename BatchEnergyFunctor, typename BatchGradientFunctor>
+std::vector<int> minimizeBatch(unsigned int dim, unsigned int numProbs,
+                               double *const *pos, double gradTol,
+                               BatchEnergyFunctor func,
+                               BatchGradientFunctor gradFunc,
+                               double funcTol = TOLX,
+                               unsigned int maxIts = MAXITS,
+                               unsigned int batchSize = 16,
+                               std::vector<unsigned int> *numIters = nullptr) {
+  RDUNUSED_PARAM(funcTol);
+  PRECONDITION(!numProbs || pos, "bad input array");
+  PRECONDITION(gradTol > 0, "bad tolerance");
+  PRECONDITION(batchSize > 0, "bad batch size");
+  using Lane = detail::BatchBFGSLane;
+  using Stage = Lane::Stage;
+
+  std::vector<int> res(numProbs, 1);
+  if (numIters) {
+    numIters->assign(numProbs, 0);
+  }
+  if (!numProbs) {
+    return res;
+  }
+  std::vector<Lane> lanes(std::min(batchSize, numProbs), Lane(dim));
+  unsigned int nextProb = 0;
+  auto loadNextProblem = [&](Lane &lane) {
+    if (nextProb < numProbs) {
+      lane.prob = nextProb++;
+      lane.pos = pos[lane.prob];
+      lane.stage = Stage::InitEnergy;
+    } else {
+      lane.stage = Stage::Idle;
+    }
+  };
+  auto finish = [&](Lane &lane, int code) {
+    res[lane.prob] = code;
+    if (numIters) {
+      (*numIters)[lane.prob] = lane.iter;
+    }
+    loadNextProblem(lane);
+  };
+  // runs the line search of a lane until it needs an energy; when the
+  // search is done, the lane moves on to waiting for its gradient
+  auto advanceLineSearch = [&](Lane &lane, bool haveVal, double val) {
+    if (haveVal && lane.acceptTrialPoint(val)) {
+      if (lane.takeStep(dim)) {
+        finish(lane, 0);
+      } else {
+        lane.stage = Stage::Grad;
+      }
+      return;
+    }
+    int status = lane.nextTrialPoint(dim);
+    CHECK_INVARIANT(status >= 0, "bad direction in linearSearch");
+    if (status == 1) {
+      lane.stage = Stage::LineSearch;
+    } else if (lane.takeStep(dim)) {
+      finish(lane, 0);
+    } else {
+      lane.stage = Stage::Grad;
+    }
+  };
+  auto startIteration = [&](Lane &lane) {
+    CHECK_INVARIANT(lane.startLineSearch(dim),
+                    "bad direction in linearSearch");
+    advanceLineSearch(lane, false, 0.0);
+  };
+
+  for (auto &lane : lanes) {
+    loadNextProblem(lane);
+  }
+  std::vector<Lane *> active;
+  std::vector<unsigned int> probs;
+  std::vector<double *> points;
+  std::vector<double *> grads;
+  std::vector<double> vals;
+  active.reserve(lanes.size());
+  probs.reserve(lanes.size());
+  points.reserve(lanes.size());
+  grads.reserve(lanes.size());
+  vals.reserve(lanes.size());
+  while (true) {
+    // the lanes which need energies:
+    active.clear();
+    probs.clear();
+    points.clear();
+    for (auto &lane : lanes) {
+      if (lane.stage == Stage::InitEnergy) {
+        points.push_back(lane.pos);
+      } else if (lane.stage == Stage::LineSearch) {
+        points.push_back(lane.newPos.data());
+      } else {
+        continue;
+      }
+      active.push_back(&lane);
+      probs.push_back(lane.prob);
+    }
+    if (!active.empty()) {
+      vals.resize(active.size());
+      func(static_cast<unsigned int>(active.size()), probs.data(),
+           points.data(), vals.data());
+      for (unsigned int i = 0; i < active.size(); ++i) {
+        auto &lane = *active[i];
+        if (lane.stage == Stage::InitEnergy) {
+          lane.fp = vals[i];
+          lane.stage = Stage::InitGrad;
+        } else {
+          advanceLineSearch(lane, true, vals[i]);
+        }
+      }
+    }
+
+    // the lanes which need gradients:
+    active.clear();
+    probs.clear();
+    points.clear();
+    grads.clear();
+    for (auto &lane : lanes) {
+      if (lane.stage == Stage::InitGrad || lane.stage == Stage::Grad) {
+        active.push_back(&lane);
+        probs.push_back(lane.prob);
+        points.push_back(lane.pos);
+        grads.push_back(lane.grad.data());
+      }
+    }
+    if (!active.empty()) {
+      vals.resize(active.size());
+      gradFunc(static_cast<unsigned int>(active.size()), probs.data(),
+               points.data(), grads.data(), vals.data());
+      for (unsigned int i = 0; i < active.size(); ++i) {
+        auto &lane = *active[i];
+        if (lane.stage == Stage::InitGrad) {
+          double sum = 0.0;
+          std::fill(lane.invHessian.begin(), lane.invHessian.end(), 0.0);
+          for (unsigned int j = 0; j < dim; j++) {
+            lane.invHessian[j * dim + j] = 1.0;
+            lane.xi[j] = -lane.grad[j];
+            sum += lane.pos[j] * lane.pos[j];
+          }
+          lane.maxStep =
+              MAXSTEP * std::max(sqrt(sum), static_cast<double>(dim));
+          lane.funcVal = 0.0;
+          lane.iter = 0;
+          if (!maxIts) {
+            finish(lane, 1);
+            continue;
+          }
+        } else if (lane.updateFromGradient(dim, vals[i], gradTol)) {
+          finish(lane, 0);
+          continue;
+        } else if (lane.iter >= maxIts) {
+          finish(lane, 1);
+          continue;
+        }
+        ++lane.iter;
+        startIteration(lane);
+      }
+    }
+
+    bool done = true;
+    for (const auto &lane : lanes) {
+      if (lane.stage != Stage::Idle) {
+        done = false;
+        break;
+      }
+    }
+    if (done) {
+      break;
+    }
+  }
+  return res;
+}
+}  // namespace BFGSOpt
+#endif  // RD_BFGSOPTBATCH_H
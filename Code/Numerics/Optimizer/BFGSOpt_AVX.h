@@ -0,0 +1,317 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#ifndef RDKIT_NUMERICS_OPTIMIZER_BFGSOPT_AVX_H
+#define RDKIT_NUMERICS_OPTIMIZER_BFGSOPT_AVX_H
+
+#include <RDGeneral/export.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define RDK_AVX_AVAILABLE 1
+#endif
+
+namespace BFGSOpt {
+//! the x86 instruction sets the minimizer kernels can use
+enum class SIMDLevel : int {
+  Scalar = 0,
+  AVX2 = 1,
+  AVX512 = 2
+};
+
+//! returns the instruction set the minimizer kernels currently use
+RDKIT_OPTIMIZER_EXPORT SIMDLevel getSIMDLevel();
+
+//! sets the highest instruction set the minimizer kernels may use
+/*!
+  The default is SIMDLevel::Scalar, so the vectorized kernels are opt-in:
+  they sum in a different order than the scalar code, which changes the
+  results of minimizations in the last few bits, and those differences can
+  grow over the iterations. The kernels never use instructions the CPU does
+  not support, so setting a higher level than is available uses the best
+  one the CPU has.
+*/
+RDKIT_OPTIMIZER_EXPORT void setMaxSIMDLevel(SIMDLevel level);
+
+#ifdef RDK_AVX_AVAILABLE
+
+#define RDK_AVX2_TARGET __attribute__((target("avx2,fma")))
+#define RDK_AVX512_TARGET __attribute__((target("avx512f")))
+
+// ---------------------------------------------------------------------------
+// AVX2 kernels. These process four doubles per instruction and finish the
+// last (dim % 4) elements with scalar code.
+// ---------------------------------------------------------------------------
+RDK_AVX2_TARGET static inline double avx2HorizontalSum(__m256d v) {
+  __m128d lo = _mm256_castpd256_pd128(v);
+  lo = _mm_add_pd(lo, _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+RDK_AVX2_TARGET static inline double avx2DotProduct(unsigned int dim,
+                                                    const double *a,
+                                                    const double *b) {
+  // two accumulators hide the latency of the FMAs
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  unsigned int i = 0;
+  for (; i + 8 <= dim; i += 8) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i),
+                           acc0);
+    acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4),
+                           _mm256_loadu_pd(b + i + 4), acc1);
+  }
+  if (i + 4 <= dim) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i),
+                           acc0);
+    i += 4;
+  }
+  double res = avx2HorizontalSum(_mm256_add_pd(acc0, acc1));
+  for (; i < dim; ++i) {
+    res += a[i] * b[i];
+  }
+  return res;
+}
+
+//! res = x + alpha * y
+RDK_AVX2_TARGET static inline void avx2AddScaled(unsigned int dim, double *res,
+                                                 const double *x, double alpha,
+                                                 const double *y) {
+  const __m256d va = _mm256_set1_pd(alpha);
+  unsigned int i = 0;
+  for (; i + 4 <= dim; i += 4) {
+    _mm256_storeu_pd(res + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(y + i),
+                                              _mm256_loadu_pd(x + i)));
+  }
+  for (; i < dim; ++i) {
+    res[i] = x[i] + alpha * y[i];
+  }
+}
+
+RDK_AVX2_TARGET static void avx2InitXiAndSum(unsigned int dim,
+                                             const double *grad, double *xi,
+                                             const double *pos,
+                                             double *outSum) {
+  const __m256d zero = _mm256_setzero_pd();
+  __m256d acc = _mm256_setzero_pd();
+  unsigned int i = 0;
+  for (; i + 4 <= dim; i += 4) {
+    _mm256_storeu_pd(xi + i, _mm256_sub_pd(zero, _mm256_loadu_pd(grad + i)));
+    const __m256d p = _mm256_loadu_pd(pos + i);
+    acc = _mm256_fmadd_pd(p, p, acc);
+  }
+  double sum = avx2HorizontalSum(acc);
+  for (; i < dim; ++i) {
+    xi[i] = -grad[i];
+    sum += pos[i] * pos[i];
+  }
+  *outSum = sum;
+}
+
+// hessDGrad = invHessian * dGrad plus the four dot products needed by the
+// BFGS update, see sveHessianVecMul()
+RDK_AVX2_TARGET static void avx2HessianVecMul(
+    unsigned int dim, const double *invHessian, const double *dGrad,
+    double *hessDGrad, const double *xi, double *outFac, double *outFae,
+    double *outSumDGrad, double *outSumXi) {
+  for (unsigned int i = 0; i < dim; i++) {
+    hessDGrad[i] = avx2DotProduct(dim, invHessian + i * dim, dGrad);
+  }
+  __m256d vFac = _mm256_setzero_pd(), vFae = _mm256_setzero_pd();
+  __m256d vSDG = _mm256_setzero_pd(), vSXi = _mm256_setzero_pd();
+  unsigned int i = 0;
+  for (; i + 4 <= dim; i += 4) {
+    const __m256d vdg = _mm256_loadu_pd(dGrad + i);
+    const __m256d vxi = _mm256_loadu_pd(xi + i);
+    const __m256d vhd = _mm256_loadu_pd(hessDGrad + i);
+    vFac = _mm256_fmadd_pd(vdg, vxi, vFac);
+    vFae = _mm256_fmadd_pd(vdg, vhd, vFae);
+    vSDG = _mm256_fmadd_pd(vdg, vdg, vSDG);
+    vSXi = _mm256_fmadd_pd(vxi, vxi, vSXi);
+  }
+  double fac = avx2HorizontalSum(vFac), fae = avx2HorizontalSum(vFae);
+  double sumDGrad = avx2HorizontalSum(vSDG), sumXi = avx2HorizontalSum(vSXi);
+  for (; i < dim; ++i) {
+    fac += dGrad[i] * xi[i];
+    fae += dGrad[i] * hessDGrad[i];
+    sumDGrad += dGrad[i] * dGrad[i];
+    sumXi += xi[i] * xi[i];
+  }
+  *outFac = fac;
+  *outFae = fae;
+  *outSumDGrad = sumDGrad;
+  *outSumXi = sumXi;
+}
+
+// symmetric rank-1 update of the inverse Hessian, only the upper triangle is
+// computed and then mirrored, see sveHessianRank1Update()
+RDK_AVX2_TARGET static void avx2HessianRank1Update(
+    unsigned int dim, double *invHessian, const double *xi,
+    const double *hessDGrad, const double *dGrad, double fac, double fad,
+    double fae) {
+  for (unsigned int i = 0; i < dim; i++) {
+    const double pxi = fac * xi[i], hdgi = fad * hessDGrad[i],
+                 dgi = fae * dGrad[i];
+    const __m256d vpxi = _mm256_set1_pd(pxi);
+    const __m256d vhdgi = _mm256_set1_pd(hdgi);
+    const __m256d vdgi = _mm256_set1_pd(dgi);
+    double *row = invHessian + i * dim;
+    unsigned int j = i;
+    for (; j + 4 <= dim; j += 4) {
+      __m256d vh = _mm256_loadu_pd(row + j);
+      vh = _mm256_fmadd_pd(vpxi, _mm256_loadu_pd(xi + j), vh);
+      vh = _mm256_fnmadd_pd(vhdgi, _mm256_loadu_pd(hessDGrad + j), vh);
+      vh = _mm256_fmadd_pd(vdgi, _mm256_loadu_pd(dGrad + j), vh);
+      _mm256_storeu_pd(row + j, vh);
+    }
+    for (; j < dim; ++j) {
+      row[j] += pxi * xi[j] - hdgi * hessDGrad[j] + dgi * dGrad[j];
+    }
+    for (unsigned int j2 = i + 1; j2 < dim; j2++) {
+      invHessian[j2 * dim + i] = row[j2];
+    }
+  }
+}
+
+// xi = -(invHessian * grad)
+RDK_AVX2_TARGET static void avx2HessianVecMulNeg(unsigned int dim,
+                                                 const double *invHessian,
+                                                 const double *grad,
+                                                 double *xi) {
+  for (unsigned int i = 0; i < dim; i++) {
+    xi[i] = -avx2DotProduct(dim, invHessian + i * dim, grad);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// AVX-512 kernels. These process eight doubles per instruction; the tail of
+// each loop is handled with a masked load/store rather than scalar code.
+// ---------------------------------------------------------------------------
+RDK_AVX512_TARGET static inline __mmask8 avx512TailMask(unsigned int n) {
+  return n >= 8 ? static_cast<__mmask8>(0xFF)
+                : static_cast<__mmask8>((1u << n) - 1);
+}
+
+RDK_AVX512_TARGET static inline double avx512DotProduct(unsigned int dim,
+                                                        const double *a,
+                                                        const double *b) {
+  __m512d acc0 = _mm512_setzero_pd();
+  __m512d acc1 = _mm512_setzero_pd();
+  unsigned int i = 0;
+  for (; i + 16 <= dim; i += 16) {
+    acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i),
+                           acc0);
+    acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8),
+                           _mm512_loadu_pd(b + i + 8), acc1);
+  }
+  for (; i < dim; i += 8) {
+    const __mmask8 m = avx512TailMask(dim - i);
+    acc0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a + i),
+                           _mm512_maskz_loadu_pd(m, b + i), acc0);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+RDK_AVX512_TARGET static inline void avx512AddScaled(unsigned int dim,
+                                                     double *res,
+                                                     const double *x,
+                                                     double alpha,
+                                                     const double *y) {
+  const __m512d va = _mm512_set1_pd(alpha);
+  for (unsigned int i = 0; i < dim; i += 8) {
+    const __mmask8 m = avx512TailMask(dim - i);
+    _mm512_mask_storeu_pd(
+        res + i, m,
+        _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, y + i),
+                        _mm512_maskz_loadu_pd(m, x + i)));
+  }
+}
+
+RDK_AVX512_TARGET static void avx512InitXiAndSum(unsigned int dim,
+                                                 const double *grad,
+                                                 double *xi, const double *pos,
+                                                 double *outSum) {
+  const __m512d zero = _mm512_setzero_pd();
+  __m512d acc = _mm512_setzero_pd();
+  for (unsigned int i = 0; i < dim; i += 8) {
+    const __mmask8 m = avx512TailMask(dim - i);
+    _mm512_mask_storeu_pd(
+        xi + i, m, _mm512_sub_pd(zero, _mm512_maskz_loadu_pd(m, grad + i)));
+    const __m512d p = _mm512_maskz_loadu_pd(m, pos + i);
+    acc = _mm512_fmadd_pd(p, p, acc);
+  }
+  *outSum = _mm512_reduce_add_pd(acc);
+}
+
+RDK_AVX512_TARGET static void avx512HessianVecMul(
+    unsigned int dim, const double *invHessian, const double *dGrad,
+    double *hessDGrad, const double *xi, double *outFac, double *outFae,
+    double *outSumDGrad, double *outSumXi) {
+  for (unsigned int i = 0; i < dim; i++) {
+    hessDGrad[i] = avx512DotProduct(dim, invHessian + i * dim, dGrad);
+  }
+  __m512d vFac = _mm512_setzero_pd(), vFae = _mm512_setzero_pd();
+  __m512d vSDG = _mm512_setzero_pd(), vSXi = _mm512_setzero_pd();
+  for (unsigned int i = 0; i < dim; i += 8) {
+    const __mmask8 m = avx512TailMask(dim - i);
+    const __m512d vdg = _mm512_maskz_loadu_pd(m, dGrad + i);
+    const __m512d vxi = _mm512_maskz_loadu_pd(m, xi + i);
+    const __m512d vhd = _mm512_maskz_loadu_pd(m, hessDGrad + i);
+    vFac = _mm512_fmadd_pd(vdg, vxi, vFac);
+    vFae = _mm512_fmadd_pd(vdg, vhd, vFae);
+    vSDG = _mm512_fmadd_pd(vdg, vdg, vSDG);
+    vSXi = _mm512_fmadd_pd(vxi, vxi, vSXi);
+  }
+  *outFac = _mm512_reduce_add_pd(vFac);
+  *outFae = _mm512_reduce_add_pd(vFae);
+  *outSumDGrad = _mm512_reduce_add_pd(vSDG);
+  *outSumXi = _mm512_reduce_add_pd(vSXi);
+}
+
+RDK_AVX512_TARGET static void avx512HessianRank1Update(
+    unsigned int dim, double *invHessian, const double *xi,
+    const double *hessDGrad, const double *dGrad, double fac, double fad,
+    double fae) {
+  for (unsigned int i = 0; i < dim; i++) {
+    const __m512d vpxi = _mm512_set1_pd(fac * xi[i]);
+    const __m512d vhdgi = _mm512_set1_pd(fad * hessDGrad[i]);
+    const __m512d vdgi = _mm512_set1_pd(fae * dGrad[i]);
+    double *row = invHessian + i * dim;
+    for (unsigned int j = i; j < dim; j += 8) {
+      const __mmask8 m = avx512TailMask(dim - j);
+      __m512d vh = _mm512_maskz_loadu_pd(m, row + j);
+      vh = _mm512_fmadd_pd(vpxi, _mm512_maskz_loadu_pd(m, xi + j), vh);
+      vh = _mm512_fnmadd_pd(vhdgi, _mm512_maskz_loadu_pd(m, hessDGrad + j),
+                            vh);
+      vh = _mm512_fmadd_pd(vdgi, _mm512_maskz_loadu_pd(m, dGrad + j), vh);
+      _mm512_mask_storeu_pd(row + j, m, vh);
+    }
+    for (unsigned int j2 = i + 1; j2 < dim; j2++) {
+      invHessian[j2 * dim + i] = row[j2];
+    }
+  }
+}
+
+RDK_AVX512_TARGET static void avx512HessianVecMulNeg(unsigned int dim,
+                                                     const double *invHessian,
+                                                     const double *grad,
+                                                     double *xi) {
+  for (unsigned int i = 0; i < dim; i++) {
+    xi[i] = -avx512DotProduct(dim, invHessian + i * dim, grad);
+  }
+}
+
+#undef RDK_AVX2_TARGET
+#undef RDK_AVX512_TARGET
+
+#endif
+
+}  // namespace BFGSOpt
+
+#endif  // RDKIT_NUMERICS_OPTIMIZER_BFGSOPT_AVX_H
@@ -0,0 +1,208 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#ifndef RD_LBFGSOPT_H
+#define RD_LBFGSOPT_H
+
+#include "BFGSOpt.h"
+
+namespace BFGSOpt {
+//! Default number of corrections stored by minimizeLBFGS()
+const unsigned int LBFGS_CORRECTIONS = 10;
+
+//! Do a limited-memory BFGS (L-BFGS) minimization of a function.
+/*!
+   Rather than the \c dim*dim inverse Hessian used by minimize(), this keeps
+   the last \c numCorrections steps and gradient changes and uses them to
+   compute the search direction (Nocedal & Wright, Numerical Optimization,
+   Algorithm 7.4). The cost per iteration is O(numCorrections*dim) instead
+   of O(dim^2), which makes this the better choice for problems with more
+   than a few hundred dimensions. The line search and the convergence
+   criteria are the same as for minimize().
+
+   \param dim     the dimensionality of the space.
+   \param pos   the starting position, as an array.
+   \param gradTol tolerance for gradient convergence
+   \param numIters used to return the number of iterations required
+   \param funcVal  used to return the final function value
+   \param func    the function to minimize
+   \param gradFunc  calculates the gradient of func
+   \param numCorrections  the number of corrections to keep
+   \param snapshotFreq     a snapshot of the minimization trajectory
+                           will be stored after as many steps as indicated
+                           through this parameter; 0 means no snapshots
+   \param snapshotVect     pointer to a std::vector<Snapshot> object that will
+                           receive the snapshots, can be NULL
+   \param funcTol tolerance for changes in the function value for convergence.
+   \param maxIts   maximum number of iterations allowed
+
+   \return a flag indicating success (or type of failure). Possible values are:
+    -  0: success
+    -  1: too many iterations were required
+*/
+template <typename EnergyFunctor, typename GradientFunctor>
+int minimizeLBFGS(unsigned int dim, double *pos, double gradTol,
+                  unsigned int &numIters, double &funcVal, EnergyFunctor func,
+                  GradientFunctor gradFunc, unsigned int numCorrections,
+                  unsigned int snapshotFreq, RDKit::SnapshotVect *snapshotVect,
+                  double funcTol = TOLX, unsigned int maxIts = MAXITS) {
+  RDUNUSED_PARAM(funcTol);
+  PRECONDITION(pos, "bad input array");
+  PRECONDITION(gradTol > 0, "bad tolerance");
+  PRECONDITION(numCorrections > 0, "bad number of corrections");
+
+  std::vector<double> grad(dim);
+  std::vector<double> dGrad(dim);
+  std::vector<double> xi(dim);
+  // the stored steps and gradient changes, oldest first starting at
+  // firstCorrection:
+  std::vector<double> steps(numCorrections * dim);
+  std::vector<double> dGrads(numCorrections * dim);
+  std::vector<double> rhos(numCorrections);
+  std::vector<double> alphas(numCorrections);
+  unsigned int firstCorrection = 0;
+  unsigned int numStored = 0;
+  double gamma = 1.0;
+  std::unique_ptr<double[]> newPos(new double[dim]);
+  snapshotFreq = std::min(snapshotFreq, maxIts);
+
+  double fp = func(pos);
+  gradFunc(pos, grad.data());
+
+  for (unsigned int i = 0; i < dim; i++) {
+    xi[i] = -grad[i];
+  }
+  double sum = detail::dotProduct(dim, pos, pos);
+  double maxStep = MAXSTEP * std::max(sqrt(sum), static_cast<double>(dim));
+
+  for (unsigned int iter = 1; iter <= maxIts; ++iter) {
+    numIters = iter;
+    int status = -1;
+
+    linearSearch(dim, pos, fp, grad.data(), xi.data(), newPos.get(), funcVal,
+                 func, maxStep, status);
+    CHECK_INVARIANT(status >= 0, "bad direction in linearSearch");
+
+    fp = funcVal;
+    double test = 0.0;
+    for (unsigned int i = 0; i < dim; i++) {
+      xi[i] = newPos[i] - pos[i];
+      pos[i] = newPos[i];
+      double temp = fabs(xi[i]) / std::max(fabs(pos[i]), 1.0);
+      if (temp > test) {
+        test = temp;
+      }
+      dGrad[i] = grad[i];
+    }
+    if (test < TOLX) {
+      if (snapshotVect && snapshotFreq) {
+        RDKit::Snapshot s(boost::shared_array<double>(newPos.release()), fp);
+        snapshotVect->push_back(s);
+      }
+      return 0;
+    }
+
+    double gradScale = gradFunc(pos, grad.data());
+
+    test = 0.0;
+    double term = std::max(fabs(funcVal) * gradScale, 1.0);
+    for (unsigned int i = 0; i < dim; i++) {
+      double temp = fabs(grad[i]) * std::max(fabs(pos[i]), 1.0);
+      test = std::max(test, temp);
+      dGrad[i] = grad[i] - dGrad[i];
+    }
+    test /= term;
+    if (test < gradTol) {
+      if (snapshotVect && snapshotFreq) {
+        RDKit::Snapshot s(boost::shared_array<double>(newPos.release()), fp);
+        snapshotVect->push_back(s);
+      }
+      return 0;
+    }
+
+    // store the new correction, skipping it (as minimize() skips the
+    // Hessian update) if the curvature condition is not met:
+    const double sy = detail::dotProduct(dim, xi.data(), dGrad.data());
+    const double yy = detail::dotProduct(dim, dGrad.data(), dGrad.data());
+    const double ss = detail::dotProduct(dim, xi.data(), xi.data());
+    if (sy > sqrt(EPS * yy * ss)) {
+      unsigned int slot;
+      if (numStored < numCorrections) {
+        slot = (firstCorrection + numStored) % numCorrections;
+        ++numStored;
+      } else {
+        slot = firstCorrection;
+        firstCorrection = (firstCorrection + 1) % numCorrections;
+      }
+      std::copy(xi.begin(), xi.end(), steps.begin() + slot * dim);
+      std::copy(dGrad.begin(), dGrad.end(), dGrads.begin() + slot * dim);
+      rhos[slot] = 1.0 / sy;
+      gamma = sy / yy;
+    }
+
+    // two-loop recursion for xi = -H * grad:
+    std::copy(grad.begin(), grad.end(), xi.begin());
+    for (unsigned int k = numStored; k > 0; --k) {
+      const unsigned int slot = (firstCorrection + k - 1) % numCorrections;
+      alphas[slot] =
+          rhos[slot] * detail::dotProduct(dim, &steps[slot * dim], xi.data());
+      detail::addScaled(dim, xi.data(), xi.data(), -alphas[slot],
+                        &dGrads[slot * dim]);
+    }
+    for (unsigned int i = 0; i < dim; i++) {
+      xi[i] *= gamma;
+    }
+    for (unsigned int k = 0; k < numStored; ++k) {
+      const unsigned int slot = (firstCorrection + k) % numCorrections;
+      const double beta =
+          rhos[slot] * detail::dotProduct(dim, &dGrads[slot * dim], xi.data());
+      detail::addScaled(dim, xi.data(), xi.data(), alphas[slot] - beta,
+                        &steps[slot * dim]);
+    }
+    for (unsigned int i = 0; i < dim; i++) {
+      xi[i] = -xi[i];
+    }
+
+    if (snapshotVect && snapshotFreq && !(iter % snapshotFreq)) {
+      RDKit::Snapshot s(boost::shared_array<double>(newPos.release()), fp);
+      snapshotVect->push_back(s);
+      newPos.reset(new double[dim]);
+    }
+  }
+  return 1;
+}
+
+//! Do a limited-memory BFGS (L-BFGS) minimization of a function.
+/*!
+   \param dim     the dimensionality of the space.
+   \param pos   the starting position, as an array.
+   \param gradTol tolerance for gradient convergence
+   \param numIters used to return the number of iterations required
+   \param funcVal  used to return the final function value
+   \param func    the function to minimize
+   \param gradFunc  calculates the gradient of func
+   \param numCorrections  the number of corrections to keep
+   \param funcTol tolerance for changes in the function value for convergence.
+   \param maxIts   maximum number of iterations allowed
+
+   \return a flag indicating success (or type of failure). Possible values are:
+    -  0: success
+    -  1: too many iterations were required
+*/
+template <typename EnergyFunctor, typename GradientFunctor>
+int minimizeLBFGS(unsigned int dim, double *pos, double gradTol,
+                  unsigned int &numIters, double &funcVal, EnergyFunctor func,
+                  GradientFunctor gradFunc,
+                  unsigned int numCorrections = LBFGS_CORRECTIONS,
+                  double funcTol = TOLX, unsigned int maxIts = MAXITS) {
+  return minimizeLBFGS(dim, pos, gradTol, numIters, funcVal, func, gradFunc,
+                       numCorrections, 0, nullptr, funcTol, maxIts);
+}
+}  // namespace BFGSOpt
+#endif  // RD_LBFGSOPT_H
@@ -13,6 +13,8 @@
 #include <catch2/catch_all.hpp>
 
 #include "BFGSOpt.h"
+#include "BFGSOptBatch.h"
+#include "LBFGSOpt.h"
 
 double circ_0_0(double *v) {
   double dx = v[0];
@@ -81,6 +83,28 @@ double circ_neg_grad(double *v, double *grad) {
   return 1.0;
 }
 
+// the extended Rosenbrock function, the minimum is 0 at (1, 1, ..., 1)
+const unsigned int ROSENBROCK_DIM = 100;
+double rosenbrock(double *v) {
+  double res = 0.0;
+  for (unsigned int i = 0; i < ROSENBROCK_DIM; i += 2) {
+    double t1 = 1.0 - v[i];
+    double t2 = 10.0 * (v[i + 1] - v[i] * v[i]);
+    res += t1 * t1 + t2 * t2;
+  }
+  return res;
+}
+
+double rosenbrock_grad(double *v, double *grad) {
+  for (unsigned int i = 0; i < ROSENBROCK_DIM; i += 2) {
+    double t1 = 1.0 - v[i];
+    double t2 = 10.0 * (v[i + 1] - v[i] * v[i]);
+    grad[i + 1] = 20.0 * t2;
+    grad[i] = -2.0 * (v[i] * grad[i + 1] + t1);
+  }
+  return 1.0;
+}
+
 TEST_CASE("testLinearSearch") {
   int dim = 2;
   double oLoc[2], oVal;
@@ -193,3 +217,171 @@ TEST_CASE("testBFGSOptimizationNegativeEnergy") {
   REQUIRE_THAT(oLoc[0], Catch::Matchers::WithinAbs(3.0, 1e-3));
   REQUIRE_THAT(oLoc[1], Catch::Matchers::WithinAbs(-1.0, 1e-3));
 }
+
+TEST_CASE("testBFGSBatchOptimization") {
+  const unsigned int dim = 2;
+  const std::vector<std::vector<double>> starts = {
+      {2.0, 0.5}, {0.0, 1.0}, {-1.0, 2.0}, {3.0, -0.5}, {1.5, 1.5}};
+  for (unsigned int batchSize : {1u, 2u, 16u}) {
+    auto locs = starts;
+    std::vector<double *> pos;
+    for (auto &loc : locs) {
+      pos.push_back(loc.data());
+    }
+    // energies are requested at the position of the problem or at a line
+    // search point, which does not belong to any of the problems
+    bool goodProbs = true;
+    auto isOwnPoint = [&locs](unsigned int prob, const double *point) {
+      for (unsigned int i = 0; i < locs.size(); ++i) {
+        if (point == locs[i].data()) {
+          return i == prob;
+        }
+      }
+      return prob < locs.size();
+    };
+    auto batchFunc = [&](unsigned int n, const unsigned int *probs,
+                         double *const *points, double *vals) {
+      for (unsigned int i = 0; i < n; ++i) {
+        goodProbs &= isOwnPoint(probs[i], points[i]);
+        vals[i] = func2(points[i]);
+      }
+    };
+    auto batchGrad = [&](unsigned int n, const unsigned int *probs,
+                         double *const *points, double *const *grads,
+                         double *gradScales) {
+      for (unsigned int i = 0; i < n; ++i) {
+        // gradients are always requested at the position of the problem
+        goodProbs &=
+            probs[i] < locs.size() && points[i] == locs[probs[i]].data();
+        gradScales[i] = grad2(points[i], grads[i]);
+      }
+    };
+    std::vector<unsigned int> nIters;
+    auto res = BFGSOpt::minimizeBatch(dim, pos.size(), pos.data(), 1e-4,
+                                      batchFunc, batchGrad, 1e-8,
+                                      BFGSOpt::MAXITS, batchSize, &nIters);
+    CHECK(goodProbs);
+    REQUIRE(res.size() == starts.size());
+    REQUIRE(nIters.size() == starts.size());
+    for (unsigned int i = 0; i < starts.size(); ++i) {
+      // every problem follows the same path as a minimization on its own
+      double oLoc[2] = {starts[i][0], starts[i][1]};
+      double nVal;
+      unsigned int nIter;
+      int needsMore = BFGSOpt::minimize(dim, oLoc, 1e-4, nIter, nVal, func2,
+                                        grad2, 1e-8);
+      CHECK(res[i] == needsMore);
+      CHECK(nIters[i] == nIter);
+      CHECK(locs[i][0] == oLoc[0]);
+      CHECK(locs[i][1] == oLoc[1]);
+      CHECK_THAT(locs[i][0], Catch::Matchers::WithinAbs(1.0, 1e-3));
+      CHECK_THAT(locs[i][1], Catch::Matchers::WithinAbs(0.0, 1e-3));
+    }
+  }
+}
+
+TEST_CASE("SIMD kernels") {
+  // the kernels are opt-in
+  REQUIRE(BFGSOpt::getSIMDLevel() == BFGSOpt::SIMDLevel::Scalar);
+  BFGSOpt::setMaxSIMDLevel(BFGSOpt::SIMDLevel::AVX512);
+  const auto maxLevel = BFGSOpt::getSIMDLevel();
+  std::vector<BFGSOpt::SIMDLevel> levels;
+  for (auto level : {BFGSOpt::SIMDLevel::AVX2, BFGSOpt::SIMDLevel::AVX512}) {
+    if (static_cast<int>(level) <= static_cast<int>(maxLevel)) {
+      levels.push_back(level);
+    }
+  }
+  // the odd sizes exercise the remainder handling of the kernels
+  for (unsigned int dim : {1u, 3u, 4u, 7u, 8u, 13u, 37u}) {
+    std::vector<double> hess(dim * dim), a(dim), b(dim);
+    for (unsigned int i = 0; i < dim; ++i) {
+      a[i] = sin(1.3 * i + 0.2);
+      b[i] = cos(0.7 * i) + 0.1 * i;
+      for (unsigned int j = 0; j <= i; ++j) {
+        hess[i * dim + j] = hess[j * dim + i] =
+            (i == j ? 1.0 : 0.0) + 0.01 * cos(0.3 * i * j);
+      }
+    }
+    BFGSOpt::setMaxSIMDLevel(BFGSOpt::SIMDLevel::Scalar);
+    REQUIRE(BFGSOpt::getSIMDLevel() == BFGSOpt::SIMDLevel::Scalar);
+    const auto refDot = BFGSOpt::detail::dotProduct(dim, a.data(), b.data());
+    std::vector<double> refScaled(dim), refDir(dim), refHess(hess);
+    std::vector<double> xi(a), dGrad(b), scratch(dim);
+    BFGSOpt::detail::addScaled(dim, refScaled.data(), a.data(), 0.3, b.data());
+    BFGSOpt::detail::setSearchDirection(dim, hess.data(), b.data(),
+                                        refDir.data());
+    BFGSOpt::detail::updateInverseHessian(dim, refHess.data(), xi.data(),
+                                          dGrad.data(), scratch.data());
+    for (auto level : levels) {
+      BFGSOpt::setMaxSIMDLevel(level);
+      REQUIRE(BFGSOpt::getSIMDLevel() == level);
+      CHECK_THAT(BFGSOpt::detail::dotProduct(dim, a.data(), b.data()),
+                 Catch::Matchers::WithinAbs(refDot, 1e-12));
+      std::vector<double> scaled(dim), dir(dim), newHess(hess);
+      xi = a;
+      dGrad = b;
+      BFGSOpt::detail::addScaled(dim, scaled.data(), a.data(), 0.3, b.data());
+      BFGSOpt::detail::setSearchDirection(dim, hess.data(), b.data(),
+                                          dir.data());
+      BFGSOpt::detail::updateInverseHessian(dim, newHess.data(), xi.data(),
+                                            dGrad.data(), scratch.data());
+      for (unsigned int i = 0; i < dim; ++i) {
+        CHECK_THAT(scaled[i], Catch::Matchers::WithinAbs(refScaled[i], 1e-12));
+        CHECK_THAT(dir[i], Catch::Matchers::WithinAbs(refDir[i], 1e-12));
+      }
+      for (unsigned int i = 0; i < dim * dim; ++i) {
+        CHECK_THAT(newHess[i], Catch::Matchers::WithinAbs(refHess[i], 1e-10));
+      }
+    }
+    xi = a;
+    dGrad = b;
+  }
+  BFGSOpt::setMaxSIMDLevel(BFGSOpt::SIMDLevel::AVX512);
+  CHECK(BFGSOpt::getSIMDLevel() == maxLevel);
+  BFGSOpt::setMaxSIMDLevel(BFGSOpt::SIMDLevel::Scalar);
+}
+
+TEST_CASE("testLBFGSOptimization") {
+  const unsigned int dim = 2;
+  double nVal;
+  unsigned int nIters;
+  double oLoc[2] = {0.0, 1.0};
+  BFGSOpt::minimizeLBFGS(dim, oLoc, 1e-4, nIters, nVal, circ_0_0,
+                         circ_0_0_grad);
+  CHECK(nIters == 1);
+  CHECK_THAT(nVal, Catch::Matchers::WithinAbs(0.0, 1e-4));
+
+  oLoc[0] = 2.0;
+  oLoc[1] = 0.5;
+  CHECK(BFGSOpt::minimizeLBFGS(dim, oLoc, 1e-4, nIters, nVal, func2, grad2,
+                               3) == 0);
+  CHECK_THAT(nVal, Catch::Matchers::WithinAbs(0.0, 1e-4));
+  CHECK_THAT(oLoc[0], Catch::Matchers::WithinAbs(1.0, 1e-3));
+  CHECK_THAT(oLoc[1], Catch::Matchers::WithinAbs(0.0, 1e-3));
+
+  oLoc[0] = 0.0;
+  oLoc[1] = 0.0;
+  CHECK(BFGSOpt::minimizeLBFGS(dim, oLoc, 1e-4, nIters, nVal, circ_neg,
+                               circ_neg_grad) == 0);
+  CHECK_THAT(nVal, Catch::Matchers::WithinAbs(-100.0, 1e-4));
+
+  SECTION("a larger problem") {
+    for (unsigned int numCorrections : {1u, 5u, 20u}) {
+      std::vector<double> pos(ROSENBROCK_DIM);
+      for (unsigned int i = 0; i < ROSENBROCK_DIM; i += 2) {
+        pos[i] = -1.2;
+        pos[i + 1] = 1.0;
+      }
+      RDKit::SnapshotVect snapshots;
+      int res = BFGSOpt::minimizeLBFGS(
+          ROSENBROCK_DIM, pos.data(), 1e-6, nIters, nVal, rosenbrock,
+          rosenbrock_grad, numCorrections, 10, &snapshots, 1e-8, 5000);
+      CHECK(res == 0);
+      CHECK(!snapshots.empty());
+      CHECK_THAT(nVal, Catch::Matchers::WithinAbs(0.0, 1e-4));
+      for (const auto v : pos) {
+        CHECK_THAT(v, Catch::Matchers::WithinAbs(1.0, 1e-2));
+      }
+    }
+  }
+}
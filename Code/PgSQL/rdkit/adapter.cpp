@@ -50,6 +50,7 @@
 
 #include <GraphMol/RDKitBase.h>
 #include <GraphMol/MolPickler.h>
+#include <GraphMol/MolPickleView.h>
 #include <GraphMol/ChemReactions/ReactionPickler.h>
 #include <GraphMol/ChemReactions/ReactionParser.h>
 #include <GraphMol/ChemReactions/Reaction.h>
@@ -724,6 +725,41 @@ extern "C" int MolNumHeavyAtoms(CROMol i) {
   return im->getNumHeavyAtoms();
 }
 
+/*
+ * These read the atom counts straight from the pickle, without building the
+ * molecule. They return -1 when that isn't possible (old pickles, or query
+ * atoms whose H counts are only known after the molecule is built).
+ */
+extern "C" int MolPickleNumAtoms(Mol *data) {
+  try {
+    MolPickleView view(VARDATA(data), VARSIZE(data) - VARHDRSZ);
+    if (view.hasQueries()) {
+      return -1;
+    }
+    int res = view.getNumAtoms();
+    for (unsigned int i = 0; i < view.getNumAtoms(); ++i) {
+      res += view.getTotalNumHs(i);
+    }
+    return res;
+  } catch (...) {
+    return -1;
+  }
+}
+extern "C" int MolPickleNumHeavyAtoms(Mol *data) {
+  try {
+    MolPickleView view(VARDATA(data), VARSIZE(data) - VARHDRSZ);
+    int res = 0;
+    for (unsigned int i = 0; i < view.getNumAtoms(); ++i) {
+      if (view.getAtomicNum(i) > 1) {
+        ++res;
+      }
+    }
+    return res;
+  } catch (...) {
+    return -1;
+  }
+}
+
 extern "C" char *makeMolFormulaText(CROMol data, int *len,
                                     bool separateIsotopes,
                                     bool abbreviateHIsotopes) {
@@ -0,0 +1,1353 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include <postgres.h>
+#include <fmgr.h>
+#include <miscadmin.h>
+#include <access/amapi.h>
+#include <access/amvalidate.h>
+#include <access/generic_xlog.h>
+#include <access/relscan.h>
+#include <access/tableam.h>
+#include <access/xloginsert.h>
+#include <catalog/pg_amop.h>
+#include <catalog/pg_amproc.h>
+#include <catalog/pg_opclass.h>
+#include <catalog/pg_opfamily.h>
+#include <catalog/pg_type.h>
+#include <commands/vacuum.h>
+#include <lib/pairingheap.h>
+#include <nodes/tidbitmap.h>
+#include <port/atomics.h>
+#include <storage/bufmgr.h>
+#include <storage/lmgr.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/regproc.h>
+#include <utils/rel.h>
+#include <utils/selfuncs.h>
+#include <utils/syscache.h>
+
+#include "rdkit.h"
+#include "guc.h"
+#include "bitstring.h"
+
+/*
+ * A popcount partitioned index for bfp similarity searches.
+ *
+ * The Tanimoto similarity of two fingerprints with na and nb bits set can't
+ * be larger than min(na, nb) / max(na, nb), and a similar bound holds for
+ * the Dice similarity. The index groups the fingerprints into partitions
+ * of similar popcount (weight), so that the partitions which can't contain
+ * any match are skipped without being read, and the remaining ones are
+ * scanned sequentially.
+ *
+ * Each partition is a list of pages, the first of which receives the new
+ * entries. Rather than storing index tuples, a page holds arrays of heap
+ * TIDs, weights and fingerprints, so that the intersection weights of all
+ * the fingerprints on a page are computed with a single call to
+ * bitstringIntersectionWeights().
+ *
+ * The metapage (block 0) stores the fingerprint size and, for each
+ * partition, its first page and the range of weights added to it.
+ *
+ * k-nearest neighbor scans visit the partitions in the order of their
+ * similarity bound, and return the matches found so far once none of the
+ * partitions left to scan can contain a better one. Parallel scans share
+ * the same order, with each worker claiming the next partition to scan.
+ *
+ * Deleted entries are removed by VACUUM, but empty pages are not recycled,
+ * REINDEX returns the space to the operating system.
+ */
+
+#define BFP_POPCOUNT_MAGIC 0xBF9C0DE5
+#define BFP_POPCOUNT_VERSION 1
+#define BFP_POPCOUNT_METAPAGE_BLKNO 0
+/* helps the page inspection tools identify the pages of the index */
+#define BFP_POPCOUNT_PAGE_ID 0xFF8A
+
+#define BFP_POPCOUNT_META 0x0001
+
+/* the maximum number of partitions, if the metapage can store them */
+#define BFP_POPCOUNT_PARTITIONS 512
+
+typedef struct BfpPopcountPageOpaqueData {
+  BlockNumber next; /* next page of the partition */
+  uint16 nitems;
+  uint16 partition;
+  uint16 flags;
+  uint16 pageId;
+} BfpPopcountPageOpaqueData;
+
+typedef BfpPopcountPageOpaqueData *BfpPopcountPageOpaque;
+
+typedef struct BfpPopcountPartition {
+  BlockNumber head; /* InvalidBlockNumber if the partition is empty */
+  uint32 minWeight; /* of the entries added to the partition */
+  uint32 maxWeight;
+} BfpPopcountPartition;
+
+typedef struct BfpPopcountMetaPageData {
+  uint32 magic;
+  uint32 version;
+  uint32 siglen; /* 0 until the first fingerprint is added */
+  uint32 capacity; /* number of entries that fit on a page */
+  uint32 bucketWidth; /* range of weights covered by a partition */
+  uint32 npartitions;
+  BfpPopcountPartition partitions[FLEXIBLE_ARRAY_MEMBER];
+} BfpPopcountMetaPageData;
+
+#define BfpPopcountPageGetOpaque(page) \
+  ((BfpPopcountPageOpaque)PageGetSpecialPointer(page))
+#define BfpPopcountPageGetMeta(page) \
+  ((BfpPopcountMetaPageData *)PageGetContents(page))
+
+#define BFP_POPCOUNT_PAGE_SPACE                  \
+  (BLCKSZ - MAXALIGN(SizeOfPageHeaderData) -     \
+   MAXALIGN(sizeof(BfpPopcountPageOpaqueData)))
+
+#define BFP_POPCOUNT_MAX_PARTITIONS                                    \
+  Min(BFP_POPCOUNT_PARTITIONS,                                         \
+      (BFP_POPCOUNT_PAGE_SPACE -                                       \
+       offsetof(BfpPopcountMetaPageData, partitions)) /                \
+          sizeof(BfpPopcountPartition))
+
+/* the layout of the arrays on a data page holding up to capacity entries */
+#define BfpPopcountPageGetTids(page) ((ItemPointer)PageGetContents(page))
+#define BfpPopcountPageGetWeights(page, capacity) \
+  ((uint32 *)(PageGetContents(page) +             \
+              MAXALIGN(sizeof(ItemPointerData) * (capacity))))
+#define BfpPopcountPageGetFps(page, capacity)                 \
+  ((uint8 *)(PageGetContents(page) +                          \
+             MAXALIGN(sizeof(ItemPointerData) * (capacity)) + \
+             MAXALIGN(sizeof(uint32) * (capacity))))
+
+static uint32 pageCapacity(uint32 siglen) {
+  return (BFP_POPCOUNT_PAGE_SPACE - 2 * MAXIMUM_ALIGNOF) /
+         (sizeof(ItemPointerData) + sizeof(uint32) + siglen);
+}
+
+/*********** Pages **********/
+
+static void initPage(Page page, uint16 flags) {
+  BfpPopcountPageOpaque opaque;
+
+  PageInit(page, BLCKSZ, sizeof(BfpPopcountPageOpaqueData));
+  opaque = BfpPopcountPageGetOpaque(page);
+  opaque->next = InvalidBlockNumber;
+  opaque->flags = flags;
+  opaque->pageId = BFP_POPCOUNT_PAGE_ID;
+
+  /*
+   * the page contents are not line pointers and tuples, mark all the space
+   * as used so that none of it is skipped in the WAL records
+   */
+  ((PageHeader)page)->pd_lower = ((PageHeader)page)->pd_upper;
+}
+
+static void initMetaPage(Page page) {
+  BfpPopcountMetaPageData *meta;
+
+  initPage(page, BFP_POPCOUNT_META);
+  meta = BfpPopcountPageGetMeta(page);
+  memset(meta, 0, sizeof(BfpPopcountMetaPageData));
+  meta->magic = BFP_POPCOUNT_MAGIC;
+  meta->version = BFP_POPCOUNT_VERSION;
+}
+
+/* set up the partitions once the size of the fingerprints is known */
+static void initPartitions(BfpPopcountMetaPageData *meta, uint32 siglen) {
+  uint32 nweights = siglen * 8 + 1;
+  uint32 i;
+
+  meta->capacity = pageCapacity(siglen);
+  if (meta->capacity == 0) {
+    elog(ERROR, "Fingerprints of %u bytes are too large for this index",
+         siglen);
+  }
+  meta->siglen = siglen;
+  meta->bucketWidth = (nweights + BFP_POPCOUNT_MAX_PARTITIONS - 1) /
+                      BFP_POPCOUNT_MAX_PARTITIONS;
+  meta->npartitions =
+      (nweights + meta->bucketWidth - 1) / meta->bucketWidth;
+  for (i = 0; i < meta->npartitions; ++i) {
+    meta->partitions[i].head = InvalidBlockNumber;
+    meta->partitions[i].minWeight = PG_UINT32_MAX;
+    meta->partitions[i].maxWeight = 0;
+  }
+}
+
+/* copy the contents of the metapage */
+static BfpPopcountMetaPageData *readMetaPage(Relation index) {
+  Buffer buffer;
+  BfpPopcountMetaPageData *meta, *result;
+  Size size;
+
+  buffer = ReadBuffer(index, BFP_POPCOUNT_METAPAGE_BLKNO);
+  LockBuffer(buffer, BUFFER_LOCK_SHARE);
+
+  meta = BfpPopcountPageGetMeta(BufferGetPage(buffer));
+  if (meta->magic != BFP_POPCOUNT_MAGIC) {
+    elog(ERROR, "Index \"%s\" has an invalid metapage",
+         RelationGetRelationName(index));
+  }
+  size = offsetof(BfpPopcountMetaPageData, partitions) +
+         meta->npartitions * sizeof(BfpPopcountPartition);
+  result = palloc(size);
+  memcpy(result, meta, size);
+
+  UnlockReleaseBuffer(buffer);
+  return result;
+}
+
+/* allocate a new page at the end of the index and lock it */
+static Buffer newBuffer(Relation index, ForkNumber forkNum) {
+#if PG_VERSION_NUM >= 160000
+  return ExtendBufferedRel(BMR_REL(index), forkNum, NULL, EB_LOCK_FIRST);
+#else
+  Buffer buffer;
+  bool needLock = !RELATION_IS_LOCAL(index);
+
+  if (needLock) {
+    LockRelationForExtension(index, ExclusiveLock);
+  }
+  buffer = ReadBufferExtended(index, forkNum, P_NEW, RBM_NORMAL, NULL);
+  LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+  if (needLock) {
+    UnlockRelationForExtension(index, ExclusiveLock);
+  }
+  return buffer;
+#endif
+}
+
+static void addToPage(Page page, uint32 capacity, uint32 siglen,
+                      ItemPointer tid, uint32 weight, uint8 *fp) {
+  BfpPopcountPageOpaque opaque = BfpPopcountPageGetOpaque(page);
+  uint32 n = opaque->nitems;
+
+  Assert(n < capacity);
+  BfpPopcountPageGetTids(page)[n] = *tid;
+  BfpPopcountPageGetWeights(page, capacity)[n] = weight;
+  memcpy(BfpPopcountPageGetFps(page, capacity) + (Size)n * siglen, fp,
+         siglen);
+  opaque->nitems = n + 1;
+}
+
+static void updateWeights(BfpPopcountPartition *partition, uint32 weight) {
+  if (weight < partition->minWeight) {
+    partition->minWeight = weight;
+  }
+  if (weight > partition->maxWeight) {
+    partition->maxWeight = weight;
+  }
+}
+
+static uint32 checkFingerprint(BfpPopcountMetaPageData *meta, Bfp *bfp) {
+  uint32 siglen = BFP_SIGLEN(bfp);
+
+  if (meta->siglen == 0) {
+    initPartitions(meta, siglen);
+  } else if (meta->siglen != siglen) {
+    elog(ERROR, "All fingerprints should be the same length");
+  }
+  return bitstringWeight(siglen, (uint8 *)VARDATA(bfp));
+}
+
+/*********** Building **********/
+
+typedef struct BfpPopcountBuildState {
+  Page metaPage;
+  /* the page being filled for each partition, NULL if none */
+  Page *pages;
+  double indtuples;
+  MemoryContext tmpCtx;
+} BfpPopcountBuildState;
+
+/* write a page of the build, making it the first page of its partition */
+static void flushBuildPage(Relation index, BfpPopcountBuildState *state,
+                           uint32 p) {
+  BfpPopcountPartition *partition =
+      &BfpPopcountPageGetMeta(state->metaPage)->partitions[p];
+  Page page = state->pages[p];
+  GenericXLogState *xlogState;
+  Buffer buffer;
+
+  BfpPopcountPageGetOpaque(page)->next = partition->head;
+
+  buffer = newBuffer(index, MAIN_FORKNUM);
+  xlogState = GenericXLogStart(index);
+  memcpy(GenericXLogRegisterBuffer(xlogState, buffer,
+                                   GENERIC_XLOG_FULL_IMAGE),
+         page, BLCKSZ);
+  GenericXLogFinish(xlogState);
+  partition->head = BufferGetBlockNumber(buffer);
+  UnlockReleaseBuffer(buffer);
+}
+
+#if PG_VERSION_NUM >= 130000
+static void buildCallback(Relation index, ItemPointer tid, Datum *values,
+                          bool *isnull, bool tupleIsAlive, void *state_) {
+#else
+static void buildCallback(Relation index, HeapTuple htup, Datum *values,
+                          bool *isnull, bool tupleIsAlive, void *state_) {
+  ItemPointer tid = &htup->t_self;
+#endif
+  BfpPopcountBuildState *state = (BfpPopcountBuildState *)state_;
+  BfpPopcountMetaPageData *meta = BfpPopcountPageGetMeta(state->metaPage);
+  MemoryContext oldCtx;
+  Bfp *bfp;
+  uint32 weight, p;
+
+  if (isnull[0]) {
+    return;
+  }
+
+  oldCtx = MemoryContextSwitchTo(state->tmpCtx);
+
+  bfp = DatumGetBfpP(values[0]);
+  weight = checkFingerprint(meta, bfp);
+  p = weight / meta->bucketWidth;
+
+  if (state->pages[p] == NULL) {
+    state->pages[p] = MemoryContextAlloc(oldCtx, BLCKSZ);
+    initPage(state->pages[p], 0);
+    BfpPopcountPageGetOpaque(state->pages[p])->partition = p;
+  } else if (BfpPopcountPageGetOpaque(state->pages[p])->nitems ==
+             meta->capacity) {
+    flushBuildPage(index, state, p);
+    initPage(state->pages[p], 0);
+    BfpPopcountPageGetOpaque(state->pages[p])->partition = p;
+  }
+  addToPage(state->pages[p], meta->capacity, meta->siglen, tid, weight,
+            (uint8 *)VARDATA(bfp));
+  updateWeights(&meta->partitions[p], weight);
+  state->indtuples += 1;
+
+  MemoryContextSwitchTo(oldCtx);
+  MemoryContextReset(state->tmpCtx);
+}
+
+static IndexBuildResult *bfpPopcountBuild(Relation heap, Relation index,
+                                          IndexInfo *indexInfo) {
+  IndexBuildResult *result;
+  BfpPopcountBuildState state;
+  BfpPopcountMetaPageData *meta;
+  GenericXLogState *xlogState;
+  Buffer metaBuffer;
+  double reltuples;
+  uint32 p;
+
+  if (RelationGetNumberOfBlocks(index) != 0) {
+    elog(ERROR, "Index \"%s\" already contains data",
+         RelationGetRelationName(index));
+  }
+
+  memset(&state, 0, sizeof(state));
+  state.metaPage = palloc(BLCKSZ);
+  initMetaPage(state.metaPage);
+  state.pages = palloc0(sizeof(Page) * BFP_POPCOUNT_MAX_PARTITIONS);
+  state.tmpCtx = AllocSetContextCreate(
+      CurrentMemoryContext, "bfp_popcount build temporary context",
+      ALLOCSET_DEFAULT_SIZES);
+
+  /* reserve block 0 for the metapage, it's written once the build is done */
+  metaBuffer = newBuffer(index, MAIN_FORKNUM);
+  Assert(BufferGetBlockNumber(metaBuffer) == BFP_POPCOUNT_METAPAGE_BLKNO);
+  xlogState = GenericXLogStart(index);
+  initMetaPage(GenericXLogRegisterBuffer(xlogState, metaBuffer,
+                                         GENERIC_XLOG_FULL_IMAGE));
+  GenericXLogFinish(xlogState);
+  UnlockReleaseBuffer(metaBuffer);
+
+  reltuples = table_index_build_scan(heap, index, indexInfo, true, true,
+                                     buildCallback, (void *)&state, NULL);
+
+  meta = BfpPopcountPageGetMeta(state.metaPage);
+  for (p = 0; p < meta->npartitions; ++p) {
+    if (state.pages[p] != NULL &&
+        BfpPopcountPageGetOpaque(state.pages[p])->nitems > 0) {
+      flushBuildPage(index, &state, p);
+    }
+  }
+
+  metaBuffer = ReadBuffer(index, BFP_POPCOUNT_METAPAGE_BLKNO);
+  LockBuffer(metaBuffer, BUFFER_LOCK_EXCLUSIVE);
+  xlogState = GenericXLogStart(index);
+  memcpy(GenericXLogRegisterBuffer(xlogState, metaBuffer,
+                                   GENERIC_XLOG_FULL_IMAGE),
+         state.metaPage, BLCKSZ);
+  GenericXLogFinish(xlogState);
+  UnlockReleaseBuffer(metaBuffer);
+
+  MemoryContextDelete(state.tmpCtx);
+
+  result = (IndexBuildResult *)palloc(sizeof(IndexBuildResult));
+  result->heap_tuples = reltuples;
+  result->index_tuples = state.indtuples;
+  return result;
+}
+
+static void bfpPopcountBuildEmpty(Relation index) {
+  Buffer metaBuffer;
+
+  metaBuffer = newBuffer(index, INIT_FORKNUM);
+  START_CRIT_SECTION();
+  initMetaPage(BufferGetPage(metaBuffer));
+  MarkBufferDirty(metaBuffer);
+  log_newpage_buffer(metaBuffer, true);
+  END_CRIT_SECTION();
+  UnlockReleaseBuffer(metaBuffer);
+}
+
+/*********** Inserting **********/
+
+#if PG_VERSION_NUM >= 140000
+static bool bfpPopcountInsert(Relation index, Datum *values, bool *isnull,
+                              ItemPointer ht_ctid, Relation heapRel,
+                              IndexUniqueCheck checkUnique,
+                              bool indexUnchanged, IndexInfo *indexInfo) {
+#else
+static bool bfpPopcountInsert(Relation index, Datum *values, bool *isnull,
+                              ItemPointer ht_ctid, Relation heapRel,
+                              IndexUniqueCheck checkUnique,
+                              IndexInfo *indexInfo) {
+#endif
+  BfpPopcountMetaPageData *meta;
+  BfpPopcountPartition *partition;
+  GenericXLogState *xlogState;
+  Buffer metaBuffer, headBuffer = InvalidBuffer, pageBuffer;
+  Page page = NULL;
+  Bfp *bfp;
+  uint32 siglen, weight, p;
+  bool metaRegistered = false, newHead, newWeights;
+
+  if (isnull[0]) {
+    return false;
+  }
+  bfp = DatumGetBfpP(values[0]);
+  siglen = BFP_SIGLEN(bfp);
+  weight = bitstringWeight(siglen, (uint8 *)VARDATA(bfp));
+
+  /*
+   * Most insertions add an entry to the first page of a partition without
+   * changing the partition's weight range. These only hold a share lock on
+   * the metapage, so that they can run concurrently as long as they go to
+   * different partitions, and only the first page is WAL-logged.
+   */
+  metaBuffer = ReadBuffer(index, BFP_POPCOUNT_METAPAGE_BLKNO);
+  LockBuffer(metaBuffer, BUFFER_LOCK_SHARE);
+  meta = BfpPopcountPageGetMeta(BufferGetPage(metaBuffer));
+  if (meta->siglen == siglen) {
+    p = weight / meta->bucketWidth;
+    partition = &meta->partitions[p];
+    if (BlockNumberIsValid(partition->head) &&
+        weight >= partition->minWeight && weight <= partition->maxWeight) {
+      headBuffer = ReadBuffer(index, partition->head);
+      LockBuffer(headBuffer, BUFFER_LOCK_EXCLUSIVE);
+      if (BfpPopcountPageGetOpaque(BufferGetPage(headBuffer))->nitems <
+          meta->capacity) {
+        xlogState = GenericXLogStart(index);
+        page = GenericXLogRegisterBuffer(xlogState, headBuffer, 0);
+        addToPage(page, meta->capacity, siglen, ht_ctid, weight,
+                  (uint8 *)VARDATA(bfp));
+        GenericXLogFinish(xlogState);
+        UnlockReleaseBuffer(headBuffer);
+        UnlockReleaseBuffer(metaBuffer);
+        return false;
+      }
+      UnlockReleaseBuffer(headBuffer);
+      headBuffer = InvalidBuffer;
+    }
+  }
+
+  /*
+   * The metapage has to change: either the partition needs a new first page
+   * or its weight range grows. The exclusive lock serializes these
+   * insertions, and things may have changed while we weren't holding it.
+   */
+  LockBuffer(metaBuffer, BUFFER_LOCK_UNLOCK);
+  LockBuffer(metaBuffer, BUFFER_LOCK_EXCLUSIVE);
+
+  xlogState = GenericXLogStart(index);
+  meta = BfpPopcountPageGetMeta(BufferGetPage(metaBuffer));
+  if (meta->siglen == 0) {
+    meta = BfpPopcountPageGetMeta(
+        GenericXLogRegisterBuffer(xlogState, metaBuffer, 0));
+    metaRegistered = true;
+  }
+  PG_TRY();
+  {
+    checkFingerprint(meta, bfp);
+  }
+  PG_CATCH();
+  {
+    GenericXLogAbort(xlogState);
+    PG_RE_THROW();
+  }
+  PG_END_TRY();
+
+  p = weight / meta->bucketWidth;
+  partition = &meta->partitions[p];
+
+  if (BlockNumberIsValid(partition->head)) {
+    headBuffer = ReadBuffer(index, partition->head);
+    LockBuffer(headBuffer, BUFFER_LOCK_EXCLUSIVE);
+    if (BfpPopcountPageGetOpaque(BufferGetPage(headBuffer))->nitems <
+        meta->capacity) {
+      page = GenericXLogRegisterBuffer(xlogState, headBuffer, 0);
+    }
+  }
+  newHead = page == NULL;
+  newWeights =
+      weight < partition->minWeight || weight > partition->maxWeight;
+  if ((newHead || newWeights) && !metaRegistered) {
+    meta = BfpPopcountPageGetMeta(
+        GenericXLogRegisterBuffer(xlogState, metaBuffer, 0));
+    partition = &meta->partitions[p];
+  }
+
+  pageBuffer = headBuffer;
+  if (newHead) {
+    /* the partition is empty or its first page is full, add a new one */
+    pageBuffer = newBuffer(index, MAIN_FORKNUM);
+    page = GenericXLogRegisterBuffer(xlogState, pageBuffer,
+                                     GENERIC_XLOG_FULL_IMAGE);
+    initPage(page, 0);
+    BfpPopcountPageGetOpaque(page)->next = partition->head;
+    BfpPopcountPageGetOpaque(page)->partition = p;
+    partition->head = BufferGetBlockNumber(pageBuffer);
+  }
+
+  addToPage(page, meta->capacity, meta->siglen, ht_ctid, weight,
+            (uint8 *)VARDATA(bfp));
+  if (newWeights) {
+    updateWeights(partition, weight);
+  }
+
+  GenericXLogFinish(xlogState);
+
+  if (pageBuffer != headBuffer) {
+    UnlockReleaseBuffer(pageBuffer);
+  }
+  if (BufferIsValid(headBuffer)) {
+    UnlockReleaseBuffer(headBuffer);
+  }
+  UnlockReleaseBuffer(metaBuffer);
+
+  return false;
+}
+
+/*********** Vacuum **********/
+
+static IndexBulkDeleteResult *bfpPopcountBulkDelete(
+    IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
+    IndexBulkDeleteCallback callback, void *callback_state) {
+  Relation index = info->index;
+  BfpPopcountMetaPageData *meta;
+  BlockNumber blkno, npages;
+  uint32 capacity, siglen;
+
+  if (stats == NULL) {
+    stats = (IndexBulkDeleteResult *)palloc0(sizeof(IndexBulkDeleteResult));
+  }
+
+  meta = readMetaPage(index);
+  capacity = meta->capacity;
+  siglen = meta->siglen;
+  pfree(meta);
+  if (siglen == 0) {
+    return stats;
+  }
+
+  npages = RelationGetNumberOfBlocks(index);
+  for (blkno = BFP_POPCOUNT_METAPAGE_BLKNO + 1; blkno < npages; ++blkno) {
+    GenericXLogState *xlogState;
+    Buffer buffer;
+    Page page;
+    ItemPointer tids;
+    uint32 *weights;
+    uint8 *fps;
+    uint32 i, n, nitems;
+
+#if PG_VERSION_NUM >= 180000
+    vacuum_delay_point(false);
+#else
+    vacuum_delay_point();
+#endif
+
+    buffer = ReadBufferExtended(index, MAIN_FORKNUM, blkno, RBM_NORMAL,
+                                info->strategy);
+    LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+    if (PageIsNew(BufferGetPage(buffer))) {
+      UnlockReleaseBuffer(buffer);
+      continue;
+    }
+
+    xlogState = GenericXLogStart(index);
+    page = GenericXLogRegisterBuffer(xlogState, buffer, 0);
+
+    tids = BfpPopcountPageGetTids(page);
+    weights = BfpPopcountPageGetWeights(page, capacity);
+    fps = BfpPopcountPageGetFps(page, capacity);
+    nitems = n = BfpPopcountPageGetOpaque(page)->nitems;
+
+    /* fill the holes with the entries at the end of the page */
+    i = 0;
+    while (i < n) {
+      if (callback(&tids[i], callback_state)) {
+        --n;
+        if (i < n) {
+          tids[i] = tids[n];
+          weights[i] = weights[n];
+          memcpy(fps + (Size)i * siglen, fps + (Size)n * siglen, siglen);
+        }
+        stats->tuples_removed += 1;
+      } else {
+        stats->num_index_tuples += 1;
+        ++i;
+      }
+    }
+
+    if (n != nitems) {
+      BfpPopcountPageGetOpaque(page)->nitems = n;
+      GenericXLogFinish(xlogState);
+    } else {
+      GenericXLogAbort(xlogState);
+    }
+    UnlockReleaseBuffer(buffer);
+  }
+
+  stats->num_pages = npages;
+  return stats;
+}
+
+static IndexBulkDeleteResult *bfpPopcountVacuumCleanup(
+    IndexVacuumInfo *info, IndexBulkDeleteResult *stats) {
+  Relation index = info->index;
+  BlockNumber blkno, npages;
+
+  if (info->analyze_only) {
+    return stats;
+  }
+
+  npages = RelationGetNumberOfBlocks(index);
+  if (stats == NULL) {
+    /* there was no bulk delete, count the entries */
+    stats = (IndexBulkDeleteResult *)palloc0(sizeof(IndexBulkDeleteResult));
+    for (blkno = BFP_POPCOUNT_METAPAGE_BLKNO + 1; blkno < npages; ++blkno) {
+      Buffer buffer;
+      Page page;
+
+#if PG_VERSION_NUM >= 180000
+      vacuum_delay_point(false);
+#else
+      vacuum_delay_point();
+#endif
+
+      buffer = ReadBufferExtended(index, MAIN_FORKNUM, blkno, RBM_NORMAL,
+                                  info->strategy);
+      LockBuffer(buffer, BUFFER_LOCK_SHARE);
+      page = BufferGetPage(buffer);
+      if (!PageIsNew(page)) {
+        stats->num_index_tuples += BfpPopcountPageGetOpaque(page)->nitems;
+      }
+      UnlockReleaseBuffer(buffer);
+    }
+  }
+  stats->num_pages = npages;
+  return stats;
+}
+
+/*********** Searching **********/
+
+/* a similarity query, from a scan key or an ordering operator */
+typedef struct BfpPopcountQuery {
+  StrategyNumber strategy;
+  uint8 *fp;
+  uint32 weight;
+  double threshold; /* not used for the ordering */
+} BfpPopcountQuery;
+
+/* a partition to scan, with the bound on the similarity of its entries */
+typedef struct BfpPopcountScanPartition {
+  uint32 partition;
+  double bound;
+} BfpPopcountScanPartition;
+
+/* a match of an ordered scan */
+typedef struct BfpPopcountMatch {
+  pairingheap_node ph_node;
+  ItemPointerData tid;
+  double similarity;
+} BfpPopcountMatch;
+
+typedef struct BfpPopcountParallelScanData {
+  /* the position in the scan order of the next partition to scan */
+  pg_atomic_uint32 next;
+} BfpPopcountParallelScanData;
+
+typedef struct BfpPopcountScanOpaqueData {
+  MemoryContext ctx; /* reset on rescan */
+  bool started;
+  bool empty; /* nothing can match the scan keys */
+
+  int nqueries;
+  BfpPopcountQuery *queries;
+  bool ordered;
+  BfpPopcountQuery order;
+
+  BfpPopcountMetaPageData *meta;
+
+  /* the partitions to scan, best first for ordered scans */
+  uint32 nscan;
+  BfpPopcountScanPartition *scan;
+  uint32 nextScan; /* the next partition to claim, for serial scans */
+  double bound;    /* the similarity bound of the partition being scanned */
+  BlockNumber nextBlock;
+
+  /* the matches on the last page read by unordered scans */
+  ItemPointerData *tids;
+  uint32 ntids;
+  uint32 curtid;
+
+  /* scratch space for processing a page */
+  int *common;
+  bool *matches;
+
+  pairingheap *queue; /* matches not yet returned by ordered scans */
+} BfpPopcountScanOpaqueData;
+
+typedef BfpPopcountScanOpaqueData *BfpPopcountScanOpaque;
+
+#if PG_VERSION_NUM >= 180000
+#define BfpPopcountGetParallelScan(scan)                               \
+  ((BfpPopcountParallelScanData *)OffsetToPointer(                     \
+      (void *)(scan)->parallel_scan, (scan)->parallel_scan->ps_offset_am))
+#else
+#define BfpPopcountGetParallelScan(scan)                               \
+  ((BfpPopcountParallelScanData *)OffsetToPointer(                     \
+      (void *)(scan)->parallel_scan, (scan)->parallel_scan->ps_offset))
+#endif
+
+static double similarity(StrategyNumber strategy, uint32 nCommon,
+                         uint32 nKey, uint32 nQuery) {
+  /* these match bitstringTanimotoSimilarity() and CalcBitmapDice() */
+  switch (strategy) {
+    case RDKitTanimotoStrategy:
+    case RDKitOrderByTanimotoStrategy:
+      if (nKey + nQuery - nCommon == 0) {
+        return 1.0;
+      }
+      return (double)nCommon / (nKey + nQuery - nCommon);
+    case RDKitDiceStrategy:
+    case RDKitOrderByDiceStrategy:
+      if (nKey + nQuery == 0) {
+        return 0.0;
+      }
+      return (2.0 * nCommon) / (nKey + nQuery);
+    default:
+      elog(ERROR, "Unknown strategy: %d", strategy);
+  }
+  return 0.0; /* keep the compiler quiet */
+}
+
+/*
+ * the largest similarity to the query of a fingerprint with weight in
+ * [minWeight, maxWeight]: the one with the weight closest to the query's,
+ * if all the bits of the lighter fingerprint are also set in the other
+ */
+static double maxSimilarity(BfpPopcountQuery *query, uint32 minWeight,
+                            uint32 maxWeight) {
+  uint32 weight = query->weight;
+
+  if (weight < minWeight) {
+    weight = minWeight;
+  } else if (weight > maxWeight) {
+    weight = maxWeight;
+  }
+  return similarity(query->strategy, Min(weight, query->weight), weight,
+                    query->weight);
+}
+
+static bool rangeMayMatch(BfpPopcountScanOpaque so, uint32 minWeight,
+                          uint32 maxWeight) {
+  int i;
+
+  if (minWeight > maxWeight) {
+    return false;
+  }
+  for (i = 0; i < so->nqueries; ++i) {
+    if (maxSimilarity(&so->queries[i], minWeight, maxWeight) <
+        so->queries[i].threshold) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void initQuery(BfpPopcountQuery *query, ScanKey key, uint32 siglen) {
+  Bfp *bfp = DatumGetBfpP(key->sk_argument);
+
+  if (BFP_SIGLEN(bfp) != siglen) {
+    elog(ERROR, "All fingerprints should be the same length");
+  }
+  query->strategy = key->sk_strategy;
+  query->fp = (uint8 *)VARDATA(bfp);
+  query->weight = bitstringWeight(siglen, query->fp);
+  switch (query->strategy) {
+    case RDKitTanimotoStrategy:
+      query->threshold = getTanimotoLimit();
+      break;
+    case RDKitDiceStrategy:
+      query->threshold = getDiceLimit();
+      break;
+    default:
+      query->threshold = 0.0;
+  }
+}
+
+static int cmpScanPartitions(const void *a, const void *b) {
+  const BfpPopcountScanPartition *pa = (const BfpPopcountScanPartition *)a;
+  const BfpPopcountScanPartition *pb = (const BfpPopcountScanPartition *)b;
+
+  if (pa->bound != pb->bound) {
+    return (pa->bound > pb->bound) ? -1 : 1;
+  }
+  return (pa->partition < pb->partition) ? -1 : 1;
+}
+
+static int cmpMatches(const pairingheap_node *a, const pairingheap_node *b,
+                      void *arg) {
+  const BfpPopcountMatch *ma = pairingheap_const_container(BfpPopcountMatch,
+                                                           ph_node, a);
+  const BfpPopcountMatch *mb = pairingheap_const_container(BfpPopcountMatch,
+                                                           ph_node, b);
+
+  /* the queue returns the most similar match first */
+  if (ma->similarity == mb->similarity) {
+    return 0;
+  }
+  return (ma->similarity > mb->similarity) ? 1 : -1;
+}
+
+/*
+ * read the metapage and the scan keys, and select the partitions to scan.
+ *
+ * the selection only depends on the fingerprint size and the scan keys, so
+ * that all the workers of a parallel scan agree on the order of the
+ * partitions; the weights actually stored in a partition are only checked
+ * when the partition is claimed.
+ */
+static void startScan(IndexScanDesc scan) {
+  BfpPopcountScanOpaque so = (BfpPopcountScanOpaque)scan->opaque;
+  BfpPopcountMetaPageData *meta;
+  MemoryContext oldCtx;
+  uint32 nbits, p;
+  int i;
+
+  so->started = true;
+  oldCtx = MemoryContextSwitchTo(so->ctx);
+
+  so->meta = meta = readMetaPage(scan->indexRelation);
+  if (meta->siglen == 0) {
+    so->empty = true;
+    MemoryContextSwitchTo(oldCtx);
+    return;
+  }
+
+  so->nqueries = scan->numberOfKeys;
+  so->queries = palloc(sizeof(BfpPopcountQuery) * Max(so->nqueries, 1));
+  for (i = 0; i < scan->numberOfKeys; ++i) {
+    ScanKey key = &scan->keyData[i];
+
+    if (key->sk_flags & SK_ISNULL) {
+      so->empty = true;
+      MemoryContextSwitchTo(oldCtx);
+      return;
+    }
+    initQuery(&so->queries[i], key, meta->siglen);
+  }
+
+  /* a NULL ordering argument makes all the distances NULL */
+  if (scan->numberOfOrderBys > 0 &&
+      !(scan->orderByData[0].sk_flags & SK_ISNULL)) {
+    so->ordered = true;
+    initQuery(&so->order, &scan->orderByData[0], meta->siglen);
+    so->queue = pairingheap_allocate(cmpMatches, NULL);
+  }
+
+  nbits = meta->siglen * 8;
+  so->scan = palloc(sizeof(BfpPopcountScanPartition) * meta->npartitions);
+  so->nscan = 0;
+  for (p = 0; p < meta->npartitions; ++p) {
+    uint32 minWeight = p * meta->bucketWidth;
+    uint32 maxWeight = Min(minWeight + meta->bucketWidth - 1, nbits);
+
+    if (!rangeMayMatch(so, minWeight, maxWeight)) {
+      continue;
+    }
+    so->scan[so->nscan].partition = p;
+    so->scan[so->nscan].bound =
+        so->ordered ? maxSimilarity(&so->order, minWeight, maxWeight) : 0.0;
+    ++so->nscan;
+  }
+  if (so->ordered) {
+    qsort(so->scan, so->nscan, sizeof(BfpPopcountScanPartition),
+          cmpScanPartitions);
+  }
+
+  so->nextBlock = InvalidBlockNumber;
+  so->tids = palloc(sizeof(ItemPointerData) * meta->capacity);
+  so->common = palloc(sizeof(int) * meta->capacity);
+  so->matches = palloc(sizeof(bool) * meta->capacity);
+
+  MemoryContextSwitchTo(oldCtx);
+}
+
+/* the position of the next partition to scan, or -1 if none is left */
+static int claimPartition(IndexScanDesc scan, bool peek) {
+  BfpPopcountScanOpaque so = (BfpPopcountScanOpaque)scan->opaque;
+  uint32 next;
+
+  if (scan->parallel_scan != NULL) {
+    BfpPopcountParallelScanData *ps = BfpPopcountGetParallelScan(scan);
+
+    next = peek ? pg_atomic_read_u32(&ps->next)
+                : pg_atomic_fetch_add_u32(&ps->next, 1);
+  } else {
+    next = peek ? so->nextScan : so->nextScan++;
+  }
+  return (next < so->nscan) ? (int)next : -1;
+}
+
+/* check the entries on a page against the scan keys */
+static void scanPage(BfpPopcountScanOpaque so, Page page) {
+  uint32 capacity = so->meta->capacity;
+  uint32 siglen = so->meta->siglen;
+  uint32 n = BfpPopcountPageGetOpaque(page)->nitems;
+  ItemPointer tids = BfpPopcountPageGetTids(page);
+  uint32 *weights = BfpPopcountPageGetWeights(page, capacity);
+  uint8 *fps = BfpPopcountPageGetFps(page, capacity);
+  uint32 i;
+  int k;
+
+  memset(so->matches, true, sizeof(bool) * n);
+  for (k = 0; k < so->nqueries; ++k) {
+    BfpPopcountQuery *query = &so->queries[k];
+
+    bitstringIntersectionWeights(siglen, query->fp, n, fps, so->common);
+    for (i = 0; i < n; ++i) {
+      if (so->matches[i] &&
+          similarity(query->strategy, so->common[i], weights[i],
+                     query->weight) < query->threshold) {
+        so->matches[i] = false;
+      }
+    }
+  }
+
+  if (so->ordered) {
+    bitstringIntersectionWeights(siglen, so->order.fp, n, fps, so->common);
+    for (i = 0; i < n; ++i) {
+      BfpPopcountMatch *match;
+
+      if (!so->matches[i]) {
+        continue;
+      }
+      match = MemoryContextAlloc(so->ctx, sizeof(BfpPopcountMatch));
+      match->tid = tids[i];
+      match->similarity = similarity(so->order.strategy, so->common[i],
+                                     weights[i], so->order.weight);
+      pairingheap_add(so->queue, &match->ph_node);
+    }
+  } else {
+    so->ntids = 0;
+    so->curtid = 0;
+    for (i = 0; i < n; ++i) {
+      if (so->matches[i]) {
+        so->tids[so->ntids++] = tids[i];
+      }
+    }
+  }
+}
+
+/* scan the next page, returns false once all the partitions are done */
+static bool nextPage(IndexScanDesc scan) {
+  BfpPopcountScanOpaque so = (BfpPopcountScanOpaque)scan->opaque;
+  Buffer buffer;
+  Page page;
+
+  while (!BlockNumberIsValid(so->nextBlock)) {
+    BfpPopcountPartition *partition;
+    int pos = claimPartition(scan, false);
+
+    if (pos < 0) {
+      return false;
+    }
+    partition = &so->meta->partitions[so->scan[pos].partition];
+    if (rangeMayMatch(so, partition->minWeight, partition->maxWeight)) {
+      so->nextBlock = partition->head;
+      so->bound = so->scan[pos].bound;
+    }
+  }
+
+  CHECK_FOR_INTERRUPTS();
+
+  buffer = ReadBuffer(scan->indexRelation, so->nextBlock);
+  LockBuffer(buffer, BUFFER_LOCK_SHARE);
+  page = BufferGetPage(buffer);
+  scanPage(so, page);
+  so->nextBlock = BfpPopcountPageGetOpaque(page)->next;
+  UnlockReleaseBuffer(buffer);
+
+  return true;
+}
+
+/*
+ * the bound on the similarity of the entries which were not scanned yet,
+ * -1 if none is left
+ */
+static double remainingBound(IndexScanDesc scan) {
+  BfpPopcountScanOpaque so = (BfpPopcountScanOpaque)scan->opaque;
+  double bound = -1.0;
+  int pos;
+
+  if (BlockNumberIsValid(so->nextBlock)) {
+    bound = so->bound;
+  }
+  pos = claimPartition(scan, true);
+  if (pos >= 0) {
+    bound = Max(bound, so->scan[pos].bound);
+  }
+  return bound;
+}
+
+static void setOrderByValues(IndexScanDesc scan, double similarity,
+                             bool isnull) {
+  int i;
+
+  for (i = 0; i < scan->numberOfOrderBys; ++i) {
+    if (i == 0) {
+      scan->xs_orderbyvals[i] = isnull ? (Datum)0
+                                       : Float8GetDatum(1.0 - similarity);
+      scan->xs_orderbynulls[i] = isnull;
+    } else {
+      /*
+       * only the first ordering is applied by the index, return a lower
+       * bound for the others and let the executor sort the ties
+       */
+      scan->xs_orderbyvals[i] = Float8GetDatum(0.0);
+      scan->xs_orderbynulls[i] = false;
+    }
+  }
+  scan->xs_recheckorderby = scan->numberOfOrderBys > 1;
+}
+
+static bool bfpPopcountGetTuple(IndexScanDesc scan, ScanDirection dir) {
+  BfpPopcountScanOpaque so = (BfpPopcountScanOpaque)scan->opaque;
+
+  if (!so->started) {
+    startScan(scan);
+  }
+  if (so->empty) {
+    return false;
+  }
+  scan->xs_recheck = false;
+
+  if (!so->ordered) {
+    while (so->curtid >= so->ntids) {
+      if (!nextPage(scan)) {
+        return false;
+      }
+    }
+    scan->xs_heaptid = so->tids[so->curtid++];
+    setOrderByValues(scan, 0.0, true);
+    return true;
+  }
+
+  for (;;) {
+    if (!pairingheap_is_empty(so->queue)) {
+      BfpPopcountMatch *match = pairingheap_container(
+          BfpPopcountMatch, ph_node, pairingheap_first(so->queue));
+
+      /* no entry left to scan can be more similar than this one */
+      if (match->similarity >= remainingBound(scan)) {
+        pairingheap_remove_first(so->queue);
+        scan->xs_heaptid = match->tid;
+        setOrderByValues(scan, match->similarity, false);
+        pfree(match);
+        return true;
+      }
+    }
+    if (!nextPage(scan) && pairingheap_is_empty(so->queue)) {
+      return false;
+    }
+  }
+}
+
+static int64 bfpPopcountGetBitmap(IndexScanDesc scan, TIDBitmap *tbm) {
+  BfpPopcountScanOpaque so = (BfpPopcountScanOpaque)scan->opaque;
+  int64 ntids = 0;
+
+  if (!so->started) {
+    startScan(scan);
+  }
+  if (so->empty) {
+    return 0;
+  }
+
+  while (nextPage(scan)) {
+    tbm_add_tuples(tbm, so->tids, so->ntids, false);
+    ntids += so->ntids;
+  }
+  return ntids;
+}
+
+static IndexScanDesc bfpPopcountBeginScan(Relation index, int nkeys,
+                                          int norderbys) {
+  IndexScanDesc scan;
+  BfpPopcountScanOpaque so;
+
+  scan = RelationGetIndexScan(index, nkeys, norderbys);
+
+  so = (BfpPopcountScanOpaque)palloc0(sizeof(BfpPopcountScanOpaqueData));
+  so->ctx = AllocSetContextCreate(CurrentMemoryContext,
+                                  "bfp_popcount scan context",
+                                  ALLOCSET_DEFAULT_SIZES);
+  scan->opaque = so;
+
+  if (norderbys > 0) {
+    scan->xs_orderbyvals = palloc0(sizeof(Datum) * norderbys);
+    scan->xs_orderbynulls = palloc(sizeof(bool) * norderbys);
+    memset(scan->xs_orderbynulls, true, sizeof(bool) * norderbys);
+  }
+
+  return scan;
+}
+
+static void bfpPopcountRescan(IndexScanDesc scan, ScanKey keys, int nkeys,
+                              ScanKey orderbys, int norderbys) {
+  BfpPopcountScanOpaque so = (BfpPopcountScanOpaque)scan->opaque;
+  MemoryContext ctx = so->ctx;
+
+  MemoryContextReset(ctx);
+  memset(so, 0, sizeof(BfpPopcountScanOpaqueData));
+  so->ctx = ctx;
+
+  if (keys && scan->numberOfKeys > 0) {
+    memmove(scan->keyData, keys, scan->numberOfKeys * sizeof(ScanKeyData));
+  }
+  if (orderbys && scan->numberOfOrderBys > 0) {
+    memmove(scan->orderByData, orderbys,
+            scan->numberOfOrderBys * sizeof(ScanKeyData));
+  }
+}
+
+static void bfpPopcountEndScan(IndexScanDesc scan) {
+  BfpPopcountScanOpaque so = (BfpPopcountScanOpaque)scan->opaque;
+
+  MemoryContextDelete(so->ctx);
+  pfree(so);
+}
+
+#if PG_VERSION_NUM >= 180000
+static Size bfpPopcountEstimateParallelScan(Relation index, int nkeys,
+                                            int norderbys) {
+#elif PG_VERSION_NUM >= 170000
+static Size bfpPopcountEstimateParallelScan(int nkeys, int norderbys) {
+#else
+static Size bfpPopcountEstimateParallelScan(void) {
+#endif
+  return sizeof(BfpPopcountParallelScanData);
+}
+
+static void bfpPopcountInitParallelScan(void *target) {
+  BfpPopcountParallelScanData *ps = (BfpPopcountParallelScanData *)target;
+
+  pg_atomic_init_u32(&ps->next, 0);
+}
+
+static void bfpPopcountParallelRescan(IndexScanDesc scan) {
+  pg_atomic_write_u32(&BfpPopcountGetParallelScan(scan)->next, 0);
+}
+
+/*********** Access method **********/
+
+static void bfpPopcountCostEstimate(PlannerInfo *root, IndexPath *path,
+                                    double loop_count,
+                                    Cost *indexStartupCost,
+                                    Cost *indexTotalCost,
+                                    Selectivity *indexSelectivity,
+                                    double *indexCorrelation,
+                                    double *indexPages) {
+  GenericCosts costs;
+
+  MemSet(&costs, 0, sizeof(costs));
+  genericcostestimate(root, path, loop_count, &costs);
+
+  *indexStartupCost = costs.indexStartupCost;
+  *indexTotalCost = costs.indexTotalCost;
+  *indexSelectivity = costs.indexSelectivity;
+  *indexCorrelation = costs.indexCorrelation;
+  *indexPages = costs.numIndexPages;
+}
+
+static bytea *bfpPopcountOptions(Datum reloptions, bool validate) {
+  if (validate && DatumGetPointer(reloptions) != NULL) {
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                    errmsg("bfp_popcount indexes do not have options")));
+  }
+  return NULL;
+}
+
+/* check the operators of an operator class, like blvalidate() does */
+static bool bfpPopcountValidate(Oid opclassoid) {
+  bool result = true;
+  HeapTuple classtup, familytup;
+  Form_pg_opclass classform;
+  Form_pg_opfamily familyform;
+  Oid opfamilyoid, opcintype;
+  char *opfamilyname;
+  CatCList *oprlist, *proclist;
+  int i;
+
+  classtup = SearchSysCache1(CLAOID, ObjectIdGetDatum(opclassoid));
+  if (!HeapTupleIsValid(classtup)) {
+    elog(ERROR, "cache lookup failed for operator class %u", opclassoid);
+  }
+  classform = (Form_pg_opclass)GETSTRUCT(classtup);
+  opfamilyoid = classform->opcfamily;
+  opcintype = classform->opcintype;
+
+  familytup = SearchSysCache1(OPFAMILYOID, ObjectIdGetDatum(opfamilyoid));
+  if (!HeapTupleIsValid(familytup)) {
+    elog(ERROR, "cache lookup failed for operator family %u", opfamilyoid);
+  }
+  familyform = (Form_pg_opfamily)GETSTRUCT(familytup);
+  opfamilyname = NameStr(familyform->opfname);
+
+  /* the access method has no support functions */
+  proclist = SearchSysCacheList1(AMPROCNUM, ObjectIdGetDatum(opfamilyoid));
+  for (i = 0; i < proclist->n_members; i++) {
+    Form_pg_amproc procform =
+        (Form_pg_amproc)GETSTRUCT(&proclist->members[i]->tuple);
+
+    ereport(INFO,
+            (errcode(ERRCODE_INVALID_OBJECT_DEFINITION),
+             errmsg("operator family \"%s\" of access method %s contains "
+                    "function %s with invalid support number %d",
+                    opfamilyname, "bfp_popcount",
+                    format_procedure(procform->amproc),
+                    procform->amprocnum)));
+    result = false;
+  }
+
+  oprlist = SearchSysCacheList1(AMOPSTRATEGY, ObjectIdGetDatum(opfamilyoid));
+  for (i = 0; i < oprlist->n_members; i++) {
+    Form_pg_amop oprform =
+        (Form_pg_amop)GETSTRUCT(&oprlist->members[i]->tuple);
+    bool isOrdering;
+
+    if (oprform->amopstrategy < 1 ||
+        oprform->amopstrategy > RDKitOrderByDiceStrategy) {
+      ereport(INFO,
+              (errcode(ERRCODE_INVALID_OBJECT_DEFINITION),
+               errmsg("operator family \"%s\" of access method %s contains "
+                      "operator %s with invalid strategy number %d",
+                      opfamilyname, "bfp_popcount",
+                      format_operator(oprform->amopopr),
+                      oprform->amopstrategy)));
+      result = false;
+      continue;
+    }
+
+    /* the similarity searches are filters, the distances orderings */
+    isOrdering = oprform->amopstrategy == RDKitOrderByTanimotoStrategy ||
+                 oprform->amopstrategy == RDKitOrderByDiceStrategy;
+    if (oprform->amoppurpose != (isOrdering ? AMOP_ORDER : AMOP_SEARCH)) {
+      ereport(INFO,
+              (errcode(ERRCODE_INVALID_OBJECT_DEFINITION),
+               errmsg("operator family \"%s\" of access method %s contains "
+                      "invalid ORDER BY specification for operator %s",
+                      opfamilyname, "bfp_popcount",
+                      format_operator(oprform->amopopr))));
+      result = false;
+    }
+
+    if (!check_amop_signature(
+            oprform->amopopr,
+            isOrdering ? get_op_rettype(oprform->amopopr) : BOOLOID,
+            opcintype, opcintype)) {
+      ereport(INFO,
+              (errcode(ERRCODE_INVALID_OBJECT_DEFINITION),
+               errmsg("operator family \"%s\" of access method %s contains "
+                      "operator %s with wrong signature",
+                      opfamilyname, "bfp_popcount",
+                      format_operator(oprform->amopopr))));
+      result = false;
+    }
+  }
+
+  ReleaseCatCacheList(proclist);
+  ReleaseCatCacheList(oprlist);
+  ReleaseSysCache(familytup);
+  ReleaseSysCache(classtup);
+
+  return result;
+}
+
+PGDLLEXPORT Datum bfp_popcount_handler(PG_FUNCTION_ARGS);
+PG_FUNCTION_INFO_V1(bfp_popcount_handler);
+Datum bfp_popcount_handler(PG_FUNCTION_ARGS) {
+  IndexAmRoutine *amroutine = makeNode(IndexAmRoutine);
+
+  amroutine->amstrategies = RDKitOrderByDiceStrategy;
+  amroutine->amsupport = 0;
+  amroutine->amcanorder = false;
+  amroutine->amcanorderbyop = true;
+  amroutine->amcanbackward = false;
+  amroutine->amcanunique = false;
+  amroutine->amcanmulticol = false;
+  amroutine->amoptionalkey = true;
+  amroutine->amsearcharray = false;
+  amroutine->amsearchnulls = false;
+  amroutine->amstorage = false;
+  amroutine->amclusterable = false;
+  amroutine->ampredlocks = false;
+  amroutine->amcanparallel = true;
+  amroutine->amcaninclude = false;
+#if PG_VERSION_NUM >= 130000
+  amroutine->amusemaintenanceworkmem = false;
+  amroutine->amparallelvacuumoptions = VACUUM_OPTION_PARALLEL_BULKDEL;
+#endif
+  amroutine->amkeytype = InvalidOid;
+
+  amroutine->ambuild = bfpPopcountBuild;
+  amroutine->ambuildempty = bfpPopcountBuildEmpty;
+  amroutine->aminsert = bfpPopcountInsert;
+  amroutine->ambulkdelete = bfpPopcountBulkDelete;
+  amroutine->amvacuumcleanup = bfpPopcountVacuumCleanup;
+  amroutine->amcanreturn = NULL;
+  amroutine->amcostestimate = bfpPopcountCostEstimate;
+  amroutine->amoptions = bfpPopcountOptions;
+  amroutine->amproperty = NULL;
+  amroutine->ambuildphasename = NULL;
+  amroutine->amvalidate = bfpPopcountValidate;
+  amroutine->ambeginscan = bfpPopcountBeginScan;
+  amroutine->amrescan = bfpPopcountRescan;
+  amroutine->amgettuple = bfpPopcountGetTuple;
+  amroutine->amgetbitmap = bfpPopcountGetBitmap;
+  amroutine->amendscan = bfpPopcountEndScan;
+  amroutine->ammarkpos = NULL;
+  amroutine->amrestrpos = NULL;
+  amroutine->amestimateparallelscan = bfpPopcountEstimateParallelScan;
+  amroutine->aminitparallelscan = bfpPopcountInitParallelScan;
+  amroutine->amparallelrescan = bfpPopcountParallelRescan;
+
+  PG_RETURN_POINTER(amroutine);
+}
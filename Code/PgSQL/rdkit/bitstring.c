@@ -42,6 +42,11 @@ typedef unsigned int POPCNT_TYPE;
 typedef unsigned long long POPCNT_TYPE;
 #endif
 
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define RDK_AVX2_POPCNT
+#endif
+
 #endif
 
 #include "bitstring.h"
@@ -333,6 +338,67 @@ double bitstringTanimotoDistance(int length, uint8 *bstr1, uint8 *bstr2) {
   return 1. - bitstringTanimotoSimilarity(length, bstr1, bstr2);
 }
 
+#ifdef RDK_AVX2_POPCNT
+/*
+ * count the bits 32 bytes at a time, looking up the counts of the
+ * nibbles with a byte shuffle (Mula, Kurz and Lemire, "Faster Population
+ * Counts Using AVX2 Instructions")
+ */
+__attribute__((target("avx2"))) static void bitstringIntersectionWeightsAVX2(
+    int length, uint8 *bstr, int nbstrs, uint8 *bstrs, int *weights) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                       2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  const __m256i zero = _mm256_setzero_si256();
+  int nblocks = length / 32;
+  int tail = nblocks * 32;
+  int i, j;
+
+  for (i = 0; i < nbstrs; ++i) {
+    uint8 *bstr2 = bstrs + (size_t)i * length;
+    __m256i acc = zero;
+
+    for (j = 0; j < nblocks; ++j) {
+      __m256i v = _mm256_and_si256(
+          _mm256_loadu_si256((const __m256i *)(bstr + 32 * j)),
+          _mm256_loadu_si256((const __m256i *)(bstr2 + 32 * j)));
+      __m256i lo = _mm256_and_si256(v, low_mask);
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+      __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                       _mm256_shuffle_epi8(lookup, hi));
+      acc = _mm256_add_epi64(acc, _mm256_sad_epu8(counts, zero));
+    }
+
+    weights[i] = (int)(_mm256_extract_epi64(acc, 0) +
+                       _mm256_extract_epi64(acc, 1) +
+                       _mm256_extract_epi64(acc, 2) +
+                       _mm256_extract_epi64(acc, 3));
+    if (tail < length) {
+      weights[i] += bitstringIntersectionWeight(length - tail, bstr + tail,
+                                                bstr2 + tail);
+    }
+  }
+}
+#endif
+
+void bitstringIntersectionWeights(int length, uint8 *bstr, int nbstrs,
+                                  uint8 *bstrs, int *weights) {
+  int i;
+
+#ifdef RDK_AVX2_POPCNT
+  if (length >= 64 && __builtin_cpu_supports("avx2")) {
+    bitstringIntersectionWeightsAVX2(length, bstr, nbstrs, bstrs, weights);
+    return;
+  }
+#endif
+
+  for (i = 0; i < nbstrs; ++i) {
+    weights[i] =
+        bitstringIntersectionWeight(length, bstr, bstrs + (size_t)i * length);
+  }
+}
+
 bool bitstringContains(int length, uint8 *bstr1, uint8 *bstr2) {
   bool contains = true;
   uint8 *bstr1_end = bstr1 + length;
@@ -43,6 +43,12 @@ void bitstringIntersection(int length, uint8 *bstr1, uint8 *bstr2);
 int bitstringWeight(int length, uint8 *bstr);
 int bitstringIntersectionWeight(int length, uint8 *bstr1, uint8 *bstr2);
 int bitstringDifferenceWeight(int length, uint8 *bstr1, uint8 *bstr2);
+/*
+ * compute the intersection weights of bstr with each of the nbstrs
+ * bitstrings stored one after the other in bstrs
+ */
+void bitstringIntersectionWeights(int length, uint8 *bstr, int nbstrs,
+                                  uint8 *bstrs, int *weights);
 
 int bitstringHemDistance(int length, uint8 *bstr1, uint8 *bstr2);
 double bitstringTanimotoSimilarity(int length, uint8 *bstr1, uint8 *bstr2);
@@ -35,6 +35,7 @@
 
 #include "rdkit.h"
 #include "cache.h"
+#include "shared_cache.h"
 
 #define MAGICKNUMBER 0xBEEC0DED
 /*
@@ -357,6 +358,25 @@ static ValueCache *createCache(void *cache, struct MemoryContextData *ctx) {
 
 /*********** SEARCHING **********/
 
+/*
+ * detoast the cached value into the cache memory context, going through
+ * the shared cache (if enabled)
+ */
+static void *detoastEntry(ValueCache *ac, ValueCacheEntry *entry) {
+  struct varlena *detoasted;
+  void *value;
+  SharedCacheLookup lookup;
+
+  value = fetchSharedCache(entry->toastedValue, ac->ctx, &lookup);
+  if (value == NULL) {
+    detoasted = PG_DETOAST_DATUM(entry->toastedValue);
+    value = MemoryContextAlloc(ac->ctx, VARSIZE(detoasted));
+    memcpy(value, detoasted, VARSIZE(detoasted));
+    storeSharedCache(&lookup, value);
+  }
+  return value;
+}
+
 /*
  * entry->kind == MolKind
  *      m, mol, fp, val
@@ -373,13 +393,7 @@ static void fetchData(ValueCache *ac, ValueCacheEntry *entry, void **detoasted,
     case MolKind:
       if (detoasted) {
         if (entry->detoasted.mol.value == NULL) {
-          Mol *detoastedMol;
-
-          detoastedMol = DatumGetMolP(entry->toastedValue);
-          entry->detoasted.mol.value =
-              MemoryContextAlloc(ac->ctx, VARSIZE(detoastedMol));
-          memcpy(entry->detoasted.mol.value, detoastedMol,
-                 VARSIZE(detoastedMol));
+          entry->detoasted.mol.value = detoastEntry(ac, entry);
         }
         *detoasted = entry->detoasted.mol.value;
       }
@@ -406,13 +420,7 @@ static void fetchData(ValueCache *ac, ValueCacheEntry *entry, void **detoasted,
     case XQMolKind:
       if (detoasted) {
         if (entry->detoasted.xqmol.value == NULL) {
-          XQMol *detoastedMol;
-
-          detoastedMol = DatumGetXQMolP(entry->toastedValue);
-          entry->detoasted.xqmol.value =
-              MemoryContextAlloc(ac->ctx, VARSIZE(detoastedMol));
-          memcpy(entry->detoasted.xqmol.value, detoastedMol,
-                 VARSIZE(detoastedMol));
+          entry->detoasted.xqmol.value = detoastEntry(ac, entry);
         }
         *detoasted = entry->detoasted.xqmol.value;
       }
@@ -441,12 +449,7 @@ static void fetchData(ValueCache *ac, ValueCacheEntry *entry, void **detoasted,
     case BfpKind:
       if (detoasted) {
         if (entry->detoasted.bfp.value == NULL) {
-          Bfp *detoastedFP;
-
-          detoastedFP = DatumGetBfpP(entry->toastedValue);
-          entry->detoasted.bfp.value =
-              MemoryContextAlloc(ac->ctx, VARSIZE(detoastedFP));
-          memcpy(entry->detoasted.bfp.value, detoastedFP, VARSIZE(detoastedFP));
+          entry->detoasted.bfp.value = detoastEntry(ac, entry);
         }
         *detoasted = entry->detoasted.bfp.value;
       }
@@ -472,12 +475,7 @@ static void fetchData(ValueCache *ac, ValueCacheEntry *entry, void **detoasted,
     case SfpKind:
       if (detoasted) {
         if (entry->detoasted.sfp.value == NULL) {
-          Sfp *detoastedFP;
-
-          detoastedFP = DatumGetSfpP(entry->toastedValue);
-          entry->detoasted.sfp.value =
-              MemoryContextAlloc(ac->ctx, VARSIZE(detoastedFP));
-          memcpy(entry->detoasted.sfp.value, detoastedFP, VARSIZE(detoastedFP));
+          entry->detoasted.sfp.value = detoastEntry(ac, entry);
         }
         *detoasted = entry->detoasted.sfp.value;
       }
@@ -504,13 +502,7 @@ static void fetchData(ValueCache *ac, ValueCacheEntry *entry, void **detoasted,
     case ReactionKind:
       if (detoasted) {
         if (entry->detoasted.reaction.value == NULL) {
-          Reaction *detoastedRxn;
-
-          detoastedRxn = DatumGetReactionP(entry->toastedValue);
-          entry->detoasted.reaction.value =
-              MemoryContextAlloc(ac->ctx, VARSIZE(detoastedRxn));
-          memcpy(entry->detoasted.reaction.value, detoastedRxn,
-                 VARSIZE(detoastedRxn));
+          entry->detoasted.reaction.value = detoastEntry(ac, entry);
         }
         *detoasted = entry->detoasted.reaction.value;
       }
@@ -35,6 +35,7 @@
 #include <utils/guc.h>
 
 #include "guc.h"
+#include "shared_cache.h"
 
 static double rdkit_tanimoto_smlar_limit = 0.5;
 static double rdkit_dice_smlar_limit = 0.5;
@@ -76,6 +77,7 @@ static int rdkit_reaction_sss_fp_type = REACTION_SSS_FP_TYPE;
 static int rdkit_reaction_difference_fp_type = REACTION_DIFFERENCE_FP_TYPE;
 static int rdkit_difference_FP_weight_agents = REACTION_DFP_WEIGHT_AGENTS;
 static int rdkit_difference_FP_weight_nonagents = REACTION_DFP_WEIGHT_NONAGENTS;
+static int rdkit_shared_cache_size = 0;
 
 static void initRDKitGUC() {
   if (rdkit_guc_inited) {
@@ -204,6 +206,13 @@ static void initRDKitGUC() {
       "rdkit.avalon_fp_size", "Size (in bits) of avalon fingerprints",
       "Size (in bits) of avalon fingerprints", &rdkit_avalon_fp_size,
       AVALON_FP_SIZE, 64, 9192, PGC_USERSET, 0, NULL, NULL, NULL);
+
+  DefineCustomIntVariable(
+      "rdkit.shared_cache_size",
+      "Size of the shared memory cache of detoasted molecules and fingerprints",
+      "The cache is only available if rdkit is in shared_preload_libraries. Zero (the default) disables it.",
+      &rdkit_shared_cache_size, 0, 0, MAX_KILOBYTES, PGC_POSTMASTER,
+      GUC_UNIT_KB, NULL, NULL, NULL);
   rdkit_guc_inited = true;
 }
 
@@ -372,5 +381,15 @@ int getReactionDifferenceFPWeightNonagents(void) {
   return rdkit_difference_FP_weight_nonagents;
 }
 
+int getSharedCacheSize(void) {
+  if (!rdkit_guc_inited) {
+    initRDKitGUC();
+  }
+  return rdkit_shared_cache_size;
+}
+
 PGDLLEXPORT void _PG_init(void);
-void _PG_init(void) { initRDKitGUC(); }
+void _PG_init(void) {
+  initRDKitGUC();
+  initSharedCache();
+}
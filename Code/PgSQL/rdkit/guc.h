@@ -60,6 +60,7 @@ double getThresholdUnmappedReactantAtoms(void);
 bool getInitReaction(void);
 int getReactionDifferenceFPWeightNonagents(void);
 int getReactionDifferenceFPWeightAgents(void);
+int getSharedCacheSize(void);
 
 #ifdef __cplusplus
 }
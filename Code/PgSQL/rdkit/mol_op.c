@@ -291,6 +291,30 @@ Datum mol_xq_rsubstruct_query(PG_FUNCTION_ARGS) {
     PG_RETURN_##ret(func(i));                                             \
   }
 
+/*
+ * the atom counts are read directly from the pickle when possible, so
+ * the molecule is only built (and cached) when that fails. The cache is
+ * then given the value which was already detoasted.
+ */
+#define MOLPICKLEDESCR(name, pfunc, func, ret)                              \
+  PGDLLEXPORT Datum mol_##name(PG_FUNCTION_ARGS);                           \
+  PG_FUNCTION_INFO_V1(mol_##name);                                          \
+  Datum mol_##name(PG_FUNCTION_ARGS) {                                      \
+    CROMol i;                                                               \
+    Mol *data = PG_GETARG_MOL_P(0);                                         \
+    int res = pfunc(data);                                                  \
+    if (res < 0) {                                                          \
+      fcinfo->flinfo->fn_extra =                                            \
+          searchMolCache(fcinfo->flinfo->fn_extra, fcinfo->flinfo->fn_mcxt, \
+                         PointerGetDatum(data), NULL, &i, NULL);            \
+      res = func(i);                                                        \
+    }                                                                       \
+    PG_RETURN_##ret(res);                                                   \
+  }
+
+MOLPICKLEDESCR(numatoms, MolPickleNumAtoms, MolNumAtoms, INT32)
+MOLPICKLEDESCR(numheavyatoms, MolPickleNumHeavyAtoms, MolNumHeavyAtoms, INT32)
+
 MOLDESCR(amw, MolAMW, FLOAT4)
 MOLDESCR(exactmw, MolExactMW, FLOAT4)
 MOLDESCR(logp, MolLogP, FLOAT4)
@@ -298,8 +322,6 @@ MOLDESCR(tpsa, MolTPSA, FLOAT4)
 MOLDESCR(labuteasa, MolLabuteASA, FLOAT4)
 MOLDESCR(hba, MolHBA, INT32)
 MOLDESCR(hbd, MolHBD, INT32)
-MOLDESCR(numatoms, MolNumAtoms, INT32)
-MOLDESCR(numheavyatoms, MolNumHeavyAtoms, INT32)
 MOLDESCR(numrotatablebonds, MolNumRotatableBonds, INT32)
 MOLDESCR(numheteroatoms, MolNumHeteroatoms, INT32)
 MOLDESCR(numrings, MolNumRings, INT32)
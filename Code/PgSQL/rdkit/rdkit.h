@@ -155,6 +155,8 @@ int MolHBA(CROMol i);
 int MolHBD(CROMol i);
 int MolNumAtoms(CROMol i);
 int MolNumHeavyAtoms(CROMol i);
+int MolPickleNumAtoms(Mol *data);
+int MolPickleNumHeavyAtoms(Mol *data);
 int MolNumRotatableBonds(CROMol i);
 int MolNumHeteroatoms(CROMol i);
 int MolNumRings(CROMol i);
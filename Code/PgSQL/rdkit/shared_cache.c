@@ -0,0 +1,448 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include <postgres.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <miscadmin.h>
+#include <access/htup_details.h>
+#include <access/transam.h>
+#if PG_VERSION_NUM >= 130000
+#include <access/detoast.h>
+#include <common/hashfn.h>
+#else
+#include <access/hash.h>
+#include <access/tuptoaster.h>
+#endif
+#include <port/atomics.h>
+#include <storage/ipc.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+#include <utils/hsearch.h>
+
+#include "rdkit.h"
+#include "guc.h"
+#include "shared_cache.h"
+
+#define SHARED_CACHE_TRANCHE "rdkit_shared_cache"
+
+/* the hash table is sized assuming this average size of the records */
+#define AVG_RECORD_SIZE (128)
+
+/* larger values are not cached, to avoid evicting too many others */
+#define MAX_RECORD_FRACTION (16)
+
+#if PG_VERSION_NUM >= 170000
+#define OID_COUNTER (TransamVariables->nextOid)
+#else
+#define OID_COUNTER (ShmemVariableCache->nextOid)
+#endif
+
+/* the hash table entry locating a value in the ring */
+typedef struct SharedCacheEntry {
+  SharedCacheKey key; /* must be first */
+  uint64 position;
+} SharedCacheEntry;
+
+/*
+ * the header stored in the ring in front of each value. a header with a
+ * zero size marks the unused space at the end of the ring, when the next
+ * record did not fit there. for inline values the compressed value is
+ * stored between the header and the detoasted value.
+ */
+typedef struct SharedCacheRecord {
+  SharedCacheKey key;
+  uint32 oidEpoch; /* when the value was stored, see getOidEpoch() */
+  uint32 compressedSize; /* MAXALIGNed, 0 for values stored out of line */
+  uint32 size;           /* of the whole record, including the header */
+} SharedCacheRecord;
+
+#define RECORDHDRSZ MAXALIGN(sizeof(SharedCacheRecord))
+
+typedef struct SharedCache {
+  LWLock *lock;
+  uint64 capacity;
+  uint64 maxentries;
+  uint64 nentries;
+  /*
+   * positions in the ring only increase, the records between tail and
+   * head are live and the oldest one is at the tail. a record's offset
+   * in data is its position modulo the capacity.
+   */
+  uint64 head;
+  uint64 tail;
+  /* the OID counter the last time it was looked at, and its wraparounds */
+  pg_atomic_uint32 lastOid;
+  pg_atomic_uint32 oidEpoch;
+  pg_atomic_uint64 hits;
+  pg_atomic_uint64 misses;
+  pg_atomic_uint64 evictions;
+  char data[FLEXIBLE_ARRAY_MEMBER];
+} SharedCache;
+
+static SharedCache *sharedCache = NULL;
+static HTAB *sharedCacheIndex = NULL;
+
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prevShmemRequestHook = NULL;
+#endif
+static shmem_startup_hook_type prevShmemStartupHook = NULL;
+
+/*********** Shared memory setup **********/
+
+static uint64 getCapacity(void) {
+  return MAXALIGN_DOWN((uint64)getSharedCacheSize() * 1024);
+}
+
+static long getMaxEntries(void) {
+  return Max(getCapacity() / AVG_RECORD_SIZE, 1);
+}
+
+static Size sharedCacheShmemSize(void) {
+  return add_size(
+      add_size(offsetof(SharedCache, data), getCapacity()),
+      hash_estimate_size(getMaxEntries(), sizeof(SharedCacheEntry)));
+}
+
+static void sharedCacheShmemRequest(void) {
+#if PG_VERSION_NUM >= 150000
+  if (prevShmemRequestHook) {
+    prevShmemRequestHook();
+  }
+#endif
+  RequestAddinShmemSpace(sharedCacheShmemSize());
+  RequestNamedLWLockTranche(SHARED_CACHE_TRANCHE, 1);
+}
+
+static void sharedCacheShmemStartup(void) {
+  HASHCTL info;
+  bool found;
+
+  if (prevShmemStartupHook) {
+    prevShmemStartupHook();
+  }
+
+  LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+  sharedCache = ShmemInitStruct("rdkit shared cache",
+                                offsetof(SharedCache, data) + getCapacity(),
+                                &found);
+  if (!found) {
+    sharedCache->lock = &(GetNamedLWLockTranche(SHARED_CACHE_TRANCHE))->lock;
+    sharedCache->capacity = getCapacity();
+    sharedCache->maxentries = getMaxEntries();
+    sharedCache->nentries = 0;
+    sharedCache->head = 0;
+    sharedCache->tail = 0;
+    pg_atomic_init_u32(&sharedCache->lastOid, 0);
+    pg_atomic_init_u32(&sharedCache->oidEpoch, 0);
+    pg_atomic_init_u64(&sharedCache->hits, 0);
+    pg_atomic_init_u64(&sharedCache->misses, 0);
+    pg_atomic_init_u64(&sharedCache->evictions, 0);
+  }
+
+  memset(&info, 0, sizeof(info));
+  info.keysize = sizeof(SharedCacheKey);
+  info.entrysize = sizeof(SharedCacheEntry);
+  sharedCacheIndex =
+      ShmemInitHash("rdkit shared cache index", getMaxEntries(),
+                    getMaxEntries(), &info, HASH_ELEM | HASH_BLOBS);
+
+  LWLockRelease(AddinShmemInitLock);
+}
+
+void initSharedCache(void) {
+  /*
+   * the shared memory can only be requested while the libraries in
+   * shared_preload_libraries are loaded; otherwise the cache stays disabled
+   */
+  if (!process_shared_preload_libraries_in_progress ||
+      getSharedCacheSize() <= 0) {
+    return;
+  }
+
+#if PG_VERSION_NUM >= 150000
+  prevShmemRequestHook = shmem_request_hook;
+  shmem_request_hook = sharedCacheShmemRequest;
+#else
+  sharedCacheShmemRequest();
+#endif
+  prevShmemStartupHook = shmem_startup_hook;
+  shmem_startup_hook = sharedCacheShmemStartup;
+}
+
+/*********** Managing the ring **********/
+
+static SharedCacheRecord *getRecord(uint64 position) {
+  return (SharedCacheRecord *)(sharedCache->data +
+                               position % sharedCache->capacity);
+}
+
+/* remove the oldest record, must be called holding the exclusive lock */
+static void evictOldest(void) {
+  uint64 offset = sharedCache->tail % sharedCache->capacity;
+  SharedCacheRecord *record;
+  SharedCacheEntry *entry;
+
+  Assert(sharedCache->tail < sharedCache->head);
+
+  if (sharedCache->capacity - offset < RECORDHDRSZ ||
+      getRecord(sharedCache->tail)->size == 0) {
+    /* skip the unused space at the end of the ring */
+    sharedCache->tail += sharedCache->capacity - offset;
+    return;
+  }
+
+  record = getRecord(sharedCache->tail);
+  entry = hash_search(sharedCacheIndex, &record->key, HASH_FIND, NULL);
+  if (entry && entry->position == sharedCache->tail) {
+    hash_search(sharedCacheIndex, &record->key, HASH_REMOVE, NULL);
+    sharedCache->nentries--;
+    pg_atomic_fetch_add_u64(&sharedCache->evictions, 1);
+  }
+  sharedCache->tail += record->size;
+}
+
+/*
+ * make space for a record of the given size at the head of the ring and
+ * return its position, must be called holding the exclusive lock
+ */
+static uint64 reserveSpace(uint32 size) {
+  uint64 position = sharedCache->head;
+  uint64 offset = position % sharedCache->capacity;
+
+  /*
+   * records never wrap around the end of the ring. since they are much
+   * smaller than the ring, evicting everything up to the head always
+   * leaves enough space.
+   */
+  if (offset + size > sharedCache->capacity) {
+    position += sharedCache->capacity - offset;
+  }
+
+  while (sharedCache->tail < sharedCache->head &&
+         (position + size - sharedCache->tail > sharedCache->capacity ||
+          sharedCache->nentries >= sharedCache->maxentries)) {
+    evictOldest();
+  }
+
+  if (position != sharedCache->head) {
+    if (sharedCache->capacity - offset >= RECORDHDRSZ) {
+      getRecord(sharedCache->head)->size = 0;
+    }
+    sharedCache->head = position;
+  }
+  return position;
+}
+
+/*
+ * returns the number of times the OID counter has been seen to wrap around.
+ * toast value OIDs are reused once the old value has been removed by
+ * VACUUM, but only after the counter has wrapped around, so the values
+ * stored before the last wraparound are not used. A wraparound is missed
+ * if the counter goes all the way around between two calls to this, when
+ * more than 4 billion OIDs are allocated without the cache being used.
+ */
+static uint32 getOidEpoch(void) {
+  Oid nextOid;
+  uint32 lastOid;
+
+  /*
+   * the counter only changes under the exclusive lock, so while holding
+   * the shared lock the values stored in lastOid only increase, apart
+   * from the wraparounds
+   */
+  LWLockAcquire(OidGenLock, LW_SHARED);
+  nextOid = OID_COUNTER;
+  lastOid = pg_atomic_read_u32(&sharedCache->lastOid);
+  while (nextOid != lastOid) {
+    if (pg_atomic_compare_exchange_u32(&sharedCache->lastOid, &lastOid,
+                                       nextOid)) {
+      if (nextOid < lastOid) {
+        pg_atomic_fetch_add_u32(&sharedCache->oidEpoch, 1);
+      }
+      break;
+    }
+  }
+  LWLockRelease(OidGenLock);
+  return pg_atomic_read_u32(&sharedCache->oidEpoch);
+}
+
+static void makeLookup(Datum a, SharedCacheLookup *lookup) {
+  struct varlena *attr = (struct varlena *)DatumGetPointer(a);
+
+  /* the key is hashed as a blob, clear the padding */
+  memset(lookup, 0, sizeof(SharedCacheLookup));
+  if (VARATT_IS_EXTERNAL_ONDISK(attr)) {
+    lookup->cacheable = true;
+    lookup->key.dbid = MyDatabaseId;
+    VARATT_EXTERNAL_GET_POINTER(lookup->key.pointer, attr);
+    lookup->oidEpoch = getOidEpoch();
+  } else if (VARATT_IS_COMPRESSED(attr)) {
+    lookup->cacheable = true;
+    lookup->key.hash =
+        DatumGetUInt32(hash_any((unsigned char *)attr, VARSIZE(attr)));
+    lookup->key.pointer.va_rawsize = VARSIZE(attr);
+    lookup->compressed = attr;
+  }
+}
+
+/* returns whether or not the record holds the value being looked up */
+static bool recordMatches(const SharedCacheRecord *record,
+                          const SharedCacheLookup *lookup) {
+  if (lookup->compressed) {
+    /* the hashes of different values may be the same */
+    return memcmp((const char *)record + RECORDHDRSZ, lookup->compressed,
+                  VARSIZE(lookup->compressed)) == 0;
+  }
+  return record->oidEpoch == lookup->oidEpoch;
+}
+
+/*********** Searching and storing **********/
+
+struct varlena *fetchSharedCache(Datum a, struct MemoryContextData *ctx,
+                                 SharedCacheLookup *lookup) {
+  SharedCacheEntry *entry;
+  struct varlena *result = NULL;
+
+  if (sharedCache == NULL) {
+    memset(lookup, 0, sizeof(SharedCacheLookup));
+    return NULL;
+  }
+  makeLookup(a, lookup);
+  if (!lookup->cacheable) {
+    return NULL;
+  }
+
+  LWLockAcquire(sharedCache->lock, LW_SHARED);
+  entry = hash_search(sharedCacheIndex, &lookup->key, HASH_FIND, NULL);
+  if (entry) {
+    SharedCacheRecord *record = getRecord(entry->position);
+    struct varlena *value =
+        (struct varlena *)((char *)record + RECORDHDRSZ +
+                           record->compressedSize);
+
+    if (recordMatches(record, lookup)) {
+      result = MemoryContextAlloc(ctx, VARSIZE(value));
+      memcpy(result, value, VARSIZE(value));
+    }
+  }
+  LWLockRelease(sharedCache->lock);
+
+  pg_atomic_fetch_add_u64(result ? &sharedCache->hits : &sharedCache->misses,
+                          1);
+  return result;
+}
+
+void storeSharedCache(const SharedCacheLookup *lookup,
+                      const struct varlena *value) {
+  SharedCacheEntry *entry;
+  SharedCacheRecord *record;
+  uint64 position;
+  uint32 compressedSize;
+  uint32 size;
+  bool found;
+
+  if (sharedCache == NULL || !lookup->cacheable) {
+    return;
+  }
+
+  compressedSize =
+      lookup->compressed ? MAXALIGN(VARSIZE(lookup->compressed)) : 0;
+  size = RECORDHDRSZ + compressedSize + MAXALIGN(VARSIZE(value));
+  if (size > sharedCache->capacity / MAX_RECORD_FRACTION) {
+    return;
+  }
+
+  /*
+   * the value is already in the backend's memory, so rather than waiting
+   * for the lock the value is not cached if another backend is busy
+   */
+  if (!LWLockConditionalAcquire(sharedCache->lock, LW_EXCLUSIVE)) {
+    return;
+  }
+
+  /*
+   * another backend may have stored the same value in the meantime. A
+   * value stored before an OID counter wraparound is replaced, its record
+   * stays in the ring until it is evicted.
+   */
+  entry = hash_search(sharedCacheIndex, &lookup->key, HASH_FIND, NULL);
+  if (entry && !lookup->compressed &&
+      !recordMatches(getRecord(entry->position), lookup)) {
+    hash_search(sharedCacheIndex, &lookup->key, HASH_REMOVE, NULL);
+    sharedCache->nentries--;
+    pg_atomic_fetch_add_u64(&sharedCache->evictions, 1);
+    entry = NULL;
+  }
+  if (!entry) {
+    position = reserveSpace(size);
+    entry =
+        hash_search(sharedCacheIndex, &lookup->key, HASH_ENTER_NULL, &found);
+    if (entry) {
+      Assert(!found);
+      entry->position = position;
+
+      record = getRecord(position);
+      record->key = lookup->key;
+      record->oidEpoch = lookup->oidEpoch;
+      record->compressedSize = compressedSize;
+      record->size = size;
+      if (lookup->compressed) {
+        memcpy((char *)record + RECORDHDRSZ, lookup->compressed,
+               VARSIZE(lookup->compressed));
+      }
+      memcpy((char *)record + RECORDHDRSZ + compressedSize, value,
+             VARSIZE(value));
+
+      sharedCache->head = position + size;
+      sharedCache->nentries++;
+    }
+  }
+
+  LWLockRelease(sharedCache->lock);
+}
+
+/*********** Statistics **********/
+
+PGDLLEXPORT Datum rdkit_shared_cache_stats(PG_FUNCTION_ARGS);
+PG_FUNCTION_INFO_V1(rdkit_shared_cache_stats);
+Datum rdkit_shared_cache_stats(PG_FUNCTION_ARGS) {
+  TupleDesc tupdesc;
+  Datum values[6];
+  bool nulls[6];
+  uint64 size = 0, used = 0, entries = 0;
+  uint64 hits = 0, misses = 0, evictions = 0;
+
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+    elog(ERROR, "return type must be a row type");
+  }
+
+  if (sharedCache != NULL) {
+    LWLockAcquire(sharedCache->lock, LW_SHARED);
+    size = sharedCache->capacity;
+    used = sharedCache->head - sharedCache->tail;
+    entries = sharedCache->nentries;
+    LWLockRelease(sharedCache->lock);
+
+    hits = pg_atomic_read_u64(&sharedCache->hits);
+    misses = pg_atomic_read_u64(&sharedCache->misses);
+    evictions = pg_atomic_read_u64(&sharedCache->evictions);
+  }
+
+  memset(nulls, 0, sizeof(nulls));
+  values[0] = Int64GetDatum((int64)size);
+  values[1] = Int64GetDatum((int64)used);
+  values[2] = Int64GetDatum((int64)entries);
+  values[3] = Int64GetDatum((int64)hits);
+  values[4] = Int64GetDatum((int64)misses);
+  values[5] = Int64GetDatum((int64)evictions);
+
+  PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
@@ -0,0 +1,89 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include <RDGeneral/export.h>
+#ifndef _RDKIT_SHARED_CACHE_H_
+#define _RDKIT_SHARED_CACHE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Shared detoasted value cache.
+ *
+ * The cache in cache.h lives in a per-backend memory context, so every
+ * query (and every parallel worker) has to fetch and decompress the
+ * toasted molecules and fingerprints it works with again. This module
+ * keeps a copy of the detoasted values in shared memory, where it is
+ * visible to all the backends of the cluster.
+ *
+ * Values that are stored out of line are keyed by the database and the
+ * toast pointer. Toast value OIDs can only be reused after the cluster's
+ * OID counter has wrapped around, so the cache watches the counter and
+ * ignores the values it stored before the last wraparound. Values that are
+ * compressed but stored inline are keyed by a hash of their compressed
+ * bytes, which are kept next to the detoasted value and compared on each
+ * lookup. Inline values that aren't compressed (which includes most bfp
+ * values) are not cached: detoasting those is only a copy, so there is
+ * nothing to save.
+ *
+ * The cache is a ring buffer: when it is full the oldest values are
+ * evicted to make space for new ones.
+ *
+ * The cache holds the detoasted varlena, which for molecules and reactions
+ * is their binary pickle. It saves the toast fetch and the decompression,
+ * but the pickles are still turned into molecule objects by each backend:
+ * those are C++ objects which can't be placed in shared memory.
+ *
+ * The cache is disabled unless the rdkit library is listed in
+ * shared_preload_libraries and rdkit.shared_cache_size is set to a
+ * non-zero value.
+ */
+
+/* identifies a value in the cache */
+typedef struct SharedCacheKey {
+  Oid dbid; /* InvalidOid for inline values */
+  uint32 hash; /* of the compressed bytes of inline values */
+  /* for inline values only va_rawsize is set, to the compressed size */
+  struct varatt_external pointer;
+} SharedCacheKey;
+
+/* filled in by fetchSharedCache() and used by storeSharedCache() */
+typedef struct SharedCacheLookup {
+  bool cacheable;
+  SharedCacheKey key;
+  uint32 oidEpoch; /* the OID counter wraparounds seen at the lookup */
+  const struct varlena *compressed; /* the inline value */
+} SharedCacheLookup;
+
+struct MemoryContextData; /* forward declaration to prevent conflicts with C++
+                           */
+
+/* requests the shared memory, must be called from _PG_init() */
+void initSharedCache(void);
+
+/*
+ * returns a copy of the detoasted value of a, allocated in ctx, or NULL if
+ * the value is not in the cache. lookup is filled in for storeSharedCache()
+ */
+struct varlena *fetchSharedCache(Datum a, struct MemoryContextData *ctx,
+                                 SharedCacheLookup *lookup);
+
+/*
+ * stores the detoasted value of a value fetchSharedCache() didn't find,
+ * the toasted value must not have been freed since
+ */
+void storeSharedCache(const SharedCacheLookup *lookup,
+                      const struct varlena *value);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
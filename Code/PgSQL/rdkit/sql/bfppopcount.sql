@@ -0,0 +1,160 @@
+SET extra_float_digits=0;
+CREATE INDEX fpidx ON pgbfp USING bfp_popcount (f);
+CREATE INDEX maccsfpidx ON pgbfp USING bfp_popcount (maccsf);
+
+SET rdkit.tanimoto_threshold = 0.5;
+SET rdkit.dice_threshold = 0.6;
+
+
+SET enable_indexscan=off;
+SET enable_bitmapscan=off;
+SET enable_seqscan=on;
+
+SELECT
+    id, tanimoto_sml(rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), f) AS sml
+FROM
+	pgbfp
+WHERE rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) % f
+ORDER BY sml DESC, id limit 10;
+
+SELECT
+    id, dice_sml(rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), f) AS sml
+FROM
+	pgbfp
+WHERE rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) # f
+ORDER BY sml DESC, id limit 10;
+
+SELECT
+    id, tanimoto_sml(maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), maccsf) AS sml
+FROM
+	pgbfp
+WHERE maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) % maccsf
+ORDER BY sml DESC, id limit 10;
+
+
+SET enable_indexscan=on;
+SET enable_bitmapscan=on;
+SET enable_seqscan=off;
+
+SELECT
+    id, tanimoto_sml(rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), f) AS sml
+FROM
+	pgbfp
+WHERE rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) % f
+ORDER BY sml DESC, id limit 10;
+
+SELECT
+    id, dice_sml(rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), f) AS sml
+FROM
+	pgbfp
+WHERE rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) # f
+ORDER BY sml DESC, id limit 10;
+
+SELECT
+    id, tanimoto_sml(maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), maccsf) AS sml
+FROM
+	pgbfp
+WHERE maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) % maccsf
+ORDER BY sml DESC, id limit 10;
+
+SET enable_indexscan=on;
+SET enable_bitmapscan=on;
+SET enable_seqscan=on;
+
+SELECT
+    id, tanimoto_sml(rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), f) AS sml
+FROM
+	pgbfp
+WHERE rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) % f
+ORDER BY rdkit_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) <%> f,id limit 10;
+
+SELECT
+    id, tanimoto_sml(maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), maccsf) AS sml
+FROM
+	pgbfp
+WHERE maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) % maccsf
+ORDER BY sml DESC, id limit 10;
+
+DROP INDEX fpidx;
+DROP INDEX maccsfpidx;
+
+-- the index after insertions, deletions and VACUUM
+CREATE TABLE pgbfp_popcount AS SELECT id, maccsf FROM pgbfp;
+CREATE INDEX maccsfpidx ON pgbfp_popcount USING bfp_popcount (maccsf);
+INSERT INTO pgbfp_popcount VALUES
+    (-1, maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol)),
+    (-2, maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol));
+DELETE FROM pgbfp_popcount WHERE id IN (-2, 5281628);
+VACUUM pgbfp_popcount;
+
+CREATE FUNCTION bfppopcount_plan_uses(query text, node text) RETURNS bool
+LANGUAGE plpgsql AS $$
+DECLARE
+    ln text;
+BEGIN
+    FOR ln IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query LOOP
+        IF ln LIKE '%' || node || '%' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END
+$$;
+
+SET enable_indexscan=on;
+SET enable_bitmapscan=on;
+SET enable_seqscan=off;
+
+SELECT bfppopcount_plan_uses(
+    'SELECT id FROM pgbfp_popcount WHERE maccs_fp(''O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1''::mol) % maccsf',
+    'maccsfpidx');
+SELECT
+    id, tanimoto_sml(maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), maccsf) AS sml
+FROM
+	pgbfp_popcount
+WHERE maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) % maccsf
+ORDER BY sml DESC, id;
+
+SELECT bfppopcount_plan_uses(
+    'SELECT id FROM pgbfp_popcount ORDER BY maccsf <%> maccs_fp(''O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1''::mol) LIMIT 8',
+    'Index Scan using maccsfpidx');
+SELECT
+    id, tanimoto_sml(maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), maccsf) AS sml
+FROM
+	pgbfp_popcount
+ORDER BY maccsf <%> maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), id
+LIMIT 8;
+
+SELECT bfppopcount_plan_uses(
+    'SELECT id FROM pgbfp_popcount ORDER BY maccsf <#> maccs_fp(''O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1''::mol) LIMIT 8',
+    'Index Scan using maccsfpidx');
+
+-- parallel index scans
+SET enable_bitmapscan=off;
+SET parallel_setup_cost=0;
+SET parallel_tuple_cost=0;
+SET min_parallel_table_scan_size=0;
+SET min_parallel_index_scan_size=0;
+SET max_parallel_workers_per_gather=2;
+
+SELECT bfppopcount_plan_uses(
+    'SELECT id FROM pgbfp_popcount WHERE maccs_fp(''O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1''::mol) % maccsf',
+    'Parallel Index Scan using maccsfpidx');
+SELECT
+    id, tanimoto_sml(maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol), maccsf) AS sml
+FROM
+	pgbfp_popcount
+WHERE maccs_fp('O=C1CC(OC2=CC=CC=C12)C1=CC=CC=C1'::mol) % maccsf
+ORDER BY sml DESC, id;
+
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+RESET min_parallel_index_scan_size;
+RESET max_parallel_workers_per_gather;
+SET enable_indexscan=on;
+SET enable_bitmapscan=on;
+SET enable_seqscan=on;
+
+DROP FUNCTION bfppopcount_plan_uses(text, text);
+DROP TABLE pgbfp_popcount;
@@ -649,3 +649,6 @@ M  V30 END CTAB
 M  END
 ',false,true,false));
 
+
+-- the shared cache is disabled unless the library is preloaded
+select size, used, entries from rdkit_shared_cache_stats();
@@ -39,12 +39,18 @@ class RDKIT_QUERY_EXPORT EqualityQuery
   }
 
   //! sets our target value
-  void setVal(MatchFuncArgType what) { this->d_val = what; }
+  void setVal(MatchFuncArgType what) {
+    this->d_val = what;
+    this->touch();
+  }
   //! returns our target value
   const MatchFuncArgType getVal() const { return this->d_val; }
 
   //! sets our tolerance
-  void setTol(MatchFuncArgType what) { this->d_tol = what; }
+  void setTol(MatchFuncArgType what) {
+    this->d_tol = what;
+    this->touch();
+  }
   //! returns out tolerance
   const MatchFuncArgType getTol() const { return this->d_tol; }
 
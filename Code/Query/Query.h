@@ -59,7 +59,10 @@ class RDKIT_QUERY_EXPORT Query {
   virtual ~Query() { this->d_children.clear(); }
 
   //! sets whether or not we are negated
-  void setNegation(bool what) { this->df_negate = what; }
+  void setNegation(bool what) {
+    this->df_negate = what;
+    this->touch();
+  }
   //! returns whether or not we are negated
   bool getNegation() const { return this->df_negate; }
 
@@ -90,6 +93,7 @@ class RDKIT_QUERY_EXPORT Query {
   //! sets our match function
   void setMatchFunc(std::function<bool(MatchFuncArgType)> what) {
     this->d_matchFunc = what;
+    this->touch();
   }
   //! returns our match function:
   std::function<bool(MatchFuncArgType)> getMatchFunc() const {
@@ -98,6 +102,7 @@ class RDKIT_QUERY_EXPORT Query {
   //! sets our data function
   void setDataFunc(std::function<MatchFuncArgType(DataFuncArgType)> what) {
     this->d_dataFunc = what;
+    this->touch();
   }
   //! returns our data function:
   std::function<MatchFuncArgType(DataFuncArgType)> getDataFunc() const {
@@ -105,12 +110,22 @@ class RDKIT_QUERY_EXPORT Query {
   }
 
   //! adds a child to our list of children
-  void addChild(CHILD_TYPE child) { this->d_children.push_back(child); }
+  void addChild(CHILD_TYPE child) {
+    this->d_children.push_back(child);
+    this->touch();
+  }
   //! returns an iterator for the beginning of our child vector
   CHILD_VECT_CI beginChildren() const { return this->d_children.begin(); }
   //! returns an iterator for the end of our child vector
   CHILD_VECT_CI endChildren() const { return this->d_children.end(); }
 
+  //! returns a counter which is incremented whenever the way we match changes
+  /*!
+    This allows cached forms of the query, like RDKit::CompiledQuery, to
+    detect that the query has been modified in place.
+  */
+  unsigned int getGeneration() const { return this->d_generation; }
+
   //! returns whether or not we match the argument
   virtual bool Match(const DataFuncArgType arg) const {
     MatchFuncArgType mfArg = TypeConvert(arg, Int2Type<needsConversion>());
@@ -158,8 +173,12 @@ class RDKIT_QUERY_EXPORT Query {
   std::string d_queryType = "";
   CHILD_VECT d_children;
   bool df_negate{false};
+  unsigned int d_generation{0};
   std::function<bool(MatchFuncArgType)> d_matchFunc;
 
+  //! to be called by everything which changes the way we match
+  void touch() { ++this->d_generation; }
+
   // MSVC complains at compile time when TypeConvert(MatchFuncArgType what,
   // Int2Type<false>) attempts to pass what (which is of type MatchFuncArgType)
   // as parameter of d_dataFunc() (which should be of type DataFuncArgType). The
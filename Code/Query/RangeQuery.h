@@ -35,11 +35,17 @@ class RDKIT_QUERY_EXPORT RangeQuery
   }
 
   //! sets our upper bound
-  void setUpper(MatchFuncArgType what) { this->d_upper = what; }
+  void setUpper(MatchFuncArgType what) {
+    this->d_upper = what;
+    this->touch();
+  }
   //! returns our upper bound
   const MatchFuncArgType getUpper() const { return this->d_upper; }
   //! sets our lower bound
-  void setLower(MatchFuncArgType what) { this->d_lower = what; }
+  void setLower(MatchFuncArgType what) {
+    this->d_lower = what;
+    this->touch();
+  }
   //! returns our lower bound
   const MatchFuncArgType getLower() const { return this->d_lower; }
 
@@ -47,6 +53,7 @@ class RDKIT_QUERY_EXPORT RangeQuery
   void setEndsOpen(bool lower, bool upper) {
     this->df_lowerOpen = lower;
     this->df_upperOpen = upper;
+    this->touch();
   }
   //! returns the state of our ends (open or not)
   std::pair<bool, bool> getEndsOpen() const {
@@ -54,7 +61,10 @@ class RDKIT_QUERY_EXPORT RangeQuery
   }
 
   //! sets our tolerance
-  void setTol(MatchFuncArgType what) { this->d_tol = what; }
+  void setTol(MatchFuncArgType what) {
+    this->d_tol = what;
+    this->touch();
+  }
   //! returns our tolerance
   const MatchFuncArgType getTol() const { return this->d_tol; }
 
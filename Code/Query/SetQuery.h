@@ -33,11 +33,15 @@ class RDKIT_QUERY_EXPORT SetQuery
   void insert(const MatchFuncArgType what) {
     if (d_set.find(what) == this->d_set.end()) {
       this->d_set.insert(what);
+      this->touch();
     }
   }
 
   //! clears our \c set
-  void clear() { this->d_set.clear(); }
+  void clear() {
+    this->d_set.clear();
+    this->touch();
+  }
 
   bool Match(const DataFuncArgType what) const override {
     MatchFuncArgType mfArg =
@@ -22,6 +22,7 @@ class ConcurrentQueue {
   bool d_done;
   std::vector<E> d_elements;
   unsigned int d_head, d_tail;
+  unsigned int d_maxSize = 0;
   mutable std::mutex d_lock;
   std::condition_variable d_notEmpty, d_notFull;
 
@@ -50,6 +51,15 @@ class ConcurrentQueue {
   //! checks whether the ConcurrentQueue is empty
   bool isEmpty() const;
 
+  //! returns the number of elements currently in the queue
+  unsigned int size() const;
+
+  //! returns the maximum number of elements the queue can hold
+  unsigned int getCapacity() const { return d_capacity; }
+
+  //! returns the largest number of elements which have been in the queue
+  unsigned int getMaxSize() const;
+
   //! returns the value of the variable done
   bool getDone() const;
 
@@ -72,6 +82,9 @@ void ConcurrentQueue<E>::push(const E &element) {
   bool wasEmpty = (d_head == d_tail);
   d_elements.at(d_tail % d_capacity) = element;
   d_tail++;
+  if (d_tail - d_head > d_maxSize) {
+    d_maxSize = d_tail - d_head;
+  }
   //! if the concurrent queue was empty before
   //! then it is not any more since we have "pushed" an element
   //! thus we notify all the consumer threads
@@ -109,6 +122,18 @@ bool ConcurrentQueue<E>::isEmpty() const {
   return (d_head == d_tail);
 }
 
+template <typename E>
+unsigned int ConcurrentQueue<E>::size() const {
+  std::unique_lock<std::mutex> lk(d_lock);
+  return d_tail - d_head;
+}
+
+template <typename E>
+unsigned int ConcurrentQueue<E>::getMaxSize() const {
+  std::unique_lock<std::mutex> lk(d_lock);
+  return d_maxSize;
+}
+
 template <typename E>
 bool ConcurrentQueue<E>::getDone() const {
   std::unique_lock<std::mutex> lk(d_lock);
@@ -8,9 +8,9 @@
 //  of the RDKit source tree.
 //
 
-#include <GraphMol/SynthonSpaceSearch/MemoryMappedFileReader.h>
-#include <GraphMol/SynthonSpaceSearch/SynthonSpaceSearch_details.h>
+#include <RDGeneral/MemoryMappedFileReader.h>
 
+#include <stdexcept>
 #include <string>
 
 #include <RDGeneral/RDLog.h>
@@ -24,7 +24,7 @@
 #include <sys/stat.h>
 #endif
 
-namespace RDKit::SynthonSpaceSearch::details {
+namespace RDKit {
 // This code is a lightly modified version of something provided by
 // ChatGPT in response to the prompt:
 // "in c++ can I use the same code for mmap on windows and linux?"
@@ -32,8 +32,9 @@ namespace RDKit::SynthonSpaceSearch::details {
 // Accessed 26/2/2025.
 MemoryMappedFileReader::MemoryMappedFileReader(const std::string &filePath) {
 #ifdef _WIN32
-  HANDLE hFile = CreateFile(filePath.c_str(), GENERIC_READ, 0, NULL,
-                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  HANDLE hFile =
+      CreateFile(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
   if (hFile == INVALID_HANDLE_VALUE) {
     throw(std::runtime_error("Error opening file " + filePath + "."));
   }
@@ -45,6 +46,11 @@ MemoryMappedFileReader::MemoryMappedFileReader(const std::string &filePath) {
     throw(std::runtime_error("Error reading file " + filePath + "."));
   }
   d_size = static_cast<size_t>(fileSize.QuadPart);
+  if (!d_size) {
+    // zero-length files cannot be mapped
+    CloseHandle(hFile);
+    return;
+  }
 
   // Create a file mapping
   HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
@@ -65,7 +71,7 @@ MemoryMappedFileReader::MemoryMappedFileReader(const std::string &filePath) {
   CloseHandle(hMapping);  // Handle is no longer needed once mapped
   CloseHandle(hFile);     // File handle is no longer needed
 #else
-  int fd = open(filePath.c_str(), O_RDWR);
+  int fd = open(filePath.c_str(), O_RDONLY);
   if (fd == -1) {
     BOOST_LOG(rdErrorLog) << "Error opening file.\n";
     throw(std::runtime_error("Error opening file " + filePath + "."));
@@ -78,6 +84,11 @@ MemoryMappedFileReader::MemoryMappedFileReader(const std::string &filePath) {
     throw(std::runtime_error("Error reading file " + filePath + "."));
   }
   d_size = static_cast<size_t>(fileStat.st_size);
+  if (!d_size) {
+    // zero-length files cannot be mapped
+    close(fd);
+    return;
+  }
 
   // Memory map the file
   d_mappedMemory =
@@ -100,6 +111,9 @@ MemoryMappedFileReader::MemoryMappedFileReader(MemoryMappedFileReader &&other) {
 }
 
 MemoryMappedFileReader::~MemoryMappedFileReader() {
+  if (!d_mappedMemory) {
+    return;
+  }
 #ifdef _WIN32
   // Windows-specific unmapping
   UnmapViewOfFile(d_mappedMemory);
@@ -112,13 +126,15 @@ MemoryMappedFileReader::~MemoryMappedFileReader() {
 MemoryMappedFileReader &MemoryMappedFileReader::operator=(
     MemoryMappedFileReader &&other) {
   if (this != &other) {
+    if (d_mappedMemory) {
 #ifdef _WIN32
-    // Windows-specific unmapping
-    UnmapViewOfFile(d_mappedMemory);
+      // Windows-specific unmapping
+      UnmapViewOfFile(d_mappedMemory);
 #else
-    // Linux-specific unmapping
-    munmap(d_mappedMemory, d_size);
+      // Linux-specific unmapping
+      munmap(d_mappedMemory, d_size);
 #endif
+    }
     d_mappedMemory = other.d_mappedMemory;
     d_size = other.d_size;
     other.d_mappedMemory = nullptr;
@@ -126,4 +142,4 @@ MemoryMappedFileReader &MemoryMappedFileReader::operator=(
   }
   return *this;
 }
-};  // namespace RDKit::SynthonSpaceSearch::details
+}  // namespace RDKit
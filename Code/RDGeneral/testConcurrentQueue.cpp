@@ -34,6 +34,23 @@ TEST_CASE("testPushAndPop") {
   delete (q);
 }
 
+TEST_CASE("queue occupancy") {
+  ConcurrentQueue<int> q(4);
+  REQUIRE(q.getCapacity() == 4);
+  REQUIRE(q.size() == 0);
+  REQUIRE(q.getMaxSize() == 0);
+  q.push(1);
+  q.push(2);
+  q.push(3);
+  REQUIRE(q.size() == 3);
+  int e;
+  REQUIRE(q.pop(e));
+  REQUIRE(q.pop(e));
+  q.push(4);
+  REQUIRE(q.size() == 2);
+  REQUIRE(q.getMaxSize() == 3);
+}
+
 void produce(ConcurrentQueue<int> &q, const int numToProduce) {
   for (int i = 0; i < numToProduce; ++i) {
     q.push(i);
@@ -0,0 +1,194 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+
+#include "ButinaCluster.h"
+
+#include <RDGeneral/Invariant.h>
+#include <RDGeneral/BadFileException.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+namespace RDPickers {
+
+namespace {
+// the number of fingerprints whose neighbors are found in one pass, this
+// bounds the size of the intermediate sparse similarity matrix
+constexpr unsigned int neighborBatchSize = 4096;
+}  // namespace
+
+FingerprintNeighborGraph::FingerprintNeighborGraph(
+    const PackedBitOps::PackedFingerprints &fps, double simThreshold,
+    PackedBitOps::SimilarityMetric metric, int numThreads,
+    const std::string &spillFile)
+    : d_spillFile(spillFile) {
+  PRECONDITION(metric != PackedBitOps::SimilarityMetric::Tversky,
+               "the neighbor graph requires a symmetric similarity metric");
+  const auto numFps = fps.size();
+  d_offsets.reserve(numFps + 1);
+  d_offsets.push_back(0);
+
+  std::ofstream spill;
+  if (!d_spillFile.empty()) {
+    spill.open(d_spillFile, std::ios_base::binary | std::ios_base::trunc);
+    if (!spill) {
+      throw RDKit::BadFileException("could not open spill file " +
+                                    d_spillFile);
+    }
+  }
+
+  try {
+    // the neighbor lists are found one batch of rows at a time and written out
+    // in row order, so only the current batch of the similarity matrix is ever
+    // held in memory
+    PackedBitOps::SparseSimilarityMatrix batchSims;
+    std::vector<std::uint32_t> batchNeighbors;
+    for (unsigned int batchStart = 0; batchStart < numFps;
+         batchStart += neighborBatchSize) {
+      const auto batchEnd = std::min(numFps, batchStart + neighborBatchSize);
+      PackedBitOps::PackedFingerprints batch(fps.getNumBits());
+      batch.reserve(batchEnd - batchStart);
+      for (auto i = batchStart; i < batchEnd; ++i) {
+        batch.append(fps.getRow(i));
+      }
+      PackedBitOps::calcSparseSimilarityMatrix(batch, fps, simThreshold,
+                                               batchSims, metric, 1.0, 1.0,
+                                               numThreads);
+      batchNeighbors.clear();
+      for (auto i = batchStart; i < batchEnd; ++i) {
+        const auto row = i - batchStart;
+        for (auto pos = batchSims.rowOffsets[row];
+             pos < batchSims.rowOffsets[row + 1]; ++pos) {
+          if (batchSims.columns[pos] != i) {
+            batchNeighbors.push_back(batchSims.columns[pos]);
+          }
+        }
+        d_offsets.push_back(d_offsets[batchStart] + batchNeighbors.size());
+      }
+      if (spill.is_open()) {
+        spill.write(reinterpret_cast<const char *>(batchNeighbors.data()),
+                    batchNeighbors.size() * sizeof(std::uint32_t));
+      } else {
+        d_neighbors.insert(d_neighbors.end(), batchNeighbors.begin(),
+                           batchNeighbors.end());
+      }
+    }
+
+    if (spill.is_open()) {
+      spill.close();
+      if (!spill) {
+        throw RDKit::BadFileException("could not write spill file " +
+                                      d_spillFile);
+      }
+      d_map.reset(new RDKit::MemoryMappedFileReader(d_spillFile));
+      CHECK_INVARIANT(d_map->d_size == d_offsets.back() * sizeof(std::uint32_t),
+                      "bad spill file size");
+      d_neighborData = reinterpret_cast<const std::uint32_t *>(
+          d_map->d_mappedMemory);
+    } else {
+      d_neighborData = d_neighbors.data();
+    }
+  } catch (...) {
+    // don't leave a partial spill file behind
+    spill.close();
+    d_map.reset();
+    if (!d_spillFile.empty()) {
+      std::remove(d_spillFile.c_str());
+    }
+    throw;
+  }
+}
+
+FingerprintNeighborGraph::~FingerprintNeighborGraph() {
+  if (!d_spillFile.empty()) {
+    d_map.reset();
+    std::remove(d_spillFile.c_str());
+  }
+}
+
+std::vector<std::vector<unsigned int>> butinaCluster(
+    const FingerprintNeighborGraph &graph, bool reordering) {
+  const auto numPoints = graph.size();
+  std::vector<std::vector<unsigned int>> res;
+  std::vector<bool> seen(numPoints, false);
+
+  auto addCluster = [&](unsigned int centroid) {
+    std::vector<unsigned int> cluster{centroid};
+    seen[centroid] = true;
+    for (auto nbr : graph.getNeighbors(centroid)) {
+      if (!seen[nbr]) {
+        cluster.push_back(nbr);
+        seen[nbr] = true;
+      }
+    }
+    res.push_back(std::move(cluster));
+  };
+
+  if (!reordering) {
+    // the points are visited in order of decreasing number of neighbors,
+    // ties are broken by decreasing index
+    std::vector<unsigned int> order(numPoints);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&graph](unsigned int i, unsigned int j) {
+                const auto ni = graph.getNumNeighbors(i);
+                const auto nj = graph.getNumNeighbors(j);
+                return ni != nj ? ni > nj : i > j;
+              });
+    for (auto idx : order) {
+      if (!seen[idx]) {
+        addCluster(idx);
+      }
+    }
+    return res;
+  }
+
+  // with reordering the number of unassigned neighbors of each point is kept
+  // up to date as clusters are formed. Rather than resorting all the points
+  // after each cluster, every updated count is pushed onto a priority queue
+  // and entries which are out of date are skipped when they are popped.
+  std::vector<unsigned int> counts(numPoints);
+  std::priority_queue<std::pair<unsigned int, unsigned int>> queue;
+  for (unsigned int i = 0; i < numPoints; ++i) {
+    counts[i] = graph.getNumNeighbors(i);
+    queue.emplace(counts[i], i);
+  }
+  while (!queue.empty()) {
+    const auto [count, idx] = queue.top();
+    queue.pop();
+    if (seen[idx] || count != counts[idx]) {
+      continue;
+    }
+    addCluster(idx);
+    for (auto member : res.back()) {
+      for (auto nbr : graph.getNeighbors(member)) {
+        if (!seen[nbr]) {
+          queue.emplace(--counts[nbr], nbr);
+        }
+      }
+    }
+  }
+  return res;
+}
+
+std::vector<std::vector<unsigned int>> butinaCluster(
+    const PackedBitOps::PackedFingerprints &fps, double distThreshold,
+    bool reordering, int numThreads, const std::string &spillFile) {
+  FingerprintNeighborGraph graph(fps, 1.0 - distThreshold,
+                                 PackedBitOps::SimilarityMetric::Tanimoto,
+                                 numThreads, spillFile);
+  return butinaCluster(graph, reordering);
+}
+
+}  // namespace RDPickers
@@ -0,0 +1,126 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+#include <RDGeneral/export.h>
+#ifndef RD_BUTINACLUSTER_H
+#define RD_BUTINACLUSTER_H
+
+#include <DataStructs/PackedBitOps.h>
+#include <RDGeneral/MemoryMappedFileReader.h>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace RDPickers {
+
+//! The neighbor lists of a set of fingerprints
+/*!
+  Two fingerprints are neighbors if their similarity is at least the
+  threshold. The lists are calculated block by block directly from the
+  fingerprints, so the full similarity matrix is never stored, and are kept
+  in compressed sparse row format: the lists are concatenated into one array
+  of 32-bit indices and a second array holds the offset of each list.
+
+  If a spill file is provided the neighbor array is written to it and
+  memory mapped rather than kept in memory. The file is removed when the
+  graph is destroyed.
+*/
+class RDKIT_SIMDIVPICKERS_EXPORT FingerprintNeighborGraph {
+ public:
+  /*!
+    \param fps          the fingerprints
+    \param simThreshold the minimum similarity for two fingerprints to be
+                        neighbors
+    \param metric       the similarity metric
+    \param numThreads   the number of threads to use (more than one thread
+                        will only be used if the RDKit was built with
+                        multithread support). If set to zero, the max
+                        supported by the system will be used.
+    \param spillFile    (optional) name of a file to store the neighbor
+                        lists in
+  */
+  FingerprintNeighborGraph(
+      const PackedBitOps::PackedFingerprints &fps, double simThreshold,
+      PackedBitOps::SimilarityMetric metric =
+          PackedBitOps::SimilarityMetric::Tanimoto,
+      int numThreads = 1, const std::string &spillFile = "");
+  FingerprintNeighborGraph(const FingerprintNeighborGraph &) = delete;
+  FingerprintNeighborGraph &operator=(const FingerprintNeighborGraph &) =
+      delete;
+  ~FingerprintNeighborGraph();
+
+  //! returns the number of fingerprints
+  unsigned int size() const {
+    return static_cast<unsigned int>(d_offsets.size() - 1);
+  }
+  //! returns the total number of entries in the neighbor lists
+  std::uint64_t getNumEntries() const { return d_offsets.back(); }
+  unsigned int getNumNeighbors(unsigned int idx) const {
+    return static_cast<unsigned int>(d_offsets[idx + 1] - d_offsets[idx]);
+  }
+  //! returns the neighbors of a fingerprint in increasing order, the
+  //! fingerprint itself is not included
+  std::span<const std::uint32_t> getNeighbors(unsigned int idx) const {
+    return std::span<const std::uint32_t>(d_neighborData + d_offsets[idx],
+                                          getNumNeighbors(idx));
+  }
+
+ private:
+  std::vector<std::uint64_t> d_offsets;
+  std::vector<std::uint32_t> d_neighbors;
+  std::unique_ptr<RDKit::MemoryMappedFileReader> d_map;
+  std::string d_spillFile;
+  const std::uint32_t *d_neighborData = nullptr;
+};
+
+//! Clusters a set of fingerprints using the Butina (Taylor-Butina)
+//! algorithm
+/*!
+  The fingerprint with the most unassigned neighbors becomes the centroid
+  of a new cluster which contains it and all of its unassigned neighbors.
+  This is repeated until every fingerprint has been assigned. Ties are
+  broken in favor of the higher index, as in rdkit.ML.Cluster.Butina.
+
+  Reference: Butina, D. Unsupervised Data Base Clustering Based on Daylight's
+  Fingerprint and Tanimoto Similarity: A Fast and Automated Way To Cluster
+  Small and Large Data Sets. J. Chem. Inf. Comput. Sci. 39, 747-750 (1999).
+
+  \param graph      the neighbor graph
+  \param reordering if set, the neighbor counts of the remaining
+                    fingerprints are updated after each cluster is formed
+                    so that only unassigned neighbors are counted.
+                    Otherwise the counts from the graph are used throughout.
+
+  \return the clusters, the first element of each cluster is its centroid
+*/
+RDKIT_SIMDIVPICKERS_EXPORT std::vector<std::vector<unsigned int>>
+butinaCluster(const FingerprintNeighborGraph &graph, bool reordering = false);
+
+//! \overload
+/*!
+  \param fps          the fingerprints
+  \param distThreshold fingerprints with a distance (1 - similarity) of at
+                      most this are neighbors
+  \param reordering   see above
+  \param numThreads   the number of threads to use for finding the
+                      neighbors
+  \param spillFile    (optional) name of a file to store the neighbor lists
+                      in while clustering
+*/
+RDKIT_SIMDIVPICKERS_EXPORT std::vector<std::vector<unsigned int>>
+butinaCluster(const PackedBitOps::PackedFingerprints &fps,
+              double distThreshold, bool reordering = false,
+              int numThreads = 1, const std::string &spillFile = "");
+
+}  // namespace RDPickers
+
+#endif
@@ -0,0 +1,136 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+
+#include "LeaderPicker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include "PickerWorkers.h"
+
+namespace RDPickers {
+
+namespace {
+// the pool is divided into blocks of this many items, which are the unit of
+// work for the threads
+constexpr unsigned int leaderBlockSize = 4096;
+
+struct LeaderBlock {
+  unsigned int start;
+  unsigned int len;
+};
+
+// removes the items which are within threshold of the query from a block,
+// the order of the remaining items is preserved. Returns the number of items
+// left.
+unsigned int compactBlock(const PackedBitOps::PackedFingerprints &fps,
+                          unsigned int query, double threshold,
+                          std::uint32_t *items, unsigned int len) {
+  const auto queryCount = fps.getPopcount(query);
+  std::uint32_t common[leaderBlockSize];
+  PackedBitOps::bulkIntersectionPopcounts(
+      fps.getRow(query), fps.getRow(0), fps.getNumWords(), fps.getNumWords(),
+      items, len, common);
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < len; ++i) {
+    // this matches TanimotoSimilarity()
+    const auto total = queryCount + fps.getPopcount(items[i]);
+    const double sim =
+        total ? (double)common[i] / (double)(total - common[i]) : 0.0;
+    if (1. - sim > threshold) {
+      items[count++] = items[i];
+    }
+  }
+  return count;
+}
+}  // namespace
+
+RDKit::INT_VECT LeaderPicker::pick(const PackedBitOps::PackedFingerprints &fps,
+                                   unsigned int pickSize,
+                                   const RDKit::INT_VECT &firstPicks,
+                                   double threshold, int nthreads) const {
+  const auto poolSize = fps.size();
+  if (!poolSize) {
+    throw ValueErrorException("empty pool to pick from");
+  }
+  if (poolSize < pickSize) {
+    throw ValueErrorException("pickSize cannot be larger than the poolSize");
+  }
+  if (!pickSize) {
+    pickSize = poolSize;
+  }
+
+  std::vector<std::uint32_t> items(poolSize);
+  std::iota(items.begin(), items.end(), 0);
+  std::vector<LeaderBlock> blocks;
+  for (unsigned int start = 0; start < poolSize; start += leaderBlockSize) {
+    blocks.push_back({start, std::min(leaderBlockSize, poolSize - start)});
+  }
+#ifdef RDK_BUILD_THREADSAFE_SSS
+  // the threads are started once and reused for every pick
+  const auto nThreads = std::min(RDKit::getNumThreadsToUse(nthreads),
+                                 static_cast<unsigned int>(blocks.size()));
+  std::unique_ptr<detail::PickerWorkers> workers;
+  if (nThreads > 1) {
+    workers.reset(new detail::PickerWorkers(nThreads));
+  }
+#else
+  RDUNUSED_PARAM(nthreads);
+#endif
+
+  // removes everything within threshold of the query from the pool
+  auto exclude = [&](unsigned int query) {
+    std::atomic<unsigned int> nextBlock{0};
+    auto worker = [&](unsigned int) {
+      for (auto b = nextBlock++; b < blocks.size(); b = nextBlock++) {
+        auto &block = blocks[b];
+        block.len = compactBlock(fps, query, threshold,
+                                 items.data() + block.start, block.len);
+      }
+    };
+#ifdef RDK_BUILD_THREADSAFE_SSS
+    if (workers && blocks.size() > 1) {
+      workers->run(worker);
+    } else {
+      worker(0);
+    }
+#else
+    worker(0);
+#endif
+    blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                                [](const LeaderBlock &block) {
+                                  return block.len == 0;
+                                }),
+                 blocks.end());
+  };
+
+  RDKit::INT_VECT picks;
+  for (auto pick : firstPicks) {
+    if (static_cast<unsigned int>(pick) >= poolSize) {
+      throw ValueErrorException("pick index was larger than the poolSize");
+    }
+    picks.push_back(pick);
+    exclude(pick);
+  }
+  while (picks.size() < pickSize && !blocks.empty()) {
+    // the next pick is the first item left in the pool
+    auto &head = blocks.front();
+    const auto pick = items[head.start];
+    ++head.start;
+    --head.len;
+    picks.push_back(pick);
+    exclude(pick);
+  }
+  return picks;
+}
+
+}  // namespace RDPickers
@@ -8,6 +8,7 @@
 //  which is included in the file license.txt, found at the root
 //  of the RDKit source tree.
 //
+#include <RDGeneral/export.h>
 #ifndef RD_LEADERPICKER_H
 #define RD_LEADERPICKER_H
 
@@ -19,6 +20,7 @@
 #include <RDGeneral/RDThreads.h>
 #include <cstdlib>
 #include "DistPicker.h"
+#include <DataStructs/PackedBitOps.h>
 
 namespace RDPickers {
 
@@ -29,7 +31,7 @@ namespace RDPickers {
  *strategy aimed at diversity. See documentation for "pick()" member function
  *for the algorithm details
  */
-class LeaderPicker : public DistPicker {
+class RDKIT_SIMDIVPICKERS_EXPORT LeaderPicker : public DistPicker {
  public:
   double default_threshold{0.0};
   int default_nthreads{1};
@@ -117,6 +119,31 @@ class LeaderPicker : public DistPicker {
     return pick(distMat, poolSize, pickSize, iv, default_threshold,
                 default_nthreads);
   }
+
+  /*! \brief Leader picking from a set of fingerprints using the Tanimoto
+   *distance
+   *
+   * The picks are the same as those from lazyPick() with a functor returning
+   *1-TanimotoSimilarity(). The items which have not yet been excluded are kept
+   *in blocks; each new pick is compared to all of them using the bulk popcount
+   *kernels and the blocks are compacted in parallel.
+   *
+   *   \param fps - the fingerprints to pick from
+   *
+   *   \param pickSize - maximum number items to pick from pool (<=
+   *fps.size()), zero picks until the pool is exhausted
+   *
+   *   \param firstPicks - indices of the items used to seed the pick set.
+   *
+   *   \param threshold - items with a distance to a pick of at most this are
+   *excluded from the pool
+   *
+   *   \param nthreads - the number of threads to use. If this is <=0 the
+   *number of threads is determined as for RDKit::getNumThreadsToUse()
+   */
+  RDKit::INT_VECT pick(const PackedBitOps::PackedFingerprints &fps,
+                       unsigned int pickSize, const RDKit::INT_VECT &firstPicks,
+                       double threshold, int nthreads) const;
 };
 
 #if defined(RDK_BUILD_THREADSAFE_SSS)
@@ -9,5 +9,165 @@
 //
 
 #include "MaxMinPicker.h"
+#include <RDGeneral/RDThreads.h>
 
-namespace RDPickers {}
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "PickerWorkers.h"
+
+namespace RDPickers {
+
+namespace {
+// the number of fingerprints passed to the popcount kernel at a time
+constexpr unsigned int maxMinBlockSize = 1024;
+// distance used to mark items which have already been picked
+constexpr double pickedDist = -1.0;
+
+struct MaxMinCandidate {
+  double dist = pickedDist;
+  unsigned int idx = 0;
+};
+
+// updates the distances from the items in [start, end) to their nearest pick
+// with the new pick and returns the item which is furthest from all picks.
+// Ties go to the lowest index, as in MaxMinPicker::lazyPick()
+MaxMinCandidate updateMinDists(const PackedBitOps::PackedFingerprints &fps,
+                               unsigned int pick, unsigned int start,
+                               unsigned int end, double *minDists) {
+  const auto numWords = fps.getNumWords();
+  const auto probe = fps.getRow(pick);
+  const auto pickCount = fps.getPopcount(pick);
+  std::uint32_t common[maxMinBlockSize];
+  MaxMinCandidate best;
+  for (auto blockStart = start; blockStart < end;
+       blockStart += maxMinBlockSize) {
+    const auto blockSize = std::min(maxMinBlockSize, end - blockStart);
+    PackedBitOps::bulkIntersectionPopcounts(probe, fps.getRow(blockStart),
+                                            numWords, numWords, blockSize,
+                                            common);
+    for (unsigned int j = 0; j < blockSize; ++j) {
+      const auto idx = blockStart + j;
+      if (minDists[idx] == pickedDist) {
+        continue;
+      }
+      // this matches TanimotoSimilarity()
+      const auto total = pickCount + fps.getPopcount(idx);
+      const double sim =
+          total ? (double)common[j] / (double)(total - common[j]) : 0.0;
+      const double dist = 1. - sim;
+      if (dist < minDists[idx]) {
+        minDists[idx] = dist;
+      }
+      if (minDists[idx] > best.dist) {
+        best.dist = minDists[idx];
+        best.idx = idx;
+      }
+    }
+  }
+  return best;
+}
+}  // namespace
+
+RDKit::INT_VECT MaxMinPicker::pick(const PackedBitOps::PackedFingerprints &fps,
+                                   unsigned int pickSize,
+                                   const RDKit::INT_VECT &firstPicks, int seed,
+                                   double &threshold, int numThreads) const {
+  const auto poolSize = fps.size();
+  if (!poolSize) {
+    throw ValueErrorException("empty pool to pick from");
+  }
+  if (poolSize < pickSize) {
+    throw ValueErrorException("pickSize cannot be larger than the poolSize");
+  }
+
+  std::vector<double> minDists(poolSize, std::numeric_limits<double>::max());
+  RDKit::INT_VECT picks;
+  picks.reserve(pickSize);
+  if (firstPicks.empty()) {
+    picks.push_back(randomPick(poolSize, seed));
+  } else {
+    for (auto pick : firstPicks) {
+      if (static_cast<unsigned int>(pick) >= poolSize) {
+        throw ValueErrorException("pick index was larger than the poolSize");
+      }
+      picks.push_back(pick);
+    }
+  }
+  for (auto pick : picks) {
+    minDists[pick] = pickedDist;
+  }
+  if (picks.size() >= pickSize) {
+    threshold = -1.0;
+    return picks;
+  }
+
+#ifdef RDK_BUILD_THREADSAFE_SSS
+  // the pool is divided into one contiguous chunk per thread
+  const unsigned int numBlocks =
+      (poolSize + maxMinBlockSize - 1) / maxMinBlockSize;
+  const auto nThreads =
+      std::min(RDKit::getNumThreadsToUse(numThreads), numBlocks);
+  const unsigned int chunkSize =
+      ((poolSize + nThreads - 1) / nThreads + maxMinBlockSize - 1) /
+      maxMinBlockSize * maxMinBlockSize;
+  // the threads are started once and reused for every pick
+  std::unique_ptr<detail::PickerWorkers> workers;
+  std::vector<MaxMinCandidate> threadBest;
+  if (nThreads > 1) {
+    workers.reset(new detail::PickerWorkers(nThreads));
+    threadBest.resize(nThreads);
+  }
+#else
+  RDUNUSED_PARAM(numThreads);
+#endif
+  auto update = [&](unsigned int pick) {
+#ifdef RDK_BUILD_THREADSAFE_SSS
+    if (workers) {
+      workers->run([&](unsigned int tid) {
+        const auto start = std::min(poolSize, tid * chunkSize);
+        threadBest[tid] =
+            updateMinDists(fps, pick, start,
+                           std::min(poolSize, start + chunkSize),
+                           minDists.data());
+      });
+      // the chunks are in index order, so ties still go to the lowest index
+      MaxMinCandidate best;
+      for (const auto &candidate : threadBest) {
+        if (candidate.dist > best.dist) {
+          best = candidate;
+        }
+      }
+      return best;
+    }
+#endif
+    return updateMinDists(fps, pick, 0, poolSize, minDists.data());
+  };
+
+  MaxMinCandidate best;
+  for (auto pick : picks) {
+    best = update(pick);
+  }
+  double tmpThreshold = -1.0;
+  while (picks.size() < pickSize) {
+    // if the current distance is closer then threshold, we're done
+    if (best.dist <= threshold && threshold >= 0.0) {
+      break;
+    }
+    // this only happens if the first picks contained duplicates
+    if (best.dist == pickedDist) {
+      break;
+    }
+    tmpThreshold = best.dist;
+    picks.push_back(best.idx);
+    minDists[best.idx] = pickedDist;
+    if (picks.size() < pickSize) {
+      best = update(best.idx);
+    }
+  }
+  threshold = tmpThreshold;
+  return picks;
+}
+
+}  // namespace RDPickers
@@ -19,6 +19,7 @@
 #include <RDGeneral/Exceptions.h>
 #include <cstdlib>
 #include "DistPicker.h"
+#include <DataStructs/PackedBitOps.h>
 #include <boost/random.hpp>
 #include <random>
 
@@ -130,6 +131,47 @@ class RDKIT_SIMDIVPICKERS_EXPORT MaxMinPicker : public DistPicker {
     RDKit::INT_VECT iv;
     return pick(distMat, poolSize, pickSize, iv);
   }
+
+  /*! \brief MaxMin picking from a set of fingerprints using the Tanimoto
+   *distance
+   *
+   * The picks are the same as those from lazyPick() with a functor returning
+   *1-TanimotoSimilarity(). Instead of caching distances, the distance from
+   *every item in the pool to its nearest pick is updated with each new pick,
+   *working through the pool in blocks which are distributed over the threads.
+   *
+   *   \param fps - the fingerprints to pick from
+   *   \param pickSize - the number items to pick from pool (<= fps.size())
+   *   \param firstPicks - indices of the items used to seed the pick set.
+   *   \param seed - seed for the random number generator. If this is <0 the
+   *                 generator will be seeded with a random number.
+   *   \param threshold - picking stops when the distance to the nearest pick
+   *                 is not larger than this (ignored if it is <0). On return
+   *                 this holds the distance of the last item picked.
+   *   \param numThreads - the number of threads to use. If this is <=0 the
+   *                 number of threads is determined as for
+   *                 RDKit::getNumThreadsToUse()
+   */
+  RDKit::INT_VECT pick(const PackedBitOps::PackedFingerprints &fps,
+                       unsigned int pickSize,
+                       const RDKit::INT_VECT &firstPicks, int seed,
+                       double &threshold, int numThreads = 1) const;
+
+ private:
+  static unsigned int randomPick(unsigned int poolSize, int seed) {
+    typedef boost::mt19937 rng_type;
+    typedef boost::uniform_int<> distrib_type;
+    typedef boost::variate_generator<rng_type &, distrib_type> source_type;
+    rng_type generator;
+    distrib_type dist(0, poolSize - 1);
+    if (seed >= 0) {
+      generator.seed(static_cast<rng_type::result_type>(seed));
+    } else {
+      generator.seed(std::random_device()());
+    }
+    source_type randomSource(generator, dist);
+    return randomSource();
+  }
 };
 
 struct MaxMinPickInfo {
@@ -165,19 +207,7 @@ RDKit::INT_VECT MaxMinPicker::lazyPick(T &func, unsigned int poolSize,
 
   // pick the first entry
   if (firstPicks.empty()) {
-    // get a seeded random number generator:
-    typedef boost::mt19937 rng_type;
-    typedef boost::uniform_int<> distrib_type;
-    typedef boost::variate_generator<rng_type &, distrib_type> source_type;
-    rng_type generator;
-    distrib_type dist(0, poolSize - 1);
-    if (seed >= 0) {
-      generator.seed(static_cast<rng_type::result_type>(seed));
-    } else {
-      generator.seed(std::random_device()());
-    }
-    source_type randomSource(generator, dist);
-    pick = randomSource();
+    pick = randomPick(poolSize, seed);
     // add the pick to the picks
     picks.push_back(pick);
     // and remove it from the pool
@@ -0,0 +1,105 @@
+//
+//  Copyright (C) 2026 Greg Landrum and other RDKit contributors
+//
+//   @@ All Rights Reserved @@
+//  This file is part of the RDKit.
+//  The contents are covered by the terms of the BSD license
+//  which is included in the file license.txt, found at the root
+//  of the RDKit source tree.
+//
+// This is an internal header, it is not installed.
+#ifndef RD_PICKERWORKERS_H
+#define RD_PICKERWORKERS_H
+
+#ifdef RDK_BUILD_THREADSAFE_SSS
+#include <barrier>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RDPickers {
+namespace detail {
+//! a fixed set of threads which run a task once per pick
+/*!
+  The pickers do a small amount of work per pick for a large number of
+  picks, so the threads are started once and each call to run() just
+  releases them with a barrier and waits for them at a second one.
+*/
+class PickerWorkers {
+ public:
+  //! starts \c numThreads - 1 threads, the calling thread is the last one
+  explicit PickerWorkers(unsigned int numThreads)
+      : d_numThreads(numThreads),
+        d_start(numThreads),
+        d_finish(numThreads) {
+    d_threads.reserve(numThreads - 1);
+    for (unsigned int tid = 1; tid < numThreads; ++tid) {
+      d_threads.emplace_back(&PickerWorkers::work, this, tid);
+    }
+  }
+  ~PickerWorkers() {
+    d_stop = true;
+    d_start.arrive_and_wait();
+    for (auto &thread : d_threads) {
+      thread.join();
+    }
+  }
+  PickerWorkers(const PickerWorkers &) = delete;
+  PickerWorkers &operator=(const PickerWorkers &) = delete;
+
+  unsigned int numThreads() const { return d_numThreads; }
+
+  //! calls \c task(tid) in every thread and waits until they have finished
+  /*!
+    Exceptions thrown by the task are rethrown here, in the calling thread.
+  */
+  void run(std::function<void(unsigned int)> task) {
+    d_task = std::move(task);
+    d_start.arrive_and_wait();
+    runTask(0);
+    d_finish.arrive_and_wait();
+    if (d_error) {
+      std::exception_ptr error;
+      std::swap(error, d_error);
+      std::rethrow_exception(error);
+    }
+  }
+
+ private:
+  void work(unsigned int tid) {
+    while (true) {
+      d_start.arrive_and_wait();
+      if (d_stop) {
+        return;
+      }
+      runTask(tid);
+      d_finish.arrive_and_wait();
+    }
+  }
+  void runTask(unsigned int tid) {
+    try {
+      d_task(tid);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(d_errorMutex);
+      if (!d_error) {
+        d_error = std::current_exception();
+      }
+    }
+  }
+
+  unsigned int d_numThreads;
+  std::barrier<> d_start;
+  std::barrier<> d_finish;
+  // the barriers order the accesses to these
+  bool d_stop = false;
+  std::function<void(unsigned int)> d_task;
+  std::mutex d_errorMutex;
+  std::exception_ptr d_error;
+  std::vector<std::thread> d_threads;
+};
+}  // namespace detail
+}  // namespace RDPickers
+#endif
+#endif
@@ -45,15 +45,13 @@ RDKit::INT_VECT LazyVectorLeaderPicks(LeaderPicker *picker, python::object objs,
                                       int poolSize, double threshold,
                                       int pickSize, python::object firstPicks,
                                       int numThreads) {
-  std::vector<const ExplicitBitVect *> bvs(poolSize);
-  for (int i = 0; i < poolSize; ++i) {
-    bvs[i] = python::extract<const ExplicitBitVect *>(objs[i]);
+  auto fps = packBitVects(objs, poolSize);
+  RDKit::INT_VECT firstPickVect;
+  for (unsigned int i = 0; i < boost::python::len(firstPicks); ++i) {
+    firstPickVect.push_back(python::extract<int>(firstPicks[i]));
   }
-  pyBVFunctor<ExplicitBitVect> functor(bvs, TANIMOTO);
-  RDKit::INT_VECT res;
-  LazyLeaderHelper(picker, functor, poolSize, threshold, pickSize, firstPicks,
-                   res, numThreads);
-  return res;
+  NOGIL gil;
+  return picker->pick(fps, pickSize, firstPickVect, threshold, numThreads);
 }
 
 RDKit::INT_VECT LazyLeaderPicks(LeaderPicker *picker, python::object distFunc,
@@ -86,8 +84,7 @@ struct LeaderPicker_wrap {
               python::arg("numThreads") = 1),
              "Pick a subset of items from a collection of bit vectors using "
              "Tanimoto distance. The threshold value is a "
-             "*distance* (i.e. 1-similarity). Note that the numThreads "
-             "argument is currently ignored.")
+             "*distance* (i.e. 1-similarity).")
         .def("LazyPick", RDPickers::LazyLeaderPicks,
              (python::arg("self"), python::arg("distFunc"),
               python::arg("poolSize"), python::arg("threshold"),
@@ -12,6 +12,7 @@
 
 #include <vector>
 #include <DataStructs/BitOps.h>
+#include <DataStructs/PackedBitOps.h>
 
 // NOTE: TANIMOTO and DICE provably return the same results for the diversity
 // picking this is still here just in case we ever later want to support other
@@ -56,4 +57,14 @@ class pyobjFunctor {
   python::object dp_obj;
 };
 
+// packs the first poolSize bit vectors from a sequence
+inline PackedBitOps::PackedFingerprints packBitVects(python::object objs,
+                                                     int poolSize) {
+  std::vector<const ExplicitBitVect *> bvs(poolSize);
+  for (int i = 0; i < poolSize; ++i) {
+    bvs[i] = python::extract<const ExplicitBitVect *>(objs[i]);
+  }
+  return PackedBitOps::PackedFingerprints(bvs);
+}
+
 #endif  // RDKIT_PICKERHELPERS_H
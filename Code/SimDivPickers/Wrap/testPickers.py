@@ -240,6 +240,12 @@ class TestCase(unittest.TestCase):
       407
     ])
 
+    ids = list(mmp.LazyBitVectorPick(fps, len(fps), 20, seed=42, numThreads=4))
+    self.assertEqual(ids, [
+      374, 720, 690, 339, 875, 842, 404, 725, 120, 385, 115, 868, 630, 881, 516, 497, 412, 718, 869,
+      407
+    ])
+
   def testBitVectorMaxMin4(self):
     # threshold tests
     fname = os.path.join(RDConfig.RDBaseDir, 'Code', 'SimDivPickers', 'Wrap', 'test_data',
@@ -275,6 +281,7 @@ class TestCase(unittest.TestCase):
     thresh = 0.8
     ids = mmp.LazyBitVectorPick(fps, len(fps), thresh)
     self.assertEqual(len(ids), 146)
+    self.assertEqual(list(mmp.LazyBitVectorPick(fps, len(fps), thresh, numThreads=4)), list(ids))
     for i in range(len(ids)):
       for j in range(i):
         self.assertGreaterEqual(1 - DataStructs.TanimotoSimilarity(fps[ids[i]], fps[ids[j]]),
@@ -14,8 +14,14 @@
 #include <DataStructs/ExplicitBitVect.h>
 #include <DataStructs/BitOps.h>
 #include <SimDivPickers/LeaderPicker.h>
+#include <SimDivPickers/MaxMinPicker.h>
+#include <SimDivPickers/ButinaCluster.h>
 
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
+#include <numeric>
+#include <random>
 
 template <typename T>
 class BVFunctor {
@@ -83,3 +89,199 @@ TEST_CASE(
   }
 #endif
 }
+
+namespace {
+// a direct implementation of rdkit.ML.Cluster.Butina.ClusterData()
+std::vector<std::vector<unsigned int>> referenceButina(
+    const std::vector<std::unique_ptr<ExplicitBitVect>> &fps,
+    double distThreshold, bool reordering) {
+  const unsigned int nPts = fps.size();
+  std::vector<std::vector<unsigned int>> nbrLists(nPts);
+  for (unsigned int i = 0; i < nPts; ++i) {
+    for (unsigned int j = 0; j < nPts; ++j) {
+      if (i == j ||
+          TanimotoSimilarity(*fps[i], *fps[j]) >= 1.0 - distThreshold) {
+        nbrLists[i].push_back(j);
+      }
+    }
+  }
+  std::vector<std::pair<unsigned int, unsigned int>> order;
+  for (unsigned int i = 0; i < nPts; ++i) {
+    order.emplace_back(nbrLists[i].size(), i);
+  }
+  std::sort(order.rbegin(), order.rend());
+  std::vector<std::vector<unsigned int>> res;
+  std::vector<bool> seen(nPts, false);
+  while (!order.empty()) {
+    auto idx = order.front().second;
+    order.erase(order.begin());
+    if (seen[idx]) {
+      continue;
+    }
+    std::vector<unsigned int> cluster{idx};
+    seen[idx] = true;
+    for (auto nbr : nbrLists[idx]) {
+      if (!seen[nbr]) {
+        cluster.push_back(nbr);
+        seen[nbr] = true;
+      }
+    }
+    res.push_back(cluster);
+    if (reordering) {
+      for (auto &elem : order) {
+        auto &nbrs = nbrLists[elem.second];
+        nbrs.erase(std::remove_if(nbrs.begin(), nbrs.end(),
+                                  [&seen](unsigned int n) { return seen[n]; }),
+                   nbrs.end());
+        elem.first = nbrs.size();
+      }
+      std::sort(order.rbegin(), order.rend());
+    }
+  }
+  return res;
+}
+}  // namespace
+
+TEST_CASE("Butina clustering", "[Butina]") {
+  std::string rdbase = getenv("RDBASE");
+  std::string fName =
+      rdbase + "/Code/SimDivPickers/Wrap/test_data/chembl_cyps.head.fps";
+  std::ifstream inf(fName);
+  std::string fpsText;
+  std::getline(inf, fpsText);
+  std::vector<std::unique_ptr<ExplicitBitVect>> fps;
+  while (!inf.eof() && !fpsText.empty()) {
+    fps.emplace_back(new ExplicitBitVect(fpsText.size() * 4));
+    UpdateBitVectFromFPSText(*fps.back(), fpsText);
+    std::getline(inf, fpsText);
+  };
+  REQUIRE(fps.size() == 1000);
+  std::vector<const ExplicitBitVect *> fpPtrs;
+  for (const auto &fp : fps) {
+    fpPtrs.push_back(fp.get());
+  }
+  PackedBitOps::PackedFingerprints packed(fpPtrs);
+  const double distThreshold = 0.6;
+
+  SECTION("neighbor graph") {
+    RDPickers::FingerprintNeighborGraph graph(packed, 1.0 - distThreshold);
+    REQUIRE(graph.size() == fps.size());
+    for (unsigned int i = 0; i < fps.size(); i += 7) {
+      std::vector<std::uint32_t> expected;
+      for (unsigned int j = 0; j < fps.size(); ++j) {
+        if (i != j &&
+            TanimotoSimilarity(*fps[i], *fps[j]) >= 1.0 - distThreshold) {
+          expected.push_back(j);
+        }
+      }
+      auto nbrs = graph.getNeighbors(i);
+      CHECK(std::vector<std::uint32_t>(nbrs.begin(), nbrs.end()) == expected);
+    }
+  }
+  SECTION("clusters") {
+    for (auto reordering : {false, true}) {
+      auto expected = referenceButina(fps, distThreshold, reordering);
+      auto clusters =
+          RDPickers::butinaCluster(packed, distThreshold, reordering);
+      CHECK(clusters == expected);
+      unsigned int total = 0;
+      for (const auto &cluster : clusters) {
+        total += cluster.size();
+      }
+      CHECK(total == fps.size());
+#ifdef RDK_BUILD_THREADSAFE_SSS
+      CHECK(RDPickers::butinaCluster(packed, distThreshold, reordering, 4) ==
+            expected);
+#endif
+    }
+  }
+  SECTION("spill file") {
+    std::string spillName = "butina_spill.bin";
+    {
+      RDPickers::FingerprintNeighborGraph graph(
+          packed, 1.0 - distThreshold,
+          PackedBitOps::SimilarityMetric::Tanimoto, 1, spillName);
+      RDPickers::FingerprintNeighborGraph inMemory(packed,
+                                                   1.0 - distThreshold);
+      REQUIRE(graph.getNumEntries() == inMemory.getNumEntries());
+      for (unsigned int i = 0; i < fps.size(); ++i) {
+        auto nbrs = graph.getNeighbors(i);
+        auto refNbrs = inMemory.getNeighbors(i);
+        CHECK(std::equal(nbrs.begin(), nbrs.end(), refNbrs.begin(),
+                         refNbrs.end()));
+      }
+      CHECK(RDPickers::butinaCluster(graph, true) ==
+            RDPickers::butinaCluster(inMemory, true));
+    }
+    // the spill file is removed with the graph
+    CHECK(!std::ifstream(spillName));
+  }
+}
+
+TEST_CASE("pickers on packed fingerprints", "[LeaderPicker][MaxMinPicker]") {
+  // a pool which is large enough to be split over several threads
+  std::mt19937 rng(0xfeed);
+  std::vector<std::unique_ptr<ExplicitBitVect>> fps;
+  for (unsigned int i = 0; i < 5000; ++i) {
+    fps.emplace_back(new ExplicitBitVect(1024));
+    auto density = 4 + rng() % 60;
+    for (unsigned int j = 0; j < 1024; ++j) {
+      if (rng() % density == 0) {
+        fps.back()->setBit(j);
+      }
+    }
+  }
+  std::vector<const ExplicitBitVect *> fpPtrs;
+  for (const auto &fp : fps) {
+    fpPtrs.push_back(fp.get());
+  }
+  PackedBitOps::PackedFingerprints packed(fpPtrs);
+  BVFunctor<std::vector<std::unique_ptr<ExplicitBitVect>>> bvf(fps);
+
+  SECTION("MaxMin") {
+    RDPickers::MaxMinPicker pkr;
+    RDKit::INT_VECT firstPicks;
+    double expectedThreshold = -1.0;
+    auto expected = pkr.lazyPick(bvf, fps.size(), 150, firstPicks, 42,
+                                 expectedThreshold);
+    for (auto numThreads : {1, 4}) {
+      double threshold = -1.0;
+      auto picks =
+          pkr.pick(packed, 150, firstPicks, 42, threshold, numThreads);
+      CHECK(picks == expected);
+      CHECK(threshold == expectedThreshold);
+    }
+    // stop at the distance reached after 150 picks
+    const double stopThreshold = expectedThreshold;
+    firstPicks = {17, 4000};
+    expectedThreshold = stopThreshold;
+    expected = pkr.lazyPick(bvf, fps.size(), 1000, firstPicks, -1,
+                            expectedThreshold);
+    CHECK(expected.size() < 1000);
+    for (auto numThreads : {1, 4}) {
+      double threshold = stopThreshold;
+      auto picks =
+          pkr.pick(packed, 1000, firstPicks, -1, threshold, numThreads);
+      CHECK(picks == expected);
+      CHECK(threshold == expectedThreshold);
+    }
+  }
+  SECTION("Leader") {
+    RDPickers::LeaderPicker pkr;
+    for (auto threshold : {0.6, 0.8}) {
+      RDKit::INT_VECT firstPicks;
+      auto expected = pkr.lazyPick(bvf, fps.size(), 0, firstPicks, threshold,
+                                   1);
+      for (auto numThreads : {1, 4}) {
+        CHECK(pkr.pick(packed, 0, firstPicks, threshold, numThreads) ==
+              expected);
+      }
+      firstPicks = {4999, 3};
+      expected = pkr.lazyPick(bvf, fps.size(), 50, firstPicks, threshold, 1);
+      for (auto numThreads : {1, 4}) {
+        CHECK(pkr.pick(packed, 50, firstPicks, threshold, numThreads) ==
+              expected);
+      }
+    }
+  }
+}
@@ -41,15 +41,14 @@ RDKit::INT_VECT LazyVectorLeaderPicks(LeaderPicker *picker, nb::object objs,
                                       int poolSize, double threshold,
                                       int pickSize, nb::object firstPicks,
                                       int numThreads) {
-  std::vector<const ExplicitBitVect *> bvs(poolSize);
-  for (int i = 0; i < poolSize; ++i) {
-    bvs[i] = nb::cast<const ExplicitBitVect *>(objs[i]);
+  auto fps = packBitVects(objs, poolSize);
+  RDKit::INT_VECT firstPickVect;
+  auto len = nb::len(firstPicks);
+  for (size_t i = 0; i < len; ++i) {
+    firstPickVect.push_back(nb::cast<int>(firstPicks[i]));
   }
-  pyBVFunctor<ExplicitBitVect> functor(bvs, TANIMOTO);
-  RDKit::INT_VECT res;
-  LazyLeaderHelper(picker, functor, poolSize, threshold, pickSize, firstPicks,
-                   res, numThreads);
-  return res;
+  nb::gil_scoped_release release;
+  return picker->pick(fps, pickSize, firstPickVect, threshold, numThreads);
 }
 
 RDKit::INT_VECT LazyLeaderPicks(LeaderPicker *picker, nb::object distFunc,
@@ -80,8 +79,7 @@ https://github.com/rdkit/UGM_2019/raw/master/Presentations/Sayle_Clustering.pdf
            "numThreads"_a = 1,
            "Pick a subset of items from a collection of bit vectors using "
            "Tanimoto distance. The threshold value is a "
-           "*distance* (i.e. 1-similarity). Note that the numThreads "
-           "argument is currently ignored.")
+           "*distance* (i.e. 1-similarity).")
       .def("LazyPick", RDPickers::LazyLeaderPicks,
            "distFunc"_a, "poolSize"_a, "threshold"_a,
            "pickSize"_a = 0, "firstPicks"_a = nb::tuple(),
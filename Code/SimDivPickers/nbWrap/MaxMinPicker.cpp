@@ -86,39 +86,44 @@ std::tuple<RDKit::INT_VECT, double> LazyMaxMinPicksWithThreshold(
   return std::make_tuple(res, threshold);
 }
 
+namespace {
+void VectorMaxMinHelper(MaxMinPicker *picker, nb::object objs,
+                        unsigned int poolSize, unsigned int pickSize,
+                        nb::object firstPicks, int seed, RDKit::INT_VECT &res,
+                        double &threshold, int numThreads) {
+  auto fps = packBitVects(objs, poolSize);
+  RDKit::INT_VECT firstPickVect;
+  auto len = nb::len(firstPicks);
+  for (size_t i = 0; i < len; ++i) {
+    firstPickVect.push_back(nb::cast<int>(firstPicks[i]));
+  }
+  nb::gil_scoped_release release;
+  res = picker->pick(fps, pickSize, firstPickVect, seed, threshold,
+                     numThreads);
+}
+}  // end of anonymous namespace
+
 RDKit::INT_VECT LazyVectorMaxMinPicks(MaxMinPicker *picker, nb::object objs,
                                       int poolSize, int pickSize,
                                       nb::object firstPicks, int seed,
-                                      nb::object useCache) {
+                                      nb::object useCache, int numThreads) {
   if (!useCache.is_none()) {
     BOOST_LOG(rdWarningLog)
         << "the useCache argument is deprecated and ignored" << std::endl;
   }
-  std::vector<const ExplicitBitVect *> bvs(poolSize);
-  for (int i = 0; i < poolSize; ++i) {
-    bvs[i] = nb::cast<const ExplicitBitVect *>(objs[i]);
-  }
-  pyBVFunctor<ExplicitBitVect> functor(bvs, TANIMOTO);
-
   RDKit::INT_VECT res;
   double threshold = -1.;
-  LazyMaxMinHelper(picker, functor, poolSize, pickSize, firstPicks, seed, res,
-                   threshold);
+  VectorMaxMinHelper(picker, objs, poolSize, pickSize, firstPicks, seed, res,
+                     threshold, numThreads);
   return res;
 }
 
 std::tuple<RDKit::INT_VECT, double> LazyVectorMaxMinPicksWithThreshold(
     MaxMinPicker *picker, nb::object objs, int poolSize, int pickSize,
-    double threshold, nb::object firstPicks, int seed) {
-  std::vector<const ExplicitBitVect *> bvs(poolSize);
-  for (int i = 0; i < poolSize; ++i) {
-    bvs[i] = nb::cast<const ExplicitBitVect *>(objs[i]);
-  }
-  pyBVFunctor<ExplicitBitVect> functor(bvs, TANIMOTO);
-
+    double threshold, nb::object firstPicks, int seed, int numThreads) {
   RDKit::INT_VECT res;
-  LazyMaxMinHelper(picker, functor, poolSize, pickSize, firstPicks, seed, res,
-                   threshold);
+  VectorMaxMinHelper(picker, objs, poolSize, pickSize, firstPicks, seed, res,
+                     threshold, numThreads);
   return std::make_tuple(res, threshold);
 }
 
@@ -164,7 +169,7 @@ ARGUMENTS:
       .def("LazyBitVectorPick", RDPickers::LazyVectorMaxMinPicks,
            "objects"_a, "poolSize"_a, "pickSize"_a,
            "firstPicks"_a = nb::tuple(), "seed"_a = -1,
-           "useCache"_a = nb::none(),
+           "useCache"_a = nb::none(), "numThreads"_a = 1,
            R"DOC(Pick a subset of items from a pool of bit vectors using the MaxMin Algorithm
 Ashton, M. et. al., Quant. Struct.-Act. Relat., 21 (2002), 598-604
 ARGUMENTS:
@@ -175,6 +180,7 @@ ARGUMENTS:
   - firstPicks: (optional) the first items to be picked (seeds the list)
   - seed: (optional) seed for the random number generator
   - useCache: IGNORED.
+  - numThreads: (optional) number of threads to use
 )DOC")
 
       .def("LazyPickWithThreshold", RDPickers::LazyMaxMinPicksWithThreshold,
@@ -199,7 +205,7 @@ ARGUMENTS:
            RDPickers::LazyVectorMaxMinPicksWithThreshold,
            "objects"_a, "poolSize"_a, "pickSize"_a,
            "threshold"_a,
-           "firstPicks"_a = nb::tuple(), "seed"_a = -1,
+           "firstPicks"_a = nb::tuple(), "seed"_a = -1, "numThreads"_a = 1,
            R"DOC(Pick a subset of items from a pool of bit vectors using the MaxMin Algorithm
 Ashton, M. et. al., Quant. Struct.-Act. Relat., 21 (2002), 598-604
 ARGUMENTS:
@@ -210,5 +216,6 @@ ARGUMENTS:
   - threshold: stop picking when the distance goes below this value
   - firstPicks: (optional) the first items to be picked (seeds the list)
   - seed: (optional) seed for the random number generator
+  - numThreads: (optional) number of threads to use
 )DOC");
 }
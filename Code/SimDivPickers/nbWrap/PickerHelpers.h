@@ -12,6 +12,7 @@
 
 #include <vector>
 #include <DataStructs/BitOps.h>
+#include <DataStructs/PackedBitOps.h>
 #include <nanobind/nanobind.h>
 
 namespace nb = nanobind;
@@ -59,4 +60,14 @@ class pyobjFunctor {
   nb::object dp_obj;
 };
 
+// packs the first poolSize bit vectors from a sequence
+inline PackedBitOps::PackedFingerprints packBitVects(nb::object objs,
+                                                     int poolSize) {
+  std::vector<const ExplicitBitVect *> bvs(poolSize);
+  for (int i = 0; i < poolSize; ++i) {
+    bvs[i] = nb::cast<const ExplicitBitVect *>(objs[i]);
+  }
+  return PackedBitOps::PackedFingerprints(bvs);
+}
+
 #endif  // RDKIT_PICKERHELPERS_H